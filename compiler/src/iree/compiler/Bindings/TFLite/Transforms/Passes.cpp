@@ -18,9 +18,12 @@ namespace iree_compiler {
 namespace IREE {
 namespace TFLite {
 
-void buildTransformPassPipeline(OpPassManager &passManager) {
+void buildTransformPassPipeline(
+    OpPassManager &passManager,
+    const IREE::ABI::InvocationOptions &invocationOptions) {
   // Wraps the entry points in a "_tflite_xx" function and adds shape support.
-  passManager.addPass(createWrapEntryPointsPass());
+  passManager.addPass(
+      createWrapEntryPointsPass(invocationOptions.invocationModel));
 
   // Cleanup the IR after manipulating it.
   passManager.addPass(createInlinerPass());
@@ -30,11 +33,12 @@ void buildTransformPassPipeline(OpPassManager &passManager) {
 }
 
 void registerTransformPassPipeline() {
-  PassPipelineRegistration<> transformPassPipeline(
+  PassPipelineRegistration<IREE::ABI::InvocationOptions> transformPassPipeline(
       "iree-tflite-transform-pipeline",
       "Runs the TFLite bindings support pipeline",
-      [](OpPassManager &passManager) {
-        buildTransformPassPipeline(passManager);
+      [](OpPassManager &passManager,
+         const IREE::ABI::InvocationOptions &invocationOptions) {
+        buildTransformPassPipeline(passManager, invocationOptions);
       });
 }
 
@@ -7,6 +7,7 @@
 #ifndef IREE_COMPILER_BINDINGS_TFLITE_TRANSFORMS_PASSES_H_
 #define IREE_COMPILER_BINDINGS_TFLITE_TRANSFORMS_PASSES_H_
 
+#include "iree/compiler/Bindings/Native/Transforms/Passes.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Pass/PassManager.h"
@@ -22,8 +23,11 @@ namespace TFLite {
 //===----------------------------------------------------------------------===//
 
 // Adds a set of passes to the given pass manager that setup a module for use
-// with the IREE TFLite runtime bindings.
-void buildTransformPassPipeline(OpPassManager &passManager);
+// with the IREE TFLite runtime bindings. The asynchronous entry point is only
+// emitted when |invocationOptions| requests the `coarse-fences` model.
+void buildTransformPassPipeline(
+    OpPassManager &passManager,
+    const IREE::ABI::InvocationOptions &invocationOptions);
 
 void registerTransformPassPipeline();
 
@@ -33,7 +37,9 @@ void registerTransformPassPipeline();
 
 // Wraps all model entry points in a function that is compatible with the
 // expected invocation semantics of the IREE TFLite bindings.
-std::unique_ptr<OperationPass<ModuleOp>> createWrapEntryPointsPass();
+std::unique_ptr<OperationPass<ModuleOp>> createWrapEntryPointsPass(
+    IREE::ABI::InvocationModel invocationModel =
+        IREE::ABI::InvocationModel::Sync);
 
 //===----------------------------------------------------------------------===//
 // Register all Passes
@@ -4,6 +4,7 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include "iree/compiler/Bindings/TFLite/Transforms/Passes.h"
 #include "iree/compiler/Dialect/HAL/IR/HALDialect.h"
 #include "iree/compiler/Dialect/HAL/IR/HALOps.h"
 #include "iree/compiler/Dialect/Util/IR/UtilDialect.h"
@@ -34,6 +35,9 @@ namespace TFLite {
 // For each exported function we produce:
 // - `_tflite_xx_argN`/`retN` globals carrying shape dimensions
 // - `_tflite_xx` entry function wrapping the existing export
+// - `_tflite_xx_async` entry function wrapping the existing export with the
+//   `coarse-fences` ABI model for pipelined invocation (only when the
+//   `coarse-fences` invocation model is requested)
 // - `_tflite_xx_calculate_shapes` shape calculation function
 // - `_tflite_xx_query_input_shape` shape query function
 // - `_tflite_xx_query_output_shape` shape query function
@@ -48,6 +52,12 @@ namespace TFLite {
 class WrapEntryPointsPass
     : public PassWrapper<WrapEntryPointsPass, OperationPass<ModuleOp>> {
  public:
+  WrapEntryPointsPass() = default;
+  WrapEntryPointsPass(const WrapEntryPointsPass &pass) {}
+  WrapEntryPointsPass(IREE::ABI::InvocationModel invocationModel) {
+    this->invocationModel = invocationModel;
+  }
+
   void getDependentDialects(DialectRegistry &registry) const override {
     registry.insert<mlir::func::FuncDialect, mlir::arith::ArithDialect,
                     mlir::tensor::TensorDialect, IREE::HAL::HALDialect,
@@ -477,35 +487,49 @@ class WrapEntryPointsPass
   //
   // NOTE: today we only support a single entry point; with minor tweaks we
   // could fix this up to support multiple if we wanted.
-  void createWrapperFunc(StringRef namePrefix, mlir::func::FuncOp entryFuncOp,
+  //
+  // When |isAsync| is set the wrapper takes a trailing (wait, signal) fence
+  // pair using the `coarse-fences` ABI model: inputs are imported once the
+  // wait fence is reached and the signal fence is reached when the outputs
+  // are ready. The wrapper returns as soon as the work has been scheduled.
+  void createWrapperFunc(StringRef wrapperName, bool isAsync,
+                         mlir::func::FuncOp entryFuncOp,
                          ArrayRef<DynamicDims> inputDynamicDims,
                          ArrayRef<DynamicDims> outputDynamicDims,
                          IREE::Util::GlobalOp dirtyGlobalOp,
                          OpBuilder &moduleBuilder) {
     // NOTE: this is where we could change our signature to provide additional
-    // values from the runtime bindings as may be required - like semaphores for
-    // async behavior or cancellation.
+    // values from the runtime bindings as may be required - like cancellation.
     auto entryFuncType = entryFuncOp.getFunctionType();
     auto bufferType = moduleBuilder.getType<IREE::HAL::BufferType>();
+    auto fenceType = moduleBuilder.getType<IREE::HAL::FenceType>();
     SmallVector<Type> inputTypes(entryFuncType.getNumInputs(), bufferType);
+    if (isAsync) {
+      inputTypes.push_back(fenceType);  // wait
+      inputTypes.push_back(fenceType);  // signal
+    }
     SmallVector<Type> outputTypes(entryFuncType.getNumResults(), bufferType);
     auto wrapperFuncType =
         moduleBuilder.getFunctionType(inputTypes, outputTypes);
 
     auto wrapperFuncOp = moduleBuilder.create<mlir::func::FuncOp>(
-        entryFuncOp.getLoc(), "_tflite_main", wrapperFuncType);
+        entryFuncOp.getLoc(), wrapperName, wrapperFuncType);
     wrapperFuncOp.setPublic();
     wrapperFuncOp.getOperation()->setAttr("iree.abi.stub",
                                           moduleBuilder.getUnitAttr());
 
     SmallVector<DictionaryAttr, 4> argAttrDict;
     entryFuncOp.getAllArgAttrs(argAttrDict);
+    if (isAsync) {
+      argAttrDict.push_back(nullptr);  // wait
+      argAttrDict.push_back(nullptr);  // signal
+    }
     wrapperFuncOp.setAllArgAttrs(argAttrDict);
     SmallVector<DictionaryAttr, 4> resultAttrDict;
     entryFuncOp.getAllResultAttrs(resultAttrDict);
     wrapperFuncOp.setAllResultAttrs(resultAttrDict);
 
-    populateReflectionAttrs(entryFuncOp, wrapperFuncOp);
+    populateReflectionAttrs(entryFuncOp, wrapperFuncOp, isAsync);
 
     // Call the entryFuncOp and return the results.
     // If we wanted to perform additional work here to invalidate cached shapes
@@ -519,9 +543,17 @@ class WrapEntryPointsPass
     // expect in the runtime.
     auto *entryBlock = wrapperFuncOp.addEntryBlock();
     auto entryBuilder = OpBuilder::atBlockBegin(entryBlock);
+    Value waitFence;
+    Value signalFence;
+    if (isAsync) {
+      waitFence = entryBlock->getArgument(entryBlock->getNumArguments() - 2);
+      signalFence = entryBlock->getArgument(entryBlock->getNumArguments() - 1);
+    }
     SmallVector<Value> callOperands;
     for (auto [arg, inputDynamicDims] :
-         llvm::zip_equal(entryBlock->getArguments(), inputDynamicDims)) {
+         llvm::zip_equal(entryBlock->getArguments().take_front(
+                             entryFuncType.getNumInputs()),
+                         inputDynamicDims)) {
       SmallVector<Value> dynamicDims;
       for (auto globalOp : inputDynamicDims.globalOps) {
         dynamicDims.push_back(entryBuilder.create<IREE::Util::GlobalLoadOp>(
@@ -529,14 +561,29 @@ class WrapEntryPointsPass
       }
       callOperands.push_back(entryBuilder.create<IREE::HAL::TensorImportOp>(
           arg.getLoc(), inputDynamicDims.tensorType, arg,
-          TypeAttr::get(inputDynamicDims.tensorType), dynamicDims,
-          /*wait_fence=*/Value{}, /*name=*/nullptr));
+          TypeAttr::get(inputDynamicDims.tensorType), dynamicDims, waitFence,
+          /*name=*/nullptr));
     }
     auto callOp = entryBuilder.create<mlir::func::CallOp>(
         entryFuncOp.getLoc(), entryFuncOp, callOperands);
+
+    // Signal the fence once all results are available; the results returned
+    // from the barrier are the ones the caller must wait on before use.
+    SmallVector<Value> asyncResults = llvm::to_vector(callOp.getResults());
+    if (signalFence) {
+      if (asyncResults.empty()) {
+        entryBuilder.create<IREE::HAL::FenceSignalOp>(entryFuncOp.getLoc(),
+                                                      signalFence);
+      } else {
+        auto barrierOp = entryBuilder.create<IREE::HAL::TensorBarrierOp>(
+            entryFuncOp.getLoc(), asyncResults, signalFence);
+        asyncResults = llvm::to_vector(barrierOp.getResults());
+      }
+    }
+
     SmallVector<Value> callResults;
     for (auto [result, outputDynamicDims] :
-         llvm::zip_equal(callOp.getResults(), outputDynamicDims)) {
+         llvm::zip_equal(asyncResults, outputDynamicDims)) {
       SmallVector<Value> dynamicDims;
       for (unsigned i = 0; i < outputDynamicDims.tensorType.getRank(); ++i) {
         if (outputDynamicDims.tensorType.isDynamicDim(i)) {
@@ -599,18 +646,29 @@ class WrapEntryPointsPass
     createQueryOutputShapeFunc(loc, namePrefix, dynamicDimGlobals.second,
                                calculateShapeFuncOp, moduleBuilder);
 
-    // Create a wrapper function for the entry point.
+    // Create wrapper functions for the entry point.
     funcOp.setPrivate();
-    createWrapperFunc(namePrefix, funcOp, dynamicDimGlobals.first,
-                      dynamicDimGlobals.second, dirtyGlobalOp, moduleBuilder);
+    createWrapperFunc("_tflite_main", /*isAsync=*/false, funcOp,
+                      dynamicDimGlobals.first, dynamicDimGlobals.second,
+                      dirtyGlobalOp, moduleBuilder);
+    if (invocationModel == IREE::ABI::InvocationModel::CoarseFences) {
+      createWrapperFunc("_tflite_main_async", /*isAsync=*/true, funcOp,
+                        dynamicDimGlobals.first, dynamicDimGlobals.second,
+                        dirtyGlobalOp, moduleBuilder);
+    }
   }
 
   // Populates attributes on |wrapperFuncOp| to support runtime reflection like
   // IO tensor names and quantization information.
   void populateReflectionAttrs(mlir::func::FuncOp entryFuncOp,
-                               mlir::func::FuncOp wrapperFuncOp) {
+                               mlir::func::FuncOp wrapperFuncOp, bool isAsync) {
     SmallVector<NamedAttribute, 4> attrs;
     attrs.push_back(buildIONamesAttr(entryFuncOp));
+    if (isAsync) {
+      attrs.push_back(
+          NamedAttribute{StringAttr::get(&getContext(), "iree.abi.model"),
+                         StringAttr::get(&getContext(), "coarse-fences")});
+    }
     // TODO(#3972): tfl.io.quant: quantization information.
     // TODO(#3978): tfl.io.types: tensor types (complex/strings/etc).
     auto reflectionAttr = DictionaryAttr::get(&getContext(), attrs);
@@ -643,10 +701,26 @@ class WrapEntryPointsPass
         StringAttr::get(&getContext(), "tfl.io.names"),
         StringAttr::get(&getContext(), llvm::join(pieces, ";"))};
   }
+
+  Option<IREE::ABI::InvocationModel> invocationModel{
+      *this,
+      "invocation-model",
+      llvm::cl::desc("Specifies the execution model used for invocations. "
+                     "`coarse-fences` additionally emits an asynchronous "
+                     "entry point for pipelined invocation."),
+      llvm::cl::init(IREE::ABI::InvocationModel::Sync),
+      llvm::cl::values(
+          clEnumValN(IREE::ABI::InvocationModel::Sync, "sync",
+                     "Fully synchronous behavior with no fences."),
+          clEnumValN(IREE::ABI::InvocationModel::CoarseFences, "coarse-fences",
+                     "Exposes one wait fence for all inputs and one signal "
+                     "fence for all outputs.")),
+  };
 };
 
-std::unique_ptr<OperationPass<mlir::ModuleOp>> createWrapEntryPointsPass() {
-  return std::make_unique<WrapEntryPointsPass>();
+std::unique_ptr<OperationPass<mlir::ModuleOp>> createWrapEntryPointsPass(
+    IREE::ABI::InvocationModel invocationModel) {
+  return std::make_unique<WrapEntryPointsPass>(invocationModel);
 }
 
 static PassRegistration<WrapEntryPointsPass> pass;
@@ -192,6 +192,11 @@
 
 
 
+// The asynchronous entry point is only emitted for the coarse-fences model.
+// CHECK-NOT: func.func @_tflite_main_async(
+
+
+
 // CHECK-LABEL: func.func private @dynamicEntry(
 func.func @dynamicEntry(
   %arg0: tensor<?x8x8x3xf32> {iree.identifier = "input0"},
@@ -0,0 +1,49 @@
+// RUN: iree-opt --pass-pipeline='builtin.module(iree-tflite-wrap-entry-points{invocation-model=coarse-fences},canonicalize,cse)' %s | FileCheck %s
+
+// Only the asynchronous wrapper is checked here; the shape support functions
+// and the synchronous wrapper are covered by wrap_entry_points.mlir.
+
+// CHECK: func.func @_tflite_main(
+
+// CHECK-LABEL: func.func @_tflite_main_async(
+//  CHECK-SAME:   %[[IN0_BUFFER:.+]]: !hal.buffer {iree.identifier = "input0"},
+//  CHECK-SAME:   %[[IN1_BUFFER:.+]]: !hal.buffer {iree.identifier = "input1"},
+//  CHECK-SAME:   %[[WAIT:.+]]: !hal.fence,
+//  CHECK-SAME:   %[[SIGNAL:.+]]: !hal.fence)
+//  CHECK-SAME: -> (
+//  CHECK-SAME:   !hal.buffer {iree.identifier = "output0"},
+//  CHECK-SAME:   !hal.buffer {iree.identifier = "output1"}
+//  CHECK-SAME: ) attributes {
+//  CHECK-SAME:   iree.abi.stub,
+//  CHECK-SAME:   iree.reflection = {
+//  CHECK-SAME:     iree.abi.model = "coarse-fences",
+//  CHECK-SAME:     tfl.io.names = "input0;input1;output0;output1"
+//  CHECK-SAME:   }
+//  CHECK-SAME: } {
+
+// Inputs are imported once the wait fence is reached.
+//      CHECK:   %[[IN0_DIM0:.+]] = util.global.load @_tflite_dynamicEntry_input0_shape_dim0 : index
+// CHECK-NEXT:   %[[IN0:.+]] = hal.tensor.import wait(%[[WAIT]]) => %[[IN0_BUFFER]] : !hal.buffer -> tensor<?x8x8x3xf32>{%[[IN0_DIM0]]}
+//      CHECK:   %[[IN1_DIM0:.+]] = util.global.load @_tflite_dynamicEntry_input1_shape_dim0 : index
+// CHECK-NEXT:   %[[IN1:.+]] = hal.tensor.import wait(%[[WAIT]]) => %[[IN1_BUFFER]] : !hal.buffer -> tensor<?x8x8x3xf32>{%[[IN1_DIM0]]}
+//      CHECK:   %[[OUT:.+]]:2 = call @dynamicEntry(%[[IN0]], %[[IN1]])
+
+// The signal fence is reached when all outputs are ready.
+// CHECK-NEXT:   %[[READY:.+]]:2 = hal.tensor.barrier join(%[[OUT]]#0, %[[OUT]]#1 : tensor<?x8x8x3xf32>, tensor<?x8x8x3xf32>) => %[[SIGNAL]] : !hal.fence
+//      CHECK:   %[[OUT0_BUFFER:.+]] = hal.tensor.export %[[READY]]#0
+//      CHECK:   %[[OUT1_BUFFER:.+]] = hal.tensor.export %[[READY]]#1
+//      CHECK:   util.global.store %false, @_tflite_dynamicEntry_shapes_dirty : i1
+// CHECK-NEXT:   return %[[OUT0_BUFFER]], %[[OUT1_BUFFER]]
+// CHECK-NEXT: }
+
+func.func @dynamicEntry(
+  %arg0: tensor<?x8x8x3xf32> {iree.identifier = "input0"},
+  %arg1: tensor<?x8x8x3xf32> {iree.identifier = "input1"}
+) -> (
+  tensor<?x8x8x3xf32> {iree.identifier = "output0"},
+  tensor<?x8x8x3xf32> {iree.identifier = "output1"}
+) {
+  %0 = arith.addf %arg0, %arg1 : tensor<?x8x8x3xf32>
+  %1 = arith.addf %0, %arg0 : tensor<?x8x8x3xf32>
+  return %0, %1 : tensor<?x8x8x3xf32>, tensor<?x8x8x3xf32>
+}
@@ -16,9 +16,51 @@ namespace iree_compiler {
 
 namespace {
 
+// Returns the number of entry points |executableOp| contributes to a linked
+// executable. Variants for different targets are linked separately so only the
+// largest one matters.
+static int64_t getExportCount(IREE::HAL::ExecutableOp executableOp) {
+  int64_t exportCount = 0;
+  for (auto variantOp :
+       executableOp.getOps<IREE::HAL::ExecutableVariantOp>()) {
+    auto exportOps = variantOp.getOps<IREE::HAL::ExecutableExportOp>();
+    exportCount = std::max<int64_t>(
+        exportCount, std::distance(exportOps.begin(), exportOps.end()));
+  }
+  return exportCount;
+}
+
+// Partitions |executableOps| into consecutive shards of at most |maxShardSize|
+// entry points each. Executables are never split and one that is larger than
+// the limit on its own gets a shard to itself.
+static SmallVector<SmallVector<IREE::HAL::ExecutableOp>> partitionIntoShards(
+    ArrayRef<IREE::HAL::ExecutableOp> executableOps, int64_t maxShardSize) {
+  SmallVector<SmallVector<IREE::HAL::ExecutableOp>> shards(1);
+  if (maxShardSize <= 0) {
+    shards.front().assign(executableOps.begin(), executableOps.end());
+    return shards;
+  }
+  int64_t shardSize = 0;
+  for (auto executableOp : executableOps) {
+    int64_t exportCount = getExportCount(executableOp);
+    if (!shards.back().empty() && shardSize + exportCount > maxShardSize) {
+      shards.emplace_back();
+      shardSize = 0;
+    }
+    shards.back().push_back(executableOp);
+    shardSize += exportCount;
+  }
+  return shards;
+}
+
 struct LLVMCPULinkExecutablesPass
     : public LLVMCPULinkExecutablesBase<LLVMCPULinkExecutablesPass> {
-  LLVMCPULinkExecutablesPass() = default;
+  LLVMCPULinkExecutablesPass(int64_t maxShardSize) {
+    this->maxShardSize = maxShardSize;
+  }
+  LLVMCPULinkExecutablesPass(const LLVMCPULinkExecutablesPass &pass)
+      : LLVMCPULinkExecutablesPass(pass.maxShardSize) {}
+
   void runOnOperation() override {
     auto moduleOp = getOperation();
     auto moduleBuilder = OpBuilder::atBlockBegin(moduleOp.getBody());
@@ -30,33 +72,45 @@ struct LLVMCPULinkExecutablesPass
     // Guess a module name, if needed, to make the output files readable.
     auto moduleName = guessModuleName(moduleOp, "llvm_module");
 
-    // Create our new "linked" hal.executable.
-    std::string linkedExecutableName =
-        llvm::formatv("{0}_linked_{1}", moduleName, "llvm_cpu");
-    auto linkedExecutableOp = moduleBuilder.create<IREE::HAL::ExecutableOp>(
-        moduleOp.getLoc(), linkedExecutableName);
-    linkedExecutableOp.setVisibility(
-        sourceExecutableOps.front().getVisibility());
-    auto executableBuilder =
-        OpBuilder::atBlockBegin(&linkedExecutableOp.getBlock());
+    // Each shard is linked into its own hal.executable. Shards are compiled
+    // independently during serialization (and thus in parallel). The runtime
+    // still creates all of them when the module is loaded.
+    auto shards = partitionIntoShards(sourceExecutableOps, maxShardSize);
+    for (auto [shardIndex, shardExecutableOps] : llvm::enumerate(shards)) {
+      // Create our new "linked" hal.executable.
+      std::string linkedExecutableName =
+          shards.size() == 1
+              ? llvm::formatv("{0}_linked_{1}", moduleName, "llvm_cpu").str()
+              : llvm::formatv("{0}_linked_{1}_{2}", moduleName, "llvm_cpu",
+                              shardIndex)
+                    .str();
+      auto linkedExecutableOp = moduleBuilder.create<IREE::HAL::ExecutableOp>(
+          moduleOp.getLoc(), linkedExecutableName);
+      linkedExecutableOp.setVisibility(
+          shardExecutableOps.front().getVisibility());
+      auto executableBuilder =
+          OpBuilder::atBlockBegin(&linkedExecutableOp.getBlock());
 
-    // Gather all unique executable targets - we may have multiple.
-    auto executableTargetAttrs = gatherExecutableTargets(sourceExecutableOps);
-    for (auto executableTargetAttr : executableTargetAttrs) {
-      // Add our hal.executable.variant with an empty module.
-      auto linkedTargetOp =
-          executableBuilder.create<IREE::HAL::ExecutableVariantOp>(
-              moduleOp.getLoc(), executableTargetAttr.getSymbolNameFragment(),
-              executableTargetAttr);
-      auto targetBuilder = OpBuilder::atBlockBegin(&linkedTargetOp.getBlock());
-      targetBuilder.create<mlir::ModuleOp>(moduleOp.getLoc());
+      // Gather all unique executable targets - we may have multiple.
+      auto executableTargetAttrs = gatherExecutableTargets(shardExecutableOps);
+      for (auto executableTargetAttr : executableTargetAttrs) {
+        // Add our hal.executable.variant with an empty module.
+        auto linkedTargetOp =
+            executableBuilder.create<IREE::HAL::ExecutableVariantOp>(
+                moduleOp.getLoc(), executableTargetAttr.getSymbolNameFragment(),
+                executableTargetAttr);
+        auto targetBuilder =
+            OpBuilder::atBlockBegin(&linkedTargetOp.getBlock());
+        targetBuilder.create<mlir::ModuleOp>(moduleOp.getLoc());
 
-      // Try linking together all executables in moduleOp.
-      if (failed(linkExecutablesInto(
-              moduleOp, sourceExecutableOps, linkedExecutableOp, linkedTargetOp,
-              [](mlir::ModuleOp moduleOp) { return moduleOp; },
-              targetBuilder))) {
-        return signalPassFailure();
+        // Try linking together all executables in the shard.
+        if (failed(linkExecutablesInto(
+                moduleOp, shardExecutableOps, linkedExecutableOp,
+                linkedTargetOp,
+                [](mlir::ModuleOp moduleOp) { return moduleOp; },
+                targetBuilder))) {
+          return signalPassFailure();
+        }
       }
     }
   }
@@ -65,8 +119,8 @@ struct LLVMCPULinkExecutablesPass
 }  // namespace
 
 std::unique_ptr<OperationPass<mlir::ModuleOp>>
-createLLVMCPULinkExecutablesPass() {
-  return std::make_unique<LLVMCPULinkExecutablesPass>();
+createLLVMCPULinkExecutablesPass(int64_t maxShardSize) {
+  return std::make_unique<LLVMCPULinkExecutablesPass>(maxShardSize);
 }
 
 }  // namespace iree_compiler
@@ -63,6 +63,13 @@ static llvm::cl::opt<bool> clEnableReassociateFpReductions(
     llvm::cl::desc("Enables reassociation for FP reductions"),
     llvm::cl::init(false));
 
+static llvm::cl::opt<int64_t> clLinkMaxShardSize(
+    "iree-llvmcpu-link-max-shard-size",
+    llvm::cl::desc("Maximum number of entry points linked into a single "
+                   "executable; larger programs are split into multiple "
+                   "executables that are compiled in parallel (0 = no limit)"),
+    llvm::cl::init(0));
+
 static llvm::cl::opt<bool> clInstrumentMemoryAccesses{
     "iree-llvmcpu-instrument-memory-accesses",
     llvm::cl::desc("Instruments memory accesses in dispatches when dispatch "
@@ -709,7 +716,7 @@ void buildLLVMCPUCodegenPassPipeline(OpPassManager &passManager) {
 // hal.executable ops.
 void buildLLVMCPULinkingPassPipeline(OpPassManager &passManager) {
   // Link together executables. This may produce some IR duplication.
-  passManager.addPass(createLLVMCPULinkExecutablesPass());
+  passManager.addPass(createLLVMCPULinkExecutablesPass(clLinkMaxShardSize));
 
   // Cleanup IR duplication.
   passManager.addNestedPass<IREE::HAL::ExecutableOp>(
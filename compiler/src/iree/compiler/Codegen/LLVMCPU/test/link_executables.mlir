@@ -0,0 +1,91 @@
+// RUN: iree-opt --iree-llvmcpu-link-executables %s | FileCheck %s
+// RUN: iree-opt --iree-llvmcpu-link-executables="max-shard-size=2" %s | FileCheck %s --check-prefix=SHARD
+
+#executable_target = #hal.executable.target<"llvm-cpu", "embedded-elf-x86_64">
+#pipeline_layout = #hal.pipeline.layout<push_constants = 0, sets = [
+  #hal.descriptor_set.layout<0, bindings = [
+    #hal.descriptor_set.binding<0, storage_buffer>
+  ]>
+]>
+
+hal.executable private @dispatch_0 {
+  hal.executable.variant @x86_64, target = #executable_target {
+    hal.executable.export @dispatch_0 ordinal(0) layout(#pipeline_layout) {
+    ^bb0(%arg0: !hal.device) :
+      %c1 = arith.constant 1 : index
+      hal.return %c1, %c1, %c1 : index, index, index
+    }
+    builtin.module {
+      llvm.func @dispatch_0() {
+        llvm.return
+      }
+    }
+  }
+}
+hal.executable private @dispatch_1 {
+  hal.executable.variant @x86_64, target = #executable_target {
+    hal.executable.export @dispatch_1 ordinal(0) layout(#pipeline_layout) {
+    ^bb0(%arg0: !hal.device) :
+      %c1 = arith.constant 1 : index
+      hal.return %c1, %c1, %c1 : index, index, index
+    }
+    builtin.module {
+      llvm.func @dispatch_1() {
+        llvm.return
+      }
+    }
+  }
+}
+hal.executable private @dispatch_2 {
+  hal.executable.variant @x86_64, target = #executable_target {
+    hal.executable.export @dispatch_2 ordinal(0) layout(#pipeline_layout) {
+    ^bb0(%arg0: !hal.device) :
+      %c1 = arith.constant 1 : index
+      hal.return %c1, %c1, %c1 : index, index, index
+    }
+    builtin.module {
+      llvm.func @dispatch_2() {
+        llvm.return
+      }
+    }
+  }
+}
+func.func @dispatches() {
+  %device = hal.ex.shared_device : !hal.device
+  %cmd = hal.command_buffer.create device(%device : !hal.device) mode("OneShot") categories("Transfer|Dispatch") : !hal.command_buffer
+  %c1 = arith.constant 1 : index
+  hal.command_buffer.dispatch.symbol<%cmd : !hal.command_buffer> target(@dispatch_0::@x86_64::@dispatch_0) workgroups([%c1, %c1, %c1])
+  hal.command_buffer.dispatch.symbol<%cmd : !hal.command_buffer> target(@dispatch_1::@x86_64::@dispatch_1) workgroups([%c1, %c1, %c1])
+  hal.command_buffer.dispatch.symbol<%cmd : !hal.command_buffer> target(@dispatch_2::@x86_64::@dispatch_2) workgroups([%c1, %c1, %c1])
+  return
+}
+
+// Without a shard size all executables are linked into a single executable.
+//   CHECK-NOT: hal.executable private @dispatch_
+//       CHECK: hal.executable private @[[LINKED:.+]]_linked_llvm_cpu {
+//       CHECK:   hal.executable.export public @dispatch_0 ordinal(0)
+//       CHECK:   hal.executable.export public @dispatch_1 ordinal(1)
+//       CHECK:   hal.executable.export public @dispatch_2 ordinal(2)
+//       CHECK:   llvm.func @dispatch_0()
+//       CHECK:   llvm.func @dispatch_1()
+//       CHECK:   llvm.func @dispatch_2()
+//       CHECK: func.func @dispatches()
+//       CHECK:   target(@[[LINKED]]_linked_llvm_cpu::@embedded_elf_x86_64::@dispatch_0)
+//       CHECK:   target(@[[LINKED]]_linked_llvm_cpu::@embedded_elf_x86_64::@dispatch_1)
+//       CHECK:   target(@[[LINKED]]_linked_llvm_cpu::@embedded_elf_x86_64::@dispatch_2)
+
+// With a shard size of 2 the first two executables are linked together and the
+// last one gets its own shard with ordinals starting over at 0.
+//   SHARD-NOT: hal.executable private @dispatch_
+//       SHARD: hal.executable private @[[LINKED:.+]]_linked_llvm_cpu_0 {
+//       SHARD:   hal.executable.export public @dispatch_0 ordinal(0)
+//       SHARD:   hal.executable.export public @dispatch_1 ordinal(1)
+//       SHARD:   llvm.func @dispatch_0()
+//       SHARD:   llvm.func @dispatch_1()
+//       SHARD: hal.executable private @[[LINKED]]_linked_llvm_cpu_1 {
+//       SHARD:   hal.executable.export public @dispatch_2 ordinal(0)
+//       SHARD:   llvm.func @dispatch_2()
+//       SHARD: func.func @dispatches()
+//       SHARD:   target(@[[LINKED]]_linked_llvm_cpu_0::@embedded_elf_x86_64::@dispatch_0)
+//       SHARD:   target(@[[LINKED]]_linked_llvm_cpu_0::@embedded_elf_x86_64::@dispatch_1)
+//       SHARD:   target(@[[LINKED]]_linked_llvm_cpu_1::@embedded_elf_x86_64::@dispatch_2)
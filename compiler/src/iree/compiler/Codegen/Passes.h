@@ -480,9 +480,11 @@ void buildLLVMCPUCodegenPassPipeline(OpPassManager &passManager);
 // LLVMCPU Linking Passes and Pipelines
 //----------------------------------------------------------------------------//
 
-/// Links LLVMCPU HAL executables within the top-level program module.
+/// Links LLVMCPU HAL executables within the top-level program module. When
+/// `maxShardSize` is non-zero the executables are linked into as many shards
+/// as needed to keep each under that many exported entry points.
 std::unique_ptr<OperationPass<mlir::ModuleOp>>
-createLLVMCPULinkExecutablesPass();
+createLLVMCPULinkExecutablesPass(int64_t maxShardSize = 0);
 
 /// Assigns executable constant ordinals across all LLVMCPU variants.
 std::unique_ptr<OperationPass<IREE::HAL::ExecutableVariantOp>>
@@ -7,6 +7,7 @@
 #include "iree/compiler/Dialect/Flow/IR/FlowOps.h"
 #include "iree/compiler/Dialect/Flow/Transforms/PassDetail.h"
 #include "iree/compiler/Dialect/Flow/Transforms/Passes.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/PostOrderIterator.h"
 #include "llvm/ADT/SetVector.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
@@ -182,6 +183,44 @@ static bool isStructurallyEquivalentTo(Operation &lhs, Operation &rhs,
   return true;
 }
 
+// Computes a hash of |region| that is equal for any two regions that are
+// structurally equivalent according to isStructurallyEquivalentTo. SSA values
+// are not tracked and only contribute their types so the hash can be computed
+// in a single walk; this makes collisions between executables that differ only
+// in their use-def structure possible but those are resolved by the full
+// equivalence check within each hash bucket.
+static llvm::hash_code computeStructuralHash(Region &region) {
+  llvm::hash_code hash = llvm::hash_value(region.getBlocks().size());
+  region.walk<WalkOrder::PreOrder>([&](Operation *op) {
+    hash = llvm::hash_combine(hash, op->getName(), op->getNumOperands(),
+                              op->getNumResults(), op->getNumRegions(),
+                              op->getNumSuccessors());
+    // Matches the attribute filtering performed during the equivalence check.
+    for (auto attr : op->getAttrs()) {
+      if (attr.getName() == "function_ref" ||
+          attr.getName() == SymbolTable::getSymbolAttrName()) {
+        continue;
+      }
+      hash = llvm::hash_combine(hash, attr);
+    }
+    for (Type type : op->getOperandTypes()) {
+      hash = llvm::hash_combine(hash, type);
+    }
+    for (Type type : op->getResultTypes()) {
+      hash = llvm::hash_combine(hash, type);
+    }
+    for (Region &nestedRegion : op->getRegions()) {
+      for (Block &block : nestedRegion) {
+        hash = llvm::hash_combine(hash, block.getNumArguments());
+        for (Type type : block.getArgumentTypes()) {
+          hash = llvm::hash_combine(hash, type);
+        }
+      }
+    }
+  });
+  return hash;
+}
+
 // Replaces each usage of an entry point with its original symbol name with a
 // new symbol name.
 void replaceEntryPointUses(
@@ -214,36 +253,41 @@ class DeduplicateExecutablesPass
     DenseMap<Attribute, SymbolRefAttr> entryPointRefReplacements;
 
     // For each executable, find the first executable which it is equivalent to.
-    for (int i = executableOps.size() - 1; i >= 0; --i) {
-      auto duplicateExecutableOp = executableOps[i];
-
-      for (int j = 0; j < i; ++j) {
-        auto referenceExecutableOp = executableOps[j];
-        if (!isStructurallyEquivalentTo(duplicateExecutableOp.getBody(),
-                                        referenceExecutableOp.getBody())) {
-          continue;
-        }
-
-        // Found an equivalent executable! Record it and move on to the next.
-        duplicateExecutableOps.push_back(duplicateExecutableOp);
-
-        // Record entry point reference replacements.
-        for (auto [oldExportOp, newExportOp] : llvm::zip_equal(
-                 duplicateExecutableOp.getBlock().getOps<ExecutableExportOp>(),
-                 referenceExecutableOp.getBlock()
-                     .getOps<ExecutableExportOp>())) {
-          auto oldSymbolRefAttr = SymbolRefAttr::get(
-              builder.getContext(), duplicateExecutableOp.getName(),
-              {SymbolRefAttr::get(builder.getContext(),
-                                  oldExportOp.getSymName())});
-          auto newSymbolRefAttr = SymbolRefAttr::get(
-              builder.getContext(), referenceExecutableOp.getName(),
-              {SymbolRefAttr::get(builder.getContext(),
-                                  newExportOp.getSymName())});
-          entryPointRefReplacements[oldSymbolRefAttr] = newSymbolRefAttr;
-        }
-
-        break;
+    // Executables are bucketed by structural hash so that only executables
+    // that are likely to be equivalent are compared; the buckets only ever
+    // hold unique executables in their original order so the first match is
+    // the same executable a pairwise scan would have chosen.
+    DenseMap<llvm::hash_code, SmallVector<ExecutableOp>> uniqueExecutableOps;
+    for (auto duplicateExecutableOp : executableOps) {
+      auto &bucket = uniqueExecutableOps[computeStructuralHash(
+          duplicateExecutableOp.getBody())];
+      auto referenceIt =
+          llvm::find_if(bucket, [&](ExecutableOp referenceExecutableOp) {
+            return isStructurallyEquivalentTo(duplicateExecutableOp.getBody(),
+                                              referenceExecutableOp.getBody());
+          });
+      if (referenceIt == bucket.end()) {
+        bucket.push_back(duplicateExecutableOp);
+        continue;
+      }
+      auto referenceExecutableOp = *referenceIt;
+
+      // Found an equivalent executable! Record it and move on to the next.
+      duplicateExecutableOps.push_back(duplicateExecutableOp);
+
+      // Record entry point reference replacements.
+      for (auto [oldExportOp, newExportOp] : llvm::zip_equal(
+               duplicateExecutableOp.getBlock().getOps<ExecutableExportOp>(),
+               referenceExecutableOp.getBlock().getOps<ExecutableExportOp>())) {
+        auto oldSymbolRefAttr = SymbolRefAttr::get(
+            builder.getContext(), duplicateExecutableOp.getName(),
+            {SymbolRefAttr::get(builder.getContext(),
+                                oldExportOp.getSymName())});
+        auto newSymbolRefAttr = SymbolRefAttr::get(
+            builder.getContext(), referenceExecutableOp.getName(),
+            {SymbolRefAttr::get(builder.getContext(),
+                                newExportOp.getSymName())});
+        entryPointRefReplacements[oldSymbolRefAttr] = newSymbolRefAttr;
       }
     }
 
@@ -0,0 +1,268 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//===--------------- FormStreamingChunks.cpp ------------------------------===//
+//
+// Splits chains of linalg ops that are independent along their leading
+// (batch) dimension into a loop over fixed-size chunks of that dimension.
+// Dispatch region formation then runs on the loop body and every intermediate
+// tensor is materialized at chunk size instead of at full size, which bounds
+// the transient memory required by the stream scheduler regardless of the
+// batch size of the program inputs.
+//
+//===----------------------------------------------------------------------===//
+
+#include <deque>
+
+#include "iree/compiler/Dialect/Flow/Transforms/PassDetail.h"
+#include "iree/compiler/Dialect/Flow/Transforms/Passes.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/Support/Debug.h"
+#include "mlir/Conversion/SCFToControlFlow/SCFToControlFlow.h"
+#include "mlir/Dialect/Affine/IR/AffineOps.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/ControlFlow/IR/ControlFlowOps.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Dialect/SCF/Transforms/TileUsingInterface.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/Dialect/Utils/StaticValueUtils.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Transforms/DialectConversion.h"
+
+#define DEBUG_TYPE "iree-flow-form-streaming-chunks"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace Flow {
+
+namespace {
+
+/// Returns true if the iteration space of `op` can be split along its leading
+/// loop without changing the result of any iteration: the leading loop must
+/// be parallel and, for every operand that depends on it, must index the
+/// leading dimension of that operand and nothing else. Operands that do not
+/// depend on the leading loop (broadcasts along the batch) are allowed.
+static bool isChunkableOp(linalg::LinalgOp op) {
+  if (!op.hasTensorSemantics()) return false;
+  if (op.getNumLoops() == 0) return false;
+  if (!linalg::isParallelIterator(op.getIteratorTypesArray().front())) {
+    return false;
+  }
+  for (OpOperand *operand : op.getDpsInitOperands()) {
+    AffineMap map = op.getMatchingIndexingMap(operand);
+    if (map.getNumResults() == 0) return false;
+    auto dimExpr = map.getResult(0).dyn_cast<AffineDimExpr>();
+    if (!dimExpr || dimExpr.getPosition() != 0) return false;
+  }
+  for (AffineMap map : op.getIndexingMapsArray()) {
+    if (!map.isProjectedPermutation()) return false;
+    for (auto [index, expr] : llvm::enumerate(map.getResults())) {
+      auto dimExpr = expr.dyn_cast<AffineDimExpr>();
+      if (!dimExpr) continue;
+      if (dimExpr.getPosition() == 0 && index != 0) return false;
+    }
+  }
+  return true;
+}
+
+/// Returns true if the leading loop of `op` is large enough that chunking it
+/// by `chunkSize` produces at least two chunks. Dynamic extents are assumed to
+/// be large as that is the common case for batch dimensions.
+static bool hasLargeLeadingDim(linalg::LinalgOp op, int64_t chunkSize) {
+  SmallVector<int64_t> loopRanges = op.getStaticLoopRanges();
+  if (loopRanges.empty()) return false;
+  int64_t extent = loopRanges.front();
+  return ShapedType::isDynamic(extent) || extent > chunkSize;
+}
+
+/// Returns true if `op` is the last op of a chunkable chain: none of its users
+/// would be chunked along with it. Only the last op is tiled directly; its
+/// chunkable producers are pulled into the chunk loop by fusion. Chains of a
+/// single op have no intermediates to bound and are skipped.
+static bool isChainRoot(linalg::LinalgOp op) {
+  for (Operation *user : op->getUsers()) {
+    auto linalgUser = dyn_cast<linalg::LinalgOp>(user);
+    if (linalgUser && isChunkableOp(linalgUser)) return false;
+  }
+  return llvm::any_of(op.getDpsInputOperands(), [](OpOperand *operand) {
+    auto producer = operand->get().getDefiningOp<linalg::LinalgOp>();
+    return producer && isChunkableOp(producer);
+  });
+}
+
+/// Returns true if `size` is the full extent of dimension `dim` of `source`.
+/// Dynamic extents are only recognized when queried from `source` itself.
+static bool isFullExtent(OpFoldResult size, Value source, int64_t dim) {
+  auto sourceType = source.getType().cast<RankedTensorType>();
+  if (!sourceType.isDynamicDim(dim)) {
+    return getConstantIntValue(size) == sourceType.getDimSize(dim);
+  }
+  auto sizeValue = size.dyn_cast<Value>();
+  if (!sizeValue) return false;
+  auto dimOp = sizeValue.getDefiningOp<tensor::DimOp>();
+  return dimOp && dimOp.getSource() == source &&
+         dimOp.getConstantIndex() == dim;
+}
+
+/// Returns true if `sliceOp` takes a chunk of its source along the leading
+/// (chunked) dimension only: the leading offset must vary with `loop` and all
+/// other dimensions must be taken in full. Any other slice does not line up
+/// with the chunks of the producer's leading loop.
+static bool isLeadingDimChunk(tensor::ExtractSliceOp sliceOp,
+                              scf::ForOp loop) {
+  if (!sliceOp.hasUnitStride()) return false;
+  if (sliceOp.getSourceType().getRank() != sliceOp.getType().getRank()) {
+    return false;
+  }
+  SmallVector<OpFoldResult> offsets = sliceOp.getMixedOffsets();
+  SmallVector<OpFoldResult> sizes = sliceOp.getMixedSizes();
+  if (offsets.empty()) return false;
+  auto leadingOffset = offsets.front().dyn_cast<Value>();
+  if (!leadingOffset ||
+      !loop.getRegion().isAncestor(leadingOffset.getParentRegion())) {
+    return false;
+  }
+  for (int64_t dim = 1; dim < static_cast<int64_t>(offsets.size()); ++dim) {
+    if (!isConstantIntValue(offsets[dim], 0) ||
+        !isFullExtent(sizes[dim], sliceOp.getSource(), dim)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Returns true if the producer of `sliceOp` should be computed per chunk
+/// inside `loop`. Producers that cannot be chunked (such as reductions across
+/// the batch) would be recomputed in full by every chunk and producers with
+/// uses outside of the loop would be computed twice; both are left ahead of
+/// the loop where their results are materialized once. So are producers read
+/// along any dimension other than their leading one, such as broadcasts, as
+/// their chunks do not correspond to the chunks of the loop.
+static bool shouldFuseIntoChunk(tensor::ExtractSliceOp sliceOp,
+                                scf::ForOp loop) {
+  auto producer = sliceOp.getSource().getDefiningOp<linalg::LinalgOp>();
+  if (!producer || !isChunkableOp(producer)) return false;
+  if (!isLeadingDimChunk(sliceOp, loop)) return false;
+  return llvm::all_of(producer->getUsers(), [&](Operation *user) {
+    return loop->isAncestor(user);
+  });
+}
+
+/// Tiles `op` along its leading loop by `chunkSize` and fuses the chunkable
+/// producers of the chain into the resulting loop. Returns the chunk loop.
+static FailureOr<scf::ForOp> chunkChain(RewriterBase &rewriter,
+                                        linalg::LinalgOp op,
+                                        int64_t chunkSize) {
+  SmallVector<int64_t> tileSizes(op.getNumLoops(), 0);
+  tileSizes.front() = chunkSize;
+  rewriter.setInsertionPoint(op);
+  FailureOr<scf::SCFTilingResult> tilingResult = scf::tileUsingSCFForOp(
+      rewriter, cast<TilingInterface>(op.getOperation()),
+      scf::SCFTilingOptions().setTileSizes(tileSizes));
+  if (failed(tilingResult)) return failure();
+  rewriter.replaceOp(op, tilingResult->replacements);
+  scf::ForOp loop = tilingResult->loops.front();
+
+  // Fuse producers through the slices of their results taken in the loop,
+  // breadth-first so that each producer is considered once all of its users
+  // in the chain have been fused. The untiled producer is erased once the loop
+  // no longer needs it.
+  std::deque<tensor::ExtractSliceOp> candidates;
+  auto addCandidateSlices = [&](Operation *tiledOp) {
+    for (Value operand : tiledOp->getOperands()) {
+      if (auto sliceOp = operand.getDefiningOp<tensor::ExtractSliceOp>()) {
+        candidates.push_back(sliceOp);
+      }
+    }
+  };
+  for (Operation *tiledOp : tilingResult->tiledOps) addCandidateSlices(tiledOp);
+  while (!candidates.empty()) {
+    tensor::ExtractSliceOp sliceOp = candidates.front();
+    candidates.pop_front();
+    if (!shouldFuseIntoChunk(sliceOp, loop)) continue;
+    std::optional<scf::SCFFuseProducerOfSliceResult> fusedProducer =
+        scf::tileAndFuseProducerOfSlice(rewriter, sliceOp,
+                                        tilingResult->loops);
+    if (!fusedProducer) continue;
+    Operation *origProducer = fusedProducer->origProducer.getOwner();
+    if (origProducer->use_empty()) rewriter.eraseOp(origProducer);
+    for (Operation *tiledOp : fusedProducer->tiledOps) {
+      addCandidateSlices(tiledOp);
+    }
+  }
+  return loop;
+}
+
+struct FormStreamingChunksPass
+    : public FormStreamingChunksBase<FormStreamingChunksPass> {
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<AffineDialect, arith::ArithDialect, cf::ControlFlowDialect,
+                    linalg::LinalgDialect, scf::SCFDialect,
+                    tensor::TensorDialect>();
+  }
+  FormStreamingChunksPass(int64_t chunkSize) { this->chunkSize = chunkSize; }
+  FormStreamingChunksPass(const FormStreamingChunksPass &pass)
+      : FormStreamingChunksPass(pass.chunkSize) {}
+
+  void runOnOperation() override {
+    if (chunkSize <= 0) return;
+    Operation *rootOp = getOperation();
+    MLIRContext *context = &getContext();
+
+    // Only ops directly in the function body are considered; anything already
+    // nested in a dispatch region or control flow is left alone.
+    SmallVector<linalg::LinalgOp> chainRoots;
+    for (Region &region : rootOp->getRegions()) {
+      for (Block &block : region) {
+        for (auto op : block.getOps<linalg::LinalgOp>()) {
+          if (isChunkableOp(op) && hasLargeLeadingDim(op, chunkSize) &&
+              isChainRoot(op)) {
+            chainRoots.push_back(op);
+          }
+        }
+      }
+    }
+    if (chainRoots.empty()) return;
+
+    IRRewriter rewriter(context);
+    llvm::SetVector<Operation *> chunkLoops;
+    for (linalg::LinalgOp op : chainRoots) {
+      FailureOr<scf::ForOp> loop = chunkChain(rewriter, op, chunkSize);
+      if (failed(loop)) {
+        LLVM_DEBUG(llvm::dbgs() << "failed to chunk " << op << "\n");
+        continue;
+      }
+      chunkLoops.insert(*loop);
+    }
+
+    // The stream dialect only models unstructured control flow at the program
+    // level so the chunk loops are lowered to a CFG right away. Each block of
+    // the loop body becomes its own execution region with chunk-sized
+    // transients.
+    RewritePatternSet patterns(context);
+    populateSCFToControlFlowConversionPatterns(patterns);
+    ConversionTarget target(*context);
+    target.addDynamicallyLegalOp<scf::ForOp>(
+        [&](scf::ForOp op) { return !chunkLoops.contains(op); });
+    target.markUnknownOpDynamicallyLegal([](Operation *) { return true; });
+    if (failed(applyPartialConversion(rootOp, target, std::move(patterns)))) {
+      return signalPassFailure();
+    }
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<Pass> createFormStreamingChunksPass(int64_t chunkSize) {
+  return std::make_unique<FormStreamingChunksPass>(chunkSize);
+}
+
+}  // namespace Flow
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
@@ -101,6 +101,22 @@ static llvm::cl::opt<bool> clEnableDataTiling(
     "iree-flow-enable-data-tiling", llvm::cl::desc("Enable data tiling path"),
     llvm::cl::init(false));
 
+static llvm::cl::opt<int64_t> clStreamingChunkSize(
+    "iree-flow-streaming-chunk-size",
+    llvm::cl::desc(
+        "Splits chains of elementwise and row reduction ops that are "
+        "independent along their leading dimension into a loop over chunks "
+        "of this many rows to bound the size of intermediates (0 disables)."),
+    llvm::cl::init(0));
+
+static llvm::cl::list<int64_t> clSpecializeDispatchDims(
+    "iree-flow-specialize-dispatch-dims",
+    llvm::cl::desc(
+        "Comma separated list of hot dynamic dimension values (such as common "
+        "sequence lengths) to emit statically-shaped dispatch variants for. "
+        "The generic dispatch is used for all other values."),
+    llvm::cl::CommaSeparated);
+
 static llvm::cl::opt<bool> clNormalizeInputIndexingMap(
     "iree-flow-normalize-input-indexing-map",
     llvm::cl::desc("Enable normalizing input indexing map to identity"),
@@ -254,6 +270,13 @@ void buildFlowTransformPassPipeline(OpPassManager &passManager,
       // transpose.
       .addPredicatedPass(clNormalizeInputIndexingMap,
                          createInterchangeTransposeGenericOpsPass)
+      // Bound transient memory for huge batches by processing batch-independent
+      // op chains in fixed-size chunks. Dispatch regions are formed per chunk.
+      .addPredicatedPass(clStreamingChunkSize > 0,
+                         [&]() {
+                           return createFormStreamingChunksPass(
+                               clStreamingChunkSize);
+                         })
       // Enable data tiling after all linalg level transformations.
       .addPredicatedPass(clEnableDataTiling, createSetEncodingPass)
       ////////////////////////////////////////////////////////////////////////
@@ -292,6 +315,18 @@ void buildFlowTransformPassPipeline(OpPassManager &passManager,
       .addPass(mlir::createCanonicalizerPass)
       .addPass(createCSEPass)
 
+      // Emit statically-shaped variants of dynamic dispatches for any
+      // user-provided hot dimension values.
+      .addPredicatedPass(!clSpecializeDispatchDims.empty(),
+                         [&]() {
+                           return createSpecializeDynamicDispatchesPass(
+                               SmallVector<int64_t>(
+                                   clSpecializeDispatchDims.begin(),
+                                   clSpecializeDispatchDims.end()));
+                         })
+      .addPredicatedPass(!clSpecializeDispatchDims.empty(),
+                         mlir::createCanonicalizerPass)
+
       // Initialize any empty tensors to zero.
       .addPass([&]() {
         return createInitializeEmptyTensorsPass(clZeroFillEmptyTensors);
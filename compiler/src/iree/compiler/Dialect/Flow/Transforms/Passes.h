@@ -153,6 +153,11 @@ struct FormDispatchRegionsOptions {
 std::unique_ptr<InterfacePass<mlir::FunctionOpInterface>>
 createFormDispatchRegionsPass(FormDispatchRegionsOptions options = {});
 
+// Pass to split chains of linalg ops that are independent along their leading
+// dimension into a loop over |chunkSize| rows of that dimension. Intermediates
+// of the chain are then only ever materialized at chunk size.
+std::unique_ptr<Pass> createFormStreamingChunksPass(int64_t chunkSize = 0);
+
 // Pass to collapse dimensions of Linalg Ops on tensor ops.
 std::unique_ptr<InterfacePass<mlir::FunctionOpInterface>>
 createCollapseDimensionsPass();
@@ -185,6 +190,12 @@ createDispatchWithTransformDialect(
 // Captures dynamic shape dimensions required by dispatch operands.
 std::unique_ptr<Pass> createCaptureDispatchDynamicDimsPass();
 
+// Specializes dispatches whose shapes depend on a single dynamic dimension for
+// each of |dimValues|. The original dispatch is kept as the fallback and the
+// variant is selected on the host by comparing the dimension at runtime.
+std::unique_ptr<Pass> createSpecializeDynamicDispatchesPass(
+    ArrayRef<int64_t> dimValues = {});
+
 // Outlines dispatch regions into executables.
 std::unique_ptr<OperationPass<mlir::ModuleOp>>
 createOutlineDispatchRegionsPass();
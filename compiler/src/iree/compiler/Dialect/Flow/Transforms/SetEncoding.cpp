@@ -258,6 +258,93 @@ struct FoldFillWithSetEncoding
   }
 };
 
+/// Pattern to move an `iree_linalg_ext.unset_encoding` operation past an
+/// elementwise `linalg.generic` consumer, i.e.
+///
+///   %0 = iree_linalg_ext.unset_encoding %src
+///       : tensor<..., #enc> -> tensor<...>
+///   %1 = linalg.generic ins(%0 : tensor<...>) outs(%init : tensor<...>)
+///
+/// becomes
+///
+///   %0 = tensor.empty() : tensor<..., #enc>
+///   %1 = linalg.generic ins(%src : tensor<..., #enc>) outs(%0 : ...)
+///   %2 = iree_linalg_ext.unset_encoding %1 : tensor<..., #enc> -> tensor<...>
+///
+/// The elementwise op then runs on the data-tiled layout of its producer and
+/// the `unset_encoding` moves towards the consumer, where it folds away if the
+/// consumer sets the same encoding again. The pattern only applies when no
+/// operand would need a new `set_encoding`, so it never adds a pack.
+struct PropagateUnsetEncodingThroughElementwise
+    : public OpRewritePattern<linalg::GenericOp> {
+  using OpRewritePattern<linalg::GenericOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(linalg::GenericOp genericOp,
+                                PatternRewriter &rewriter) const override {
+    if (!genericOp.hasTensorSemantics() || genericOp.hasIndexSemantics() ||
+        genericOp.getNumDpsInits() != 1 ||
+        genericOp.getNumParallelLoops() != genericOp.getNumLoops()) {
+      return failure();
+    }
+    if (!llvm::all_of(genericOp.getIndexingMapsArray(),
+                      [](AffineMap map) { return map.isIdentity(); })) {
+      return failure();
+    }
+
+    // All inputs must come out of an `unset_encoding` with the same encoded
+    // type.
+    RankedTensorType encodedType;
+    SmallVector<Value> encodedInputs;
+    for (OpOperand *operand : genericOp.getDpsInputOperands()) {
+      auto unsetEncodingOp =
+          operand->get().getDefiningOp<IREE::LinalgExt::UnsetEncodingOp>();
+      if (!unsetEncodingOp) return failure();
+      if (encodedType && unsetEncodingOp.getSourceType() != encodedType) {
+        return failure();
+      }
+      encodedType = unsetEncodingOp.getSourceType();
+      encodedInputs.push_back(unsetEncodingOp.getSource());
+    }
+    if (!encodedType) return failure();
+
+    // The init either comes out of an `unset_encoding` as well, or is not read
+    // by the payload and can be replaced by an empty tensor of the encoded
+    // type.
+    OpOperand *initOperand = genericOp.getDpsInitOperand(0);
+    auto initType = initOperand->get().getType().dyn_cast<RankedTensorType>();
+    if (!initType || initType.getShape() != encodedType.getShape() ||
+        initType.getElementType() != encodedType.getElementType()) {
+      return failure();
+    }
+    Location loc = genericOp.getLoc();
+    Value encodedInit;
+    if (auto unsetEncodingOp =
+            initOperand->get()
+                .getDefiningOp<IREE::LinalgExt::UnsetEncodingOp>()) {
+      if (unsetEncodingOp.getSourceType() != encodedType) return failure();
+      encodedInit = unsetEncodingOp.getSource();
+    } else if (!genericOp.payloadUsesValueFromOperand(initOperand)) {
+      SmallVector<OpFoldResult> dimValues =
+          tensor::createDimValues(rewriter, loc, initOperand->get());
+      encodedInit = rewriter.create<tensor::EmptyOp>(
+          loc, dimValues, encodedType.getElementType(),
+          encodedType.getEncoding());
+    } else {
+      return failure();
+    }
+
+    auto encodedGenericOp = rewriter.create<linalg::GenericOp>(
+        loc, encodedInit.getType(), encodedInputs, encodedInit,
+        genericOp.getIndexingMapsArray(), genericOp.getIteratorTypesArray());
+    rewriter.cloneRegionBefore(genericOp.getRegion(),
+                               encodedGenericOp.getRegion(),
+                               encodedGenericOp.getRegion().begin());
+    rewriter.replaceOpWithNewOp<IREE::LinalgExt::UnsetEncodingOp>(
+        genericOp, encodedGenericOp.getResult(0));
+    return success();
+  }
+};
+
 struct SetEncodingPass : public SetEncodingBase<SetEncodingPass> {
   void getDependentDialects(DialectRegistry &registry) const override {
     registry.insert<IREE::LinalgExt::IREELinalgExtDialect>();
@@ -273,7 +360,12 @@ void SetEncodingPass::runOnOperation() {
     RewritePatternSet patterns(context);
     patterns.insert<SetMatmulEncoding>(context, defaultPadding);
     linalg::FillOp::getCanonicalizationPatterns(patterns, context);
-    patterns.insert<FoldFillWithSetEncoding>(context);
+    patterns.insert<FoldFillWithSetEncoding,
+                    PropagateUnsetEncodingThroughElementwise>(context);
+    IREE::LinalgExt::SetEncodingOp::getCanonicalizationPatterns(patterns,
+                                                                context);
+    IREE::LinalgExt::UnsetEncodingOp::getCanonicalizationPatterns(patterns,
+                                                                  context);
     memref::populateResolveRankedShapeTypeResultDimsPatterns(patterns);
     if (failed(applyPatternsAndFoldGreedily(getOperation(),
                                             std::move(patterns)))) {
@@ -0,0 +1,188 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//===--------------- SpecializeDynamicDispatches.cpp ----------------------===//
+//
+// Emits statically-shaped variants of dynamically-shaped dispatches for a set
+// of hot dimension values alongside the original generic dispatch. Each
+// variant is its own dispatch (and after outlining its own executable export)
+// so codegen tiles and distributes it like any other static dispatch. The
+// variant to run is selected on the host by comparing the dynamic dimension
+// against each hot value before issuing the dispatch.
+//
+//===----------------------------------------------------------------------===//
+
+#include "iree/compiler/Dialect/Flow/IR/FlowOps.h"
+#include "iree/compiler/Dialect/Flow/Transforms/PassDetail.h"
+#include "iree/compiler/Dialect/Flow/Transforms/Passes.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/Support/Debug.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/ControlFlow/IR/ControlFlowOps.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/FunctionInterfaces.h"
+#include "mlir/IR/Matchers.h"
+
+#define DEBUG_TYPE "iree-flow-specialize-dynamic-dispatches"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace Flow {
+
+namespace {
+
+/// Returns the single dynamic dimension value that all operand and result
+/// shapes of |dispatchOp| depend on, or nullptr if there are none or more than
+/// one. Dispatches over a single dynamic extent (such as a sequence length) are
+/// by far the most common and specializing them yields one variant per value.
+static Value getSpecializableDim(DispatchWorkgroupsOp dispatchOp) {
+  llvm::SetVector<Value> dims;
+  dims.insert(dispatchOp.getArgumentDims().begin(),
+              dispatchOp.getArgumentDims().end());
+  dims.insert(dispatchOp.getResultDims().begin(),
+              dispatchOp.getResultDims().end());
+  if (dims.size() != 1) return nullptr;
+  Value dim = dims.front();
+  if (matchPattern(dim, m_Constant())) return nullptr;
+  return dim;
+}
+
+/// Clones |dispatchOp| at the current insertion point of |builder| with every
+/// use of |dim| (both at the dispatch site and inside the captured region)
+/// replaced by |value|. Canonicalization of the dispatch region then turns the
+/// dynamic tensor loads and stores into static ones.
+static DispatchWorkgroupsOp cloneWithConstantDim(
+    OpBuilder &builder, DispatchWorkgroupsOp dispatchOp, Value dim,
+    int64_t value) {
+  Location loc = dispatchOp.getLoc();
+  Value constantDim = builder.create<arith::ConstantIndexOp>(loc, value);
+  auto clonedOp = cast<DispatchWorkgroupsOp>(builder.clone(*dispatchOp));
+  clonedOp->replaceUsesOfWith(dim, constantDim);
+
+  Block &body = clonedOp.getWorkgroupBody().front();
+  auto bodyBuilder = OpBuilder::atBlockBegin(&body);
+  Value bodyConstantDim = nullptr;
+  for (auto [argument, blockArg] :
+       llvm::zip_equal(dispatchOp.getArguments(),
+                       clonedOp.getInputBlockArguments())) {
+    if (argument != dim || blockArg.use_empty()) continue;
+    if (!bodyConstantDim) {
+      bodyConstantDim =
+          bodyBuilder.create<arith::ConstantIndexOp>(blockArg.getLoc(), value);
+    }
+    blockArg.replaceAllUsesWith(bodyConstantDim);
+  }
+  return clonedOp;
+}
+
+/// Replaces |dispatchOp| with a chain of comparisons against |values| that
+/// branch to a specialized dispatch for each value and to the original
+/// dispatch otherwise:
+///
+///   %eq = arith.cmpi eq, %dim, %c128 : index
+///   cf.cond_br %eq, ^specialized_128, ^next
+/// ^specialized_128:
+///   %0 = flow.dispatch.workgroups[%c128](...) : (tensor<?xf32>{%c128}) ...
+///   cf.br ^continue(%0 : tensor<?xf32>)
+/// ^next:
+///   ...
+/// ^generic:
+///   %1 = flow.dispatch.workgroups[%dim](...) : (tensor<?xf32>{%dim}) ...
+///   cf.br ^continue(%1 : tensor<?xf32>)
+/// ^continue(%result: tensor<?xf32>):
+static void specializeDispatch(DispatchWorkgroupsOp dispatchOp, Value dim,
+                               ArrayRef<int64_t> values) {
+  Location loc = dispatchOp.getLoc();
+  Block *headBlock = dispatchOp->getBlock();
+  Region *region = headBlock->getParent();
+
+  // Isolate the original dispatch into its own block and route all of its
+  // results through the continuation block arguments.
+  Block *genericBlock = headBlock->splitBlock(dispatchOp);
+  Block *continueBlock =
+      genericBlock->splitBlock(std::next(dispatchOp->getIterator()));
+  SmallVector<Location> resultLocs(dispatchOp->getNumResults(), loc);
+  continueBlock->addArguments(dispatchOp->getResultTypes(), resultLocs);
+  for (auto [result, blockArg] : llvm::zip_equal(
+           dispatchOp.getResults(), continueBlock->getArguments())) {
+    result.replaceAllUsesWith(blockArg);
+  }
+  OpBuilder builder = OpBuilder::atBlockEnd(genericBlock);
+  builder.create<cf::BranchOp>(loc, continueBlock, dispatchOp.getResults());
+
+  Block *checkBlock = headBlock;
+  for (auto [index, value] : llvm::enumerate(values)) {
+    auto *specializedBlock = new Block();
+    region->getBlocks().insert(genericBlock->getIterator(), specializedBlock);
+    Block *nextBlock = genericBlock;
+    if (index + 1 < values.size()) {
+      nextBlock = new Block();
+      region->getBlocks().insert(genericBlock->getIterator(), nextBlock);
+    }
+
+    builder.setInsertionPointToEnd(checkBlock);
+    Value constantValue = builder.create<arith::ConstantIndexOp>(loc, value);
+    Value isMatch = builder.create<arith::CmpIOp>(
+        loc, arith::CmpIPredicate::eq, dim, constantValue);
+    builder.create<cf::CondBranchOp>(loc, isMatch, specializedBlock,
+                                     ValueRange{}, nextBlock, ValueRange{});
+
+    builder.setInsertionPointToEnd(specializedBlock);
+    auto specializedOp = cloneWithConstantDim(builder, dispatchOp, dim, value);
+    builder.create<cf::BranchOp>(loc, continueBlock,
+                                 specializedOp.getResults());
+
+    checkBlock = nextBlock;
+  }
+}
+
+struct SpecializeDynamicDispatchesPass
+    : public SpecializeDynamicDispatchesBase<SpecializeDynamicDispatchesPass> {
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<arith::ArithDialect, cf::ControlFlowDialect>();
+  }
+  SpecializeDynamicDispatchesPass(ArrayRef<int64_t> dimValues) {
+    this->dimValues = dimValues;
+  }
+
+  void runOnOperation() override {
+    // Deduplicate the requested values while preserving their order: earlier
+    // values are checked first at runtime and should be the hottest.
+    llvm::SetVector<int64_t> values;
+    for (int64_t value : dimValues) {
+      if (value > 0) values.insert(value);
+    }
+    if (values.empty()) return;
+
+    SmallVector<std::pair<DispatchWorkgroupsOp, Value>> worklist;
+    getOperation()->walk([&](DispatchWorkgroupsOp dispatchOp) {
+      // Selection branches on the host so the dispatch must be directly in a
+      // function body where new blocks can be formed.
+      if (!isa<FunctionOpInterface>(dispatchOp->getParentOp())) return;
+      if (Value dim = getSpecializableDim(dispatchOp)) {
+        worklist.push_back(std::make_pair(dispatchOp, dim));
+      }
+    });
+    for (auto [dispatchOp, dim] : worklist) {
+      LLVM_DEBUG(llvm::dbgs() << "specializing " << dispatchOp.getLoc()
+                              << " for " << values.size() << " values\n");
+      specializeDispatch(dispatchOp, dim, values.getArrayRef());
+    }
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<Pass> createSpecializeDynamicDispatchesPass(
+    ArrayRef<int64_t> dimValues) {
+  return std::make_unique<SpecializeDynamicDispatchesPass>(dimValues);
+}
+
+}  // namespace Flow
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
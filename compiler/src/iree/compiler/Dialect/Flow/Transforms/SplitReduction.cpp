@@ -14,6 +14,7 @@
 #include "iree-dialects/Dialect/LinalgExt/Transforms/Transforms.h"
 #include "iree/compiler/Dialect/Flow/Transforms/PassDetail.h"
 #include "iree/compiler/Dialect/Flow/Transforms/Passes.h"
+#include "iree/compiler/Dialect/HAL/IR/HALTypes.h"
 #include "mlir/Dialect/Affine/IR/AffineOps.h"
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/Dialect/Linalg/Transforms/Transforms.h"
@@ -29,11 +30,87 @@ static llvm::cl::opt<int64_t> splitReductionRatio(
     "iree-flow-split-matmul-reduction", llvm::cl::desc("split ratio"),
     llvm::cl::init(1));
 
+static llvm::cl::opt<int64_t> splitReductionTargetParallelism(
+    "iree-flow-split-reduction-target-parallelism",
+    llvm::cl::desc(
+        "Number of parallel workgroups (such as the core count of a CPU "
+        "target) that skinny reductions are split to fill. The split ratio of "
+        "each reduction is derived from this and the native vector size of "
+        "the targets. 0 disables splitting of non-matmul reductions."),
+    llvm::cl::init(0));
+
 static llvm::cl::list<int64_t> topkSplitReductionRatio(
     "iree-flow-topk-split-reduction",
     llvm::cl::desc("comma separated list of split ratios"),
     llvm::cl::CommaSeparated);
 
+// Native vector size in bytes assumed when no target specifies one.
+static constexpr int64_t kDefaultNativeVectorSizeInBytes = 16;
+
+// Minimum number of native vectors each partial reduction must cover so that
+// the split does not trade vector efficiency for parallelism.
+static constexpr int64_t kMinVectorsPerSplit = 8;
+
+/// Returns the smallest `native_vector_size` across all executable targets the
+/// |op| may be compiled for. Reductions are split conservatively so that each
+/// partial reduction stays vectorizable on every target.
+static int64_t getNativeVectorSizeInBytes(Operation *op) {
+  int64_t nativeVectorSize = 0;
+  for (auto targetAttr :
+       IREE::HAL::DeviceTargetAttr::lookupExecutableTargets(op)) {
+    auto configAttr = targetAttr.getConfiguration();
+    if (!configAttr) continue;
+    auto sizeAttr = configAttr.getAs<IntegerAttr>("native_vector_size");
+    if (!sizeAttr || sizeAttr.getInt() <= 0) continue;
+    nativeVectorSize = nativeVectorSize
+                           ? std::min(nativeVectorSize, sizeAttr.getInt())
+                           : sizeAttr.getInt();
+  }
+  return nativeVectorSize ? nativeVectorSize : kDefaultNativeVectorSizeInBytes;
+}
+
+/// Returns the split ratio for a reduction |op| such that the partial
+/// reductions produce about |targetParallelism| independent outputs, or 0 if
+/// the reduction already has enough parallelism or cannot be split profitably.
+/// The ratio must evenly divide the reduction size (a requirement of the
+/// upstream transformation) and leave each partial reduction with at least
+/// kMinVectorsPerSplit full vectors of work.
+static int64_t getCostModelSplitRatio(linalg::LinalgOp op,
+                                      int64_t targetParallelism,
+                                      int64_t nativeVectorSizeInBytes) {
+  if (targetParallelism <= 1) return 0;
+  if (op.getNumReductionLoops() != 1 || op.getNumDpsInits() != 1) return 0;
+
+  int64_t parallelSize = 1;
+  int64_t reductionSize = 0;
+  for (auto [range, iteratorType] : llvm::zip_equal(
+           op.getStaticLoopRanges(), op.getIteratorTypesArray())) {
+    if (ShapedType::isDynamic(range)) return 0;
+    if (linalg::isReductionIterator(iteratorType)) {
+      reductionSize = range;
+    } else {
+      parallelSize *= range;
+    }
+  }
+  if (parallelSize >= targetParallelism) return 0;
+
+  Type elementType = getElementTypeOrSelf(op.getDpsInitOperand(0)->get());
+  if (!elementType.isIntOrFloat()) return 0;
+  unsigned bitWidth = elementType.getIntOrFloatBitWidth();
+  int64_t vectorSize =
+      std::max<int64_t>(1, nativeVectorSizeInBytes * 8 / bitWidth);
+
+  int64_t desiredRatio = llvm::divideCeil(targetParallelism, parallelSize);
+  int64_t maxRatio = std::min(
+      desiredRatio, reductionSize / (vectorSize * kMinVectorsPerSplit));
+  for (int64_t ratio = maxRatio; ratio > 1; --ratio) {
+    if (reductionSize % ratio != 0) continue;
+    if ((reductionSize / ratio) % vectorSize != 0) continue;
+    return ratio;
+  }
+  return 0;
+}
+
 namespace {
 /// Pattern to wrap splitReduction transformation. This also propagates
 /// attributes to allow compilation info attribute to not be lost.
@@ -83,9 +160,12 @@ struct SplitReductionPass : public SplitReductionBase<SplitReductionPass> {
 
   void runOnOperation() override {
     if (splitReductionRatio.getValue() <= 1 &&
+        splitReductionTargetParallelism.getValue() <= 1 &&
         topkSplitReductionRatio.empty()) {
       return;
     }
+    int64_t nativeVectorSizeInBytes =
+        getNativeVectorSizeInBytes(getOperation());
 
     RewritePatternSet patterns(&getContext());
     patterns.add<LinalgSplitReduction>(
@@ -95,8 +175,15 @@ struct SplitReductionPass : public SplitReductionBase<SplitReductionPass> {
           // like a batch_matmul and can follow the same codegen.
           if (isa<linalg::MatmulOp>(op))
             return {int64_t(splitReductionRatio), 0, /*innerParallel=*/false};
-          // Currently disable spliting reduction for non-matmul op. This will
-          // get enabled after once tests are ready.
+          // Other reductions are only split when they cannot fill the target
+          // on their own, e.g. a global pool or a softmax denominator over a
+          // long sequence. The partial results get a new leading dimension
+          // and are combined by a second, much smaller reduction.
+          if (isa<linalg::GenericOp>(op)) {
+            int64_t ratio = getCostModelSplitRatio(
+                op, splitReductionTargetParallelism, nativeVectorSizeInBytes);
+            return {ratio, 0, /*innerParallel=*/false};
+          }
           return {int64_t(0), 0, /*innerParallel=*/false};
         },
         LinalgExt::LinalgTransformationFilter(
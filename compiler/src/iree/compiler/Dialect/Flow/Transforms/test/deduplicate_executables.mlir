@@ -376,3 +376,50 @@ flow.executable @block_successors_ex_with_swapped_cond_br {
     }
   }
 }
+
+// -----
+
+// Executables with the same ops and types but different use-def structure hash
+// to the same bucket and must still be kept separate.
+
+// CHECK-LABEL: flow.executable public @same_hash_executables_ex_0
+flow.executable @same_hash_executables_ex_0 {
+  flow.executable.export @same_hash_executables_entry_0
+  builtin.module {
+    func.func @same_hash_executables_entry_0(%arg0: tensor<4xf32>, %arg1: tensor<4xf32>) -> tensor<4xf32> {
+      %0 = arith.subf %arg0, %arg1 : tensor<4xf32>
+      return %0 : tensor<4xf32>
+    }
+  }
+}
+// CHECK-LABEL: flow.executable public @same_hash_executables_ex_1
+flow.executable @same_hash_executables_ex_1 {
+  flow.executable.export @same_hash_executables_entry_1
+  builtin.module {
+    func.func @same_hash_executables_entry_1(%arg0: tensor<4xf32>, %arg1: tensor<4xf32>) -> tensor<4xf32> {
+      %0 = arith.subf %arg1, %arg0 : tensor<4xf32>
+      return %0 : tensor<4xf32>
+    }
+  }
+}
+// CHECK-NOT: flow.executable public @same_hash_executables_ex_2
+flow.executable @same_hash_executables_ex_2 {
+  flow.executable.export @same_hash_executables_entry_2
+  builtin.module {
+    func.func @same_hash_executables_entry_2(%arg0: tensor<4xf32>, %arg1: tensor<4xf32>) -> tensor<4xf32> {
+      %0 = arith.subf %arg1, %arg0 : tensor<4xf32>
+      return %0 : tensor<4xf32>
+    }
+  }
+}
+// CHECK-LABEL: func.func @same_hash_executables
+func.func @same_hash_executables(%arg0: tensor<4xf32>, %arg1: tensor<4xf32>) -> (tensor<4xf32>, tensor<4xf32>, tensor<4xf32>) {
+  %c4 = arith.constant 4 : index
+  // CHECK: flow.dispatch @same_hash_executables_ex_0::@same_hash_executables_entry_0
+  %0 = flow.dispatch @same_hash_executables_ex_0::@same_hash_executables_entry_0[%c4] (%arg0, %arg1) : (tensor<4xf32>, tensor<4xf32>) -> tensor<4xf32>
+  // CHECK: flow.dispatch @same_hash_executables_ex_1::@same_hash_executables_entry_1
+  %1 = flow.dispatch @same_hash_executables_ex_1::@same_hash_executables_entry_1[%c4] (%arg0, %arg1) : (tensor<4xf32>, tensor<4xf32>) -> tensor<4xf32>
+  // CHECK: flow.dispatch @same_hash_executables_ex_1::@same_hash_executables_entry_1
+  %2 = flow.dispatch @same_hash_executables_ex_2::@same_hash_executables_entry_2[%c4] (%arg0, %arg1) : (tensor<4xf32>, tensor<4xf32>) -> tensor<4xf32>
+  return %0, %1, %2 : tensor<4xf32>, tensor<4xf32>, tensor<4xf32>
+}
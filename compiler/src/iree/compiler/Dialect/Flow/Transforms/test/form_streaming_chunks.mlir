@@ -0,0 +1,148 @@
+// RUN: iree-opt --split-input-file --pass-pipeline="builtin.module(func.func(iree-flow-form-streaming-chunks{chunk-size=128}))" %s | FileCheck %s
+
+func.func @elementwise_row_reduction(%arg0: tensor<1024x256xf32>, %arg1: tensor<256xf32>) -> tensor<1024xf32> {
+  %cst = arith.constant 0.000000e+00 : f32
+  %0 = tensor.empty() : tensor<1024x256xf32>
+  %1 = linalg.generic {indexing_maps = [affine_map<(d0, d1) -> (d0, d1)>, affine_map<(d0, d1) -> (d1)>, affine_map<(d0, d1) -> (d0, d1)>], iterator_types = ["parallel", "parallel"]} ins(%arg0, %arg1 : tensor<1024x256xf32>, tensor<256xf32>) outs(%0 : tensor<1024x256xf32>) {
+  ^bb0(%in: f32, %bias: f32, %out: f32):
+    %4 = arith.addf %in, %bias : f32
+    %5 = math.exp %4 : f32
+    linalg.yield %5 : f32
+  } -> tensor<1024x256xf32>
+  %2 = tensor.empty() : tensor<1024xf32>
+  %3 = linalg.fill ins(%cst : f32) outs(%2 : tensor<1024xf32>) -> tensor<1024xf32>
+  %4 = linalg.generic {indexing_maps = [affine_map<(d0, d1) -> (d0, d1)>, affine_map<(d0, d1) -> (d0)>], iterator_types = ["parallel", "reduction"]} ins(%1 : tensor<1024x256xf32>) outs(%3 : tensor<1024xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %6 = arith.addf %in, %out : f32
+    linalg.yield %6 : f32
+  } -> tensor<1024xf32>
+  return %4 : tensor<1024xf32>
+}
+
+// CHECK-LABEL: func.func @elementwise_row_reduction
+//  CHECK-SAME:     %[[ARG0:[a-zA-Z0-9]+]]: tensor<1024x256xf32>
+//  CHECK-SAME:     %[[ARG1:[a-zA-Z0-9]+]]: tensor<256xf32>
+//   CHECK-NOT:   scf.for
+//       CHECK:   cf.br ^[[HEADER:.+]](%{{.+}}, %{{.+}} : index, tensor<1024xf32>)
+//       CHECK: ^[[HEADER]](%[[IV:.+]]: index, %[[ACC:.+]]: tensor<1024xf32>):
+//       CHECK:   cf.cond_br %{{.+}}, ^[[BODY:.+]], ^[[EXIT:.+]]
+//       CHECK: ^[[BODY]]:
+//       CHECK:   %[[CHUNK:.+]] = tensor.extract_slice %[[ARG0]][%[[IV]], 0] [128, 256] [1, 1]
+//       CHECK:   %[[EXP:.+]] = linalg.generic
+//  CHECK-SAME:       ins(%[[CHUNK]], %[[ARG1]] : tensor<128x256xf32>, tensor<256xf32>)
+//       CHECK:   %[[SUM:.+]] = linalg.generic
+//  CHECK-SAME:       ins(%[[EXP]] : tensor<128x256xf32>)
+//  CHECK-SAME:       -> tensor<128xf32>
+//       CHECK:   tensor.insert_slice %[[SUM]] into %[[ACC]][%[[IV]]] [128] [1]
+//       CHECK: ^[[EXIT]]:
+//       CHECK:   return %[[ACC]]
+
+// -----
+
+// Reductions across the leading dimension cannot be chunked.
+
+func.func @leading_reduction(%arg0: tensor<1024x256xf32>) -> tensor<256xf32> {
+  %cst = arith.constant 0.000000e+00 : f32
+  %0 = tensor.empty() : tensor<256xf32>
+  %1 = linalg.fill ins(%cst : f32) outs(%0 : tensor<256xf32>) -> tensor<256xf32>
+  %2 = linalg.generic {indexing_maps = [affine_map<(d0, d1) -> (d1, d0)>, affine_map<(d0, d1) -> (d0)>], iterator_types = ["parallel", "reduction"]} ins(%arg0 : tensor<1024x256xf32>) outs(%1 : tensor<256xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %3 = arith.addf %in, %out : f32
+    linalg.yield %3 : f32
+  } -> tensor<256xf32>
+  return %2 : tensor<256xf32>
+}
+
+// CHECK-LABEL: func.func @leading_reduction
+//   CHECK-NOT:   cf.cond_br
+//       CHECK:   linalg.generic
+//  CHECK-SAME:       ins(%{{.+}} : tensor<1024x256xf32>)
+
+// -----
+
+// Producers that cannot be chunked are computed once ahead of the chunk loop
+// instead of being recomputed by every chunk.
+
+func.func @batch_reduction_producer(%arg0: tensor<1024x256xf32>) -> tensor<1024xf32> {
+  %cst = arith.constant 0.000000e+00 : f32
+  %0 = tensor.empty() : tensor<256xf32>
+  %1 = linalg.fill ins(%cst : f32) outs(%0 : tensor<256xf32>) -> tensor<256xf32>
+  %2 = linalg.generic {indexing_maps = [affine_map<(d0, d1) -> (d1, d0)>, affine_map<(d0, d1) -> (d0)>], iterator_types = ["parallel", "reduction"]} ins(%arg0 : tensor<1024x256xf32>) outs(%1 : tensor<256xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %8 = arith.addf %in, %out : f32
+    linalg.yield %8 : f32
+  } -> tensor<256xf32>
+  %3 = tensor.empty() : tensor<1024x256xf32>
+  %4 = linalg.generic {indexing_maps = [affine_map<(d0, d1) -> (d0, d1)>, affine_map<(d0, d1) -> (d1)>, affine_map<(d0, d1) -> (d0, d1)>], iterator_types = ["parallel", "parallel"]} ins(%arg0, %2 : tensor<1024x256xf32>, tensor<256xf32>) outs(%3 : tensor<1024x256xf32>) {
+  ^bb0(%in: f32, %sum: f32, %out: f32):
+    %8 = arith.subf %in, %sum : f32
+    linalg.yield %8 : f32
+  } -> tensor<1024x256xf32>
+  %5 = tensor.empty() : tensor<1024xf32>
+  %6 = linalg.fill ins(%cst : f32) outs(%5 : tensor<1024xf32>) -> tensor<1024xf32>
+  %7 = linalg.generic {indexing_maps = [affine_map<(d0, d1) -> (d0, d1)>, affine_map<(d0, d1) -> (d0)>], iterator_types = ["parallel", "reduction"]} ins(%4 : tensor<1024x256xf32>) outs(%6 : tensor<1024xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %8 = arith.addf %in, %out : f32
+    linalg.yield %8 : f32
+  } -> tensor<1024xf32>
+  return %7 : tensor<1024xf32>
+}
+
+// CHECK-LABEL: func.func @batch_reduction_producer
+//  CHECK-SAME:     %[[ARG0:[a-zA-Z0-9]+]]: tensor<1024x256xf32>
+//       CHECK:   %[[BATCH_SUM:.+]] = linalg.generic
+//  CHECK-SAME:       ins(%[[ARG0]] : tensor<1024x256xf32>)
+//  CHECK-SAME:       -> tensor<256xf32>
+//       CHECK:   cf.br ^[[HEADER:.+]](
+//       CHECK:   cf.cond_br %{{.+}}, ^[[BODY:.+]], ^[[EXIT:.+]]
+//       CHECK: ^[[BODY]]:
+//   CHECK-NOT:   -> tensor<256xf32>
+//       CHECK:   %[[CHUNK:.+]] = tensor.extract_slice %[[ARG0]]
+//       CHECK:   linalg.generic
+//  CHECK-SAME:       ins(%[[CHUNK]], %[[BATCH_SUM]] : tensor<128x256xf32>, tensor<256xf32>)
+//       CHECK:   linalg.generic
+//  CHECK-SAME:       -> tensor<128xf32>
+//       CHECK: ^[[EXIT]]:
+
+// -----
+
+// Chunkable producers that are read along a dimension other than their leading
+// one (here broadcast along the batch) do not line up with the chunks and are
+// computed once ahead of the chunk loop.
+
+func.func @inner_dim_producer(%arg0: tensor<1024x256xf32>, %arg1: tensor<256xf32>) -> tensor<1024x256xf32> {
+  %0 = tensor.empty() : tensor<256xf32>
+  %1 = linalg.generic {indexing_maps = [affine_map<(d0) -> (d0)>, affine_map<(d0) -> (d0)>], iterator_types = ["parallel"]} ins(%arg1 : tensor<256xf32>) outs(%0 : tensor<256xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %6 = math.exp %in : f32
+    linalg.yield %6 : f32
+  } -> tensor<256xf32>
+  %2 = tensor.empty() : tensor<1024x256xf32>
+  %3 = linalg.generic {indexing_maps = [affine_map<(d0, d1) -> (d0, d1)>, affine_map<(d0, d1) -> (d0, d1)>], iterator_types = ["parallel", "parallel"]} ins(%arg0 : tensor<1024x256xf32>) outs(%2 : tensor<1024x256xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %6 = math.absf %in : f32
+    linalg.yield %6 : f32
+  } -> tensor<1024x256xf32>
+  %4 = linalg.generic {indexing_maps = [affine_map<(d0, d1) -> (d0, d1)>, affine_map<(d0, d1) -> (d1)>, affine_map<(d0, d1) -> (d0, d1)>], iterator_types = ["parallel", "parallel"]} ins(%3, %1 : tensor<1024x256xf32>, tensor<256xf32>) outs(%2 : tensor<1024x256xf32>) {
+  ^bb0(%in: f32, %scale: f32, %out: f32):
+    %6 = arith.mulf %in, %scale : f32
+    linalg.yield %6 : f32
+  } -> tensor<1024x256xf32>
+  return %4 : tensor<1024x256xf32>
+}
+
+// CHECK-LABEL: func.func @inner_dim_producer
+//  CHECK-SAME:     %[[ARG0:[a-zA-Z0-9]+]]: tensor<1024x256xf32>
+//  CHECK-SAME:     %[[ARG1:[a-zA-Z0-9]+]]: tensor<256xf32>
+//       CHECK:   %[[SCALE:.+]] = linalg.generic
+//  CHECK-SAME:       ins(%[[ARG1]] : tensor<256xf32>)
+//       CHECK:   cf.br ^[[HEADER:.+]](
+//       CHECK:   cf.cond_br %{{.+}}, ^[[BODY:.+]], ^[[EXIT:.+]]
+//       CHECK: ^[[BODY]]:
+//   CHECK-NOT:   ins(%[[ARG1]]
+//       CHECK:   %[[CHUNK:.+]] = tensor.extract_slice %[[ARG0]][%{{.+}}, 0] [128, 256] [1, 1]
+//       CHECK:   %[[ABS:.+]] = linalg.generic
+//  CHECK-SAME:       ins(%[[CHUNK]] : tensor<128x256xf32>)
+//       CHECK:   linalg.generic
+//  CHECK-SAME:       ins(%[[ABS]], %[[SCALE]] : tensor<128x256xf32>, tensor<256xf32>)
+//       CHECK: ^[[EXIT]]:
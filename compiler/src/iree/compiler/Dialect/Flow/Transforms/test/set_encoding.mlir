@@ -156,3 +156,38 @@ func.func @fold_fill_with_tensor_pad(%arg0 : index, %arg1 : index, %arg2 : index
 //      CHECK:   %[[FILL:.+]] = linalg.fill
 // CHECK-SAME:       outs(%[[EMPTY]] :
 //      CHECK:   return %[[FILL]]
+
+// -----
+
+func.func @matmul_relu_matmul(%arg0 : tensor<128x256xf32>,
+    %arg1 : tensor<256x512xf32>, %arg2 : tensor<128x512xf32>,
+    %arg3 : tensor<128x512xf32>, %arg4 : tensor<512x512xf32>)
+    -> tensor<128x512xf32> {
+  %cst = arith.constant 0.0 : f32
+  %0 = linalg.matmul ins(%arg0, %arg1 : tensor<128x256xf32>, tensor<256x512xf32>)
+      outs(%arg2 : tensor<128x512xf32>) -> tensor<128x512xf32>
+  %1 = tensor.empty() : tensor<128x512xf32>
+  %2 = linalg.generic {
+      indexing_maps = [affine_map<(d0, d1) -> (d0, d1)>, affine_map<(d0, d1) -> (d0, d1)>],
+      iterator_types = ["parallel", "parallel"]}
+      ins(%0 : tensor<128x512xf32>) outs(%1 : tensor<128x512xf32>) {
+    ^bb0(%b0 : f32, %b1 : f32):
+      %3 = arith.maxf %b0, %cst : f32
+      linalg.yield %3 : f32
+  } -> tensor<128x512xf32>
+  %4 = linalg.matmul ins(%arg3, %arg4 : tensor<128x512xf32>, tensor<512x512xf32>)
+      outs(%2 : tensor<128x512xf32>) -> tensor<128x512xf32>
+  return %4 : tensor<128x512xf32>
+}
+//      CHECK: func @matmul_relu_matmul(
+//      CHECK:   %[[MATMUL0:.+]] = linalg.matmul
+// CHECK-SAME:       -> tensor<128x512xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RESULT>>
+//      CHECK:   %[[EMPTY:.+]] = tensor.empty() : tensor<128x512xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RESULT>>
+//      CHECK:   %[[RELU:.+]] = linalg.generic
+// CHECK-SAME:       ins(%[[MATMUL0]] : tensor<128x512xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RESULT>>)
+// CHECK-SAME:       outs(%[[EMPTY]] : tensor<128x512xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RESULT>>)
+//  CHECK-NOT:   iree_linalg_ext.unset_encoding %[[RELU]]
+//      CHECK:   %[[MATMUL1:.+]] = linalg.matmul
+// CHECK-SAME:       outs(%[[RELU]] : tensor<128x512xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RESULT>>)
+//      CHECK:   %[[RESULT:.+]] = iree_linalg_ext.unset_encoding %[[MATMUL1]]
+//      CHECK:   return %[[RESULT]]
@@ -0,0 +1,60 @@
+// RUN: iree-opt --split-input-file --pass-pipeline="builtin.module(func.func(iree-flow-specialize-dynamic-dispatches{dim-values=128,256}))" %s | FileCheck %s
+
+func.func @single_dynamic_dim(%arg0: tensor<?x4xf32>, %dim: index) -> tensor<?x4xf32> {
+  %0 = flow.dispatch.workgroups[%dim](%arg0, %dim) : (tensor<?x4xf32>{%dim}, index) -> tensor<?x4xf32>{%dim} =
+      (%arg0_capture: !flow.dispatch.tensor<readonly:tensor<?x4xf32>>, %dim_capture: index, %ret0: !flow.dispatch.tensor<writeonly:tensor<?x4xf32>>) {
+    %t = flow.dispatch.tensor.load %arg0_capture, offsets=[0, 0], sizes=[%dim_capture, 4], strides=[1, 1] : !flow.dispatch.tensor<readonly:tensor<?x4xf32>>{%dim_capture} -> tensor<?x4xf32>
+    flow.dispatch.tensor.store %t, %ret0, offsets=[0, 0], sizes=[%dim_capture, 4], strides=[1, 1] : tensor<?x4xf32> -> !flow.dispatch.tensor<writeonly:tensor<?x4xf32>>{%dim_capture}
+    flow.return
+  } count(%x_capture: index) -> (index, index, index) {
+    %c1 = arith.constant 1 : index
+    flow.return %x_capture, %c1, %c1 : index, index, index
+  }
+  return %0 : tensor<?x4xf32>
+}
+
+// CHECK-LABEL: func.func @single_dynamic_dim
+//  CHECK-SAME:   (%[[ARG0:.+]]: tensor<?x4xf32>, %[[DIM:.+]]: index)
+//       CHECK:   %[[C128:.+]] = arith.constant 128 : index
+//       CHECK:   %[[IS_128:.+]] = arith.cmpi eq, %[[DIM]], %[[C128]] : index
+//       CHECK:   cf.cond_br %[[IS_128]], ^[[SPEC_128:.+]], ^[[CHECK_256:.+]]
+//       CHECK: ^[[SPEC_128]]:
+//       CHECK:   %[[SPEC_DIM_128:.+]] = arith.constant 128 : index
+//       CHECK:   %[[RESULT_128:.+]] = flow.dispatch.workgroups[%[[SPEC_DIM_128]]](%[[ARG0]], %[[SPEC_DIM_128]])
+//  CHECK-SAME:       : (tensor<?x4xf32>{%[[SPEC_DIM_128]]}, index) -> tensor<?x4xf32>{%[[SPEC_DIM_128]]}
+//       CHECK:     %[[INNER_128:.+]] = arith.constant 128 : index
+//       CHECK:     flow.dispatch.tensor.load {{.+}} sizes = [%[[INNER_128]], 4]
+//       CHECK:   cf.br ^[[CONTINUE:.+]](%[[RESULT_128]] : tensor<?x4xf32>)
+//       CHECK: ^[[CHECK_256]]:
+//       CHECK:   %[[C256:.+]] = arith.constant 256 : index
+//       CHECK:   %[[IS_256:.+]] = arith.cmpi eq, %[[DIM]], %[[C256]] : index
+//       CHECK:   cf.cond_br %[[IS_256]], ^[[SPEC_256:.+]], ^[[GENERIC:.+]]
+//       CHECK: ^[[SPEC_256]]:
+//       CHECK:   flow.dispatch.workgroups
+//  CHECK-SAME:       : (tensor<?x4xf32>{%{{.+}}}, index) -> tensor<?x4xf32>{%{{.+}}}
+//       CHECK:   cf.br ^[[CONTINUE]]
+//       CHECK: ^[[GENERIC]]:
+//       CHECK:   %[[RESULT:.+]] = flow.dispatch.workgroups[%[[DIM]]](%[[ARG0]], %[[DIM]])
+//       CHECK:   cf.br ^[[CONTINUE]](%[[RESULT]] : tensor<?x4xf32>)
+//       CHECK: ^[[CONTINUE]](%[[MERGED:.+]]: tensor<?x4xf32>):
+//       CHECK:   return %[[MERGED]]
+
+// -----
+
+// Dispatches depending on more than one dynamic dimension are left generic.
+
+func.func @multiple_dynamic_dims(%arg0: tensor<?x?xf32>, %dim0: index, %dim1: index) -> tensor<?x?xf32> {
+  %c1 = arith.constant 1 : index
+  %0 = flow.dispatch.workgroups[%c1](%arg0, %dim0, %dim1) : (tensor<?x?xf32>{%dim0, %dim1}, index, index) -> %arg0{%dim0, %dim1} =
+      (%arg0_capture: !flow.dispatch.tensor<readwrite:tensor<?x?xf32>>, %dim0_capture: index, %dim1_capture: index) {
+    flow.return
+  } count(%x_capture: index) -> (index, index, index) {
+    flow.return %x_capture, %x_capture, %x_capture : index, index, index
+  }
+  return %0 : tensor<?x?xf32>
+}
+
+// CHECK-LABEL: func.func @multiple_dynamic_dims
+//   CHECK-NOT:   cf.cond_br
+//       CHECK:   flow.dispatch.workgroups
+//   CHECK-NOT:   flow.dispatch.workgroups
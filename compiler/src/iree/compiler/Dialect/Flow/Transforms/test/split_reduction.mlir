@@ -0,0 +1,70 @@
+// RUN: iree-opt --split-input-file --iree-flow-split-reduction-ops --iree-flow-split-reduction-target-parallelism=16 %s | FileCheck %s
+
+// Skinny reductions are split so that the partial reductions fill the target
+// parallelism: 2 outputs * 8 partial sums = 16. Each partial sum covers 2048
+// elements which is a multiple of the default 4 x f32 native vector.
+
+func.func @skinny_reduction(%arg0: tensor<2x16384xf32>) -> tensor<2xf32> {
+  %cst = arith.constant 0.000000e+00 : f32
+  %0 = tensor.empty() : tensor<2xf32>
+  %1 = linalg.fill ins(%cst : f32) outs(%0 : tensor<2xf32>) -> tensor<2xf32>
+  %2 = linalg.generic {indexing_maps = [affine_map<(d0, d1) -> (d0, d1)>, affine_map<(d0, d1) -> (d0)>], iterator_types = ["parallel", "reduction"]} ins(%arg0 : tensor<2x16384xf32>) outs(%1 : tensor<2xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %3 = arith.addf %in, %out : f32
+    linalg.yield %3 : f32
+  } -> tensor<2xf32>
+  return %2 : tensor<2xf32>
+}
+
+// CHECK-LABEL: func.func @skinny_reduction
+//  CHECK-SAME:   %[[ARG0:[a-zA-Z0-9]+]]: tensor<2x16384xf32>
+//       CHECK:   %[[EXPANDED:.+]] = tensor.expand_shape %[[ARG0]]
+//  CHECK-SAME:       tensor<2x16384xf32> into tensor<2x8x2048xf32>
+//       CHECK:   %[[PARTIAL:.+]] = linalg.generic
+//  CHECK-SAME:       ins(%[[EXPANDED]] : tensor<2x8x2048xf32>)
+//  CHECK-SAME:       outs(%{{.+}} : tensor<8x2xf32>)
+//       CHECK:   %[[RESULT:.+]] = linalg.generic
+//  CHECK-SAME:       ins(%[[PARTIAL]] : tensor<8x2xf32>)
+//  CHECK-SAME:       outs(%{{.+}} : tensor<2xf32>)
+//       CHECK:   return %[[RESULT]]
+
+// -----
+
+// Reductions with enough parallel outputs are left as is.
+
+func.func @wide_reduction(%arg0: tensor<64x16384xf32>) -> tensor<64xf32> {
+  %cst = arith.constant 0.000000e+00 : f32
+  %0 = tensor.empty() : tensor<64xf32>
+  %1 = linalg.fill ins(%cst : f32) outs(%0 : tensor<64xf32>) -> tensor<64xf32>
+  %2 = linalg.generic {indexing_maps = [affine_map<(d0, d1) -> (d0, d1)>, affine_map<(d0, d1) -> (d0)>], iterator_types = ["parallel", "reduction"]} ins(%arg0 : tensor<64x16384xf32>) outs(%1 : tensor<64xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %3 = arith.addf %in, %out : f32
+    linalg.yield %3 : f32
+  } -> tensor<64xf32>
+  return %2 : tensor<64xf32>
+}
+
+// CHECK-LABEL: func.func @wide_reduction
+//   CHECK-NOT:   tensor.expand_shape
+//       CHECK:   linalg.generic
+//  CHECK-SAME:       ins(%{{.+}} : tensor<64x16384xf32>)
+
+// -----
+
+// Reductions too small to give each partial sum enough vectors of work are not
+// split.
+
+func.func @small_reduction(%arg0: tensor<2x32xf32>) -> tensor<2xf32> {
+  %cst = arith.constant 0.000000e+00 : f32
+  %0 = tensor.empty() : tensor<2xf32>
+  %1 = linalg.fill ins(%cst : f32) outs(%0 : tensor<2xf32>) -> tensor<2xf32>
+  %2 = linalg.generic {indexing_maps = [affine_map<(d0, d1) -> (d0, d1)>, affine_map<(d0, d1) -> (d0)>], iterator_types = ["parallel", "reduction"]} ins(%arg0 : tensor<2x32xf32>) outs(%1 : tensor<2xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %3 = arith.addf %in, %out : f32
+    linalg.yield %3 : f32
+  } -> tensor<2xf32>
+  return %2 : tensor<2xf32>
+}
+
+// CHECK-LABEL: func.func @small_reduction
+//   CHECK-NOT:   tensor.expand_shape
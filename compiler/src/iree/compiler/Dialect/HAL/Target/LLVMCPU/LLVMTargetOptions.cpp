@@ -207,6 +207,14 @@ LLVMTargetOptions getLLVMTargetOptionsFromFlags() {
     targetOptions.target.triple = targetTriple.str();
   }
 
+  static llvm::cl::opt<bool> clEmbeddedPrelink(
+      "iree-llvmcpu-embedded-prelink",
+      llvm::cl::desc("Links embedded ELFs at a preferred base address with "
+                     "relocations pre-applied so that the runtime loader can "
+                     "skip relocation when the address is available"),
+      llvm::cl::init(targetOptions.embeddedPrelink));
+  targetOptions.embeddedPrelink = clEmbeddedPrelink;
+
   static llvm::cl::opt<bool> clLinkStatic(
       "iree-llvmcpu-link-static",
       llvm::cl::desc(
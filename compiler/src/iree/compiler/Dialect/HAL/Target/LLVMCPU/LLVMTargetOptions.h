@@ -66,6 +66,12 @@ struct LLVMTargetOptions {
   // loader, such as WebAssembly.
   bool linkEmbedded = true;
 
+  // Link embedded ELFs at a preferred base address with all dynamic
+  // relocations pre-applied. When the runtime loader is able to place the
+  // image at that address it skips relocation entirely; otherwise the
+  // relocations are applied as usual. Only used on 64-bit targets.
+  bool embeddedPrelink = false;
+
   // Link any required runtime libraries into the produced binaries statically.
   // This increases resulting binary size but enables the binaries to be used on
   // any machine without requiring matching system libraries to be installed.
@@ -32,6 +32,8 @@ namespace HAL {
 //   the spec and included for compatibility.
 // - No lazy binding; all symbols must be resolved on load.
 // - GNU_RELRO is optional but used here as we don't support lazy binding.
+// - Optionally (--iree-llvmcpu-embedded-prelink) linked at a preferred base
+//   address with relocations pre-applied so the loader can skip relocation.
 //
 // We allow debug information to be included in the ELFs however we don't
 // currently have a use for it at runtime. When unstripped we can possibly feed
@@ -103,6 +105,22 @@ class EmbeddedLinkerTool : public LinkerTool {
     return success();
   }
 
+  // Returns the preferred base address for a prelinked library. Each library
+  // gets a 2MB-aligned slot derived from its name so that modules loaded into
+  // the same process are unlikely to collide. The range stays within a 39-bit
+  // address space as used by some aarch64 and riscv64 kernels. A stable FNV-1a
+  // hash is used so that outputs are reproducible across compiler runs.
+  static uint64_t getPrelinkBaseAddress(StringRef libraryName) {
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : libraryName) {
+      hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+    }
+    constexpr uint64_t kRangeBase = 0x2000000000ull;  // 128GB
+    constexpr uint64_t kSlotSize = 2 * 1024 * 1024;
+    constexpr uint64_t kSlotCount = 64 * 1024;
+    return kRangeBase + (hash % kSlotCount) * kSlotSize;
+  }
+
   std::optional<Artifacts> linkDynamicLibrary(
       StringRef libraryName, ArrayRef<Artifact> objectFiles) override {
     Artifacts artifacts;
@@ -180,6 +198,18 @@ class EmbeddedLinkerTool : public LinkerTool {
     // runtime loader).
     flags.push_back("--hash-style=sysv");
 
+    // Link at a preferred base with the dynamic relocations written into the
+    // output as resolved for that base. The relocation tables are retained so
+    // that the loader can still relocate when the base is unavailable.
+    // 32-bit targets have too little address space to reserve a range for
+    // this and use REL relocations that are cheap to apply anyway.
+    if (targetOptions.embeddedPrelink && targetTriple.isArch64Bit()) {
+      flags.push_back(llvm::formatv("--image-base={0:x}",
+                                    getPrelinkBaseAddress(libraryName))
+                          .str());
+      flags.push_back("--apply-dynamic-relocs");
+    }
+
     // Strip debug information (only, no relocations) when not requested.
     if (!targetOptions.debugSymbols) {
       flags.push_back("--strip-debug");
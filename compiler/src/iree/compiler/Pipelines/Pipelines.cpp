@@ -91,7 +91,7 @@ void buildIREEVMTransformPassPipeline(
     IREE::ABI::buildTransformPassPipeline(passManager, invocationOptions);
   }
   if (bindingOptions.tflite) {
-    IREE::TFLite::buildTransformPassPipeline(passManager);
+    IREE::TFLite::buildTransformPassPipeline(passManager, invocationOptions);
   }
   IREE_TRACE_ADD_END_FRAME_PASS(passManager, "ABI");
   if (compileTo == IREEVMPipelinePhase::ABI) return;  // early-exit
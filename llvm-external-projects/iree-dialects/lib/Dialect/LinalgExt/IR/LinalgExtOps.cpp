@@ -2695,6 +2695,23 @@ LogicalResult SetEncodingOp::verify() {
   return success();
 }
 
+/// Rewrites `set_encoding(unset_encoding(%x))` to `%x` when the encoding being
+/// set is the one that was just removed. This cancels the unpack/pack round
+/// trip between two ops that both operate on the same data-tiled layout.
+/// This is a canonicalization rather than a folder so that materializing
+/// the encodings (which is a dialect conversion) still lowers each op
+/// individually.
+LogicalResult SetEncodingOp::canonicalize(SetEncodingOp op,
+                                          PatternRewriter &rewriter) {
+  auto unsetEncodingOp = op.getSource().getDefiningOp<UnsetEncodingOp>();
+  if (!unsetEncodingOp ||
+      unsetEncodingOp.getSourceType() != op.getResultType()) {
+    return failure();
+  }
+  rewriter.replaceOp(op, unsetEncodingOp.getSource());
+  return success();
+}
+
 LogicalResult SetEncodingOp::reifyResultShapes(
     OpBuilder &builder, ReifiedRankedShapedTypeDims &reifiedReturnShapes) {
   OpBuilder::InsertionGuard g(builder);
@@ -2733,6 +2750,16 @@ LogicalResult UnsetEncodingOp::verify() {
   return success();
 }
 
+/// Rewrites `unset_encoding(set_encoding(%x))` to `%x`.
+LogicalResult UnsetEncodingOp::canonicalize(UnsetEncodingOp op,
+                                            PatternRewriter &rewriter) {
+  auto setEncodingOp = op.getSource().getDefiningOp<SetEncodingOp>();
+  if (!setEncodingOp || setEncodingOp.getSourceType() != op.getResultType())
+    return failure();
+  rewriter.replaceOp(op, setEncodingOp.getSource());
+  return success();
+}
+
 LogicalResult UnsetEncodingOp::reifyResultShapes(
     OpBuilder &builder, ReifiedRankedShapedTypeDims &reifiedReturnShapes) {
   OpBuilder::InsertionGuard g(builder);
@@ -235,6 +235,53 @@ lowerOpWithEncoding(RewriterBase &rewriter, linalg::FillOp fillOp,
   return materializedFillOp;
 }
 
+/// Utility method to convert an elementwise `linalg.generic` whose operands all
+/// have the same encoding to a `linalg.generic` on the materialized types. The
+/// materialized layout only permutes and tiles the iteration space, so an
+/// elementwise op can run directly on the packed tensors with identity
+/// indexing maps over the packed rank. This lets elementwise consumers of a
+/// data-tiled op avoid an unpack/pack round trip.
+static FailureOr<Operation *>
+lowerOpWithEncoding(RewriterBase &rewriter, linalg::GenericOp genericOp,
+                    ValueRange convertedInputOperands,
+                    ValueRange convertedOutputOperands, MaterializeEncodingFn,
+                    MaterializeEncodingValueFn) {
+  if (!genericOp.hasTensorSemantics() || genericOp.hasIndexSemantics())
+    return failure();
+  if (genericOp.getNumParallelLoops() != genericOp.getNumLoops())
+    return failure();
+  if (!llvm::all_of(genericOp.getIndexingMapsArray(),
+                    [](AffineMap map) { return map.isIdentity(); })) {
+    return failure();
+  }
+  std::optional<TensorEncoding> encoding;
+  for (Value operand : genericOp->getOperands()) {
+    auto tensorType = operand.getType().dyn_cast<RankedTensorType>();
+    if (!tensorType)
+      return failure();
+    std::optional<TensorEncoding> operandEncoding = getEncoding(tensorType);
+    if (!operandEncoding || (encoding && *encoding != *operandEncoding))
+      return failure();
+    encoding = operandEncoding;
+  }
+
+  int64_t packedRank =
+      convertedOutputOperands[0].getType().cast<RankedTensorType>().getRank();
+  SmallVector<AffineMap> indexingMaps(
+      genericOp->getNumOperands(),
+      rewriter.getMultiDimIdentityMap(packedRank));
+  SmallVector<utils::IteratorType> iteratorTypes(packedRank,
+                                                 utils::IteratorType::parallel);
+  auto materializedGenericOp = rewriter.create<linalg::GenericOp>(
+      genericOp.getLoc(), convertedOutputOperands.getTypes(),
+      convertedInputOperands, convertedOutputOperands, indexingMaps,
+      iteratorTypes);
+  rewriter.inlineRegionBefore(genericOp.getRegion(),
+                              materializedGenericOp.getRegion(),
+                              materializedGenericOp.getRegion().begin());
+  return materializedGenericOp.getOperation();
+}
+
 /// Utility method to convert `tensor.empty` with encoding to a `tensor.empty`
 /// of the materialized type.
 static FailureOr<Operation *>
@@ -449,6 +496,7 @@ void populateMaterializeEncodingPatterns(
 
   // Add all patterns for converting from encoded type to the materialized type
   patterns.insert<MaterializeDPSOperation<linalg::FillOp>,
+                  MaterializeDPSOperation<linalg::GenericOp>,
                   MaterializeDPSOperation<linalg::MatmulOp>,
                   MaterializeOperation<tensor::EmptyOp>,
                   SetEncodingOpToPackOpConversion,
@@ -40,3 +40,49 @@ func.func @pack_canonicalize(%arg0 : tensor<?x?xi32>,
 //  CHECK-SAME:       into %[[ARG1]]
 //       CHECK:   %[[CAST:.+]] = tensor.cast %[[PACK]]
 //       CHECK:   return %[[CAST]]
+
+// -----
+
+func.func @fold_unset_set_encoding(%arg0 : tensor<?x?xf32>) -> tensor<?x?xf32> {
+  %0 = iree_linalg_ext.set_encoding %arg0
+      : tensor<?x?xf32> -> tensor<?x?xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RESULT>>
+  %1 = iree_linalg_ext.unset_encoding %0
+      : tensor<?x?xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RESULT>> -> tensor<?x?xf32>
+  return %1 : tensor<?x?xf32>
+}
+// CHECK-LABEL: func.func @fold_unset_set_encoding(
+//  CHECK-SAME:     %[[ARG0:.+]]: tensor<?x?xf32>
+//   CHECK-NOT:   iree_linalg_ext.set_encoding
+//   CHECK-NOT:   iree_linalg_ext.unset_encoding
+//       CHECK:   return %[[ARG0]]
+
+// -----
+
+func.func @fold_set_unset_encoding(
+    %arg0 : tensor<?x?xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RESULT>>)
+    -> tensor<?x?xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RESULT>> {
+  %0 = iree_linalg_ext.unset_encoding %arg0
+      : tensor<?x?xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RESULT>> -> tensor<?x?xf32>
+  %1 = iree_linalg_ext.set_encoding %0
+      : tensor<?x?xf32> -> tensor<?x?xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RESULT>>
+  return %1 : tensor<?x?xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RESULT>>
+}
+// CHECK-LABEL: func.func @fold_set_unset_encoding(
+//  CHECK-SAME:     %[[ARG0:.+]]: tensor<?x?xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RESULT>>
+//       CHECK:   return %[[ARG0]]
+
+// -----
+
+func.func @no_fold_set_unset_different_encoding(
+    %arg0 : tensor<?x?xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RESULT>>)
+    -> tensor<?x?xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_LHS>> {
+  %0 = iree_linalg_ext.unset_encoding %arg0
+      : tensor<?x?xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RESULT>> -> tensor<?x?xf32>
+  %1 = iree_linalg_ext.set_encoding %0
+      : tensor<?x?xf32> -> tensor<?x?xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_LHS>>
+  return %1 : tensor<?x?xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_LHS>>
+}
+// CHECK-LABEL: func.func @no_fold_set_unset_different_encoding(
+//       CHECK:   %[[UNSET:.+]] = iree_linalg_ext.unset_encoding
+//       CHECK:   %[[SET:.+]] = iree_linalg_ext.set_encoding %[[UNSET]]
+//       CHECK:   return %[[SET]]
@@ -0,0 +1,343 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// DLPack interop for host-visible buffer views.
+// See https://dmlc.github.io/dlpack/latest/python_spec.html for the protocol.
+
+#include <memory>
+
+#include "./hal.h"
+#include "./status_utils.h"
+#include "iree/base/api.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/api.h"
+
+namespace iree {
+namespace python {
+
+namespace {
+
+//------------------------------------------------------------------------------
+// DLPack ABI
+//------------------------------------------------------------------------------
+// The subset of the stable DLPack C ABI (dlpack.h, v0.8) that is exchanged
+// through `dltensor` capsules. Layouts must not change.
+
+enum DLDeviceType : int32_t {
+  kDLCPU = 1,
+};
+
+enum DLDataTypeCode : uint8_t {
+  kDLInt = 0,
+  kDLUInt = 1,
+  kDLFloat = 2,
+  kDLBfloat = 4,
+  kDLComplex = 5,
+  kDLBool = 6,
+};
+
+struct DLDevice {
+  int32_t device_type;
+  int32_t device_id;
+};
+
+struct DLDataType {
+  uint8_t code;
+  uint8_t bits;
+  uint16_t lanes;
+};
+
+struct DLTensor {
+  void* data;
+  DLDevice device;
+  int32_t ndim;
+  DLDataType dtype;
+  int64_t* shape;
+  int64_t* strides;
+  uint64_t byte_offset;
+};
+
+struct DLManagedTensor {
+  DLTensor dl_tensor;
+  void* manager_ctx;
+  void (*deleter)(DLManagedTensor* self);
+};
+
+const char kDlpackCapsuleName[] = "dltensor";
+const char kDlpackUsedCapsuleName[] = "used_dltensor";
+
+//------------------------------------------------------------------------------
+// Element types
+//------------------------------------------------------------------------------
+
+bool ElementTypeToDLDataType(iree_hal_element_type_t element_type,
+                             DLDataType* out_dtype) {
+  out_dtype->bits = iree_hal_element_bit_count(element_type);
+  out_dtype->lanes = 1;
+  // Sub-byte types are packed and have no DLPack representation.
+  if (out_dtype->bits % 8 != 0) return false;
+  switch (iree_hal_element_numerical_type(element_type)) {
+    case IREE_HAL_NUMERICAL_TYPE_BOOLEAN:
+      out_dtype->code = kDLBool;
+      return true;
+    case IREE_HAL_NUMERICAL_TYPE_INTEGER:
+    case IREE_HAL_NUMERICAL_TYPE_INTEGER_SIGNED:
+      out_dtype->code = kDLInt;
+      return true;
+    case IREE_HAL_NUMERICAL_TYPE_INTEGER_UNSIGNED:
+      out_dtype->code = kDLUInt;
+      return true;
+    case IREE_HAL_NUMERICAL_TYPE_FLOAT_IEEE:
+      out_dtype->code = kDLFloat;
+      return true;
+    case IREE_HAL_NUMERICAL_TYPE_FLOAT_BRAIN:
+      out_dtype->code = kDLBfloat;
+      return true;
+    case IREE_HAL_NUMERICAL_TYPE_FLOAT_COMPLEX:
+      out_dtype->code = kDLComplex;
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool DLDataTypeToElementType(DLDataType dtype,
+                             iree_hal_element_type_t* out_element_type) {
+  if (dtype.lanes != 1 || dtype.bits % 8 != 0) return false;
+  iree_hal_numerical_type_t numerical_type;
+  switch (dtype.code) {
+    case kDLBool:
+      numerical_type = IREE_HAL_NUMERICAL_TYPE_BOOLEAN;
+      break;
+    case kDLInt:
+      numerical_type = IREE_HAL_NUMERICAL_TYPE_INTEGER_SIGNED;
+      break;
+    case kDLUInt:
+      numerical_type = IREE_HAL_NUMERICAL_TYPE_INTEGER_UNSIGNED;
+      break;
+    case kDLFloat:
+      numerical_type = IREE_HAL_NUMERICAL_TYPE_FLOAT_IEEE;
+      break;
+    case kDLBfloat:
+      numerical_type = IREE_HAL_NUMERICAL_TYPE_FLOAT_BRAIN;
+      break;
+    case kDLComplex:
+      numerical_type = IREE_HAL_NUMERICAL_TYPE_FLOAT_COMPLEX;
+      break;
+    default:
+      return false;
+  }
+  *out_element_type = iree_hal_make_element_type(numerical_type, dtype.bits);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Export
+//------------------------------------------------------------------------------
+
+// Owns everything an exported tensor references: the buffer view is retained
+// and its storage stays mapped until the consumer calls the deleter.
+struct DlpackExport {
+  DLManagedTensor managed_tensor;
+  iree_hal_buffer_view_t* buffer_view = nullptr;
+  iree_hal_buffer_mapping_t mapping = {{0}};
+  std::vector<int64_t> shape;
+};
+
+void DeleteDlpackExport(DLManagedTensor* self) {
+  auto* dlpack_export = static_cast<DlpackExport*>(self->manager_ctx);
+  iree_hal_buffer_unmap_range(&dlpack_export->mapping);
+  iree_hal_buffer_view_release(dlpack_export->buffer_view);
+  delete dlpack_export;
+}
+
+// Frees the tensor if the capsule is dropped without being consumed.
+void DestroyDlpackCapsule(PyObject* capsule) {
+  if (!PyCapsule_IsValid(capsule, kDlpackCapsuleName)) return;
+  auto* managed_tensor = static_cast<DLManagedTensor*>(
+      PyCapsule_GetPointer(capsule, kDlpackCapsuleName));
+  managed_tensor->deleter(managed_tensor);
+}
+
+//------------------------------------------------------------------------------
+// Import
+//------------------------------------------------------------------------------
+
+// Returns an imported tensor to its producer once the HAL buffer aliasing it
+// is destroyed. That may happen on any thread and producer deleters commonly
+// release Python objects so the GIL is acquired around the call.
+void ReleaseDlpackImport(void* user_data, iree_hal_buffer_t* buffer) {
+  auto* managed_tensor = static_cast<DLManagedTensor*>(user_data);
+  if (!managed_tensor->deleter || !Py_IsInitialized()) return;
+  PyGILState_STATE gil_state = PyGILState_Ensure();
+  managed_tensor->deleter(managed_tensor);
+  PyGILState_Release(gil_state);
+}
+
+}  // namespace
+
+py::capsule HalBufferView::ExportDlpack(py::object stream) {
+  IREE_TRACE_SCOPE0("HalBufferView::ExportDlpack");
+  if (!stream.is_none()) {
+    throw RaisePyError(PyExc_BufferError,
+                       "DLPack streams are not supported for host memory");
+  }
+  if (iree_hal_buffer_view_encoding_type(raw_ptr()) !=
+      IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR) {
+    throw RaisePyError(PyExc_BufferError,
+                       "only dense row-major buffer views can be exported");
+  }
+  DLDataType dtype;
+  if (!ElementTypeToDLDataType(iree_hal_buffer_view_element_type(raw_ptr()),
+                               &dtype)) {
+    throw RaisePyError(PyExc_BufferError,
+                       "buffer view element type has no DLPack equivalent");
+  }
+
+  auto dlpack_export = std::make_unique<DlpackExport>();
+  iree_hal_buffer_t* buffer = iree_hal_buffer_view_buffer(raw_ptr());
+  CheckApiStatus(
+      iree_hal_buffer_map_range(buffer, IREE_HAL_MAPPING_MODE_SCOPED,
+                                iree_hal_buffer_allowed_access(buffer), 0,
+                                iree_hal_buffer_view_byte_length(raw_ptr()),
+                                &dlpack_export->mapping),
+      "Could not map memory for DLPack export");
+  dlpack_export->buffer_view = raw_ptr();
+  iree_hal_buffer_view_retain(dlpack_export->buffer_view);
+
+  iree_host_size_t rank = iree_hal_buffer_view_shape_rank(raw_ptr());
+  const iree_hal_dim_t* dims = iree_hal_buffer_view_shape_dims(raw_ptr());
+  dlpack_export->shape.assign(dims, dims + rank);
+
+  // Null strides denote a compact row-major layout.
+  DLManagedTensor& managed_tensor = dlpack_export->managed_tensor;
+  managed_tensor.dl_tensor.data = dlpack_export->mapping.contents.data;
+  managed_tensor.dl_tensor.device = {kDLCPU, 0};
+  managed_tensor.dl_tensor.ndim = static_cast<int32_t>(rank);
+  managed_tensor.dl_tensor.dtype = dtype;
+  managed_tensor.dl_tensor.shape = dlpack_export->shape.data();
+  managed_tensor.dl_tensor.strides = nullptr;
+  managed_tensor.dl_tensor.byte_offset = 0;
+  managed_tensor.manager_ctx = dlpack_export.get();
+  managed_tensor.deleter = DeleteDlpackExport;
+
+  PyObject* capsule =
+      PyCapsule_New(&managed_tensor, kDlpackCapsuleName, DestroyDlpackCapsule);
+  if (!capsule) {
+    DeleteDlpackExport(&dlpack_export.release()->managed_tensor);
+    throw py::error_already_set();
+  }
+  dlpack_export.release();
+  return py::reinterpret_steal<py::capsule>(capsule);
+}
+
+py::tuple HalBufferView::DlpackDevice() {
+  return py::make_tuple(static_cast<int>(kDLCPU), 0);
+}
+
+py::object HalAllocator::ImportDlpack(int memory_type, int allowed_usage,
+                                      py::capsule capsule,
+                                      std::optional<bool> copy) {
+  IREE_TRACE_SCOPE0("HalAllocator::ImportDlpack");
+  if (!PyCapsule_IsValid(capsule.ptr(), kDlpackCapsuleName)) {
+    throw RaisePyError(PyExc_BufferError,
+                       "expected an unconsumed DLPack 'dltensor' capsule");
+  }
+  auto* managed_tensor = static_cast<DLManagedTensor*>(
+      PyCapsule_GetPointer(capsule.ptr(), kDlpackCapsuleName));
+  const DLTensor& tensor = managed_tensor->dl_tensor;
+  if (tensor.device.device_type != kDLCPU) {
+    throw RaisePyError(PyExc_BufferError,
+                       "only host (kDLCPU) DLPack tensors can be imported");
+  }
+  iree_hal_element_type_t element_type;
+  if (!DLDataTypeToElementType(tensor.dtype, &element_type)) {
+    throw RaisePyError(PyExc_BufferError, "unsupported DLPack dtype");
+  }
+
+  // Only compact row-major layouts map onto a dense buffer view. Strides of
+  // unit dimensions are meaningless and not checked.
+  std::vector<iree_hal_dim_t> dims(tensor.ndim);
+  int64_t element_count = 1;
+  for (int32_t i = tensor.ndim - 1; i >= 0; --i) {
+    if (tensor.strides && tensor.shape[i] != 1 &&
+        tensor.strides[i] != element_count) {
+      throw RaisePyError(PyExc_BufferError,
+                         "only compact row-major DLPack tensors are supported");
+    }
+    dims[i] = tensor.shape[i];
+    element_count *= tensor.shape[i];
+  }
+  iree_device_size_t byte_length =
+      element_count * iree_hal_element_dense_byte_count(element_type);
+  uint8_t* data = static_cast<uint8_t*>(tensor.data) + tensor.byte_offset;
+
+  iree_hal_buffer_params_t params = {0};
+  params.type = memory_type | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE;
+  params.usage = allowed_usage;
+
+  // Heap-backed devices can only alias allocations with at least the
+  // alignment they allocate with themselves.
+  bool can_alias =
+      !copy.value_or(false) &&
+      iree_host_size_has_alignment((uintptr_t)data,
+                                   IREE_HAL_HEAP_BUFFER_ALIGNMENT);
+  if (!can_alias && copy.has_value() && !*copy) {
+    throw RaisePyError(PyExc_BufferError,
+                       "DLPack tensor data is not sufficiently aligned to be "
+                       "imported without a copy");
+  }
+
+  iree_hal_buffer_t* hal_buffer = nullptr;
+  bool is_aliased = false;
+  iree_status_t status = iree_ok_status();
+  {
+    py::gil_scoped_release release;
+    if (can_alias) {
+      iree_hal_external_buffer_t external_buffer = {};
+      external_buffer.type = IREE_HAL_EXTERNAL_BUFFER_TYPE_HOST_ALLOCATION;
+      external_buffer.flags = IREE_HAL_EXTERNAL_BUFFER_FLAG_NONE;
+      external_buffer.size = byte_length;
+      external_buffer.handle.host_allocation.ptr = data;
+      iree_hal_buffer_release_callback_t release_callback = {
+          ReleaseDlpackImport, managed_tensor};
+      status = iree_hal_allocator_import_buffer(
+          raw_ptr(), params, &external_buffer, release_callback, &hal_buffer);
+      if (iree_status_is_ok(status)) {
+        is_aliased = true;
+      } else if (!copy.has_value()) {
+        // The allocator cannot alias the memory; fall back to a copy.
+        status = iree_status_ignore(status);
+      }
+    }
+    if (iree_status_is_ok(status) && !is_aliased) {
+      status = iree_hal_allocator_allocate_buffer(
+          raw_ptr(), params, byte_length,
+          iree_make_const_byte_span(data, byte_length), &hal_buffer);
+    }
+  }
+  CheckApiStatus(status, "Failed to import DLPack tensor");
+
+  // An aliased tensor is now owned by the buffer and its release callback: mark
+  // the capsule consumed so the producer does not free it as well. Copied
+  // tensors are left for the producer to free with the capsule.
+  if (is_aliased) {
+    PyCapsule_SetName(capsule.ptr(), kDlpackUsedCapsuleName);
+  }
+
+  iree_hal_buffer_view_t* hal_buffer_view = nullptr;
+  status = iree_hal_buffer_view_create(
+      hal_buffer, dims.size(), dims.data(), element_type,
+      IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR,
+      iree_hal_allocator_host_allocator(raw_ptr()), &hal_buffer_view);
+  iree_hal_buffer_release(hal_buffer);
+  CheckApiStatus(status, "Error allocating buffer_view");
+  return py::cast(HalBufferView::StealFromRawPtr(hal_buffer_view),
+                  py::return_value_policy::move);
+}
+
+}  // namespace python
+}  // namespace iree
@@ -209,6 +209,53 @@ py::str HalBufferView::Repr() {
   return py::str(repr);
 }
 
+//------------------------------------------------------------------------------
+// HalFence
+//------------------------------------------------------------------------------
+
+HalFence HalFence::Create(HalDevice& device) {
+  iree_hal_semaphore_t* semaphore = nullptr;
+  CheckApiStatus(iree_hal_semaphore_create(device.raw_ptr(), 0ull, &semaphore),
+                 "Error creating semaphore");
+  iree_hal_fence_t* fence = nullptr;
+  iree_status_t status = iree_hal_fence_create_at(
+      semaphore, 1ull, iree_hal_device_host_allocator(device.raw_ptr()),
+      &fence);
+  iree_hal_semaphore_release(semaphore);
+  CheckApiStatus(status, "Error creating fence");
+  return HalFence::StealFromRawPtr(fence);
+}
+
+bool HalFence::IsReady() {
+  iree_status_t status = iree_hal_fence_query(raw_ptr());
+  if (iree_status_code(status) == IREE_STATUS_DEFERRED) {
+    iree_status_ignore(status);
+    return false;
+  }
+  CheckApiStatus(status, "Error querying fence");
+  return true;
+}
+
+bool HalFence::Wait(std::optional<int64_t> timeout_ms) {
+  iree_timeout_t timeout = timeout_ms ? iree_make_timeout_ms(*timeout_ms)
+                                      : iree_infinite_timeout();
+  iree_status_t status;
+  {
+    py::gil_scoped_release release;
+    status = iree_hal_fence_wait(raw_ptr(), timeout);
+  }
+  if (iree_status_is_deadline_exceeded(status)) {
+    iree_status_ignore(status);
+    return false;
+  }
+  CheckApiStatus(status, "Error waiting on fence");
+  return true;
+}
+
+void HalFence::Signal() {
+  CheckApiStatus(iree_hal_fence_signal(raw_ptr()), "Error signaling fence");
+}
+
 //------------------------------------------------------------------------------
 // HalDevice
 //------------------------------------------------------------------------------
@@ -711,7 +758,13 @@ void SetupHalBindings(pybind11::module m) {
            "object. If an element type is specified, wraps in a BufferView "
            "matching the characteristics of the Python buffer. The format is "
            "requested as ND/C-Contiguous, which may incur copies if not "
-           "already in that format.");
+           "already in that format.")
+      .def("import_dlpack", &HalAllocator::ImportDlpack,
+           py::arg("memory_type"), py::arg("allowed_usage"),
+           py::arg("capsule"), py::arg("copy") = py::none(),
+           py::keep_alive<0, 1>(),
+           "Imports a DLPack 'dltensor' capsule as a BufferView, aliasing the "
+           "producer's memory when possible.");
 
   py::class_<HalBuffer>(m, "HalBuffer")
       .def("fill_zero", &HalBuffer::FillZero, py::arg("byte_offset"),
@@ -742,8 +795,26 @@ void SetupHalBindings(pybind11::module m) {
           [](HalBufferView& self) {
             return iree_hal_buffer_view_element_type(self.raw_ptr());
           })
+      .def("__dlpack__", &HalBufferView::ExportDlpack,
+           py::arg("stream") = py::none())
+      .def("__dlpack_device__", &HalBufferView::DlpackDevice)
       .def("__repr__", &HalBufferView::Repr);
 
+  auto hal_fence = py::class_<HalFence>(m, "HalFence");
+  VmRef::BindRefProtocol(hal_fence, iree_hal_fence_type,
+                         iree_hal_fence_retain_ref, iree_hal_fence_deref,
+                         iree_hal_fence_isa);
+  hal_fence
+      .def_static("create", &HalFence::Create, py::arg("device"),
+                  "Creates a fence on a new semaphore of the device that is "
+                  "reached once it is signaled from the host.")
+      .def_property_readonly("is_ready", &HalFence::IsReady)
+      .def("wait", &HalFence::Wait, py::arg("timeout_ms") = py::none(),
+           "Waits for all timepoints in the fence to be reached, returning "
+           "False if the timeout elapsed first.")
+      .def("signal", &HalFence::Signal,
+           "Signals all timepoints in the fence from the host.");
+
   py::class_<HalMappedMemory>(m, "MappedMemory", py::buffer_protocol())
       .def_buffer(&HalMappedMemory::ToBufferInfo)
       .def("asarray",
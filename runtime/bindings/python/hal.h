@@ -7,6 +7,7 @@
 #ifndef IREE_BINDINGS_PYTHON_IREE_RT_HAL_H_
 #define IREE_BINDINGS_PYTHON_IREE_RT_HAL_H_
 
+#include <optional>
 #include <vector>
 
 #include "./binding.h"
@@ -76,6 +77,12 @@ struct ApiPtrAdapter<iree_hal_buffer_view_t> {
   }
 };
 
+template <>
+struct ApiPtrAdapter<iree_hal_fence_t> {
+  static void Retain(iree_hal_fence_t* f) { iree_hal_fence_retain(f); }
+  static void Release(iree_hal_fence_t* f) { iree_hal_fence_release(f); }
+};
+
 //------------------------------------------------------------------------------
 // ApiRefCounted types
 //------------------------------------------------------------------------------
@@ -112,6 +119,13 @@ class HalAllocator : public ApiRefCounted<HalAllocator, iree_hal_allocator_t> {
   py::object AllocateBufferCopy(
       int memory_type, int allowed_usage, py::object buffer,
       std::optional<iree_hal_element_types_t> element_type);
+
+  // Imports the compact host tensor held by a DLPack `dltensor` capsule as a
+  // buffer view aliasing its memory. Memory the allocator cannot alias (such as
+  // insufficiently aligned data) is copied unless |copy| is false; a |copy| of
+  // true always copies.
+  py::object ImportDlpack(int memory_type, int allowed_usage,
+                          py::capsule capsule, std::optional<bool> copy);
 };
 
 struct HalShape {
@@ -129,6 +143,31 @@ class HalBufferView
     : public ApiRefCounted<HalBufferView, iree_hal_buffer_view_t> {
  public:
   py::str Repr();
+
+  // Exports the buffer view as a DLPack `dltensor` capsule aliasing its host
+  // mapping. The buffer view is retained until the consumer releases it.
+  py::capsule ExportDlpack(py::object stream);
+
+  // Returns the DLPack (device_type, device_id) of the exported memory.
+  py::tuple DlpackDevice();
+};
+
+class HalFence : public ApiRefCounted<HalFence, iree_hal_fence_t> {
+ public:
+  // Creates a fence on a new semaphore of |device| that is reached once it is
+  // signaled from the host.
+  static HalFence Create(HalDevice& device);
+
+  // Returns true if all timepoints in the fence have been reached. Raises if
+  // any of the semaphores has failed.
+  bool IsReady();
+
+  // Blocks with the GIL released until all timepoints in the fence have been
+  // reached or |timeout_ms| elapses. Returns false on timeout.
+  bool Wait(std::optional<int64_t> timeout_ms);
+
+  // Signals all timepoints in the fence from the host.
+  void Signal();
 };
 
 class HalBuffer : public ApiRefCounted<HalBuffer, iree_hal_buffer_t> {
@@ -21,6 +21,7 @@ from ._binding import (
     HalBuffer,
     HalBufferView,
     HalDevice,
+    HalFence,
     HalDriver,
     HalElementType,
     MemoryAccess,
@@ -22,6 +22,7 @@ from ._binding import (
 __all__ = [
     "asdevicearray",
     "DeviceArray",
+    "from_dlpack",
 ]
 
 _DEVICE_HANDLED_FUNCTIONS = {}
@@ -90,6 +91,18 @@ class DeviceArray(numpy.lib.mixins.NDArrayOperatorsMixin):
     host_array = self.to_host()
     return host_array.__array_function__(func, types, args, kwargs)  # pytype: disable=attribute-error
 
+  def __dlpack__(self, stream=None):
+    """Exports the array via DLPack, aliasing its host mapping."""
+    if self._override_dtype is not None and (self._override_dtype !=
+                                             self._get_raw_dtype()):
+      # The device representation differs from the reported dtype so only the
+      # converted host array can be shared.
+      return self.to_host().__dlpack__(stream=stream)
+    return self._buffer_view.__dlpack__(stream=stream)
+
+  def __dlpack_device__(self):
+    return self._buffer_view.__dlpack_device__()
+
   def __repr__(self):
     return f"<IREE DeviceArray: shape={np.shape(self)}, dtype={self.dtype}>"
 
@@ -224,6 +237,34 @@ def asdevicearray(device: HalDevice,
                      override_dtype=a.dtype)
 
 
+def from_dlpack(device: HalDevice,
+                x,
+                *,
+                copy: Optional[bool] = None,
+                implicit_host_transfer: bool = False,
+                memory_type=MemoryType.DEVICE_LOCAL,
+                allowed_usage=(BufferUsage.DEFAULT | BufferUsage.MAPPING)
+               ) -> DeviceArray:
+  """Creates a DeviceArray from an object supporting the DLPack protocol.
+
+  The producer's memory is imported and aliased without a copy when the device
+  allocator can use it directly. Host tensors that are not sufficiently aligned
+  are copied unless `copy=False`, in which case a BufferError is raised;
+  `copy=True` always copies. Writes to an aliased array are visible to the
+  producer and vice versa.
+
+  `x` may also be a raw `dltensor` capsule as returned by `__dlpack__`.
+  """
+  capsule = x.__dlpack__() if hasattr(x, "__dlpack__") else x
+  buffer_view = device.allocator.import_dlpack(memory_type=memory_type,
+                                               allowed_usage=allowed_usage,
+                                               capsule=capsule,
+                                               copy=copy)
+  return DeviceArray(device,
+                     buffer_view,
+                     implicit_host_transfer=implicit_host_transfer)
+
+
 # NOTE: Numpy dtypes are not hashable and exist in a hierarchy that should
 # be queried via isinstance checks. This should be done as a fallback but
 # this is a linear list for quick access to the most common. There may also
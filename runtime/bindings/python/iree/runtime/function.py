@@ -6,8 +6,11 @@
 
 from typing import Dict, Optional
 
+import asyncio
+import concurrent.futures
 import json
 import logging
+import threading
 
 import numpy as np
 
@@ -17,6 +20,7 @@ from ._binding import (
     BufferUsage,
     HalBufferView,
     HalDevice,
+    HalFence,
     InvokeContext,
     MemoryType,
     VmContext,
@@ -118,41 +122,98 @@ class FunctionInvoker:
     if self._tracer:
       call_trace = self._tracer.start_call(self._vm_function)
     try:
-      # Initialize the capacity to our total number of args, since we should
-      # be below that when doing a flat invocation. May want to be more
-      # conservative here when considering nesting.
-      inv = Invocation(self._device)
-      ret_descs = self._ret_descs
-
-      ret_list = VmVariantList(len(ret_descs) if ret_descs is not None else 1)
+      ret_list = self._create_ret_list()
       if call_trace:
         call_trace.add_vm_list(arg_list, "args")
       self._invoke(arg_list, ret_list)
       if call_trace:
         call_trace.add_vm_list(ret_list, "results")
-
-      # Un-inline the results to align with reflection, as needed.
-      reflection_aligned_ret_list = ret_list
-      if self._has_inlined_results:
-        reflection_aligned_ret_list = VmVariantList(1)
-        reflection_aligned_ret_list.push_list(ret_list)
-      returns = _extract_vm_sequence_to_python(inv, reflection_aligned_ret_list,
-                                               ret_descs)
-      return_arity = len(returns)
-      if return_arity == 1:
-        return returns[0]
-      elif return_arity == 0:
-        return None
-      else:
-        return tuple(returns)
+      return self._unpack_results(ret_list)
     finally:
       if call_trace:
         call_trace.end_call()
 
+  def invoke_async(self, *args, **kwargs) -> concurrent.futures.Future:
+    """Invokes the function without blocking on the device.
+
+    Arguments are packed on the calling thread and the function is invoked
+    there with the GIL released. Functions using the `coarse-fences` ABI model
+    return as soon as their work is scheduled and the returned future resolves
+    once the device has signaled completion; results are unpacked on a shared
+    waiter thread. Other functions complete before this returns.
+
+    Returns a future resolving to the value `__call__` would return.
+    """
+    invoke_context = InvokeContext(self._device)
+    arg_list = self._arg_packer.pack(invoke_context, args, kwargs)
+
+    call_trace = None  # type: Optional[tracing.CallTrace]
+    if self._tracer:
+      call_trace = self._tracer.start_call(self._vm_function)
+    future = concurrent.futures.Future()
+    try:
+      ret_list = self._create_ret_list()
+      if call_trace:
+        call_trace.add_vm_list(arg_list, "args")
+      signal_fence = self._invoke_async(arg_list, ret_list)
+    except BaseException:
+      if call_trace:
+        call_trace.end_call()
+      raise
+
+    def complete():
+      try:
+        if signal_fence is not None:
+          signal_fence.wait()
+        if call_trace:
+          call_trace.add_vm_list(ret_list, "results")
+        future.set_result(self._unpack_results(ret_list))
+      except BaseException as e:
+        future.set_exception(e)
+      finally:
+        if call_trace:
+          call_trace.end_call()
+
+    if signal_fence is None or signal_fence.is_ready:
+      complete()
+    else:
+      _get_fence_waiter().submit(complete)
+    return future
+
+  async def call_async(self, *args, **kwargs):
+    """Awaitable form of `invoke_async` for use from an asyncio event loop."""
+    return await asyncio.wrap_future(self.invoke_async(*args, **kwargs))
+
+  def _create_ret_list(self) -> VmVariantList:
+    ret_descs = self._ret_descs
+    return VmVariantList(len(ret_descs) if ret_descs is not None else 1)
+
+  def _unpack_results(self, ret_list: VmVariantList):
+    inv = Invocation(self._device)
+
+    # Un-inline the results to align with reflection, as needed.
+    reflection_aligned_ret_list = ret_list
+    if self._has_inlined_results:
+      reflection_aligned_ret_list = VmVariantList(1)
+      reflection_aligned_ret_list.push_list(ret_list)
+    returns = _extract_vm_sequence_to_python(inv, reflection_aligned_ret_list,
+                                             self._ret_descs)
+    return_arity = len(returns)
+    if return_arity == 1:
+      return returns[0]
+    elif return_arity == 0:
+      return None
+    else:
+      return tuple(returns)
+
   # Break out invoke so it shows up in profiles.
   def _invoke(self, arg_list, ret_list):
     self._vm_context.invoke(self._vm_function, arg_list, ret_list)
 
+  def _invoke_async(self, arg_list, ret_list) -> Optional[HalFence]:
+    return self._vm_context.invoke_async(self._vm_function, arg_list, ret_list,
+                                         self._device)
+
   def _parse_abi_dict(self, vm_function: VmFunction):
     reflection = vm_function.reflection
     abi_json = reflection.get("iree.abi")
@@ -190,6 +251,21 @@ class FunctionInvoker:
     return repr(self._vm_function)
 
 
+# Shared pool of threads that block on signal fences of asynchronous
+# invocations (with the GIL released) and then unpack their results.
+_fence_waiter = None  # type: Optional[concurrent.futures.ThreadPoolExecutor]
+_fence_waiter_lock = threading.Lock()
+
+
+def _get_fence_waiter() -> concurrent.futures.ThreadPoolExecutor:
+  global _fence_waiter
+  with _fence_waiter_lock:
+    if _fence_waiter is None:
+      _fence_waiter = concurrent.futures.ThreadPoolExecutor(
+          thread_name_prefix="iree-fence-waiter")
+    return _fence_waiter
+
+
 # VM to Python converters. All take:
 #   inv: Invocation
 #   vm_list: VmVariantList to read from
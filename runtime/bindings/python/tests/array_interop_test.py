@@ -163,6 +163,41 @@ class DeviceHalTest(unittest.TestCase):
     self.assertEqual(repr(ary), "<IREE DeviceArray: shape=[3, 4], dtype=bool>")
     np.testing.assert_array_equal(ary.to_host(), init_ary)
 
+  def testDlpackExport(self):
+    init_ary = np.arange(12, dtype=np.int32).reshape([3, 4])
+    ary = iree.runtime.asdevicearray(self.device, init_ary)
+    self.assertEqual((1, 0), ary.__dlpack_device__())
+    exported = np.from_dlpack(ary)
+    np.testing.assert_array_equal(exported, init_ary)
+    self.assertTrue(np.shares_memory(exported, ary.to_host()))
+
+  def testDlpackImportAliases(self):
+    init_ary = np.arange(12, dtype=np.float32).reshape([3, 4])
+    src = iree.runtime.asdevicearray(self.device, init_ary)
+    ary = iree.runtime.from_dlpack(self.device, src, copy=False)
+    self.assertEqual([3, 4], ary.shape)
+    self.assertEqual(np.float32, ary.dtype)
+    self.assertTrue(np.shares_memory(ary.to_host(), src.to_host()))
+
+    # The imported memory must outlive the original array.
+    src = None
+    gc.collect()
+    np.testing.assert_array_equal(ary.to_host(), init_ary)
+
+  def testDlpackImportCopy(self):
+    init_ary = np.arange(12, dtype=np.int64).reshape([3, 4])
+    ary = iree.runtime.from_dlpack(self.device, init_ary, copy=True)
+    init_ary[0, 0] = 100
+    self.assertEqual(0, ary.to_host()[0, 0])
+
+  def testDlpackImportUnaligned(self):
+    # Offset by a single byte from an allocation that is at least word aligned.
+    unaligned_ary = np.zeros([17], dtype=np.uint8)[1:]
+    with self.assertRaises(BufferError):
+      iree.runtime.from_dlpack(self.device, unaligned_ary, copy=False)
+    ary = iree.runtime.from_dlpack(self.device, unaligned_ary)
+    np.testing.assert_array_equal(ary.to_host(), unaligned_ary)
+
 
 if __name__ == "__main__":
   unittest.main()
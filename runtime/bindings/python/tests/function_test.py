@@ -4,8 +4,10 @@
 # See https://llvm.org/LICENSE.txt for license information.
 # SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+import asyncio
 import json
 import numpy as np
+import threading
 import unittest
 
 from iree import runtime as rt
@@ -19,8 +21,9 @@ from iree.runtime._binding import VmVariantList
 
 class MockVmContext:
 
-  def __init__(self, invoke_callback):
+  def __init__(self, invoke_callback, signal_fence=None):
     self._invoke_callback = invoke_callback
+    self._signal_fence = signal_fence
     self.invocations = []
 
   def invoke(self, vm_function, arg_list, ret_list):
@@ -28,11 +31,28 @@ class MockVmContext:
     self.invocations.append((vm_function, arg_list, ret_list))
     print(f"INVOKE: {arg_list} -> {ret_list}")
 
+  def invoke_async(self, vm_function, arg_list, ret_list, device):
+    self.invoke(vm_function, arg_list, ret_list)
+    return self._signal_fence
+
   @property
   def mock_arg_reprs(self):
     return repr([arg_list for _, arg_list, _ in self.invocations])
 
 
+class MockHalFence:
+
+  def __init__(self):
+    self.signaled = threading.Event()
+
+  @property
+  def is_ready(self):
+    return self.signaled.is_set()
+
+  def wait(self, timeout_ms=None):
+    return self.signaled.wait()
+
+
 class MockVmFunction:
 
   def __init__(self, reflection):
@@ -589,6 +609,53 @@ class FunctionTest(unittest.TestCase):
     result = invoker()
     self.assertEqual("[1, 2]", repr(result))
 
+  def testInvokeAsyncSynchronous(self):
+
+    def invoke(arg_list, ret_list):
+      ret_list.push_int(3)
+      ret_list.push_int(4)
+
+    vm_context = MockVmContext(invoke)
+    vm_function = MockVmFunction(reflection={})
+    invoker = FunctionInvoker(vm_context, self.device, vm_function, tracer=None)
+    future = invoker.invoke_async(1, 2)
+    self.assertTrue(future.done())
+    self.assertEqual((3, 4), future.result())
+    self.assertEqual("[<VmVariantList(2): [1, 2]>]", vm_context.mock_arg_reprs)
+
+  def testInvokeAsyncWaitsOnFence(self):
+
+    def invoke(arg_list, ret_list):
+      ret_list.push_int(3)
+
+    signal_fence = MockHalFence()
+    vm_context = MockVmContext(invoke, signal_fence=signal_fence)
+    vm_function = MockVmFunction(reflection={})
+    invoker = FunctionInvoker(vm_context, self.device, vm_function, tracer=None)
+    future = invoker.invoke_async(1)
+    self.assertFalse(future.done())
+    signal_fence.signaled.set()
+    self.assertEqual(3, future.result(timeout=10))
+
+  def testCallAsync(self):
+
+    def invoke(arg_list, ret_list):
+      ret_list.push_int(3)
+
+    signal_fence = MockHalFence()
+    vm_context = MockVmContext(invoke, signal_fence=signal_fence)
+    vm_function = MockVmFunction(reflection={})
+    invoker = FunctionInvoker(vm_context, self.device, vm_function, tracer=None)
+
+    async def main():
+      pending = asyncio.ensure_future(invoker.call_async(1))
+      await asyncio.sleep(0)
+      self.assertFalse(pending.done())
+      signal_fence.signaled.set()
+      return await pending
+
+    self.assertEqual(3, asyncio.run(main()))
+
 
 if __name__ == "__main__":
   unittest.main()
@@ -6,8 +6,11 @@
 
 # pylint: disable=unused-variable
 
+import asyncio
 import logging
 import numpy as np
+import threading
+import time
 import unittest
 
 import iree.compiler
@@ -56,6 +59,22 @@ def create_simple_dynamic_abs_module(instance):
   return m
 
 
+def create_coarse_fences_mul_module(instance):
+  binary = iree.compiler.compile_str(
+      """
+      func.func @simple_mul(%arg0: tensor<4xf32>, %arg1: tensor<4xf32>) -> tensor<4xf32> {
+        %0 = arith.mulf %arg0, %arg1 : tensor<4xf32>
+        return %0 : tensor<4xf32>
+      }
+      """,
+      target_backends=iree.compiler.core.DEFAULT_TESTING_BACKENDS,
+      # Exports the function with the `coarse-fences` ABI model.
+      extra_args=["--iree-execution-model=async-external"],
+  )
+  m = iree.runtime.VmModule.from_flatbuffer(instance, binary)
+  return m
+
+
 class VmTest(unittest.TestCase):
 
   @classmethod
@@ -129,6 +148,133 @@ class VmTest(unittest.TestCase):
     logging.info("result: %s", result)
     np.testing.assert_allclose(result, [4., 10., 18., 28.])
 
+  def _invoke_async_simple_mul(self, context, f, wait_fence=None):
+    arg_list = iree.runtime.VmVariantList(4)
+    for ary in (np.array([1., 2., 3., 4.], dtype=np.float32),
+                np.array([4., 5., 6., 7.], dtype=np.float32)):
+      arg_list.push_ref(
+          self.device.allocator.allocate_buffer_copy(
+              memory_type=iree.runtime.MemoryType.DEVICE_LOCAL,
+              allowed_usage=iree.runtime.BufferUsage.DEFAULT,
+              buffer=ary,
+              element_type=iree.runtime.HalElementType.FLOAT_32))
+    ret_list = iree.runtime.VmVariantList(1)
+    fence = context.invoke_async(f, arg_list, ret_list, self.device,
+                                 wait_fence=wait_fence)
+    return fence, arg_list, ret_list
+
+  def test_invoke_async_coarse_fences(self):
+    m = create_coarse_fences_mul_module(self.instance)
+    context = iree.runtime.VmContext(self.instance,
+                                     modules=[self.hal_module, m])
+    f = m.lookup_function("simple_mul")
+    self.assertEqual(f.reflection.get("iree.abi.model"), "coarse-fences")
+    fence, arg_list, ret_list = self._invoke_async_simple_mul(context, f)
+    self.assertIsInstance(fence, iree.runtime.HalFence)
+
+    # A null wait fence and the returned signal fence are appended.
+    self.assertEqual(len(arg_list), 4)
+    self.assertIsNone(arg_list.get_variant(2))
+    self.assertEqual(arg_list.get_as_object(3, iree.runtime.HalFence), fence)
+
+    self.assertTrue(fence.wait())
+    self.assertTrue(fence.is_ready)
+    self.assertTrue(fence.wait(timeout_ms=0))
+    result_view = ret_list.get_as_object(0, iree.runtime.HalBufferView)
+    result = result_view.map().asarray(result_view.shape, np.float32)
+    np.testing.assert_allclose(result, [4., 10., 18., 28.])
+
+  def test_invoke_async_synchronous_model(self):
+    m = create_simple_static_mul_module(self.instance)
+    context = iree.runtime.VmContext(self.instance,
+                                     modules=[self.hal_module, m])
+    f = m.lookup_function("simple_mul")
+    arg_list = iree.runtime.VmVariantList(2)
+    arg_list.push_ref(
+        self.device.allocator.allocate_buffer_copy(
+            memory_type=iree.runtime.MemoryType.DEVICE_LOCAL,
+            allowed_usage=iree.runtime.BufferUsage.DEFAULT,
+            buffer=np.array([1., 2., 3., 4.], dtype=np.float32),
+            element_type=iree.runtime.HalElementType.FLOAT_32))
+    arg_list.push_ref(arg_list.get_as_ref(0))
+    ret_list = iree.runtime.VmVariantList(1)
+    self.assertIsNone(context.invoke_async(f, arg_list, ret_list, self.device))
+    self.assertEqual(len(arg_list), 2)
+    result_view = ret_list.get_as_object(0, iree.runtime.HalBufferView)
+    result = result_view.map().asarray(result_view.shape, np.float32)
+    np.testing.assert_allclose(result, [1., 4., 9., 16.])
+
+  def test_hal_fence_ref_protocol(self):
+    m = create_coarse_fences_mul_module(self.instance)
+    context = iree.runtime.VmContext(self.instance,
+                                     modules=[self.hal_module, m])
+    f = m.lookup_function("simple_mul")
+    fence, _, _ = self._invoke_async_simple_mul(context, f)
+    fence.wait()
+
+    ref = fence.ref
+    self.assertEqual(ref, fence.__iree_vm_ref__)
+    self.assertTrue(ref.isinstance(iree.runtime.HalFence))
+    self.assertFalse(ref.isinstance(iree.runtime.VmVariantList))
+    self.assertEqual(ref.deref(iree.runtime.HalFence), fence)
+    self.assertEqual(iree.runtime.HalFence.__iree_vm_cast__(ref), fence)
+    self.assertIsNone(
+        iree.runtime.HalFence.__iree_vm_cast__(
+            iree.runtime.VmVariantList(0).ref))
+    lst = iree.runtime.VmVariantList(1)
+    lst.push_ref(fence)
+    self.assertEqual(lst.get_as_object(0, iree.runtime.HalFence), fence)
+
+  def test_invoke_async_releases_gil(self):
+    # The invocation can't complete until its wait fence is signaled and must
+    # release the GIL while it waits for the main thread to keep running.
+    m = create_coarse_fences_mul_module(self.instance)
+    context = iree.runtime.VmContext(self.instance,
+                                     modules=[self.hal_module, m])
+    f = m.lookup_function("simple_mul")
+    wait_fence = iree.runtime.HalFence.create(self.device)
+    started = threading.Event()
+    results = []
+
+    def run():
+      started.set()
+      fence, _, ret_list = self._invoke_async_simple_mul(
+          context, f, wait_fence=wait_fence)
+      fence.wait()
+      result_view = ret_list.get_as_object(0, iree.runtime.HalBufferView)
+      results.append(result_view.map().asarray(result_view.shape, np.float32))
+
+    thread = threading.Thread(target=run)
+    thread.start()
+    started.wait()
+    main_progress = 0
+    deadline = time.monotonic() + 0.1
+    while time.monotonic() < deadline:
+      main_progress += 1
+    self.assertGreater(main_progress, 0)
+    self.assertFalse(wait_fence.is_ready)
+    self.assertEqual(results, [])
+
+    wait_fence.signal()
+    thread.join()
+    self.assertEqual(len(results), 1)
+    np.testing.assert_allclose(results[0], [4., 10., 18., 28.])
+
+  def test_call_async_coarse_fences(self):
+    m = create_coarse_fences_mul_module(self.instance)
+    context = iree.runtime.VmContext(self.instance,
+                                     modules=[self.hal_module, m])
+    f = m.lookup_function("simple_mul")
+    finv = iree.runtime.FunctionInvoker(context, self.device, f, tracer=None)
+    arg0 = np.array([1., 2., 3., 4.], dtype=np.float32)
+    arg1 = np.array([4., 5., 6., 7.], dtype=np.float32)
+
+    async def main():
+      return await asyncio.gather(finv.call_async(arg0, arg1),
+                                  finv.call_async(arg1, arg0))
+
+    for result in asyncio.run(main()):
+      np.testing.assert_allclose(result, [4., 10., 18., 28.])
 
 if __name__ == "__main__":
   logging.basicConfig(level=logging.DEBUG)
@@ -88,6 +88,16 @@ class VmTypesTest(unittest.TestCase):
     with self.assertRaises(IndexError):
       lst1.get_as_list(1)
 
+  def test_variant_list_push_refs(self):
+    lst1 = rt.VmVariantList(5)
+    lst2 = rt.VmVariantList(0)
+    lst3 = rt.VmVariantList(0)
+    lst1.push_refs([lst2, lst3])
+    self.assertEqual("<VmVariantList(2): [List[], List[]]>", str(lst1))
+    with self.assertRaises(AttributeError):
+      lst1.push_refs([lst2, 1])
+    self.assertEqual(2, len(lst1))
+
   def test_vm_buffer(self):
     b1 = rt.VmBuffer(10, alignment=0, mutable=True)
     print(b1)
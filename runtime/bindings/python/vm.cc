@@ -6,6 +6,7 @@
 
 #include "./vm.h"
 
+#include "./hal.h"
 #include "./status_utils.h"
 #include "iree/base/api.h"
 #include "iree/base/tracing.h"
@@ -126,6 +127,76 @@ void VmContext::Invoke(iree_vm_function_t f, VmVariantList& inputs,
   CheckApiStatus(status, "Error invoking function");
 }
 
+// Appends the (wait, signal) fences of the `coarse-fences` ABI model to
+// |inputs| if |f| uses it. An empty wait fence is passed if |wait_fence| is
+// NULL as all arguments are then ready on the host. Other models have no way
+// to wait asynchronously so |wait_fence| is waited on here and
+// |out_signal_fence| is left NULL.
+static iree_status_t AppendCoarseFences(iree_vm_function_t* f,
+                                        iree_hal_device_t* device,
+                                        iree_hal_fence_t* wait_fence,
+                                        iree_vm_list_t* inputs,
+                                        iree_hal_fence_t** out_signal_fence) {
+  *out_signal_fence = nullptr;
+  iree_string_view_t model =
+      iree_vm_function_lookup_attr_by_name(f, IREE_SV("iree.abi.model"));
+  if (!iree_string_view_equal(model, IREE_SV("coarse-fences"))) {
+    if (!wait_fence) return iree_ok_status();
+    return iree_hal_fence_wait(wait_fence, iree_infinite_timeout());
+  }
+
+  // The signal fence is a 0->1 transition on a new semaphore.
+  iree_hal_semaphore_t* semaphore = nullptr;
+  IREE_RETURN_IF_ERROR(iree_hal_semaphore_create(device, 0ull, &semaphore));
+  iree_hal_fence_t* signal_fence = nullptr;
+  iree_status_t status = iree_hal_fence_create_at(
+      semaphore, 1ull, iree_hal_device_host_allocator(device), &signal_fence);
+  iree_hal_semaphore_release(semaphore);
+
+  if (iree_status_is_ok(status)) {
+    iree_vm_ref_t wait_fence_ref = iree_vm_ref_null();
+    if (wait_fence) wait_fence_ref = iree_hal_fence_retain_ref(wait_fence);
+    status = iree_vm_list_push_ref_move(inputs, &wait_fence_ref);
+  }
+  if (iree_status_is_ok(status)) {
+    iree_vm_ref_t signal_fence_ref = iree_hal_fence_retain_ref(signal_fence);
+    status = iree_vm_list_push_ref_move(inputs, &signal_fence_ref);
+    iree_vm_ref_release(&signal_fence_ref);
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_signal_fence = signal_fence;
+  } else {
+    iree_hal_fence_release(signal_fence);
+  }
+  return status;
+}
+
+py::object VmContext::InvokeAsync(iree_vm_function_t f, VmVariantList& inputs,
+                                  VmVariantList& outputs, HalDevice& device,
+                                  HalFence* wait_fence) {
+  iree_hal_fence_t* signal_fence = nullptr;
+  iree_status_t status;
+  {
+    py::gil_scoped_release release;
+    status = AppendCoarseFences(
+        &f, device.raw_ptr(), wait_fence ? wait_fence->raw_ptr() : nullptr,
+        inputs.raw_ptr(), &signal_fence);
+    if (iree_status_is_ok(status)) {
+      status = iree_vm_invoke(raw_ptr(), f, IREE_VM_INVOCATION_FLAG_NONE,
+                              nullptr, inputs.raw_ptr(), outputs.raw_ptr(),
+                              iree_allocator_system());
+    }
+  }
+  if (!iree_status_is_ok(status)) {
+    iree_hal_fence_release(signal_fence);
+    CheckApiStatus(status, "Error invoking function");
+  }
+  if (!signal_fence) return py::none();
+  return py::cast(HalFence::StealFromRawPtr(signal_fence),
+                  py::return_value_policy::move);
+}
+
 //------------------------------------------------------------------------------
 // VmModule
 //------------------------------------------------------------------------------
@@ -242,6 +313,20 @@ void VmVariantList::PushRef(py::handle ref_or_object) {
                  "Failed to push ref");
 }
 
+void VmVariantList::PushRefs(py::sequence refs_or_objects) {
+  // The refs are borrowed from the sequence items, which keep them alive until
+  // the list has retained its own references.
+  std::vector<iree_vm_ref_t> refs;
+  refs.reserve(py::len(refs_or_objects));
+  for (py::handle ref_or_object : refs_or_objects) {
+    py::object py_ref = ref_or_object.attr(VmRef::kRefAttr);
+    refs.push_back(py::cast<VmRef&>(py_ref).ref());
+  }
+  CheckApiStatus(
+      iree_vm_list_push_refs_retain(raw_ptr(), refs.size(), refs.data()),
+      "Failed to push refs");
+}
+
 py::object VmVariantList::GetAsList(int index) {
   iree_vm_ref_t ref = {0};
   CheckApiStatus(iree_vm_list_get_ref_assign(raw_ptr(), index, &ref),
@@ -592,6 +677,7 @@ void SetupVmBindings(pybind11::module m) {
       .def("push_int", &VmVariantList::PushInt)
       .def("push_list", &VmVariantList::PushList)
       .def("push_ref", &VmVariantList::PushRef)
+      .def("push_refs", &VmVariantList::PushRefs)
       .def("__repr__", &VmVariantList::DebugString);
 
   py::class_<iree_vm_function_t>(m, "VmFunction")
@@ -635,7 +721,10 @@ void SetupVmBindings(pybind11::module m) {
            py::arg("modules") = std::optional<std::vector<VmModule*>>())
       .def("register_modules", &VmContext::RegisterModules)
       .def_property_readonly("context_id", &VmContext::context_id)
-      .def("invoke", &VmContext::Invoke);
+      .def("invoke", &VmContext::Invoke)
+      .def("invoke_async", &VmContext::InvokeAsync, py::arg("function"),
+           py::arg("arg_list"), py::arg("ret_list"), py::arg("device"),
+           py::arg("wait_fence") = nullptr);
 
   py::class_<VmModule>(m, "VmModule")
       .def_static("from_flatbuffer", &VmModule::FromFlatbufferBlob)
@@ -19,6 +19,8 @@ namespace iree {
 namespace python {
 
 class FunctionAbi;
+class HalDevice;
+class HalFence;
 
 //------------------------------------------------------------------------------
 // Retain/release bindings
@@ -107,6 +109,7 @@ class VmVariantList : public ApiRefCounted<VmVariantList, iree_vm_list_t> {
   void PushInt(int64_t ivalue);
   void PushList(VmVariantList& other);
   void PushRef(py::handle ref_or_object);
+  void PushRefs(py::sequence refs_or_objects);
   py::object GetAsList(int index);
   py::object GetAsRef(int index);
   py::object GetAsObject(int index, py::object clazz);
@@ -169,6 +172,17 @@ class VmContext : public ApiRefCounted<VmContext, iree_vm_context_t> {
   // Synchronously invokes the given function.
   void Invoke(iree_vm_function_t f, VmVariantList& inputs,
               VmVariantList& outputs);
+
+  // Invokes the given function without waiting on asynchronous work it
+  // schedules on |device|. Functions using the `coarse-fences` ABI model have
+  // |wait_fence| (or an empty fence if None) and a new signal fence appended to
+  // |inputs| and the signal fence is returned as a HalFence: |outputs| must not
+  // be used until it has been reached. All other functions are invoked once
+  // |wait_fence| is reached, complete synchronously and None is returned. The
+  // GIL is released for the duration of the call.
+  py::object InvokeAsync(iree_vm_function_t f, VmVariantList& inputs,
+                         VmVariantList& outputs, HalDevice& device,
+                         HalFence* wait_fence);
 };
 
 class VmInvocation : public ApiRefCounted<VmInvocation, iree_vm_invocation_t> {
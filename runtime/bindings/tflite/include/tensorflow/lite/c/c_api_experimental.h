@@ -32,6 +32,111 @@ extern "C" {
 TFL_CAPI_EXPORT extern TfLiteStatus TfLiteInterpreterResetVariableTensors(
     TfLiteInterpreter* interpreter);
 
+/// Returns the tensor index corresponding to the input tensor at
+/// `input_index` or -1 if the index is out of range.
+///
+/// WARNING: This is an experimental API and subject to change.
+TFL_CAPI_EXPORT extern int TfLiteInterpreterGetInputTensorIndex(
+    const TfLiteInterpreter* interpreter, int32_t input_index);
+
+/// Returns the tensor index corresponding to the output tensor at
+/// `output_index` or -1 if the index is out of range.
+///
+/// WARNING: This is an experimental API and subject to change.
+TFL_CAPI_EXPORT extern int TfLiteInterpreterGetOutputTensorIndex(
+    const TfLiteInterpreter* interpreter, int32_t output_index);
+
+/// Assigns (or reassigns) a custom memory allocation for the given
+/// tensor. `flags` is a bitmask, see TfLiteCustomAllocationFlags.
+/// The runtime does NOT take ownership of the underlying memory.
+///
+/// NOTE: User needs to call TfLiteInterpreterAllocateTensors() after this.
+/// Invalid/insufficient buffers will cause an error during
+/// TfLiteInterpreterAllocateTensors or TfLiteInterpreterInvoke (in case of
+/// dynamic shapes in the graph).
+///
+/// Parameters should satisfy the following conditions:
+/// 1. tensor->allocation_type == kTfLiteArenaRw or kTfLiteArenaRwPersistent
+///    In general, this is true for I/O tensors & variable tensors.
+/// 2. allocation->data has the appropriate permissions for runtime access
+///    (Read-only for inputs, Read-Write for others), and outlives
+///    TfLiteInterpreter.
+/// 3. allocation->bytes >= tensor->bytes.
+///    This condition is checked again if any tensors are resized.
+/// 4. allocation->data should be aligned to kDefaultTensorAlignment
+///    defined in lite/util.h. (Currently 64 bytes)
+///    This check is skipped if kTfLiteCustomAllocationFlagsSkipAlignCheck is
+///    set through `flags`.
+///
+/// Passing an allocation with NULL data resets the tensor to runtime-owned
+/// storage.
+///
+/// NOTE: IREE only supports custom allocations for input tensors. Outputs are
+/// allocated by the module and their tensor indices are rejected.
+///
+/// WARNING: This is an experimental API and subject to change.
+TFL_CAPI_EXPORT extern TfLiteStatus
+TfLiteInterpreterSetCustomAllocationForTensor(
+    TfLiteInterpreter* interpreter, int tensor_index,
+    const TfLiteCustomAllocation* allocation, int64_t flags);
+
+/// IREE extension: an asynchronous invocation of an interpreter.
+/// Holds the outputs of the invocation until deleted.
+typedef struct TfLiteInvocation TfLiteInvocation;
+
+/// IREE extension: submits an invocation using the current input tensor
+/// contents and returns without waiting for it to complete.
+///
+/// Input tensors are double-buffered: after submission they are backed by
+/// different storage that can be populated for the next invocation while the
+/// submitted one executes. Input contents are not preserved across
+/// submissions. Tensors with custom allocations are not double-buffered and
+/// must not be modified until the invocation completes.
+///
+/// The returned invocation must be deleted with TfLiteInvocationDelete prior
+/// to deleting the interpreter. Modules compiled without the asynchronous
+/// entry point are invoked synchronously and return a completed invocation.
+///
+/// WARNING: This is an experimental API and subject to change.
+TFL_CAPI_EXPORT extern TfLiteStatus TfLiteInterpreterInvokeAsync(
+    TfLiteInterpreter* interpreter, TfLiteInvocation** out_invocation);
+
+/// IREE extension: returns true if the invocation has completed (successfully
+/// or not) and TfLiteInvocationWait will not block.
+///
+/// WARNING: This is an experimental API and subject to change.
+TFL_CAPI_EXPORT extern bool TfLiteInvocationIsReady(
+    TfLiteInvocation* invocation);
+
+/// IREE extension: blocks until the invocation has completed and its output
+/// tensors are available.
+///
+/// WARNING: This is an experimental API and subject to change.
+TFL_CAPI_EXPORT extern TfLiteStatus TfLiteInvocationWait(
+    TfLiteInvocation* invocation);
+
+/// IREE extension: returns the number of output tensors of the invocation.
+///
+/// WARNING: This is an experimental API and subject to change.
+TFL_CAPI_EXPORT extern int32_t TfLiteInvocationGetOutputTensorCount(
+    const TfLiteInvocation* invocation);
+
+/// IREE extension: returns the tensor associated with the output index or
+/// NULL if the index is out of range. Only the shape is valid until
+/// TfLiteInvocationWait has returned successfully.
+///
+/// WARNING: This is an experimental API and subject to change.
+TFL_CAPI_EXPORT extern const TfLiteTensor* TfLiteInvocationGetOutputTensor(
+    const TfLiteInvocation* invocation, int32_t output_index);
+
+/// IREE extension: deletes the invocation, waiting for it to complete if
+/// required. Its input storage is returned to the interpreter for reuse.
+/// Must be called from the thread using the interpreter.
+///
+/// WARNING: This is an experimental API and subject to change.
+TFL_CAPI_EXPORT extern void TfLiteInvocationDelete(
+    TfLiteInvocation* invocation);
+
 #if defined(IREE_BINDINGS_TFLITE_INCLUDE_UNSUPPORTED_APIS)
 
 /// Adds an op registration for a builtin operator.
@@ -429,6 +429,12 @@ typedef struct TfLiteSparsity {
   int dim_metadata_size;
 } TfLiteSparsity;
 
+#else
+
+typedef struct TfLiteTensor TfLiteTensor;
+
+#endif  // IREE_BINDINGS_TFLITE_INCLUDE_UNSUPPORTED_APIS
+
 // Defines a custom memory allocation not owned by the runtime.
 // `data` should be aligned to kDefaultTensorAlignment defined in
 // lite/util.h. (Currently 64 bytes)
@@ -438,11 +444,16 @@ typedef struct TfLiteCustomAllocation {
   size_t bytes;
 } TfLiteCustomAllocation;
 
-#else
-
-typedef struct TfLiteTensor TfLiteTensor;
-
-#endif  // IREE_BINDINGS_TFLITE_INCLUDE_UNSUPPORTED_APIS
+// The flags used in `Interpreter::SetCustomAllocationForTensor`.
+// Note that this is a bitmask, so the values should be 1, 2, 4, 8, ...etc.
+typedef enum TfLiteCustomAllocationFlags {
+  kTfLiteCustomAllocationFlagsNone = 0,
+  // Skips checking whether allocation.data points to an aligned buffer as
+  // expected by the TFLite runtime.
+  // NOTE: Setting this flag can cause crashes when calling Invoke().
+  // Use with caution.
+  kTfLiteCustomAllocationFlagsSkipAlignCheck = 1,
+} TfLiteCustomAllocationFlags;
 
 // A tensor in the interpreter system which is a wrapper around a buffer of
 // data including a dimensionality (or NULL if not currently defined).
@@ -10,6 +10,7 @@
 #include "iree/base/tracing.h"
 #include "iree/hal/drivers/init.h"
 #include "iree/modules/hal/module.h"
+#include "runtime/bindings/tflite/invocation.h"
 #include "runtime/bindings/tflite/model.h"
 #include "runtime/bindings/tflite/shim.h"
 #include "runtime/bindings/tflite/tensor.h"
@@ -68,6 +69,54 @@ static iree_status_t _TfLiteInterpreterPrepareHAL(
   return iree_ok_status();
 }
 
+//===----------------------------------------------------------------------===//
+// VM invocation
+//===----------------------------------------------------------------------===//
+
+// Synchronously invokes |fn| in the interpreter context.
+// Equivalent to iree_vm_invoke but reuses the interpreter invocation state so
+// that the VM stack storage persists across calls instead of being
+// reinitialized in a fresh multi-KB stack frame for each one.
+static iree_status_t _TfLiteInterpreterCall(TfLiteInterpreter* interpreter,
+                                            iree_vm_function_t fn,
+                                            const iree_vm_list_t* inputs,
+                                            iree_vm_list_t* outputs) {
+  iree_vm_invoke_state_t* state = &interpreter->invoke_state;
+  iree_status_t status = iree_vm_begin_invoke(
+      state, interpreter->context, fn, IREE_VM_INVOCATION_FLAG_NONE,
+      /*policy=*/NULL, inputs, interpreter->allocator);
+  while (iree_status_is_deferred(status)) {
+    // Invocations only yield when waiting on the device or for cooperative
+    // scheduling; waits are performed inline as the tflite API is blocking.
+    iree_vm_stack_frame_t* current_frame =
+        iree_vm_stack_current_frame(state->stack);
+    if (IREE_UNLIKELY(!current_frame)) {
+      status = iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                                "unbalanced stack after yield");
+      break;
+    } else if (current_frame->type == IREE_VM_STACK_FRAME_WAIT) {
+      iree_vm_wait_frame_t* wait_frame =
+          (iree_vm_wait_frame_t*)iree_vm_stack_frame_storage(current_frame);
+      status =
+          iree_vm_wait_invoke(state, wait_frame, IREE_TIME_INFINITE_FUTURE);
+      if (!iree_status_is_ok(status)) break;
+    }
+    status = iree_vm_resume_invoke(state);
+  }
+
+  // Retrieve the result of the invocation or tear down the state if the
+  // invocation itself failed.
+  iree_status_t invoke_status = iree_ok_status();
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_end_invoke(state, outputs, &invoke_status);
+  }
+  if (!iree_status_is_ok(status)) {
+    iree_vm_abort_invoke(state);
+    return status;
+  }
+  return invoke_status;
+}
+
 //===----------------------------------------------------------------------===//
 // Model shape function query/mutation utilities
 //===----------------------------------------------------------------------===//
@@ -156,10 +205,8 @@ static iree_status_t _TfLiteInterpreterShapeFrameApply(
   // Populate shape_list with the shape dimensions for this particular output.
   iree_vm_value_t index_value = iree_vm_value_make_i32(index);
   IREE_IGNORE_ERROR(iree_vm_list_set_value(frame->arg_list, 0, &index_value));
-  return iree_vm_invoke(interpreter->context, apply_fn,
-                        IREE_VM_INVOCATION_FLAG_NONE,
-                        /*policy=*/NULL, frame->arg_list, /*outputs=*/NULL,
-                        interpreter->allocator);
+  return _TfLiteInterpreterCall(interpreter, apply_fn, frame->arg_list,
+                                /*outputs=*/NULL);
 }
 
 //===----------------------------------------------------------------------===//
@@ -169,8 +216,6 @@ static iree_status_t _TfLiteInterpreterShapeFrameApply(
 // Queries all input shapes from the module; some may still be dynamic (-1).
 static iree_status_t _TfLiteInterpreterRefreshInputShapes(
     TfLiteInterpreter* interpreter, _TfLiteInterpreterShapeFrame* frame) {
-  // NOTE: we could optimize this more by using iree_vm_invoke_within, but that
-  // shouldn't be needed (it's just stack pointer manipulation).
   for (int32_t i = 0; i < interpreter->model->input_count; ++i) {
     TfLiteTensor* tensor = &interpreter->input_tensors[i];
     IREE_RETURN_IF_ERROR(_TfLiteInterpreterShapeFrameApply(
@@ -185,8 +230,6 @@ static iree_status_t _TfLiteInterpreterRefreshInputShapes(
 // shapes to compute the possibly dynamic values.
 static iree_status_t _TfLiteInterpreterRefreshOutputShapes(
     TfLiteInterpreter* interpreter, _TfLiteInterpreterShapeFrame* frame) {
-  // NOTE: we could optimize this more by using iree_vm_invoke_within, but that
-  // shouldn't be needed (it's just stack pointer manipulation).
   for (int32_t i = 0; i < interpreter->model->output_count; ++i) {
     TfLiteTensor* tensor = &interpreter->output_tensors[i];
     IREE_RETURN_IF_ERROR(_TfLiteInterpreterShapeFrameApply(
@@ -198,6 +241,18 @@ static iree_status_t _TfLiteInterpreterRefreshOutputShapes(
   return iree_ok_status();
 }
 
+// Refreshes only the output tensor shapes by querying the module; used after
+// invocation as input shapes only change on resize.
+static iree_status_t _TfLiteInterpreterRefreshOutputShapesOnly(
+    TfLiteInterpreter* interpreter) {
+  _TfLiteInterpreterShapeFrame frame;
+  IREE_RETURN_IF_ERROR(_TfLiteInterpreterShapeFrameInitialize(&frame));
+  iree_status_t status =
+      _TfLiteInterpreterRefreshOutputShapes(interpreter, &frame);
+  _TfLiteInterpreterShapeFrameDeinitialize(&frame);
+  return status;
+}
+
 // Refreshes both input and output tensor shapes by querying the module.
 // This should be called after each shape change so that we can let the module
 // run "shape propagation" and compute the new output shapes.
@@ -446,10 +501,8 @@ TFL_CAPI_EXPORT extern TfLiteStatus TfLiteInterpreterResetVariableTensors(
   iree_vm_function_t reset_variables_fn =
       interpreter->model->exports._reset_variables;
   if (!iree_vm_function_is_null(reset_variables_fn)) {
-    status = iree_vm_invoke(interpreter->context, reset_variables_fn,
-                            IREE_VM_INVOCATION_FLAG_NONE,
-                            /*policy=*/NULL, /*inputs=*/NULL, /*outputs=*/NULL,
-                            interpreter->allocator);
+    status = _TfLiteInterpreterCall(interpreter, reset_variables_fn,
+                                    /*inputs=*/NULL, /*outputs=*/NULL);
   }
 
   IREE_TRACE_ZONE_END(z0);
@@ -516,6 +569,19 @@ TFL_CAPI_EXPORT extern TfLiteStatus TfLiteInterpreterResizeInputTensor(
   return _TfLiteStatusFromIREEStatus(status);
 }
 
+// Repopulates the input list passed to _main with the current input buffers.
+static iree_status_t _TfLiteInterpreterResetInputList(
+    TfLiteInterpreter* interpreter) {
+  IREE_RETURN_IF_ERROR(iree_vm_list_resize(interpreter->input_list, 0));
+  for (iree_host_size_t i = 0; i < interpreter->model->input_count; ++i) {
+    iree_vm_ref_t buffer_ref =
+        iree_hal_buffer_retain_ref(interpreter->input_tensors[i].buffer);
+    IREE_RETURN_IF_ERROR(
+        iree_vm_list_push_ref_move(interpreter->input_list, &buffer_ref));
+  }
+  return iree_ok_status();
+}
+
 static iree_status_t _TfLiteInterpreterAllocateTensors(
     TfLiteInterpreter* interpreter) {
   // NOTE: we could slab allocate like tflite does, but then if any single
@@ -537,10 +603,8 @@ static iree_status_t _TfLiteInterpreterAllocateTensors(
     IREE_RETURN_IF_ERROR(_TfLiteTensorReallocateIfNeeded(
         tensor, iree_hal_device_allocator(interpreter->device),
         interpreter->allocator));
-    iree_vm_ref_t buffer_ref = iree_hal_buffer_retain_ref(tensor->buffer);
-    IREE_RETURN_IF_ERROR(
-        iree_vm_list_push_ref_move(interpreter->input_list, &buffer_ref));
   }
+  IREE_RETURN_IF_ERROR(_TfLiteInterpreterResetInputList(interpreter));
 
   // TODO(benvanik): preallocate outputs when we support using them.
   // We could stash the buffer views in interpreter->output_list.
@@ -571,25 +635,73 @@ TFL_CAPI_EXPORT extern TfLiteStatus TfLiteInterpreterAllocateTensors(
   return _TfLiteStatusFromIREEStatus(status);
 }
 
+TFL_CAPI_EXPORT extern int TfLiteInterpreterGetInputTensorIndex(
+    const TfLiteInterpreter* interpreter, int32_t input_index) {
+  if (input_index < 0 || input_index >= interpreter->model->input_count) {
+    return -1;
+  }
+  // Inputs occupy the first tensor indices followed by the outputs.
+  return input_index;
+}
+
+TFL_CAPI_EXPORT extern int TfLiteInterpreterGetOutputTensorIndex(
+    const TfLiteInterpreter* interpreter, int32_t output_index) {
+  if (output_index < 0 || output_index >= interpreter->model->output_count) {
+    return -1;
+  }
+  return interpreter->model->input_count + output_index;
+}
+
+static iree_status_t _TfLiteInterpreterSetCustomAllocationForTensor(
+    TfLiteInterpreter* interpreter, int tensor_index,
+    const TfLiteCustomAllocation* allocation, int64_t flags) {
+  // Only inputs can be bound to caller memory: outputs are allocated by the
+  // module when it is invoked.
+  int32_t input_count = interpreter->model->input_count;
+  if (tensor_index < 0 || tensor_index >= input_count) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "tensor_index %d is not an input tensor (0 <= "
+                            "index < %d)",
+                            tensor_index, input_count);
+  }
+  // Drop the list reference to the old buffer so that it is released; the
+  // list is repopulated with the new buffer on allocation.
+  IREE_RETURN_IF_ERROR(iree_vm_list_resize(interpreter->input_list, 0));
+  return _TfLiteTensorSetCustomAllocation(
+      &interpreter->input_tensors[tensor_index], allocation, flags);
+}
+
+TFL_CAPI_EXPORT extern TfLiteStatus
+TfLiteInterpreterSetCustomAllocationForTensor(
+    TfLiteInterpreter* interpreter, int tensor_index,
+    const TfLiteCustomAllocation* allocation, int64_t flags) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_status_t status = _TfLiteInterpreterSetCustomAllocationForTensor(
+      interpreter, tensor_index, allocation, flags);
+  IREE_TRACE_ZONE_END(z0);
+  return _TfLiteStatusFromIREEStatus(status);
+}
+
 static iree_status_t _TfLiteInterpreterInvoke(TfLiteInterpreter* interpreter) {
   // tflite models only have a single entry point and the IREE converter
   // emits it as '_main'.
-  IREE_RETURN_IF_ERROR(
-      iree_vm_invoke(interpreter->context, interpreter->model->exports._main,
-                     IREE_VM_INVOCATION_FLAG_NONE,
-                     /*policy=*/NULL, interpreter->input_list,
-                     interpreter->output_list, interpreter->allocator));
+  IREE_RETURN_IF_ERROR(_TfLiteInterpreterCall(
+      interpreter, interpreter->model->exports._main, interpreter->input_list,
+      interpreter->output_list));
 
   // Refresh output shapes.
-  // TODO(#3975): just use buffer view results or at least just refresh outputs.
-  IREE_RETURN_IF_ERROR(_TfLiteInterpreterRefreshIOShapes(interpreter));
+  // TODO(#3975): just use buffer view results.
+  IREE_RETURN_IF_ERROR(_TfLiteInterpreterRefreshOutputShapesOnly(interpreter));
 
   // Map the output buffers.
   // NOTE: we could defer the mapping unless requested and ensure state buffers
   // remain where they currently are for the next invocation.
+  const iree_vm_ref_t* output_refs = NULL;
+  IREE_RETURN_IF_ERROR(iree_vm_list_map_refs(interpreter->output_list, 0,
+                                             interpreter->model->output_count,
+                                             &output_refs));
   for (iree_host_size_t i = 0; i < interpreter->model->output_count; ++i) {
-    iree_hal_buffer_t* buffer =
-        iree_vm_list_get_buffer_assign(interpreter->output_list, i);
+    iree_hal_buffer_t* buffer = iree_hal_buffer_deref(output_refs[i]);
     TfLiteTensor* tensor = &interpreter->output_tensors[i];
     IREE_RETURN_IF_ERROR(_TfLiteTensorBind(tensor, buffer));
   }
@@ -616,6 +728,99 @@ TFL_CAPI_EXPORT extern TfLiteStatus TfLiteInterpreterInvoke(
   return _TfLiteStatusFromIREEStatus(status);
 }
 
+// Submits |invocation| with the current input buffers and rotates the input
+// tensors to new storage so the next invocation can be prepared.
+static iree_status_t _TfLiteInterpreterSubmit(TfLiteInterpreter* interpreter,
+                                              TfLiteInvocation* invocation) {
+  // Capture the current input buffers; the invocation retains them until it is
+  // deleted so they stay live while the device reads them.
+  for (iree_host_size_t i = 0; i < interpreter->model->input_count; ++i) {
+    iree_hal_buffer_t* buffer = interpreter->input_tensors[i].buffer;
+    if (!buffer) {
+      return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                              "input tensor %" PRIhsz
+                              " not allocated; call "
+                              "TfLiteInterpreterAllocateTensors first",
+                              i);
+    }
+    iree_vm_ref_t buffer_ref = iree_hal_buffer_retain_ref(buffer);
+    IREE_RETURN_IF_ERROR(
+        iree_vm_list_push_ref_move(invocation->input_list, &buffer_ref));
+  }
+
+  // Use the `coarse-fences` variant when available so that the call returns
+  // once the work is scheduled. The inputs are ready when submitted so there
+  // is no wait fence.
+  iree_vm_function_t fn = interpreter->model->exports._main_async;
+  if (!iree_vm_function_is_null(fn)) {
+    iree_hal_semaphore_t* semaphore = NULL;
+    IREE_RETURN_IF_ERROR(
+        iree_hal_semaphore_create(interpreter->device, 0ull, &semaphore));
+    iree_status_t status = iree_hal_fence_create_at(
+        semaphore, 1ull, interpreter->allocator, &invocation->signal_fence);
+    iree_hal_semaphore_release(semaphore);
+    IREE_RETURN_IF_ERROR(status);
+    iree_vm_ref_t wait_fence_ref = iree_vm_ref_null();
+    IREE_RETURN_IF_ERROR(
+        iree_vm_list_push_ref_move(invocation->input_list, &wait_fence_ref));
+    iree_vm_ref_t signal_fence_ref =
+        iree_hal_fence_retain_ref(invocation->signal_fence);
+    IREE_RETURN_IF_ERROR(
+        iree_vm_list_push_ref_move(invocation->input_list, &signal_fence_ref));
+  } else {
+    fn = interpreter->model->exports._main;
+  }
+  IREE_RETURN_IF_ERROR(_TfLiteInterpreterCall(
+      interpreter, fn, invocation->input_list, invocation->output_list));
+
+  // Output shapes are computed on the host while scheduling and are available
+  // before the outputs themselves.
+  IREE_RETURN_IF_ERROR(_TfLiteInterpreterRefreshOutputShapesOnly(interpreter));
+  for (iree_host_size_t i = 0; i < interpreter->model->output_count; ++i) {
+    const TfLiteTensor* source = &interpreter->output_tensors[i];
+    TfLiteTensor* tensor = &invocation->output_tensors[i];
+    tensor->shape_rank = source->shape_rank;
+    memcpy(tensor->shape_dims, source->shape_dims,
+           sizeof(tensor->shape_dims[0]) * source->shape_rank);
+  }
+
+  // Swap the input tensors to their spare buffers so the caller can populate
+  // the next invocation while this one is in flight.
+  for (iree_host_size_t i = 0; i < interpreter->model->input_count; ++i) {
+    IREE_RETURN_IF_ERROR(_TfLiteTensorRotateBuffer(
+        &interpreter->input_tensors[i],
+        iree_hal_device_allocator(interpreter->device),
+        interpreter->allocator));
+  }
+  return _TfLiteInterpreterResetInputList(interpreter);
+}
+
+TFL_CAPI_EXPORT extern TfLiteStatus TfLiteInterpreterInvokeAsync(
+    TfLiteInterpreter* interpreter, TfLiteInvocation** out_invocation) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  *out_invocation = NULL;
+
+  TfLiteInvocation* invocation = NULL;
+  iree_status_t status = _TfLiteInvocationCreate(interpreter, &invocation);
+  if (iree_status_is_ok(status)) {
+    status = _TfLiteInterpreterSubmit(interpreter, invocation);
+  }
+  if (iree_status_is_ok(status)) {
+    *out_invocation = invocation;
+  } else {
+    // Fail the fence (if created) so deletion does not wait on work that was
+    // never scheduled and does not reuse the input buffers.
+    if (invocation && invocation->signal_fence) {
+      iree_hal_fence_fail(invocation->signal_fence,
+                          iree_status_from_code(IREE_STATUS_ABORTED));
+    }
+    TfLiteInvocationDelete(invocation);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return _TfLiteStatusFromIREEStatus(status);
+}
+
 TFL_CAPI_EXPORT extern int32_t TfLiteInterpreterGetOutputTensorCount(
     const TfLiteInterpreter* interpreter) {
   return interpreter->model->output_count;
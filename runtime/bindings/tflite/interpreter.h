@@ -39,6 +39,11 @@ struct TfLiteInterpreter {
   };
   iree_vm_context_t* context;
 
+  // Invocation state (including the VM stack storage) reused across all calls
+  // into the context. tflite interpreters are not thread-safe so there is only
+  // ever one invocation in flight.
+  iree_vm_invoke_state_t invoke_state;
+
   iree_vm_list_t* input_list;
   iree_vm_list_t* output_list;
   TfLiteTensor* input_tensors;
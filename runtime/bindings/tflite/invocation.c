@@ -0,0 +1,174 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "runtime/bindings/tflite/invocation.h"
+
+#include "iree/base/tracing.h"
+#include "iree/modules/hal/module.h"
+#include "runtime/bindings/tflite/shim.h"
+
+// Computes the storage requirement for the TfLiteInvocation struct.
+static iree_host_size_t _TfLiteInvocationCalculateSize(
+    const TfLiteModel* model) {
+  iree_host_size_t total_size =
+      iree_host_align(sizeof(TfLiteInvocation), iree_max_align_t);
+
+  // Inputs are followed by the (wait, signal) fences so the list is variant.
+  total_size +=
+      iree_vm_list_storage_size(/*element_type=*/NULL, model->input_count + 2);
+  iree_vm_type_def_t buffer_type_def =
+      iree_vm_make_ref_type_def(iree_hal_buffer_type());
+  total_size +=
+      iree_vm_list_storage_size(&buffer_type_def, model->output_count);
+  total_size += sizeof(TfLiteTensor) * model->output_count;
+
+  return total_size;
+}
+
+iree_status_t _TfLiteInvocationCreate(TfLiteInterpreter* interpreter,
+                                      TfLiteInvocation** out_invocation) {
+  *out_invocation = NULL;
+  const TfLiteModel* model = interpreter->model;
+  iree_host_size_t invocation_size = _TfLiteInvocationCalculateSize(model);
+  TfLiteInvocation* invocation = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      interpreter->allocator, invocation_size, (void**)&invocation));
+  memset(invocation, 0, invocation_size);
+  invocation->allocator = interpreter->allocator;
+  invocation->interpreter = interpreter;
+
+  uint8_t* p = (uint8_t*)invocation +
+               iree_host_align(sizeof(*invocation), iree_max_align_t);
+
+  iree_byte_span_t input_list_storage = iree_make_byte_span(
+      p, iree_vm_list_storage_size(/*element_type=*/NULL,
+                                   model->input_count + 2));
+  iree_status_t status =
+      iree_vm_list_initialize(input_list_storage, /*element_type=*/NULL,
+                              model->input_count + 2, &invocation->input_list);
+  p += input_list_storage.data_length;
+
+  iree_vm_type_def_t buffer_type_def =
+      iree_vm_make_ref_type_def(iree_hal_buffer_type());
+  iree_byte_span_t output_list_storage = iree_make_byte_span(
+      p, iree_vm_list_storage_size(&buffer_type_def, model->output_count));
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_list_initialize(output_list_storage, &buffer_type_def,
+                                     model->output_count,
+                                     &invocation->output_list);
+  }
+  p += output_list_storage.data_length;
+
+  invocation->output_tensors = (TfLiteTensor*)p;
+  for (int32_t i = 0; i < model->output_count; ++i) {
+    const TfLiteTensor* source = &interpreter->output_tensors[i];
+    TfLiteTensor* tensor = &invocation->output_tensors[i];
+    tensor->type = source->type;
+    tensor->quantization_params = source->quantization_params;
+    tensor->name = source->name;
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_invocation = invocation;
+  } else {
+    TfLiteInvocationDelete(invocation);
+  }
+  return status;
+}
+
+TFL_CAPI_EXPORT extern bool TfLiteInvocationIsReady(
+    TfLiteInvocation* invocation) {
+  if (!invocation->signal_fence) return true;
+  iree_status_t status = iree_hal_fence_query(invocation->signal_fence);
+  bool is_ready = !iree_status_is_deferred(status);
+  iree_status_ignore(status);
+  return is_ready;
+}
+
+static iree_status_t _TfLiteInvocationWait(TfLiteInvocation* invocation) {
+  if (invocation->signal_fence) {
+    IREE_RETURN_IF_ERROR(iree_hal_fence_wait(invocation->signal_fence,
+                                             iree_infinite_timeout()));
+  }
+  if (invocation->outputs_bound) return iree_ok_status();
+
+  // Map the output buffers now that their contents are available.
+  int32_t output_count = invocation->interpreter->model->output_count;
+  const iree_vm_ref_t* output_refs = NULL;
+  IREE_RETURN_IF_ERROR(iree_vm_list_map_refs(invocation->output_list, 0,
+                                             output_count, &output_refs));
+  for (int32_t i = 0; i < output_count; ++i) {
+    IREE_RETURN_IF_ERROR(_TfLiteTensorBind(
+        &invocation->output_tensors[i], iree_hal_buffer_deref(output_refs[i])));
+  }
+  invocation->outputs_bound = true;
+  return iree_ok_status();
+}
+
+TFL_CAPI_EXPORT extern TfLiteStatus TfLiteInvocationWait(
+    TfLiteInvocation* invocation) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_status_t status = _TfLiteInvocationWait(invocation);
+  IREE_TRACE_ZONE_END(z0);
+  return _TfLiteStatusFromIREEStatus(status);
+}
+
+TFL_CAPI_EXPORT extern int32_t TfLiteInvocationGetOutputTensorCount(
+    const TfLiteInvocation* invocation) {
+  return invocation->interpreter->model->output_count;
+}
+
+TFL_CAPI_EXPORT extern const TfLiteTensor* TfLiteInvocationGetOutputTensor(
+    const TfLiteInvocation* invocation, int32_t output_index) {
+  if (output_index < 0 ||
+      output_index >= invocation->interpreter->model->output_count) {
+    return NULL;
+  }
+  return &invocation->output_tensors[output_index];
+}
+
+TFL_CAPI_EXPORT extern void TfLiteInvocationDelete(
+    TfLiteInvocation* invocation) {
+  if (!invocation) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  TfLiteInterpreter* interpreter = invocation->interpreter;
+
+  // The input buffers may still be in use by the device until the invocation
+  // completes. Failures are ignored as the buffers are not reused if so.
+  bool is_complete = true;
+  if (invocation->signal_fence) {
+    is_complete = iree_status_consume_code(iree_hal_fence_wait(
+                      invocation->signal_fence, iree_infinite_timeout())) ==
+                  IREE_STATUS_OK;
+  }
+
+  // Return the input buffers to the interpreter so the next submission can
+  // reuse them instead of allocating.
+  if (invocation->input_list) {
+    iree_host_size_t input_count =
+        iree_min(iree_vm_list_size(invocation->input_list),
+                 (iree_host_size_t)interpreter->model->input_count);
+    for (iree_host_size_t i = 0; is_complete && i < input_count; ++i) {
+      iree_vm_ref_t buffer_ref = iree_vm_ref_null();
+      if (iree_status_is_ok(iree_vm_list_get_ref_assign(invocation->input_list,
+                                                        i, &buffer_ref))) {
+        _TfLiteTensorRecycleBuffer(&interpreter->input_tensors[i],
+                                   iree_hal_buffer_deref(buffer_ref));
+      }
+    }
+    iree_vm_list_deinitialize(invocation->input_list);
+  }
+  if (invocation->output_list) {
+    iree_vm_list_deinitialize(invocation->output_list);
+  }
+  for (int32_t i = 0; i < interpreter->model->output_count; ++i) {
+    _TfLiteTensorDiscardBuffer(&invocation->output_tensors[i]);
+  }
+  iree_hal_fence_release(invocation->signal_fence);
+
+  iree_allocator_free(invocation->allocator, invocation);
+  IREE_TRACE_ZONE_END(z0);
+}
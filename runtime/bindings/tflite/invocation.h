@@ -0,0 +1,49 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BINDINGS_TFLITE_INVOCATION_H_
+#define IREE_BINDINGS_TFLITE_INVOCATION_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/vm/api.h"
+#include "runtime/bindings/tflite/interpreter.h"
+#include "runtime/bindings/tflite/tensor.h"
+
+// NOTE: we pull in our own copy here in case the tflite API changes upstream.
+#define TFL_COMPILE_LIBRARY 1
+#include "runtime/bindings/tflite/include/tensorflow/lite/c/c_api.h"
+#include "runtime/bindings/tflite/include/tensorflow/lite/c/c_api_experimental.h"
+
+struct TfLiteInvocation {
+  iree_allocator_t allocator;
+
+  // Interpreter the invocation was submitted to. Unretained; the invocation
+  // must be deleted before the interpreter.
+  TfLiteInterpreter* interpreter;
+
+  // Fence reached when the outputs are ready or NULL if the invocation
+  // completed synchronously.
+  iree_hal_fence_t* signal_fence;
+  // Set once the output tensors have been bound after completion.
+  bool outputs_bound;
+
+  // [inputs..., (wait, signal)] arguments of the invocation. Retains the input
+  // buffers so that they remain live while the invocation is in flight.
+  iree_vm_list_t* input_list;
+  iree_vm_list_t* output_list;
+
+  // Output tensors bound to the buffers in output_list. Names are borrowed
+  // from the interpreter.
+  TfLiteTensor* output_tensors;
+};
+
+// Allocates an invocation with storage for all I/O of the |interpreter| model.
+// Output tensor metadata is copied from the interpreter output tensors.
+iree_status_t _TfLiteInvocationCreate(TfLiteInterpreter* interpreter,
+                                      TfLiteInvocation** out_invocation);
+
+#endif  // IREE_BINDINGS_TFLITE_INVOCATION_H_
@@ -95,6 +95,13 @@ static iree_status_t _TfLiteModelInitializeModule(const void* flatbuffer_data,
       iree_make_cstring_view("_tflite_main_reset_variables"),
       &model->exports._reset_variables));
 
+  // Optional as older modules may not have it; asynchronous invocations fall
+  // back to _main when not present.
+  IREE_IGNORE_ERROR(iree_vm_module_lookup_function_by_name(
+      model->module, IREE_VM_FUNCTION_LINKAGE_EXPORT,
+      iree_make_cstring_view("_tflite_main_async"),
+      &model->exports._main_async));
+
   IREE_TRACE_ZONE_END(z0);
   return iree_ok_status();
 }
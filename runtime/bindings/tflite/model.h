@@ -22,6 +22,8 @@ typedef struct _TfLiteModelExports {
   iree_vm_function_t _resize_input_shape;
   iree_vm_function_t _query_output_shape;
   iree_vm_function_t _main;
+  // Optional `coarse-fences` variant of _main used for pipelined invocation.
+  iree_vm_function_t _main_async;
 } _TfLiteModelExports;
 
 struct TfLiteModel {
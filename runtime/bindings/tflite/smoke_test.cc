@@ -214,6 +214,154 @@ TEST(CApiSimple, StaticSmoke) {
   TfLiteInterpreterDelete(interpreter);
 }
 
+// Binds caller-owned memory as the input storage.
+TEST(CApiSimple, StaticCustomAllocation) {
+  TfLiteModel* model =
+      TfLiteModelCreate(IREE_BINDINGS_TFLITE_TESTDATA_ADD_STATIC_EMBEDDED_DATA,
+                        IREE_BINDINGS_TFLITE_TESTDATA_ADD_STATIC_EMBEDDED_SIZE);
+  ASSERT_NE(model, nullptr);
+  TfLiteInterpreter* interpreter = TfLiteInterpreterCreate(model, nullptr);
+  ASSERT_NE(interpreter, nullptr);
+  TfLiteModelDelete(model);
+
+  EXPECT_EQ(TfLiteInterpreterGetInputTensorIndex(interpreter, 0), 0);
+  EXPECT_EQ(TfLiteInterpreterGetInputTensorIndex(interpreter, 1), -1);
+  EXPECT_EQ(TfLiteInterpreterGetOutputTensorIndex(interpreter, 0), 1);
+  EXPECT_EQ(TfLiteInterpreterGetOutputTensorIndex(interpreter, 1), -1);
+
+  alignas(64) std::array<float, 1 * 8 * 8 * 3> input = {
+      1.f,
+      3.f,
+  };
+  alignas(64) std::array<float, 1 * 8 * 8 * 3> output = {0.f};
+  TfLiteCustomAllocation input_allocation = {input.data(),
+                                             input.size() * sizeof(float)};
+  TfLiteCustomAllocation output_allocation = {output.data(),
+                                              output.size() * sizeof(float)};
+  ASSERT_EQ(TfLiteInterpreterSetCustomAllocationForTensor(
+                interpreter,
+                TfLiteInterpreterGetInputTensorIndex(interpreter, 0),
+                &input_allocation, kTfLiteCustomAllocationFlagsNone),
+            kTfLiteOk);
+
+  // Only input tensors can be bound and misaligned storage is rejected.
+  EXPECT_NE(TfLiteInterpreterSetCustomAllocationForTensor(
+                interpreter,
+                TfLiteInterpreterGetOutputTensorIndex(interpreter, 0),
+                &output_allocation, kTfLiteCustomAllocationFlagsNone),
+            kTfLiteOk);
+  TfLiteCustomAllocation misaligned_allocation = {
+      reinterpret_cast<uint8_t*>(input.data()) + 4,
+      input.size() * sizeof(float) - 4};
+  EXPECT_NE(TfLiteInterpreterSetCustomAllocationForTensor(
+                interpreter, 0, &misaligned_allocation,
+                kTfLiteCustomAllocationFlagsNone),
+            kTfLiteOk);
+  EXPECT_NE(TfLiteInterpreterSetCustomAllocationForTensor(
+                interpreter, 2, &input_allocation,
+                kTfLiteCustomAllocationFlagsNone),
+            kTfLiteOk);
+
+  ASSERT_EQ(TfLiteInterpreterAllocateTensors(interpreter), kTfLiteOk);
+
+  TfLiteTensor* input_tensor = TfLiteInterpreterGetInputTensor(interpreter, 0);
+  ASSERT_NE(input_tensor, nullptr);
+  EXPECT_EQ(TfLiteTensorData(input_tensor), input.data());
+  EXPECT_EQ(TfLiteTensorByteSize(input_tensor), sizeof(float) * 1 * 8 * 8 * 3);
+
+  ASSERT_EQ(TfLiteInterpreterInvoke(interpreter), kTfLiteOk);
+
+  const TfLiteTensor* output_tensor =
+      TfLiteInterpreterGetOutputTensor(interpreter, 0);
+  ASSERT_NE(output_tensor, nullptr);
+  ASSERT_EQ(TfLiteTensorCopyToBuffer(output_tensor, output.data(),
+                                     output.size() * sizeof(float)),
+            kTfLiteOk);
+  EXPECT_EQ(output[0], 2.f);
+  EXPECT_EQ(output[1], 6.f);
+
+  // Updating the input in place is picked up by the next invocation.
+  input[0] = 5.f;
+  ASSERT_EQ(TfLiteInterpreterInvoke(interpreter), kTfLiteOk);
+  ASSERT_EQ(TfLiteTensorCopyToBuffer(output_tensor, output.data(),
+                                     output.size() * sizeof(float)),
+            kTfLiteOk);
+  EXPECT_EQ(output[0], 10.f);
+
+  TfLiteInterpreterDelete(interpreter);
+}
+
+// Pipelines two invocations with double-buffered inputs.
+TEST(CApiSimple, StaticInvokeAsync) {
+  TfLiteModel* model =
+      TfLiteModelCreate(IREE_BINDINGS_TFLITE_TESTDATA_ADD_STATIC_EMBEDDED_DATA,
+                        IREE_BINDINGS_TFLITE_TESTDATA_ADD_STATIC_EMBEDDED_SIZE);
+  ASSERT_NE(model, nullptr);
+  TfLiteInterpreter* interpreter = TfLiteInterpreterCreate(model, nullptr);
+  ASSERT_NE(interpreter, nullptr);
+  TfLiteModelDelete(model);
+
+  ASSERT_EQ(TfLiteInterpreterAllocateTensors(interpreter), kTfLiteOk);
+  TfLiteTensor* input_tensor = TfLiteInterpreterGetInputTensor(interpreter, 0);
+  ASSERT_NE(input_tensor, nullptr);
+
+  // Submit the first frame and populate the next one while it is in flight.
+  std::array<float, 1 * 8 * 8 * 3> input0 = {1.f, 3.f};
+  ASSERT_EQ(TfLiteTensorCopyFromBuffer(input_tensor, input0.data(),
+                                       input0.size() * sizeof(float)),
+            kTfLiteOk);
+  void* input0_data = TfLiteTensorData(input_tensor);
+  TfLiteInvocation* invocation0 = nullptr;
+  ASSERT_EQ(TfLiteInterpreterInvokeAsync(interpreter, &invocation0), kTfLiteOk);
+  ASSERT_NE(invocation0, nullptr);
+  EXPECT_NE(TfLiteTensorData(input_tensor), input0_data);
+
+  std::array<float, 1 * 8 * 8 * 3> input1 = {5.f, 7.f};
+  ASSERT_EQ(TfLiteTensorCopyFromBuffer(input_tensor, input1.data(),
+                                       input1.size() * sizeof(float)),
+            kTfLiteOk);
+  TfLiteInvocation* invocation1 = nullptr;
+  ASSERT_EQ(TfLiteInterpreterInvokeAsync(interpreter, &invocation1), kTfLiteOk);
+  ASSERT_NE(invocation1, nullptr);
+
+  ASSERT_EQ(TfLiteInvocationGetOutputTensorCount(invocation0), 1);
+  ASSERT_EQ(TfLiteInvocationWait(invocation0), kTfLiteOk);
+  EXPECT_TRUE(TfLiteInvocationIsReady(invocation0));
+  const TfLiteTensor* output_tensor0 =
+      TfLiteInvocationGetOutputTensor(invocation0, 0);
+  ASSERT_NE(output_tensor0, nullptr);
+  EXPECT_EQ(TfLiteTensorNumDims(output_tensor0), 4);
+  EXPECT_STREQ(TfLiteTensorName(output_tensor0), "output");
+  std::array<float, 1 * 8 * 8 * 3> output;
+  ASSERT_EQ(TfLiteTensorCopyToBuffer(output_tensor0, output.data(),
+                                     output.size() * sizeof(float)),
+            kTfLiteOk);
+  EXPECT_EQ(output[0], 2.f);
+  EXPECT_EQ(output[1], 6.f);
+
+  // Deleting the first invocation returns its input storage for the third.
+  TfLiteInvocationDelete(invocation0);
+
+  ASSERT_EQ(TfLiteInvocationWait(invocation1), kTfLiteOk);
+  const TfLiteTensor* output_tensor1 =
+      TfLiteInvocationGetOutputTensor(invocation1, 0);
+  ASSERT_NE(output_tensor1, nullptr);
+  ASSERT_EQ(TfLiteTensorCopyToBuffer(output_tensor1, output.data(),
+                                     output.size() * sizeof(float)),
+            kTfLiteOk);
+  EXPECT_EQ(output[0], 10.f);
+  EXPECT_EQ(output[1], 14.f);
+  EXPECT_EQ(TfLiteInvocationGetOutputTensor(invocation1, 1), nullptr);
+
+  TfLiteInvocation* invocation2 = nullptr;
+  ASSERT_EQ(TfLiteInterpreterInvokeAsync(interpreter, &invocation2), kTfLiteOk);
+  EXPECT_EQ(TfLiteTensorData(input_tensor), input0_data);
+  TfLiteInvocationDelete(invocation1);
+  TfLiteInvocationDelete(invocation2);
+
+  TfLiteInterpreterDelete(interpreter);
+}
+
 // TODO(#3971): fix cmake data deps.
 // TODO(#3972): plumb through quantization params.
 TEST(CApiSimple, DISABLED_QuantizationParams) {
@@ -103,6 +103,26 @@ static iree_status_t _TfLiteTypeToElementType(
   return iree_ok_status();
 }
 
+iree_status_t _TfLiteTensorSetCustomAllocation(
+    TfLiteTensor* tensor, const TfLiteCustomAllocation* allocation,
+    int64_t flags) {
+  // Allocations we import must be at least as aligned as those the HAL would
+  // make itself. The check can be skipped but the import may still reject it.
+  if (allocation->data &&
+      !iree_all_bits_set(flags, kTfLiteCustomAllocationFlagsSkipAlignCheck) &&
+      !iree_host_size_has_alignment((uintptr_t)allocation->data,
+                                    IREE_HAL_HEAP_BUFFER_ALIGNMENT)) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "custom allocation data must be aligned to %d bytes",
+        IREE_HAL_HEAP_BUFFER_ALIGNMENT);
+  }
+  _TfLiteTensorDiscardBuffer(tensor);
+  tensor->custom_allocation = *allocation;
+  tensor->custom_allocation_flags = flags;
+  return iree_ok_status();
+}
+
 iree_status_t _TfLiteTensorReallocateIfNeeded(
     TfLiteTensor* tensor, iree_hal_allocator_t* buffer_allocator,
     iree_allocator_t heap_allocator) {
@@ -127,25 +147,50 @@ iree_status_t _TfLiteTensorReallocateIfNeeded(
               IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR, &allocation_size));
   allocation_size *= storage_scalar;
 
-  // If the old buffer is the same size then no need to realloc.
+  // If the old buffer is the same size then no need to realloc. Changing the
+  // custom allocation discards the buffer so a buffer that is still present
+  // is backed by the current storage.
   if (tensor->buffer &&
       iree_hal_buffer_byte_length(tensor->buffer) == allocation_size) {
     IREE_TRACE_ZONE_END(z0);
     return iree_ok_status();
   }
+  _TfLiteTensorDiscardBuffer(tensor);
 
-  // Allocate the underlying buffer for the tensor.
-  IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_hal_allocator_allocate_buffer(
-              buffer_allocator,
-              (iree_hal_buffer_params_t){
-                  .type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL |
-                          IREE_HAL_MEMORY_TYPE_HOST_VISIBLE,
-                  .usage = IREE_HAL_BUFFER_USAGE_DISPATCH_STORAGE |
-                           IREE_HAL_BUFFER_USAGE_TRANSFER |
-                           IREE_HAL_BUFFER_USAGE_MAPPING,
-              },
-              allocation_size, iree_const_byte_span_empty(), &tensor->buffer));
+  iree_hal_buffer_params_t params = {
+      .type =
+          IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE,
+      .usage = IREE_HAL_BUFFER_USAGE_DISPATCH_STORAGE |
+               IREE_HAL_BUFFER_USAGE_TRANSFER | IREE_HAL_BUFFER_USAGE_MAPPING,
+  };
+  if (tensor->custom_allocation.data) {
+    // Import the caller memory directly so that the module reads from it
+    // without an intermediate copy.
+    if (tensor->custom_allocation.bytes < allocation_size) {
+      IREE_TRACE_ZONE_END(z0);
+      return iree_make_status(
+          IREE_STATUS_OUT_OF_RANGE,
+          "custom allocation of %" PRIhsz
+          " bytes is too small for the tensor; %" PRIdsz " bytes required",
+          tensor->custom_allocation.bytes, allocation_size);
+    }
+    iree_hal_external_buffer_t external_buffer = {
+        .type = IREE_HAL_EXTERNAL_BUFFER_TYPE_HOST_ALLOCATION,
+        .flags = IREE_HAL_EXTERNAL_BUFFER_FLAG_NONE,
+        .size = allocation_size,
+        .handle.host_allocation.ptr = tensor->custom_allocation.data,
+    };
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_hal_allocator_import_buffer(
+                buffer_allocator, params, &external_buffer,
+                iree_hal_buffer_release_callback_null(), &tensor->buffer));
+  } else {
+    // Allocate the underlying buffer for the tensor.
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_hal_allocator_allocate_buffer(
+                buffer_allocator, params, allocation_size,
+                iree_const_byte_span_empty(), &tensor->buffer));
+  }
 
   // Map the buffer memory immediately. The tflite API doesn't let us know if
   // this is a buffer the user will actually touch or some state buffer that is
@@ -196,6 +241,7 @@ void _TfLiteTensorDiscardBuffer(TfLiteTensor* tensor) {
   IREE_TRACE_ZONE_BEGIN(z0);
   if (tensor->buffer_mapping.contents.data != NULL) {
     iree_hal_buffer_unmap_range(&tensor->buffer_mapping);
+    memset(&tensor->buffer_mapping, 0, sizeof(tensor->buffer_mapping));
   }
   iree_hal_buffer_release(tensor->buffer);
   tensor->buffer = NULL;
@@ -204,6 +250,8 @@ void _TfLiteTensorDiscardBuffer(TfLiteTensor* tensor) {
 
 void _TfLiteTensorReset(TfLiteTensor* tensor, iree_allocator_t allocator) {
   _TfLiteTensorDiscardBuffer(tensor);
+  iree_hal_buffer_release(tensor->spare_buffer);
+  tensor->spare_buffer = NULL;
   if (tensor->name.data) {
     iree_allocator_free(allocator, (void*)tensor->name.data);
   }
@@ -245,6 +293,9 @@ TFL_CAPI_EXPORT extern TfLiteStatus TfLiteTensorCopyFromBuffer(
   if (input_data_size != tensor->buffer_mapping.contents.data_length) {
     return kTfLiteApplicationError;
   }
+  // Callers that filled the memory behind TfLiteTensorData (such as a custom
+  // allocation) in place need no copy.
+  if (input_data == tensor->buffer_mapping.contents.data) return kTfLiteOk;
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_VALUE(z0, tensor->buffer_mapping.contents.data_length);
 
@@ -264,6 +315,9 @@ TFL_CAPI_EXPORT extern TfLiteStatus TfLiteTensorCopyToBuffer(
   if (output_data_size != output_tensor->buffer_mapping.contents.data_length) {
     return kTfLiteApplicationError;
   }
+  if (output_data == output_tensor->buffer_mapping.contents.data) {
+    return kTfLiteOk;
+  }
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_VALUE(
       z0, output_tensor->buffer_mapping.contents.data_length);
@@ -38,6 +38,17 @@ struct TfLiteTensor {
   iree_hal_buffer_t* buffer;
   // Persistently mapped buffer; invalidated when buffer is resized.
   iree_hal_buffer_mapping_t buffer_mapping;
+
+  // Caller-owned memory assigned with
+  // TfLiteInterpreterSetCustomAllocationForTensor. When data is non-NULL the
+  // tensor buffer is imported from this memory instead of being allocated.
+  TfLiteCustomAllocation custom_allocation;
+  int64_t custom_allocation_flags;
+
+  // Idle buffer of the same size as buffer returned by a completed
+  // asynchronous invocation. Swapped in when the current buffer is handed off
+  // to a new invocation so that inputs are double-buffered.
+  iree_hal_buffer_t* spare_buffer;
 };
 
 // Parses a tfl.io.names value and sets the |tensor| name.
@@ -53,9 +64,17 @@ iree_status_t _TfLiteTensorParseTypeAttr(TfLiteTensor* tensor,
 iree_status_t _TfLiteTensorParseQuantAttr(TfLiteTensor* tensor,
                                           iree_string_view_t attr);
 
+// Assigns caller-owned memory to back the tensor, or if |allocation| has no
+// data reverts to runtime-allocated storage. The current buffer is discarded
+// and the new storage is bound on the next _TfLiteTensorReallocateIfNeeded.
+iree_status_t _TfLiteTensorSetCustomAllocation(
+    TfLiteTensor* tensor, const TfLiteCustomAllocation* allocation,
+    int64_t flags);
+
 // Reallocates and remaps the tensor buffer view if needed.
 // No-op if the buffer view is already allocated and its shape matches the
-// current tensor shape.
+// current tensor shape. Tensors with a custom allocation import the caller
+// memory instead of allocating.
 iree_status_t _TfLiteTensorReallocateIfNeeded(
     TfLiteTensor* tensor, iree_hal_allocator_t* buffer_allocator,
     iree_allocator_t heap_allocator);
@@ -65,6 +84,19 @@ iree_status_t _TfLiteTensorReallocateIfNeeded(
 iree_status_t _TfLiteTensorBind(TfLiteTensor* tensor,
                                 iree_hal_buffer_t* buffer);
 
+// Hands the current buffer off to an in-flight invocation (which must retain
+// it) and binds the spare buffer or a newly allocated one in its place.
+// Contents are not preserved. No-op for tensors with custom allocations.
+iree_status_t _TfLiteTensorRotateBuffer(TfLiteTensor* tensor,
+                                        iree_hal_allocator_t* buffer_allocator,
+                                        iree_allocator_t heap_allocator);
+
+// Offers a |buffer| previously handed off with _TfLiteTensorRotateBuffer for
+// reuse once the invocation using it has completed. The buffer is retained
+// only if it can be reused for the current tensor shape.
+void _TfLiteTensorRecycleBuffer(TfLiteTensor* tensor,
+                                iree_hal_buffer_t* buffer);
+
 // Discards the current buffer view, if any, resetting it to NULL.
 void _TfLiteTensorDiscardBuffer(TfLiteTensor* tensor);
 
@@ -9,6 +9,7 @@
 #include <stdint.h>
 #include <string.h>
 
+#include "iree/base/internal/cpu.h"
 #include "iree/base/tracing.h"
 
 //===----------------------------------------------------------------------===//
@@ -27,6 +28,27 @@ void iree_arena_block_pool_initialize(iree_host_size_t total_block_size,
   out_block_pool->block_allocator = block_allocator;
   iree_atomic_arena_block_slist_initialize(&out_block_pool->available_slist);
 
+  // One cache per processor so that pools on small systems don't pay for (or
+  // scan) caches that can never be selected. The caches are only an
+  // optimization and if they can't be allocated all blocks go through the
+  // shared list.
+  iree_host_size_t cache_count =
+      iree_min(iree_cpu_query_processor_count(),
+               (iree_host_size_t)IREE_ARENA_BLOCK_POOL_MAX_CACHE_COUNT);
+  iree_arena_block_cache_slot_t* caches = NULL;
+  iree_status_t status = iree_allocator_malloc_aligned(
+      block_allocator, cache_count * sizeof(*caches),
+      iree_hardware_destructive_interference_size, 0, (void**)&caches);
+  if (iree_status_is_ok(status)) {
+    for (iree_host_size_t i = 0; i < cache_count; ++i) {
+      iree_slim_mutex_initialize(&caches[i].cache.mutex);
+    }
+    out_block_pool->cache_count = cache_count;
+    out_block_pool->caches = caches;
+  } else {
+    iree_status_ignore(status);
+  }
+
   IREE_TRACE_ZONE_END(z0);
 }
 
@@ -36,33 +58,113 @@ void iree_arena_block_pool_deinitialize(iree_arena_block_pool_t* block_pool) {
   // Since all blocks must have been released we can just reuse trim (today) as
   // it doesn't retain any blocks.
   iree_arena_block_pool_trim(block_pool);
+  for (iree_host_size_t i = 0; i < block_pool->cache_count; ++i) {
+    iree_slim_mutex_deinitialize(&block_pool->caches[i].cache.mutex);
+  }
+  if (block_pool->caches) {
+    iree_allocator_free_aligned(block_pool->block_allocator,
+                                block_pool->caches);
+    block_pool->caches = NULL;
+    block_pool->cache_count = 0;
+  }
   iree_atomic_arena_block_slist_deinitialize(&block_pool->available_slist);
 
   IREE_TRACE_ZONE_END(z0);
 }
 
+// Frees the blocks in the list starting at |head|.
+static void iree_arena_block_pool_free_blocks(
+    iree_arena_block_pool_t* block_pool, iree_arena_block_t* head) {
+  while (head) {
+    void* ptr = (uint8_t*)head - block_pool->usable_block_size;
+    head = head->next;
+    iree_allocator_free(block_pool->block_allocator, ptr);
+  }
+}
+
 void iree_arena_block_pool_trim(iree_arena_block_pool_t* block_pool) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  for (iree_host_size_t i = 0; i < block_pool->cache_count; ++i) {
+    iree_arena_block_cache_t* cache = &block_pool->caches[i].cache;
+    iree_slim_mutex_lock(&cache->mutex);
+    iree_arena_block_t* head = cache->head;
+    cache->head = NULL;
+    cache->tail = NULL;
+    cache->count = 0;
+    if (head) {
+      iree_atomic_fetch_sub_int32(&block_pool->nonempty_cache_count, 1,
+                                  iree_memory_order_relaxed);
+    }
+    iree_slim_mutex_unlock(&cache->mutex);
+    iree_arena_block_pool_free_blocks(block_pool, head);
+  }
+
   iree_arena_block_t* head = NULL;
   iree_atomic_arena_block_slist_flush(
       &block_pool->available_slist,
       IREE_ATOMIC_SLIST_FLUSH_ORDER_APPROXIMATE_LIFO, &head, NULL);
-  while (head) {
-    void* ptr = (uint8_t*)head - block_pool->usable_block_size;
-    head = head->next;
-    iree_allocator_free(block_pool->block_allocator, ptr);
-  }
+  iree_arena_block_pool_free_blocks(block_pool, head);
 
   IREE_TRACE_ZONE_END(z0);
 }
 
+// Returns the cache used by the processor the caller is running on or NULL if
+// the pool has no caches. The processor may change at any time and the cache
+// is only a hint for reducing contention.
+static iree_arena_block_cache_t* iree_arena_block_pool_select_cache(
+    iree_arena_block_pool_t* block_pool) {
+  if (!block_pool->cache_count) return NULL;
+  iree_cpu_processor_id_t processor_id = iree_cpu_query_processor_id();
+  return &block_pool->caches[processor_id % block_pool->cache_count].cache;
+}
+
+// Pops a block from |cache| or returns NULL if it is empty.
+static iree_arena_block_t* iree_arena_block_cache_pop(
+    iree_arena_block_pool_t* block_pool, iree_arena_block_cache_t* cache) {
+  iree_slim_mutex_lock(&cache->mutex);
+  iree_arena_block_t* block = cache->head;
+  if (block) {
+    cache->head = block->next;
+    if (!cache->head) {
+      cache->tail = NULL;
+      iree_atomic_fetch_sub_int32(&block_pool->nonempty_cache_count, 1,
+                                  iree_memory_order_relaxed);
+    }
+    --cache->count;
+  }
+  iree_slim_mutex_unlock(&cache->mutex);
+  return block;
+}
+
 iree_status_t iree_arena_block_pool_acquire(iree_arena_block_pool_t* block_pool,
                                             iree_arena_block_t** out_block) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  // Fast path: a block recently released on this processor.
+  iree_arena_block_cache_t* local_cache =
+      iree_arena_block_pool_select_cache(block_pool);
   iree_arena_block_t* block =
-      iree_atomic_arena_block_slist_pop(&block_pool->available_slist);
+      local_cache ? iree_arena_block_cache_pop(block_pool, local_cache) : NULL;
+
+  // Blocks spilled from caches when they filled up.
+  if (!block) {
+    block = iree_atomic_arena_block_slist_pop(&block_pool->available_slist);
+  }
+
+  // Steal from the other caches before growing the pool so that blocks
+  // released on other processors don't cause additional allocations. The scan
+  // is skipped entirely when no cache holds blocks, which is the common case
+  // for a pool that is still growing.
+  if (!block && iree_atomic_load_int32(&block_pool->nonempty_cache_count,
+                                       iree_memory_order_relaxed) > 0) {
+    for (iree_host_size_t i = 0; !block && i < block_pool->cache_count; ++i) {
+      iree_arena_block_cache_t* cache = &block_pool->caches[i].cache;
+      if (cache != local_cache) {
+        block = iree_arena_block_cache_pop(block_pool, cache);
+      }
+    }
+  }
 
   if (!block) {
     // No blocks available; allocate one now.
@@ -89,9 +191,59 @@ iree_status_t iree_arena_block_pool_acquire(iree_arena_block_pool_t* block_pool,
 void iree_arena_block_pool_release(iree_arena_block_pool_t* block_pool,
                                    iree_arena_block_t* block_head,
                                    iree_arena_block_t* block_tail) {
+  if (!block_head) return;
   IREE_TRACE_ZONE_BEGIN(z0);
-  iree_atomic_arena_block_slist_concat(&block_pool->available_slist, block_head,
-                                       block_tail);
+
+  iree_arena_block_cache_t* cache =
+      iree_arena_block_pool_select_cache(block_pool);
+  if (!cache) {
+    iree_atomic_arena_block_slist_concat(&block_pool->available_slist,
+                                         block_head, block_tail);
+    IREE_TRACE_ZONE_END(z0);
+    return;
+  }
+
+  // Keep up to the cache capacity of the released blocks; they were most
+  // recently used on this processor and are the most likely to be warm.
+  iree_host_size_t keep_count = 1;
+  iree_arena_block_t* keep_tail = block_head;
+  while (keep_tail != block_tail &&
+         keep_count < IREE_ARENA_BLOCK_POOL_CACHE_CAPACITY) {
+    keep_tail = keep_tail->next;
+    ++keep_count;
+  }
+  iree_arena_block_t* spill_head = NULL;
+  iree_arena_block_t* spill_tail = NULL;
+  if (keep_tail != block_tail) {
+    spill_head = keep_tail->next;
+    spill_tail = block_tail;
+  }
+
+  iree_slim_mutex_lock(&cache->mutex);
+  if (!cache->head) {
+    iree_atomic_fetch_add_int32(&block_pool->nonempty_cache_count, 1,
+                                iree_memory_order_relaxed);
+  } else if (cache->count + keep_count > IREE_ARENA_BLOCK_POOL_CACHE_CAPACITY) {
+    // The cache is full: spill all of its blocks to the shared list in one
+    // batch along with any released blocks that didn't fit.
+    cache->tail->next = spill_head;
+    if (!spill_head) spill_tail = cache->tail;
+    spill_head = cache->head;
+    cache->head = NULL;
+    cache->tail = NULL;
+    cache->count = 0;
+  }
+  keep_tail->next = cache->head;
+  cache->head = block_head;
+  if (!cache->tail) cache->tail = keep_tail;
+  cache->count += keep_count;
+  iree_slim_mutex_unlock(&cache->mutex);
+
+  if (spill_head) {
+    iree_atomic_arena_block_slist_concat(&block_pool->available_slist,
+                                         spill_head, spill_tail);
+  }
+
   IREE_TRACE_ZONE_END(z0);
 }
 
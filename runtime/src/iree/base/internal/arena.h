@@ -11,6 +11,8 @@
 
 #include "iree/base/api.h"
 #include "iree/base/internal/atomic_slist.h"
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -34,6 +36,35 @@ typedef struct iree_arena_block_t {
 IREE_TYPED_ATOMIC_SLIST_WRAPPER(iree_atomic_arena_block, iree_arena_block_t,
                                 offsetof(iree_arena_block_t, next));
 
+// Maximum number of per-processor block caches in each block pool.
+// Pools allocate one cache per logical processor up to this count. Processors
+// are mapped onto the caches by their ID modulo the count and processors
+// sharing a cache contend with each other.
+#if !defined(IREE_ARENA_BLOCK_POOL_MAX_CACHE_COUNT)
+#define IREE_ARENA_BLOCK_POOL_MAX_CACHE_COUNT 16
+#endif  // !IREE_ARENA_BLOCK_POOL_MAX_CACHE_COUNT
+
+// Maximum number of blocks retained in each per-processor block cache.
+// When a release would exceed the capacity the cached blocks are returned to
+// the shared list of the pool in a single batch.
+#if !defined(IREE_ARENA_BLOCK_POOL_CACHE_CAPACITY)
+#define IREE_ARENA_BLOCK_POOL_CACHE_CAPACITY 8
+#endif  // !IREE_ARENA_BLOCK_POOL_CACHE_CAPACITY
+
+// A bounded LIFO cache of free blocks used by the processors mapped to it.
+typedef struct iree_arena_block_cache_t {
+  iree_slim_mutex_t mutex;
+  iree_arena_block_t* head IREE_GUARDED_BY(mutex);
+  iree_arena_block_t* tail IREE_GUARDED_BY(mutex);
+  iree_host_size_t count IREE_GUARDED_BY(mutex);
+} iree_arena_block_cache_t;
+
+// Pads a cache to avoid false sharing with its neighbors.
+typedef union iree_arena_block_cache_slot_t {
+  iree_arena_block_cache_t cache;
+  uint8_t reserved[iree_hardware_destructive_interference_size];
+} iree_arena_block_cache_slot_t;
+
 // A simple atomic fixed-size block pool.
 // Blocks are allocated from the system as required and kept in the pool to
 // satisfy future requests. Blocks are all of a uniform size specified when the
@@ -41,6 +72,14 @@ IREE_TYPED_ATOMIC_SLIST_WRAPPER(iree_atomic_arena_block, iree_arena_block_t,
 // blocks so that the underlying allocator is more likely to bucket them
 // appropriately.
 //
+// Free blocks are kept in small per-processor caches in front of a shared list
+// so that threads acquiring and releasing blocks on different processors
+// don't contend. Caches spill to the shared list in batches when they fill and
+// threads that find both their cache and the shared list empty steal from
+// other caches before allocating new blocks. The caches are allocated from the
+// block allocator when the pool is initialized; if that fails the pool still
+// functions using only the shared list.
+//
 // Thread-safe; multiple threads may acquire and release blocks from the pool.
 // The underlying allocator must also be thread-safe.
 typedef struct iree_arena_block_pool_t {
@@ -51,8 +90,15 @@ typedef struct iree_arena_block_pool_t {
   iree_host_size_t usable_block_size;
   // Allocator used for allocating/freeing each allocation block.
   iree_allocator_t block_allocator;
-  // Linked list of free blocks (LIFO).
+  // Linked list of free blocks (LIFO) shared by all processors.
   iree_atomic_arena_block_slist_t available_slist;
+  // Per-processor caches of free blocks checked before available_slist.
+  iree_host_size_t cache_count;
+  iree_arena_block_cache_slot_t* caches;
+  // Number of caches holding at least one block. Only changes when a cache
+  // becomes empty or non-empty and lets acquisitions skip stealing from the
+  // other caches when they are all empty.
+  iree_atomic_int32_t nonempty_cache_count;
 } iree_arena_block_pool_t;
 
 // Initializes a new block pool in |out_block_pool|.
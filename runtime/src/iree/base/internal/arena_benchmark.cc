@@ -0,0 +1,143 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <cstddef>
+
+#include "benchmark/benchmark.h"
+#include "iree/base/api.h"
+#include "iree/base/internal/arena.h"
+
+namespace {
+
+//==============================================================================
+// Inlined timing utils
+//==============================================================================
+
+void SpinDelay(int count, int* data) {
+  // This emulates work we may be doing with the block (like recording a few
+  // commands into it).
+  for (size_t i = 0; i < count * 10; ++i) {
+    ++(*data);
+    benchmark::DoNotOptimize(*data);
+  }
+}
+
+static constexpr iree_host_size_t kBlockSize = 32 * 1024;
+
+//==============================================================================
+// iree_atomic_arena_block_slist_t
+//==============================================================================
+
+// Baseline: a single free list shared by all threads as the pool used prior to
+// the per-processor caches.
+void BM_SharedSList(benchmark::State& state) {
+  struct Shared {
+    iree_atomic_arena_block_slist_t slist;
+    iree_arena_block_t blocks[256];
+    Shared() {
+      iree_atomic_arena_block_slist_initialize(&slist);
+      for (auto& block : blocks) {
+        iree_atomic_arena_block_slist_push(&slist, &block);
+      }
+    }
+  };
+  static auto* shared = new Shared();
+  int local = 0;
+  for (auto _ : state) {
+    iree_arena_block_t* block =
+        iree_atomic_arena_block_slist_pop(&shared->slist);
+    SpinDelay(static_cast<int>(state.range(0)), &local);
+    if (block) iree_atomic_arena_block_slist_push(&shared->slist, block);
+  }
+}
+
+BENCHMARK(BM_SharedSList)
+    ->UseRealTime()
+    // ThreadPerCpu poorly handles non-power-of-two CPU counts.
+    ->Threads(1)
+    ->Threads(2)
+    ->Threads(4)
+    ->Threads(8)
+    ->Threads(16)
+    ->Threads(32)
+    ->Threads(64)
+    // Amount of work performed with each block.
+    ->Arg(0)
+    ->Arg(50);
+
+//==============================================================================
+// iree_arena_block_pool_t
+//==============================================================================
+
+void BM_BlockPoolAcquireRelease(benchmark::State& state) {
+  static iree_arena_block_pool_t* block_pool = ([]() {
+    auto* block_pool = new iree_arena_block_pool_t();
+    iree_arena_block_pool_initialize(kBlockSize, iree_allocator_system(),
+                                     block_pool);
+    return block_pool;
+  })();
+  int local = 0;
+  for (auto _ : state) {
+    iree_arena_block_t* block = NULL;
+    IREE_CHECK_OK(iree_arena_block_pool_acquire(block_pool, &block));
+    SpinDelay(static_cast<int>(state.range(0)), &local);
+    iree_arena_block_pool_release(block_pool, block, block);
+  }
+}
+
+BENCHMARK(BM_BlockPoolAcquireRelease)
+    ->UseRealTime()
+    // ThreadPerCpu poorly handles non-power-of-two CPU counts.
+    ->Threads(1)
+    ->Threads(2)
+    ->Threads(4)
+    ->Threads(8)
+    ->Threads(16)
+    ->Threads(32)
+    ->Threads(64)
+    // Amount of work performed with each block.
+    ->Arg(0)
+    ->Arg(50);
+
+//==============================================================================
+// iree_arena_allocator_t
+//==============================================================================
+
+// Models command buffer recording: each iteration allocates a few blocks worth
+// of small allocations from an arena and then resets it.
+void BM_ArenaAllocateReset(benchmark::State& state) {
+  static iree_arena_block_pool_t* block_pool = ([]() {
+    auto* block_pool = new iree_arena_block_pool_t();
+    iree_arena_block_pool_initialize(kBlockSize, iree_allocator_system(),
+                                     block_pool);
+    return block_pool;
+  })();
+  iree_arena_allocator_t arena;
+  iree_arena_initialize(block_pool, &arena);
+  const iree_host_size_t allocation_count = state.range(0);
+  for (auto _ : state) {
+    for (iree_host_size_t i = 0; i < allocation_count; ++i) {
+      void* ptr = NULL;
+      IREE_CHECK_OK(iree_arena_allocate(&arena, 1024, &ptr));
+      benchmark::DoNotOptimize(ptr);
+    }
+    iree_arena_reset(&arena);
+  }
+  iree_arena_deinitialize(&arena);
+}
+
+BENCHMARK(BM_ArenaAllocateReset)
+    ->UseRealTime()
+    // ThreadPerCpu poorly handles non-power-of-two CPU counts.
+    ->Threads(1)
+    ->Threads(4)
+    ->Threads(16)
+    ->Threads(64)
+    // Allocations per reset; 32 1KB allocations fill one block.
+    ->Arg(8)
+    ->Arg(128);
+
+}  // namespace
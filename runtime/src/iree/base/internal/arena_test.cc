@@ -0,0 +1,186 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/internal/arena.h"
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+// Wraps the system allocator and counts live allocations.
+struct CountingAllocator {
+  std::atomic<int> live_count{0};
+
+  iree_allocator_t allocator() { return {this, Ctl}; }
+
+  static iree_status_t Ctl(void* self, iree_allocator_command_t command,
+                           const void* params, void** inout_ptr) {
+    auto* counter = reinterpret_cast<CountingAllocator*>(self);
+    if (command == IREE_ALLOCATOR_COMMAND_MALLOC ||
+        command == IREE_ALLOCATOR_COMMAND_CALLOC) {
+      ++counter->live_count;
+    } else if (command == IREE_ALLOCATOR_COMMAND_FREE) {
+      --counter->live_count;
+    }
+    return iree_allocator_system_ctl(NULL, command, params, inout_ptr);
+  }
+};
+
+static constexpr iree_host_size_t kBlockSize = 4096;
+
+TEST(ArenaBlockPool, Lifetime) {
+  CountingAllocator counter;
+  iree_arena_block_pool_t block_pool;
+  iree_arena_block_pool_initialize(kBlockSize, counter.allocator(),
+                                   &block_pool);
+  iree_arena_block_pool_deinitialize(&block_pool);
+  EXPECT_EQ(0, counter.live_count);
+}
+
+// Blocks released to the pool are reused by subsequent acquisitions instead of
+// allocating new ones.
+TEST(ArenaBlockPool, ReuseReleasedBlocks) {
+  CountingAllocator counter;
+  iree_arena_block_pool_t block_pool;
+  iree_arena_block_pool_initialize(kBlockSize, counter.allocator(),
+                                   &block_pool);
+  // The per-processor caches are allocated once at initialization.
+  const int baseline_count = counter.live_count;
+
+  iree_arena_block_t* block = NULL;
+  IREE_ASSERT_OK(iree_arena_block_pool_acquire(&block_pool, &block));
+  EXPECT_EQ(baseline_count + 1, counter.live_count);
+  iree_arena_block_pool_release(&block_pool, block, block);
+  for (int i = 0; i < 16; ++i) {
+    IREE_ASSERT_OK(iree_arena_block_pool_acquire(&block_pool, &block));
+    iree_arena_block_pool_release(&block_pool, block, block);
+  }
+  EXPECT_EQ(baseline_count + 1, counter.live_count);
+
+  iree_arena_block_pool_deinitialize(&block_pool);
+  EXPECT_EQ(0, counter.live_count);
+}
+
+// Releasing more blocks than fit in a cache spills them to the shared list and
+// all of them remain available for reuse and trimming.
+TEST(ArenaBlockPool, SpillAndTrim) {
+  CountingAllocator counter;
+  iree_arena_block_pool_t block_pool;
+  iree_arena_block_pool_initialize(kBlockSize, counter.allocator(),
+                                   &block_pool);
+  const int baseline_count = counter.live_count;
+
+  static constexpr int kBlockCount = IREE_ARENA_BLOCK_POOL_CACHE_CAPACITY * 4;
+  std::vector<iree_arena_block_t*> blocks(kBlockCount);
+  for (int i = 0; i < kBlockCount; ++i) {
+    IREE_ASSERT_OK(iree_arena_block_pool_acquire(&block_pool, &blocks[i]));
+  }
+  EXPECT_EQ(baseline_count + kBlockCount, counter.live_count);
+
+  // Release half individually and half as a single chain.
+  for (int i = 0; i < kBlockCount / 2; ++i) {
+    iree_arena_block_pool_release(&block_pool, blocks[i], blocks[i]);
+  }
+  for (int i = kBlockCount / 2; i < kBlockCount - 1; ++i) {
+    blocks[i]->next = blocks[i + 1];
+  }
+  blocks[kBlockCount - 1]->next = NULL;
+  iree_arena_block_pool_release(&block_pool, blocks[kBlockCount / 2],
+                                blocks[kBlockCount - 1]);
+
+  // Everything can be reacquired without allocating.
+  for (int i = 0; i < kBlockCount; ++i) {
+    IREE_ASSERT_OK(iree_arena_block_pool_acquire(&block_pool, &blocks[i]));
+  }
+  EXPECT_EQ(baseline_count + kBlockCount, counter.live_count);
+  for (int i = 0; i < kBlockCount; ++i) {
+    iree_arena_block_pool_release(&block_pool, blocks[i], blocks[i]);
+  }
+
+  iree_arena_block_pool_trim(&block_pool);
+  EXPECT_EQ(baseline_count, counter.live_count);
+  iree_arena_block_pool_deinitialize(&block_pool);
+  EXPECT_EQ(0, counter.live_count);
+}
+
+// Blocks held in another processor's cache are stolen instead of allocating
+// new ones and the steal scan is skipped once all caches are empty.
+TEST(ArenaBlockPool, StealFromOtherCaches) {
+  CountingAllocator counter;
+  iree_arena_block_pool_t block_pool;
+  iree_arena_block_pool_initialize(kBlockSize, counter.allocator(),
+                                   &block_pool);
+  const int baseline_count = counter.live_count;
+  EXPECT_EQ(0, iree_atomic_load_int32(&block_pool.nonempty_cache_count,
+                                      iree_memory_order_relaxed));
+
+  // Release on a thread that may be scheduled on another processor.
+  iree_arena_block_t* block = NULL;
+  IREE_ASSERT_OK(iree_arena_block_pool_acquire(&block_pool, &block));
+  std::thread([&]() {
+    iree_arena_block_pool_release(&block_pool, block, block);
+  }).join();
+  if (block_pool.cache_count > 0) {
+    EXPECT_EQ(1, iree_atomic_load_int32(&block_pool.nonempty_cache_count,
+                                        iree_memory_order_relaxed));
+  }
+
+  // Wherever the block landed it is reused.
+  IREE_ASSERT_OK(iree_arena_block_pool_acquire(&block_pool, &block));
+  EXPECT_EQ(baseline_count + 1, counter.live_count);
+  EXPECT_EQ(0, iree_atomic_load_int32(&block_pool.nonempty_cache_count,
+                                      iree_memory_order_relaxed));
+  iree_arena_block_pool_release(&block_pool, block, block);
+
+  iree_arena_block_pool_deinitialize(&block_pool);
+  EXPECT_EQ(0, counter.live_count);
+}
+
+// Arenas on many threads sharing a pool never observe the same block.
+TEST(ArenaBlockPool, ConcurrentArenas) {
+  CountingAllocator counter;
+  iree_arena_block_pool_t block_pool;
+  iree_arena_block_pool_initialize(kBlockSize, counter.allocator(),
+                                   &block_pool);
+
+  static constexpr int kThreadCount = 8;
+  static constexpr int kIterationCount = 1000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreadCount; ++t) {
+    threads.emplace_back([&block_pool, t]() {
+      iree_arena_allocator_t arena;
+      iree_arena_initialize(&block_pool, &arena);
+      for (int i = 0; i < kIterationCount; ++i) {
+        std::vector<uint8_t*> ptrs;
+        for (int j = 0; j < (i % 5) + 1; ++j) {
+          void* ptr = NULL;
+          IREE_ASSERT_OK(iree_arena_allocate(&arena, kBlockSize / 2, &ptr));
+          memset(ptr, t, kBlockSize / 2);
+          ptrs.push_back((uint8_t*)ptr);
+        }
+        for (uint8_t* ptr : ptrs) {
+          ASSERT_EQ(t, ptr[0]);
+          ASSERT_EQ(t, ptr[kBlockSize / 2 - 1]);
+        }
+        iree_arena_reset(&arena);
+      }
+      iree_arena_deinitialize(&arena);
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  iree_arena_block_pool_deinitialize(&block_pool);
+  EXPECT_EQ(0, counter.live_count);
+}
+
+}  // namespace
@@ -285,6 +285,14 @@ iree_status_t iree_cpu_lookup_data_by_key(iree_string_view_t key,
 #if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX)
 
 #include <sched.h>
+#include <unistd.h>
+
+iree_host_size_t iree_cpu_query_processor_count(void) {
+  // Configured rather than online processors so that IDs of processors brought
+  // online later are still in range.
+  long count = sysconf(_SC_NPROCESSORS_CONF);
+  return count > 0 ? (iree_host_size_t)count : 1;
+}
 
 iree_cpu_processor_id_t iree_cpu_query_processor_id(void) {
   // This path is relatively portable and should work on linux/bsd/etc-likes.
@@ -299,6 +307,11 @@ iree_cpu_processor_id_t iree_cpu_query_processor_id(void) {
 
 #elif defined(IREE_PLATFORM_WINDOWS)
 
+iree_host_size_t iree_cpu_query_processor_count(void) {
+  DWORD count = GetActiveProcessorCount(ALL_PROCESSOR_GROUPS);
+  return count > 0 ? (iree_host_size_t)count : 1;
+}
+
 iree_cpu_processor_id_t iree_cpu_query_processor_id(void) {
   PROCESSOR_NUMBER pn;
   GetCurrentProcessorNumberEx(&pn);
@@ -309,6 +322,8 @@ iree_cpu_processor_id_t iree_cpu_query_processor_id(void) {
 
 // No implementation.
 // We could allow an iree/base/config.h override to externalize this.
+iree_host_size_t iree_cpu_query_processor_count(void) { return 1; }
+
 iree_cpu_processor_id_t iree_cpu_query_processor_id(void) { return 0; }
 
 #endif  // IREE_PLATFORM_*
@@ -64,6 +64,13 @@ iree_status_t iree_cpu_lookup_data_by_key(iree_string_view_t key,
 typedef uint32_t iree_cpu_processor_id_t;
 typedef uint32_t iree_cpu_processor_tag_t;
 
+// Returns the number of logical processors configured in the system.
+// IDs returned by iree_cpu_query_processor_id are usually less than this but
+// may not be (such as with multiple processor groups on Windows) and callers
+// mapping IDs onto per-processor data should do so modulo the count.
+// Returns 1 on platforms where processor IDs cannot be queried.
+iree_host_size_t iree_cpu_query_processor_count(void);
+
 // Returns the ID of the logical processor executing this code.
 iree_cpu_processor_id_t iree_cpu_query_processor_id(void);
 
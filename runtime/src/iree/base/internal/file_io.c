@@ -4,6 +4,11 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+// NOTE: must be first before _any_ system includes.
+// Required for fileno and pread on POSIX platforms when building with strict
+// standard modes (-std=c11).
+#define _GNU_SOURCE
+
 #include "iree/base/internal/file_io.h"
 
 #include "iree/base/config.h"
@@ -26,19 +31,18 @@
 #define IREE_SET_BINARY_MODE(handle) ((void)0)
 #endif  // IREE_PLATFORM_WINDOWS
 
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_APPLE) || \
+    defined(IREE_PLATFORM_LINUX)
+#define IREE_FILE_IO_POSIX 1
+#include <sys/mman.h>
+#include <unistd.h>
+#endif  // IREE_PLATFORM_ANDROID || IREE_PLATFORM_APPLE || IREE_PLATFORM_LINUX
+
 // We could take alignment as an arg, but roughly page aligned should be
 // acceptable for all uses - if someone cares about memory usage they won't
 // be using this method.
 #define IREE_FILE_BASE_ALIGNMENT 4096
 
-#if defined(IREE_PLATFORM_WINDOWS)
-#define iree_fseek64 _fseeki64
-#define iree_ftell64 _ftelli64
-#else
-#define iree_fseek64 fseek
-#define iree_ftell64 ftell
-#endif  // IREE_PLATFORM_WINDOWS
-
 iree_status_t iree_file_exists(const char* path) {
   IREE_ASSERT_ARGUMENT(path);
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -85,6 +89,78 @@ bool iree_file_is_at(FILE* file, uint64_t position) {
   return iree_ftell64(file) == position;
 }
 
+iree_status_t iree_file_read_at(FILE* file, uint64_t offset,
+                                iree_byte_span_t buffer) {
+  IREE_ASSERT_ARGUMENT(file);
+#if defined(IREE_FILE_IO_POSIX)
+  int fd = fileno(file);
+  while (buffer.data_length > 0) {
+    ssize_t read_length =
+        pread(fd, buffer.data, buffer.data_length, (off_t)offset);
+    if (read_length < 0) {
+      if (errno == EINTR) continue;
+      return iree_make_status(iree_status_code_from_errno(errno),
+                              "failed to read %" PRIhsz
+                              " bytes at file offset %" PRIu64,
+                              buffer.data_length, offset);
+    } else if (read_length == 0) {
+      return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                              "file truncated; %" PRIhsz
+                              " bytes missing at file offset %" PRIu64,
+                              buffer.data_length, offset);
+    }
+    buffer.data += read_length;
+    buffer.data_length -= read_length;
+    offset += read_length;
+  }
+  return iree_ok_status();
+#elif defined(IREE_PLATFORM_WINDOWS)
+  HANDLE handle = (HANDLE)_get_osfhandle(_fileno(file));
+  while (buffer.data_length > 0) {
+    // ReadFile takes a 32-bit length so we read in chunks of up to 1GB.
+    DWORD chunk_length =
+        (DWORD)iree_min(buffer.data_length, (iree_host_size_t)(1u << 30));
+    // The handle is not opened for overlapped I/O so the read is synchronous
+    // and also moves the file position; see iree_file_read_at in the header.
+    OVERLAPPED overlapped = {0};
+    overlapped.Offset = (DWORD)offset;
+    overlapped.OffsetHigh = (DWORD)(offset >> 32);
+    DWORD read_length = 0;
+    if (!ReadFile(handle, buffer.data, chunk_length, &read_length,
+                  &overlapped)) {
+      return iree_make_status(
+          iree_status_code_from_win32_error(GetLastError()),
+          "failed to read %" PRIhsz " bytes at file offset %" PRIu64,
+          buffer.data_length, offset);
+    } else if (read_length == 0) {
+      return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                              "file truncated; %" PRIhsz
+                              " bytes missing at file offset %" PRIu64,
+                              buffer.data_length, offset);
+    }
+    buffer.data += read_length;
+    buffer.data_length -= read_length;
+    offset += read_length;
+  }
+  return iree_ok_status();
+#else
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "positional file reads not supported");
+#endif  // IREE_FILE_IO_POSIX
+}
+
+// Releases the platform mapping backing |contents|, if any.
+static void iree_file_contents_unmap(iree_file_contents_t* contents) {
+  if (!contents->mapping_base) return;
+#if defined(IREE_FILE_IO_POSIX)
+  munmap(contents->mapping_base, contents->mapping_length);
+#elif defined(IREE_PLATFORM_WINDOWS)
+  UnmapViewOfFile(contents->mapping_base);
+#endif  // IREE_FILE_IO_POSIX
+  contents->mapping_base = NULL;
+  contents->mapping_length = 0;
+}
+
 iree_status_t iree_file_contents_allocator_ctl(void* self,
                                                iree_allocator_command_t command,
                                                const void* params,
@@ -99,6 +175,7 @@ iree_status_t iree_file_contents_allocator_ctl(void* self,
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                             "only the file contents buffer is valid");
   }
+  iree_file_contents_unmap(contents);
   iree_allocator_t allocator = contents->allocator;
   iree_allocator_free(allocator, contents);
   return iree_ok_status();
@@ -116,6 +193,7 @@ iree_allocator_t iree_file_contents_deallocator(
 void iree_file_contents_free(iree_file_contents_t* contents) {
   if (!contents) return;
   IREE_TRACE_ZONE_BEGIN(z0);
+  iree_file_contents_unmap(contents);
   iree_allocator_free(contents->allocator, contents);
   IREE_TRACE_ZONE_END(z0);
 }
@@ -189,6 +267,106 @@ iree_status_t iree_file_read_contents(const char* path,
   return status;
 }
 
+iree_status_t iree_file_map_contents(FILE* file, uint64_t offset,
+                                     uint64_t length,
+                                     iree_allocator_t allocator,
+                                     iree_file_contents_t** out_contents) {
+  IREE_ASSERT_ARGUMENT(file);
+  IREE_ASSERT_ARGUMENT(out_contents);
+  *out_contents = NULL;
+#if defined(IREE_FILE_IO_POSIX) || defined(IREE_PLATFORM_WINDOWS)
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, length);
+
+  // Touching mapped pages beyond the end of the file faults so the range must
+  // be validated up front.
+  uint64_t file_length = 0;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(z0,
+                                    iree_file_query_length(file, &file_length));
+  if (offset > file_length || length > file_length - offset) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "file range [%" PRIu64 ", %" PRIu64
+                            ") exceeds the file length of %" PRIu64,
+                            offset, offset + length, file_length);
+  }
+
+  // Mappings must start at a file offset aligned to the platform granularity.
+#if defined(IREE_FILE_IO_POSIX)
+  uint64_t granularity = (uint64_t)sysconf(_SC_PAGESIZE);
+#else
+  SYSTEM_INFO system_info;
+  GetSystemInfo(&system_info);
+  uint64_t granularity = system_info.dwAllocationGranularity;
+#endif  // IREE_FILE_IO_POSIX
+  uint64_t mapping_offset = offset & ~(granularity - 1);
+  uint64_t mapping_length = offset - mapping_offset + length;
+  if (mapping_length > IREE_HOST_SIZE_MAX) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "file range exceeds host address range");
+  }
+
+  iree_file_contents_t* contents = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(allocator, sizeof(*contents),
+                                (void**)&contents));
+  contents->allocator = allocator;
+
+  // Zero-length mappings are not allowed and there's nothing to map anyway.
+  iree_status_t status = iree_ok_status();
+  void* mapping_base = NULL;
+  if (length > 0) {
+#if defined(IREE_FILE_IO_POSIX)
+    mapping_base =
+        mmap(NULL, (size_t)mapping_length, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE, fileno(file), (off_t)mapping_offset);
+    if (mapping_base == MAP_FAILED) {
+      mapping_base = NULL;
+      status = iree_make_status(iree_status_code_from_errno(errno),
+                                "failed to map %" PRIu64
+                                " bytes at file offset %" PRIu64,
+                                mapping_length, mapping_offset);
+    }
+#else
+    HANDLE mapping_handle =
+        CreateFileMappingA((HANDLE)_get_osfhandle(_fileno(file)), NULL,
+                           PAGE_WRITECOPY, 0, 0, NULL);
+    if (mapping_handle) {
+      mapping_base = MapViewOfFile(
+          mapping_handle, FILE_MAP_COPY, (DWORD)(mapping_offset >> 32),
+          (DWORD)mapping_offset, (SIZE_T)mapping_length);
+      // The view retains the mapping object.
+      CloseHandle(mapping_handle);
+    }
+    if (!mapping_base) {
+      status = iree_make_status(
+          iree_status_code_from_win32_error(GetLastError()),
+          "failed to map %" PRIu64 " bytes at file offset %" PRIu64,
+          mapping_length, mapping_offset);
+    }
+#endif  // IREE_FILE_IO_POSIX
+  }
+
+  if (iree_status_is_ok(status)) {
+    contents->mapping_base = mapping_base;
+    contents->mapping_length = (iree_host_size_t)mapping_length;
+    contents->buffer = iree_make_byte_span(
+        mapping_base ? (uint8_t*)mapping_base + (offset - mapping_offset)
+                     : NULL,
+        (iree_host_size_t)length);
+    *out_contents = contents;
+  } else {
+    iree_allocator_free(allocator, contents);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+#else
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "file mapping not supported");
+#endif  // IREE_FILE_IO_POSIX || IREE_PLATFORM_WINDOWS
+}
+
 iree_status_t iree_file_write_contents(const char* path,
                                        iree_const_byte_span_t content) {
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -300,6 +478,18 @@ iree_status_t iree_file_read_contents(const char* path,
   return iree_make_status(IREE_STATUS_UNAVAILABLE, "File I/O is disabled");
 }
 
+iree_status_t iree_file_read_at(FILE* file, uint64_t offset,
+                                iree_byte_span_t buffer) {
+  return iree_make_status(IREE_STATUS_UNAVAILABLE, "File I/O is disabled");
+}
+
+iree_status_t iree_file_map_contents(FILE* file, uint64_t offset,
+                                     uint64_t length,
+                                     iree_allocator_t allocator,
+                                     iree_file_contents_t** out_contents) {
+  return iree_make_status(IREE_STATUS_UNAVAILABLE, "File I/O is disabled");
+}
+
 iree_status_t iree_file_write_contents(const char* path,
                                        iree_const_byte_span_t content) {
   return iree_make_status(IREE_STATUS_UNAVAILABLE, "File I/O is disabled");
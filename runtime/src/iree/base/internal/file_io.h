@@ -16,6 +16,15 @@
 extern "C" {
 #endif
 
+// 64-bit variants of fseek/ftell as `long` is 32 bits on Windows.
+#if defined(IREE_PLATFORM_WINDOWS)
+#define iree_fseek64 _fseeki64
+#define iree_ftell64 _ftelli64
+#else
+#define iree_fseek64 fseek
+#define iree_ftell64 ftell
+#endif  // IREE_PLATFORM_WINDOWS
+
 // Checks if a file exists at the provided |path|.
 //
 // Returns an OK status if the file definitely exists. An OK status does not
@@ -29,6 +38,21 @@ iree_status_t iree_file_query_length(FILE* file, uint64_t* out_length);
 // Returns true if |file| position is at |position|.
 bool iree_file_is_at(FILE* file, uint64_t position);
 
+// Reads |buffer|.data_length bytes from |file| starting at byte |offset|
+// without using the current file position. Multiple threads may read from the
+// same |file| concurrently.
+//
+// The file position after the read is unspecified: on Windows the underlying
+// handle is synchronous and each read moves its position past the bytes read,
+// bypassing any buffering in |file|. Callers that continue with stream reads
+// must reposition |file| with a seek (which also discards stale buffered data)
+// once all positional reads have completed.
+//
+// Returns IREE_STATUS_UNAVAILABLE if the platform does not support positional
+// reads; callers can probe for support with an empty |buffer|.
+iree_status_t iree_file_read_at(FILE* file, uint64_t offset,
+                                iree_byte_span_t buffer);
+
 // Loaded file contents.
 typedef struct iree_file_contents_t {
   iree_allocator_t allocator;
@@ -36,6 +60,10 @@ typedef struct iree_file_contents_t {
     iree_byte_span_t buffer;
     iree_const_byte_span_t const_buffer;
   };
+  // Platform mapping containing |buffer| if the contents were mapped with
+  // iree_file_map_contents and otherwise NULL.
+  void* mapping_base;
+  iree_host_size_t mapping_length;
 } iree_file_contents_t;
 
 // Returns an allocator that deallocates the |contents|.
@@ -54,6 +82,20 @@ iree_status_t iree_file_read_contents(const char* path,
                                       iree_allocator_t allocator,
                                       iree_file_contents_t** out_contents);
 
+// Maps |length| bytes of |file| starting at byte |offset| into host memory.
+// The mapping is copy-on-write: writes to the contents are private to the
+// process and never reach the file. The mapping remains valid after |file| is
+// closed.
+//
+// Returns the contents of the file range in |out_contents|. |allocator| is
+// used to allocate the bookkeeping and the caller must use
+// iree_file_contents_free to unmap the file.
+// Returns IREE_STATUS_UNAVAILABLE if the platform does not support mapping.
+iree_status_t iree_file_map_contents(FILE* file, uint64_t offset,
+                                     uint64_t length,
+                                     iree_allocator_t allocator,
+                                     iree_file_contents_t** out_contents);
+
 // Synchronously writes a byte buffer into a file.
 // Existing contents are overwritten.
 iree_status_t iree_file_write_contents(const char* path,
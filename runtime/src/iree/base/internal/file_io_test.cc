@@ -94,6 +94,112 @@ TEST(FileIO, ReadWriteContents) {
   iree_file_contents_free(read_contents);
 }
 
+// Returns |length| bytes of deterministic but non-repeating contents.
+std::string GetPatternContents(size_t length) {
+  std::string contents(length, 0);
+  for (size_t i = 0; i < length; ++i) {
+    contents[i] = static_cast<char>((i * 7) ^ (i >> 8));
+  }
+  return contents;
+}
+
+TEST(FileIO, ReadAt) {
+  constexpr const char* kUniqueName = "ReadAt";
+  auto path = GetUniquePath(kUniqueName);
+  auto write_contents = GetPatternContents(3 * 4096 + 123);
+  IREE_ASSERT_OK(iree_file_write_contents(
+      path.c_str(),
+      iree_make_const_byte_span(write_contents.data(), write_contents.size())));
+
+  FILE* file = fopen(path.c_str(), "rb");
+  ASSERT_NE(file, nullptr);
+  iree_status_t probe_status =
+      iree_file_read_at(file, 0, iree_make_byte_span(NULL, 0));
+  if (iree_status_is_unavailable(probe_status)) {
+    iree_status_free(probe_status);
+    fclose(file);
+    GTEST_SKIP() << "positional reads not supported";
+  }
+  IREE_ASSERT_OK(probe_status);
+
+  // Reads must not depend on or change the file position.
+  std::string read_contents(5000, 0);
+  IREE_ASSERT_OK(iree_file_read_at(
+      file, 4000,
+      iree_make_byte_span(&read_contents[0], read_contents.size())));
+  EXPECT_EQ(read_contents, write_contents.substr(4000, 5000));
+  EXPECT_TRUE(iree_file_is_at(file, 0));
+
+  // Reading past the end of the file fails.
+  iree_status_t status = iree_file_read_at(
+      file, write_contents.size() - 10,
+      iree_make_byte_span(&read_contents[0], read_contents.size()));
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_OUT_OF_RANGE, status);
+  iree_status_free(status);
+
+  fclose(file);
+}
+
+TEST(FileIO, MapContents) {
+  constexpr const char* kUniqueName = "MapContents";
+  auto path = GetUniquePath(kUniqueName);
+  auto write_contents = GetPatternContents(3 * 4096 + 123);
+  IREE_ASSERT_OK(iree_file_write_contents(
+      path.c_str(),
+      iree_make_const_byte_span(write_contents.data(), write_contents.size())));
+
+  FILE* file = fopen(path.c_str(), "rb");
+  ASSERT_NE(file, nullptr);
+
+  // Map a range that doesn't start on a page boundary.
+  iree_file_contents_t* mapped_contents = NULL;
+  iree_status_t status = iree_file_map_contents(
+      file, 4000, 5000, iree_allocator_system(), &mapped_contents);
+  if (iree_status_is_unavailable(status)) {
+    iree_status_free(status);
+    fclose(file);
+    GTEST_SKIP() << "file mapping not supported";
+  }
+  IREE_ASSERT_OK(status);
+
+  // The mapping outlives the file and writes to it stay private.
+  fclose(file);
+  ASSERT_EQ(5000, mapped_contents->const_buffer.data_length);
+  EXPECT_EQ(0, memcmp(write_contents.data() + 4000,
+                      mapped_contents->const_buffer.data, 5000));
+  mapped_contents->buffer.data[0] ^= 0xFF;
+  iree_file_contents_free(mapped_contents);
+
+  iree_file_contents_t* read_contents = NULL;
+  IREE_ASSERT_OK(iree_file_read_contents(path.c_str(), iree_allocator_system(),
+                                         &read_contents));
+  EXPECT_EQ(0, memcmp(write_contents.data(), read_contents->const_buffer.data,
+                      write_contents.size()));
+  iree_file_contents_free(read_contents);
+}
+
+TEST(FileIO, MapContentsOutOfRange) {
+  constexpr const char* kUniqueName = "MapContentsOutOfRange";
+  auto path = GetUniquePath(kUniqueName);
+  auto write_contents = GetUniqueContents(kUniqueName);
+  IREE_ASSERT_OK(iree_file_write_contents(
+      path.c_str(),
+      iree_make_const_byte_span(write_contents.data(), write_contents.size())));
+
+  FILE* file = fopen(path.c_str(), "rb");
+  ASSERT_NE(file, nullptr);
+  iree_file_contents_t* mapped_contents = NULL;
+  iree_status_t status =
+      iree_file_map_contents(file, 1, write_contents.size(),
+                             iree_allocator_system(), &mapped_contents);
+  if (!iree_status_is_unavailable(status)) {
+    IREE_EXPECT_STATUS_IS(IREE_STATUS_OUT_OF_RANGE, status);
+  }
+  iree_status_free(status);
+  EXPECT_EQ(mapped_contents, nullptr);
+  fclose(file);
+}
+
 }  // namespace
 }  // namespace file_io
 }  // namespace iree
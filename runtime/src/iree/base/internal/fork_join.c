@@ -0,0 +1,111 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/internal/fork_join.h"
+
+#include <string.h>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/internal/threading.h"
+#include "iree/base/tracing.h"
+
+typedef struct iree_fork_join_t {
+  iree_fork_join_fn_t fn;
+  void* user_data;
+  // Held while signaling so that the caller can't tear down the fork-join
+  // while the last thread is still posting the notification.
+  iree_slim_mutex_t mutex;
+  // Number of forked indices that have not yet completed.
+  iree_atomic_int32_t pending_count;
+  iree_notification_t notification;
+} iree_fork_join_t;
+
+// A single forked index and the thread running it.
+typedef struct iree_fork_join_task_t {
+  iree_fork_join_t* fork_join;
+  iree_host_size_t index;
+  iree_thread_t* thread;
+} iree_fork_join_task_t;
+
+static int iree_fork_join_task_main(void* entry_arg) {
+  iree_fork_join_task_t* task = (iree_fork_join_task_t*)entry_arg;
+  iree_fork_join_t* fork_join = task->fork_join;
+  fork_join->fn(fork_join->user_data, task->index);
+  iree_slim_mutex_lock(&fork_join->mutex);
+  if (iree_atomic_fetch_sub_int32(&fork_join->pending_count, 1,
+                                  iree_memory_order_acq_rel) == 1) {
+    iree_notification_post(&fork_join->notification, IREE_ALL_WAITERS);
+  }
+  iree_slim_mutex_unlock(&fork_join->mutex);
+  return 0;
+}
+
+static bool iree_fork_join_is_done(void* user_data) {
+  iree_fork_join_t* fork_join = (iree_fork_join_t*)user_data;
+  return iree_atomic_load_int32(&fork_join->pending_count,
+                                iree_memory_order_acquire) == 0;
+}
+
+void iree_fork_join(iree_string_view_t thread_name, iree_host_size_t count,
+                    iree_fork_join_fn_t fn, void* user_data,
+                    iree_allocator_t host_allocator) {
+  if (count == 0) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (uint64_t)count);
+
+  // Index 0 always runs on the calling thread and needs no task.
+  iree_fork_join_task_t* tasks = NULL;
+  if (count == 1 ||
+      !iree_status_is_ok(iree_allocator_malloc(
+          host_allocator, (count - 1) * sizeof(*tasks), (void**)&tasks))) {
+    for (iree_host_size_t i = 0; i < count; ++i) fn(user_data, i);
+    IREE_TRACE_ZONE_END(z0);
+    return;
+  }
+
+  iree_fork_join_t fork_join;
+  fork_join.fn = fn;
+  fork_join.user_data = user_data;
+  iree_slim_mutex_initialize(&fork_join.mutex);
+  iree_atomic_store_int32(&fork_join.pending_count, (int32_t)(count - 1),
+                          iree_memory_order_release);
+  iree_notification_initialize(&fork_join.notification);
+
+  iree_thread_create_params_t thread_params;
+  memset(&thread_params, 0, sizeof(thread_params));
+  thread_params.name = thread_name;
+  for (iree_host_size_t i = 1; i < count; ++i) {
+    iree_fork_join_task_t* task = &tasks[i - 1];
+    task->fork_join = &fork_join;
+    task->index = i;
+    task->thread = NULL;
+    iree_status_t status =
+        iree_thread_create(iree_fork_join_task_main, task, thread_params,
+                           host_allocator, &task->thread);
+    if (!iree_status_is_ok(status)) {
+      iree_status_ignore(status);
+      iree_fork_join_task_main(task);
+    }
+  }
+  fn(user_data, 0);
+
+  // Wait for all forked indices and then for the last one to finish signaling.
+  iree_notification_await(&fork_join.notification, iree_fork_join_is_done,
+                          &fork_join, iree_infinite_timeout());
+  iree_slim_mutex_lock(&fork_join.mutex);
+  iree_slim_mutex_unlock(&fork_join.mutex);
+
+  // Each thread has dropped its own reference once it started running so
+  // releasing ours now joins it.
+  for (iree_host_size_t i = 0; i < count - 1; ++i) {
+    iree_thread_release(tasks[i].thread);
+  }
+  iree_notification_deinitialize(&fork_join.notification);
+  iree_slim_mutex_deinitialize(&fork_join.mutex);
+  iree_allocator_free(host_allocator, tasks);
+  IREE_TRACE_ZONE_END(z0);
+}
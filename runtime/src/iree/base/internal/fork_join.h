@@ -0,0 +1,37 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BASE_INTERNAL_FORK_JOIN_H_
+#define IREE_BASE_INTERNAL_FORK_JOIN_H_
+
+#include "iree/base/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Function run once for each |index| of a fork-join.
+typedef void (*iree_fork_join_fn_t)(void* user_data, iree_host_size_t index);
+
+// Runs |fn| once for each index in [0, |count|) and returns once all have
+// completed. Index 0 runs on the calling thread and every other index runs on
+// its own short-lived thread named |thread_name|. Indices whose thread cannot
+// be created (or all of them if the bookkeeping can't be allocated from
+// |host_allocator|) run on the calling thread instead, so every index always
+// runs exactly once.
+//
+// Intended for splitting a single large operation (reading a file, comparing
+// buffers) across a handful of threads in tools and utilities that have no
+// executor of their own; runtime work should use the task system instead.
+void iree_fork_join(iree_string_view_t thread_name, iree_host_size_t count,
+                    iree_fork_join_fn_t fn, void* user_data,
+                    iree_allocator_t host_allocator);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_BASE_INTERNAL_FORK_JOIN_H_
@@ -0,0 +1,137 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/internal/fork_join.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/testing/gtest.h"
+
+namespace {
+
+// Counts how many times each index runs.
+struct CountState {
+  std::vector<iree_atomic_int32_t> counts;
+  explicit CountState(iree_host_size_t count) : counts(count) {
+    for (auto& value : counts) {
+      iree_atomic_store_int32(&value, 0, iree_memory_order_relaxed);
+    }
+  }
+};
+
+static void CountIndex(void* user_data, iree_host_size_t index) {
+  auto* state = reinterpret_cast<CountState*>(user_data);
+  iree_atomic_fetch_add_int32(&state->counts[index], 1,
+                              iree_memory_order_relaxed);
+}
+
+TEST(ForkJoinTest, Empty) {
+  iree_fork_join(IREE_SV("fork-join-test"), 0, CountIndex, nullptr,
+                 iree_allocator_system());
+}
+
+TEST(ForkJoinTest, SingleRunsOnCaller) {
+  struct State {
+    std::thread::id caller_id = std::this_thread::get_id();
+    std::thread::id index_id;
+  } state;
+  iree_fork_join(
+      IREE_SV("fork-join-test"), 1,
+      +[](void* user_data, iree_host_size_t index) {
+        reinterpret_cast<State*>(user_data)->index_id =
+            std::this_thread::get_id();
+      },
+      &state, iree_allocator_system());
+  EXPECT_EQ(state.index_id, state.caller_id);
+}
+
+// Every index runs exactly once and all have completed by the time the
+// fork-join returns.
+TEST(ForkJoinTest, RunsEachIndexOnce) {
+  for (iree_host_size_t count : {2, 3, 8, 17}) {
+    CountState state(count);
+    iree_fork_join(IREE_SV("fork-join-test"), count, CountIndex, &state,
+                   iree_allocator_system());
+    for (iree_host_size_t i = 0; i < count; ++i) {
+      EXPECT_EQ(iree_atomic_load_int32(&state.counts[i],
+                                       iree_memory_order_relaxed),
+                1)
+          << "index " << i << " of " << count;
+    }
+  }
+}
+
+// Indices run concurrently: each waits until all others have started, which
+// could never happen if they ran one after another.
+TEST(ForkJoinTest, RunsIndicesConcurrently) {
+  static constexpr iree_host_size_t kCount = 4;
+  struct State {
+    iree_atomic_int32_t arrived_count;
+    iree_atomic_int32_t all_arrived_count;
+    std::vector<std::thread::id> thread_ids =
+        std::vector<std::thread::id>(kCount);
+  } state;
+  iree_atomic_store_int32(&state.arrived_count, 0, iree_memory_order_relaxed);
+  iree_atomic_store_int32(&state.all_arrived_count, 0,
+                          iree_memory_order_relaxed);
+  iree_fork_join(
+      IREE_SV("fork-join-test"), kCount,
+      +[](void* user_data, iree_host_size_t index) {
+        auto* state = reinterpret_cast<State*>(user_data);
+        state->thread_ids[index] = std::this_thread::get_id();
+        iree_atomic_fetch_add_int32(&state->arrived_count, 1,
+                                    iree_memory_order_acq_rel);
+        // Bounded so that a serialized fork-join fails instead of hanging.
+        auto deadline =
+            std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (iree_atomic_load_int32(&state->arrived_count,
+                                      iree_memory_order_acquire) != kCount) {
+          if (std::chrono::steady_clock::now() > deadline) return;
+          std::this_thread::yield();
+        }
+        iree_atomic_fetch_add_int32(&state->all_arrived_count, 1,
+                                    iree_memory_order_acq_rel);
+      },
+      &state, iree_allocator_system());
+  EXPECT_EQ(iree_atomic_load_int32(&state.all_arrived_count,
+                                   iree_memory_order_acquire),
+            kCount);
+  EXPECT_EQ(state.thread_ids[0], std::this_thread::get_id());
+  for (iree_host_size_t i = 1; i < kCount; ++i) {
+    EXPECT_NE(state.thread_ids[i], std::this_thread::get_id());
+  }
+}
+
+// If the thread bookkeeping can't be allocated all indices run on the caller.
+TEST(ForkJoinTest, RunsOnCallerWithoutAllocator) {
+  static constexpr iree_host_size_t kCount = 4;
+  struct State {
+    CountState counts = CountState(kCount);
+    std::thread::id caller_id = std::this_thread::get_id();
+    bool all_on_caller = true;
+  } state;
+  iree_fork_join(
+      IREE_SV("fork-join-test"), kCount,
+      +[](void* user_data, iree_host_size_t index) {
+        auto* state = reinterpret_cast<State*>(user_data);
+        CountIndex(&state->counts, index);
+        if (std::this_thread::get_id() != state->caller_id) {
+          state->all_on_caller = false;
+        }
+      },
+      &state, iree_allocator_null());
+  EXPECT_TRUE(state.all_on_caller);
+  for (iree_host_size_t i = 0; i < kCount; ++i) {
+    EXPECT_EQ(iree_atomic_load_int32(&state.counts.counts[i],
+                                     iree_memory_order_relaxed),
+              1);
+  }
+}
+
+}  // namespace
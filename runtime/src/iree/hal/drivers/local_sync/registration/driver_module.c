@@ -11,6 +11,7 @@
 
 #include "iree/base/api.h"
 #include "iree/hal/drivers/local_sync/sync_driver.h"
+#include "iree/hal/local/fork_join_pool_flags.h"
 #include "iree/hal/local/loaders/registration/init.h"
 #include "iree/hal/local/plugins/registration/init.h"
 
@@ -58,12 +59,18 @@ static iree_status_t iree_hal_local_sync_driver_factory_try_create(
                                             &device_allocator);
   }
 
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_local_fork_join_pool_create_from_flags(
+        host_allocator, &default_params.fork_join_pool);
+  }
+
   if (iree_status_is_ok(status)) {
     status = iree_hal_sync_driver_create(
         driver_name, &default_params, loader_count, loaders, device_allocator,
         host_allocator, out_driver);
   }
 
+  iree_hal_local_fork_join_pool_release(default_params.fork_join_pool);
   iree_hal_allocator_release(device_allocator);
   for (iree_host_size_t i = 0; i < loader_count; ++i) {
     iree_hal_executable_loader_release(loaders[i]);
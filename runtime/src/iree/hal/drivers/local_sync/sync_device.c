@@ -36,6 +36,9 @@ typedef struct iree_hal_sync_device_t {
   // buffers can contain inlined data uploads).
   iree_arena_block_pool_t large_block_pool;
 
+  // Optional pool used to execute dispatches across multiple threads.
+  iree_hal_local_fork_join_pool_t* fork_join_pool;
+
   // Shared semaphore state used to emulate OS-level primitives. This backend
   // is intended to run on bare-metal systems where we need to perform all
   // synchronization ourselves.
@@ -100,6 +103,8 @@ iree_status_t iree_hal_sync_device_create(
     iree_hal_allocator_retain(device_allocator);
     iree_arena_block_pool_initialize(params->arena_block_size, host_allocator,
                                      &device->large_block_pool);
+    device->fork_join_pool = params->fork_join_pool;
+    iree_hal_local_fork_join_pool_retain(device->fork_join_pool);
 
     device->loader_count = loader_count;
     for (iree_host_size_t i = 0; i < device->loader_count; ++i) {
@@ -134,6 +139,7 @@ static void iree_hal_sync_device_destroy(iree_hal_device_t* base_device) {
   iree_hal_channel_provider_release(device->channel_provider);
 
   iree_arena_block_pool_deinitialize(&device->large_block_pool);
+  iree_hal_local_fork_join_pool_release(device->fork_join_pool);
 
   iree_allocator_free(host_allocator, device);
 
@@ -192,6 +198,10 @@ static iree_status_t iree_hal_sync_device_query_i64(
             ? 1
             : 0;
     return iree_ok_status();
+  } else if (iree_string_view_equal(category,
+                                    IREE_SV("hal.executable.statistics"))) {
+    return iree_hal_query_executable_loader_statistic(
+        device->loader_count, device->loaders, key, out_value);
   } else if (iree_string_view_equal(category, IREE_SV("hal.device"))) {
     if (iree_string_view_equal(key, IREE_SV("concurrency"))) {
       *out_value = 1;
@@ -224,13 +234,14 @@ static iree_status_t iree_hal_sync_device_create_command_buffer(
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
     iree_hal_command_buffer_t** out_command_buffer) {
+  iree_hal_sync_device_t* device = iree_hal_sync_device_cast(base_device);
   if (iree_all_bits_set(mode,
                         IREE_HAL_COMMAND_BUFFER_MODE_ALLOW_INLINE_EXECUTION)) {
     return iree_hal_inline_command_buffer_create(
         base_device, mode, command_categories, queue_affinity, binding_capacity,
-        iree_hal_device_host_allocator(base_device), out_command_buffer);
+        device->fork_join_pool, iree_hal_device_host_allocator(base_device),
+        out_command_buffer);
   } else {
-    iree_hal_sync_device_t* device = iree_hal_sync_device_cast(base_device);
     return iree_hal_deferred_command_buffer_create(
         base_device, mode, command_categories, binding_capacity,
         &device->large_block_pool, device->host_allocator, out_command_buffer);
@@ -260,6 +271,7 @@ static iree_status_t iree_hal_sync_device_create_executable_cache(
   iree_hal_sync_device_t* device = iree_hal_sync_device_cast(base_device);
   return iree_hal_local_executable_cache_create(
       identifier, /*worker_capacity=*/1, device->loader_count, device->loaders,
+      /*load_loop=*/iree_loop_null(),
       iree_hal_device_host_allocator(base_device), out_executable_cache);
 }
 
@@ -346,7 +358,8 @@ static iree_status_t iree_hal_sync_device_apply_deferred_command_buffers(
           iree_hal_command_buffer_mode(command_buffer) |
               IREE_HAL_COMMAND_BUFFER_MODE_ALLOW_INLINE_EXECUTION,
           IREE_HAL_COMMAND_CATEGORY_ANY, IREE_HAL_QUEUE_AFFINITY_ANY,
-          /*binding_capacity=*/0, device->host_allocator, storage,
+          /*binding_capacity=*/0, device->fork_join_pool,
+          device->host_allocator, storage,
           &inline_command_buffer));
       iree_status_t status = iree_hal_deferred_command_buffer_apply(
           command_buffer, inline_command_buffer,
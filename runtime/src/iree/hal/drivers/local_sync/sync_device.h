@@ -10,6 +10,7 @@
 #include "iree/base/api.h"
 #include "iree/hal/api.h"
 #include "iree/hal/local/executable_loader.h"
+#include "iree/hal/local/fork_join_pool.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -22,6 +23,11 @@ typedef struct iree_hal_sync_device_params_t {
   // Larger sizes will lower overhead and ensure the heap isn't hit for
   // transient allocations while also increasing memory consumption.
   iree_host_size_t arena_block_size;
+
+  // Optional pool used to execute the workgroups of each dispatch across
+  // multiple threads. When NULL all work runs on the thread issuing it.
+  // Retained by the device (and by any driver the params are passed to).
+  iree_hal_local_fork_join_pool_t* fork_join_pool;
 } iree_hal_sync_device_params_t;
 
 // Initializes |out_params| to default values.
@@ -64,6 +64,7 @@ iree_status_t iree_hal_sync_driver_create(
         (char*)driver + total_size - identifier.size);
     memcpy(&driver->default_params, default_params,
            sizeof(driver->default_params));
+    iree_hal_local_fork_join_pool_retain(driver->default_params.fork_join_pool);
 
     driver->loader_count = loader_count;
     for (iree_host_size_t i = 0; i < driver->loader_count; ++i) {
@@ -91,6 +92,7 @@ static void iree_hal_sync_driver_destroy(iree_hal_driver_t* base_driver) {
   for (iree_host_size_t i = 0; i < driver->loader_count; ++i) {
     iree_hal_executable_loader_release(driver->loaders[i]);
   }
+  iree_hal_local_fork_join_pool_release(driver->default_params.fork_join_pool);
 
   iree_allocator_free(host_allocator, driver);
 
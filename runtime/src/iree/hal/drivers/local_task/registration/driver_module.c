@@ -10,11 +10,44 @@
 #include <stddef.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/flags.h"
 #include "iree/hal/drivers/local_task/task_driver.h"
 #include "iree/hal/local/loaders/registration/init.h"
 #include "iree/hal/local/plugins/registration/init.h"
 #include "iree/task/api.h"
 
+IREE_FLAG(
+    bool, task_async_executable_loading, true,
+    "Loads executables concurrently on the task executor and completes each\n"
+    "load on the first dispatch of the executable. Disable to load executables\n"
+    "synchronously when they are prepared (reporting load errors there).");
+
+IREE_FLAG(
+    string, task_queue_priority, "normal",
+    "Scheduling priority class of work submitted to local-task devices:\n"
+    "  high: latency-critical work run ahead of everything else\n"
+    "  normal: default\n"
+    "  low: background work that yields to all other work");
+
+// Parses the --task_queue_priority= flag value.
+static iree_status_t iree_hal_local_task_parse_queue_priority_flag(
+    iree_task_priority_class_t* out_priority_class) {
+  iree_string_view_t value = iree_make_cstring_view(FLAG_task_queue_priority);
+  if (iree_string_view_equal(value, IREE_SV("high"))) {
+    *out_priority_class = IREE_TASK_PRIORITY_CLASS_HIGH;
+  } else if (iree_string_view_equal(value, IREE_SV("normal"))) {
+    *out_priority_class = IREE_TASK_PRIORITY_CLASS_NORMAL;
+  } else if (iree_string_view_equal(value, IREE_SV("low"))) {
+    *out_priority_class = IREE_TASK_PRIORITY_CLASS_LOW;
+  } else {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "unsupported --task_queue_priority= value '%s'; "
+                            "expected one of high, normal, or low",
+                            FLAG_task_queue_priority);
+  }
+  return iree_ok_status();
+}
+
 static iree_status_t iree_hal_local_task_driver_factory_enumerate(
     void* self, iree_host_size_t* out_driver_info_count,
     const iree_hal_driver_info_t** out_driver_infos) {
@@ -41,6 +74,9 @@ static iree_status_t iree_hal_local_task_driver_factory_try_create(
 
   iree_hal_task_device_params_t default_params;
   iree_hal_task_device_params_initialize(&default_params);
+  default_params.async_executable_loading = FLAG_task_async_executable_loading;
+  IREE_RETURN_IF_ERROR(iree_hal_local_task_parse_queue_priority_flag(
+      &default_params.queue_priority_class));
 
   // Create executors for each topology specified by flags.
   // Stack allocated storage today but we can query for the total count and
@@ -18,7 +18,6 @@
 #include "iree/hal/local/local_executable.h"
 #include "iree/hal/local/local_pipeline_layout.h"
 #include "iree/hal/utils/resource_set.h"
-#include "iree/task/affinity_set.h"
 #include "iree/task/list.h"
 #include "iree/task/submission.h"
 #include "iree/task/task.h"
@@ -846,8 +845,7 @@ static iree_status_t iree_hal_cmd_dispatch_tile(
       .workgroup_count_x = tile_context->workgroup_count[0],
       .workgroup_count_y = tile_context->workgroup_count[1],
       .workgroup_count_z = tile_context->workgroup_count[2],
-      .max_concurrency =
-          iree_task_affinity_set_count_ones(cmd->task.header.affinity_set),
+      .max_concurrency = tile_context->max_concurrency,
       .binding_count = cmd->binding_count,
   };
   uint8_t* cmd_ptr = (uint8_t*)cmd + sizeof(*cmd);
@@ -884,8 +882,10 @@ static iree_status_t iree_hal_task_command_buffer_build_dispatch(
   iree_hal_task_command_buffer_t* command_buffer =
       iree_hal_task_command_buffer_cast(base_command_buffer);
 
-  iree_hal_local_executable_t* local_executable =
-      iree_hal_local_executable_cast(executable);
+  // Executables that are still loading complete here on their first use.
+  iree_hal_local_executable_t* local_executable = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_local_executable_resolve(
+      iree_hal_local_executable_cast(executable), &local_executable));
   if (IREE_UNLIKELY(!local_executable->pipeline_layouts)) {
     return iree_make_status(
         IREE_STATUS_FAILED_PRECONDITION,
@@ -42,6 +42,11 @@ typedef struct iree_hal_task_device_t {
   // Optional provider used for creating/configuring collective channels.
   iree_hal_channel_provider_t* channel_provider;
 
+  // Scope for executable loads issued to the queue 0 executor when
+  // asynchronous executable loading is enabled.
+  bool async_executable_loading;
+  iree_task_scope_t executable_load_scope;
+
   iree_host_size_t queue_count;
   iree_hal_task_queue_t queues[];
 } iree_hal_task_device_t;
@@ -57,6 +62,8 @@ static iree_hal_task_device_t* iree_hal_task_device_cast(
 void iree_hal_task_device_params_initialize(
     iree_hal_task_device_params_t* out_params) {
   out_params->arena_block_size = 32 * 1024;
+  out_params->async_executable_loading = true;
+  out_params->queue_priority_class = IREE_TASK_PRIORITY_CLASS_NORMAL;
 }
 
 static iree_status_t iree_hal_task_device_check_params(
@@ -69,6 +76,11 @@ static iree_status_t iree_hal_task_device_check_params(
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                             "must have at least one queue");
   }
+  if (params->queue_priority_class >= IREE_TASK_PRIORITY_CLASS_COUNT) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "invalid queue priority class %u",
+                            params->queue_priority_class);
+  }
   return iree_ok_status();
 }
 
@@ -119,6 +131,10 @@ iree_status_t iree_hal_task_device_create(
     iree_arena_block_pool_initialize(params->arena_block_size, host_allocator,
                                      &device->large_block_pool);
 
+    device->async_executable_loading = params->async_executable_loading;
+    iree_task_scope_initialize(device->identifier,
+                               &device->executable_load_scope);
+
     device->loader_count = loader_count;
     device->loaders =
         (iree_hal_executable_loader_t**)((uint8_t*)device + sizeof(*device) +
@@ -131,9 +147,9 @@ iree_status_t iree_hal_task_device_create(
     device->queue_count = queue_count;
     for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
       // TODO(benvanik): add a number to each queue ID.
-      iree_hal_task_queue_initialize(device->identifier, queue_executors[i],
-                                     &device->small_block_pool,
-                                     &device->queues[i]);
+      iree_hal_task_queue_initialize(
+          device->identifier, queue_executors[i], params->queue_priority_class,
+          &device->small_block_pool, &device->queues[i]);
     }
   }
 
@@ -151,6 +167,11 @@ static void iree_hal_task_device_destroy(iree_hal_device_t* base_device) {
   iree_allocator_t host_allocator = iree_hal_device_host_allocator(base_device);
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  // Executables still loading reference the loaders and queue executor.
+  iree_status_ignore(iree_task_scope_wait_idle(&device->executable_load_scope,
+                                               IREE_TIME_INFINITE_FUTURE));
+  iree_task_scope_deinitialize(&device->executable_load_scope);
+
   for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
     iree_hal_task_queue_deinitialize(&device->queues[i]);
   }
@@ -233,6 +254,10 @@ static iree_status_t iree_hal_task_device_query_i64(
             ? 1
             : 0;
     return iree_ok_status();
+  } else if (iree_string_view_equal(category,
+                                    IREE_SV("hal.executable.statistics"))) {
+    return iree_hal_query_executable_loader_statistic(
+        device->loader_count, device->loaders, key, out_value);
   } else if (iree_string_view_equal(category, IREE_SV("hal.device"))) {
     if (iree_string_view_equal(key, IREE_SV("concurrency"))) {
       *out_value = (int64_t)device->queue_count;
@@ -308,11 +333,94 @@ static iree_status_t iree_hal_task_device_create_event(
                                     out_event);
 }
 
+// A loop call issued to the queue 0 executor to load an executable.
+typedef struct iree_hal_task_device_load_cmd_t {
+  // Call to execute.
+  iree_task_call_t task;
+
+  // Loop the call was issued on; passed back to the callback.
+  iree_loop_t loop;
+
+  // Callback to issue. Cleared once issued.
+  iree_loop_callback_t callback;
+
+  // Allocator used for this command.
+  iree_allocator_t host_allocator;
+} iree_hal_task_device_load_cmd_t;
+
+static iree_status_t iree_hal_task_device_load_cmd(
+    void* user_context, iree_task_t* task,
+    iree_task_submission_t* pending_submission) {
+  iree_hal_task_device_load_cmd_t* cmd = (iree_hal_task_device_load_cmd_t*)task;
+  iree_loop_callback_t callback = cmd->callback;
+  cmd->callback.fn = NULL;
+  return callback.fn(callback.user_data, cmd->loop, iree_ok_status());
+}
+
+static void iree_hal_task_device_load_cmd_cleanup(
+    iree_task_t* task, iree_status_code_t status_code) {
+  iree_hal_task_device_load_cmd_t* cmd = (iree_hal_task_device_load_cmd_t*)task;
+  // Loop callbacks must always be issued, including when the call is aborted
+  // before it has a chance to run.
+  if (cmd->callback.fn) {
+    iree_status_ignore(cmd->callback.fn(
+        cmd->callback.user_data, cmd->loop,
+        iree_make_status(IREE_STATUS_ABORTED, "executable load aborted")));
+  }
+  iree_allocator_free(cmd->host_allocator, cmd);
+}
+
+// Loop used by executable caches to load executables on the queue 0 executor.
+// Only calls are supported as that is all the caches require.
+static iree_status_t iree_hal_task_device_load_loop_ctl(
+    void* self, iree_loop_command_t command, const void* params,
+    void** inout_ptr) {
+  iree_hal_task_device_t* device = (iree_hal_task_device_t*)self;
+  if (IREE_UNLIKELY(command != IREE_LOOP_COMMAND_CALL)) {
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                            "executable load loop only supports calls");
+  }
+  const iree_loop_call_params_t* call_params =
+      (const iree_loop_call_params_t*)params;
+
+  iree_hal_task_device_load_cmd_t* cmd = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(device->host_allocator,
+                                             sizeof(*cmd), (void**)&cmd));
+  iree_task_call_initialize(
+      &device->executable_load_scope,
+      iree_task_make_call_closure(iree_hal_task_device_load_cmd, 0),
+      &cmd->task);
+  iree_task_set_cleanup_fn(&cmd->task.header,
+                           iree_hal_task_device_load_cmd_cleanup);
+  cmd->loop.self = device;
+  cmd->loop.ctl = iree_hal_task_device_load_loop_ctl;
+  cmd->callback = call_params->callback;
+  cmd->host_allocator = device->host_allocator;
+
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  iree_task_submission_enqueue(&submission, &cmd->task.header);
+  iree_task_executor_t* executor = device->queues[0].executor;
+  iree_task_executor_submit(executor, &submission);
+  iree_task_executor_flush(executor);
+  return iree_ok_status();
+}
+
 static iree_status_t iree_hal_task_device_create_executable_cache(
     iree_hal_device_t* base_device, iree_string_view_t identifier,
     iree_loop_t loop, iree_hal_executable_cache_t** out_executable_cache) {
   iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
 
+  // Executables are loaded on the device executor so that programs creating
+  // many of them (usually all during initialization) load them in parallel.
+  // The device outlives the caches it creates and waits for pending loads
+  // before it is destroyed.
+  iree_loop_t load_loop = iree_loop_null();
+  if (device->async_executable_loading) {
+    load_loop.self = device;
+    load_loop.ctl = iree_hal_task_device_load_loop_ctl;
+  }
+
   // Sum up the total worker count across all queues so that the loaders can
   // preallocate worker-specific storage.
   iree_host_size_t total_worker_count = 0;
@@ -323,7 +431,8 @@ static iree_status_t iree_hal_task_device_create_executable_cache(
 
   return iree_hal_local_executable_cache_create(
       identifier, total_worker_count, device->loader_count, device->loaders,
-      iree_hal_device_host_allocator(base_device), out_executable_cache);
+      load_loop, iree_hal_device_host_allocator(base_device),
+      out_executable_cache);
 }
 
 static iree_status_t iree_hal_task_device_create_pipeline_layout(
@@ -23,6 +23,17 @@ typedef struct iree_hal_task_device_params_t {
   // Larger sizes will lower overhead and ensure the heap isn't hit for
   // transient allocations while also increasing memory consumption.
   iree_host_size_t arena_block_size;
+
+  // Loads executables concurrently on the queue executor instead of during
+  // their preparation. Load failures are reported when the executable is first
+  // dispatched instead of from preparation.
+  bool async_executable_loading;
+
+  // Scheduling priority class of all work submitted to the device queues.
+  // Workers run tasks of more important classes first and dispatches of less
+  // important classes yield to them between tiles. Devices sharing an executor
+  // can use this to prioritize latency-sensitive work over background work.
+  iree_task_priority_class_t queue_priority_class;
 } iree_hal_task_device_params_t;
 
 // Initializes |out_params| to default values.
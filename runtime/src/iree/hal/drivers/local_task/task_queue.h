@@ -39,8 +39,11 @@ typedef struct iree_hal_task_queue_t {
   iree_hal_task_queue_state_t state;
 } iree_hal_task_queue_t;
 
+// Initializes a queue scheduling all of its work on |executor| with the given
+// |priority_class|.
 void iree_hal_task_queue_initialize(iree_string_view_t identifier,
                                     iree_task_executor_t* executor,
+                                    iree_task_priority_class_t priority_class,
                                     iree_arena_block_pool_t* block_pool,
                                     iree_hal_task_queue_t* out_queue);
 
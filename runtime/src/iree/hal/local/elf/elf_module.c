@@ -32,6 +32,10 @@ typedef struct iree_elf_module_load_state_t {
   iree_elf_addr_t init;               // DT_INIT
   const iree_elf_addr_t* init_array;  // DT_INIT_ARRAY
   iree_host_size_t init_array_count;  // DT_INIT_ARRAYSZ
+
+  // True if the module was loaded at the base address it was linked for and
+  // the relocated values are already present in the loaded segments.
+  bool is_prelinked;
 } iree_elf_module_load_state_t;
 
 // Verifies the ELF file header and machine class.
@@ -240,14 +244,24 @@ static iree_status_t iree_elf_module_load_segments(
   iree_byte_range_t vaddr_range =
       iree_elf_module_calculate_vaddr_range(load_state);
 
+  // Shared objects are normally linked at 0 and may be placed anywhere. Those
+  // linked at a non-zero base (such as with --iree-llvmcpu-embedded-prelink)
+  // have their relocations pre-applied for that base and if we can place them
+  // there we can skip relocation entirely.
+  void* preferred_base_address =
+      vaddr_range.offset != 0 ? (void*)vaddr_range.offset : NULL;
+
   // Reserve virtual address space in the host memory space. This memory is
   // uncommitted by default as the ELF may only sparsely use the address space.
   module->vaddr_size = iree_page_align_end(
       vaddr_range.length, load_state->memory_info.normal_page_size);
   IREE_RETURN_IF_ERROR(iree_memory_view_reserve(
       IREE_MEMORY_VIEW_FLAG_MAY_EXECUTE, module->vaddr_size,
-      module->host_allocator, (void**)&module->vaddr_base));
+      preferred_base_address, module->host_allocator,
+      (void**)&module->vaddr_base));
   module->vaddr_bias = module->vaddr_base - vaddr_range.offset;
+  load_state->is_prelinked =
+      preferred_base_address != NULL && module->vaddr_bias == NULL;
 
   // Commit and load all of the segments.
   for (iree_elf_half_t i = 0; i < load_state->ehdr->e_phnum; ++i) {
@@ -494,6 +508,10 @@ static iree_status_t iree_elf_module_verify_no_imports(
 // Applies symbol and address base relocations to the loaded sections.
 static iree_status_t iree_elf_module_apply_relocations(
     iree_elf_module_load_state_t* load_state, iree_elf_module_t* module) {
+  // Prelinked modules loaded at their link base already contain the values
+  // relocation would produce.
+  if (load_state->is_prelinked) return iree_ok_status();
+
   // Redirect to the architecture-specific handler.
   iree_elf_relocation_state_t reloc_state;
   memset(&reloc_state, 0, sizeof(reloc_state));
@@ -8,6 +8,7 @@
 #include "iree/base/internal/cpu.h"
 #include "iree/base/target_platform.h"
 #include "iree/hal/local/elf/elf_module.h"
+#include "iree/hal/local/elf/platform.h"
 #include "iree/hal/local/executable_environment.h"
 #include "iree/hal/local/executable_library.h"
 
@@ -52,23 +53,15 @@ static iree_status_t query_arch_test_file_data(
                           "the application for the current target platform");
 }
 
-static iree_status_t run_test() {
-  iree_const_byte_span_t file_data;
-  IREE_RETURN_IF_ERROR(query_arch_test_file_data(&file_data));
-
-  iree_elf_import_table_t import_table;
-  memset(&import_table, 0, sizeof(import_table));
-  iree_elf_module_t module;
-  IREE_RETURN_IF_ERROR(iree_elf_module_initialize_from_memory(
-      file_data, &import_table, iree_allocator_system(), &module));
-
+// Runs the single dispatch function exported by the loaded |module|.
+static iree_status_t run_module(iree_elf_module_t* module) {
   iree_hal_executable_environment_v0_t environment;
   iree_hal_executable_environment_initialize(iree_allocator_system(),
                                              &environment);
 
   void* query_fn_ptr = NULL;
   IREE_RETURN_IF_ERROR(iree_elf_module_lookup_export(
-      &module, IREE_HAL_EXECUTABLE_LIBRARY_EXPORT_NAME, &query_fn_ptr));
+      module, IREE_HAL_EXECUTABLE_LIBRARY_EXPORT_NAME, &query_fn_ptr));
 
   union {
     const iree_hal_executable_library_header_t** header;
@@ -141,21 +134,292 @@ static iree_status_t run_test() {
                             "dispatch function returned failure: %d", ret);
   }
 
-  iree_status_t status = iree_ok_status();
   for (int i = 0; i < IREE_ARRAYSIZE(expected); ++i) {
     if (ret0[i] != expected[i]) {
-      status =
-          iree_make_status(IREE_STATUS_INTERNAL,
-                           "output mismatch: ret[%d] = %.1f, expected %.1f", i,
-                           ret0[i], expected[i]);
-      break;
+      return iree_make_status(IREE_STATUS_INTERNAL,
+                              "output mismatch: ret[%d] = %.1f, expected %.1f",
+                              i, ret0[i], expected[i]);
     }
   }
+  return iree_ok_status();
+}
 
+// Loads the ELF in |file_data|, runs it, and unloads it. The bias the module
+// was loaded with is returned in |out_vaddr_bias|.
+static iree_status_t load_and_run_module(iree_const_byte_span_t file_data,
+                                         uint8_t** out_vaddr_bias) {
+  iree_elf_import_table_t import_table;
+  memset(&import_table, 0, sizeof(import_table));
+  iree_elf_module_t module;
+  IREE_RETURN_IF_ERROR(iree_elf_module_initialize_from_memory(
+      file_data, &import_table, iree_allocator_system(), &module));
+  *out_vaddr_bias = module.vaddr_bias;
+  iree_status_t status = run_module(&module);
   iree_elf_module_deinitialize(&module);
   return status;
 }
 
+//===----------------------------------------------------------------------===//
+// Prelinked modules
+//===----------------------------------------------------------------------===//
+
+// Relative relocation type of the current architecture. The testdata is
+// produced by the compiler and only contains relative relocations.
+#if defined(IREE_ARCH_ARM_32)
+#define TEST_R_RELATIVE 23  // R_ARM_RELATIVE
+#elif defined(IREE_ARCH_ARM_64)
+#define TEST_R_RELATIVE 1027  // R_AARCH64_RELATIVE
+#elif defined(IREE_ARCH_RISCV_32) || defined(IREE_ARCH_RISCV_64)
+#define TEST_R_RELATIVE 3  // R_RISCV_RELATIVE
+#elif defined(IREE_ARCH_X86_32)
+#define TEST_R_RELATIVE 8  // R_386_RELATIVE
+#elif defined(IREE_ARCH_X86_64)
+#define TEST_R_RELATIVE 8  // R_X86_64_RELATIVE
+#endif  // IREE_ARCH_*
+
+// Base address the testdata is prelinked at. Chosen to be well away from
+// where the host places its own mappings.
+#if defined(IREE_PTR_SIZE_64)
+#define TEST_PRELINK_BASE ((iree_elf_addr_t)0x3000000000ull)
+#else
+#define TEST_PRELINK_BASE ((iree_elf_addr_t)0x30000000u)
+#endif  // IREE_PTR_SIZE_*
+
+// Returns a pointer into |file_data| for the loaded address |vaddr| or NULL if
+// it is not backed by file contents.
+static uint8_t* prelink_map_vaddr(iree_byte_span_t file_data,
+                                  iree_elf_addr_t vaddr,
+                                  iree_host_size_t length) {
+  const iree_elf_ehdr_t* ehdr = (const iree_elf_ehdr_t*)file_data.data;
+  const iree_elf_phdr_t* phdr_table =
+      (const iree_elf_phdr_t*)(file_data.data + ehdr->e_phoff);
+  for (iree_elf_half_t i = 0; i < ehdr->e_phnum; ++i) {
+    const iree_elf_phdr_t* phdr = &phdr_table[i];
+    if (phdr->p_type != IREE_ELF_PT_LOAD) continue;
+    if (vaddr < phdr->p_vaddr ||
+        vaddr + length > phdr->p_vaddr + phdr->p_filesz) {
+      continue;
+    }
+    return file_data.data + phdr->p_offset + (vaddr - phdr->p_vaddr);
+  }
+  return NULL;
+}
+
+// Rewrites the ELF in |file_data| in-place as if it had been linked at |base|
+// with its relocations applied for that base (as done by
+// --iree-llvmcpu-embedded-prelink). Fails if the ELF has relocations other
+// than relative ones as those would require symbol resolution.
+static iree_status_t prelink_file_data(iree_byte_span_t file_data,
+                                       iree_elf_addr_t base) {
+#if !defined(TEST_R_RELATIVE)
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                          "no relative relocation type for this architecture");
+#else
+  iree_elf_ehdr_t* ehdr = (iree_elf_ehdr_t*)file_data.data;
+  iree_elf_phdr_t* phdr_table =
+      (iree_elf_phdr_t*)(file_data.data + ehdr->e_phoff);
+
+  // Gather the tables referenced from the dynamic segment while the addresses
+  // are still relative to 0.
+  iree_elf_dyn_t* dyn_table = NULL;
+  iree_host_size_t dyn_count = 0;
+  for (iree_elf_half_t i = 0; i < ehdr->e_phnum; ++i) {
+    if (phdr_table[i].p_type != IREE_ELF_PT_DYNAMIC) continue;
+    dyn_table = (iree_elf_dyn_t*)(file_data.data + phdr_table[i].p_offset);
+    dyn_count = phdr_table[i].p_filesz / sizeof(iree_elf_dyn_t);
+  }
+  iree_elf_addr_t rel_vaddr = 0, rela_vaddr = 0, symtab_vaddr = 0;
+  iree_elf_addr_t hash_vaddr = 0;
+  iree_host_size_t rel_size = 0, rela_size = 0, pltrel_size = 0;
+  for (iree_host_size_t i = 0; i < dyn_count; ++i) {
+    iree_elf_dyn_t* dyn = &dyn_table[i];
+    switch (dyn->d_tag) {
+      case IREE_ELF_DT_REL:
+        rel_vaddr = dyn->d_un.d_ptr;
+        break;
+      case IREE_ELF_DT_RELSZ:
+        rel_size = dyn->d_un.d_val;
+        break;
+      case IREE_ELF_DT_RELA:
+        rela_vaddr = dyn->d_un.d_ptr;
+        break;
+      case IREE_ELF_DT_RELASZ:
+        rela_size = dyn->d_un.d_val;
+        break;
+      case IREE_ELF_DT_PLTRELSZ:
+        pltrel_size = dyn->d_un.d_val;
+        break;
+      case IREE_ELF_DT_SYMTAB:
+        symtab_vaddr = dyn->d_un.d_ptr;
+        break;
+      case IREE_ELF_DT_HASH:
+        hash_vaddr = dyn->d_un.d_ptr;
+        break;
+      default:
+        break;
+    }
+  }
+  if (pltrel_size != 0) {
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                            "PLT relocations require symbol resolution");
+  }
+
+  // Apply the relocations for the new base. Relocations with an explicit
+  // addend keep it pointing at the new base so that loading elsewhere still
+  // works; implicit addends are updated in the target.
+  iree_elf_rel_t* rel_table =
+      rel_size ? (iree_elf_rel_t*)prelink_map_vaddr(file_data, rel_vaddr,
+                                                    rel_size)
+               : NULL;
+  for (iree_host_size_t i = 0; i < rel_size / sizeof(iree_elf_rel_t); ++i) {
+    iree_elf_rel_t* rel = &rel_table[i];
+    iree_elf_addr_t* target = (iree_elf_addr_t*)prelink_map_vaddr(
+        file_data, rel->r_offset, sizeof(iree_elf_addr_t));
+    if (IREE_ELF_R_TYPE(rel->r_info) != TEST_R_RELATIVE || !target) {
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unsupported relocation");
+    }
+    *target += base;
+    rel->r_offset += base;
+  }
+  iree_elf_rela_t* rela_table =
+      rela_size ? (iree_elf_rela_t*)prelink_map_vaddr(file_data, rela_vaddr,
+                                                      rela_size)
+                : NULL;
+  for (iree_host_size_t i = 0; i < rela_size / sizeof(iree_elf_rela_t); ++i) {
+    iree_elf_rela_t* rela = &rela_table[i];
+    iree_elf_addr_t* target = (iree_elf_addr_t*)prelink_map_vaddr(
+        file_data, rela->r_offset, sizeof(iree_elf_addr_t));
+    if (IREE_ELF_R_TYPE(rela->r_info) != TEST_R_RELATIVE || !target) {
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unsupported relocation");
+    }
+    rela->r_addend += base;
+    *target = (iree_elf_addr_t)rela->r_addend;
+    rela->r_offset += base;
+  }
+
+  // Move all defined symbols to the new base. The symbol count comes from
+  // the DT_HASH nchain field.
+  const iree_elf_word_t* hash_table = (const iree_elf_word_t*)prelink_map_vaddr(
+      file_data, hash_vaddr, 2 * sizeof(iree_elf_word_t));
+  iree_host_size_t sym_count = hash_table ? hash_table[1] : 0;
+  iree_elf_sym_t* sym_table = (iree_elf_sym_t*)prelink_map_vaddr(
+      file_data, symtab_vaddr, sym_count * sizeof(iree_elf_sym_t));
+  for (iree_host_size_t i = 0; sym_table && i < sym_count; ++i) {
+    iree_elf_sym_t* sym = &sym_table[i];
+    if (sym->st_shndx == IREE_ELF_SHN_UNDEF || sym->st_shndx >= 0xFF00) {
+      continue;  // undefined, absolute, or otherwise special
+    }
+    sym->st_value += base;
+  }
+
+  // Move the dynamic table pointers and all segments.
+  for (iree_host_size_t i = 0; i < dyn_count; ++i) {
+    iree_elf_dyn_t* dyn = &dyn_table[i];
+    switch (dyn->d_tag) {
+      case IREE_ELF_DT_PLTGOT:
+      case IREE_ELF_DT_HASH:
+      case IREE_ELF_DT_STRTAB:
+      case IREE_ELF_DT_SYMTAB:
+      case IREE_ELF_DT_RELA:
+      case IREE_ELF_DT_INIT:
+      case IREE_ELF_DT_FINI:
+      case IREE_ELF_DT_REL:
+      case IREE_ELF_DT_JMPREL:
+      case IREE_ELF_DT_INIT_ARRAY:
+      case IREE_ELF_DT_FINI_ARRAY:
+        if (dyn->d_un.d_ptr) dyn->d_un.d_ptr += base;
+        break;
+      default:
+        break;
+    }
+  }
+  for (iree_elf_half_t i = 0; i < ehdr->e_phnum; ++i) {
+    phdr_table[i].p_vaddr += base;
+    phdr_table[i].p_paddr += base;
+  }
+  if (ehdr->e_entry) ehdr->e_entry += base;
+  return iree_ok_status();
+#endif  // TEST_R_RELATIVE
+}
+
+// Loads a prelinked copy of |file_data| both with its preferred base address
+// taken and with it available. The former must fall back to relocating the
+// module and the latter must load it at the base without a bias.
+static iree_status_t run_prelinked_test(iree_const_byte_span_t file_data) {
+  iree_allocator_t host_allocator = iree_allocator_system();
+  uint8_t* prelinked_data = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      host_allocator, file_data.data_length, (void**)&prelinked_data));
+  memcpy(prelinked_data, file_data.data, file_data.data_length);
+  iree_status_t status = prelink_file_data(
+      iree_make_byte_span(prelinked_data, file_data.data_length),
+      TEST_PRELINK_BASE);
+  if (iree_status_is_unimplemented(status)) {
+    // The testdata for this architecture cannot be prelinked here; skip.
+    fprintf(stdout, "skipping prelinked module test: ");
+    iree_status_fprint(stdout, status);
+    iree_status_ignore(status);
+    iree_allocator_free(host_allocator, prelinked_data);
+    return iree_ok_status();
+  }
+  iree_const_byte_span_t prelinked_file_data =
+      iree_make_const_byte_span(prelinked_data, file_data.data_length);
+
+  // Occupy the preferred base address. Hosts are free to ignore address hints
+  // in which case the base is unavailable to the module anyway.
+  void* preferred_base_address = (void*)(uintptr_t)TEST_PRELINK_BASE;
+  const iree_host_size_t reservation_length = 64 * 1024;
+  void* reservation = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_memory_view_reserve(IREE_MEMORY_VIEW_FLAG_NONE,
+                                      reservation_length,
+                                      preferred_base_address, host_allocator,
+                                      &reservation);
+  }
+  const bool is_hint_honored = reservation == preferred_base_address;
+
+  // Preferred base taken: the module must be relocated to where it landed.
+  uint8_t* vaddr_bias = NULL;
+  if (iree_status_is_ok(status)) {
+    status = load_and_run_module(prelinked_file_data, &vaddr_bias);
+  }
+  if (iree_status_is_ok(status) && is_hint_honored && vaddr_bias == NULL) {
+    status = iree_make_status(IREE_STATUS_INTERNAL,
+                              "prelinked module loaded over an existing "
+                              "reservation of its preferred base");
+  }
+  if (reservation) {
+    iree_memory_view_release(reservation, reservation_length, host_allocator);
+  }
+
+  // Preferred base available: the module must be loaded there as-is.
+  if (iree_status_is_ok(status)) {
+    status = load_and_run_module(prelinked_file_data, &vaddr_bias);
+  }
+  if (iree_status_is_ok(status) && is_hint_honored && vaddr_bias != NULL) {
+    status = iree_make_status(IREE_STATUS_INTERNAL,
+                              "prelinked module not loaded at its preferred "
+                              "base (bias %p)",
+                              vaddr_bias);
+  }
+
+  iree_allocator_free(host_allocator, prelinked_data);
+  return status;
+}
+
+static iree_status_t run_test() {
+  iree_const_byte_span_t file_data;
+  IREE_RETURN_IF_ERROR(query_arch_test_file_data(&file_data));
+
+  // Modules linked at 0 are always relocated to where they are loaded.
+  uint8_t* vaddr_bias = NULL;
+  IREE_RETURN_IF_ERROR(load_and_run_module(file_data, &vaddr_bias));
+
+  return run_prelinked_test(file_data);
+}
+
 int main() {
   const iree_status_t result = run_test();
   int ret = (int)iree_status_code(result);
@@ -140,9 +140,15 @@ typedef uint32_t iree_memory_view_flags_t;
 // first be committed with iree_memory_view_commit_ranges and then may have
 // their access permissions changed with iree_memory_view_protect_ranges.
 //
+// An optional |preferred_base_address| may be provided as a hint of where to
+// place the range. It is only a hint: if the range is unavailable (or the
+// platform does not support placement) the reservation is made elsewhere and
+// callers must check |out_base_address|.
+//
 // Implemented by VirtualAlloc+MEM_RESERVE/mmap+PROT_NONE.
 iree_status_t iree_memory_view_reserve(iree_memory_view_flags_t flags,
                                        iree_host_size_t total_length,
+                                       void* preferred_base_address,
                                        iree_allocator_t host_allocator,
                                        void** out_base_address);
 
@@ -41,6 +41,7 @@ void iree_memory_jit_context_end(void) {}
 
 iree_status_t iree_memory_view_reserve(iree_memory_view_flags_t flags,
                                        iree_host_size_t total_length,
+                                       void* preferred_base_address,
                                        iree_allocator_t host_allocator,
                                        void** out_base_address) {
   *out_base_address = NULL;
@@ -55,6 +55,7 @@ static int iree_memory_access_to_prot(iree_memory_access_t access) {
 
 iree_status_t iree_memory_view_reserve(iree_memory_view_flags_t flags,
                                        iree_host_size_t total_length,
+                                       void* preferred_base_address,
                                        iree_allocator_t host_allocator,
                                        void** out_base_address) {
   *out_base_address = NULL;
@@ -64,7 +65,10 @@ iree_status_t iree_memory_view_reserve(iree_memory_view_flags_t flags,
   int mmap_flags = MAP_PRIVATE | MAP_ANON | MAP_NORESERVE;
 
   iree_status_t status = iree_ok_status();
-  void* base_address = mmap(NULL, total_length, mmap_prot, mmap_flags, -1, 0);
+  // NOTE: without MAP_FIXED the address is only a hint and the kernel will
+  // place the mapping elsewhere if the range is in use.
+  void* base_address = mmap(preferred_base_address, total_length, mmap_prot,
+                            mmap_flags, -1, 0);
   if (base_address == MAP_FAILED) {
     status = iree_make_status(iree_status_code_from_errno(errno),
                               "mmap reservation failed");
@@ -68,6 +68,7 @@ static DWORD iree_memory_access_to_win32_page_flags(
 
 iree_status_t iree_memory_view_reserve(iree_memory_view_flags_t flags,
                                        iree_host_size_t total_length,
+                                       void* preferred_base_address,
                                        iree_allocator_t host_allocator,
                                        void** out_base_address) {
   *out_base_address = NULL;
@@ -75,8 +76,16 @@ iree_status_t iree_memory_view_reserve(iree_memory_view_flags_t flags,
 
   iree_status_t status = iree_ok_status();
 
-  void* base_address =
-      VirtualAlloc(NULL, total_length, MEM_RESERVE, PAGE_NOACCESS);
+  // VirtualAlloc fails if the requested address is unavailable instead of
+  // treating it as a hint so we retry anywhere.
+  void* base_address = NULL;
+  if (preferred_base_address) {
+    base_address = VirtualAlloc(preferred_base_address, total_length,
+                                MEM_RESERVE, PAGE_NOACCESS);
+  }
+  if (base_address == NULL) {
+    base_address = VirtualAlloc(NULL, total_length, MEM_RESERVE, PAGE_NOACCESS);
+  }
   if (base_address == NULL) {
     status = iree_make_status(iree_status_code_from_win32_error(GetLastError()),
                               "VirtualAlloc failed to reserve");
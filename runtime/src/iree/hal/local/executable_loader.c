@@ -6,6 +6,8 @@
 
 #include "iree/hal/local/executable_loader.h"
 
+#include <string.h>
+
 #include "iree/base/tracing.h"
 
 iree_status_t iree_hal_executable_import_provider_try_resolve(
@@ -55,6 +57,16 @@ void iree_hal_executable_loader_initialize(
   iree_atomic_ref_count_init(&out_base_loader->ref_count);
   out_base_loader->vtable = vtable;
   out_base_loader->import_provider = import_provider;
+  IREE_STATISTICS({
+    iree_atomic_store_int64(&out_base_loader->statistics.load_count, 0,
+                            iree_memory_order_relaxed);
+    iree_atomic_store_int64(&out_base_loader->statistics.load_bytes, 0,
+                            iree_memory_order_relaxed);
+    iree_atomic_store_int64(&out_base_loader->statistics.load_time_ns, 0,
+                            iree_memory_order_relaxed);
+    iree_atomic_store_int64(&out_base_loader->statistics.load_time_max_ns, 0,
+                            iree_memory_order_relaxed);
+  });
 }
 
 void iree_hal_executable_loader_retain(
@@ -95,6 +107,82 @@ bool iree_hal_query_any_executable_loader_support(
   return false;
 }
 
+void iree_hal_executable_loader_query_statistics(
+    iree_hal_executable_loader_t* executable_loader,
+    iree_hal_executable_loader_statistics_t* out_statistics) {
+  IREE_ASSERT_ARGUMENT(executable_loader);
+  IREE_ASSERT_ARGUMENT(out_statistics);
+  memset(out_statistics, 0, sizeof(*out_statistics));
+  IREE_STATISTICS({
+    out_statistics->load_count = iree_atomic_load_int64(
+        &executable_loader->statistics.load_count, iree_memory_order_relaxed);
+    out_statistics->load_bytes = iree_atomic_load_int64(
+        &executable_loader->statistics.load_bytes, iree_memory_order_relaxed);
+    out_statistics->load_time_ns = iree_atomic_load_int64(
+        &executable_loader->statistics.load_time_ns, iree_memory_order_relaxed);
+    out_statistics->load_time_max_ns =
+        iree_atomic_load_int64(&executable_loader->statistics.load_time_max_ns,
+                               iree_memory_order_relaxed);
+  });
+}
+
+iree_status_t iree_hal_query_executable_loader_statistic(
+    iree_host_size_t loader_count, iree_hal_executable_loader_t** loaders,
+    iree_string_view_t key, int64_t* out_value) {
+  IREE_ASSERT_ARGUMENT(!loader_count || loaders);
+  IREE_ASSERT_ARGUMENT(out_value);
+  *out_value = 0;
+#if IREE_STATISTICS_ENABLE
+  const bool is_count = iree_string_view_equal(key, IREE_SV("load_count"));
+  const bool is_bytes = iree_string_view_equal(key, IREE_SV("load_bytes"));
+  const bool is_time = iree_string_view_equal(key, IREE_SV("load_time_ns"));
+  const bool is_time_max =
+      iree_string_view_equal(key, IREE_SV("load_time_max_ns"));
+  if (is_count || is_bytes || is_time || is_time_max) {
+    for (iree_host_size_t i = 0; i < loader_count; ++i) {
+      iree_hal_executable_loader_statistics_t statistics;
+      iree_hal_executable_loader_query_statistics(loaders[i], &statistics);
+      if (is_count) {
+        *out_value += statistics.load_count;
+      } else if (is_bytes) {
+        *out_value += statistics.load_bytes;
+      } else if (is_time) {
+        *out_value += statistics.load_time_ns;
+      } else {
+        *out_value = iree_max(*out_value, statistics.load_time_max_ns);
+      }
+    }
+    return iree_ok_status();
+  }
+#endif  // IREE_STATISTICS_ENABLE
+  return iree_make_status(IREE_STATUS_NOT_FOUND,
+                          "executable loader statistic '%.*s' not available",
+                          (int)key.size, key.data);
+}
+
+#if IREE_STATISTICS_ENABLE
+static void iree_hal_executable_loader_record_load(
+    iree_hal_executable_loader_t* executable_loader,
+    iree_host_size_t executable_size, iree_duration_t load_time_ns) {
+  iree_atomic_fetch_add_int64(&executable_loader->statistics.load_count, 1,
+                              iree_memory_order_relaxed);
+  iree_atomic_fetch_add_int64(&executable_loader->statistics.load_bytes,
+                              (int64_t)executable_size,
+                              iree_memory_order_relaxed);
+  iree_atomic_fetch_add_int64(&executable_loader->statistics.load_time_ns,
+                              load_time_ns, iree_memory_order_relaxed);
+  int64_t max_ns =
+      iree_atomic_load_int64(&executable_loader->statistics.load_time_max_ns,
+                             iree_memory_order_relaxed);
+  while (load_time_ns > max_ns &&
+         !iree_atomic_compare_exchange_weak_int64(
+             &executable_loader->statistics.load_time_max_ns, &max_ns,
+             load_time_ns, iree_memory_order_relaxed,
+             iree_memory_order_relaxed)) {
+  }
+}
+#endif  // IREE_STATISTICS_ENABLE
+
 iree_status_t iree_hal_executable_loader_try_load(
     iree_hal_executable_loader_t* executable_loader,
     const iree_hal_executable_params_t* executable_params,
@@ -106,6 +194,15 @@ iree_status_t iree_hal_executable_loader_try_load(
   IREE_ASSERT_ARGUMENT(!executable_params->executable_data.data_length ||
                        executable_params->executable_data.data);
   IREE_ASSERT_ARGUMENT(out_executable);
-  return executable_loader->vtable->try_load(
+  IREE_STATISTICS(iree_time_t start_time_ns = iree_time_now());
+  iree_status_t status = executable_loader->vtable->try_load(
       executable_loader, executable_params, worker_capacity, out_executable);
+  IREE_STATISTICS({
+    if (iree_status_is_ok(status)) {
+      iree_hal_executable_loader_record_load(
+          executable_loader, executable_params->executable_data.data_length,
+          iree_time_now() - start_time_ns);
+    }
+  });
+  return status;
 }
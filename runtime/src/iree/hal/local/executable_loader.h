@@ -95,6 +95,22 @@ static bool iree_hal_executable_import_is_optional(const char* symbol_name) {
 typedef struct iree_hal_executable_loader_vtable_t
     iree_hal_executable_loader_vtable_t;
 
+// Aggregate executable load statistics.
+typedef struct iree_hal_executable_loader_statistics_t {
+#if IREE_STATISTICS_ENABLE
+  // Total number of executables successfully loaded.
+  int64_t load_count;
+  // Total size in bytes of the executable data successfully loaded.
+  int64_t load_bytes;
+  // Total wall time spent in successful loads.
+  int64_t load_time_ns;
+  // Wall time of the slowest successful load.
+  int64_t load_time_max_ns;
+#else
+  int reserved;
+#endif  // IREE_STATISTICS_ENABLE
+} iree_hal_executable_loader_statistics_t;
+
 // Interface for compiled executable loader implementations.
 // A loader may be as simple as something that resolves function pointers in the
 // local executable for statically linked executables or as complex as a custom
@@ -108,6 +124,14 @@ typedef struct iree_hal_executable_loader_t {
   iree_atomic_ref_count_t ref_count;
   const iree_hal_executable_loader_vtable_t* vtable;
   iree_hal_executable_import_provider_t import_provider;
+#if IREE_STATISTICS_ENABLE
+  struct {
+    iree_atomic_int64_t load_count;
+    iree_atomic_int64_t load_bytes;
+    iree_atomic_int64_t load_time_ns;
+    iree_atomic_int64_t load_time_max_ns;
+  } statistics;
+#endif  // IREE_STATISTICS_ENABLE
 } iree_hal_executable_loader_t;
 
 // Initializes the base iree_hal_executable_loader_t type.
@@ -140,6 +164,25 @@ bool iree_hal_query_any_executable_loader_support(
     iree_hal_executable_caching_mode_t caching_mode,
     iree_string_view_t executable_format);
 
+// Queries the aggregate load statistics of |executable_loader| since creation.
+// Thread-safe; statistics are captured at the time the call is made.
+//
+// NOTE: statistics may be compiled out in some configurations and this call
+// will become a memset(0).
+void iree_hal_executable_loader_query_statistics(
+    iree_hal_executable_loader_t* executable_loader,
+    iree_hal_executable_loader_statistics_t* out_statistics);
+
+// Queries a single load statistic summed across all |loaders| by |key|.
+// Used by devices to service `hal.executable.statistics` queries with keys
+// `load_count`, `load_bytes`, `load_time_ns`, and `load_time_max_ns` (the
+// maximum across loaders).
+// Returns IREE_STATUS_NOT_FOUND if the key is unknown or statistics are
+// disabled.
+iree_status_t iree_hal_query_executable_loader_statistic(
+    iree_host_size_t loader_count, iree_hal_executable_loader_t** loaders,
+    iree_string_view_t key, int64_t* out_value);
+
 // Tries loading the executable data provided in the given format.
 // May fail even if the executable is valid if it requires features not
 // supported by the current host or runtime (such as available architectures,
@@ -0,0 +1,425 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/local/fork_join_pool.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/cpu.h"
+#include "iree/base/internal/fpu_state.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/tracing.h"
+
+//===----------------------------------------------------------------------===//
+// iree_hal_local_fork_join_pool_t
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_hal_local_fork_join_worker_t {
+  iree_hal_local_fork_join_pool_t* pool;
+  // Participant index of the worker; 0 is reserved for the calling thread.
+  uint32_t participant_index;
+  // Last epoch the worker executed. Only accessed by the worker thread.
+  int64_t executed_epoch;
+  iree_thread_t* thread;
+} iree_hal_local_fork_join_worker_t;
+
+struct iree_hal_local_fork_join_pool_t {
+  iree_atomic_ref_count_t ref_count;
+  iree_allocator_t host_allocator;
+  uint32_t min_fork_workgroup_count;
+
+  // Held by the thread that has forked a dispatch across the pool. Other
+  // threads issuing dispatches while the pool is busy run them inline.
+  iree_slim_mutex_t dispatch_mutex;
+
+  // Workgroup local memory for each participant with |local_memory_capacity|
+  // bytes per participant. Grown as needed under the |dispatch_mutex|.
+  iree_host_size_t local_memory_capacity;
+  uint8_t* local_memory_base;
+
+  // The dispatch currently being executed. Written by the forking thread prior
+  // to advancing the |epoch| and read-only until all workers have joined.
+  struct {
+    iree_hal_local_executable_t* executable;
+    iree_host_size_t ordinal;
+    const iree_hal_executable_dispatch_state_v0_t* dispatch_state;
+    uint64_t workgroup_count;
+    iree_host_size_t local_memory_size;
+  } job;
+
+  // Linearized index of the next workgroup to be claimed.
+  iree_atomic_int64_t next_workgroup;
+  // First failure of the current dispatch (as an iree_status_t) or 0.
+  iree_atomic_intptr_t job_status;
+  // Number of workers that have not yet finished the current dispatch.
+  iree_atomic_int32_t pending_worker_count;
+  // Number of worker threads that have not yet exited.
+  iree_atomic_int32_t live_worker_count;
+
+  // Incremented each time workers are woken for a new dispatch or exit.
+  iree_atomic_int64_t epoch;
+  iree_atomic_int32_t exit_requested;
+  // Posted when the |epoch| advances.
+  iree_notification_t work_notification;
+  // Posted when the |pending_worker_count| or |live_worker_count| reach 0.
+  iree_notification_t done_notification;
+
+  iree_host_size_t worker_count;
+  iree_hal_local_fork_join_worker_t workers[];
+};
+
+void iree_hal_local_fork_join_pool_params_initialize(
+    iree_hal_local_fork_join_pool_params_t* out_params) {
+  memset(out_params, 0, sizeof(*out_params));
+  out_params->name = iree_make_cstring_view("iree-inline");
+  out_params->min_fork_workgroup_count = 2;
+}
+
+// Executes workgroups of the current job until the grid is exhausted or a
+// workgroup fails.
+static void iree_hal_local_fork_join_pool_run_job(
+    iree_hal_local_fork_join_pool_t* pool, uint32_t participant_index,
+    uint32_t processor_id) {
+  const iree_hal_executable_dispatch_state_v0_t* dispatch_state =
+      pool->job.dispatch_state;
+  const uint64_t workgroup_count_x = dispatch_state->workgroup_count_x;
+  const uint64_t workgroup_count_y = dispatch_state->workgroup_count_y;
+  iree_alignas(64) iree_hal_executable_workgroup_state_v0_t workgroup_state = {
+      .workgroup_id_x = 0,
+      .workgroup_id_y = 0,
+      .workgroup_id_z = 0,
+      .processor_id = processor_id,
+      .local_memory = pool->job.local_memory_size
+                          ? pool->local_memory_base +
+                                participant_index * pool->local_memory_capacity
+                          : NULL,
+      .local_memory_size = (size_t)pool->job.local_memory_size,
+  };
+  while (iree_atomic_load_intptr(&pool->job_status,
+                                 iree_memory_order_relaxed) == 0) {
+    uint64_t workgroup_index = (uint64_t)iree_atomic_fetch_add_int64(
+        &pool->next_workgroup, 1, iree_memory_order_relaxed);
+    if (workgroup_index >= pool->job.workgroup_count) break;
+    workgroup_state.workgroup_id_x =
+        (uint32_t)(workgroup_index % workgroup_count_x);
+    uint64_t workgroup_index_yz = workgroup_index / workgroup_count_x;
+    workgroup_state.workgroup_id_y =
+        (uint32_t)(workgroup_index_yz % workgroup_count_y);
+    workgroup_state.workgroup_id_z =
+        (uint32_t)(workgroup_index_yz / workgroup_count_y);
+    iree_status_t status = iree_hal_local_executable_issue_call(
+        pool->job.executable, pool->job.ordinal, dispatch_state,
+        &workgroup_state, participant_index);
+    if (IREE_UNLIKELY(!iree_status_is_ok(status))) {
+      // Only the first failure is reported; others are dropped.
+      intptr_t expected = 0;
+      if (!iree_atomic_compare_exchange_strong_intptr(
+              &pool->job_status, &expected, (intptr_t)status,
+              iree_memory_order_acq_rel, iree_memory_order_relaxed)) {
+        iree_status_ignore(status);
+      }
+      break;
+    }
+  }
+}
+
+static bool iree_hal_local_fork_join_worker_has_work(void* arg) {
+  iree_hal_local_fork_join_worker_t* worker =
+      (iree_hal_local_fork_join_worker_t*)arg;
+  return iree_atomic_load_int64(&worker->pool->epoch,
+                                iree_memory_order_acquire) !=
+         worker->executed_epoch;
+}
+
+static int iree_hal_local_fork_join_worker_main(
+    iree_hal_local_fork_join_worker_t* worker) {
+  iree_hal_local_fork_join_pool_t* pool = worker->pool;
+
+  // Workers are dedicated to running dispatches so we set the floating point
+  // state once for their lifetime.
+  iree_fpu_state_t fpu_state =
+      iree_fpu_state_push(IREE_FPU_STATE_FLAG_FLUSH_DENORMALS_TO_ZERO);
+
+  iree_cpu_processor_tag_t processor_tag = 0;
+  iree_cpu_processor_id_t processor_id = 0;
+  for (;;) {
+    iree_notification_await(&pool->work_notification,
+                            iree_hal_local_fork_join_worker_has_work, worker,
+                            iree_infinite_timeout());
+    worker->executed_epoch =
+        iree_atomic_load_int64(&pool->epoch, iree_memory_order_acquire);
+    if (iree_atomic_load_int32(&pool->exit_requested,
+                               iree_memory_order_acquire)) {
+      break;
+    }
+
+    IREE_TRACE_ZONE_BEGIN_NAMED(z0, "iree_hal_local_fork_join_worker_run");
+    iree_cpu_requery_processor_id(&processor_tag, &processor_id);
+    iree_hal_local_fork_join_pool_run_job(pool, worker->participant_index,
+                                          processor_id);
+    IREE_TRACE_ZONE_END(z0);
+
+    if (iree_atomic_fetch_sub_int32(&pool->pending_worker_count, 1,
+                                    iree_memory_order_acq_rel) == 1) {
+      iree_notification_post(&pool->done_notification, IREE_ALL_WAITERS);
+    }
+  }
+
+  iree_fpu_state_pop(fpu_state);
+
+  // NOTE: the pool remains valid until the thread is joined.
+  if (iree_atomic_fetch_sub_int32(&pool->live_worker_count, 1,
+                                  iree_memory_order_acq_rel) == 1) {
+    iree_notification_post(&pool->done_notification, IREE_ALL_WAITERS);
+  }
+  return 0;
+}
+
+// Wakes all workers by advancing the epoch.
+static void iree_hal_local_fork_join_pool_wake_workers(
+    iree_hal_local_fork_join_pool_t* pool) {
+  iree_atomic_fetch_add_int64(&pool->epoch, 1, iree_memory_order_acq_rel);
+  iree_notification_post(&pool->work_notification, IREE_ALL_WAITERS);
+}
+
+static bool iree_hal_local_fork_join_pool_workers_exited(void* arg) {
+  iree_hal_local_fork_join_pool_t* pool = (iree_hal_local_fork_join_pool_t*)arg;
+  return iree_atomic_load_int32(&pool->live_worker_count,
+                                iree_memory_order_acquire) == 0;
+}
+
+static void iree_hal_local_fork_join_pool_destroy(
+    iree_hal_local_fork_join_pool_t* pool) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_allocator_t host_allocator = pool->host_allocator;
+
+  // Request exit and wait for all workers to have exited. Threads that have
+  // not yet started hold their own reference and releasing ours would not join
+  // them so we must wait for them to run to completion first. Workers that
+  // failed to be created have no thread and are skipped.
+  iree_atomic_store_int32(&pool->exit_requested, 1, iree_memory_order_release);
+  iree_hal_local_fork_join_pool_wake_workers(pool);
+  iree_notification_await(&pool->done_notification,
+                          iree_hal_local_fork_join_pool_workers_exited, pool,
+                          iree_infinite_timeout());
+  for (iree_host_size_t i = 0; i < pool->worker_count; ++i) {
+    iree_thread_release(pool->workers[i].thread);
+  }
+
+  iree_notification_deinitialize(&pool->done_notification);
+  iree_notification_deinitialize(&pool->work_notification);
+  iree_allocator_free(host_allocator, pool->local_memory_base);
+  iree_slim_mutex_deinitialize(&pool->dispatch_mutex);
+  iree_allocator_free(host_allocator, pool);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+iree_status_t iree_hal_local_fork_join_pool_create(
+    const iree_hal_local_fork_join_pool_params_t* params,
+    iree_allocator_t host_allocator,
+    iree_hal_local_fork_join_pool_t** out_pool) {
+  IREE_ASSERT_ARGUMENT(params);
+  IREE_ASSERT_ARGUMENT(out_pool);
+  *out_pool = NULL;
+  if (params->worker_count > IREE_HAL_LOCAL_FORK_JOIN_POOL_MAX_WORKER_COUNT) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "worker count %" PRIhsz " exceeds the maximum of %d",
+        params->worker_count, IREE_HAL_LOCAL_FORK_JOIN_POOL_MAX_WORKER_COUNT);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)params->worker_count);
+
+  iree_hal_local_fork_join_pool_t* pool = NULL;
+  iree_host_size_t total_size =
+      sizeof(*pool) + params->worker_count * sizeof(pool->workers[0]);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, total_size, (void**)&pool));
+  memset(pool, 0, total_size);
+  iree_atomic_ref_count_init(&pool->ref_count);
+  pool->host_allocator = host_allocator;
+  pool->min_fork_workgroup_count =
+      iree_max(1u, params->min_fork_workgroup_count);
+  iree_slim_mutex_initialize(&pool->dispatch_mutex);
+  iree_notification_initialize(&pool->work_notification);
+  iree_notification_initialize(&pool->done_notification);
+  pool->worker_count = params->worker_count;
+
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < pool->worker_count; ++i) {
+    iree_hal_local_fork_join_worker_t* worker = &pool->workers[i];
+    worker->pool = pool;
+    worker->participant_index = (uint32_t)(i + 1);
+
+    char name[16];
+    int name_length = snprintf(name, IREE_ARRAYSIZE(name), "%.*s-%d",
+                               (int)iree_min(params->name.size, 10),
+                               params->name.data, (int)i);
+    iree_thread_create_params_t thread_params;
+    memset(&thread_params, 0, sizeof(thread_params));
+    thread_params.name = iree_make_string_view(name, name_length);
+    thread_params.priority_class = IREE_THREAD_PRIORITY_CLASS_NORMAL;
+    thread_params.stack_size = params->worker_stack_size;
+    if (params->worker_affinities) {
+      thread_params.initial_affinity = params->worker_affinities[i];
+    }
+    iree_atomic_fetch_add_int32(&pool->live_worker_count, 1,
+                                iree_memory_order_relaxed);
+    status = iree_thread_create(
+        (iree_thread_entry_t)iree_hal_local_fork_join_worker_main, worker,
+        thread_params, host_allocator, &worker->thread);
+    if (!iree_status_is_ok(status)) {
+      iree_atomic_fetch_sub_int32(&pool->live_worker_count, 1,
+                                  iree_memory_order_relaxed);
+      break;
+    }
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_pool = pool;
+  } else {
+    iree_hal_local_fork_join_pool_destroy(pool);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+void iree_hal_local_fork_join_pool_retain(
+    iree_hal_local_fork_join_pool_t* pool) {
+  if (IREE_LIKELY(pool)) {
+    iree_atomic_ref_count_inc(&pool->ref_count);
+  }
+}
+
+void iree_hal_local_fork_join_pool_release(
+    iree_hal_local_fork_join_pool_t* pool) {
+  if (IREE_LIKELY(pool) && iree_atomic_ref_count_dec(&pool->ref_count) == 1) {
+    iree_hal_local_fork_join_pool_destroy(pool);
+  }
+}
+
+iree_host_size_t iree_hal_local_fork_join_pool_concurrency(
+    iree_hal_local_fork_join_pool_t* pool) {
+  return pool->worker_count + 1;
+}
+
+// Executes the dispatch on the calling thread only. Used when the pool is busy
+// or the dispatch is too small to be worth forking.
+static iree_status_t iree_hal_local_fork_join_pool_issue_dispatch_inline(
+    iree_hal_local_fork_join_pool_t* pool,
+    iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
+    const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
+    uint32_t processor_id, iree_host_size_t local_memory_size) {
+  iree_byte_span_t local_memory = iree_make_byte_span(NULL, local_memory_size);
+  if (local_memory_size > 0) {
+    IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+        pool->host_allocator, local_memory_size, (void**)&local_memory.data));
+  }
+  iree_fpu_state_t fpu_state =
+      iree_fpu_state_push(IREE_FPU_STATE_FLAG_FLUSH_DENORMALS_TO_ZERO);
+  iree_status_t status = iree_hal_local_executable_issue_dispatch_inline(
+      executable, ordinal, dispatch_state, processor_id, local_memory);
+  iree_fpu_state_pop(fpu_state);
+  iree_allocator_free(pool->host_allocator, local_memory.data);
+  return status;
+}
+
+// Ensures each participant has at least |local_memory_size| bytes of local
+// memory. Must be called with the |dispatch_mutex| held.
+static iree_status_t iree_hal_local_fork_join_pool_reserve_local_memory(
+    iree_hal_local_fork_join_pool_t* pool, iree_host_size_t local_memory_size) {
+  if (local_memory_size <= pool->local_memory_capacity) {
+    return iree_ok_status();
+  }
+  iree_host_size_t participant_count = pool->worker_count + 1;
+  local_memory_size = iree_host_align(local_memory_size, iree_max_align_t);
+  iree_allocator_free(pool->host_allocator, pool->local_memory_base);
+  pool->local_memory_base = NULL;
+  pool->local_memory_capacity = 0;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      pool->host_allocator, participant_count * local_memory_size,
+      (void**)&pool->local_memory_base));
+  pool->local_memory_capacity = local_memory_size;
+  return iree_ok_status();
+}
+
+static bool iree_hal_local_fork_join_pool_workers_done(void* arg) {
+  iree_hal_local_fork_join_pool_t* pool = (iree_hal_local_fork_join_pool_t*)arg;
+  return iree_atomic_load_int32(&pool->pending_worker_count,
+                                iree_memory_order_acquire) == 0;
+}
+
+iree_status_t iree_hal_local_fork_join_pool_issue_dispatch(
+    iree_hal_local_fork_join_pool_t* pool,
+    iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
+    const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
+    uint32_t processor_id, iree_host_size_t local_memory_size) {
+  IREE_ASSERT_ARGUMENT(pool);
+  IREE_ASSERT_ARGUMENT(executable);
+  IREE_ASSERT_ARGUMENT(dispatch_state);
+  const uint64_t workgroup_count = (uint64_t)dispatch_state->workgroup_count_x *
+                                   (uint64_t)dispatch_state->workgroup_count_y *
+                                   (uint64_t)dispatch_state->workgroup_count_z;
+  if (workgroup_count == 0) return iree_ok_status();
+
+  // Small dispatches and dispatches issued while another thread owns the pool
+  // run entirely on the calling thread.
+  if (pool->worker_count == 0 ||
+      workgroup_count < pool->min_fork_workgroup_count ||
+      !iree_slim_mutex_try_lock(&pool->dispatch_mutex)) {
+    return iree_hal_local_fork_join_pool_issue_dispatch_inline(
+        pool, executable, ordinal, dispatch_state, processor_id,
+        local_memory_size);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)workgroup_count);
+
+  iree_status_t status =
+      iree_hal_local_fork_join_pool_reserve_local_memory(pool,
+                                                         local_memory_size);
+  if (!iree_status_is_ok(status)) {
+    iree_slim_mutex_unlock(&pool->dispatch_mutex);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  // Publish the job and fork.
+  pool->job.executable = executable;
+  pool->job.ordinal = ordinal;
+  pool->job.dispatch_state = dispatch_state;
+  pool->job.workgroup_count = workgroup_count;
+  pool->job.local_memory_size = local_memory_size;
+  iree_atomic_store_int64(&pool->next_workgroup, 0, iree_memory_order_relaxed);
+  iree_atomic_store_intptr(&pool->job_status, 0, iree_memory_order_relaxed);
+  iree_atomic_store_int32(&pool->pending_worker_count,
+                          (int32_t)pool->worker_count,
+                          iree_memory_order_relaxed);
+  iree_hal_local_fork_join_pool_wake_workers(pool);
+
+  // Participate in the dispatch from the calling thread. Since we are running
+  // on a borrowed thread we know nothing about the floating point state.
+  iree_fpu_state_t fpu_state =
+      iree_fpu_state_push(IREE_FPU_STATE_FLAG_FLUSH_DENORMALS_TO_ZERO);
+  iree_hal_local_fork_join_pool_run_job(pool, /*participant_index=*/0,
+                                        processor_id);
+  iree_fpu_state_pop(fpu_state);
+
+  // Join. Workers that woke late will find the grid exhausted and return
+  // immediately.
+  iree_notification_await(&pool->done_notification,
+                          iree_hal_local_fork_join_pool_workers_done, pool,
+                          iree_infinite_timeout());
+  status = (iree_status_t)iree_atomic_exchange_intptr(
+      &pool->job_status, 0, iree_memory_order_acquire);
+  memset(&pool->job, 0, sizeof(pool->job));
+
+  iree_slim_mutex_unlock(&pool->dispatch_mutex);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
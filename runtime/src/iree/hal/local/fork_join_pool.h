@@ -0,0 +1,111 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_LOCAL_FORK_JOIN_POOL_H_
+#define IREE_HAL_LOCAL_FORK_JOIN_POOL_H_
+
+#include "iree/base/api.h"
+#include "iree/base/internal/threading.h"
+#include "iree/hal/api.h"
+#include "iree/hal/local/executable_library.h"
+#include "iree/hal/local/local_executable.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Maximum number of worker threads a fork-join pool may have.
+#define IREE_HAL_LOCAL_FORK_JOIN_POOL_MAX_WORKER_COUNT 64
+
+// Parameters configuring an iree_hal_local_fork_join_pool_t.
+// Must be initialized with iree_hal_local_fork_join_pool_params_initialize
+// prior to use.
+typedef struct iree_hal_local_fork_join_pool_params_t {
+  // Developer-visible name prefix for the worker threads.
+  iree_string_view_t name;
+
+  // Number of worker threads in addition to the calling thread. A dispatch
+  // issued through the pool runs on up to worker_count + 1 threads. 0 is valid
+  // and results in all dispatches running on the calling thread.
+  iree_host_size_t worker_count;
+
+  // Optional per-worker affinities with worker_count entries. When omitted the
+  // workers float and the OS places them as it sees fit.
+  const iree_thread_affinity_t* worker_affinities;
+
+  // Minimum number of workgroups in a dispatch required to wake the workers.
+  // Smaller dispatches run entirely on the calling thread as the cost of the
+  // fork-join exceeds the work.
+  uint32_t min_fork_workgroup_count;
+
+  // Worker stack size in bytes. 0 uses the platform default.
+  iree_host_size_t worker_stack_size;
+} iree_hal_local_fork_join_pool_params_t;
+
+// Initializes |out_params| to default values.
+void iree_hal_local_fork_join_pool_params_initialize(
+    iree_hal_local_fork_join_pool_params_t* out_params);
+
+// A lightweight pool of threads that cooperatively execute the workgroups of a
+// single dispatch alongside the thread issuing it. This is intended for the
+// inline/synchronous execution paths (inline command buffers and the
+// hal_loader module) where the full iree/task system is too heavy: no task
+// graph is built and nothing is allocated per dispatch.
+//
+// Dispatches are distributed by having all participating threads (the caller
+// and each worker) claim workgroups from a shared atomic counter until the
+// grid is exhausted. The caller returns once all workgroups have completed.
+//
+// Only one dispatch executes on the pool at a time. If another thread issues a
+// dispatch while the pool is busy it is executed entirely on that thread
+// instead of blocking.
+//
+// Thread-safe.
+typedef struct iree_hal_local_fork_join_pool_t iree_hal_local_fork_join_pool_t;
+
+// Creates a fork-join pool and spins up its worker threads.
+iree_status_t iree_hal_local_fork_join_pool_create(
+    const iree_hal_local_fork_join_pool_params_t* params,
+    iree_allocator_t host_allocator,
+    iree_hal_local_fork_join_pool_t** out_pool);
+
+// Retains the given |pool| for the caller.
+void iree_hal_local_fork_join_pool_retain(
+    iree_hal_local_fork_join_pool_t* pool);
+
+// Releases the given |pool| from the caller. The worker threads are joined
+// when the last reference is released.
+void iree_hal_local_fork_join_pool_release(
+    iree_hal_local_fork_join_pool_t* pool);
+
+// Returns the maximum number of threads that may concurrently execute
+// workgroups of a single dispatch (workers + the calling thread).
+iree_host_size_t iree_hal_local_fork_join_pool_concurrency(
+    iree_hal_local_fork_join_pool_t* pool);
+
+// Executes all workgroups of the dispatch |ordinal| of |executable| using the
+// calling thread and the pool workers and returns once all have completed.
+// If the pool is busy with another dispatch or the dispatch has fewer than
+// min_fork_workgroup_count workgroups it runs on the calling thread only.
+//
+// |local_memory_size| bytes of workgroup local memory is provided to each
+// participating thread from storage owned by the pool.
+//
+// |dispatch_state| must remain valid until the call returns and its
+// max_concurrency should be set to
+// iree_hal_local_fork_join_pool_concurrency so that executables do not assume
+// more (or less) parallelism than is available.
+iree_status_t iree_hal_local_fork_join_pool_issue_dispatch(
+    iree_hal_local_fork_join_pool_t* pool,
+    iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
+    const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
+    uint32_t processor_id, iree_host_size_t local_memory_size);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_LOCAL_FORK_JOIN_POOL_H_
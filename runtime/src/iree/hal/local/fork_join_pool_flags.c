@@ -0,0 +1,68 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/local/fork_join_pool_flags.h"
+
+#include <string.h>
+
+#include "iree/base/internal/flags.h"
+#include "iree/base/tracing.h"
+
+IREE_FLAG(
+    int32_t, inline_worker_count, 0,
+    "Number of worker threads used in addition to the calling thread to\n"
+    "execute dispatch workgroups in inline execution modes (the local-sync\n"
+    "HAL device and the hal_loader module). 0 runs all workgroups on the\n"
+    "calling thread.");
+
+IREE_FLAG(
+    bool, inline_worker_pinning, false,
+    "Pins inline workers to processors 1 to N, leaving processor 0 for the\n"
+    "calling thread. When false the workers float and the OS places them.");
+
+IREE_FLAG(
+    int32_t, inline_worker_min_fork_workgroups, 2,
+    "Minimum number of workgroups in a dispatch required to wake the inline\n"
+    "workers. Smaller dispatches run on the calling thread.");
+
+iree_status_t iree_hal_local_fork_join_pool_create_from_flags(
+    iree_allocator_t host_allocator,
+    iree_hal_local_fork_join_pool_t** out_pool) {
+  IREE_ASSERT_ARGUMENT(out_pool);
+  *out_pool = NULL;
+  if (FLAG_inline_worker_count <= 0) return iree_ok_status();
+  if (FLAG_inline_worker_count >
+      IREE_HAL_LOCAL_FORK_JOIN_POOL_MAX_WORKER_COUNT) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "--inline_worker_count=%d exceeds the maximum "
+                            "of %d",
+                            FLAG_inline_worker_count,
+                            IREE_HAL_LOCAL_FORK_JOIN_POOL_MAX_WORKER_COUNT);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_local_fork_join_pool_params_t params;
+  iree_hal_local_fork_join_pool_params_initialize(&params);
+  params.worker_count = (iree_host_size_t)FLAG_inline_worker_count;
+  params.min_fork_workgroup_count =
+      (uint32_t)iree_max(1, FLAG_inline_worker_min_fork_workgroups);
+
+  iree_thread_affinity_t
+      worker_affinities[IREE_HAL_LOCAL_FORK_JOIN_POOL_MAX_WORKER_COUNT];
+  if (FLAG_inline_worker_pinning) {
+    memset(worker_affinities, 0, sizeof(worker_affinities));
+    for (iree_host_size_t i = 0; i < params.worker_count; ++i) {
+      worker_affinities[i].specified = 1;
+      worker_affinities[i].id = (uint32_t)(i + 1);
+    }
+    params.worker_affinities = worker_affinities;
+  }
+
+  iree_status_t status =
+      iree_hal_local_fork_join_pool_create(&params, host_allocator, out_pool);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
@@ -0,0 +1,29 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_LOCAL_FORK_JOIN_POOL_FLAGS_H_
+#define IREE_HAL_LOCAL_FORK_JOIN_POOL_FLAGS_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/local/fork_join_pool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Creates a fork-join pool for inline execution as configured by the
+// --inline_worker_count= and --inline_worker_pinning= flags.
+// |out_pool| is set to NULL if no workers were requested and all inline
+// dispatches should run on the calling thread.
+iree_status_t iree_hal_local_fork_join_pool_create_from_flags(
+    iree_allocator_t host_allocator,
+    iree_hal_local_fork_join_pool_t** out_pool);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_LOCAL_FORK_JOIN_POOL_FLAGS_H_
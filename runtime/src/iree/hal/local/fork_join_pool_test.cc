@@ -0,0 +1,192 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/local/fork_join_pool.h"
+
+#include <cstring>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+using iree::Status;
+using iree::StatusCode;
+using iree::testing::status::StatusIs;
+
+// Executable that records which workgroups ran and on which participants.
+struct TestExecutable {
+  iree_hal_local_executable_t base;
+  std::vector<iree_atomic_int32_t> workgroup_hits;
+  iree_atomic_int32_t worker_mask;
+  // Linearized workgroup index that fails or -1 to never fail.
+  int64_t failing_workgroup = -1;
+  // Set if any workgroup saw local memory shared with another participant.
+  iree_atomic_int32_t local_memory_clobbered;
+};
+
+static iree_status_t TestExecutableIssueCall(
+    iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
+    const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
+    const iree_hal_executable_workgroup_state_v0_t* workgroup_state,
+    uint32_t worker_id) {
+  auto* test_executable = reinterpret_cast<TestExecutable*>(executable);
+  int64_t workgroup_index =
+      ((int64_t)workgroup_state->workgroup_id_z *
+           dispatch_state->workgroup_count_y +
+       workgroup_state->workgroup_id_y) *
+          dispatch_state->workgroup_count_x +
+      workgroup_state->workgroup_id_x;
+  iree_atomic_fetch_add_int32(
+      &test_executable->workgroup_hits[workgroup_index], 1,
+      iree_memory_order_relaxed);
+  iree_atomic_fetch_or_int32(&test_executable->worker_mask, 1 << worker_id,
+                             iree_memory_order_relaxed);
+
+  // Stamp the local memory with our worker ID and make sure nobody else wrote
+  // to it while we were running.
+  if (workgroup_state->local_memory_size > 0) {
+    auto* local_memory = (volatile uint32_t*)workgroup_state->local_memory;
+    size_t count = workgroup_state->local_memory_size / sizeof(uint32_t);
+    for (size_t i = 0; i < count; ++i) local_memory[i] = worker_id;
+    for (size_t i = 0; i < count; ++i) {
+      if (local_memory[i] != worker_id) {
+        iree_atomic_store_int32(&test_executable->local_memory_clobbered, 1,
+                                iree_memory_order_relaxed);
+      }
+    }
+  }
+
+  if (workgroup_index == test_executable->failing_workgroup) {
+    return iree_make_status(IREE_STATUS_DATA_LOSS, "workgroup failed");
+  }
+  return iree_ok_status();
+}
+
+static const iree_hal_local_executable_vtable_t test_executable_vtable = {
+    /*.base=*/{/*.destroy=*/NULL},
+    /*.issue_call=*/TestExecutableIssueCall,
+};
+
+class ForkJoinPoolTest : public ::testing::Test {
+ protected:
+  void CreatePool(iree_host_size_t worker_count,
+                  uint32_t min_fork_workgroup_count = 1) {
+    iree_hal_local_fork_join_pool_params_t params;
+    iree_hal_local_fork_join_pool_params_initialize(&params);
+    params.worker_count = worker_count;
+    params.min_fork_workgroup_count = min_fork_workgroup_count;
+    IREE_ASSERT_OK(iree_hal_local_fork_join_pool_create(
+        &params, iree_allocator_system(), &pool_));
+  }
+
+  void TearDown() override { iree_hal_local_fork_join_pool_release(pool_); }
+
+  iree_status_t Dispatch(TestExecutable* executable, uint32_t x, uint32_t y,
+                         uint32_t z, iree_host_size_t local_memory_size = 0) {
+    memset(&executable->base, 0, sizeof(executable->base));
+    iree_hal_resource_initialize(&test_executable_vtable,
+                                 &executable->base.resource);
+    executable->workgroup_hits =
+        std::vector<iree_atomic_int32_t>((size_t)x * y * z);
+    for (auto& hits : executable->workgroup_hits) {
+      iree_atomic_store_int32(&hits, 0, iree_memory_order_relaxed);
+    }
+    iree_atomic_store_int32(&executable->worker_mask, 0,
+                            iree_memory_order_relaxed);
+    iree_atomic_store_int32(&executable->local_memory_clobbered, 0,
+                            iree_memory_order_relaxed);
+    iree_hal_executable_dispatch_state_v0_t dispatch_state;
+    memset(&dispatch_state, 0, sizeof(dispatch_state));
+    dispatch_state.workgroup_size_x = 1;
+    dispatch_state.workgroup_size_y = 1;
+    dispatch_state.workgroup_size_z = 1;
+    dispatch_state.workgroup_count_x = x;
+    dispatch_state.workgroup_count_y = y;
+    dispatch_state.workgroup_count_z = z;
+    dispatch_state.max_concurrency =
+        (uint32_t)iree_hal_local_fork_join_pool_concurrency(pool_);
+    return iree_hal_local_fork_join_pool_issue_dispatch(
+        pool_, &executable->base, /*ordinal=*/0, &dispatch_state,
+        /*processor_id=*/0, local_memory_size);
+  }
+
+  static void ExpectAllWorkgroupsRanOnce(TestExecutable* executable) {
+    for (size_t i = 0; i < executable->workgroup_hits.size(); ++i) {
+      EXPECT_EQ(1, iree_atomic_load_int32(&executable->workgroup_hits[i],
+                                          iree_memory_order_relaxed))
+          << "workgroup " << i;
+    }
+  }
+
+  iree_hal_local_fork_join_pool_t* pool_ = NULL;
+};
+
+TEST_F(ForkJoinPoolTest, NoWorkers) {
+  CreatePool(/*worker_count=*/0);
+  EXPECT_EQ(1, iree_hal_local_fork_join_pool_concurrency(pool_));
+  TestExecutable executable;
+  IREE_ASSERT_OK(Dispatch(&executable, 4, 3, 2));
+  ExpectAllWorkgroupsRanOnce(&executable);
+  EXPECT_EQ(1, iree_atomic_load_int32(&executable.worker_mask,
+                                      iree_memory_order_relaxed));
+}
+
+TEST_F(ForkJoinPoolTest, EmptyGrid) {
+  CreatePool(/*worker_count=*/2);
+  TestExecutable executable;
+  IREE_ASSERT_OK(Dispatch(&executable, 4, 0, 2));
+}
+
+TEST_F(ForkJoinPoolTest, AllWorkgroupsRunOnce) {
+  CreatePool(/*worker_count=*/3);
+  EXPECT_EQ(4, iree_hal_local_fork_join_pool_concurrency(pool_));
+  // Repeat to exercise waking the workers for multiple dispatches.
+  for (int i = 0; i < 16; ++i) {
+    TestExecutable executable;
+    IREE_ASSERT_OK(Dispatch(&executable, 17, 5, 3));
+    ExpectAllWorkgroupsRanOnce(&executable);
+    EXPECT_EQ(0, iree_atomic_load_int32(&executable.worker_mask,
+                                        iree_memory_order_relaxed) &
+                     ~0xF);
+  }
+}
+
+TEST_F(ForkJoinPoolTest, SmallDispatchRunsInline) {
+  CreatePool(/*worker_count=*/3, /*min_fork_workgroup_count=*/8);
+  TestExecutable executable;
+  IREE_ASSERT_OK(Dispatch(&executable, 7, 1, 1));
+  ExpectAllWorkgroupsRanOnce(&executable);
+  EXPECT_EQ(1, iree_atomic_load_int32(&executable.worker_mask,
+                                      iree_memory_order_relaxed));
+}
+
+TEST_F(ForkJoinPoolTest, LocalMemoryPerParticipant) {
+  CreatePool(/*worker_count=*/3);
+  TestExecutable executable;
+  IREE_ASSERT_OK(Dispatch(&executable, 64, 4, 1, /*local_memory_size=*/4096));
+  ExpectAllWorkgroupsRanOnce(&executable);
+  EXPECT_EQ(0, iree_atomic_load_int32(&executable.local_memory_clobbered,
+                                      iree_memory_order_relaxed));
+}
+
+TEST_F(ForkJoinPoolTest, FailurePropagates) {
+  CreatePool(/*worker_count=*/3);
+  TestExecutable executable;
+  executable.failing_workgroup = 37;
+  EXPECT_THAT(Status(Dispatch(&executable, 64, 2, 1)),
+              StatusIs(StatusCode::kDataLoss));
+
+  // The pool must be reusable after a failure.
+  TestExecutable next_executable;
+  IREE_ASSERT_OK(Dispatch(&next_executable, 64, 2, 1));
+  ExpectAllWorkgroupsRanOnce(&next_executable);
+}
+
+}  // namespace
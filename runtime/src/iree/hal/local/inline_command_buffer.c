@@ -28,6 +28,9 @@ typedef struct iree_hal_inline_command_buffer_t {
   iree_hal_command_buffer_t base;
   iree_allocator_t host_allocator;
 
+  // Optional pool used to execute dispatch workgroups across multiple threads.
+  iree_hal_local_fork_join_pool_t* fork_join_pool;
+
   struct {
     // A flattened list of all available descriptor set bindings.
     // As descriptor sets are pushed/bound the bindings will be updated to
@@ -94,6 +97,7 @@ iree_status_t iree_hal_inline_command_buffer_initialize(
     iree_hal_device_t* device, iree_hal_command_buffer_mode_t mode,
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
+    iree_hal_local_fork_join_pool_t* fork_join_pool,
     iree_allocator_t host_allocator, iree_byte_span_t storage,
     iree_hal_command_buffer_t** out_command_buffer) {
   IREE_ASSERT_ARGUMENT(out_command_buffer);
@@ -131,6 +135,8 @@ iree_status_t iree_hal_inline_command_buffer_initialize(
       device, mode, command_categories, queue_affinity, binding_capacity,
       &iree_hal_inline_command_buffer_vtable, &command_buffer->base);
   command_buffer->host_allocator = host_allocator;
+  command_buffer->fork_join_pool = fork_join_pool;
+  iree_hal_local_fork_join_pool_retain(fork_join_pool);
   iree_hal_inline_command_buffer_reset(command_buffer);
 
   *out_command_buffer = &command_buffer->base;
@@ -144,12 +150,15 @@ void iree_hal_inline_command_buffer_deinitialize(
   iree_hal_inline_command_buffer_t* command_buffer =
       iree_hal_inline_command_buffer_cast(base_command_buffer);
   iree_hal_inline_command_buffer_reset(command_buffer);
+  iree_hal_local_fork_join_pool_release(command_buffer->fork_join_pool);
+  command_buffer->fork_join_pool = NULL;
 }
 
 iree_status_t iree_hal_inline_command_buffer_create(
     iree_hal_device_t* device, iree_hal_command_buffer_mode_t mode,
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
+    iree_hal_local_fork_join_pool_t* fork_join_pool,
     iree_allocator_t host_allocator,
     iree_hal_command_buffer_t** out_command_buffer) {
   IREE_ASSERT_ARGUMENT(out_command_buffer);
@@ -163,7 +172,7 @@ iree_status_t iree_hal_inline_command_buffer_create(
   if (iree_status_is_ok(status)) {
     status = iree_hal_inline_command_buffer_initialize(
         device, mode, command_categories, queue_affinity, binding_capacity,
-        host_allocator,
+        fork_join_pool, host_allocator,
         iree_make_byte_span(storage, iree_hal_inline_command_buffer_size()),
         &command_buffer);
   }
@@ -443,8 +452,10 @@ static iree_status_t iree_hal_inline_command_buffer_dispatch(
   iree_hal_inline_command_buffer_t* command_buffer =
       iree_hal_inline_command_buffer_cast(base_command_buffer);
 
-  iree_hal_local_executable_t* local_executable =
-      iree_hal_local_executable_cast(executable);
+  // Executables that are still loading complete here on their first use.
+  iree_hal_local_executable_t* local_executable = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_local_executable_resolve(
+      iree_hal_local_executable_cast(executable), &local_executable));
   if (IREE_UNLIKELY(!local_executable->pipeline_layouts)) {
     return iree_make_status(
         IREE_STATUS_FAILED_PRECONDITION,
@@ -478,8 +489,12 @@ static iree_status_t iree_hal_inline_command_buffer_dispatch(
   dispatch_state->workgroup_count_y = workgroup_y;
   dispatch_state->workgroup_count_z = workgroup_z;
 
-  // Single-threaded.
-  dispatch_state->max_concurrency = 1;
+  // Single-threaded unless we have a pool to fork across.
+  dispatch_state->max_concurrency =
+      command_buffer->fork_join_pool
+          ? (uint32_t)iree_hal_local_fork_join_pool_concurrency(
+                command_buffer->fork_join_pool)
+          : 1;
 
   // Push constants are pulled directly from the command buffer state, but we
   // only allow the dispatch to read what we know is initialized based on the
@@ -515,6 +530,14 @@ static iree_status_t iree_hal_inline_command_buffer_dispatch(
         command_buffer->state.full_binding_lengths[binding_ordinal];
   }
 
+  // The pool owns per-thread local memory and handles the floating point state
+  // of each participating thread.
+  if (command_buffer->fork_join_pool) {
+    return iree_hal_local_fork_join_pool_issue_dispatch(
+        command_buffer->fork_join_pool, local_executable, entry_point,
+        dispatch_state, command_buffer->state.processor_id, local_memory_size);
+  }
+
   // TODO(benvanik): plumb through an arena or fixed-size reservation to use.
   // For now when deploying to devices where you want something like the
   // inline command buffer you probably don't want 256KB of transient memory
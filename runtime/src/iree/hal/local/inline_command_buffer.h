@@ -9,6 +9,7 @@
 
 #include "iree/base/api.h"
 #include "iree/hal/api.h"
+#include "iree/hal/local/fork_join_pool.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -31,6 +32,7 @@ iree_status_t iree_hal_inline_command_buffer_initialize(
     iree_hal_device_t* device, iree_hal_command_buffer_mode_t mode,
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
+    iree_hal_local_fork_join_pool_t* fork_join_pool,
     iree_allocator_t host_allocator, iree_byte_span_t storage,
     iree_hal_command_buffer_t** out_command_buffer);
 
@@ -45,13 +47,17 @@ void iree_hal_inline_command_buffer_deinitialize(
 // can begin execution immediately. No inter-command-buffer scheduling will be
 // performed and all barriers and events are ignored.
 //
-// Executes all work on the calling thread synchronously (today).
+// Executes all work synchronously before each command returns. When a
+// |fork_join_pool| is provided the workgroups of each dispatch are distributed
+// across the calling thread and the pool workers; otherwise all work executes
+// on the calling thread.
 //
 // Must have IREE_HAL_COMMAND_BUFFER_MODE_ALLOW_INLINE_EXECUTION set.
 iree_status_t iree_hal_inline_command_buffer_create(
     iree_hal_device_t* device, iree_hal_command_buffer_mode_t mode,
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
+    iree_hal_local_fork_join_pool_t* fork_join_pool,
     iree_allocator_t host_allocator,
     iree_hal_command_buffer_t** out_command_buffer);
 
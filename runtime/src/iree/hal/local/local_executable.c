@@ -47,6 +47,21 @@ iree_hal_local_executable_t* iree_hal_local_executable_cast(
   return (iree_hal_local_executable_t*)base_value;
 }
 
+iree_status_t iree_hal_local_executable_resolve(
+    iree_hal_local_executable_t* executable,
+    iree_hal_local_executable_t** out_executable) {
+  IREE_ASSERT_ARGUMENT(executable);
+  IREE_ASSERT_ARGUMENT(out_executable);
+  const iree_hal_local_executable_vtable_t* vtable =
+      (const iree_hal_local_executable_vtable_t*)executable->resource.vtable;
+  if (IREE_LIKELY(!vtable->resolve)) {
+    *out_executable = executable;
+    return iree_ok_status();
+  }
+  *out_executable = NULL;
+  return vtable->resolve(executable, out_executable);
+}
+
 iree_status_t iree_hal_local_executable_issue_call(
     iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
     const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
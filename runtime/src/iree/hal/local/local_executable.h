@@ -47,6 +47,13 @@ typedef struct iree_hal_local_executable_vtable_t {
       const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
       const iree_hal_executable_workgroup_state_v0_t* workgroup_state,
       uint32_t worker_id);
+
+  // Optional; executables that are always ready for dispatch leave this NULL.
+  // Blocks until the executable has finished loading and returns the
+  // executable to issue calls against in |out_executable|.
+  iree_status_t(IREE_API_PTR* resolve)(
+      iree_hal_local_executable_t* executable,
+      iree_hal_local_executable_t** out_executable);
 } iree_hal_local_executable_vtable_t;
 
 // Initializes the local executable base type.
@@ -67,6 +74,17 @@ void iree_hal_local_executable_deinitialize(
 iree_hal_local_executable_t* iree_hal_local_executable_cast(
     iree_hal_executable_t* base_value);
 
+// Resolves |executable| for dispatch by waiting for any pending load to
+// complete. |out_executable| receives the executable that should be used to
+// issue calls and read dispatch attributes from; it is kept live by
+// |executable| and may be |executable| itself.
+//
+// Executables prepared asynchronously by the local executable cache finish
+// loading (and surface any load failure) here on their first dispatch.
+iree_status_t iree_hal_local_executable_resolve(
+    iree_hal_local_executable_t* executable,
+    iree_hal_local_executable_t** out_executable);
+
 iree_status_t iree_hal_local_executable_issue_call(
     iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
     const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
@@ -8,14 +8,20 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <string.h>
 
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/base/tracing.h"
+#include "iree/hal/local/local_executable.h"
 
 typedef struct iree_hal_local_executable_cache_t {
   iree_hal_resource_t resource;
   iree_allocator_t host_allocator;
   iree_string_view_t identifier;
   iree_host_size_t worker_capacity;
+  // Loop executables are loaded on or NULL if loaded synchronously.
+  iree_loop_t load_loop;
   iree_host_size_t loader_count;
   iree_hal_executable_loader_t* loaders[];
 } iree_hal_local_executable_cache_t;
@@ -32,7 +38,7 @@ static iree_hal_local_executable_cache_t* iree_hal_local_executable_cache_cast(
 iree_status_t iree_hal_local_executable_cache_create(
     iree_string_view_t identifier, iree_host_size_t worker_capacity,
     iree_host_size_t loader_count, iree_hal_executable_loader_t** loaders,
-    iree_allocator_t host_allocator,
+    iree_loop_t load_loop, iree_allocator_t host_allocator,
     iree_hal_executable_cache_t** out_executable_cache) {
   IREE_ASSERT_ARGUMENT(!loader_count || loaders);
   IREE_ASSERT_ARGUMENT(out_executable_cache);
@@ -54,6 +60,7 @@ iree_status_t iree_hal_local_executable_cache_create(
         identifier, &executable_cache->identifier,
         (char*)executable_cache + total_size - identifier.size);
     executable_cache->worker_capacity = worker_capacity;
+    executable_cache->load_loop = load_loop;
 
     executable_cache->loader_count = loader_count;
     for (iree_host_size_t i = 0; i < executable_cache->loader_count; ++i) {
@@ -98,12 +105,11 @@ static bool iree_hal_local_executable_cache_can_prepare_format(
   return false;
 }
 
-static iree_status_t iree_hal_local_executable_cache_prepare_executable(
-    iree_hal_executable_cache_t* base_executable_cache,
+// Loads the executable with the first loader that supports it.
+static iree_status_t iree_hal_local_executable_cache_load_executable(
+    iree_hal_local_executable_cache_t* executable_cache,
     const iree_hal_executable_params_t* executable_params,
     iree_hal_executable_t** out_executable) {
-  iree_hal_local_executable_cache_t* executable_cache =
-      iree_hal_local_executable_cache_cast(base_executable_cache);
   for (iree_host_size_t i = 0; i < executable_cache->loader_count; ++i) {
     if (!iree_hal_executable_loader_query_support(
             executable_cache->loaders[i], executable_params->caching_mode,
@@ -133,6 +139,279 @@ static iree_status_t iree_hal_local_executable_cache_prepare_executable(
       executable_params->executable_format.data);
 }
 
+//===----------------------------------------------------------------------===//
+// iree_hal_local_deferred_executable_t
+//===----------------------------------------------------------------------===//
+
+// An executable whose loading has been scheduled on the cache load loop.
+// Preparing an executable only captures its parameters and returns so that the
+// (potentially expensive) ELF loading, relocation, and import resolution of
+// many executables can proceed concurrently with each other and the program
+// creating them. The first dispatch of the executable waits for the load to
+// complete and then uses the loaded executable directly.
+typedef struct iree_hal_local_deferred_executable_t {
+  iree_hal_local_executable_t base;
+
+  // Cache performing the load; retained until loading completes so that the
+  // loaders remain live.
+  iree_hal_local_executable_cache_t* executable_cache;
+
+  // Executable parameters referencing storage owned by this executable.
+  iree_hal_executable_params_t params;
+
+  // Set to 1 with release semantics once |load_status| and |loaded_executable|
+  // are available and |notification| is posted.
+  iree_atomic_int32_t is_loaded;
+  iree_notification_t notification;
+  iree_status_t load_status;
+  iree_hal_local_executable_t* loaded_executable;
+
+  iree_hal_pipeline_layout_t* layouts[];
+} iree_hal_local_deferred_executable_t;
+
+static const iree_hal_local_executable_vtable_t
+    iree_hal_local_deferred_executable_vtable;
+
+static bool iree_hal_local_deferred_executable_is_loaded(void* arg) {
+  iree_hal_local_deferred_executable_t* executable =
+      (iree_hal_local_deferred_executable_t*)arg;
+  return iree_atomic_load_int32(&executable->is_loaded,
+                                iree_memory_order_acquire) == 1;
+}
+
+static iree_status_t iree_hal_local_deferred_executable_create(
+    iree_hal_local_executable_cache_t* executable_cache,
+    const iree_hal_executable_params_t* executable_params,
+    iree_hal_local_deferred_executable_t** out_executable) {
+  *out_executable = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // The executable data is only guaranteed live for the duration of the
+  // prepare call unless the caller has indicated we may alias it.
+  const bool alias_data = iree_all_bits_set(
+      executable_params->caching_mode,
+      IREE_HAL_EXECUTABLE_CACHING_MODE_ALIAS_PROVIDED_DATA);
+  const iree_host_size_t layouts_size =
+      executable_params->pipeline_layout_count *
+      sizeof(*executable_params->pipeline_layouts);
+  const iree_host_size_t constants_size =
+      executable_params->constant_count * sizeof(*executable_params->constants);
+  const iree_host_size_t data_size =
+      alias_data ? 0 : executable_params->executable_data.data_length;
+  iree_hal_local_deferred_executable_t* executable = NULL;
+  const iree_host_size_t total_size =
+      sizeof(*executable) + layouts_size + constants_size +
+      executable_params->executable_format.size + data_size;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(executable_cache->host_allocator, total_size,
+                                (void**)&executable));
+  iree_hal_local_executable_initialize(
+      &iree_hal_local_deferred_executable_vtable,
+      executable_params->pipeline_layout_count,
+      executable_params->pipeline_layouts, executable->layouts,
+      executable_cache->host_allocator, &executable->base);
+  executable->executable_cache = executable_cache;
+  iree_hal_executable_cache_retain(
+      (iree_hal_executable_cache_t*)executable_cache);
+  iree_atomic_store_int32(&executable->is_loaded, 0, iree_memory_order_relaxed);
+  iree_notification_initialize(&executable->notification);
+  executable->load_status = iree_ok_status();
+
+  // Copy everything the loaders need into our trailing storage. The copied
+  // executable data is owned by us and outlives the loaded executable so the
+  // loaders may always alias it.
+  uint8_t* storage_ptr = (uint8_t*)executable + sizeof(*executable) +
+                         layouts_size;
+  iree_hal_executable_params_t* params = &executable->params;
+  *params = *executable_params;
+  params->caching_mode |= IREE_HAL_EXECUTABLE_CACHING_MODE_ALIAS_PROVIDED_DATA;
+  params->pipeline_layouts = executable->layouts;
+  if (constants_size > 0) {
+    memcpy(storage_ptr, executable_params->constants, constants_size);
+    params->constants = (const uint32_t*)storage_ptr;
+    storage_ptr += constants_size;
+  }
+  iree_string_view_append_to_buffer(executable_params->executable_format,
+                                    &params->executable_format,
+                                    (char*)storage_ptr);
+  storage_ptr += executable_params->executable_format.size;
+  if (data_size > 0) {
+    memcpy(storage_ptr, executable_params->executable_data.data, data_size);
+    params->executable_data = iree_make_const_byte_span(storage_ptr, data_size);
+  }
+
+  *out_executable = executable;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+static void iree_hal_local_deferred_executable_destroy(
+    iree_hal_executable_t* base_executable) {
+  iree_hal_local_deferred_executable_t* executable =
+      (iree_hal_local_deferred_executable_t*)base_executable;
+  iree_allocator_t host_allocator = executable->base.host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // A scheduled load holds a reference so we only get here once it has
+  // completed or if it was never scheduled.
+  iree_hal_executable_release(
+      (iree_hal_executable_t*)executable->loaded_executable);
+  iree_hal_executable_cache_release(
+      (iree_hal_executable_cache_t*)executable->executable_cache);
+  iree_status_ignore(executable->load_status);
+  iree_notification_deinitialize(&executable->notification);
+  iree_hal_local_executable_deinitialize(&executable->base);
+  iree_allocator_free(host_allocator, executable);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Loads the executable from the cache load loop.
+static iree_status_t iree_hal_local_deferred_executable_load(
+    void* user_data, iree_loop_t loop, iree_status_t status) {
+  iree_hal_local_deferred_executable_t* executable =
+      (iree_hal_local_deferred_executable_t*)user_data;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // The loop may fail the call (such as when shutting down) in which case we
+  // record that as the load failure.
+  iree_hal_executable_t* loaded_executable = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_local_executable_cache_load_executable(
+        executable->executable_cache, &executable->params, &loaded_executable);
+  }
+  executable->load_status = status;
+  if (iree_status_is_ok(status)) {
+    executable->loaded_executable =
+        iree_hal_local_executable_cast(loaded_executable);
+    executable->base.dispatch_attrs =
+        executable->loaded_executable->dispatch_attrs;
+  }
+
+  // Drop the cache (and with it the loaders) before publishing: once loaded
+  // the executable has no need for it.
+  iree_hal_local_executable_cache_t* executable_cache =
+      executable->executable_cache;
+  executable->executable_cache = NULL;
+  iree_atomic_store_int32(&executable->is_loaded, 1,
+                          iree_memory_order_release);
+  iree_notification_post(&executable->notification, IREE_ALL_WAITERS);
+  iree_hal_executable_cache_release(
+      (iree_hal_executable_cache_t*)executable_cache);
+
+  // Drop the reference held by the pending load.
+  iree_hal_executable_release((iree_hal_executable_t*)executable);
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_local_deferred_executable_resolve(
+    iree_hal_local_executable_t* base_executable,
+    iree_hal_local_executable_t** out_executable) {
+  iree_hal_local_deferred_executable_t* executable =
+      (iree_hal_local_deferred_executable_t*)base_executable;
+  if (IREE_UNLIKELY(!iree_hal_local_deferred_executable_is_loaded(
+          executable))) {
+    IREE_TRACE_ZONE_BEGIN_NAMED(z0, "iree_hal_local_deferred_executable_wait");
+    iree_notification_await(&executable->notification,
+                            iree_hal_local_deferred_executable_is_loaded,
+                            executable, iree_infinite_timeout());
+    IREE_TRACE_ZONE_END(z0);
+  }
+  if (IREE_UNLIKELY(!iree_status_is_ok(executable->load_status))) {
+    return iree_status_clone(executable->load_status);
+  }
+  *out_executable = executable->loaded_executable;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_local_deferred_executable_issue_call(
+    iree_hal_local_executable_t* base_executable, iree_host_size_t ordinal,
+    const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
+    const iree_hal_executable_workgroup_state_v0_t* workgroup_state,
+    uint32_t worker_id) {
+  // Callers should resolve once and issue calls against the loaded executable;
+  // this path is only taken by those that don't.
+  iree_hal_local_executable_t* loaded_executable = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_local_deferred_executable_resolve(
+      base_executable, &loaded_executable));
+  return iree_hal_local_executable_issue_call(loaded_executable, ordinal,
+                                              dispatch_state, workgroup_state,
+                                              worker_id);
+}
+
+static const iree_hal_local_executable_vtable_t
+    iree_hal_local_deferred_executable_vtable = {
+        .base =
+            {
+                .destroy = iree_hal_local_deferred_executable_destroy,
+            },
+        .issue_call = iree_hal_local_deferred_executable_issue_call,
+        .resolve = iree_hal_local_deferred_executable_resolve,
+};
+
+//===----------------------------------------------------------------------===//
+// iree_hal_local_executable_cache_t
+//===----------------------------------------------------------------------===//
+
+static iree_status_t iree_hal_local_executable_cache_prepare_executable(
+    iree_hal_executable_cache_t* base_executable_cache,
+    const iree_hal_executable_params_t* executable_params,
+    iree_hal_executable_t** out_executable) {
+  iree_hal_local_executable_cache_t* executable_cache =
+      iree_hal_local_executable_cache_cast(base_executable_cache);
+  if (!executable_cache->load_loop.ctl) {
+    return iree_hal_local_executable_cache_load_executable(
+        executable_cache, executable_params, out_executable);
+  }
+
+  // Fail early on formats no loader can handle so that only failures specific
+  // to the executable contents are deferred to its first use.
+  if (!iree_hal_query_any_executable_loader_support(
+          executable_cache->loader_count, executable_cache->loaders,
+          executable_params->caching_mode,
+          executable_params->executable_format)) {
+    return iree_make_status(
+        IREE_STATUS_NOT_FOUND,
+        "no executable loader registered for the given executable format "
+        "'%.*s'",
+        (int)executable_params->executable_format.size,
+        executable_params->executable_format.data);
+  }
+
+  iree_hal_local_deferred_executable_t* executable = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_local_deferred_executable_create(
+      executable_cache, executable_params, &executable));
+
+  // The pending load holds a reference that it releases upon completion.
+  iree_hal_executable_retain((iree_hal_executable_t*)executable);
+  iree_status_t status = iree_loop_call(
+      executable_cache->load_loop, IREE_LOOP_PRIORITY_DEFAULT,
+      iree_hal_local_deferred_executable_load, executable);
+  if (!iree_status_is_ok(status)) {
+    // Not scheduled; the load callback will never run.
+    iree_hal_executable_release((iree_hal_executable_t*)executable);
+    iree_hal_executable_release((iree_hal_executable_t*)executable);
+    return status;
+  }
+
+  // Loops that run calls immediately have already loaded the executable and
+  // we can hand it out directly without the indirection.
+  if (iree_hal_local_deferred_executable_is_loaded(executable)) {
+    status = iree_status_clone(executable->load_status);
+    if (iree_status_is_ok(status)) {
+      *out_executable = (iree_hal_executable_t*)executable->loaded_executable;
+      iree_hal_executable_retain(*out_executable);
+    }
+    iree_hal_executable_release((iree_hal_executable_t*)executable);
+    return status;
+  }
+
+  *out_executable = (iree_hal_executable_t*)executable;
+  return iree_ok_status();
+}
+
 static const iree_hal_executable_cache_vtable_t
     iree_hal_local_executable_cache_vtable = {
         .destroy = iree_hal_local_executable_cache_destroy,
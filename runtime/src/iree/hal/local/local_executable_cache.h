@@ -23,10 +23,19 @@ extern "C" {
 // one device is the same JIT'ed executable in another, and in multi-tenant
 // situations we're likely to want that isolation _and_ sharing.
 
+// Creates an executable cache that loads executables with |loaders|.
+//
+// If |load_loop| is provided executables are loaded asynchronously by calls
+// issued on the loop: preparation only captures the executable parameters and
+// the load (and any failure it produces) completes on the first dispatch of
+// the executable. Loops that can run calls concurrently allow many executables
+// to load in parallel. |load_loop| must remain valid for the lifetime of the
+// cache and all executables prepared from it. With iree_loop_null executables
+// are loaded synchronously during preparation.
 iree_status_t iree_hal_local_executable_cache_create(
     iree_string_view_t identifier, iree_host_size_t worker_capacity,
     iree_host_size_t loader_count, iree_hal_executable_loader_t** loaders,
-    iree_allocator_t host_allocator,
+    iree_loop_t load_loop, iree_allocator_t host_allocator,
     iree_hal_executable_cache_t** out_executable_cache);
 
 #ifdef __cplusplus
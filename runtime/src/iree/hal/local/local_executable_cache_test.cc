@@ -0,0 +1,269 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/local/local_executable_cache.h"
+
+#include <cstring>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/local/executable_loader.h"
+#include "iree/hal/local/local_executable.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+using iree::Status;
+using iree::StatusCode;
+using iree::testing::status::StatusIs;
+
+static const iree_hal_executable_dispatch_attrs_v0_t kTestDispatchAttrs[1] = {
+    {/*.local_memory_pages=*/1},
+};
+
+//===----------------------------------------------------------------------===//
+// Test executable/loader
+//===----------------------------------------------------------------------===//
+
+// Loads executables of the "test" format. Executable data starting with 'X'
+// fails to load.
+struct TestLoader {
+  iree_hal_executable_loader_t base;
+  int load_count = 0;
+};
+
+static void TestExecutableDestroy(iree_hal_executable_t* base_executable) {
+  auto* executable = (iree_hal_local_executable_t*)base_executable;
+  iree_hal_local_executable_deinitialize(executable);
+  iree_allocator_free(executable->host_allocator, executable);
+}
+
+static iree_status_t TestExecutableIssueCall(
+    iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
+    const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
+    const iree_hal_executable_workgroup_state_v0_t* workgroup_state,
+    uint32_t worker_id) {
+  return iree_ok_status();
+}
+
+static const iree_hal_local_executable_vtable_t test_executable_vtable = {
+    /*.base=*/{/*.destroy=*/TestExecutableDestroy},
+    /*.issue_call=*/TestExecutableIssueCall,
+};
+
+static void TestLoaderDestroy(iree_hal_executable_loader_t* loader) {}
+
+static bool TestLoaderQuerySupport(
+    iree_hal_executable_loader_t* loader,
+    iree_hal_executable_caching_mode_t caching_mode,
+    iree_string_view_t executable_format) {
+  return iree_string_view_equal(executable_format, IREE_SV("test"));
+}
+
+static iree_status_t TestLoaderTryLoad(
+    iree_hal_executable_loader_t* base_loader,
+    const iree_hal_executable_params_t* executable_params,
+    iree_host_size_t worker_capacity, iree_hal_executable_t** out_executable) {
+  auto* loader = reinterpret_cast<TestLoader*>(base_loader);
+  ++loader->load_count;
+  if (executable_params->executable_data.data_length > 0 &&
+      executable_params->executable_data.data[0] == 'X') {
+    return iree_make_status(IREE_STATUS_DATA_LOSS, "corrupt executable");
+  }
+  iree_hal_local_executable_t* executable = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      iree_allocator_system(), sizeof(*executable), (void**)&executable));
+  iree_hal_local_executable_initialize(
+      &test_executable_vtable, /*pipeline_layout_count=*/0,
+      /*source_pipeline_layouts=*/NULL, /*target_pipeline_layouts=*/NULL,
+      iree_allocator_system(), executable);
+  executable->dispatch_attrs = kTestDispatchAttrs;
+  *out_executable = (iree_hal_executable_t*)executable;
+  return iree_ok_status();
+}
+
+static const iree_hal_executable_loader_vtable_t test_loader_vtable = {
+    /*.destroy=*/TestLoaderDestroy,
+    /*.query_support=*/TestLoaderQuerySupport,
+    /*.try_load=*/TestLoaderTryLoad,
+};
+
+//===----------------------------------------------------------------------===//
+// Test loop
+//===----------------------------------------------------------------------===//
+
+// Loop that queues calls until RunPending is called.
+struct DeferredLoop {
+  std::vector<iree_loop_callback_t> pending_calls;
+
+  iree_loop_t loop() {
+    iree_loop_t loop = {this, Ctl};
+    return loop;
+  }
+
+  void RunPending() {
+    std::vector<iree_loop_callback_t> calls;
+    calls.swap(pending_calls);
+    for (auto& call : calls) {
+      IREE_EXPECT_OK(call.fn(call.user_data, loop(), iree_ok_status()));
+    }
+  }
+
+  static iree_status_t Ctl(void* self, iree_loop_command_t command,
+                           const void* params, void** inout_ptr) {
+    if (command != IREE_LOOP_COMMAND_CALL) {
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED);
+    }
+    reinterpret_cast<DeferredLoop*>(self)->pending_calls.push_back(
+        reinterpret_cast<const iree_loop_call_params_t*>(params)->callback);
+    return iree_ok_status();
+  }
+};
+
+class LocalExecutableCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    iree_hal_executable_loader_initialize(
+        &test_loader_vtable, iree_hal_executable_import_provider_null(),
+        &loader_.base);
+  }
+
+  void TearDown() override {
+    iree_hal_executable_cache_release(executable_cache_);
+  }
+
+  void CreateCache(iree_loop_t load_loop) {
+    iree_hal_executable_loader_t* loaders[1] = {&loader_.base};
+    IREE_ASSERT_OK(iree_hal_local_executable_cache_create(
+        IREE_SV("test"), /*worker_capacity=*/1, IREE_ARRAYSIZE(loaders),
+        loaders, load_loop, iree_allocator_system(), &executable_cache_));
+  }
+
+  iree_status_t Prepare(const char* format, const char* data,
+                        iree_hal_executable_t** out_executable) {
+    iree_hal_executable_params_t params;
+    iree_hal_executable_params_initialize(&params);
+    params.executable_format = iree_make_cstring_view(format);
+    params.executable_data =
+        iree_make_const_byte_span(data, data ? strlen(data) : 0);
+    return iree_hal_executable_cache_prepare_executable(
+        executable_cache_, &params, out_executable);
+  }
+
+  TestLoader loader_;
+  iree_hal_executable_cache_t* executable_cache_ = NULL;
+};
+
+TEST_F(LocalExecutableCacheTest, SynchronousLoad) {
+  CreateCache(iree_loop_null());
+  iree_hal_executable_t* executable = NULL;
+  IREE_ASSERT_OK(Prepare("test", "data", &executable));
+  EXPECT_EQ(1, loader_.load_count);
+
+  iree_hal_local_executable_t* local_executable =
+      iree_hal_local_executable_cast(executable);
+  iree_hal_local_executable_t* resolved_executable = NULL;
+  IREE_ASSERT_OK(iree_hal_local_executable_resolve(local_executable,
+                                                   &resolved_executable));
+  EXPECT_EQ(local_executable, resolved_executable);
+  iree_hal_executable_release(executable);
+
+  iree_hal_executable_loader_statistics_t statistics;
+  iree_hal_executable_loader_query_statistics(&loader_.base, &statistics);
+  IREE_STATISTICS(EXPECT_EQ(1, statistics.load_count));
+  IREE_STATISTICS(EXPECT_EQ(4, statistics.load_bytes));
+}
+
+TEST_F(LocalExecutableCacheTest, UnsupportedFormat) {
+  CreateCache(iree_loop_null());
+  iree_hal_executable_t* executable = NULL;
+  EXPECT_THAT(Status(Prepare("other", "data", &executable)),
+              StatusIs(StatusCode::kNotFound));
+  EXPECT_EQ(nullptr, executable);
+}
+
+TEST_F(LocalExecutableCacheTest, DeferredLoad) {
+  DeferredLoop loop;
+  CreateCache(loop.loop());
+
+  // The executable data is only valid during preparation.
+  std::vector<char> data = {'d', 'a', 't', 'a', 0};
+  iree_hal_executable_t* executable = NULL;
+  IREE_ASSERT_OK(Prepare("test", data.data(), &executable));
+  data.clear();
+  EXPECT_EQ(0, loader_.load_count);
+  ASSERT_EQ(1u, loop.pending_calls.size());
+
+  // The cache must keep the loaders alive until the load completes.
+  iree_hal_executable_cache_release(executable_cache_);
+  executable_cache_ = NULL;
+  loop.RunPending();
+  EXPECT_EQ(1, loader_.load_count);
+
+  iree_hal_local_executable_t* local_executable =
+      iree_hal_local_executable_cast(executable);
+  iree_hal_local_executable_t* resolved_executable = NULL;
+  IREE_ASSERT_OK(iree_hal_local_executable_resolve(local_executable,
+                                                   &resolved_executable));
+  ASSERT_NE(nullptr, resolved_executable);
+  EXPECT_NE(local_executable, resolved_executable);
+  EXPECT_EQ(kTestDispatchAttrs, resolved_executable->dispatch_attrs);
+  EXPECT_EQ(kTestDispatchAttrs, local_executable->dispatch_attrs);
+  iree_hal_executable_release(executable);
+}
+
+TEST_F(LocalExecutableCacheTest, DeferredLoadFailure) {
+  DeferredLoop loop;
+  CreateCache(loop.loop());
+  iree_hal_executable_t* executable = NULL;
+  IREE_ASSERT_OK(Prepare("test", "XXXX", &executable));
+  loop.RunPending();
+
+  // The failure is reported on each use of the executable.
+  iree_hal_local_executable_t* resolved_executable = NULL;
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_THAT(Status(iree_hal_local_executable_resolve(
+                    iree_hal_local_executable_cast(executable),
+                    &resolved_executable)),
+                StatusIs(StatusCode::kDataLoss));
+  }
+  iree_hal_executable_release(executable);
+}
+
+TEST_F(LocalExecutableCacheTest, DeferredUnsupportedFormat) {
+  DeferredLoop loop;
+  CreateCache(loop.loop());
+  iree_hal_executable_t* executable = NULL;
+  EXPECT_THAT(Status(Prepare("other", "data", &executable)),
+              StatusIs(StatusCode::kNotFound));
+  EXPECT_TRUE(loop.pending_calls.empty());
+}
+
+TEST_F(LocalExecutableCacheTest, InlineLoopLoadsImmediately) {
+  iree_status_t loop_status = iree_ok_status();
+  CreateCache(iree_loop_inline(&loop_status));
+  iree_hal_executable_t* executable = NULL;
+  IREE_ASSERT_OK(Prepare("test", "data", &executable));
+  EXPECT_EQ(1, loader_.load_count);
+
+  // Calls that complete during preparation hand out the loaded executable.
+  iree_hal_local_executable_t* local_executable =
+      iree_hal_local_executable_cast(executable);
+  iree_hal_local_executable_t* resolved_executable = NULL;
+  IREE_ASSERT_OK(iree_hal_local_executable_resolve(local_executable,
+                                                   &resolved_executable));
+  EXPECT_EQ(local_executable, resolved_executable);
+  iree_hal_executable_release(executable);
+
+  // Failures are reported from preparation.
+  EXPECT_THAT(Status(Prepare("test", "XXXX", &executable)),
+              StatusIs(StatusCode::kDataLoss));
+  IREE_EXPECT_OK(loop_status);
+}
+
+}  // namespace
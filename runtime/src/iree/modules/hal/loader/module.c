@@ -22,6 +22,8 @@
 typedef struct iree_hal_loader_module_t {
   iree_allocator_t host_allocator;
   iree_hal_loader_module_flags_t flags;
+  // Optional pool used to execute dispatches across multiple threads.
+  iree_hal_local_fork_join_pool_t* fork_join_pool;
   // TODO(benvanik): types.
   iree_host_size_t loader_count;
   iree_hal_executable_loader_t* loaders[];
@@ -41,6 +43,7 @@ static void IREE_API_PTR iree_hal_loader_module_destroy(void* base_module) {
   for (iree_host_size_t i = 0; i < module->loader_count; ++i) {
     iree_hal_executable_loader_release(module->loaders[i]);
   }
+  iree_hal_local_fork_join_pool_release(module->fork_join_pool);
 }
 
 static iree_status_t IREE_API_PTR
@@ -270,6 +273,10 @@ static iree_status_t iree_hal_loader_module_executable_dispatch(
     binding_lengths[i] = span.data_length;
   }
 
+  iree_hal_loader_module_t* loader_module = IREE_HAL_LOADER_MODULE_CAST(module);
+  iree_hal_local_fork_join_pool_t* fork_join_pool =
+      loader_module->fork_join_pool;
+
   const iree_hal_executable_dispatch_state_v0_t dispatch_state = {
       .workgroup_size_x = 1,
       .workgroup_size_y = 1,
@@ -278,7 +285,11 @@ static iree_status_t iree_hal_loader_module_executable_dispatch(
       .workgroup_count_x = args->workgroup_x,
       .workgroup_count_y = args->workgroup_y,
       .workgroup_count_z = args->workgroup_z,
-      .max_concurrency = 1,
+      .max_concurrency =
+          fork_join_pool
+              ? (uint32_t)iree_hal_local_fork_join_pool_concurrency(
+                    fork_join_pool)
+              : 1,
       .binding_count = args->binding_count,
       .push_constants = args->push_constants,
       .binding_ptrs = binding_ptrs,
@@ -287,11 +298,25 @@ static iree_status_t iree_hal_loader_module_executable_dispatch(
 
   // TODO(benvanik): environmental information.
   uint32_t processor_id = 0;
-  iree_byte_span_t local_memory = iree_byte_span_empty();
 
+  iree_hal_local_executable_t* local_executable =
+      (iree_hal_local_executable_t*)executable;
+  if (fork_join_pool) {
+    iree_host_size_t local_memory_size =
+        local_executable->dispatch_attrs
+            ? local_executable->dispatch_attrs[args->entry_point]
+                      .local_memory_pages *
+                  IREE_HAL_WORKGROUP_LOCAL_MEMORY_PAGE_SIZE
+            : 0;
+    return iree_hal_local_fork_join_pool_issue_dispatch(
+        fork_join_pool, local_executable, args->entry_point, &dispatch_state,
+        processor_id, local_memory_size);
+  }
+
+  iree_byte_span_t local_memory = iree_byte_span_empty();
   return iree_hal_local_executable_issue_dispatch_inline(
-      (iree_hal_local_executable_t*)executable, args->entry_point,
-      &dispatch_state, processor_id, local_memory);
+      local_executable, args->entry_point, &dispatch_state, processor_id,
+      local_memory);
 }
 
 static iree_status_t iree_vm_shim_dispatch_v(
@@ -392,6 +417,7 @@ static const iree_vm_native_module_descriptor_t
 IREE_API_EXPORT iree_status_t iree_hal_loader_module_create(
     iree_vm_instance_t* instance, iree_hal_loader_module_flags_t flags,
     iree_host_size_t loader_count, iree_hal_executable_loader_t** loaders,
+    iree_hal_local_fork_join_pool_t* fork_join_pool,
     iree_allocator_t host_allocator, iree_vm_module_t** out_module) {
   IREE_ASSERT_ARGUMENT(instance);
   IREE_ASSERT_ARGUMENT(out_module);
@@ -425,6 +451,8 @@ IREE_API_EXPORT iree_status_t iree_hal_loader_module_create(
   iree_hal_loader_module_t* module = IREE_HAL_LOADER_MODULE_CAST(base_module);
   module->host_allocator = host_allocator;
   module->flags = flags;
+  module->fork_join_pool = fork_join_pool;
+  iree_hal_local_fork_join_pool_retain(fork_join_pool);
   module->loader_count = loader_count;
   for (iree_host_size_t i = 0; i < loader_count; ++i) {
     module->loaders[i] = loaders[i];
@@ -12,6 +12,7 @@
 #include "iree/base/api.h"
 #include "iree/hal/api.h"
 #include "iree/hal/local/executable_loader.h"
+#include "iree/hal/local/fork_join_pool.h"
 #include "iree/modules/hal/types.h"
 #include "iree/vm/api.h"
 
@@ -25,9 +26,13 @@ enum iree_hal_loader_module_flag_bits_t {
 typedef uint32_t iree_hal_loader_module_flags_t;
 
 // Creates the dynamic HAL executable loader module for local execution.
+// When |fork_join_pool| is provided the workgroups of each dispatch are
+// distributed across the calling thread and the pool workers; otherwise all
+// workgroups run on the calling thread.
 IREE_API_EXPORT iree_status_t iree_hal_loader_module_create(
     iree_vm_instance_t* instance, iree_hal_loader_module_flags_t flags,
     iree_host_size_t loader_count, iree_hal_executable_loader_t** loaders,
+    iree_hal_local_fork_join_pool_t* fork_join_pool,
     iree_allocator_t host_allocator, iree_vm_module_t** out_module);
 
 #ifdef __cplusplus
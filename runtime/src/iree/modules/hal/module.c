@@ -15,6 +15,7 @@
 #include "iree/base/tracing.h"
 #include "iree/hal/api.h"
 #include "iree/modules/hal/utils/buffer_diagnostics.h"
+#include "iree/modules/hal/utils/resource_cache.h"
 #include "iree/vm/api.h"
 
 #define IREE_HAL_MODULE_VERSION_0_0 0x00000000u
@@ -40,6 +41,9 @@ typedef struct iree_hal_module_t {
   iree_allocator_t host_allocator;
   iree_hal_module_flags_t flags;
   iree_hal_device_t* shared_device;
+  // Process-wide cache of immutable resources created on shared_device or NULL
+  // if IREE_HAL_MODULE_FLAG_DISABLE_RESOURCE_SHARING was specified.
+  iree_hal_resource_cache_t* resource_cache;
   // TODO(benvanik): types.
 } iree_hal_module_t;
 
@@ -69,10 +73,18 @@ typedef struct iree_hal_module_state_t {
   // executables like ones for training vs inference in the same model, or just
   // always use this.
   iree_hal_executable_cache_t* executable_cache;
+
+  // Resource cache shared with other HAL modules using the same device or NULL
+  // if sharing is disabled. Unowned; the module outlives its states.
+  iree_hal_resource_cache_t* resource_cache;
+  // Cache entries used by this context. Rodata referenced by keys is owned by
+  // modules in the context and stays live until this state is freed.
+  iree_hal_resource_cache_pins_t resource_pins;
 } iree_hal_module_state_t;
 
 static void IREE_API_PTR iree_hal_module_destroy(void* base_module) {
   iree_hal_module_t* module = IREE_HAL_MODULE_CAST(base_module);
+  iree_hal_resource_cache_release(module->resource_cache);
   iree_hal_device_release(module->shared_device);
 }
 
@@ -91,6 +103,7 @@ iree_hal_module_alloc_state(void* self, iree_allocator_t host_allocator,
   state->flags = module->flags;
   state->shared_device = module->shared_device;
   iree_hal_device_retain(state->shared_device);
+  state->resource_cache = module->resource_cache;
 
   state->loop_status = iree_ok_status();
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
@@ -110,6 +123,11 @@ iree_hal_module_free_state(void* self, iree_vm_module_state_t* module_state) {
   iree_hal_module_state_t* state = (iree_hal_module_state_t*)module_state;
   iree_hal_executable_cache_release(state->executable_cache);
   iree_status_ignore(state->loop_status);
+
+  // Drop shared resources that were only in use by this context. The modules
+  // owning the rodata their keys reference are released after this.
+  iree_hal_resource_cache_unpin(state->resource_cache, &state->resource_pins);
+
   iree_hal_device_release(state->shared_device);
   iree_allocator_free(state->host_allocator, state);
 
@@ -122,12 +140,54 @@ static iree_status_t IREE_API_PTR iree_hal_module_notify(
   switch (signal) {
     case IREE_VM_SIGNAL_SUSPEND:
     case IREE_VM_SIGNAL_LOW_MEMORY:
+      iree_hal_resource_cache_trim(state->resource_cache);
       return iree_hal_device_trim(state->shared_device);
     default:
       return iree_ok_status();
   }
 }
 
+// Shares |*inout_resource| with all other HAL modules using the device under
+// |key|. If an equivalent resource was shared first it is returned in place of
+// the one provided. On failure the resource is released.
+static iree_status_t iree_hal_module_state_share_resource(
+    iree_hal_module_state_t* state, const iree_hal_resource_cache_key_t* key,
+    iree_hal_resource_t** inout_resource) {
+  iree_hal_resource_t* shared_resource = NULL;
+  iree_status_t status =
+      iree_hal_resource_cache_insert(state->resource_cache, key,
+                                     *inout_resource, &state->resource_pins,
+                                     &shared_resource);
+  iree_hal_resource_release(*inout_resource);
+  *inout_resource = shared_resource;
+  return status;
+}
+
+// Appends the origin of |length| bytes at |offset| in the module rodata
+// |buffer| to |key|. Rodata is identified by the digest of the module it is
+// stored in and its offset within it so that the key matches the same data in
+// any loaded copy of the module without the data having to be read. The buffer
+// must have an origin digest.
+static void iree_hal_module_key_append_rodata(
+    iree_hal_resource_cache_key_t* key, const iree_vm_buffer_t* buffer,
+    iree_host_size_t offset, iree_host_size_t length) {
+  iree_hal_resource_cache_key_append(key, buffer->origin_digest,
+                                     sizeof(*buffer->origin_digest));
+  iree_host_size_t origin_offset = buffer->origin_offset + offset;
+  iree_hal_resource_cache_key_append(key, &origin_offset,
+                                     sizeof(origin_offset));
+  iree_hal_resource_cache_key_append(key, &length, sizeof(length));
+}
+
+// Returns the resource shared under |key| by any HAL module using the device or
+// NULL if it has not been created yet.
+static iree_status_t iree_hal_module_state_lookup_resource(
+    iree_hal_module_state_t* state, const iree_hal_resource_cache_key_t* key,
+    iree_hal_resource_t** out_resource) {
+  return iree_hal_resource_cache_lookup(state->resource_cache, key,
+                                        &state->resource_pins, out_resource);
+}
+
 //===----------------------------------------------------------------------===//
 // Experimental APIs
 //===----------------------------------------------------------------------===//
@@ -208,17 +268,46 @@ IREE_VM_ABI_EXPORT(iree_hal_module_allocator_allocate_initialized,  //
                             offset, (offset + length - 1), buffer_length);
   }
 
-  const iree_hal_buffer_params_t params = {
-      .type = memory_types,
-      .usage = buffer_usage,
-  };
+  // Immutable buffers initialized from module rodata are constants and can be
+  // shared with other contexts using the same module contents. The buffer
+  // contents are copied from the rodata and keyed by the module digest.
+  iree_const_byte_span_t initial_data =
+      iree_make_const_byte_span(source->data.data + offset, length);
+  bool is_shareable =
+      state->resource_cache &&
+      iree_all_bits_set(buffer_usage,
+                        IREE_HAL_BUFFER_USAGE_SHARING_IMMUTABLE) &&
+      source->origin_digest != NULL;
+  iree_hal_resource_cache_key_t key;
   iree_hal_buffer_t* buffer = NULL;
-  IREE_RETURN_IF_ERROR(
-      iree_hal_allocator_allocate_buffer(
-          allocator, params, length,
-          iree_make_const_byte_span(source->data.data + offset, length),
-          &buffer),
-      "failed to allocate buffer of length %" PRIdsz, length);
+  if (is_shareable) {
+    iree_hal_resource_cache_key_initialize(IREE_HAL_RESOURCE_CACHE_TYPE_BUFFER,
+                                           &key);
+    iree_hal_resource_cache_key_append(&key, &allocator, sizeof(allocator));
+    iree_hal_resource_cache_key_append(&key, &memory_types,
+                                       sizeof(memory_types));
+    iree_hal_resource_cache_key_append(&key, &buffer_usage,
+                                       sizeof(buffer_usage));
+    iree_hal_module_key_append_rodata(&key, source, (iree_host_size_t)offset,
+                                      (iree_host_size_t)length);
+    IREE_RETURN_IF_ERROR(iree_hal_module_state_lookup_resource(
+        state, &key, (iree_hal_resource_t**)&buffer));
+  }
+
+  if (!buffer) {
+    const iree_hal_buffer_params_t params = {
+        .type = memory_types,
+        .usage = buffer_usage,
+    };
+    IREE_RETURN_IF_ERROR(
+        iree_hal_allocator_allocate_buffer(allocator, params, length,
+                                           initial_data, &buffer),
+        "failed to allocate buffer of length %" PRIdsz, length);
+    if (is_shareable) {
+      IREE_RETURN_IF_ERROR(iree_hal_module_state_share_resource(
+          state, &key, (iree_hal_resource_t**)&buffer));
+    }
+  }
 
   rets->r0 = iree_hal_buffer_move_ref(buffer);
   return iree_ok_status();
@@ -894,9 +983,28 @@ IREE_VM_ABI_EXPORT(iree_hal_module_descriptor_set_layout_create,  //
     bindings[i].flags = (iree_hal_descriptor_flags_t)args->a2[i].i2;
   }
 
+  iree_hal_resource_cache_key_t key;
   iree_hal_descriptor_set_layout_t* descriptor_set_layout = NULL;
-  IREE_RETURN_IF_ERROR(iree_hal_descriptor_set_layout_create(
-      device, flags, binding_count, bindings, &descriptor_set_layout));
+  if (state->resource_cache) {
+    iree_hal_resource_cache_key_initialize(
+        IREE_HAL_RESOURCE_CACHE_TYPE_DESCRIPTOR_SET_LAYOUT, &key);
+    iree_hal_resource_cache_key_append(&key, &device, sizeof(device));
+    iree_hal_resource_cache_key_append(&key, &flags, sizeof(flags));
+    iree_hal_resource_cache_key_append(&key, bindings,
+                                       binding_count * sizeof(bindings[0]));
+    IREE_RETURN_IF_ERROR(iree_hal_module_state_lookup_resource(
+        state, &key, (iree_hal_resource_t**)&descriptor_set_layout));
+  }
+
+  if (!descriptor_set_layout) {
+    IREE_RETURN_IF_ERROR(iree_hal_descriptor_set_layout_create(
+        device, flags, binding_count, bindings, &descriptor_set_layout));
+    if (state->resource_cache) {
+      IREE_RETURN_IF_ERROR(iree_hal_module_state_share_resource(
+          state, &key, (iree_hal_resource_t**)&descriptor_set_layout));
+    }
+  }
+
   rets->r0 = iree_hal_descriptor_set_layout_move_ref(descriptor_set_layout);
   return iree_ok_status();
 }
@@ -1011,6 +1119,37 @@ IREE_VM_ABI_EXPORT(iree_hal_module_device_queue_flush,  //
 // iree_hal_executable_t
 //===--------------------------------------------------------------------===//
 
+// Builds the shared resource key of an executable prepared with |params| from
+// the module rodata |executable_data|. Executables that alias their data can
+// only be shared with users of the same loaded copy of it and also include its
+// identity. Pipeline layouts are themselves shared so their identity is
+// sufficient.
+static void iree_hal_module_executable_key(
+    iree_hal_device_t* device, const iree_vm_buffer_t* executable_data,
+    const iree_hal_executable_params_t* params,
+    iree_hal_resource_cache_key_t* out_key) {
+  iree_hal_resource_cache_key_initialize(
+      IREE_HAL_RESOURCE_CACHE_TYPE_EXECUTABLE, out_key);
+  iree_hal_resource_cache_key_append(out_key, &device, sizeof(device));
+  iree_hal_resource_cache_key_append(out_key, &params->caching_mode,
+                                     sizeof(params->caching_mode));
+  iree_hal_resource_cache_key_append(out_key, params->executable_format.data,
+                                     params->executable_format.size);
+  iree_hal_module_key_append_rodata(out_key, executable_data, 0,
+                                    executable_data->data.data_length);
+  if (iree_all_bits_set(params->caching_mode,
+                        IREE_HAL_EXECUTABLE_CACHING_MODE_ALIAS_PROVIDED_DATA)) {
+    iree_hal_resource_cache_key_append_identity(out_key,
+                                                params->executable_data);
+  }
+  iree_hal_resource_cache_key_append(
+      out_key, params->pipeline_layouts,
+      params->pipeline_layout_count * sizeof(params->pipeline_layouts[0]));
+  iree_hal_resource_cache_key_append(
+      out_key, params->constants,
+      params->constant_count * sizeof(params->constants[0]));
+}
+
 IREE_VM_ABI_EXPORT(iree_hal_module_executable_create,  //
                    iree_hal_module_state_t,            //
                    rrrrCrD, r) {
@@ -1066,8 +1205,27 @@ IREE_VM_ABI_EXPORT(iree_hal_module_executable_create,  //
     executable_params.pipeline_layouts = pipeline_layouts;
     executable_params.constant_count = constant_count;
     executable_params.constants = constants;
-    status = iree_hal_executable_cache_prepare_executable(
-        state->executable_cache, &executable_params, &executable);
+
+    // Only executables loaded from module rodata with a known digest are
+    // shared; other data may change or be freed while the executable remains
+    // in the cache.
+    bool is_shareable =
+        state->resource_cache && executable_data->origin_digest != NULL;
+    iree_hal_resource_cache_key_t key;
+    if (is_shareable) {
+      iree_hal_module_executable_key(device, executable_data,
+                                     &executable_params, &key);
+      status = iree_hal_module_state_lookup_resource(
+          state, &key, (iree_hal_resource_t**)&executable);
+    }
+    if (iree_status_is_ok(status) && !executable) {
+      status = iree_hal_executable_cache_prepare_executable(
+          state->executable_cache, &executable_params, &executable);
+      if (iree_status_is_ok(status) && is_shareable) {
+        status = iree_hal_module_state_share_resource(
+            state, &key, (iree_hal_resource_t**)&executable);
+      }
+    }
   }
 
   iree_allocator_free(state->host_allocator, pipeline_layouts);
@@ -1373,9 +1531,31 @@ IREE_VM_ABI_EXPORT(iree_hal_module_pipeline_layout_create,  //
                               iree_hal_descriptor_set_layout, 32,
                               &set_layout_count, &set_layouts);
 
+  // Set layouts are themselves shared so their identity is sufficient.
+  iree_hal_resource_cache_key_t key;
   iree_hal_pipeline_layout_t* pipeline_layout = NULL;
-  IREE_RETURN_IF_ERROR(iree_hal_pipeline_layout_create(
-      device, push_constants, set_layout_count, set_layouts, &pipeline_layout));
+  if (state->resource_cache) {
+    iree_hal_resource_cache_key_initialize(
+        IREE_HAL_RESOURCE_CACHE_TYPE_PIPELINE_LAYOUT, &key);
+    iree_hal_resource_cache_key_append(&key, &device, sizeof(device));
+    iree_hal_resource_cache_key_append(&key, &push_constants,
+                                       sizeof(push_constants));
+    iree_hal_resource_cache_key_append(
+        &key, set_layouts, set_layout_count * sizeof(set_layouts[0]));
+    IREE_RETURN_IF_ERROR(iree_hal_module_state_lookup_resource(
+        state, &key, (iree_hal_resource_t**)&pipeline_layout));
+  }
+
+  if (!pipeline_layout) {
+    IREE_RETURN_IF_ERROR(iree_hal_pipeline_layout_create(
+        device, push_constants, set_layout_count, set_layouts,
+        &pipeline_layout));
+    if (state->resource_cache) {
+      IREE_RETURN_IF_ERROR(iree_hal_module_state_share_resource(
+          state, &key, (iree_hal_resource_t**)&pipeline_layout));
+    }
+  }
+
   rets->r0 = iree_hal_pipeline_layout_move_ref(pipeline_layout);
   return iree_ok_status();
 }
@@ -1470,6 +1650,16 @@ IREE_API_EXPORT iree_status_t iree_hal_module_create(
   module->shared_device = device;
   iree_hal_device_retain(module->shared_device);
 
+  if (!iree_all_bits_set(flags,
+                         IREE_HAL_MODULE_FLAG_DISABLE_RESOURCE_SHARING)) {
+    status = iree_hal_resource_cache_acquire(device, host_allocator,
+                                             &module->resource_cache);
+    if (!iree_status_is_ok(status)) {
+      iree_vm_module_release(base_module);
+      return status;
+    }
+  }
+
   *out_module = base_module;
   return iree_ok_status();
 }
@@ -23,6 +23,13 @@ enum iree_hal_module_flag_bits_t {
 
   // Forces HAL methods to block instead of yielding as a coroutine.
   IREE_HAL_MODULE_FLAG_SYNCHRONOUS = 1u << 0,
+
+  // Disables sharing of immutable resources (executables, layouts, and
+  // constant buffers) with other HAL modules using the same device. By default
+  // all HAL modules in the process using a device share a cache of these
+  // resources so that contexts loading the same program reuse them instead of
+  // preparing and uploading their own copies.
+  IREE_HAL_MODULE_FLAG_DISABLE_RESOURCE_SHARING = 1u << 1,
 };
 typedef uint32_t iree_hal_module_flags_t;
 
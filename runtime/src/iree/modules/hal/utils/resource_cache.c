@@ -0,0 +1,418 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/modules/hal/utils/resource_cache.h"
+
+#include <string.h>
+
+#include "iree/base/internal/call_once.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/tracing.h"
+
+//===----------------------------------------------------------------------===//
+// iree_hal_resource_cache_key_t
+//===----------------------------------------------------------------------===//
+
+void iree_hal_resource_cache_key_initialize(
+    iree_hal_resource_cache_type_t type,
+    iree_hal_resource_cache_key_t* out_key) {
+  out_key->length = 0;
+  uint32_t type_value = (uint32_t)type;
+  iree_hal_resource_cache_key_append(out_key, &type_value, sizeof(type_value));
+}
+
+void iree_hal_resource_cache_key_append(iree_hal_resource_cache_key_t* key,
+                                        const void* data,
+                                        iree_host_size_t data_length) {
+  // The length is appended first so that adjacent fields can't shift bytes
+  // between each other and produce the same key.
+  iree_host_size_t required_length =
+      key->length + sizeof(data_length) + data_length;
+  if (required_length <= IREE_HAL_RESOURCE_CACHE_KEY_CAPACITY) {
+    memcpy(key->data + key->length, &data_length, sizeof(data_length));
+    if (data_length > 0) {
+      memcpy(key->data + key->length + sizeof(data_length), data, data_length);
+    }
+  }
+  key->length = required_length;
+}
+
+void iree_hal_resource_cache_key_append_identity(
+    iree_hal_resource_cache_key_t* key, iree_const_byte_span_t data) {
+  iree_hal_resource_cache_key_append(key, &data.data, sizeof(data.data));
+  iree_hal_resource_cache_key_append(key, &data.data_length,
+                                     sizeof(data.data_length));
+}
+
+static inline bool iree_hal_resource_cache_key_is_valid(
+    const iree_hal_resource_cache_key_t* key) {
+  return key->length <= IREE_HAL_RESOURCE_CACHE_KEY_CAPACITY;
+}
+
+// FNV-1a over the key bytes. Only used to select a bucket; keys are always
+// compared in full.
+static uint64_t iree_hal_resource_cache_key_hash(
+    const iree_hal_resource_cache_key_t* key) {
+  uint64_t hash = 0xCBF29CE484222325ull;
+  for (iree_host_size_t i = 0; i < key->length; ++i) {
+    hash = (hash ^ key->data[i]) * 0x100000001B3ull;
+  }
+  return hash;
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_resource_cache_t
+//===----------------------------------------------------------------------===//
+
+// Power of two number of hash buckets. Programs have at most a few hundred
+// executables and layouts and sharing contexts have the same ones.
+#define IREE_HAL_RESOURCE_CACHE_BUCKET_COUNT 256
+
+struct iree_hal_resource_cache_entry_t {
+  // Next entry in the cache-wide list ordered newest to oldest.
+  struct iree_hal_resource_cache_entry_t* next;
+  // Next entry in the same hash bucket.
+  struct iree_hal_resource_cache_entry_t* bucket_next;
+  // Retained resource or NULL if the entry was trimmed while still pinned.
+  // Trimmed entries are no longer in the cache and are freed when unpinned.
+  iree_hal_resource_t* resource;
+  // Number of pins held on the entry across all cache users.
+  iree_host_size_t pin_count;
+  uint64_t key_hash;
+  iree_host_size_t key_length;
+  uint8_t key_data[];
+};
+
+struct iree_hal_resource_cache_t {
+  iree_allocator_t host_allocator;
+
+  // Next cache in the process-wide registry. Guarded by the registry mutex.
+  iree_hal_resource_cache_t* registry_next;
+  // Number of users that have acquired the cache. Guarded by the registry
+  // mutex so that lookups in the registry never observe a dying cache.
+  iree_host_size_t user_count;
+
+  // Device all resources in the cache were created for.
+  iree_hal_device_t* device;
+
+  // Guards all entries.
+  iree_slim_mutex_t mutex;
+  iree_host_size_t entry_count;
+  // All entries ordered newest to oldest. Resources can only reference
+  // resources created before them (executables reference layouts, etc) so
+  // walking in this order drops dependents before their dependencies.
+  iree_hal_resource_cache_entry_t* entries;
+  iree_hal_resource_cache_entry_t*
+      buckets[IREE_HAL_RESOURCE_CACHE_BUCKET_COUNT];
+};
+
+// Process-wide registry of caches, one per device.
+typedef struct iree_hal_resource_cache_registry_t {
+  iree_slim_mutex_t mutex;
+  iree_hal_resource_cache_t* head;
+} iree_hal_resource_cache_registry_t;
+
+static iree_hal_resource_cache_registry_t iree_hal_resource_cache_registry_;
+static iree_once_flag iree_hal_resource_cache_registry_flag_ =
+    IREE_ONCE_FLAG_INIT;
+static void iree_hal_resource_cache_registry_initialize(void) {
+  memset(&iree_hal_resource_cache_registry_, 0,
+         sizeof(iree_hal_resource_cache_registry_));
+  iree_slim_mutex_initialize(&iree_hal_resource_cache_registry_.mutex);
+}
+
+static iree_hal_resource_cache_registry_t* iree_hal_resource_cache_registry(
+    void) {
+  iree_call_once(&iree_hal_resource_cache_registry_flag_,
+                 iree_hal_resource_cache_registry_initialize);
+  return &iree_hal_resource_cache_registry_;
+}
+
+static iree_hal_resource_cache_entry_t** iree_hal_resource_cache_bucket(
+    iree_hal_resource_cache_t* cache, uint64_t key_hash) {
+  return &cache->buckets[key_hash & (IREE_HAL_RESOURCE_CACHE_BUCKET_COUNT - 1)];
+}
+
+iree_status_t iree_hal_resource_cache_acquire(
+    iree_hal_device_t* device, iree_allocator_t host_allocator,
+    iree_hal_resource_cache_t** out_cache) {
+  IREE_ASSERT_ARGUMENT(device);
+  IREE_ASSERT_ARGUMENT(out_cache);
+  *out_cache = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_resource_cache_registry_t* registry =
+      iree_hal_resource_cache_registry();
+  iree_slim_mutex_lock(&registry->mutex);
+
+  iree_hal_resource_cache_t* cache = registry->head;
+  while (cache && cache->device != device) cache = cache->registry_next;
+
+  iree_status_t status = iree_ok_status();
+  if (!cache) {
+    status =
+        iree_allocator_malloc(host_allocator, sizeof(*cache), (void**)&cache);
+    if (iree_status_is_ok(status)) {
+      memset(cache, 0, sizeof(*cache));
+      cache->host_allocator = host_allocator;
+      cache->device = device;
+      iree_hal_device_retain(device);
+      iree_slim_mutex_initialize(&cache->mutex);
+      cache->registry_next = registry->head;
+      registry->head = cache;
+    }
+  }
+  if (iree_status_is_ok(status)) {
+    ++cache->user_count;
+    *out_cache = cache;
+  }
+
+  iree_slim_mutex_unlock(&registry->mutex);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_resource_cache_destroy(iree_hal_resource_cache_t* cache) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_allocator_t host_allocator = cache->host_allocator;
+
+  // All users have unpinned their entries by the time the last one releases
+  // the cache and unpinned entries are removed so this is usually empty.
+  iree_hal_resource_cache_entry_t* entry = cache->entries;
+  while (entry) {
+    iree_hal_resource_cache_entry_t* next = entry->next;
+    iree_hal_resource_release(entry->resource);
+    iree_allocator_free(host_allocator, entry);
+    entry = next;
+  }
+
+  iree_slim_mutex_deinitialize(&cache->mutex);
+  iree_hal_device_release(cache->device);
+  iree_allocator_free(host_allocator, cache);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+void iree_hal_resource_cache_release(iree_hal_resource_cache_t* cache) {
+  if (!cache) return;
+
+  iree_hal_resource_cache_registry_t* registry =
+      iree_hal_resource_cache_registry();
+  iree_slim_mutex_lock(&registry->mutex);
+  bool is_last_user = --cache->user_count == 0;
+  if (is_last_user) {
+    iree_hal_resource_cache_t** it = &registry->head;
+    while (*it != cache) it = &(*it)->registry_next;
+    *it = cache->registry_next;
+  }
+  iree_slim_mutex_unlock(&registry->mutex);
+
+  if (is_last_user) iree_hal_resource_cache_destroy(cache);
+}
+
+// Returns the entry with |key| or NULL. Must be called with the mutex held.
+static iree_hal_resource_cache_entry_t* iree_hal_resource_cache_find(
+    iree_hal_resource_cache_t* cache, const iree_hal_resource_cache_key_t* key,
+    uint64_t key_hash) {
+  iree_hal_resource_cache_entry_t* entry =
+      *iree_hal_resource_cache_bucket(cache, key_hash);
+  while (entry) {
+    if (entry->key_hash == key_hash && entry->key_length == key->length &&
+        memcmp(entry->key_data, key->data, key->length) == 0) {
+      break;
+    }
+    entry = entry->bucket_next;
+  }
+  return entry;
+}
+
+// Adds a pin on |entry| to |pins|. Must be called with the mutex held.
+static iree_status_t iree_hal_resource_cache_pin(
+    iree_hal_resource_cache_t* cache, iree_hal_resource_cache_pins_t* pins,
+    iree_hal_resource_cache_entry_t* entry) {
+  if (pins->count == pins->capacity) {
+    iree_host_size_t new_capacity = iree_max(16, pins->capacity * 2);
+    IREE_RETURN_IF_ERROR(iree_allocator_realloc(
+        cache->host_allocator, new_capacity * sizeof(pins->entries[0]),
+        (void**)&pins->entries));
+    pins->capacity = new_capacity;
+  }
+  pins->entries[pins->count++] = entry;
+  ++entry->pin_count;
+  return iree_ok_status();
+}
+
+// Removes |entry| from the cache and releases its resource. The entry memory
+// remains live until it is no longer pinned. Must be called with the mutex held
+// and |entry_it| pointing at the link to |entry| in the cache-wide list.
+static void iree_hal_resource_cache_remove(
+    iree_hal_resource_cache_t* cache,
+    iree_hal_resource_cache_entry_t** entry_it) {
+  iree_hal_resource_cache_entry_t* entry = *entry_it;
+  *entry_it = entry->next;
+  iree_hal_resource_cache_entry_t** bucket_it =
+      iree_hal_resource_cache_bucket(cache, entry->key_hash);
+  while (*bucket_it != entry) bucket_it = &(*bucket_it)->bucket_next;
+  *bucket_it = entry->bucket_next;
+  --cache->entry_count;
+  iree_hal_resource_release(entry->resource);
+  entry->resource = NULL;
+  if (entry->pin_count == 0) {
+    iree_allocator_free(cache->host_allocator, entry);
+  }
+}
+
+iree_status_t iree_hal_resource_cache_lookup(
+    iree_hal_resource_cache_t* cache, const iree_hal_resource_cache_key_t* key,
+    iree_hal_resource_cache_pins_t* pins, iree_hal_resource_t** out_resource) {
+  IREE_ASSERT_ARGUMENT(cache);
+  IREE_ASSERT_ARGUMENT(key);
+  IREE_ASSERT_ARGUMENT(pins);
+  IREE_ASSERT_ARGUMENT(out_resource);
+  *out_resource = NULL;
+  if (!iree_hal_resource_cache_key_is_valid(key)) return iree_ok_status();
+  uint64_t key_hash = iree_hal_resource_cache_key_hash(key);
+
+  iree_slim_mutex_lock(&cache->mutex);
+  iree_status_t status = iree_ok_status();
+  iree_hal_resource_cache_entry_t* entry =
+      iree_hal_resource_cache_find(cache, key, key_hash);
+  if (entry) {
+    status = iree_hal_resource_cache_pin(cache, pins, entry);
+    if (iree_status_is_ok(status)) {
+      *out_resource = entry->resource;
+      iree_hal_resource_retain(*out_resource);
+    }
+  }
+  iree_slim_mutex_unlock(&cache->mutex);
+  return status;
+}
+
+iree_status_t iree_hal_resource_cache_insert(
+    iree_hal_resource_cache_t* cache, const iree_hal_resource_cache_key_t* key,
+    iree_hal_resource_t* resource, iree_hal_resource_cache_pins_t* pins,
+    iree_hal_resource_t** out_resource) {
+  IREE_ASSERT_ARGUMENT(cache);
+  IREE_ASSERT_ARGUMENT(key);
+  IREE_ASSERT_ARGUMENT(resource);
+  IREE_ASSERT_ARGUMENT(pins);
+  IREE_ASSERT_ARGUMENT(out_resource);
+  *out_resource = NULL;
+  if (!iree_hal_resource_cache_key_is_valid(key)) {
+    iree_hal_resource_retain(resource);
+    *out_resource = resource;
+    return iree_ok_status();
+  }
+  uint64_t key_hash = iree_hal_resource_cache_key_hash(key);
+
+  // Allocate outside of the lock; we'll discard it if we lose the race.
+  iree_hal_resource_cache_entry_t* new_entry = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      cache->host_allocator, sizeof(*new_entry) + key->length,
+      (void**)&new_entry));
+
+  iree_slim_mutex_lock(&cache->mutex);
+  iree_hal_resource_cache_entry_t* entry =
+      iree_hal_resource_cache_find(cache, key, key_hash);
+  if (!entry) {
+    iree_hal_resource_cache_entry_t** bucket =
+        iree_hal_resource_cache_bucket(cache, key_hash);
+    new_entry->resource = resource;
+    iree_hal_resource_retain(resource);
+    new_entry->pin_count = 0;
+    new_entry->key_hash = key_hash;
+    new_entry->key_length = key->length;
+    memcpy(new_entry->key_data, key->data, key->length);
+    new_entry->bucket_next = *bucket;
+    *bucket = new_entry;
+    new_entry->next = cache->entries;
+    cache->entries = new_entry;
+    ++cache->entry_count;
+    entry = new_entry;
+    new_entry = NULL;
+  }
+  iree_status_t status = iree_hal_resource_cache_pin(cache, pins, entry);
+  if (iree_status_is_ok(status)) {
+    *out_resource = entry->resource;
+    iree_hal_resource_retain(*out_resource);
+  } else if (entry->pin_count == 0) {
+    // Entries must not remain in the cache unpinned.
+    iree_hal_resource_cache_entry_t** it = &cache->entries;
+    while (*it != entry) it = &(*it)->next;
+    iree_hal_resource_cache_remove(cache, it);
+  }
+  iree_slim_mutex_unlock(&cache->mutex);
+
+  iree_allocator_free(cache->host_allocator, new_entry);
+  return status;
+}
+
+void iree_hal_resource_cache_unpin(iree_hal_resource_cache_t* cache,
+                                   iree_hal_resource_cache_pins_t* pins) {
+  if (!cache || !pins->entries) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_slim_mutex_lock(&cache->mutex);
+
+  bool any_unpinned = false;
+  for (iree_host_size_t i = 0; i < pins->count; ++i) {
+    iree_hal_resource_cache_entry_t* entry = pins->entries[i];
+    if (--entry->pin_count > 0) continue;
+    if (entry->resource) {
+      any_unpinned = true;
+    } else {
+      // Already trimmed from the cache; we were the last reference.
+      iree_allocator_free(cache->host_allocator, entry);
+    }
+  }
+
+  // Remove all entries that are no longer pinned by any user in one pass.
+  // Their keys may reference source data that is about to be freed.
+  if (any_unpinned) {
+    iree_hal_resource_cache_entry_t** it = &cache->entries;
+    while (*it) {
+      if ((*it)->pin_count == 0) {
+        iree_hal_resource_cache_remove(cache, it);
+      } else {
+        it = &(*it)->next;
+      }
+    }
+  }
+
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (uint64_t)cache->entry_count);
+  iree_slim_mutex_unlock(&cache->mutex);
+
+  iree_allocator_free(cache->host_allocator, pins->entries);
+  memset(pins, 0, sizeof(*pins));
+  IREE_TRACE_ZONE_END(z0);
+}
+
+void iree_hal_resource_cache_trim(iree_hal_resource_cache_t* cache) {
+  if (!cache) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_slim_mutex_lock(&cache->mutex);
+
+  // New references can only be acquired through the cache while the mutex is
+  // held so a count of 1 (our own) cannot change underneath us.
+  iree_hal_resource_cache_entry_t** it = &cache->entries;
+  while (*it) {
+    if (iree_atomic_ref_count_load(&(*it)->resource->ref_count) == 1) {
+      iree_hal_resource_cache_remove(cache, it);
+    } else {
+      it = &(*it)->next;
+    }
+  }
+
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (uint64_t)cache->entry_count);
+  iree_slim_mutex_unlock(&cache->mutex);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+iree_host_size_t iree_hal_resource_cache_count(
+    iree_hal_resource_cache_t* cache) {
+  iree_slim_mutex_lock(&cache->mutex);
+  iree_host_size_t count = cache->entry_count;
+  iree_slim_mutex_unlock(&cache->mutex);
+  return count;
+}
@@ -0,0 +1,148 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_MODULES_HAL_UTILS_RESOURCE_CACHE_H_
+#define IREE_MODULES_HAL_UTILS_RESOURCE_CACHE_H_
+
+#include <stdint.h>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_hal_resource_cache_key_t
+//===----------------------------------------------------------------------===//
+
+// Resource type tags used to partition keys so that resources of different
+// types with coincidentally identical contents never alias.
+typedef enum iree_hal_resource_cache_type_e {
+  IREE_HAL_RESOURCE_CACHE_TYPE_DESCRIPTOR_SET_LAYOUT = 1,
+  IREE_HAL_RESOURCE_CACHE_TYPE_PIPELINE_LAYOUT = 2,
+  IREE_HAL_RESOURCE_CACHE_TYPE_EXECUTABLE = 3,
+  IREE_HAL_RESOURCE_CACHE_TYPE_BUFFER = 4,
+} iree_hal_resource_cache_type_t;
+
+// Maximum length in bytes of a resource key.
+#define IREE_HAL_RESOURCE_CACHE_KEY_CAPACITY 1024
+
+// Identifies a resource by everything that determines its contents.
+// Keys are built by appending each input of the resource creation in order and
+// are compared byte-for-byte on lookup so that a hash collision can never
+// return the wrong resource.
+//
+// Large inputs such as executable binaries and constant data are not appended
+// by contents so that building a key does not touch the data. Data from module
+// rodata is appended as the digest of the module and its offset within it.
+// Resources that reference the memory of a particular copy of their data (such
+// as executables aliasing it) additionally append the identity of that memory
+// with iree_hal_resource_cache_key_append_identity. See
+// iree_hal_resource_cache_pins_t for how the cache ensures such keys never
+// match stale memory.
+typedef struct iree_hal_resource_cache_key_t {
+  // Total number of bytes appended, which may exceed the capacity in which case
+  // the key is unusable and the resource is not shared.
+  iree_host_size_t length;
+  uint8_t data[IREE_HAL_RESOURCE_CACHE_KEY_CAPACITY];
+} iree_hal_resource_cache_key_t;
+
+// Initializes |out_key| for a resource of the given |type|.
+void iree_hal_resource_cache_key_initialize(
+    iree_hal_resource_cache_type_t type,
+    iree_hal_resource_cache_key_t* out_key);
+
+// Appends |data_length| bytes of |data| to the |key|.
+void iree_hal_resource_cache_key_append(iree_hal_resource_cache_key_t* key,
+                                        const void* data,
+                                        iree_host_size_t data_length);
+
+// Appends the identity of |data| (its address and length) to the |key|.
+// The data must remain live and unchanged for as long as the cache user that
+// uses the key holds its pins.
+void iree_hal_resource_cache_key_append_identity(
+    iree_hal_resource_cache_key_t* key, iree_const_byte_span_t data);
+
+//===----------------------------------------------------------------------===//
+// iree_hal_resource_cache_t
+//===----------------------------------------------------------------------===//
+
+// A process-wide cache of immutable HAL resources created for a device.
+// Multiple HAL modules (and with them multiple VM contexts and runtime
+// sessions) using the same device share a single cache so that executables,
+// layouts, and constant buffers prepared by one are reused by the others
+// instead of being created again.
+//
+// The cache holds a reference to each resource it contains. Resources that are
+// no longer referenced by anything but the cache are dropped by
+// iree_hal_resource_cache_trim.
+//
+// Thread-safe.
+typedef struct iree_hal_resource_cache_t iree_hal_resource_cache_t;
+
+typedef struct iree_hal_resource_cache_entry_t iree_hal_resource_cache_entry_t;
+
+// Cache entries looked up or inserted by a single cache user (such as a HAL
+// module state). An entry remains in the cache only while at least one user
+// pins it: keys may reference source data by identity and that data is only
+// guaranteed to be live and unchanged while a user that provided it is alive.
+// Once the last user unpins an entry it can no longer be found even if the
+// resource itself is still referenced elsewhere.
+//
+// Guarded by the cache mutex.
+typedef struct iree_hal_resource_cache_pins_t {
+  iree_host_size_t count;
+  iree_host_size_t capacity;
+  iree_hal_resource_cache_entry_t** entries;
+} iree_hal_resource_cache_pins_t;
+
+// Acquires the shared resource cache for |device|, creating it if this is the
+// first user. Must be released with iree_hal_resource_cache_release.
+iree_status_t iree_hal_resource_cache_acquire(
+    iree_hal_device_t* device, iree_allocator_t host_allocator,
+    iree_hal_resource_cache_t** out_cache);
+
+// Releases the caller's reference to |cache|. The cache and the resources it
+// holds are released when the last user releases it.
+void iree_hal_resource_cache_release(iree_hal_resource_cache_t* cache);
+
+// Returns the resource matching |key| in |out_resource| or NULL if not present.
+// A found entry is added to |pins|. The returned resource is retained and must
+// be released by the caller.
+iree_status_t iree_hal_resource_cache_lookup(
+    iree_hal_resource_cache_t* cache, const iree_hal_resource_cache_key_t* key,
+    iree_hal_resource_cache_pins_t* pins, iree_hal_resource_t** out_resource);
+
+// Inserts |resource| into the cache under |key| and adds the entry to |pins|.
+// If another resource was inserted with the same key first (such as by a
+// concurrent context) that one is returned in |out_resource| and the caller
+// should use it in place of its own. Keys that exceed the key capacity are not
+// inserted and |resource| is returned as-is. |out_resource| is retained and
+// must be released by the caller. On failure no resource is returned.
+iree_status_t iree_hal_resource_cache_insert(
+    iree_hal_resource_cache_t* cache, const iree_hal_resource_cache_key_t* key,
+    iree_hal_resource_t* resource, iree_hal_resource_cache_pins_t* pins,
+    iree_hal_resource_t** out_resource);
+
+// Unpins all entries in |pins| and frees its storage. Entries no longer pinned
+// by any user are removed from the cache.
+void iree_hal_resource_cache_unpin(iree_hal_resource_cache_t* cache,
+                                   iree_hal_resource_cache_pins_t* pins);
+
+// Drops all resources that are only referenced by the cache.
+void iree_hal_resource_cache_trim(iree_hal_resource_cache_t* cache);
+
+// Returns the total number of resources in the cache.
+iree_host_size_t iree_hal_resource_cache_count(
+    iree_hal_resource_cache_t* cache);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_MODULES_HAL_UTILS_RESOURCE_CACHE_H_
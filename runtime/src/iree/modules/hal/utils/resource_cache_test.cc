@@ -0,0 +1,278 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/modules/hal/utils/resource_cache.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+typedef struct iree_hal_test_resource_t {
+  iree_hal_resource_t resource;
+  iree_allocator_t host_allocator;
+  int* live_count;
+} iree_hal_test_resource_t;
+
+typedef struct iree_hal_test_resource_vtable_t {
+  void(IREE_API_PTR* destroy)(iree_hal_test_resource_t* resource);
+} iree_hal_test_resource_vtable_t;
+IREE_HAL_ASSERT_VTABLE_LAYOUT(iree_hal_test_resource_vtable_t);
+
+extern const iree_hal_test_resource_vtable_t iree_hal_test_resource_vtable;
+
+static iree_status_t iree_hal_test_resource_create(
+    int* live_count, iree_allocator_t host_allocator,
+    iree_hal_resource_t** out_resource) {
+  iree_hal_test_resource_t* test_resource = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      host_allocator, sizeof(*test_resource), (void**)&test_resource));
+  iree_hal_resource_initialize(&iree_hal_test_resource_vtable,
+                               &test_resource->resource);
+  test_resource->host_allocator = host_allocator;
+  test_resource->live_count = live_count;
+  ++*live_count;
+  *out_resource = (iree_hal_resource_t*)test_resource;
+  return iree_ok_status();
+}
+
+static void iree_hal_test_resource_destroy(iree_hal_test_resource_t* resource) {
+  iree_allocator_t host_allocator = resource->host_allocator;
+  --*resource->live_count;
+  iree_allocator_free(host_allocator, resource);
+}
+
+const iree_hal_test_resource_vtable_t iree_hal_test_resource_vtable = {
+    /*.destroy=*/iree_hal_test_resource_destroy,
+};
+
+static iree_hal_resource_cache_key_t MakeKey(uint32_t value) {
+  iree_hal_resource_cache_key_t key;
+  iree_hal_resource_cache_key_initialize(
+      IREE_HAL_RESOURCE_CACHE_TYPE_DESCRIPTOR_SET_LAYOUT, &key);
+  iree_hal_resource_cache_key_append(&key, &value, sizeof(value));
+  return key;
+}
+
+struct ResourceCacheTest : public ::testing::Test {
+  iree_allocator_t host_allocator = iree_allocator_system();
+  // Only used for its identity and reference count.
+  int device_live_count = 0;
+  iree_hal_device_t* device = NULL;
+  int live_count = 0;
+  iree_hal_resource_cache_t* cache = NULL;
+
+  void SetUp() override {
+    IREE_ASSERT_OK(iree_hal_test_resource_create(
+        &device_live_count, host_allocator, (iree_hal_resource_t**)&device));
+    IREE_ASSERT_OK(
+        iree_hal_resource_cache_acquire(device, host_allocator, &cache));
+  }
+
+  void TearDown() override {
+    iree_hal_resource_cache_release(cache);
+    iree_hal_device_release(device);
+    EXPECT_EQ(0, live_count);
+    EXPECT_EQ(0, device_live_count);
+  }
+
+  // Inserts a new resource under |key| and returns the resource in the cache.
+  // The returned resource is retained.
+  iree_hal_resource_t* Insert(const iree_hal_resource_cache_key_t& key,
+                              iree_hal_resource_cache_pins_t* pins) {
+    iree_hal_resource_t* resource = NULL;
+    IREE_CHECK_OK(
+        iree_hal_test_resource_create(&live_count, host_allocator, &resource));
+    iree_hal_resource_t* shared_resource = NULL;
+    IREE_CHECK_OK(iree_hal_resource_cache_insert(cache, &key, resource, pins,
+                                                 &shared_resource));
+    iree_hal_resource_release(resource);
+    return shared_resource;
+  }
+
+  // Returns the resource under |key| or NULL. The returned resource is
+  // retained.
+  iree_hal_resource_t* Lookup(const iree_hal_resource_cache_key_t& key,
+                              iree_hal_resource_cache_pins_t* pins) {
+    iree_hal_resource_t* resource = NULL;
+    IREE_CHECK_OK(iree_hal_resource_cache_lookup(cache, &key, pins, &resource));
+    return resource;
+  }
+};
+
+// Users of the same device share one cache and the resources in it.
+TEST_F(ResourceCacheTest, SharesAcrossUsers) {
+  iree_hal_resource_cache_t* other_cache = NULL;
+  IREE_ASSERT_OK(
+      iree_hal_resource_cache_acquire(device, host_allocator, &other_cache));
+  EXPECT_EQ(cache, other_cache);
+
+  iree_hal_resource_cache_pins_t pins_a = {0};
+  iree_hal_resource_cache_pins_t pins_b = {0};
+  iree_hal_resource_t* resource_a = Insert(MakeKey(1), &pins_a);
+  iree_hal_resource_t* resource_b = Lookup(MakeKey(1), &pins_b);
+  EXPECT_EQ(resource_a, resource_b);
+  EXPECT_EQ(nullptr, Lookup(MakeKey(2), &pins_b));
+  EXPECT_EQ(1, live_count);
+
+  // Losing the race to insert returns the resource inserted first.
+  iree_hal_resource_t* resource_c = Insert(MakeKey(1), &pins_b);
+  EXPECT_EQ(resource_a, resource_c);
+  EXPECT_EQ(1, live_count);
+  EXPECT_EQ(1, iree_hal_resource_cache_count(cache));
+
+  iree_hal_resource_release(resource_a);
+  iree_hal_resource_release(resource_b);
+  iree_hal_resource_release(resource_c);
+  iree_hal_resource_cache_unpin(other_cache, &pins_b);
+  iree_hal_resource_cache_unpin(cache, &pins_a);
+  iree_hal_resource_cache_release(other_cache);
+}
+
+// Entries are removed once the last user unpins them even if the resource is
+// still referenced elsewhere.
+TEST_F(ResourceCacheTest, UnpinRemovesEntries) {
+  iree_hal_resource_cache_pins_t pins_a = {0};
+  iree_hal_resource_cache_pins_t pins_b = {0};
+  iree_hal_resource_t* resource_a = Insert(MakeKey(1), &pins_a);
+  iree_hal_resource_t* resource_b = Lookup(MakeKey(1), &pins_b);
+  iree_hal_resource_release(resource_b);
+
+  iree_hal_resource_cache_unpin(cache, &pins_b);
+  EXPECT_EQ(1, iree_hal_resource_cache_count(cache));
+
+  iree_hal_resource_cache_unpin(cache, &pins_a);
+  EXPECT_EQ(0, iree_hal_resource_cache_count(cache));
+  EXPECT_EQ(1, live_count);
+
+  iree_hal_resource_cache_pins_t pins_c = {0};
+  EXPECT_EQ(nullptr, Lookup(MakeKey(1), &pins_c));
+  iree_hal_resource_release(resource_a);
+  EXPECT_EQ(0, live_count);
+}
+
+// Trimming drops resources only referenced by the cache while users may still
+// hold pins on their entries.
+TEST_F(ResourceCacheTest, Trim) {
+  iree_hal_resource_cache_pins_t pins = {0};
+  iree_hal_resource_t* resource_1 = Insert(MakeKey(1), &pins);
+  iree_hal_resource_t* resource_2 = Insert(MakeKey(2), &pins);
+  iree_hal_resource_release(resource_1);
+  EXPECT_EQ(2, live_count);
+
+  iree_hal_resource_cache_trim(cache);
+  EXPECT_EQ(1, iree_hal_resource_cache_count(cache));
+  EXPECT_EQ(1, live_count);
+  EXPECT_EQ(nullptr, Lookup(MakeKey(1), &pins));
+
+  // A new resource can be inserted under the trimmed key.
+  iree_hal_resource_t* resource_3 = Insert(MakeKey(1), &pins);
+  EXPECT_EQ(2, iree_hal_resource_cache_count(cache));
+
+  iree_hal_resource_release(resource_2);
+  iree_hal_resource_release(resource_3);
+  iree_hal_resource_cache_unpin(cache, &pins);
+  EXPECT_EQ(0, iree_hal_resource_cache_count(cache));
+}
+
+// Keys sharing a hash bucket or a digest never alias as keys are compared in
+// full.
+TEST_F(ResourceCacheTest, Collisions) {
+  iree_hal_resource_cache_pins_t pins = {0};
+  static constexpr uint32_t kKeyCount = 2048;
+  std::vector<iree_hal_resource_t*> resources(kKeyCount);
+  for (uint32_t i = 0; i < kKeyCount; ++i) {
+    resources[i] = Insert(MakeKey(i), &pins);
+  }
+  EXPECT_EQ(kKeyCount, iree_hal_resource_cache_count(cache));
+  for (uint32_t i = 0; i < kKeyCount; ++i) {
+    iree_hal_resource_t* resource = Lookup(MakeKey(i), &pins);
+    EXPECT_EQ(resources[i], resource);
+    iree_hal_resource_release(resource);
+  }
+
+  // The same bytes split across fields or in a different type are different
+  // keys.
+  uint8_t bytes[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+  iree_hal_resource_cache_key_t key_a;
+  iree_hal_resource_cache_key_initialize(
+      IREE_HAL_RESOURCE_CACHE_TYPE_PIPELINE_LAYOUT, &key_a);
+  iree_hal_resource_cache_key_append(&key_a, bytes, 4);
+  iree_hal_resource_cache_key_append(&key_a, bytes + 4, 4);
+  iree_hal_resource_cache_key_t key_b;
+  iree_hal_resource_cache_key_initialize(
+      IREE_HAL_RESOURCE_CACHE_TYPE_PIPELINE_LAYOUT, &key_b);
+  iree_hal_resource_cache_key_append(&key_b, bytes, 8);
+  iree_hal_resource_cache_key_t key_c;
+  iree_hal_resource_cache_key_initialize(IREE_HAL_RESOURCE_CACHE_TYPE_BUFFER,
+                                         &key_c);
+  iree_hal_resource_cache_key_append(&key_c, bytes, 8);
+  iree_hal_resource_t* resource_a = Insert(key_a, &pins);
+  iree_hal_resource_t* resource_b = Insert(key_b, &pins);
+  iree_hal_resource_t* resource_c = Insert(key_c, &pins);
+  EXPECT_NE(resource_a, resource_b);
+  EXPECT_NE(resource_b, resource_c);
+
+  // Identical contents at different addresses are different identities.
+  uint8_t copy[8];
+  memcpy(copy, bytes, sizeof(copy));
+  iree_hal_resource_cache_key_t key_d;
+  iree_hal_resource_cache_key_initialize(IREE_HAL_RESOURCE_CACHE_TYPE_BUFFER,
+                                         &key_d);
+  iree_hal_resource_cache_key_append_identity(
+      &key_d, iree_make_const_byte_span(bytes, sizeof(bytes)));
+  iree_hal_resource_cache_key_t key_e;
+  iree_hal_resource_cache_key_initialize(IREE_HAL_RESOURCE_CACHE_TYPE_BUFFER,
+                                         &key_e);
+  iree_hal_resource_cache_key_append_identity(
+      &key_e, iree_make_const_byte_span(copy, sizeof(copy)));
+  iree_hal_resource_t* resource_d = Insert(key_d, &pins);
+  iree_hal_resource_t* resource_e = Insert(key_e, &pins);
+  EXPECT_NE(resource_d, resource_e);
+
+  for (iree_hal_resource_t* resource : resources) {
+    iree_hal_resource_release(resource);
+  }
+  iree_hal_resource_release(resource_a);
+  iree_hal_resource_release(resource_b);
+  iree_hal_resource_release(resource_c);
+  iree_hal_resource_release(resource_d);
+  iree_hal_resource_release(resource_e);
+  iree_hal_resource_cache_unpin(cache, &pins);
+  EXPECT_EQ(0, iree_hal_resource_cache_count(cache));
+}
+
+// Keys exceeding the capacity are never shared.
+TEST_F(ResourceCacheTest, OversizedKeysNotShared) {
+  std::vector<uint8_t> bytes(IREE_HAL_RESOURCE_CACHE_KEY_CAPACITY);
+  iree_hal_resource_cache_key_t key;
+  iree_hal_resource_cache_key_initialize(
+      IREE_HAL_RESOURCE_CACHE_TYPE_PIPELINE_LAYOUT, &key);
+  iree_hal_resource_cache_key_append(&key, bytes.data(), bytes.size());
+
+  iree_hal_resource_cache_pins_t pins = {0};
+  iree_hal_resource_t* resource_a = Insert(key, &pins);
+  iree_hal_resource_t* resource_b = Insert(key, &pins);
+  EXPECT_NE(resource_a, resource_b);
+  EXPECT_EQ(0, iree_hal_resource_cache_count(cache));
+  EXPECT_EQ(nullptr, Lookup(key, &pins));
+
+  iree_hal_resource_release(resource_a);
+  iree_hal_resource_release(resource_b);
+  iree_hal_resource_cache_unpin(cache, &pins);
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
@@ -25,14 +25,40 @@ extern "C" {
 // iree_task_affinity_set_t
 //===----------------------------------------------------------------------===//
 
+// A set of workers within a single worker cluster.
+// Executors partition their workers by index into clusters of
+// IREE_TASK_EXECUTOR_CLUSTER_WORKER_COUNT workers and track each cluster with
+// its own sets; bit N of a cluster's set refers to worker
+// (cluster_index * IREE_TASK_EXECUTOR_CLUSTER_WORKER_COUNT + N).
+//
+// Task affinity sets are applied to every cluster: a task allowed on bit N may
+// run on worker N of any cluster.
 typedef uint64_t iree_task_affinity_set_t;
 
+static_assert(IREE_TASK_EXECUTOR_CLUSTER_WORKER_COUNT ==
+                  8 * sizeof(iree_task_affinity_set_t),
+              "worker clusters must match the affinity set bit count");
+
+// Returns the index of the worker cluster containing |worker_index|.
+static inline iree_host_size_t iree_task_affinity_cluster_for_worker(
+    iree_host_size_t worker_index) {
+  return worker_index / IREE_TASK_EXECUTOR_CLUSTER_WORKER_COUNT;
+}
+
 // Allows for only a specific worker to be selected.
+// |worker_index| is the index of the worker within its cluster.
 static inline iree_task_affinity_set_t iree_task_affinity_for_worker(
     uint8_t worker_index) {
   return 1ull << worker_index;
 }
 
+// Returns the bit for the executor-local |worker_index| within its cluster.
+static inline iree_task_affinity_set_t iree_task_affinity_bit_for_worker(
+    iree_host_size_t worker_index) {
+  return iree_task_affinity_for_worker(
+      (uint8_t)(worker_index % IREE_TASK_EXECUTOR_CLUSTER_WORKER_COUNT));
+}
+
 // Allows for a range of workers to be selected.
 static inline iree_task_affinity_set_t iree_task_affinity_for_worker_range(
     uint8_t worker_start, uint8_t worker_end) {
@@ -51,6 +77,23 @@ static inline iree_task_affinity_set_t iree_task_affinity_for_any_worker(void) {
 #define iree_task_affinity_set_count_ones iree_math_count_ones_u64
 #define iree_task_affinity_set_rotr iree_math_rotr_u64
 
+// Returns the number of workers in an executor with |worker_count| workers that
+// |affinity_set| allows, with the set applied to every cluster.
+static inline iree_host_size_t iree_task_affinity_set_count_workers(
+    iree_task_affinity_set_t affinity_set, iree_host_size_t worker_count) {
+  iree_host_size_t full_cluster_count =
+      worker_count / IREE_TASK_EXECUTOR_CLUSTER_WORKER_COUNT;
+  iree_host_size_t tail_worker_count =
+      worker_count % IREE_TASK_EXECUTOR_CLUSTER_WORKER_COUNT;
+  iree_host_size_t count =
+      full_cluster_count * iree_task_affinity_set_count_ones(affinity_set);
+  if (tail_worker_count) {
+    count += iree_task_affinity_set_count_ones(
+        affinity_set & ((1ull << tail_worker_count) - 1));
+  }
+  return count;
+}
+
 //===----------------------------------------------------------------------===//
 // iree_atomic_task_affinity_set_t
 //===----------------------------------------------------------------------===//
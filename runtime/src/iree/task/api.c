@@ -38,12 +38,11 @@ IREE_FLAG(
 // TODO(benvanik): enable this when we use it - though hopefully we don't!
 IREE_FLAG(
     int32_t, task_worker_local_memory, 0,  // 64 * 1024,
-    "Specifies the bytes of per-worker local memory allocated for use by\n"
-    "dispatched tiles. Tiles may use less than this but will fail to dispatch\n"
-    "if they require more. Conceptually it is like a stack reservation and\n"
-    "should be treated the same way: the source programs must be built to\n"
-    "only use a specific maximum amount of local memory and the runtime must\n"
-    "be configured to make at least that amount of local memory available.");
+    "Specifies the bytes of per-worker local memory reserved up-front for use\n"
+    "by dispatched tiles. Dispatches requiring more grow a per-worker arena\n"
+    "the first time they run on each worker and the arena is retained for\n"
+    "reuse by subsequent dispatches. Reserving the maximum amount expected to\n"
+    "be used by the program avoids allocations during execution.");
 
 iree_status_t iree_task_executor_options_initialize_from_flags(
     iree_task_executor_options_t* out_options) {
@@ -235,11 +234,14 @@ static iree_status_t iree_task_flags_dump_task_topologies(
       } else {
         fprintf(stdout, "%d group(s): ",
                 iree_math_count_ones_u64(group->constructive_sharing_mask));
+        iree_host_size_t cluster_base =
+            iree_task_affinity_cluster_for_worker(j) *
+            IREE_TASK_EXECUTOR_CLUSTER_WORKER_COUNT;
         for (iree_host_size_t ic = 0, jc = 0;
              ic < IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT; ++ic) {
           if ((group->constructive_sharing_mask >> ic) & 1) {
             if (jc > 0) fprintf(stdout, ", ");
-            fprintf(stdout, "%" PRIhsz, ic);
+            fprintf(stdout, "%" PRIhsz, cluster_base + ic);
             ++jc;
           }
         }
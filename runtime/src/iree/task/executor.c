@@ -10,6 +10,7 @@
 #include <stddef.h>
 #include <string.h>
 
+#include "iree/base/internal/cpu.h"
 #include "iree/base/internal/math.h"
 #include "iree/base/tracing.h"
 #include "iree/task/affinity_set.h"
@@ -78,8 +79,13 @@ iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
   executor->allocator = allocator;
   executor->scheduling_mode = options.scheduling_mode;
   executor->worker_spin_ns = options.worker_spin_ns;
-  iree_atomic_task_slist_initialize(&executor->incoming_ready_slist);
-  iree_slim_mutex_initialize(&executor->coordinator_mutex);
+  executor->coordinator_shard_count =
+      (worker_count + IREE_TASK_EXECUTOR_COORDINATOR_SHARD_WORKER_COUNT - 1) /
+      IREE_TASK_EXECUTOR_COORDINATOR_SHARD_WORKER_COUNT;
+  for (iree_host_size_t i = 0; i < executor->coordinator_shard_count; ++i) {
+    iree_atomic_task_slist_initialize(
+        &executor->coordinator_shards[i].incoming_ready_slist);
+  }
 
   // Simple PRNG used to generate seeds for the per-worker PRNGs used to
   // distribute work. This isn't strong (and doesn't need to be); it's just
@@ -114,6 +120,12 @@ iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
         &executor->transient_task_pool);
   }
 
+  // Blocks for the worker local memory arenas are only allocated when a
+  // dispatch requires more than the up-front worker_local_memory_size.
+  iree_arena_block_pool_initialize(IREE_TASK_EXECUTOR_LOCAL_MEMORY_BLOCK_SIZE,
+                                   allocator,
+                                   &executor->local_memory_block_pool);
+
   // Wait handling polling and waiting use a dedicated thread to ensure that
   // blocking syscalls stay off the workers.
   if (iree_status_is_ok(status)) {
@@ -135,13 +147,9 @@ iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
     uint8_t* worker_local_memory =
         (uint8_t*)executor->workers + worker_list_size;
 
-    iree_task_affinity_set_t worker_idle_mask = 0;
-    iree_task_affinity_set_t worker_live_mask = 0;
+    executor->cluster_count =
+        iree_task_affinity_cluster_for_worker(worker_count - 1) + 1;
     for (iree_host_size_t i = 0; i < worker_count; ++i) {
-      iree_task_affinity_set_t worker_bit = iree_task_affinity_for_worker(i);
-      worker_idle_mask |= worker_bit;
-      worker_live_mask |= worker_bit;
-
       iree_task_worker_t* worker = &executor->workers[i];
       status = iree_task_worker_initialize(
           executor, i, iree_task_topology_get_group(topology, i),
@@ -152,13 +160,24 @@ iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
       worker_local_memory += options.worker_local_memory_size;
       if (!iree_status_is_ok(status)) break;
     }
-    // The masks are accessed with 'relaxed' order because they are just hints.
-    iree_atomic_task_affinity_set_store(&executor->worker_idle_mask,
-                                        worker_idle_mask,
-                                        iree_memory_order_relaxed);
-    iree_atomic_task_affinity_set_store(&executor->worker_live_mask,
-                                        worker_live_mask,
-                                        iree_memory_order_relaxed);
+    for (iree_host_size_t i = 0; i < executor->cluster_count; ++i) {
+      iree_host_size_t cluster_worker_count =
+          iree_min(worker_count - i * IREE_TASK_EXECUTOR_CLUSTER_WORKER_COUNT,
+                   IREE_TASK_EXECUTOR_CLUSTER_WORKER_COUNT);
+      iree_task_affinity_set_t worker_mask =
+          cluster_worker_count == IREE_TASK_EXECUTOR_CLUSTER_WORKER_COUNT
+              ? iree_task_affinity_for_any_worker()
+              : iree_task_affinity_for_worker(cluster_worker_count) - 1;
+      // The masks are accessed with 'relaxed' order because they are just
+      // hints.
+      iree_task_worker_cluster_t* cluster = &executor->clusters[i];
+      iree_atomic_task_affinity_set_store(&cluster->worker_idle_mask,
+                                          worker_mask,
+                                          iree_memory_order_relaxed);
+      iree_atomic_task_affinity_set_store(&cluster->worker_live_mask,
+                                          worker_mask,
+                                          iree_memory_order_relaxed);
+    }
   }
 
   if (!iree_status_is_ok(status)) {
@@ -207,9 +226,12 @@ static void iree_task_executor_destroy(iree_task_executor_t* executor) {
   }
   iree_task_poller_deinitialize(&executor->poller);
 
+  iree_arena_block_pool_deinitialize(&executor->local_memory_block_pool);
   iree_event_pool_free(executor->event_pool);
-  iree_slim_mutex_deinitialize(&executor->coordinator_mutex);
-  iree_atomic_task_slist_deinitialize(&executor->incoming_ready_slist);
+  for (iree_host_size_t i = 0; i < executor->coordinator_shard_count; ++i) {
+    iree_atomic_task_slist_deinitialize(
+        &executor->coordinator_shards[i].incoming_ready_slist);
+  }
   iree_task_pool_deinitialize(&executor->transient_task_pool);
   iree_allocator_free(executor->allocator, executor);
 
@@ -235,6 +257,10 @@ void iree_task_executor_trim(iree_task_executor_t* executor) {
   // on submit - or rework pools to not have this limitation.
   // iree_task_pool_trim(&executor->fence_task_pool);
   // iree_task_pool_trim(&executor->transient_task_pool);
+
+  // Only blocks not retained by any worker arena are freed so this is safe to
+  // perform while dispatches are in-flight.
+  iree_arena_block_pool_trim(&executor->local_memory_block_pool);
 }
 
 iree_host_size_t iree_task_executor_worker_count(
@@ -262,11 +288,34 @@ iree_status_t iree_task_executor_acquire_fence(iree_task_executor_t* executor,
   return iree_ok_status();
 }
 
+void iree_task_executor_query_priority_statistics(
+    iree_task_executor_t* executor, iree_task_priority_class_t priority_class,
+    iree_task_executor_priority_statistics_t* out_statistics) {
+  memset(out_statistics, 0, sizeof(*out_statistics));
+  if (priority_class >= IREE_TASK_PRIORITY_CLASS_COUNT) return;
+  for (iree_host_size_t i = 0; i < executor->worker_count; ++i) {
+    iree_task_worker_t* worker = &executor->workers[i];
+    out_statistics->task_count += iree_atomic_load_int64(
+        &worker->priority_counters[priority_class].task_count,
+        iree_memory_order_relaxed);
+    out_statistics->busy_time_ns += iree_atomic_load_int64(
+        &worker->priority_counters[priority_class].busy_time_ns,
+        iree_memory_order_relaxed);
+    out_statistics->preemption_count += iree_atomic_load_int64(
+        &worker->priority_counters[priority_class].preemption_count,
+        iree_memory_order_relaxed);
+    out_statistics->starvation_count += iree_atomic_load_int64(
+        &worker->priority_counters[priority_class].starvation_count,
+        iree_memory_order_relaxed);
+  }
+}
+
 // Schedules a generic task to a worker matching its affinity.
 // The task will be posted to the worker mailbox and available for the worker to
 // begin processing as soon as the |post_batch| is submitted.
 //
-// Only called during coordination and expects the coordinator lock to be held.
+// |post_batch| is owned by the calling thread so no synchronization is needed
+// beyond the atomic worker masks consulted for selection.
 static void iree_task_executor_relay_to_worker(
     iree_task_executor_t* executor, iree_task_post_batch_t* post_batch,
     iree_task_t* task) {
@@ -285,7 +334,8 @@ static void iree_task_executor_relay_to_worker(
 // least recently added tasks from the submission (nice in-order traversal) we
 // are pushing them as what will become the least recent tasks in the batch.
 //
-// Only called during coordination and expects the coordinator lock to be held.
+// Called by the thread coordinating a coordinator shard with that shard's
+// flushed ready list. Other shards may be scheduled concurrently.
 void iree_task_executor_schedule_ready_tasks(
     iree_task_executor_t* executor, iree_task_submission_t* pending_submission,
     iree_task_post_batch_t* post_batch) {
@@ -358,14 +408,23 @@ void iree_task_executor_schedule_ready_tasks(
 }
 
 void iree_task_executor_merge_submission(iree_task_executor_t* executor,
+                                         iree_host_size_t shard_index,
                                          iree_task_submission_t* submission) {
+  iree_task_coordinator_shard_t* shard =
+      &executor->coordinator_shards[shard_index];
+
   // Concatenate all of the incoming tasks into the submission list.
   // Note that the submission stores tasks in LIFO order such that when they are
   // put into the LIFO atomic slist they match the order across all concats
   // (earlier concats are later in the LIFO list).
-  iree_atomic_task_slist_concat(&executor->incoming_ready_slist,
-                                submission->ready_list.head,
-                                submission->ready_list.tail);
+  if (!iree_task_list_is_empty(&submission->ready_list)) {
+    iree_atomic_task_slist_concat(&shard->incoming_ready_slist,
+                                  submission->ready_list.head,
+                                  submission->ready_list.tail);
+    // Flag the shard only after the tasks are in the list so that whoever
+    // consumes the flag is guaranteed to find them.
+    iree_atomic_store_int32(&shard->pending, 1, iree_memory_order_seq_cst);
+  }
 
   // Enqueue waiting tasks with the poller immediately: this may issue a
   // syscall to kick the poller. If we see bad context switches here then we
@@ -378,12 +437,24 @@ void iree_task_executor_merge_submission(iree_task_executor_t* executor,
   iree_task_submission_reset(submission);
 }
 
+// Returns the coordinator shard used by the calling non-worker thread.
+// Threads running on nearby processors share a shard; a thread migrating
+// between submitting and flushing is fine as flushes visit all shards.
+static iree_host_size_t iree_task_executor_select_caller_shard(
+    iree_task_executor_t* executor) {
+  if (executor->coordinator_shard_count == 1) return 0;
+  return (iree_cpu_query_processor_id() /
+          IREE_TASK_EXECUTOR_COORDINATOR_SHARD_WORKER_COUNT) %
+         executor->coordinator_shard_count;
+}
+
 void iree_task_executor_submit(iree_task_executor_t* executor,
                                iree_task_submission_t* submission) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  // Concatenate the submitted tasks onto our primary LIFO incoming lists.
-  iree_task_executor_merge_submission(executor, submission);
+  // Concatenate the submitted tasks onto the incoming LIFO list of our shard.
+  iree_task_executor_merge_submission(
+      executor, iree_task_executor_select_caller_shard(executor), submission);
 
   IREE_TRACE_ZONE_END(z0);
 }
@@ -399,39 +470,33 @@ void iree_task_executor_flush(iree_task_executor_t* executor) {
   IREE_TRACE_ZONE_END(z0);
 }
 
-// Dispatches tasks in the global submission queue to workers.
-// This is called by users upon submission of new tasks or by workers when they
-// run out of tasks to process. If |current_worker| is provided then tasks will
-// prefer to be routed back to it for immediate processing.
-//
-// If a coordination run ends up with no ready tasks and |current_worker| is
-// provided the calling thread will enter a wait until the worker has more tasks
-// posted to it.
-void iree_task_executor_coordinate(iree_task_executor_t* executor,
-                                   iree_task_worker_t* current_worker) {
-  IREE_TRACE_ZONE_BEGIN(z0);
+// Dispatches the tasks in the incoming queue of |shard| to workers.
+// Returns immediately if the shard has no pending work or another thread is
+// already coordinating it. In the latter case that thread re-checks the shard
+// after it stops coordinating and will pick up any work merged before this call
+// so nothing is lost by leaving.
+static void iree_task_executor_coordinate_shard(
+    iree_task_executor_t* executor, iree_task_coordinator_shard_t* shard,
+    iree_task_worker_t* current_worker, iree_task_post_batch_t* post_batch) {
+  // The pending/coordinating accesses are sequentially consistent so that a
+  // thread that fails to take the shard after raising pending is ordered
+  // before the holder's re-check of pending after releasing the shard.
+  while (iree_atomic_load_int32(&shard->pending, iree_memory_order_seq_cst)) {
+    if (iree_atomic_exchange_int32(&shard->coordinating, 1,
+                                   iree_memory_order_seq_cst) != 0) {
+      break;  // another thread is coordinating the shard
+    }
+    IREE_TRACE_ZONE_BEGIN_NAMED(z0, "iree_task_executor_coordinate_shard");
 
-  // We may be adding tasks/waiting/etc on each pass through coordination - to
-  // ensure we completely drain the incoming queues and satisfied waits we loop
-  // until there's nothing left to coordinate.
-  bool schedule_dirty = true;
-  do {
-    IREE_TRACE_ZONE_BEGIN_NAMED(z1, "iree_task_executor_coordinate_try");
-    // TODO(#10212): remove this lock or do something more clever to avoid
-    // contention when many workers try to coordinate at the same time. This can
-    // create very long serialized lock chains that slow down worker wakes.
-    iree_slim_mutex_lock(&executor->coordinator_mutex);
+    // Consume the pending flag before flushing: any tasks merged after this
+    // point raise it again and cause another pass.
+    iree_atomic_exchange_int32(&shard->pending, 0, iree_memory_order_seq_cst);
 
     // Check for incoming submissions and move their posted tasks into our
     // local lists. Any of the tasks here are ready to execute immediately and
     // ones we should be able to distribute to workers without delay. The
     // waiting tasks are to the best of the caller's knowledge not ready yet.
     //
-    // Note that we only do this once per coordination; that's so we don't
-    // starve if submissions come in faster than we can schedule them.
-    // Coordination will run again when workers become idle and will pick up
-    // any changes then.
-    //
     // As we schedule tasks we may spawn new ones (like a dispatch -> many
     // dispatch shards) and we keep track of those here. By doing a pass through
     // all ready tasks and only then merging in the new submission we get
@@ -440,53 +505,81 @@ void iree_task_executor_coordinate(iree_task_executor_t* executor,
     // latency.
     iree_task_submission_t pending_submission;
     iree_task_submission_initialize_from_lifo_slist(
-        &executor->incoming_ready_slist, &pending_submission);
-    if (iree_task_list_is_empty(&pending_submission.ready_list)) {
-      iree_slim_mutex_unlock(&executor->coordinator_mutex);
-      IREE_TRACE_ZONE_END(z1);
-      break;
+        &shard->incoming_ready_slist, &pending_submission);
+    const bool has_tasks =
+        !iree_task_list_is_empty(&pending_submission.ready_list);
+    if (has_tasks) {
+      iree_task_post_batch_initialize(executor, current_worker, post_batch);
+
+      // Schedule all ready tasks in this batch. Some may complete inline (such
+      // as ready barriers with all their dependencies resolved) while others
+      // may be scheduled on workers via the post batch.
+      iree_task_executor_schedule_ready_tasks(executor, &pending_submission,
+                                              post_batch);
+
+      // Route waiting tasks to the poller.
+      iree_task_poller_enqueue(&executor->poller,
+                               &pending_submission.waiting_list);
     }
 
-    // Scratch coordinator submission batch used during scheduling to batch up
-    // all tasks that will be posted to each worker. We could stash this on the
-    // executor but given that which thread is playing the role of the
-    // coordinator is random it's better to ensure that these bytes never incur
-    // a cache miss by making them live here in the stack of the chosen thread.
-    iree_task_post_batch_t* post_batch =
-        iree_alloca(sizeof(iree_task_post_batch_t) +
-                    executor->worker_count * sizeof(iree_task_list_t));
-    iree_task_post_batch_initialize(executor, current_worker, post_batch);
-
-    // Schedule all ready tasks in this batch. Some may complete inline (such
-    // as ready barriers with all their dependencies resolved) while others may
-    // be scheduled on workers via the post batch.
-    iree_task_executor_schedule_ready_tasks(executor, &pending_submission,
-                                            post_batch);
-
-    // Route waiting tasks to the poller.
-    iree_task_poller_enqueue(&executor->poller,
-                             &pending_submission.waiting_list);
-
-    iree_slim_mutex_unlock(&executor->coordinator_mutex);
-    IREE_TRACE_ZONE_END(z1);
+    iree_atomic_store_int32(&shard->coordinating, 0, iree_memory_order_seq_cst);
 
     // Post all new work to workers; they may wake and begin executing
-    // immediately. Returns whether this worker has new tasks for it to work on.
-    schedule_dirty = iree_task_post_batch_submit(post_batch);
-  } while (schedule_dirty);
+    // immediately. Another thread may already be coordinating the shard again.
+    if (has_tasks) iree_task_post_batch_submit(post_batch);
+
+    IREE_TRACE_ZONE_END(z0);
+  }
+}
+
+// Dispatches tasks in the incoming queues to workers.
+// This is called by users upon submission of new tasks or by workers when they
+// run out of tasks to process. If |current_worker| is provided then tasks will
+// prefer to be routed back to it for immediate processing.
+//
+// Only one thread at a time coordinates a particular shard but threads never
+// wait on each other: if a shard is busy its current coordinator handles any
+// work that was merged into it. The calling thread coordinates its own shard
+// first and then makes a pass over the others so that work merged into shards
+// without active submitters or idle workers still makes progress.
+void iree_task_executor_coordinate(iree_task_executor_t* executor,
+                                   iree_task_worker_t* current_worker) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  const iree_host_size_t home_shard_index =
+      current_worker ? current_worker->coordinator_shard_index
+                     : iree_task_executor_select_caller_shard(executor);
+
+  // Scratch coordinator submission batch used during scheduling to batch up
+  // all tasks that will be posted to each worker. We could stash this on the
+  // executor but given that which thread is playing the role of the
+  // coordinator is random it's better to ensure that these bytes never incur
+  // a cache miss by making them live here in the stack of the chosen thread.
+  iree_task_post_batch_t* post_batch =
+      iree_alloca(sizeof(iree_task_post_batch_t) +
+                  executor->worker_count * sizeof(iree_task_list_t));
+
+  for (iree_host_size_t i = 0; i < executor->coordinator_shard_count; ++i) {
+    iree_host_size_t shard_index =
+        (home_shard_index + i) % executor->coordinator_shard_count;
+    iree_task_executor_coordinate_shard(
+        executor, &executor->coordinator_shards[shard_index], current_worker,
+        post_batch);
+  }
 
   IREE_TRACE_ZONE_END(z0);
 }
 
 static iree_task_t* iree_task_executor_try_steal_task_from_affinity_set(
-    iree_task_executor_t* executor, iree_task_affinity_set_t victim_mask,
-    uint32_t max_theft_attempts, int rotation_offset,
-    iree_task_queue_t* local_task_queue) {
+    iree_task_executor_t* executor, iree_host_size_t cluster_index,
+    iree_task_affinity_set_t victim_mask, uint32_t max_theft_attempts,
+    int rotation_offset, iree_task_queue_t* local_task_queues) {
   if (!victim_mask) return NULL;
   max_theft_attempts = iree_min(max_theft_attempts,
                                 iree_task_affinity_set_count_ones(victim_mask));
-  victim_mask = iree_task_affinity_set_rotr(victim_mask, rotation_offset);
 
+  iree_host_size_t cluster_base =
+      cluster_index * IREE_TASK_EXECUTOR_CLUSTER_WORKER_COUNT;
   int worker_index = rotation_offset;
   iree_task_affinity_set_t mask =
       iree_task_affinity_set_rotr(victim_mask, worker_index);
@@ -503,7 +596,9 @@ static iree_task_t* iree_task_executor_try_steal_task_from_affinity_set(
     //            mask >>= 1 = 0b01010101
     //            victim_index = 4 % 64 = 4
     int offset = iree_task_affinity_set_count_trailing_zeros(mask);
-    int victim_index = (worker_index + offset) % executor->worker_count;
+    iree_host_size_t victim_index =
+        cluster_base +
+        (worker_index + offset) % IREE_TASK_EXECUTOR_CLUSTER_WORKER_COUNT;
     worker_index += offset + 1;
     mask = iree_shr(mask, offset + 1);
     iree_task_worker_t* victim_worker = &executor->workers[victim_index];
@@ -520,7 +615,7 @@ static iree_task_t* iree_task_executor_try_steal_task_from_affinity_set(
     // thievery taking ~half of the tasks each time (across all queues) will
     // lead to a relatively even distribution.
     iree_task_t* task = iree_task_worker_try_steal_task(
-        victim_worker, local_task_queue,
+        victim_worker, local_task_queues,
         /*max_tasks=*/IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT);
     if (task) return task;
   }
@@ -529,14 +624,32 @@ static iree_task_t* iree_task_executor_try_steal_task_from_affinity_set(
   return NULL;
 }
 
+// Returns a mask of the workers in |cluster_index| that are worth stealing
+// from: those that are currently live and not idle.
+static iree_task_affinity_set_t iree_task_executor_query_victim_mask(
+    iree_task_executor_t* executor, iree_host_size_t cluster_index) {
+  // The masks are accessed with 'relaxed' order because they are just hints.
+  iree_task_worker_cluster_t* cluster = &executor->clusters[cluster_index];
+  iree_task_affinity_set_t worker_live_mask =
+      iree_atomic_task_affinity_set_load(&cluster->worker_live_mask,
+                                         iree_memory_order_relaxed);
+  iree_task_affinity_set_t worker_idle_mask =
+      iree_atomic_task_affinity_set_load(&cluster->worker_idle_mask,
+                                         iree_memory_order_relaxed);
+  return worker_live_mask & ~worker_idle_mask;
+}
+
 // Tries to steal an entire task from a sibling worker (based on topology).
 // Returns a task that is available (has not yet begun processing at all).
-// May steal multiple tasks and add them to the |local_task_queue|.
+// May steal multiple tasks and add them to the |local_task_queues| entry of
+// their priority class.
 //
 // We do a scan through ideal victims indicated by the
 // |constructive_sharing_mask|; these are the workers most likely to have some
 // cache benefits to taking their work as they share some level of the cache
-// hierarchy and should be better to steal from than any random worker.
+// hierarchy and should be better to steal from than any random worker. The
+// remaining workers in the thief's cluster are tried next and only then are
+// the other clusters scanned, starting with the one after the thief's own.
 //
 // To prevent biasing any particular victim we use a fast prng function to
 // select where in the set of potential victims defined by the topology
@@ -544,22 +657,16 @@ static iree_task_t* iree_task_executor_try_steal_task_from_affinity_set(
 // instead of bouncing around at random we just select the starting point in
 // our search and then go in-order.
 iree_task_t* iree_task_executor_try_steal_task(
-    iree_task_executor_t* executor,
+    iree_task_executor_t* executor, iree_host_size_t cluster_index,
     iree_task_affinity_set_t constructive_sharing_mask,
     uint32_t max_theft_attempts, iree_prng_minilcg128_state_t* theft_prng,
-    iree_task_queue_t* local_task_queue) {
+    iree_task_queue_t* local_task_queues) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  // The masks are accessed with 'relaxed' order because they are just hints.
-  iree_task_affinity_set_t worker_live_mask =
-      iree_atomic_task_affinity_set_load(&executor->worker_live_mask,
-                                         iree_memory_order_relaxed);
-  iree_task_affinity_set_t worker_idle_mask =
-      iree_atomic_task_affinity_set_load(&executor->worker_idle_mask,
-                                         iree_memory_order_relaxed);
   // Limit the workers we will steal from to the ones that are currently live
   // and not idle.
-  iree_task_affinity_set_t victim_mask = worker_live_mask & ~worker_idle_mask;
+  iree_task_affinity_set_t victim_mask =
+      iree_task_executor_query_victim_mask(executor, cluster_index);
 
   // TODO(benvanik): it may be possible to rework this such that we better
   // use the prng; for example, instead of all this rotating stuff we could just
@@ -574,19 +681,33 @@ iree_task_t* iree_task_executor_try_steal_task(
   // that we won't need to go back to main memory (or higher cache tiers) in the
   // event that the thief and victim are running close to each other in time.
   iree_task_t* task = iree_task_executor_try_steal_task_from_affinity_set(
-      executor, victim_mask & constructive_sharing_mask, max_theft_attempts,
-      rotation_offset, local_task_queue);
+      executor, cluster_index, victim_mask & constructive_sharing_mask,
+      max_theft_attempts, rotation_offset, local_task_queues);
   if (task) {
     IREE_TRACE_ZONE_APPEND_TEXT(z0, "local");
   } else {
     task = iree_task_executor_try_steal_task_from_affinity_set(
-        executor, victim_mask & ~constructive_sharing_mask, max_theft_attempts,
-        rotation_offset, local_task_queue);
+        executor, cluster_index, victim_mask & ~constructive_sharing_mask,
+        max_theft_attempts, rotation_offset, local_task_queues);
     if (task) {
       IREE_TRACE_ZONE_APPEND_TEXT(z0, "non-local");
     }
   }
 
+  // Fall back to the other clusters. Each is only touched if it has a worker
+  // that may have tasks so that idle clusters cost a single relaxed load.
+  for (iree_host_size_t i = 1; !task && i < executor->cluster_count; ++i) {
+    iree_host_size_t victim_cluster_index =
+        (cluster_index + i) % executor->cluster_count;
+    task = iree_task_executor_try_steal_task_from_affinity_set(
+        executor, victim_cluster_index,
+        iree_task_executor_query_victim_mask(executor, victim_cluster_index),
+        max_theft_attempts, rotation_offset, local_task_queues);
+    if (task) {
+      IREE_TRACE_ZONE_APPEND_TEXT(z0, "remote");
+    }
+  }
+
   IREE_TRACE_ZONE_END(z0);
   return task;
 }
@@ -63,7 +63,8 @@ extern "C" {
 //   - power islands on multi-core systems with fine-grained power management
 //   - heterogenous microarchitectures in big.LITTLE/etc compute complexes
 //   - task isolation between multiple active requests or users
-//   - latency prioritization by partitioning workloads by priority
+//   - latency prioritization by partitioning workloads by priority (see
+//     iree_task_priority_class_t)
 // - scheduling overhead tradeoffs by varying:
 //   - coordination/flush frequency to reduce cross-thread communication
 //   - by statically inserting dispatch shards to avoid dynamic fan-out
@@ -113,14 +114,19 @@ extern "C" {
 //      as iree_wait_handle_t then it is placed into the waiting_list.
 //
 // 2. iree_task_executor_submit (LIFO, atomic slist)
-//    Submissions have their task thread-local lists concatenated into a LIFO
-//    incoming_ready_slist or the wait poller shared by the executor.
+//    Submissions have their task thread-local lists concatenated into the LIFO
+//    incoming_ready_slist of the coordinator shard of the submitting thread or
+//    the wait poller shared by the executor. Workers and threads running on
+//    nearby processors share a shard.
 //
 // 3. iree_task_executor_flush (or a worker puts on its coordinator hat 🎩)
+//    Each shard is coordinated by at most one thread at a time. Threads
+//    finding their shard busy leave their work to its current coordinator
+//    instead of waiting and all shards are visited so none is left pending.
 //
 //   a. Tasks are flushed from the incoming_ready_slist into a coordinator-local
-//      FIFO task queue. This centralizes enqueuing from all threads into a
-//      single ordered list.
+//      FIFO task queue. This centralizes enqueuing from all threads sharing
+//      the shard into a single ordered list.
 //
 //   b. iree_task_executor_schedule_ready_tasks: walks the FIFO task queue and
 //      builds a iree_task_post_batch_t containing the per-worker tasks
@@ -135,24 +141,27 @@ extern "C" {
 //    each worker will check its mailbox_slist to see if any tasks have been
 //    posted.
 //
-//    a. Tasks are flushed from the LIFO mailbox into the local_task_queue FIFO
-//       for the particular worker.
+//    a. Tasks are flushed from the LIFO mailbox into the local_task_queues
+//       FIFOs of the particular worker, one per priority class.
 //
 //    b. If the mailbox is empty the worker *may* attempt to steal work from
 //       another nearby worker in the topology.
 //
-//    c. Any tasks in the local_task_queue are executed until empty.
+//    c. Any tasks in the local_task_queues are executed until empty, most
+//       important class first. Dispatch shards check between tiles whether
+//       more important tasks have been posted to the mailbox and yield to them
+//       by returning to the front of their queue.
 //       Tasks are retired and dependent tasks (via completion_task or barriers)
-//       are made ready and placed in the executor incoming_ready_slist as with
-//       iree_task_executor_submit.
+//       are made ready and placed in the incoming_ready_slist of the worker
+//       coordinator shard as with iree_task_executor_submit.
 //
 //    d. If no more thread-local work is available and the mailbox_slist is
 //       empty the worker will self-nominate for coordination and attempt to don
 //       the coordinator hat with iree_task_executor_coordinate. If new work
 //       becomes available after coordination step 5 repeats.
 //
-//    e. If another worker (or iree_task_executor_flush) is already wearing the
-//       coordinator hat then the worker will go to sleep.
+//    e. If other workers (or iree_task_executor_flush) are already wearing the
+//       coordinator hats then the worker will go to sleep.
 //
 //==============================================================================
 // Scaling Down
@@ -297,10 +306,11 @@ typedef struct iree_task_executor_options_t {
   iree_host_size_t worker_stack_size;
 
   // Defines the bytes to be allocated and reserved by each worker to use for
-  // local memory operations. Will be rounded up to the next power of two.
-  // Dispatches performed will be able to request up to this amount of memory
-  // for their invocations and no more. May be 0 if no worker local memory is
-  // required.
+  // local memory operations. Will be rounded up to the destructive
+  // interference size. Dispatches requiring more than this amount of memory
+  // grow a per-worker arena on demand that is retained for reuse by subsequent
+  // dispatches. May be 0 if no worker local memory should be reserved
+  // up-front.
   iree_host_size_t worker_local_memory_size;
 } iree_task_executor_options_t;
 
@@ -347,6 +357,31 @@ iree_status_t iree_task_executor_acquire_fence(iree_task_executor_t* executor,
                                                iree_task_scope_t* scope,
                                                iree_task_fence_t** out_fence);
 
+// Counters for the tasks of a single priority class aggregated across all
+// workers of an executor. Values increase monotonically over the lifetime of
+// the executor; utilization over an interval can be derived from the deltas of
+// two queries.
+typedef struct iree_task_executor_priority_statistics_t {
+  // Total number of tasks executed by workers. Dispatch shards that yielded
+  // are counted each time they execute.
+  // Always 0 unless IREE_TASK_WORKER_BUSY_STATISTICS_ENABLE is set.
+  int64_t task_count;
+  // Total time in nanoseconds workers spent executing tasks.
+  // Always 0 unless IREE_TASK_WORKER_BUSY_STATISTICS_ENABLE is set.
+  int64_t busy_time_ns;
+  // Number of times dispatch shards yielded to more important work.
+  int64_t preemption_count;
+  // Number of times tasks were run ahead of more important work in order to
+  // prevent starvation.
+  int64_t starvation_count;
+} iree_task_executor_priority_statistics_t;
+
+// Queries the counters of |priority_class| across all workers.
+// Counters of in-flight work may be slightly out of date.
+void iree_task_executor_query_priority_statistics(
+    iree_task_executor_t* executor, iree_task_priority_class_t priority_class,
+    iree_task_executor_priority_statistics_t* out_statistics);
+
 // TODO(benvanik): scheduling mode mutation, compute quota control, etc.
 
 // Submits a batch of tasks for execution.
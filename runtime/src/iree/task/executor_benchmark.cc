@@ -0,0 +1,84 @@
+// Copyright 2026 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "iree/base/api.h"
+#include "iree/task/executor.h"
+#include "iree/task/topology.h"
+
+namespace {
+
+// Enough workers to span several coordinator shards.
+static constexpr iree_host_size_t kWorkerCount =
+    4 * IREE_TASK_EXECUTOR_COORDINATOR_SHARD_WORKER_COUNT;
+
+static iree_task_executor_t* GetExecutor() {
+  static iree_task_executor_t* executor = ([]() {
+    iree_task_executor_options_t options;
+    iree_task_executor_options_initialize(&options);
+    iree_task_topology_t topology;
+    iree_task_topology_initialize_from_group_count(kWorkerCount, &topology);
+    iree_task_executor_t* executor = NULL;
+    IREE_CHECK_OK(iree_task_executor_create(
+        options, &topology, iree_allocator_system(), &executor));
+    iree_task_topology_deinitialize(&topology);
+    return executor;
+  })();
+  return executor;
+}
+
+static iree_status_t NoopCall(void* user_context, iree_task_t* task,
+                              iree_task_submission_t* pending_submission) {
+  return iree_ok_status();
+}
+
+// Submission throughput as the number of client threads grows: each thread
+// repeatedly submits state.range(0) calls joined by a fence, flushes, and waits
+// for them to complete. With the coordinator sharded by processor the
+// aggregate rate should keep rising with the thread count instead of
+// flattening out on a single executor-wide lock.
+void BM_ExecutorSubmitFlush(benchmark::State& state) {
+  iree_task_executor_t* executor = GetExecutor();
+  const iree_host_size_t call_count = (iree_host_size_t)state.range(0);
+
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("benchmark"), &scope);
+  std::vector<iree_task_call_t> calls(call_count);
+  for (auto _ : state) {
+    iree_task_fence_t* fence = NULL;
+    IREE_CHECK_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+    iree_task_submission_t submission;
+    iree_task_submission_initialize(&submission);
+    for (auto& call : calls) {
+      iree_task_call_initialize(
+          &scope, iree_task_make_call_closure(NoopCall, NULL), &call);
+      iree_task_set_completion_task(&call.header, &fence->header);
+      iree_task_submission_enqueue(&submission, &call.header);
+    }
+    iree_task_executor_submit(executor, &submission);
+    iree_task_executor_flush(executor);
+    IREE_CHECK_OK(iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+  }
+  iree_task_scope_deinitialize(&scope);
+  state.SetItemsProcessed(state.iterations() * call_count);
+}
+
+BENCHMARK(BM_ExecutorSubmitFlush)
+    ->UseRealTime()
+    // ThreadPerCpu poorly handles non-power-of-two CPU counts.
+    ->Threads(1)
+    ->Threads(2)
+    ->Threads(4)
+    ->Threads(8)
+    ->Threads(16)
+    ->Threads(32)
+    // Calls per submission.
+    ->Arg(1)
+    ->Arg(16);
+
+}  // namespace
@@ -7,6 +7,7 @@
 #ifndef IREE_TASK_EXECUTOR_IMPL_H_
 #define IREE_TASK_EXECUTOR_IMPL_H_
 
+#include "iree/base/internal/arena.h"
 #include "iree/base/internal/math.h"
 #include "iree/base/internal/prng.h"
 #include "iree/base/internal/synchronization.h"
@@ -26,6 +27,71 @@
 extern "C" {
 #endif  // __cplusplus
 
+// Scheduling state for one cluster of up to
+// IREE_TASK_EXECUTOR_CLUSTER_WORKER_COUNT workers. Workers only ever update the
+// masks of their own cluster and coordinators and thieves prefer the cluster
+// they are running in so that traffic on these stays mostly cluster-local.
+// Padded so that clusters do not falsely share cache lines.
+typedef struct iree_task_worker_cluster_t {
+  // A bitset indicating which workers are likely to be live and usable; all
+  // attempts to push work onto a particular worker should check first with this
+  // mask. This may change over time either automatically or by user request
+  // ("don't use these cores for awhile I'm going to be using them" etc).
+  //
+  // This mask is just a hint, accessed with memory_order_relaxed. Readers must
+  // be OK with getting slightly out-of-date information. The only way to get
+  // an authoritative answer to the question "is this worker live" is to
+  // atomically query worker->state. This mask is for usage patterns where one
+  // needs a cheap (single relaxed atomic op) approximation of all N workers'
+  // live state without having to perform N expensive atomic ops.
+  iree_atomic_task_affinity_set_t worker_live_mask;
+
+  // A bitset indicating which workers are currently idle. Used to bias incoming
+  // tasks to workers that aren't doing much else. This is a balance of latency
+  // to wake the idle workers vs. latency to wait for existing work to complete
+  // on already woken workers.
+  //
+  // This mask is just a hint, accessed with memory_order_relaxed. See the
+  // comment on worker_live_mask.
+  iree_atomic_task_affinity_set_t worker_idle_mask;
+
+  uint8_t _padding[iree_hardware_destructive_interference_size -
+                   2 * sizeof(iree_atomic_task_affinity_set_t)];
+} iree_task_worker_cluster_t;
+
+// Coordination state for a subset of the executor workers and the threads
+// submitting near them. Submitted tasks are merged into the shard of the
+// submitting thread and any thread may coordinate any shard but only one at a
+// time does so. Threads finding a shard already being coordinated move on
+// instead of waiting as the coordinating thread is guaranteed to observe their
+// work before it stops.
+typedef struct iree_alignas(iree_hardware_destructive_interference_size)
+    iree_task_coordinator_shard_t {
+  // A list of incoming tasks that are ready to execute immediately.
+  // The list is LIFO and we require that task lists are reversed by the
+  // submitter so we can use iree_atomic_slist_concat to quickly prepend the
+  // LIFO list to the atomic slist. By doing this we can construct the task
+  // lists in LIFO order prior to submission, concat with a pointer swap into
+  // this list, flush from the list in LIFO order during coordination, and do a
+  // single LIFO->FIFO conversion while distributing work. What could have been
+  // half a dozen task list pointer walks and inverted sequential memory access
+  // becomes one.
+  //
+  // Example:
+  //   existing tasks: C B A
+  //        new tasks: 1 2 3
+  //    updated tasks: 3 2 1 C B A
+  iree_atomic_task_slist_t incoming_ready_slist;
+
+  // Set after tasks are merged into incoming_ready_slist and cleared by the
+  // coordinating thread before it flushes the list.
+  iree_atomic_int32_t pending;
+
+  // Set while a thread is coordinating the shard. Acts as a try-lock: threads
+  // that fail to set it leave the pending work to the current holder.
+  iree_atomic_int32_t coordinating;
+} iree_task_coordinator_shard_t;
+
 struct iree_task_executor_t {
   iree_atomic_ref_count_t ref_count;
   iree_allocator_t allocator;
@@ -56,22 +122,6 @@ struct iree_task_executor_t {
   // Increasing the size larger than these will waste memory.
   iree_task_pool_t transient_task_pool;
 
-  // A list of incoming tasks that are ready to execute immediately.
-  // The list is LIFO and we require that task lists are reversed by the
-  // submitter so we can use iree_atomic_slist_concat to quickly prepend the
-  // LIFO list to the atomic slist. By doing this we can construct the task
-  // lists in LIFO order prior to submission, concat with a pointer swap into
-  // this list, flush from the list in LIFO order during coordination, and do a
-  // single LIFO->FIFO conversion while distributing work. What could have been
-  // half a dozen task list pointer walks and inverted sequential memory access
-  // becomes one.
-  //
-  // Example:
-  //   existing tasks: C B A
-  //        new tasks: 1 2 3
-  //    updated tasks: 3 2 1 C B A
-  iree_atomic_task_slist_t incoming_ready_slist;
-
   // iree_event_t pool used to acquire system wait handles.
   // Many subsystems interacting with the executor will need events to park
   // their work in the wait set and sharing the pool across all of them ensures
@@ -79,9 +129,9 @@ struct iree_task_executor_t {
   // them.
   iree_event_pool_t* event_pool;
 
-  // Guards coordination logic; only one thread at a time may be acting as the
-  // coordinator.
-  iree_slim_mutex_t coordinator_mutex;
+  // Block pool shared by the per-worker local memory arenas used when a
+  // dispatch requires more local memory than each worker reserves up-front.
+  iree_arena_block_pool_t local_memory_block_pool;
 
   // Wait task polling and wait thread manager.
   // This handles all system waits so that we can keep the syscalls off the
@@ -90,27 +140,18 @@ struct iree_task_executor_t {
   // existing computation on the workers to finish).
   iree_task_poller_t poller;
 
-  // A bitset indicating which workers are likely to be live and usable; all
-  // attempts to push work onto a particular worker should check first with this
-  // mask. This may change over time either automatically or by user request
-  // ("don't use these cores for awhile I'm going to be using them" etc).
-  //
-  // This mask is just a hint, accessed with memory_order_relaxed. Readers must
-  // be OK with getting slightly out-of-date information. The only way to get
-  // an authoritative answer to the question "is this worker live" is to
-  // atomically query worker->state. This mask is for usage patterns where one
-  // needs a cheap (single relaxed atomic op) approximation of all N workers'
-  // live state without having to perform N expensive atomic ops.
-  iree_atomic_task_affinity_set_t worker_live_mask;
+  // Coordination shards; see iree_task_coordinator_shard_t.
+  // Workers use shard worker_index / COORDINATOR_SHARD_WORKER_COUNT and other
+  // threads pick one based on the processor they are running on.
+  // Only the first coordinator_shard_count entries are used.
+  iree_host_size_t coordinator_shard_count;
+  iree_task_coordinator_shard_t
+      coordinator_shards[IREE_TASK_EXECUTOR_MAX_COORDINATOR_SHARD_COUNT];
 
-  // A bitset indicating which workers are currently idle. Used to bias incoming
-  // tasks to workers that aren't doing much else. This is a balance of latency
-  // to wake the idle workers vs. latency to wait for existing work to complete
-  // on already woken workers.
-  //
-  // This mask is just a hint, accessed with memory_order_relaxed. See the
-  // comment on worker_live_mask.
-  iree_atomic_task_affinity_set_t worker_idle_mask;
+  // Per-cluster worker masks; see iree_task_worker_cluster_t.
+  // Only the first cluster_count entries are used.
+  iree_host_size_t cluster_count;
+  iree_task_worker_cluster_t clusters[IREE_TASK_EXECUTOR_MAX_CLUSTER_COUNT];
 
   // Base value added to each executor-local worker index.
   // This allows workers to uniquely identify themselves in multi-executor
@@ -124,21 +165,25 @@ struct iree_task_executor_t {
   iree_task_worker_t* workers;  // [worker_count]
 };
 
-// Merges a submission into the primary FIFO queues.
+// Merges a submission into the incoming queue of |shard_index|.
 // Coordinators will fetch items from here as workers demand them but otherwise
 // not be notified of the changes (waiting until coordination runs again).
 //
 // May be called from any thread.
 void iree_task_executor_merge_submission(iree_task_executor_t* executor,
+                                         iree_host_size_t shard_index,
                                          iree_task_submission_t* submission);
 
 // Schedules all ready tasks in the |pending_submission| list.
-// Only called during coordination and expects the coordinator lock to be held.
+// Called by the thread holding a coordinator shard (or otherwise owning the
+// tasks in |pending_submission|); see iree_task_coordinator_shard_t.
 void iree_task_executor_schedule_ready_tasks(
     iree_task_executor_t* executor, iree_task_submission_t* pending_submission,
     iree_task_post_batch_t* post_batch);
 
-// Dispatches tasks in the global submission queue to workers.
+// Dispatches tasks in the incoming queues of all coordinator shards to workers.
+// The shard of the calling thread is coordinated first and then any other
+// shard that has pending work and is not already being coordinated.
 // |current_worker| will be NULL if called from a non-worker thread and
 // otherwise be the current worker; used to avoid round-tripping through the
 // whole system to post to oneself.
@@ -152,12 +197,14 @@ void iree_task_executor_coordinate(iree_task_executor_t* executor,
 
 // Tries to steal an entire task from a sibling worker (based on topology).
 // Returns a task that is available (has not yet begun processing at all).
-// May steal multiple tasks and add them to the |local_task_queue|.
+// May steal multiple tasks and add them to the |local_task_queues| entry of
+// their priority class.
+// Workers in |cluster_index| are tried before those in other clusters.
 iree_task_t* iree_task_executor_try_steal_task(
-    iree_task_executor_t* executor,
+    iree_task_executor_t* executor, iree_host_size_t cluster_index,
     iree_task_affinity_set_t constructive_sharing_mask,
     uint32_t max_theft_attempts, iree_prng_minilcg128_state_t* theft_prng,
-    iree_task_queue_t* local_task_queue);
+    iree_task_queue_t* local_task_queues);
 
 #ifdef __cplusplus
 }  // extern "C"
@@ -6,7 +6,10 @@
 
 #include "iree/task/executor.h"
 
+#include <atomic>
 #include <cstddef>
+#include <thread>
+#include <vector>
 
 #include "iree/testing/gtest.h"
 #include "iree/testing/status_matchers.h"
@@ -133,4 +136,484 @@ TEST(ExecutorTest, SubmissionStress) {
   iree_task_topology_deinitialize(&topology);
 }
 
+// Tests an executor with more workers than fit in a single worker cluster
+// (including a partially populated last cluster). Every tile of a wide dispatch
+// must run exactly once and only on workers that exist.
+TEST(ExecutorTest, MultipleClusters) {
+  static constexpr iree_host_size_t kWorkerCount =
+      2 * IREE_TASK_EXECUTOR_CLUSTER_WORKER_COUNT + 3;
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(kWorkerCount, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope"), &scope);
+
+  struct Coverage {
+    std::vector<std::atomic<int>> tile_hits;
+    std::atomic<int> invalid_worker_count{0};
+  } coverage;
+  const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  const uint32_t kWorkgroupCount[3] = {4 * kWorkerCount, 1, 1};
+  coverage.tile_hits = std::vector<std::atomic<int>>(kWorkgroupCount[0]);
+
+  iree_task_dispatch_t dispatch;
+  iree_task_dispatch_initialize(
+      &scope,
+      iree_task_make_dispatch_closure(
+          [](void* user_context, const iree_task_tile_context_t* tile_context,
+             iree_task_submission_t* pending_submission) {
+            auto* coverage = reinterpret_cast<Coverage*>(user_context);
+            coverage->tile_hits[tile_context->workgroup_xyz[0]]++;
+            if (tile_context->worker_id >= kWorkerCount) {
+              coverage->invalid_worker_count++;
+            }
+            return iree_ok_status();
+          },
+          &coverage),
+      kWorkgroupSize, kWorkgroupCount, &dispatch);
+
+  iree_task_fence_t* fence = NULL;
+  IREE_ASSERT_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+  iree_task_set_completion_task(&dispatch.header, &fence->header);
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  iree_task_submission_enqueue(&submission, &dispatch.header);
+  iree_task_executor_submit(executor, &submission);
+  iree_task_executor_flush(executor);
+  IREE_ASSERT_OK(iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+
+  for (auto& tile_hit : coverage.tile_hits) EXPECT_EQ(1, tile_hit.load());
+  EXPECT_EQ(0, coverage.invalid_worker_count.load());
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+  iree_task_topology_deinitialize(&topology);
+}
+
+// Workers are counted across clusters with the affinity set applied to each.
+TEST(ExecutorTest, AffinitySetCountWorkers) {
+  const iree_host_size_t kClusterSize = IREE_TASK_EXECUTOR_CLUSTER_WORKER_COUNT;
+  const iree_task_affinity_set_t any = iree_task_affinity_for_any_worker();
+  EXPECT_EQ(0, iree_task_affinity_set_count_workers(any, 0));
+  EXPECT_EQ(3, iree_task_affinity_set_count_workers(any, 3));
+  EXPECT_EQ(kClusterSize,
+            iree_task_affinity_set_count_workers(any, kClusterSize));
+  EXPECT_EQ(kClusterSize + 5,
+            iree_task_affinity_set_count_workers(any, kClusterSize + 5));
+  const iree_task_affinity_set_t even = 0x5555555555555555ull;
+  EXPECT_EQ(2, iree_task_affinity_set_count_workers(even, 3));
+  EXPECT_EQ(kClusterSize / 2,
+            iree_task_affinity_set_count_workers(even, kClusterSize));
+  EXPECT_EQ(kClusterSize + 3,
+            iree_task_affinity_set_count_workers(even, 2 * kClusterSize + 5));
+  EXPECT_EQ(0, iree_task_affinity_set_count_workers(0, 4 * kClusterSize));
+}
+
+// Tests many client threads submitting and flushing concurrently into an
+// executor with multiple coordinator shards. Every submitted task must run even
+// when submitters find their shard already being coordinated.
+TEST(ExecutorTest, ConcurrentSubmitters) {
+  static constexpr iree_host_size_t kWorkerCount =
+      3 * IREE_TASK_EXECUTOR_COORDINATOR_SHARD_WORKER_COUNT;
+  static constexpr int kThreadCount = 8;
+  static constexpr int kSubmissionCount = 200;
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(kWorkerCount, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+
+  std::atomic<int> call_count{0};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreadCount; ++i) {
+    threads.emplace_back([&]() {
+      iree_task_scope_t scope;
+      iree_task_scope_initialize(iree_make_cstring_view("client"), &scope);
+      for (int j = 0; j < kSubmissionCount; ++j) {
+        iree_task_call_t call;
+        iree_task_call_initialize(
+            &scope,
+            iree_task_make_call_closure(
+                [](void* user_context, iree_task_t* task,
+                   iree_task_submission_t* pending_submission) {
+                  ++*reinterpret_cast<std::atomic<int>*>(user_context);
+                  return iree_ok_status();
+                },
+                &call_count),
+            &call);
+        iree_task_fence_t* fence = NULL;
+        IREE_ASSERT_OK(
+            iree_task_executor_acquire_fence(executor, &scope, &fence));
+        iree_task_set_completion_task(&call.header, &fence->header);
+        iree_task_submission_t submission;
+        iree_task_submission_initialize(&submission);
+        iree_task_submission_enqueue(&submission, &call.header);
+        iree_task_executor_submit(executor, &submission);
+        iree_task_executor_flush(executor);
+        IREE_ASSERT_OK(
+            iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+      }
+      iree_task_scope_deinitialize(&scope);
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  EXPECT_EQ(kThreadCount * kSubmissionCount, call_count.load());
+
+  iree_task_executor_release(executor);
+  iree_task_topology_deinitialize(&topology);
+}
+
+// Tests that a long-running low priority dispatch yields to a high priority
+// task posted to the same worker instead of running all of its tiles first.
+TEST(ExecutorTest, PriorityPreemption) {
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/1, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+  iree_task_scope_t low_scope;
+  iree_task_scope_initialize(iree_make_cstring_view("low"), &low_scope);
+  iree_task_scope_set_priority_class(&low_scope, IREE_TASK_PRIORITY_CLASS_LOW);
+  iree_task_scope_t high_scope;
+  iree_task_scope_initialize(iree_make_cstring_view("high"), &high_scope);
+  iree_task_scope_set_priority_class(&high_scope,
+                                     IREE_TASK_PRIORITY_CLASS_HIGH);
+
+  // The first tile blocks until the high priority task has been posted so
+  // that the worker is guaranteed to be in the middle of the dispatch.
+  struct State {
+    std::atomic<bool> dispatch_started{false};
+    std::atomic<bool> high_posted{false};
+    std::atomic<bool> high_done{false};
+    std::atomic<int> tiles_after_high{0};
+  } state;
+  const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  const uint32_t kWorkgroupCount[3] = {256, 1, 1};
+  iree_task_dispatch_t dispatch;
+  iree_task_dispatch_initialize(
+      &low_scope,
+      iree_task_make_dispatch_closure(
+          [](void* user_context, const iree_task_tile_context_t* tile_context,
+             iree_task_submission_t* pending_submission) {
+            auto* state = reinterpret_cast<State*>(user_context);
+            if (!state->dispatch_started.exchange(true)) {
+              while (!state->high_posted) std::this_thread::yield();
+            }
+            if (state->high_done) state->tiles_after_high++;
+            return iree_ok_status();
+          },
+          &state),
+      kWorkgroupSize, kWorkgroupCount, &dispatch);
+  iree_task_fence_t* low_fence = NULL;
+  IREE_ASSERT_OK(
+      iree_task_executor_acquire_fence(executor, &low_scope, &low_fence));
+  iree_task_set_completion_task(&dispatch.header, &low_fence->header);
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  iree_task_submission_enqueue(&submission, &dispatch.header);
+  iree_task_executor_submit(executor, &submission);
+  iree_task_executor_flush(executor);
+  while (!state.dispatch_started) std::this_thread::yield();
+
+  iree_task_call_t call;
+  iree_task_call_initialize(
+      &high_scope,
+      iree_task_make_call_closure(
+          [](void* user_context, iree_task_t* task,
+             iree_task_submission_t* pending_submission) {
+            reinterpret_cast<State*>(user_context)->high_done = true;
+            return iree_ok_status();
+          },
+          &state),
+      &call);
+  iree_task_fence_t* high_fence = NULL;
+  IREE_ASSERT_OK(
+      iree_task_executor_acquire_fence(executor, &high_scope, &high_fence));
+  iree_task_set_completion_task(&call.header, &high_fence->header);
+  iree_task_submission_initialize(&submission);
+  iree_task_submission_enqueue(&submission, &call.header);
+  iree_task_executor_submit(executor, &submission);
+  iree_task_executor_flush(executor);
+  state.high_posted = true;
+
+  IREE_ASSERT_OK(
+      iree_task_scope_wait_idle(&high_scope, IREE_TIME_INFINITE_FUTURE));
+  IREE_ASSERT_OK(
+      iree_task_scope_wait_idle(&low_scope, IREE_TIME_INFINITE_FUTURE));
+  EXPECT_GT(state.tiles_after_high.load(), 0);
+
+  iree_task_executor_priority_statistics_t high_statistics;
+  iree_task_executor_query_priority_statistics(
+      executor, IREE_TASK_PRIORITY_CLASS_HIGH, &high_statistics);
+  iree_task_executor_priority_statistics_t low_statistics;
+  iree_task_executor_query_priority_statistics(
+      executor, IREE_TASK_PRIORITY_CLASS_LOW, &low_statistics);
+  EXPECT_GE(low_statistics.preemption_count, 1);
+#if IREE_TASK_WORKER_BUSY_STATISTICS_ENABLE
+  EXPECT_EQ(1, high_statistics.task_count);
+  EXPECT_GT(low_statistics.busy_time_ns, 0);
+#else
+  EXPECT_EQ(0, high_statistics.task_count);
+  EXPECT_EQ(0, low_statistics.busy_time_ns);
+#endif  // IREE_TASK_WORKER_BUSY_STATISTICS_ENABLE
+
+  iree_task_scope_deinitialize(&high_scope);
+  iree_task_scope_deinitialize(&low_scope);
+  iree_task_executor_release(executor);
+  iree_task_topology_deinitialize(&topology);
+}
+
+// Tests that a burst of tasks posted to a busy worker can be stolen by other
+// workers. The worker takes one task of its own before blocking on another
+// until the burst has completed and only thieves can run the burst.
+TEST(ExecutorTest, StealPostedBurst) {
+  static constexpr iree_host_size_t kWorkerCount = 4;
+  static constexpr int kBurstCount = 32;
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(kWorkerCount, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope"), &scope);
+
+  struct State {
+    std::atomic<int> gate_count{0};
+    std::atomic<bool> burst_posted{false};
+    std::atomic<bool> blocker_started{false};
+    std::atomic<int> burst_done{0};
+    std::atomic<int> burst_done_while_blocked{0};
+  } state;
+
+  // Two gates are posted to worker 0. The first to run waits for the burst to
+  // be posted so that the worker sees it with the second gate still queued
+  // and the second blocks the worker until the burst has completed. Helpers
+  // keep the other workers busy until then so that they can't steal the gate.
+  iree_task_call_t gates[2];
+  for (auto& gate : gates) {
+    iree_task_call_initialize(
+        &scope,
+        iree_task_make_call_closure(
+            [](void* user_context, iree_task_t* task,
+               iree_task_submission_t* pending_submission) {
+              auto* state = reinterpret_cast<State*>(user_context);
+              if (state->gate_count++ == 0) {
+                while (!state->burst_posted) std::this_thread::yield();
+                return iree_ok_status();
+              }
+              state->blocker_started = true;
+              iree_time_t deadline_ns = iree_time_now() + 10000000000ll;
+              while (state->burst_done < kBurstCount &&
+                     iree_time_now() < deadline_ns) {
+                std::this_thread::yield();
+              }
+              state->burst_done_while_blocked = state->burst_done.load();
+              return iree_ok_status();
+            },
+            &state),
+        &gate);
+    gate.header.affinity_set = iree_task_affinity_for_worker(0);
+  }
+  iree_task_call_t helpers[kWorkerCount - 1];
+  for (iree_host_size_t i = 0; i < kWorkerCount - 1; ++i) {
+    iree_task_call_initialize(
+        &scope,
+        iree_task_make_call_closure(
+            [](void* user_context, iree_task_t* task,
+               iree_task_submission_t* pending_submission) {
+              auto* state = reinterpret_cast<State*>(user_context);
+              while (!state->blocker_started) std::this_thread::yield();
+              return iree_ok_status();
+            },
+            &state),
+        &helpers[i]);
+    helpers[i].header.affinity_set =
+        iree_task_affinity_for_worker((uint8_t)(i + 1));
+  }
+  iree_task_fence_t* fence = NULL;
+  IREE_ASSERT_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  for (auto& gate : gates) {
+    iree_task_set_completion_task(&gate.header, &fence->header);
+    iree_task_submission_enqueue(&submission, &gate.header);
+  }
+  for (auto& helper : helpers) {
+    iree_task_set_completion_task(&helper.header, &fence->header);
+    iree_task_submission_enqueue(&submission, &helper.header);
+  }
+  iree_task_executor_submit(executor, &submission);
+  iree_task_executor_flush(executor);
+  while (state.gate_count == 0) std::this_thread::yield();
+
+  std::vector<iree_task_call_t> burst(kBurstCount);
+  iree_task_fence_t* burst_fence = NULL;
+  IREE_ASSERT_OK(
+      iree_task_executor_acquire_fence(executor, &scope, &burst_fence));
+  iree_task_submission_initialize(&submission);
+  for (auto& call : burst) {
+    iree_task_call_initialize(
+        &scope,
+        iree_task_make_call_closure(
+            [](void* user_context, iree_task_t* task,
+               iree_task_submission_t* pending_submission) {
+              reinterpret_cast<State*>(user_context)->burst_done++;
+              return iree_ok_status();
+            },
+            &state),
+        &call);
+    call.header.affinity_set = iree_task_affinity_for_worker(0);
+    iree_task_set_completion_task(&call.header, &burst_fence->header);
+    iree_task_submission_enqueue(&submission, &call.header);
+  }
+  iree_task_executor_submit(executor, &submission);
+  iree_task_executor_flush(executor);
+  state.burst_posted = true;
+
+  IREE_ASSERT_OK(iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+  EXPECT_EQ(kBurstCount, state.burst_done_while_blocked.load());
+  EXPECT_EQ(kBurstCount, state.burst_done.load());
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+  iree_task_topology_deinitialize(&topology);
+}
+
+// Tests that a steady stream of high priority tasks does not starve low
+// priority tasks queued on the same worker: each low priority task runs within
+// IREE_TASK_WORKER_MAX_PRIORITY_STREAK tasks of the previous one.
+TEST(ExecutorTest, PriorityStarvationBound) {
+  static constexpr int kLowCount = 4;
+  static constexpr int kHighCount =
+      (kLowCount + 1) * IREE_TASK_WORKER_MAX_PRIORITY_STREAK;
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/1, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+  iree_task_scope_t gate_scope;
+  iree_task_scope_initialize(iree_make_cstring_view("gate"), &gate_scope);
+  iree_task_scope_t low_scope;
+  iree_task_scope_initialize(iree_make_cstring_view("low"), &low_scope);
+  iree_task_scope_set_priority_class(&low_scope, IREE_TASK_PRIORITY_CLASS_LOW);
+  iree_task_scope_t high_scope;
+  iree_task_scope_initialize(iree_make_cstring_view("high"), &high_scope);
+  iree_task_scope_set_priority_class(&high_scope,
+                                     IREE_TASK_PRIORITY_CLASS_HIGH);
+
+  // The gate holds the only worker until all tasks have been posted so that
+  // they are all queued together once it resumes.
+  struct State {
+    std::atomic<bool> gate_started{false};
+    std::atomic<bool> gate_released{false};
+    std::atomic<int> high_count{0};
+    std::vector<int> low_high_counts;
+  } state;
+  iree_task_call_t gate;
+  iree_task_call_initialize(
+      &gate_scope,
+      iree_task_make_call_closure(
+          [](void* user_context, iree_task_t* task,
+             iree_task_submission_t* pending_submission) {
+            auto* state = reinterpret_cast<State*>(user_context);
+            state->gate_started = true;
+            while (!state->gate_released) std::this_thread::yield();
+            return iree_ok_status();
+          },
+          &state),
+      &gate);
+  iree_task_fence_t* gate_fence = NULL;
+  IREE_ASSERT_OK(
+      iree_task_executor_acquire_fence(executor, &gate_scope, &gate_fence));
+  iree_task_set_completion_task(&gate.header, &gate_fence->header);
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  iree_task_submission_enqueue(&submission, &gate.header);
+  iree_task_executor_submit(executor, &submission);
+  iree_task_executor_flush(executor);
+  while (!state.gate_started) std::this_thread::yield();
+
+  std::vector<iree_task_call_t> high_calls(kHighCount);
+  iree_task_fence_t* high_fence = NULL;
+  IREE_ASSERT_OK(
+      iree_task_executor_acquire_fence(executor, &high_scope, &high_fence));
+  std::vector<iree_task_call_t> low_calls(kLowCount);
+  iree_task_fence_t* low_fence = NULL;
+  IREE_ASSERT_OK(
+      iree_task_executor_acquire_fence(executor, &low_scope, &low_fence));
+  iree_task_submission_initialize(&submission);
+  for (auto& call : high_calls) {
+    iree_task_call_initialize(
+        &high_scope,
+        iree_task_make_call_closure(
+            [](void* user_context, iree_task_t* task,
+               iree_task_submission_t* pending_submission) {
+              reinterpret_cast<State*>(user_context)->high_count++;
+              return iree_ok_status();
+            },
+            &state),
+        &call);
+    iree_task_set_completion_task(&call.header, &high_fence->header);
+    iree_task_submission_enqueue(&submission, &call.header);
+  }
+  for (auto& call : low_calls) {
+    iree_task_call_initialize(
+        &low_scope,
+        iree_task_make_call_closure(
+            [](void* user_context, iree_task_t* task,
+               iree_task_submission_t* pending_submission) {
+              auto* state = reinterpret_cast<State*>(user_context);
+              state->low_high_counts.push_back(state->high_count.load());
+              return iree_ok_status();
+            },
+            &state),
+        &call);
+    iree_task_set_completion_task(&call.header, &low_fence->header);
+    iree_task_submission_enqueue(&submission, &call.header);
+  }
+  iree_task_executor_submit(executor, &submission);
+  iree_task_executor_flush(executor);
+  state.gate_released = true;
+
+  IREE_ASSERT_OK(
+      iree_task_scope_wait_idle(&gate_scope, IREE_TIME_INFINITE_FUTURE));
+  IREE_ASSERT_OK(
+      iree_task_scope_wait_idle(&high_scope, IREE_TIME_INFINITE_FUTURE));
+  IREE_ASSERT_OK(
+      iree_task_scope_wait_idle(&low_scope, IREE_TIME_INFINITE_FUTURE));
+  EXPECT_EQ(kHighCount, state.high_count.load());
+
+  // Each low priority task preempted the stream of high priority tasks within
+  // the streak bound instead of waiting for all of them to complete.
+  ASSERT_EQ(kLowCount, (int)state.low_high_counts.size());
+  int previous_high_count = 0;
+  for (int high_count : state.low_high_counts) {
+    EXPECT_LT(high_count - previous_high_count,
+              IREE_TASK_WORKER_MAX_PRIORITY_STREAK);
+    previous_high_count = high_count;
+  }
+  iree_task_executor_priority_statistics_t low_statistics;
+  iree_task_executor_query_priority_statistics(
+      executor, IREE_TASK_PRIORITY_CLASS_LOW, &low_statistics);
+  EXPECT_EQ(kLowCount, low_statistics.starvation_count);
+
+  iree_task_scope_deinitialize(&high_scope);
+  iree_task_scope_deinitialize(&low_scope);
+  iree_task_scope_deinitialize(&gate_scope);
+  iree_task_executor_release(executor);
+  iree_task_topology_deinitialize(&topology);
+}
+
 }  // namespace
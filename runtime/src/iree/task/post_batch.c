@@ -17,12 +17,17 @@
 #include "iree/task/queue.h"
 #include "iree/task/worker.h"
 
+static_assert(IREE_TASK_EXECUTOR_MAX_CLUSTER_COUNT <= 64,
+              "cluster_pending_mask must have a bit per cluster");
+
 void iree_task_post_batch_initialize(iree_task_executor_t* executor,
                                      iree_task_worker_t* current_worker,
                                      iree_task_post_batch_t* out_post_batch) {
   out_post_batch->executor = executor;
   out_post_batch->current_worker = current_worker;
-  out_post_batch->worker_pending_mask = 0;
+  out_post_batch->cluster_pending_mask = 0;
+  memset(&out_post_batch->worker_pending_masks, 0,
+         sizeof(out_post_batch->worker_pending_masks));
   memset(&out_post_batch->worker_pending_lifos, 0,
          executor->worker_count * sizeof(iree_task_list_t));
 }
@@ -32,34 +37,51 @@ iree_host_size_t iree_task_post_batch_worker_count(
   return post_batch->executor->worker_count;
 }
 
-static iree_host_size_t iree_task_post_batch_select_random_worker(
-    iree_task_post_batch_t* post_batch, iree_task_affinity_set_t affinity_set) {
+// Returns the cluster that worker selection should start from.
+static iree_host_size_t iree_task_post_batch_home_cluster(
+    const iree_task_post_batch_t* post_batch) {
+  return post_batch->current_worker
+             ? post_batch->current_worker->cluster_index
+             : 0;
+}
+
+// Selects a live worker from |affinity_set| within |cluster_index| and
+// returns its executor-local index in |out_worker_index|.
+// Returns false if none of the workers in the set are live.
+static bool iree_task_post_batch_select_random_worker(
+    iree_task_post_batch_t* post_batch, iree_host_size_t cluster_index,
+    iree_task_affinity_set_t affinity_set,
+    iree_host_size_t* out_worker_index) {
   // The masks are accessed with 'relaxed' order because they are just hints.
   iree_task_affinity_set_t worker_live_mask =
       iree_atomic_task_affinity_set_load(
-          &post_batch->executor->worker_live_mask, iree_memory_order_relaxed);
+          &post_batch->executor->clusters[cluster_index].worker_live_mask,
+          iree_memory_order_relaxed);
   iree_task_affinity_set_t valid_worker_mask = affinity_set & worker_live_mask;
-  if (!valid_worker_mask) {
-    // No valid workers as desired; for now just bail to worker 0.
-    return 0;
-  }
+  if (!valid_worker_mask) return false;
 
   // TODO(benvanik): rotate through workers here. Instead, if the affinity set
   // has the current_worker allowed we just use that to avoid needing a
   // cross-thread hop.
-  return iree_task_affinity_set_count_trailing_zeros(valid_worker_mask);
+  *out_worker_index =
+      cluster_index * IREE_TASK_EXECUTOR_CLUSTER_WORKER_COUNT +
+      iree_task_affinity_set_count_trailing_zeros(valid_worker_mask);
+  return true;
 }
 
 iree_host_size_t iree_task_post_batch_select_worker(
     iree_task_post_batch_t* post_batch, iree_task_affinity_set_t affinity_set) {
-  if (post_batch->current_worker) {
+  iree_task_worker_t* current_worker = post_batch->current_worker;
+  if (current_worker) {
     // Posting from a worker - prefer sending right back to this worker if we
     // haven't already scheduled for it.
-    if ((affinity_set & post_batch->current_worker->worker_bit) &&
-        !(post_batch->worker_pending_mask &
-          post_batch->current_worker->worker_bit)) {
-      return iree_task_affinity_set_count_trailing_zeros(
-          post_batch->current_worker->worker_bit);
+    if ((affinity_set & current_worker->worker_bit) &&
+        !(post_batch->worker_pending_masks[current_worker->cluster_index] &
+          current_worker->worker_bit)) {
+      return current_worker->cluster_index *
+                 IREE_TASK_EXECUTOR_CLUSTER_WORKER_COUNT +
+             iree_task_affinity_set_count_trailing_zeros(
+                 current_worker->worker_bit);
     }
   }
 
@@ -69,20 +91,44 @@ iree_host_size_t iree_task_post_batch_select_worker(
   // worker's queue to finish. Note that we only consider workers idle if we
   // ourselves in this batch haven't already queued work for them (as then they
   // aren't going to be idle).
+  //
+  // Clusters are scanned starting with our own so that the work (and the
+  // cache lines it touches) stays close to where it was produced.
   // The masks are accessed with 'relaxed' order because they are just hints.
-  iree_task_affinity_set_t worker_idle_mask =
-      iree_atomic_task_affinity_set_load(
-          &post_batch->executor->worker_idle_mask, iree_memory_order_relaxed);
-  worker_idle_mask &= ~post_batch->worker_pending_mask;
-  iree_task_affinity_set_t idle_affinity_set = affinity_set & worker_idle_mask;
-  if (idle_affinity_set) {
-    return iree_task_post_batch_select_random_worker(post_batch,
-                                                     idle_affinity_set);
+  iree_task_executor_t* executor = post_batch->executor;
+  iree_host_size_t home_cluster_index =
+      iree_task_post_batch_home_cluster(post_batch);
+  iree_host_size_t worker_index = 0;
+  for (iree_host_size_t i = 0; i < executor->cluster_count; ++i) {
+    iree_host_size_t cluster_index =
+        (home_cluster_index + i) % executor->cluster_count;
+    iree_task_affinity_set_t worker_idle_mask =
+        iree_atomic_task_affinity_set_load(
+            &executor->clusters[cluster_index].worker_idle_mask,
+            iree_memory_order_relaxed);
+    worker_idle_mask &= ~post_batch->worker_pending_masks[cluster_index];
+    iree_task_affinity_set_t idle_affinity_set =
+        affinity_set & worker_idle_mask;
+    if (idle_affinity_set &&
+        iree_task_post_batch_select_random_worker(
+            post_batch, cluster_index, idle_affinity_set, &worker_index)) {
+      return worker_index;
+    }
   }
 
   // No more workers are idle; farm out at random. In the worst case work
   // stealing will help balance things out on the backend.
-  return iree_task_post_batch_select_random_worker(post_batch, affinity_set);
+  for (iree_host_size_t i = 0; i < executor->cluster_count; ++i) {
+    iree_host_size_t cluster_index =
+        (home_cluster_index + i) % executor->cluster_count;
+    if (iree_task_post_batch_select_random_worker(
+            post_batch, cluster_index, affinity_set, &worker_index)) {
+      return worker_index;
+    }
+  }
+
+  // No valid workers as desired; for now just bail to worker 0.
+  return 0;
 }
 
 void iree_task_post_batch_enqueue(iree_task_post_batch_t* post_batch,
@@ -90,13 +136,17 @@ void iree_task_post_batch_enqueue(iree_task_post_batch_t* post_batch,
                                   iree_task_t* task) {
   iree_task_list_push_front(&post_batch->worker_pending_lifos[worker_index],
                             task);
-  post_batch->worker_pending_mask |=
-      iree_task_affinity_for_worker(worker_index);
+  iree_host_size_t cluster_index =
+      iree_task_affinity_cluster_for_worker(worker_index);
+  post_batch->worker_pending_masks[cluster_index] |=
+      iree_task_affinity_bit_for_worker(worker_index);
+  post_batch->cluster_pending_mask |= 1ull << cluster_index;
 }
 
-// Wakes each worker indicated in the |wake_mask|, if needed.
+// Wakes each worker in |cluster_index| indicated in the |wake_mask|, if needed.
 static void iree_task_post_batch_wake_workers(
-    iree_task_post_batch_t* post_batch, iree_task_affinity_set_t wake_mask) {
+    iree_task_post_batch_t* post_batch, iree_host_size_t cluster_index,
+    iree_task_affinity_set_t wake_mask) {
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_VALUE(z0, iree_math_count_ones_u64(wake_mask));
 
@@ -110,10 +160,11 @@ static void iree_task_post_batch_wake_workers(
   // migrations prior to beginning execution.
   iree_task_executor_t* executor = post_batch->executor;
   int wake_count = iree_task_affinity_set_count_ones(wake_mask);
-  int worker_index = 0;
+  iree_host_size_t worker_index =
+      cluster_index * IREE_TASK_EXECUTOR_CLUSTER_WORKER_COUNT;
   for (int i = 0; i < wake_count; ++i) {
     int offset = iree_task_affinity_set_count_trailing_zeros(wake_mask);
-    int wake_index = worker_index + offset;
+    iree_host_size_t wake_index = worker_index + offset;
     worker_index += offset + 1;
     wake_mask = iree_shr(wake_mask, offset + 1);
 
@@ -128,21 +179,18 @@ static void iree_task_post_batch_wake_workers(
   IREE_TRACE_ZONE_END(z0);
 }
 
-bool iree_task_post_batch_submit(iree_task_post_batch_t* post_batch) {
-  if (!post_batch->worker_pending_mask) return false;
-
-  IREE_TRACE_ZONE_BEGIN(z0);
-
-  // Run through each worker that has a bit set in the pending mask and post
-  // the pending tasks.
-  iree_task_affinity_set_t worker_mask = post_batch->worker_pending_mask;
-  post_batch->worker_pending_mask = 0;
-  int worker_index = 0;
+// Posts the pending tasks of each worker in |cluster_index| indicated in the
+// |worker_mask| and wakes the workers that need it.
+static void iree_task_post_batch_submit_cluster(
+    iree_task_post_batch_t* post_batch, iree_host_size_t cluster_index,
+    iree_task_affinity_set_t worker_mask) {
+  iree_host_size_t worker_index =
+      cluster_index * IREE_TASK_EXECUTOR_CLUSTER_WORKER_COUNT;
   int post_count = iree_task_affinity_set_count_ones(worker_mask);
   iree_task_affinity_set_t worker_wake_mask = 0;
   for (int i = 0; i < post_count; ++i) {
     int offset = iree_task_affinity_set_count_trailing_zeros(worker_mask);
-    int target_index = worker_index + offset;
+    iree_host_size_t target_index = worker_index + offset;
     worker_index += offset + 1;
     worker_mask = iree_shr(worker_mask, offset + 1);
 
@@ -154,20 +202,45 @@ bool iree_task_post_batch_submit(iree_task_post_batch_t* post_batch) {
       // role of coordinator and we want to ensure we aren't doing a fully
       // block-and-flush loop when we could just be popping the next new task
       // off the list.
-      iree_task_queue_append_from_lifo_list_unsafe(&worker->local_task_queue,
-                                                   target_pending_lifo);
+      iree_task_worker_append_local_tasks(worker, target_pending_lifo);
     } else {
       iree_task_worker_post_tasks(worker, target_pending_lifo);
-      worker_wake_mask |= iree_task_affinity_for_worker(target_index);
+      worker_wake_mask |= worker->worker_bit;
     }
   }
 
   // Wake all workers that now have pending work. If a worker is not already
   // waiting this will be cheap (no syscall).
   if (worker_wake_mask != 0) {
-    iree_task_post_batch_wake_workers(post_batch, worker_wake_mask);
+    iree_task_post_batch_wake_workers(post_batch, cluster_index,
+                                      worker_wake_mask);
+  }
+}
+
+bool iree_task_post_batch_submit(iree_task_post_batch_t* post_batch) {
+  if (!post_batch->cluster_pending_mask) return false;
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Run through each cluster that has a bit set in the pending mask and post
+  // the pending tasks of its workers.
+  uint64_t cluster_mask = post_batch->cluster_pending_mask;
+  post_batch->cluster_pending_mask = 0;
+  iree_host_size_t cluster_index = 0;
+  int cluster_count = iree_math_count_ones_u64(cluster_mask);
+  for (int i = 0; i < cluster_count; ++i) {
+    int offset = iree_math_count_trailing_zeros_u64(cluster_mask);
+    iree_host_size_t target_cluster_index = cluster_index + offset;
+    cluster_index += offset + 1;
+    cluster_mask = iree_shr(cluster_mask, offset + 1);
+
+    iree_task_affinity_set_t worker_mask =
+        post_batch->worker_pending_masks[target_cluster_index];
+    post_batch->worker_pending_masks[target_cluster_index] = 0;
+    iree_task_post_batch_submit_cluster(post_batch, target_cluster_index,
+                                        worker_mask);
   }
 
   IREE_TRACE_ZONE_END(z0);
-  return post_count != 0;
+  return true;
 }
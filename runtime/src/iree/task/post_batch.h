@@ -35,9 +35,15 @@ typedef struct iree_task_post_batch_t {
   // May be NULL if not being posted from a worker (such as a submission).
   iree_task_worker_t* current_worker;
 
-  // A bitmask of workers indicating which have pending tasks in their lists.
-  // Used to quickly scan the lists and perform the posts only when required.
-  iree_task_affinity_set_t worker_pending_mask;
+  // A bitmask of worker clusters indicating which have a non-zero entry in
+  // worker_pending_masks. Used to skip clusters with nothing to post.
+  uint64_t cluster_pending_mask;
+
+  // Per-cluster bitmasks of workers indicating which have pending tasks in
+  // their lists. Used to quickly scan the lists and perform the posts only
+  // when required.
+  iree_task_affinity_set_t
+      worker_pending_masks[IREE_TASK_EXECUTOR_MAX_CLUSTER_COUNT];
 
   // A per-worker LIFO task list waiting to be posted.
   iree_task_list_t worker_pending_lifos[0];
@@ -52,6 +58,9 @@ iree_host_size_t iree_task_post_batch_worker_count(
     const iree_task_post_batch_t* post_batch);
 
 // Selects a random worker from the given affinity set.
+// The affinity set is applied to each worker cluster and clusters are tried
+// starting with the one containing the current worker (if any). Returns the
+// executor-local worker index.
 iree_host_size_t iree_task_post_batch_select_worker(
     iree_task_post_batch_t* post_batch, iree_task_affinity_set_t affinity_set);
 
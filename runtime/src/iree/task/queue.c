@@ -9,43 +9,160 @@
 #include <stddef.h>
 #include <string.h>
 
+static_assert((IREE_TASK_QUEUE_CAPACITY & (IREE_TASK_QUEUE_CAPACITY - 1)) == 0,
+              "queue capacity must be a power of two");
+
+#define IREE_TASK_QUEUE_SLOT(index) \
+  ((index) & (int64_t)(IREE_TASK_QUEUE_CAPACITY - 1))
+
+// Pushes |task| at the bottom of the ring, making it the next task the owner
+// will pop. Returns false if the ring is full.
+static bool iree_task_queue_push_bottom(iree_task_queue_t* queue,
+                                        iree_task_t* task) {
+  int64_t bottom = iree_atomic_load_int64(&queue->bottom,
+                                          iree_memory_order_relaxed);
+  int64_t top = iree_atomic_load_int64(&queue->top, iree_memory_order_acquire);
+  if (bottom - top >= IREE_TASK_QUEUE_CAPACITY) return false;
+  iree_atomic_store_intptr(&queue->tasks[IREE_TASK_QUEUE_SLOT(bottom)],
+                           (intptr_t)task, iree_memory_order_relaxed);
+  iree_atomic_store_int64(&queue->bottom, bottom + 1,
+                          iree_memory_order_release);
+  return true;
+}
+
+// Pops the task at the bottom of the ring, racing any thieves for the last one.
+// Returns NULL if the ring is empty or the last task was stolen.
+//
+// The claim of the bottom slot and the read of top must be ordered against the
+// reads a thief makes in the opposite order; sequentially consistent accesses
+// are used instead of fences as they are understood by thread sanitizers.
+static iree_task_t* iree_task_queue_pop_bottom(iree_task_queue_t* queue) {
+  int64_t bottom =
+      iree_atomic_load_int64(&queue->bottom, iree_memory_order_relaxed) - 1;
+  iree_atomic_store_int64(&queue->bottom, bottom, iree_memory_order_seq_cst);
+  int64_t top = iree_atomic_load_int64(&queue->top, iree_memory_order_seq_cst);
+  if (top > bottom) {
+    // Empty; restore the bottom we speculatively claimed.
+    iree_atomic_store_int64(&queue->bottom, bottom + 1,
+                            iree_memory_order_relaxed);
+    return NULL;
+  }
+  iree_task_t* task = (iree_task_t*)iree_atomic_load_intptr(
+      &queue->tasks[IREE_TASK_QUEUE_SLOT(bottom)], iree_memory_order_relaxed);
+  if (top == bottom) {
+    // Last task in the ring; thieves may be trying to take it as well.
+    if (!iree_atomic_compare_exchange_strong_int64(
+            &queue->top, &top, top + 1, iree_memory_order_seq_cst,
+            iree_memory_order_relaxed)) {
+      task = NULL;
+    }
+    iree_atomic_store_int64(&queue->bottom, bottom + 1,
+                            iree_memory_order_relaxed);
+  }
+  return task;
+}
+
+// Steals the task at the top of the ring.
+// Returns NULL if the ring is empty or another thread took the task first.
+static iree_task_t* iree_task_queue_steal_top(iree_task_queue_t* queue) {
+  int64_t top = iree_atomic_load_int64(&queue->top, iree_memory_order_seq_cst);
+  int64_t bottom =
+      iree_atomic_load_int64(&queue->bottom, iree_memory_order_seq_cst);
+  if (top >= bottom) return NULL;
+  iree_task_t* task = (iree_task_t*)iree_atomic_load_intptr(
+      &queue->tasks[IREE_TASK_QUEUE_SLOT(top)], iree_memory_order_relaxed);
+  if (!iree_atomic_compare_exchange_strong_int64(&queue->top, &top, top + 1,
+                                                 iree_memory_order_seq_cst,
+                                                 iree_memory_order_relaxed)) {
+    return NULL;
+  }
+  return task;
+}
+
+// Returns true if the ring has no tasks. Exact only when called by the owner
+// and then only with respect to tasks it may still pop.
+static bool iree_task_queue_ring_is_empty(iree_task_queue_t* queue) {
+  int64_t bottom = iree_atomic_load_int64(&queue->bottom,
+                                          iree_memory_order_relaxed);
+  int64_t top = iree_atomic_load_int64(&queue->top, iree_memory_order_acquire);
+  return top >= bottom;
+}
+
+// Moves as many tasks from the front of the overflow list into the ring as will
+// fit. The ring must be empty so that the moved tasks are the next to run.
+static void iree_task_queue_refill(iree_task_queue_t* queue) {
+  if (iree_task_list_is_empty(&queue->overflow_list)) return;
+
+  // The ring is empty and only the owner adds tasks so thieves cannot move
+  // top until we publish the new bottom below.
+  int64_t bottom = iree_atomic_load_int64(&queue->bottom,
+                                          iree_memory_order_relaxed);
+  int64_t count = 0;
+  iree_task_t* task = queue->overflow_list.head;
+  while (task && count < IREE_TASK_QUEUE_CAPACITY) {
+    task = task->next_task;
+    ++count;
+  }
+
+  // Write the tasks in reverse so that the first in the list is at the bottom.
+  for (int64_t i = count - 1; i >= 0; --i) {
+    iree_task_t* next_task = iree_task_list_pop_front(&queue->overflow_list);
+    iree_atomic_store_intptr(&queue->tasks[IREE_TASK_QUEUE_SLOT(bottom + i)],
+                             (intptr_t)next_task, iree_memory_order_relaxed);
+  }
+  iree_atomic_store_int64(&queue->bottom, bottom + count,
+                          iree_memory_order_release);
+}
+
+// Appends a FIFO |list| of tasks after all tasks currently in the queue.
+static void iree_task_queue_append_fifo(iree_task_queue_t* queue,
+                                        iree_task_list_t* list) {
+  iree_task_list_append(&queue->overflow_list, list);
+  if (iree_task_queue_ring_is_empty(queue)) iree_task_queue_refill(queue);
+}
+
 void iree_task_queue_initialize(iree_task_queue_t* out_queue) {
   memset(out_queue, 0, sizeof(*out_queue));
-  iree_slim_mutex_initialize(&out_queue->mutex);
-  iree_task_list_initialize(&out_queue->list);
+  iree_task_list_initialize(&out_queue->overflow_list);
 }
 
 void iree_task_queue_deinitialize(iree_task_queue_t* queue) {
-  iree_task_list_discard(&queue->list);
-  iree_slim_mutex_deinitialize(&queue->mutex);
+  // Gather everything left in the ring in the order it would have run and
+  // discard it along with the overflow list.
+  iree_task_list_t list;
+  iree_task_list_initialize(&list);
+  iree_task_t* task = NULL;
+  while ((task = iree_task_queue_pop_bottom(queue)) != NULL) {
+    iree_task_list_push_back(&list, task);
+  }
+  iree_task_list_append(&list, &queue->overflow_list);
+  iree_task_list_discard(&list);
 }
 
 bool iree_task_queue_is_empty(iree_task_queue_t* queue) {
-  iree_slim_mutex_lock(&queue->mutex);
-  bool is_empty = iree_task_list_is_empty(&queue->list);
-  iree_slim_mutex_unlock(&queue->mutex);
-  return is_empty;
+  return iree_task_queue_ring_is_empty(queue) &&
+         iree_task_list_is_empty(&queue->overflow_list);
 }
 
 void iree_task_queue_push_front(iree_task_queue_t* queue, iree_task_t* task) {
-  iree_slim_mutex_lock(&queue->mutex);
-  iree_task_list_push_front(&queue->list, task);
-  iree_slim_mutex_unlock(&queue->mutex);
+  while (!iree_task_queue_push_bottom(queue, task)) {
+    // Full; make room by moving the last task in the ring to the front of the
+    // overflow list where it still runs before everything already there. We
+    // race thieves for it and if one wins there is room anyway.
+    iree_task_t* last_task = iree_task_queue_steal_top(queue);
+    if (last_task) iree_task_list_push_front(&queue->overflow_list, last_task);
+  }
 }
 
 void iree_task_queue_append_from_lifo_list_unsafe(iree_task_queue_t* queue,
                                                   iree_task_list_t* list) {
-  // NOTE: reversing the list outside of the lock.
   iree_task_list_reverse(list);
-  iree_slim_mutex_lock(&queue->mutex);
-  iree_task_list_append(&queue->list, list);
-  iree_slim_mutex_unlock(&queue->mutex);
+  iree_task_queue_append_fifo(queue, list);
 }
 
 iree_task_t* iree_task_queue_flush_from_lifo_slist(
     iree_task_queue_t* queue, iree_atomic_task_slist_t* source_slist) {
-  // Perform the flush and swap outside of the lock; acquiring the list is
-  // atomic and then we own it exclusively.
+  // Acquiring the list is atomic and then we own it exclusively.
   iree_task_list_t suffix;
   iree_task_list_initialize(&suffix);
   const bool did_flush = iree_atomic_task_slist_flush(
@@ -53,39 +170,46 @@ iree_task_t* iree_task_queue_flush_from_lifo_slist(
       &suffix.head, &suffix.tail);
 
   // Append the tasks and pop off the front for return.
-  iree_slim_mutex_lock(&queue->mutex);
-  if (did_flush) iree_task_list_append(&queue->list, &suffix);
-  iree_task_t* next_task = iree_task_list_pop_front(&queue->list);
-  iree_slim_mutex_unlock(&queue->mutex);
-
-  return next_task;
+  if (did_flush) iree_task_queue_append_fifo(queue, &suffix);
+  return iree_task_queue_pop_front(queue);
 }
 
 iree_task_t* iree_task_queue_pop_front(iree_task_queue_t* queue) {
-  iree_slim_mutex_lock(&queue->mutex);
-  iree_task_t* next_task = iree_task_list_pop_front(&queue->list);
-  iree_slim_mutex_unlock(&queue->mutex);
+  iree_task_t* next_task = iree_task_queue_pop_bottom(queue);
+  if (!next_task && !iree_task_list_is_empty(&queue->overflow_list)) {
+    // The ring has drained (possibly due to thieves); pull in the next batch.
+    iree_task_queue_refill(queue);
+    next_task = iree_task_queue_pop_bottom(queue);
+  }
   return next_task;
 }
 
 iree_task_t* iree_task_queue_try_steal(iree_task_queue_t* source_queue,
                                        iree_task_queue_t* target_queue,
                                        iree_host_size_t max_tasks) {
-  // First attempt to steal up to max_tasks from the source queue.
+  // Aim to take roughly half of the tasks in the ring (rounding up so that the
+  // last task of a nearly-done victim can be taken).
+  int64_t top =
+      iree_atomic_load_int64(&source_queue->top, iree_memory_order_relaxed);
+  int64_t bottom =
+      iree_atomic_load_int64(&source_queue->bottom, iree_memory_order_relaxed);
+  if (top >= bottom) return NULL;
+  iree_host_size_t steal_count =
+      iree_min(max_tasks, (iree_host_size_t)((bottom - top + 1) / 2));
+
+  // Tasks are stolen one at a time from the end of the victim's FIFO order so
+  // prepending them rebuilds that order in the stolen list. Stop at the first
+  // failure as the victim or another thief is draining the queue.
   iree_task_list_t stolen_tasks;
   iree_task_list_initialize(&stolen_tasks);
-  if (iree_slim_mutex_try_lock(&source_queue->mutex)) {
-    iree_task_list_split(&source_queue->list, max_tasks, &stolen_tasks);
-    iree_slim_mutex_unlock(&source_queue->mutex);
+  for (iree_host_size_t i = 0; i < steal_count; ++i) {
+    iree_task_t* task = iree_task_queue_steal_top(source_queue);
+    if (!task) break;
+    iree_task_list_push_front(&stolen_tasks, task);
   }
 
   // Add any stolen tasks to the target queue and pop off the head for return.
-  iree_task_t* next_task = NULL;
-  if (!iree_task_list_is_empty(&stolen_tasks)) {
-    iree_slim_mutex_lock(&target_queue->mutex);
-    iree_task_list_append(&target_queue->list, &stolen_tasks);
-    next_task = iree_task_list_pop_front(&target_queue->list);
-    iree_slim_mutex_unlock(&target_queue->mutex);
-  }
-  return next_task;
+  if (iree_task_list_is_empty(&stolen_tasks)) return NULL;
+  iree_task_queue_append_fifo(target_queue, &stolen_tasks);
+  return iree_task_queue_pop_front(target_queue);
 }
@@ -10,15 +10,16 @@
 #include <stdbool.h>
 
 #include "iree/base/api.h"
-#include "iree/base/internal/synchronization.h"
+#include "iree/base/internal/atomics.h"
 #include "iree/task/list.h"
 #include "iree/task/task.h"
+#include "iree/task/tuning.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif  // __cplusplus
 
-// A simple work-stealing LIFO queue modeled on a Chase-Lev concurrent deque.
+// A work-stealing queue modeled on a Chase-Lev concurrent deque.
 // This is used by workers to maintain their thread-local working lists. The
 // workers keep the tasks they will process in FIFO order. They allow it to
 // empty and then refresh it with more tasks from the incoming worker mailbox.
@@ -26,19 +27,11 @@ extern "C" {
 // accesses and the only other accesses are thieves that hopefully we can just
 // improve our distribution to vs. introducing a slowdown here.
 //
-// A futex is used to synchronize access; because the common case is that of
-// only the worker that owns the queue touching it for pushing and popping items
-// this puts us into the sweet-spot of uncontended lightweight exclusive locks.
-// Since futices are effectively just single machine words managed with atomic
-// ops we can avoid a lot of the traditional atomic tomfoolery one finds in
-// systems like these that originated prior to the introduction of futices while
-// also keeping the tiny overhead of the pure atomic solutions.
-//
-// We can also take advantage of the futex providing an actual exclusive region
-// such that our data structure can be whatever we want as opposed to needing to
-// be something that someone had figured out how to make atomic. For example,
-// common implementations of work-stealing queues are all bounded as unbounded
-// atomic deques are an unsolved problem in CS.
+// The owning worker pushes and pops at the bottom of a bounded ring of task
+// pointers without any read-modify-write operations in the common case; only
+// when racing a thief for the very last task does it need a compare-exchange.
+// Thieves take tasks from the top of the ring with a single compare-exchange
+// each and never block the owner or each other.
 //
 // Very rarely when another worker runs out of work it'll try to steal tasks
 // from nearby workers and use this queue type to do it: the assumption is that
@@ -56,20 +49,22 @@ extern "C" {
 // tasks in one go (hopefully roughly half) to reduce the total overhead when
 // there is high imbalance in workloads.
 //
+// To get FIFO processing out of a LIFO deque the tasks are written into the
+// ring in reverse: the first task to run is at the bottom where the owner pops
+// and the last task to run is at the top where thieves steal. Tasks can only be
+// added at the bottom without contending with thieves so any tasks that arrive
+// while the ring is non-empty (or that do not fit) are appended to an overflow
+// list private to the owner. The overflow list is moved into the ring in the
+// same reversed order when the ring drains, preserving FIFO order across
+// batches. Tasks in the overflow list cannot be stolen until then.
+//
 // Flushing from the mailbox slist (LIFO) to our list (FIFO) requires a full
 // walk of the incoming task linked list. This is generally fine as the number
 // of tasks in any given flush is low(ish) and by walking in reverse order to
 // then process forward the cache should be hot as the worker starts making its
-// way back through the tasks. As we walk forward we'll be using the task fields
-// for execution and retiring of tasks (notifing dependencies/etc) and the
-// intrusive next pointer sitting next to those should be in-cache when we need
-// to access it. This, combined with slab allocation of tasks in command buffers
-// to begin with gives us the (probabilistically) same characteristics of a flat
-// array walked with an index as is common in other work queues but with the
-// flexibility to reorder tasks as we see fit (theft, redistribution/rotation,
-// reprioritization, etc).
+// way back through the tasks.
 //
-// Similar concepts, though implemented with atomics:
+// References:
 //   "Dynamic Circular Work-Stealing Deque":
 //   http://citeseerx.ist.psu.edu/viewdoc/download?doi=10.1.1.170.1097&rep=rep1&type=pdf
 //   "Correct and Efficient Work-Stealing for Weak Memory Models":
@@ -78,8 +73,6 @@ extern "C" {
 //   https://blog.molecular-matters.com/2015/08/24/job-system-2-0-lock-free-work-stealing-part-1-basics/
 //
 // Useful diagram from https://github.com/injinj/WSQ
-// Much of this implementation is inspired from that; though significant
-// reworking was required for our FIFO->LIFO->FIFO sandwich.
 //  +--------+ <- tasks[0]
 //  |  top   | <- stealers consume here: task = tasks[top++]
 //  |        |
@@ -90,24 +83,18 @@ extern "C" {
 //  |        |    owner consumes here:  task = tasks[--bottom]
 //  |        |
 //  +--------+ <- tasks[IREE_TASK_QUEUE_CAPACITY-1]
-//
-// Unlike that implementation, though, our task list is unbounded because we use
-// a linked list. To keep our options open, though, I've left the API of this
-// implementation compatible with classic atomic work-stealing queues. I'm
-// hopeful this will not need to be revisted for awhile, though!
-//
-// Future improvement idea: have the owner of the queue maintain a theft point
-// skip list that makes it possible for thieves to quickly come in and slice
-// off batches of tasks at the tail of the queue. Since we are a singly-linked
-// list we can't easily just walk backward and we don't want to be introducing
-// cache line contention as thieves start touching the same tasks as the worker
-// is while processing.
 typedef struct iree_task_queue_t {
-  // Must be held when manipulating the queue. >90% accesses are by the owner.
-  iree_slim_mutex_t mutex;
+  // Index one past the next task the owner will pop. Only written by the owner.
+  iree_atomic_int64_t bottom;
+  // Index of the next task a thief will steal. Advanced by compare-exchange.
+  iree_atomic_int64_t top;
 
-  // FIFO task list.
-  iree_task_list_t list IREE_GUARDED_BY(mutex);
+  // FIFO list of tasks that will run after all tasks in the ring.
+  // Only accessed by the owner.
+  iree_task_list_t overflow_list;
+
+  // Ring of iree_task_t* indexed by top/bottom modulo the capacity.
+  iree_atomic_intptr_t tasks[IREE_TASK_QUEUE_CAPACITY];
 } iree_task_queue_t;
 
 // Initializes a work-stealing task queue in-place.
@@ -118,7 +105,9 @@ void iree_task_queue_initialize(iree_task_queue_t* out_queue);
 void iree_task_queue_deinitialize(iree_task_queue_t* queue);
 
 // Returns true if the queue is empty.
-// Note that due to races this may return both false-positives and -negatives.
+// Note that due to races with thieves this may return false-negatives.
+//
+// Must only be called from the owning worker's thread.
 bool iree_task_queue_is_empty(iree_task_queue_t* queue);
 
 // Pushes a task to the front of the queue.
@@ -154,7 +143,7 @@ iree_task_t* iree_task_queue_pop_front(iree_task_queue_t* queue);
 // |target_queue| and the first of the stolen tasks is returned.
 //
 // It's expected this is not called from the queue's owning worker, though it's
-// valid to do so.
+// valid to do so. |target_queue| must be owned by the calling thread.
 iree_task_t* iree_task_queue_try_steal(iree_task_queue_t* source_queue,
                                        iree_task_queue_t* target_queue,
                                        iree_host_size_t max_tasks);
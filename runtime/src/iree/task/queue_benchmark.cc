@@ -0,0 +1,108 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "iree/task/queue.h"
+
+namespace {
+
+// Emulates the work of executing a small tile.
+static void SpinDelay(int count) {
+  int data = 0;
+  for (int i = 0; i < count; ++i) {
+    ++data;
+    benchmark::DoNotOptimize(data);
+  }
+}
+
+// Builds a LIFO list of |tasks| as a coordinator would post to a worker.
+static void MakeLifoList(std::vector<iree_task_t>& tasks,
+                         iree_task_list_t* out_list) {
+  iree_task_list_initialize(out_list);
+  for (auto& task : tasks) {
+    memset(&task, 0, sizeof(task));
+    iree_task_list_push_front(out_list, &task);
+  }
+}
+
+// Owner-only traffic: flushing a batch of tasks and popping them one by one.
+void BM_QueueOwnerPushPop(benchmark::State& state) {
+  iree_task_queue_t queue;
+  iree_task_queue_initialize(&queue);
+  std::vector<iree_task_t> tasks(state.range(0));
+  for (auto _ : state) {
+    iree_task_list_t list;
+    MakeLifoList(tasks, &list);
+    iree_task_queue_append_from_lifo_list_unsafe(&queue, &list);
+    while (iree_task_t* task = iree_task_queue_pop_front(&queue)) {
+      benchmark::DoNotOptimize(task);
+    }
+  }
+  iree_task_queue_deinitialize(&queue);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_QueueOwnerPushPop)->Arg(64)->Arg(512)->Arg(4096);
+
+// Heavy fan-out: one worker receives a large batch of small tasks and
+// state.range(0) idle workers continuously try to steal from it. Each iteration
+// completes when every task has been executed by someone.
+void BM_QueueFanOutSteal(benchmark::State& state) {
+  static constexpr int kTaskCount = 2048;
+  static constexpr int kTaskWork = 64;
+  const int thief_count = static_cast<int>(state.range(0));
+
+  iree_task_queue_t victim_queue;
+  iree_task_queue_initialize(&victim_queue);
+  std::vector<iree_task_t> tasks(kTaskCount);
+  std::atomic<int> remaining_count{0};
+  std::atomic<bool> done{false};
+
+  std::vector<std::thread> thieves;
+  for (int i = 0; i < thief_count; ++i) {
+    thieves.emplace_back([&]() {
+      iree_task_queue_t local_queue;
+      iree_task_queue_initialize(&local_queue);
+      while (!done.load(std::memory_order_relaxed)) {
+        iree_task_t* task = iree_task_queue_try_steal(
+            &victim_queue, &local_queue, IREE_TASK_EXECUTOR_MAX_WORKER_COUNT);
+        while (task) {
+          SpinDelay(kTaskWork);
+          remaining_count.fetch_sub(1, std::memory_order_acq_rel);
+          task = iree_task_queue_pop_front(&local_queue);
+        }
+      }
+      iree_task_queue_deinitialize(&local_queue);
+    });
+  }
+
+  for (auto _ : state) {
+    remaining_count.store(kTaskCount, std::memory_order_release);
+    iree_task_list_t list;
+    MakeLifoList(tasks, &list);
+    iree_task_queue_append_from_lifo_list_unsafe(&victim_queue, &list);
+    while (iree_task_t* task = iree_task_queue_pop_front(&victim_queue)) {
+      benchmark::DoNotOptimize(task);
+      SpinDelay(kTaskWork);
+      remaining_count.fetch_sub(1, std::memory_order_acq_rel);
+    }
+    while (remaining_count.load(std::memory_order_acquire) > 0) {
+      std::this_thread::yield();
+    }
+  }
+
+  done.store(true, std::memory_order_relaxed);
+  for (auto& thief : thieves) thief.join();
+  iree_task_queue_deinitialize(&victim_queue);
+  state.SetItemsProcessed(state.iterations() * kTaskCount);
+}
+BENCHMARK(BM_QueueFanOutSteal)->Arg(0)->Arg(1)->Arg(3)->Arg(7)->UseRealTime();
+
+}  // namespace
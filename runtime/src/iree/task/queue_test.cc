@@ -6,6 +6,10 @@
 
 #include "iree/task/queue.h"
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 #include "iree/testing/gtest.h"
 
 namespace {
@@ -319,4 +323,106 @@ TEST(QueueTest, TryStealAll) {
   iree_task_queue_deinitialize(&target_queue);
 }
 
+TEST(QueueTest, AppendListWhileNonEmpty) {
+  iree_task_queue_t queue;
+  iree_task_queue_initialize(&queue);
+
+  iree_task_t task_a = {0};
+  iree_task_t task_b = {0};
+  iree_task_list_t list = {0};
+  iree_task_list_push_front(&list, &task_a);
+  iree_task_queue_append_from_lifo_list_unsafe(&queue, &list);
+  iree_task_list_push_front(&list, &task_b);
+  iree_task_queue_append_from_lifo_list_unsafe(&queue, &list);
+
+  // Tasks appended later run after the tasks already in the queue.
+  EXPECT_EQ(&task_a, iree_task_queue_pop_front(&queue));
+  EXPECT_EQ(&task_b, iree_task_queue_pop_front(&queue));
+  EXPECT_TRUE(iree_task_queue_is_empty(&queue));
+
+  iree_task_queue_deinitialize(&queue);
+}
+
+TEST(QueueTest, AppendBeyondCapacity) {
+  iree_task_queue_t queue;
+  iree_task_queue_initialize(&queue);
+
+  // Make a lifo list with more tasks than fit in the stealable ring.
+  std::vector<iree_task_t> tasks(IREE_TASK_QUEUE_CAPACITY * 2 + 3);
+  iree_task_list_t list = {0};
+  for (auto& task : tasks) {
+    memset(&task, 0, sizeof(task));
+    iree_task_list_push_front(&list, &task);
+  }
+  iree_task_queue_append_from_lifo_list_unsafe(&queue, &list);
+
+  // A task pushed to the front runs first even with the ring full.
+  iree_task_t task_front = {0};
+  iree_task_queue_push_front(&queue, &task_front);
+  EXPECT_EQ(&task_front, iree_task_queue_pop_front(&queue));
+
+  for (auto& task : tasks) {
+    EXPECT_EQ(&task, iree_task_queue_pop_front(&queue));
+  }
+  EXPECT_TRUE(iree_task_queue_is_empty(&queue));
+
+  iree_task_queue_deinitialize(&queue);
+}
+
+// Races thieves against the owner and ensures every task is taken once.
+TEST(QueueTest, ConcurrentSteal) {
+  static constexpr int kThiefCount = 4;
+  static constexpr int kRoundCount = 64;
+  static constexpr int kTaskCount = 256;
+
+  iree_task_queue_t source_queue;
+  iree_task_queue_initialize(&source_queue);
+  std::vector<iree_task_t> tasks(kTaskCount);
+  std::vector<std::atomic<int>> task_counts(kTaskCount);
+  std::atomic<int> remaining_count{0};
+  std::atomic<bool> done{false};
+
+  auto take = [&](iree_task_t* task) {
+    ++task_counts[task - tasks.data()];
+    --remaining_count;
+  };
+
+  std::vector<std::thread> thieves;
+  for (int i = 0; i < kThiefCount; ++i) {
+    thieves.emplace_back([&]() {
+      iree_task_queue_t target_queue;
+      iree_task_queue_initialize(&target_queue);
+      while (!done.load()) {
+        iree_task_t* task =
+            iree_task_queue_try_steal(&source_queue, &target_queue, 8);
+        while (task) {
+          take(task);
+          task = iree_task_queue_pop_front(&target_queue);
+        }
+      }
+      iree_task_queue_deinitialize(&target_queue);
+    });
+  }
+
+  for (int round = 0; round < kRoundCount; ++round) {
+    for (auto& count : task_counts) count = 0;
+    remaining_count = kTaskCount;
+    iree_task_list_t list = {0};
+    for (auto& task : tasks) {
+      memset(&task, 0, sizeof(task));
+      iree_task_list_push_front(&list, &task);
+    }
+    iree_task_queue_append_from_lifo_list_unsafe(&source_queue, &list);
+    while (iree_task_t* task = iree_task_queue_pop_front(&source_queue)) {
+      take(task);
+    }
+    while (remaining_count.load() > 0) std::this_thread::yield();
+    for (auto& count : task_counts) ASSERT_EQ(1, count.load());
+  }
+
+  done = true;
+  for (auto& thief : thieves) thief.join();
+  iree_task_queue_deinitialize(&source_queue);
+}
+
 }  // namespace
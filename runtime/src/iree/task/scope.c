@@ -18,6 +18,7 @@ void iree_task_scope_initialize(iree_string_view_t name,
 
   memset(out_scope, 0, sizeof(*out_scope));
   iree_atomic_ref_count_init_value(&out_scope->pending_submissions, 0);
+  out_scope->priority_class = IREE_TASK_PRIORITY_CLASS_NORMAL;
 
   iree_host_size_t name_length =
       iree_min(name.size, IREE_ARRAYSIZE(out_scope->name) - 1);
@@ -32,6 +33,11 @@ void iree_task_scope_initialize(iree_string_view_t name,
   IREE_TRACE_ZONE_END(z0);
 }
 
+void iree_task_scope_set_priority_class(
+    iree_task_scope_t* scope, iree_task_priority_class_t priority_class) {
+  scope->priority_class = priority_class;
+}
+
 void iree_task_scope_deinitialize(iree_task_scope_t* scope) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
@@ -49,6 +49,9 @@ typedef struct iree_task_scope_t {
   // Name used for logging and tracing.
   char name[16];
 
+  // Scheduling priority class assigned to tasks initialized with this scope.
+  iree_task_priority_class_t priority_class;
+
   // Base color used for tasks in this scope.
   // The color will be modulated based on task type.
   IREE_TRACE(uint32_t task_trace_color;)
@@ -81,6 +84,12 @@ typedef struct iree_task_scope_t {
 void iree_task_scope_initialize(iree_string_view_t name,
                                 iree_task_scope_t* out_scope);
 
+// Sets the scheduling priority class of tasks initialized with the scope.
+// Tasks already initialized retain their prior class. Defaults to
+// IREE_TASK_PRIORITY_CLASS_NORMAL.
+void iree_task_scope_set_priority_class(
+    iree_task_scope_t* scope, iree_task_priority_class_t priority_class);
+
 // Deinitializes an task scope.
 // No tasks may be pending and the scope must be idle.
 void iree_task_scope_deinitialize(iree_task_scope_t* scope);
@@ -33,6 +33,25 @@ TEST(ScopeTest, LongNameTruncation) {
   iree_task_scope_deinitialize(&scope);
 }
 
+// Tasks inherit the priority class of their scope at initialization.
+TEST(ScopeTest, PriorityClass) {
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope_a"), &scope);
+  iree_task_nop_t normal_task;
+  iree_task_nop_initialize(&scope, &normal_task);
+  EXPECT_EQ(IREE_TASK_PRIORITY_CLASS_NORMAL, normal_task.header.priority_class);
+
+  iree_task_scope_set_priority_class(&scope, IREE_TASK_PRIORITY_CLASS_HIGH);
+  iree_task_nop_t high_task;
+  iree_task_nop_initialize(&scope, &high_task);
+  EXPECT_EQ(IREE_TASK_PRIORITY_CLASS_HIGH, high_task.header.priority_class);
+  EXPECT_EQ(IREE_TASK_PRIORITY_CLASS_NORMAL, normal_task.header.priority_class);
+
+  iree_task_set_priority_class(&high_task.header, IREE_TASK_PRIORITY_CLASS_LOW);
+  EXPECT_EQ(IREE_TASK_PRIORITY_CLASS_LOW, high_task.header.priority_class);
+  iree_task_scope_deinitialize(&scope);
+}
+
 TEST(ScopeTest, AbortEmpty) {
   iree_task_scope_t scope;
   iree_task_scope_initialize(iree_make_cstring_view("scope_a"), &scope);
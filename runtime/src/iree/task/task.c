@@ -29,6 +29,13 @@ void iree_task_initialize(iree_task_type_t type, iree_task_scope_t* scope,
   out_task->scope = scope;
   out_task->affinity_set = iree_task_affinity_for_any_worker();
   out_task->type = type;
+  out_task->priority_class =
+      scope ? scope->priority_class : IREE_TASK_PRIORITY_CLASS_NORMAL;
+}
+
+void iree_task_set_priority_class(iree_task_t* task,
+                                  iree_task_priority_class_t priority_class) {
+  task->priority_class = priority_class;
 }
 
 void iree_task_set_cleanup_fn(iree_task_t* task,
@@ -608,6 +615,9 @@ void iree_task_dispatch_issue(iree_task_dispatch_t* dispatch_task,
   iree_host_size_t worker_count = iree_task_post_batch_worker_count(post_batch);
   iree_host_size_t shard_count =
       iree_min(dispatch_task->tile_count, worker_count);
+  dispatch_task->max_concurrency =
+      (uint32_t)iree_task_affinity_set_count_workers(
+          dispatch_task->header.affinity_set, worker_count);
 
   // Compute how many tiles we want each shard to reserve at a time from the
   // larger grid. A higher number reduces overhead and improves locality while
@@ -684,15 +694,11 @@ void iree_task_dispatch_retire(iree_task_dispatch_t* dispatch_task,
 // IREE_TASK_TYPE_DISPATCH_SHARD
 //==============================================================================
 
-static inline iree_task_dispatch_t* iree_task_dispatch_shard_parent(
-    iree_task_dispatch_shard_t* task) {
-  return (iree_task_dispatch_t*)task->header.completion_task;
-}
-
 void iree_task_dispatch_shard_initialize(iree_task_dispatch_t* dispatch_task,
                                          iree_task_dispatch_shard_t* out_task) {
   iree_task_initialize(IREE_TASK_TYPE_DISPATCH_SHARD,
                        dispatch_task->header.scope, &out_task->header);
+  out_task->header.priority_class = dispatch_task->header.priority_class;
   iree_task_set_completion_task(&out_task->header, &dispatch_task->header);
 }
 
@@ -710,9 +716,10 @@ iree_task_dispatch_shard_t* iree_task_dispatch_shard_allocate(
   return shard_task;
 }
 
-void iree_task_dispatch_shard_execute(
+bool iree_task_dispatch_shard_execute(
     iree_task_dispatch_shard_t* task, iree_cpu_processor_id_t processor_id,
     uint32_t worker_id, iree_byte_span_t worker_local_memory,
+    iree_atomic_int32_t* preemption_mask,
     iree_task_submission_t* pending_submission) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
@@ -730,12 +737,12 @@ void iree_task_dispatch_shard_execute(
         &dispatch_task->status,
         iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
                          "dispatch requires %ub of local memory but only "
-                         "%zub is available per-worker",
+                         "%zub could be reserved by the worker",
                          dispatch_task->local_memory_size,
                          worker_local_memory.data_length));
     iree_task_retire(&task->header, pending_submission, iree_ok_status());
     IREE_TRACE_ZONE_END(z0);
-    return;
+    return false;
   }
   iree_byte_span_t local_memory = iree_make_byte_span(
       worker_local_memory.data, dispatch_task->local_memory_size);
@@ -749,6 +756,7 @@ void iree_task_dispatch_shard_execute(
   uint32_t workgroup_count_x = tile_context.workgroup_count[0];
   uint32_t workgroup_count_y = tile_context.workgroup_count[1];
   tile_context.worker_id = worker_id;
+  tile_context.max_concurrency = dispatch_task->max_concurrency;
   tile_context.local_memory = local_memory;
 
   // We perform all our shard statistics work locally here and only push back to
@@ -761,6 +769,11 @@ void iree_task_dispatch_shard_execute(
   // Hint as to which processor we are running on.
   tile_context.processor_id = processor_id;
 
+  // Priority classes more important than our own; if work of any of them is
+  // posted to the worker we stop reserving tiles and yield to it.
+  const int32_t preempting_classes = (1 << task->header.priority_class) - 1;
+  bool did_yield = false;
+
   // Loop over all tiles until they are all processed.
   const uint32_t tile_count = dispatch_task->tile_count;
   const uint32_t tiles_per_reservation = dispatch_task->tiles_per_reservation;
@@ -815,6 +828,17 @@ void iree_task_dispatch_shard_execute(
       }
     }
 
+    // Yield before reserving more tiles if more important work is waiting.
+    // The remaining tiles stay available to this shard (once re-executed) and
+    // all other shards of the dispatch.
+    // relaxed order because the mask is only a hint to look at the mailbox.
+    if (IREE_UNLIKELY(iree_atomic_load_int32(preemption_mask,
+                                             iree_memory_order_relaxed) &
+                      preempting_classes)) {
+      did_yield = true;
+      break;
+    }
+
     // Try to grab the next slice of tiles.
     tile_base = iree_atomic_fetch_add_int32(&dispatch_task->tile_index,
                                             tiles_per_reservation,
@@ -828,8 +852,15 @@ abort_shard:
   iree_task_dispatch_statistics_merge(&shard_statistics,
                                       &dispatch_task->statistics);
 
+  if (did_yield) {
+    IREE_TRACE_ZONE_APPEND_TEXT(z0, "yielded");
+    IREE_TRACE_ZONE_END(z0);
+    return true;
+  }
+
   // NOTE: even if an error was hit we retire OK - the error has already been
   // propagated to the dispatch and it'll clean up after all shards are joined.
   iree_task_retire(&task->header, pending_submission, iree_ok_status());
   IREE_TRACE_ZONE_END(z0);
+  return false;
 }
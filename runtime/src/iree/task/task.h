@@ -120,6 +120,26 @@ enum iree_task_flag_bits_t {
 };
 typedef uint16_t iree_task_flags_t;
 
+// Scheduling priority class of a task.
+// Workers always prefer ready tasks of a more important class (lower value)
+// and dispatch shards yield between tile reservations when more important work
+// is posted to the worker running them. To avoid starving less important
+// classes workers periodically run them ahead of more important work; see
+// IREE_TASK_WORKER_MAX_PRIORITY_STREAK.
+enum iree_task_priority_class_bits_t {
+  // Latency-critical work such as interactive requests.
+  IREE_TASK_PRIORITY_CLASS_HIGH = 0u,
+  // Default class for all tasks.
+  IREE_TASK_PRIORITY_CLASS_NORMAL = 1u,
+  // Throughput-oriented work such as offline batch processing that can
+  // tolerate being delayed by other classes.
+  IREE_TASK_PRIORITY_CLASS_LOW = 2u,
+
+  // Total number of priority classes.
+  IREE_TASK_PRIORITY_CLASS_COUNT = 3u,
+};
+typedef uint8_t iree_task_priority_class_t;
+
 typedef struct iree_task_t iree_task_t;
 
 // A function called to cleanup tasks.
@@ -178,6 +198,9 @@ struct iree_alignas(iree_max_align_t) iree_task_t {
   // Specifies the type of the task and how the executor handles it.
   iree_task_type_t type;
 
+  // Scheduling priority class of the task inherited from its scope.
+  iree_task_priority_class_t priority_class;
+
   // Task-specific flag bits.
   iree_task_flags_t flags;
 };
@@ -195,6 +218,11 @@ static_assert(sizeof(iree_task_t) <= 64,
 void iree_task_initialize(iree_task_type_t type, iree_task_scope_t* scope,
                           iree_task_t* out_task);
 
+// Overrides the scheduling priority class the task inherited from its scope.
+// Must be called prior to the task being submitted.
+void iree_task_set_priority_class(iree_task_t* task,
+                                  iree_task_priority_class_t priority_class);
+
 // Sets the optional function called when the task completes (whether successful
 // or not). The cleanup function will receive a status indicating whether the
 // cleanup is from expected execution as the task retires (IREE_STATUS_OK)
@@ -539,6 +567,10 @@ typedef iree_alignas(iree_max_align_t) struct {
   // Worker that is processing the tile, [0, worker_capacity).
   uint32_t worker_id;
 
+  // Maximum number of workers that may process tiles of the dispatch
+  // concurrently: the executor workers allowed by the dispatch affinity set.
+  uint32_t max_concurrency;
+
   // Tile-local memory that is pinned to each worker ensuring no cache
   // thrashing. Aligned to at least the natural pointer size of the machine.
   // Contents are (today) undefined upon entry.
@@ -646,6 +678,10 @@ typedef iree_alignas(iree_max_align_t) struct iree_task_dispatch_t {
   // reasonable number chosen based on the tile and shard counts.
   uint32_t tiles_per_reservation;
 
+  // Number of executor workers allowed by the dispatch affinity set.
+  // Computed when the dispatch is issued and passed on to tiles.
+  uint32_t max_concurrency;
+
   // The tail tile index; the next reservation will start from here.
   // This is used by shards to slice off the work to perform in their inner
   // loop. Ideally we'd have no destructive interference with other shared data
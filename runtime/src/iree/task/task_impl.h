@@ -17,6 +17,14 @@
 extern "C" {
 #endif
 
+// The issue/retire functions below are called by the thread that owns the task
+// at the time: usually one coordinating an executor coordinator shard. Threads
+// coordinating different shards run concurrently and there is no executor-wide
+// lock. Each task is owned by one thread at a time and dependent tasks are
+// released by atomically decrementing their pending_dependency_count so only
+// the thread that drops a count to 0 adds the dependent to its
+// |pending_submission|.
+
 //==============================================================================
 // IREE_TASK_TYPE_NOP
 //==============================================================================
@@ -46,7 +54,8 @@ void iree_task_call_execute(iree_task_call_t* task,
 // Retires a barrier task by notifying all dependent tasks.
 // May add zero or more tasks to the |pending_submission| if they are ready.
 //
-// Only called during coordination and expects the coordinator lock to be held.
+// Other threads may be retiring tasks that share dependents with the barrier
+// at the same time; each dependent is only readied once.
 void iree_task_barrier_retire(iree_task_barrier_t* task,
                               iree_task_submission_t* pending_submission);
 
@@ -56,7 +65,8 @@ void iree_task_barrier_retire(iree_task_barrier_t* task,
 
 // Retires a fence task by updating the scope state.
 //
-// Only called during coordination and expects the coordinator lock to be held.
+// Ends the scope of the fence and may wake threads waiting on it to go idle.
+// The task must not be touched after this returns.
 void iree_task_fence_retire(iree_task_fence_t* task,
                             iree_task_submission_t* pending_submission);
 
@@ -66,12 +76,13 @@ void iree_task_fence_retire(iree_task_fence_t* task,
 
 // Returns true if the user-specified condition on the task is true.
 //
-// Only called during coordination and expects the coordinator lock to be held.
+// Only reads the wait task state and can be called by its owning thread at any
+// time.
 bool iree_task_wait_check_condition(iree_task_wait_t* task);
 
 // Retires a wait when it has completed waiting (successfully or not).
 //
-// Only called during coordination and expects the coordinator lock to be held.
+// Called from coordination or by the poller thread once the wait resolves.
 void iree_task_wait_retire(iree_task_wait_t* task,
                            iree_task_submission_t* pending_submission,
                            iree_status_t status);
@@ -86,7 +97,9 @@ void iree_task_wait_retire(iree_task_wait_t* task,
 // execution prior to the shards and end execution after the last shard
 // finishes.
 //
-// Only called during coordination and expects the coordinator lock to be held.
+// Shards are posted to workers through the caller's |post_batch|. Issuing
+// reads the executor worker count and selects workers using atomic idle masks
+// so concurrent coordinators may issue different dispatches at once.
 void iree_task_dispatch_issue(iree_task_dispatch_t* dispatch_task,
                               iree_task_pool_t* shard_task_pool,
                               iree_task_submission_t* pending_submission,
@@ -94,7 +107,8 @@ void iree_task_dispatch_issue(iree_task_dispatch_t* dispatch_task,
 
 // Retires a dispatch when all issued shards have completed executing.
 //
-// Only called during coordination and expects the coordinator lock to be held.
+// Each shard holds a dependency on the dispatch so it is readied for retirement
+// exactly once by whichever thread retired the last shard.
 void iree_task_dispatch_retire(iree_task_dispatch_t* dispatch_task,
                                iree_task_submission_t* pending_submission);
 
@@ -107,6 +121,12 @@ void iree_task_dispatch_retire(iree_task_dispatch_t* dispatch_task,
 iree_task_dispatch_shard_t* iree_task_dispatch_shard_allocate(
     iree_task_dispatch_t* dispatch_task, iree_task_pool_t* shard_task_pool);
 
+// Returns the dispatch task that |task| is a shard of.
+static inline iree_task_dispatch_t* iree_task_dispatch_shard_parent(
+    iree_task_dispatch_shard_t* task) {
+  return (iree_task_dispatch_t*)task->header.completion_task;
+}
+
 // Executes and retires a dispatch shard task.
 // May block the caller for an indeterminate amount of time and should only be
 // called from threads owned by or donated to the executor.
@@ -117,12 +137,23 @@ iree_task_dispatch_shard_t* iree_task_dispatch_shard_allocate(
 //
 // |worker_local_memory| is a block of memory exclusively available to the shard
 // during execution. Contents are undefined both before and after execution.
+// Workers reserve at least the dispatch local_memory_size when possible and
+// the shard fails if the block is smaller than that.
+//
+// |preemption_mask| is a bitmask of the priority classes of work that has
+// been posted to the executing worker. Between tile reservations the shard
+// yields if work of a more important class than its own has been posted. A
+// yielded shard has not retired and must be executed again (by any worker) to
+// process the remaining tiles.
 //
 // Errors are propagated to the parent scope and the dispatch will fail once
 // all shards have completed.
-void iree_task_dispatch_shard_execute(
+//
+// Returns true if the shard yielded and false if it retired.
+bool iree_task_dispatch_shard_execute(
     iree_task_dispatch_shard_t* task, iree_cpu_processor_id_t processor_id,
     uint32_t worker_id, iree_byte_span_t worker_local_memory,
+    iree_atomic_int32_t* preemption_mask,
     iree_task_submission_t* pending_submission);
 
 #ifdef __cplusplus
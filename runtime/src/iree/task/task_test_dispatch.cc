@@ -6,11 +6,13 @@
 
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
 #include <memory>
 
 #include "iree/base/api.h"
 #include "iree/task/submission.h"
 #include "iree/task/task.h"
+#include "iree/task/tuning.h"
 #include "iree/task/testing/task_test.h"
 #include "iree/testing/gtest.h"
 #include "iree/testing/status_matchers.h"
@@ -214,4 +216,95 @@ TEST_F(TaskDispatchTest, IssueFailureChained) {
               StatusIs(StatusCode::kDataLoss));
 }
 
+// Dispatches requiring more local memory than reserved by the workers grow the
+// worker local arenas and smaller dispatches after them reuse the storage.
+TEST_F(TaskDispatchTest, LocalMemoryGrowth) {
+  IREE_TRACE_SCOPE();
+
+  const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  const uint32_t kWorkgroupCount[3] = {64, 1, 1};
+
+  auto tile = [](void* user_context,
+                 const iree_task_tile_context_t* tile_context,
+                 iree_task_submission_t* pending_submission) -> iree_status_t {
+    IREE_TRACE_SCOPE();
+    const uint32_t local_memory_size = *(const uint32_t*)user_context;
+    if (tile_context->local_memory.data_length != local_memory_size) {
+      return iree_make_status(IREE_STATUS_INTERNAL,
+                              "local memory size mismatch");
+    }
+    if ((uintptr_t)tile_context->local_memory.data %
+            iree_hardware_destructive_interference_size !=
+        0) {
+      return iree_make_status(IREE_STATUS_INTERNAL,
+                              "local memory is not aligned");
+    }
+    memset(tile_context->local_memory.data, 0xCD, local_memory_size);
+    return iree_ok_status();
+  };
+
+  const uint32_t kLocalMemorySizes[] = {
+      1024,
+      256 * 1024,
+      4 * 1024,
+      IREE_TASK_EXECUTOR_LOCAL_MEMORY_BLOCK_SIZE,
+  };
+  for (size_t i = 0; i < IREE_ARRAYSIZE(kLocalMemorySizes); ++i) {
+    uint32_t local_memory_size = kLocalMemorySizes[i];
+    iree_task_dispatch_t task;
+    iree_task_dispatch_initialize(
+        &scope_,
+        iree_task_make_dispatch_closure(tile, (void*)&local_memory_size),
+        kWorkgroupSize, kWorkgroupCount, &task);
+    task.local_memory_size = local_memory_size;
+    IREE_ASSERT_OK(SubmitTasksAndWaitIdle(&task.header, &task.header));
+    IREE_EXPECT_OK(iree_task_scope_consume_status(&scope_));
+  }
+}
+
+// Tiles are told how many workers may run the dispatch concurrently based on
+// the executor worker count and the dispatch affinity.
+TEST_F(TaskDispatchTest, MaxConcurrency) {
+  IREE_TRACE_SCOPE();
+
+  const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  const uint32_t kWorkgroupCount[3] = {16, 1, 1};
+
+  auto tile = [](void* user_context,
+                 const iree_task_tile_context_t* tile_context,
+                 iree_task_submission_t* pending_submission) -> iree_status_t {
+    const uint32_t expected_concurrency = *(const uint32_t*)user_context;
+    return tile_context->max_concurrency == expected_concurrency
+               ? iree_ok_status()
+               : iree_make_status(IREE_STATUS_INTERNAL,
+                                  "max_concurrency %u != %u",
+                                  tile_context->max_concurrency,
+                                  expected_concurrency);
+  };
+
+  const iree_host_size_t worker_count =
+      iree_task_executor_worker_count(executor_);
+  struct {
+    iree_task_affinity_set_t affinity_set;
+    uint32_t expected_concurrency;
+  } cases[] = {
+      {iree_task_affinity_for_any_worker(), (uint32_t)worker_count},
+      {iree_task_affinity_for_worker(0) | iree_task_affinity_for_worker(2), 2},
+      {iree_task_affinity_for_worker(0) |
+           iree_task_affinity_for_worker((uint8_t)worker_count),
+       1},
+  };
+  for (auto& test_case : cases) {
+    iree_task_dispatch_t task;
+    iree_task_dispatch_initialize(
+        &scope_,
+        iree_task_make_dispatch_closure(tile,
+                                        &test_case.expected_concurrency),
+        kWorkgroupSize, kWorkgroupCount, &task);
+    task.header.affinity_set = test_case.affinity_set;
+    IREE_ASSERT_OK(SubmitTasksAndWaitIdle(&task.header, &task.header));
+    IREE_EXPECT_OK(iree_task_scope_consume_status(&scope_));
+  }
+}
+
 }  // namespace
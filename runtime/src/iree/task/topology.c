@@ -14,7 +14,7 @@
 #include "iree/base/tracing.h"
 
 void iree_task_topology_group_initialize(
-    uint8_t group_index, iree_task_topology_group_t* out_group) {
+    uint16_t group_index, iree_task_topology_group_t* out_group) {
   memset(out_group, 0, sizeof(*out_group));
   out_group->group_index = group_index;
   snprintf(out_group->name, IREE_ARRAYSIZE(out_group->name), "iree-worker-%u",
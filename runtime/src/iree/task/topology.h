@@ -41,8 +41,11 @@ iree_task_topology_node_id_t iree_task_topology_query_current_node(void);
 // Topology group (worker thread(s) assigned to a processor)
 //===----------------------------------------------------------------------===//
 
-// A bitmask indicating which other groups from 0 to N may constructively share
-// caches. For example, a value of 0b1100 indicates that group 2 and 3 share.
+// A bitmask indicating which other groups within the same worker cluster may
+// constructively share caches. Bit N refers to group
+// (cluster_index * IREE_TASK_EXECUTOR_CLUSTER_WORKER_COUNT + N) where the
+// cluster is the one containing the group the mask belongs to. For example, a
+// value of 0b1100 on group 70 indicates that groups 66 and 67 share.
 typedef uint64_t iree_task_topology_group_mask_t;
 
 #define IREE_TASK_TOPOLOGY_GROUP_MASK_ALL UINT64_MAX
@@ -53,12 +56,12 @@ typedef uint64_t iree_task_topology_group_mask_t;
 // Groups may be of varying levels of granularity even within the same topology
 // based on how the topology is defined.
 typedef struct iree_task_topology_group_t {
-  // Group index within the topology matching a particular bit in
-  // iree_task_topology_group_mask_t.
-  uint8_t group_index;
+  // Group index within the topology matching a particular bit in the
+  // iree_task_topology_group_mask_t of its worker cluster.
+  uint16_t group_index;
 
   // A name assigned to executor workers used for logging/tracing.
-  char name[32 - /*group_index*/ 1];
+  char name[32 - /*group_index*/ 2];
 
   // Processor index in the cpuinfo set.
   uint32_t processor_index;
@@ -72,12 +75,13 @@ typedef struct iree_task_topology_group_t {
   // hierarchy. Workers of this group are more likely to constructively share
   // some cache levels higher up with these other groups. For example, if the
   // workers in a group all share an L2 cache then the groups indicated here may
-  // all share the same L3 cache.
+  // all share the same L3 cache. Only groups in the same worker cluster are
+  // represented.
   iree_task_topology_group_mask_t constructive_sharing_mask;
 } iree_task_topology_group_t;
 
 // Initializes |out_group| with a |group_index| derived name.
-void iree_task_topology_group_initialize(uint8_t group_index,
+void iree_task_topology_group_initialize(uint16_t group_index,
                                          iree_task_topology_group_t* out_group);
 
 //===----------------------------------------------------------------------===//
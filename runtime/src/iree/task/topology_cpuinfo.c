@@ -10,6 +10,7 @@
 #include "iree/base/internal/math.h"
 #include "iree/base/target_platform.h"
 #include "iree/base/tracing.h"
+#include "iree/task/affinity_set.h"
 #include "iree/task/topology.h"
 
 // Initializes |out_topology| with a standardized behavior when cpuinfo is not
@@ -133,33 +134,20 @@ static void iree_task_topology_set_affinity_from_processor(
 #endif  // cpuinfo-like platform field
 }
 
-// Returns a bitset with all *processors* that share the same |cache|.
-static uint64_t iree_task_topology_calculate_cache_bits(
-    const struct cpuinfo_cache* cache) {
-  if (!cache) return 0;
-  uint64_t mask = 0;
-  for (uint32_t processor_i = 0; processor_i < cache->processor_count;
-       ++processor_i) {
-    uint32_t i = cache->processor_start + processor_i;
-    if (i < IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT) {
-      mask |= 1ull << i;
-    }
-  }
-  return mask;
-}
-
-// Constructs a constructive sharing mask for all *processors* that share the
-// same cache as the specified |processor|.
-static uint64_t iree_task_topology_calculate_constructive_sharing_mask(
-    const struct cpuinfo_processor* processor) {
-  uint64_t mask = 0;
-  mask |= iree_task_topology_calculate_cache_bits(processor->cache.l1i);
-  mask |= iree_task_topology_calculate_cache_bits(processor->cache.l1d);
-  mask |= iree_task_topology_calculate_cache_bits(processor->cache.l2);
+// Returns true if |processor| and |other_processor| share a cache that can be
+// used for constructive sharing.
+static bool iree_task_topology_processors_share_cache(
+    const struct cpuinfo_processor* processor,
+    const struct cpuinfo_processor* other_processor) {
   // TODO(benvanik): include L3 here too (for systems that have it)? Or use L3
   // info purely for distribution and focus the group mask on lower-latency
   // caches?
-  return mask;
+  return (processor->cache.l1i &&
+          processor->cache.l1i == other_processor->cache.l1i) ||
+         (processor->cache.l1d &&
+          processor->cache.l1d == other_processor->cache.l1d) ||
+         (processor->cache.l2 &&
+          processor->cache.l2 == other_processor->cache.l2);
 }
 
 // Populates |our_group| with the information from |core|.
@@ -183,26 +171,30 @@ static void iree_task_topology_group_initialize_from_core(
 // Fixes constructive_sharing_mask values such that they represent other chosen
 // topology groups instead of processor indices. We do this so that code using
 // the topology groups doesn't need to know anything about which physical
-// processor IDs a particular group is mapped to.
+// processor IDs a particular group is mapped to. Masks only cover the worker
+// cluster each group belongs to.
 static void iree_task_topology_fixup_constructive_sharing_masks(
     iree_task_topology_t* topology) {
-  // O(n^2), but n is always <= 64 (and often <= 8).
+  // O(n^2) within each cluster, but n is always <= 64 (and often <= 8).
   for (iree_host_size_t i = 0; i < topology->group_count; ++i) {
     iree_task_topology_group_t* group = &topology->groups[i];
-
-    // Compute the processors that we can constructively share with.
-    uint64_t constructive_sharing_mask =
-        iree_task_topology_calculate_constructive_sharing_mask(
-            cpuinfo_get_processor(group->processor_index));
-
+    const struct cpuinfo_processor* processor =
+        cpuinfo_get_processor(group->processor_index);
+
+    iree_host_size_t cluster_base =
+        iree_task_affinity_cluster_for_worker(i) *
+        IREE_TASK_EXECUTOR_CLUSTER_WORKER_COUNT;
+    iree_host_size_t cluster_end =
+        iree_min(topology->group_count,
+                 cluster_base + IREE_TASK_EXECUTOR_CLUSTER_WORKER_COUNT);
     iree_task_topology_group_mask_t group_mask = 0;
-    for (iree_host_size_t j = 0; j < topology->group_count; ++j) {
+    for (iree_host_size_t j = cluster_base; j < cluster_end; ++j) {
       if (i == j) continue;
       const iree_task_topology_group_t* other_group = &topology->groups[j];
-      uint64_t group_processor_bits =
-          iree_math_rotl_u64(1ull, other_group->processor_index);
-      if (constructive_sharing_mask & group_processor_bits) {
-        group_mask |= iree_math_rotl_u64(1ull, other_group->group_index);
+      if (iree_task_topology_processors_share_cache(
+              processor,
+              cpuinfo_get_processor(other_group->processor_index))) {
+        group_mask |= iree_task_affinity_bit_for_worker(j);
       }
     }
 
@@ -236,7 +228,8 @@ static bool iree_task_topology_core_filter_by_cluster_id(
 static void iree_task_topology_initialize_from_physical_cores_with_filter(
     iree_task_topology_core_filter_t filter_fn, uintptr_t filter_fn_data,
     iree_host_size_t max_core_count, iree_task_topology_t* out_topology) {
-  max_core_count = iree_min(max_core_count, IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT);
+  max_core_count =
+      iree_min(max_core_count, IREE_TASK_EXECUTOR_MAX_WORKER_COUNT);
   if (!iree_task_topology_is_cpuinfo_available()) {
     iree_task_topology_initialize_fallback(max_core_count, out_topology);
     return;
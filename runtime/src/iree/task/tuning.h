@@ -11,11 +11,38 @@
 extern "C" {
 #endif  // __cplusplus
 
+// Number of workers in each worker cluster.
+// Workers are partitioned by index into clusters that each use a uint64_t
+// bitmask to select workers. Scheduling decisions (waking idle workers,
+// picking theft victims, etc) are made against the masks of a single cluster
+// and only fall back to scanning other clusters when nothing local is usable.
+#define IREE_TASK_EXECUTOR_CLUSTER_WORKER_COUNT (64)
+
 // Maximum number of workers that an executor can manage.
-// A 64 worker hard limit is based on us using uint64_t as a bitmask to select
-// workers. It's easy to go smaller (just use fewer bits) if it's known that
-// only <64 will ever be used (such as for devices with 2 cores).
-#define IREE_TASK_EXECUTOR_MAX_WORKER_COUNT (64)
+// Each group of IREE_TASK_EXECUTOR_CLUSTER_WORKER_COUNT workers adds one
+// cluster with its own masks. It's easy to go smaller if it's known that only
+// a few workers will ever be used (such as for devices with 2 cores) and doing
+// so shrinks topologies and the executor bookkeeping.
+#define IREE_TASK_EXECUTOR_MAX_WORKER_COUNT (256)
+
+// Maximum number of worker clusters that an executor can manage.
+#define IREE_TASK_EXECUTOR_MAX_CLUSTER_COUNT       \
+  ((IREE_TASK_EXECUTOR_MAX_WORKER_COUNT +          \
+    IREE_TASK_EXECUTOR_CLUSTER_WORKER_COUNT - 1) / \
+   IREE_TASK_EXECUTOR_CLUSTER_WORKER_COUNT)
+
+// Number of workers sharing a coordinator shard. Each shard has its own
+// incoming task list and at most one thread coordinating it at a time so that
+// concurrent submissions from many threads are scheduled in parallel. Smaller
+// values increase coordination parallelism at the cost of idle workers having
+// more shards to check for work.
+#define IREE_TASK_EXECUTOR_COORDINATOR_SHARD_WORKER_COUNT (8)
+
+// Maximum number of coordinator shards that an executor can manage.
+#define IREE_TASK_EXECUTOR_MAX_COORDINATOR_SHARD_COUNT       \
+  ((IREE_TASK_EXECUTOR_MAX_WORKER_COUNT +                    \
+    IREE_TASK_EXECUTOR_COORDINATOR_SHARD_WORKER_COUNT - 1) / \
+   IREE_TASK_EXECUTOR_COORDINATOR_SHARD_WORKER_COUNT)
 
 // Initial number of shard tasks that are allocated in the executor pool.
 // Increasing this number will decrease initial allocation storms in cases of
@@ -23,6 +50,12 @@ extern "C" {
 // at the cost of a higher minimum memory consumption.
 #define IREE_TASK_EXECUTOR_INITIAL_SHARD_RESERVATION_PER_WORKER (4)
 
+// Size in bytes of the blocks in the executor pool backing the growable
+// per-worker local memory arenas. Dispatches requiring no more than this
+// (minus a small amount of tracking overhead) reuse pooled blocks and larger
+// requirements are allocated directly from the system.
+#define IREE_TASK_EXECUTOR_LOCAL_MEMORY_BLOCK_SIZE (64 * 1024)
+
 // Maximum number of events retained by the executor event pool.
 #define IREE_TASK_EXECUTOR_EVENT_POOL_CAPACITY 64
 
@@ -53,6 +86,30 @@ extern "C" {
 // 1ms may result in 10-15ms.
 #define IREE_TASK_EXECUTOR_DELAY_SLOP_NS (1 /*ms*/ * 1000000)
 
+// Number of tasks each worker-local queue can hold in its lock-free
+// work-stealing array. Must be a power of two. Tasks beyond this are held in a
+// list private to the owning worker and are not visible to thieves until the
+// array drains. Each slot is a pointer so this adds 8 bytes per slot per
+// worker on 64-bit systems.
+#define IREE_TASK_QUEUE_CAPACITY (512)
+
+// Maximum number of consecutive tasks a worker will run from a more important
+// priority class while tasks of a less important class are waiting in its
+// queues. Once reached the worker runs one task from the least important
+// waiting class before returning to strict priority order. Lower values bound
+// the delay of background work more tightly at the cost of latency for
+// important work. Must be greater than 0.
+#define IREE_TASK_WORKER_MAX_PRIORITY_STREAK (16)
+
+// Whether workers count the tasks they execute and time how long each takes
+// (iree_task_executor_priority_statistics_t task_count and busy_time_ns).
+// Costs two clock reads and two counter updates per task so it is off unless
+// requested. Preemption and starvation counts are always recorded as they only
+// change when those events occur.
+#if !defined(IREE_TASK_WORKER_BUSY_STATISTICS_ENABLE)
+#define IREE_TASK_WORKER_BUSY_STATISTICS_ENABLE 0
+#endif  // !IREE_TASK_WORKER_BUSY_STATISTICS_ENABLE
+
 // Allows for dividing the total number of attempts that a worker will make to
 // steal tasks from other workers. By default all other workers will be
 // attempted while setting this to 2, for example, will try for only half of
@@ -78,7 +135,7 @@ extern "C" {
 // lower variance in execution) while in batch mode systems too many tasks is
 // better (as latencies don't matter so long as throughput is maximized).
 #define IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT \
-  IREE_TASK_EXECUTOR_MAX_WORKER_COUNT
+  IREE_TASK_EXECUTOR_CLUSTER_WORKER_COUNT
 
 // Number of tiles that will be batched into a single reservation from the grid.
 // This is a maximum; if there are fewer tiles that would otherwise allow for
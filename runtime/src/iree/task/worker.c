@@ -31,7 +31,11 @@ iree_status_t iree_task_worker_initialize(
 
   out_worker->executor = executor;
   out_worker->worker_index = executor->worker_base_index + worker_index;
-  out_worker->worker_bit = iree_task_affinity_for_worker(worker_index);
+  out_worker->worker_bit = iree_task_affinity_bit_for_worker(worker_index);
+  out_worker->cluster_index =
+      iree_task_affinity_cluster_for_worker(worker_index);
+  out_worker->coordinator_shard_index =
+      worker_index / IREE_TASK_EXECUTOR_COORDINATOR_SHARD_WORKER_COUNT;
   out_worker->ideal_thread_affinity = topology_group->ideal_thread_affinity;
   out_worker->constructive_sharing_mask =
       topology_group->constructive_sharing_mask;
@@ -40,13 +44,23 @@ iree_status_t iree_task_worker_initialize(
   iree_prng_minilcg128_initialize(iree_prng_splitmix64_next(seed_prng),
                                   &out_worker->theft_prng);
   out_worker->local_memory = local_memory;
+  iree_arena_initialize(&executor->local_memory_block_pool,
+                        &out_worker->local_arena);
+  out_worker->local_arena_memory = iree_byte_span_empty();
   out_worker->processor_id = 0;
   out_worker->processor_tag = 0;
 
   iree_notification_initialize(&out_worker->wake_notification);
   iree_notification_initialize(&out_worker->state_notification);
   iree_atomic_task_slist_initialize(&out_worker->mailbox_slist);
-  iree_task_queue_initialize(&out_worker->local_task_queue);
+  iree_atomic_store_int32(&out_worker->mailbox_priority_mask, 0,
+                          iree_memory_order_relaxed);
+  out_worker->priority_streak = 0;
+  memset(out_worker->priority_counters, 0,
+         sizeof(out_worker->priority_counters));
+  for (iree_host_size_t i = 0; i < IREE_TASK_PRIORITY_CLASS_COUNT; ++i) {
+    iree_task_queue_initialize(&out_worker->local_task_queues[i]);
+  }
 
   iree_task_worker_state_t initial_state = IREE_TASK_WORKER_STATE_RUNNING;
   iree_atomic_store_int32(&out_worker->state, initial_state,
@@ -128,35 +142,172 @@ void iree_task_worker_deinitialize(iree_task_worker_t* worker) {
   worker->thread = NULL;
 
   // Release unfinished tasks by flushing the mailbox (which if we're here can't
-  // get anything more posted to it) and then discarding everything we still
-  // have a reference to.
+  // get anything more posted to it). Tasks still in the local queues are
+  // discarded when they are deinitialized below.
   iree_atomic_task_slist_discard(&worker->mailbox_slist);
-  iree_task_list_discard(&worker->local_task_queue.list);
 
   iree_notification_deinitialize(&worker->wake_notification);
   iree_notification_deinitialize(&worker->state_notification);
   iree_atomic_task_slist_deinitialize(&worker->mailbox_slist);
-  iree_task_queue_deinitialize(&worker->local_task_queue);
+  iree_arena_deinitialize(&worker->local_arena);
+  worker->local_arena_memory = iree_byte_span_empty();
+  for (iree_host_size_t i = 0; i < IREE_TASK_PRIORITY_CLASS_COUNT; ++i) {
+    iree_task_queue_deinitialize(&worker->local_task_queues[i]);
+  }
 
   IREE_TRACE_ZONE_END(z0);
 }
 
 void iree_task_worker_post_tasks(iree_task_worker_t* worker,
                                  iree_task_list_t* list) {
+  // Gather the priority classes being posted so that the worker can yield to
+  // them if it is in the middle of less important work.
+  int32_t priority_mask = 0;
+  for (iree_task_t* task = list->head; task != NULL; task = task->next_task) {
+    priority_mask |= 1 << task->priority_class;
+  }
+
   // Move the list into the mailbox. Note that the mailbox is LIFO and this list
   // is concatenated with its current order preserved (which should be LIFO).
   iree_atomic_task_slist_concat(&worker->mailbox_slist, list->head, list->tail);
   memset(list, 0, sizeof(*list));
+
+  // Publish the classes only after the tasks are in the mailbox so that a
+  // worker observing the bits is guaranteed to find the tasks when it flushes.
+  iree_atomic_fetch_or_int32(&worker->mailbox_priority_mask, priority_mask,
+                             iree_memory_order_release);
+}
+
+void iree_task_worker_append_local_tasks(iree_task_worker_t* worker,
+                                         iree_task_list_t* list) {
+  // Split the list by priority class preserving the relative (LIFO) order of
+  // the tasks within each class.
+  iree_task_list_t class_lists[IREE_TASK_PRIORITY_CLASS_COUNT];
+  for (iree_host_size_t i = 0; i < IREE_TASK_PRIORITY_CLASS_COUNT; ++i) {
+    iree_task_list_initialize(&class_lists[i]);
+  }
+  iree_task_t* task = NULL;
+  while ((task = iree_task_list_pop_front(list)) != NULL) {
+    iree_task_list_push_back(&class_lists[task->priority_class], task);
+  }
+  for (iree_host_size_t i = 0; i < IREE_TASK_PRIORITY_CLASS_COUNT; ++i) {
+    if (iree_task_list_is_empty(&class_lists[i])) continue;
+    iree_task_queue_append_from_lifo_list_unsafe(&worker->local_task_queues[i],
+                                                 &class_lists[i]);
+  }
+}
+
+// Moves all tasks posted to the worker mailbox into its local queues.
+static void iree_task_worker_flush_mailbox(iree_task_worker_t* worker) {
+  // Clear the priority mask before flushing: any bits set after this belong to
+  // tasks we may or may not pick up now and at worst cause one extra flush.
+  iree_atomic_exchange_int32(&worker->mailbox_priority_mask, 0,
+                             iree_memory_order_acquire);
+  iree_task_list_t list;
+  iree_task_list_initialize(&list);
+  if (!iree_atomic_task_slist_flush(
+          &worker->mailbox_slist,
+          IREE_ATOMIC_SLIST_FLUSH_ORDER_APPROXIMATE_LIFO, &list.head,
+          &list.tail)) {
+    return;
+  }
+  iree_task_worker_append_local_tasks(worker, &list);
+}
+
+// Moves tasks posted to the worker mailbox into its local queues if any of them
+// are more important than all of the tasks already there. The local queues of
+// those classes are empty and the flushed tasks land in their stealable rings.
+// Otherwise the posted tasks would only be appended to the overflow lists
+// private to the worker and are instead left in the mailbox where thieves can
+// take them until the local queues drain.
+// Must only be called from the worker thread.
+static void iree_task_worker_flush_preempting_mailbox(
+    iree_task_worker_t* worker) {
+  const int32_t mailbox_mask = iree_atomic_load_int32(
+      &worker->mailbox_priority_mask, iree_memory_order_relaxed);
+  if (!mailbox_mask) return;
+  for (iree_host_size_t i = 0; i < IREE_TASK_PRIORITY_CLASS_COUNT; ++i) {
+    if (!iree_task_queue_is_empty(&worker->local_task_queues[i])) return;
+    if (mailbox_mask & (1 << i)) {
+      iree_task_worker_flush_mailbox(worker);
+      return;
+    }
+  }
+}
+
+// Returns true if any of the worker local queues has tasks.
+// Must only be called from the worker thread.
+static bool iree_task_worker_has_local_tasks(iree_task_worker_t* worker) {
+  for (iree_host_size_t i = 0; i < IREE_TASK_PRIORITY_CLASS_COUNT; ++i) {
+    if (!iree_task_queue_is_empty(&worker->local_task_queues[i])) return true;
+  }
+  return false;
+}
+
+// Adds |delta| to a counter only ever written by the owning worker.
+static void iree_task_worker_add_counter(iree_atomic_int64_t* counter,
+                                         int64_t delta) {
+  iree_atomic_store_int64(
+      counter,
+      iree_atomic_load_int64(counter, iree_memory_order_relaxed) + delta,
+      iree_memory_order_relaxed);
+}
+
+// Pops the next task to run from the worker local queues.
+// Tasks of more important classes are preferred but once
+// IREE_TASK_WORKER_MAX_PRIORITY_STREAK of them have run while less important
+// tasks were waiting the least important waiting task is run instead.
+static iree_task_t* iree_task_worker_pop_local_task(
+    iree_task_worker_t* worker) {
+  iree_task_queue_t* queues = worker->local_task_queues;
+  iree_host_size_t class_index = 0;
+  iree_task_t* task = NULL;
+  for (; class_index < IREE_TASK_PRIORITY_CLASS_COUNT; ++class_index) {
+    task = iree_task_queue_pop_front(&queues[class_index]);
+    if (task) break;
+  }
+  if (!task) return NULL;
+
+  // Find the least important class that is waiting behind this task, if any.
+  iree_host_size_t starved_class_index = class_index;
+  for (iree_host_size_t i = IREE_TASK_PRIORITY_CLASS_COUNT - 1; i > class_index;
+       --i) {
+    if (!iree_task_queue_is_empty(&queues[i])) {
+      starved_class_index = i;
+      break;
+    }
+  }
+  if (starved_class_index == class_index) {
+    worker->priority_streak = 0;
+    return task;
+  } else if (++worker->priority_streak < IREE_TASK_WORKER_MAX_PRIORITY_STREAK) {
+    return task;
+  }
+
+  // Streak exhausted: put the task back and run the starved task instead. If
+  // a thief took it in the meantime we just continue with the original task.
+  worker->priority_streak = 0;
+  iree_task_t* starved_task =
+      iree_task_queue_pop_front(&queues[starved_class_index]);
+  if (!starved_task) return task;
+  iree_task_queue_push_front(&queues[class_index], task);
+  iree_task_worker_add_counter(
+      &worker->priority_counters[starved_class_index].starvation_count, 1);
+  return starved_task;
 }
 
 iree_task_t* iree_task_worker_try_steal_task(iree_task_worker_t* worker,
-                                             iree_task_queue_t* target_queue,
+                                             iree_task_queue_t* target_queues,
                                              iree_host_size_t max_tasks) {
-  // Try to grab tasks from the worker; if more than one task is stolen then the
-  // first will be returned and the remaining will be added to the target queue.
-  iree_task_t* task = iree_task_queue_try_steal(&worker->local_task_queue,
-                                                target_queue, max_tasks);
-  if (task) return task;
+  // Try to grab tasks from the worker starting with the most important class;
+  // if more than one task is stolen then the first will be returned and the
+  // remaining will be added to the target queue of the same class.
+  for (iree_host_size_t i = 0; i < IREE_TASK_PRIORITY_CLASS_COUNT; ++i) {
+    iree_task_t* task = iree_task_queue_try_steal(
+        &worker->local_task_queues[i], &target_queues[i], max_tasks);
+    if (task) return task;
+  }
+  iree_task_t* task = NULL;
 
   // If we still didn't steal any tasks then let's try the slist instead.
   task = iree_atomic_task_slist_pop(&worker->mailbox_slist);
@@ -165,6 +316,49 @@ iree_task_t* iree_task_worker_try_steal_task(iree_task_worker_t* worker,
   return NULL;
 }
 
+// Returns worker local memory of at least |minimum_size| bytes, growing the
+// worker local arena if the up-front reservation is insufficient. If the arena
+// cannot grow the largest local memory available is returned and the dispatch
+// will fail when it finds it insufficient.
+static iree_byte_span_t iree_task_worker_reserve_local_memory(
+    iree_task_worker_t* worker, iree_host_size_t minimum_size) {
+  if (minimum_size <= worker->local_memory.data_length) {
+    return worker->local_memory;
+  } else if (minimum_size <= worker->local_arena_memory.data_length) {
+    return worker->local_arena_memory;
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)minimum_size);
+
+  // Drop the prior allocation and grow to the next power of two so that
+  // dispatches with slowly increasing requirements don't each reallocate. The
+  // allocation is padded so that it can be aligned to avoid false sharing.
+  // Requirements that fit within a pooled block use all of it.
+  const iree_host_size_t alignment =
+      iree_hardware_destructive_interference_size;
+  iree_arena_reset(&worker->local_arena);
+  worker->local_arena_memory = iree_byte_span_empty();
+  iree_host_size_t allocation_size =
+      iree_max((iree_host_size_t)iree_math_round_up_to_pow2_u64(minimum_size),
+               worker->local_arena.block_pool->usable_block_size - alignment);
+  void* base_ptr = NULL;
+  iree_status_t status = iree_arena_allocate(
+      &worker->local_arena, allocation_size + alignment, &base_ptr);
+  if (iree_status_is_ok(status)) {
+    worker->local_arena_memory = iree_make_byte_span(
+        (void*)iree_host_align((uintptr_t)base_ptr, alignment),
+        allocation_size);
+  } else {
+    iree_status_ignore(status);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return worker->local_arena_memory.data_length >
+                 worker->local_memory.data_length
+             ? worker->local_arena_memory
+             : worker->local_memory;
+}
+
 // Executes a task on a worker.
 // Only task types that are scheduled to workers are handled; all others must be
 // handled by the coordinator during scheduling.
@@ -178,16 +372,25 @@ static void iree_task_worker_execute(
   // TODO(benvanik): think a bit more about this timing; this ensures we have
   // BFS behavior at the cost of the additional merge overhead - it's probably
   // worth it?
-  // TODO(benvanik): handle partial tasks and re-queuing.
+  const iree_task_priority_class_t priority_class = task->priority_class;
+#if IREE_TASK_WORKER_BUSY_STATISTICS_ENABLE
+  const iree_time_t start_time_ns = iree_time_now();
+#endif  // IREE_TASK_WORKER_BUSY_STATISTICS_ENABLE
+  bool did_yield = false;
   switch (task->type) {
     case IREE_TASK_TYPE_CALL: {
       iree_task_call_execute((iree_task_call_t*)task, pending_submission);
       break;
     }
     case IREE_TASK_TYPE_DISPATCH_SHARD: {
-      iree_task_dispatch_shard_execute(
-          (iree_task_dispatch_shard_t*)task, worker->processor_id,
-          worker->worker_index, worker->local_memory, pending_submission);
+      iree_task_dispatch_shard_t* shard_task =
+          (iree_task_dispatch_shard_t*)task;
+      iree_byte_span_t local_memory = iree_task_worker_reserve_local_memory(
+          worker,
+          iree_task_dispatch_shard_parent(shard_task)->local_memory_size);
+      did_yield = iree_task_dispatch_shard_execute(
+          shard_task, worker->processor_id, worker->worker_index, local_memory,
+          &worker->mailbox_priority_mask, pending_submission);
       break;
     }
     default:
@@ -195,6 +398,23 @@ static void iree_task_worker_execute(
       break;
   }
 
+#if IREE_TASK_WORKER_BUSY_STATISTICS_ENABLE
+  iree_task_worker_add_counter(
+      &worker->priority_counters[priority_class].task_count, 1);
+  iree_task_worker_add_counter(
+      &worker->priority_counters[priority_class].busy_time_ns,
+      iree_time_now() - start_time_ns);
+#endif  // IREE_TASK_WORKER_BUSY_STATISTICS_ENABLE
+
+  // A shard that yielded to more important work is still live and goes back to
+  // the front of its queue to resume once that work has been processed.
+  if (did_yield) {
+    iree_task_worker_add_counter(
+        &worker->priority_counters[priority_class].preemption_count, 1);
+    iree_task_queue_push_front(&worker->local_task_queues[priority_class],
+                               task);
+  }
+
   // NOTE: task is invalidated above and must not be used!
   task = NULL;
 }
@@ -206,10 +426,14 @@ static bool iree_task_worker_pump_once(
     iree_task_worker_t* worker, iree_task_submission_t* pending_submission) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  // Check the local work queue for any work we know we should start
+  // If more important work has been posted since we last checked the mailbox
+  // move it into the local queues now so that it can overtake what we have.
+  iree_task_worker_flush_preempting_mailbox(worker);
+
+  // Check the local work queues for any work we know we should start
   // processing immediately. Other workers may try to steal some of this work
   // if we take too long.
-  iree_task_t* task = iree_task_queue_pop_front(&worker->local_task_queue);
+  iree_task_t* task = iree_task_worker_pop_local_task(worker);
 
   // Check the mailbox to see if we have incoming work that has been posted.
   // We try to greedily move it to our local work list so that we can work
@@ -221,8 +445,8 @@ static bool iree_task_worker_pump_once(
     // first place (large uneven workloads for various workers, bad distribution
     // in the face of heterogenous multi-core architectures where some workers
     // complete tasks faster than others, etc).
-    task = iree_task_queue_flush_from_lifo_slist(&worker->local_task_queue,
-                                                 &worker->mailbox_slist);
+    iree_task_worker_flush_mailbox(worker);
+    task = iree_task_worker_pop_local_task(worker);
   }
 
 #if IREE_TASK_EXECUTOR_MAX_THEFT_ATTEMPTS_DIVISOR > 0
@@ -232,9 +456,9 @@ static bool iree_task_worker_pump_once(
   // the first task in the queue is popped off and returned.
   if (!task) {
     task = iree_task_executor_try_steal_task(
-        worker->executor, worker->constructive_sharing_mask,
-        worker->max_theft_attempts, &worker->theft_prng,
-        &worker->local_task_queue);
+        worker->executor, worker->cluster_index,
+        worker->constructive_sharing_mask, worker->max_theft_attempts,
+        &worker->theft_prng, worker->local_task_queues);
   }
 #endif  // IREE_TASK_EXECUTOR_MAX_THEFT_ATTEMPTS_DIVISOR > 0
 
@@ -276,9 +500,9 @@ static void iree_task_worker_pump_until_exit(iree_task_worker_t* worker) {
     iree_wait_token_t wait_token =
         iree_notification_prepare_wait(&worker->wake_notification);
     // The masks are accessed with 'relaxed' order because they are just hints.
-    iree_atomic_task_affinity_set_fetch_and(&worker->executor->worker_idle_mask,
-                                            ~worker->worker_bit,
-                                            iree_memory_order_relaxed);
+    iree_atomic_task_affinity_set_fetch_and(
+        &worker->executor->clusters[worker->cluster_index].worker_idle_mask,
+        ~worker->worker_bit, iree_memory_order_relaxed);
 
     // Check state to see if we've been asked to exit.
     if (iree_atomic_load_int32(&worker->state, iree_memory_order_acquire) ==
@@ -302,6 +526,7 @@ static void iree_task_worker_pump_until_exit(iree_task_worker_t* worker) {
     bool schedule_dirty = false;
     if (!iree_task_submission_is_empty(&pending_submission)) {
       iree_task_executor_merge_submission(worker->executor,
+                                          worker->coordinator_shard_index,
                                           &pending_submission);
       schedule_dirty = true;
     }
@@ -309,25 +534,23 @@ static void iree_task_worker_pump_until_exit(iree_task_worker_t* worker) {
     // We've finished all the work we have scheduled so set our idle flag.
     // This ensures that if any other thread comes in and wants to give us
     // work we will properly coordinate/wake below.
-    iree_atomic_task_affinity_set_fetch_or(&worker->executor->worker_idle_mask,
-                                           worker->worker_bit,
-                                           iree_memory_order_relaxed);
+    iree_atomic_task_affinity_set_fetch_or(
+        &worker->executor->clusters[worker->cluster_index].worker_idle_mask,
+        worker->worker_bit, iree_memory_order_relaxed);
 
     // When we encounter a complete lack of work we can self-nominate to check
-    // the global work queue and distribute work to other threads. Only one
-    // coordinator can be running at a time so we also ensure that if another
-    // is doing its work we gracefully wait for it. It's fine to block in here
-    // as the next thing we'd have done is go idle anyway.
+    // the incoming work queues and distribute work to other threads. Only one
+    // coordinator can be running at a time per shard and if another is doing
+    // its work we leave it to them.
 
     // First self-nominate; this *may* do something or just be ignored (if
-    // another worker is already coordinating).
+    // other threads are already coordinating).
     iree_task_executor_coordinate(worker->executor, worker);
 
     // If nothing has been enqueued since we started this loop (so even
     // coordination didn't find anything) we go idle. Otherwise we fall
     // through and try the loop again.
-    if (schedule_dirty ||
-        !iree_task_queue_is_empty(&worker->local_task_queue)) {
+    if (schedule_dirty || iree_task_worker_has_local_tasks(worker)) {
       // Have more work to do; loop around to try another pump.
       iree_notification_cancel_wait(&worker->wake_notification);
     } else {
@@ -11,6 +11,7 @@
 #include <stdint.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/arena.h"
 #include "iree/base/internal/prng.h"
 #include "iree/base/internal/synchronization.h"
 #include "iree/base/internal/threading.h"
@@ -61,9 +62,15 @@ typedef struct iree_task_worker_t {
   // them based on the work distribution policy. When workers go to look for
   // more work after their local queue empties they will flush this list and
   // move all of the tasks into their local queue and restart processing.
-  // LAYOUT: must be 64b away from local_task_queue.
+  // LAYOUT: must be 64b away from local_task_queues.
   iree_atomic_task_slist_t mailbox_slist;
 
+  // Bitmask of the priority classes of tasks posted to mailbox_slist since the
+  // worker last flushed it. Dispatch shards check this to yield to more
+  // important work.
+  // LAYOUT: next to mailbox_slist as posters touch both.
+  iree_atomic_int32_t mailbox_priority_mask;
+
   // Current state of the worker (iree_task_worker_state_t).
   // LAYOUT: frequent access; next to wake_notification as they are always
   //         accessed together.
@@ -85,10 +92,17 @@ typedef struct iree_task_worker_t {
   // Globally unique worker index (worker_base_index + local worker_index).
   iree_host_size_t worker_index;
 
-  // Bit the worker represents in the various worker bitsets.
+  // Bit the worker represents in the various worker bitsets of its cluster.
   // Local to the executor owning the worker.
   iree_task_affinity_set_t worker_bit;
 
+  // Index of the worker cluster within the executor owning the worker.
+  iree_host_size_t cluster_index;
+
+  // Index of the coordinator shard the worker merges its submissions into and
+  // coordinates first when it runs out of work.
+  iree_host_size_t coordinator_shard_index;
+
   // Ideal thread affinity for the worker thread.
   iree_thread_affinity_t ideal_thread_affinity;
 
@@ -96,7 +110,7 @@ typedef struct iree_task_worker_t {
   // hierarchy. Workers of this group are more likely to constructively share
   // some cache levels higher up with these other groups. For example, if the
   // workers in a group all share an L2 cache then the groups indicated here may
-  // all share the same L3 cache.
+  // all share the same L3 cache. Bits are relative to the worker's cluster.
   iree_task_affinity_set_t constructive_sharing_mask;
 
   // Maximum number of attempts to make when trying to steal tasks from other
@@ -122,7 +136,7 @@ typedef struct iree_task_worker_t {
   iree_cpu_processor_tag_t processor_tag;
 
   // Destructive interference padding between the mailbox and local task queue
-  // to ensure that the worker - who is pounding on local_task_queue - doesn't
+  // to ensure that the worker - who is pounding on local_task_queues - doesn't
   // contend with submissions or coordinators dropping new tasks in the mailbox.
   //
   // Today we don't need this, however on 32-bit systems or if we adjust the
@@ -133,24 +147,45 @@ typedef struct iree_task_worker_t {
   // interference) this is the only place padding should be added.
   // uint8_t _padding[8];
 
+  // Number of consecutive tasks run from a more important priority class while
+  // less important tasks were waiting in local_task_queues.
+  // Only ever touched by the worker thread.
+  uint32_t priority_streak;
+
+  // Per-priority-class counters. Only written by the worker thread.
+  struct {
+    iree_atomic_int64_t task_count;
+    iree_atomic_int64_t busy_time_ns;
+    iree_atomic_int64_t preemption_count;
+    iree_atomic_int64_t starvation_count;
+  } priority_counters[IREE_TASK_PRIORITY_CLASS_COUNT];
+
   // Pointer to local memory available for use exclusively by the worker.
   // The base address should be aligned to avoid false sharing with other
   // workers.
   iree_byte_span_t local_memory;
 
-  // Worker-local FIFO queue containing the tasks that will be processed by the
-  // worker. This queue supports work-stealing by other workers if they run out
-  // of work of their own.
+  // Arena used to grow local memory for dispatches requiring more than the
+  // up-front |local_memory| reservation. The current allocation is kept in
+  // |local_arena_memory| and reused until a larger one is required.
+  // Only ever touched by the worker thread.
+  iree_arena_allocator_t local_arena;
+  iree_byte_span_t local_arena_memory;
+
+  // Worker-local FIFO queues containing the tasks that will be processed by
+  // the worker, one per priority class. Tasks in more important classes are
+  // processed first. These queues support work-stealing by other workers if
+  // they run out of work of their own.
   // LAYOUT: must be 64b away from mailbox_slist.
-  iree_task_queue_t local_task_queue;
+  iree_task_queue_t local_task_queues[IREE_TASK_PRIORITY_CLASS_COUNT];
 } iree_task_worker_t;
 static_assert(offsetof(iree_task_worker_t, mailbox_slist) +
                       sizeof(iree_atomic_task_slist_t) <
                   iree_hardware_constructive_interference_size,
               "mailbox_slist must be in the first cache line");
-static_assert(offsetof(iree_task_worker_t, local_task_queue) >=
+static_assert(offsetof(iree_task_worker_t, local_task_queues) >=
                   iree_hardware_constructive_interference_size,
-              "local_task_queue must be separated from mailbox_slist by "
+              "local_task_queues must be separated from mailbox_slist by "
               "at least a cache line");
 
 // Initializes a worker by creating its thread and configuring it for receiving
@@ -191,13 +226,22 @@ void iree_task_worker_deinitialize(iree_task_worker_t* worker);
 void iree_task_worker_post_tasks(iree_task_worker_t* worker,
                                  iree_task_list_t* list);
 
+// Appends a LIFO |list| of tasks to the local queues of the worker matching
+// their priority classes.
+//
+// Must only be called from the worker thread.
+void iree_task_worker_append_local_tasks(iree_task_worker_t* worker,
+                                         iree_task_list_t* list);
+
 // Tries to steal up to |max_tasks| from the back of the queue.
 // Returns NULL if no tasks are available and otherwise up to |max_tasks| tasks
-// that were at the tail of the worker FIFO will be moved to the |target_queue|
-// and the first of the stolen tasks is returned. While tasks from the FIFO
-// are preferred this may also steal tasks from the mailbox.
+// that were at the tail of the worker FIFO will be moved to the
+// |target_queues| entry of their priority class and the first of the stolen
+// tasks is returned. The most important nonempty queue of the worker is stolen
+// from. While tasks from the FIFOs are preferred this may also steal tasks from
+// the mailbox.
 iree_task_t* iree_task_worker_try_steal_task(iree_task_worker_t* worker,
-                                             iree_task_queue_t* target_queue,
+                                             iree_task_queue_t* target_queues,
                                              iree_host_size_t max_tasks);
 
 #ifdef __cplusplus
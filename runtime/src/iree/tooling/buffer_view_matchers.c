@@ -8,6 +8,8 @@
 
 #include <math.h>
 
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/fork_join.h"
 #include "iree/base/internal/math.h"
 #include "iree/base/tracing.h"
 
@@ -56,145 +58,685 @@ static iree_status_t iree_hal_append_element_mismatch_string(
   return iree_ok_status();
 }
 
-static bool iree_hal_compare_strided_elements_exact(
-    iree_hal_element_type_t element_type, iree_host_size_t element_count,
-    iree_const_byte_span_t expected_elements, iree_host_size_t expected_stride,
-    iree_const_byte_span_t actual_elements, iree_host_size_t actual_stride,
-    iree_host_size_t* out_index) {
-  const iree_host_size_t element_size =
-      iree_hal_element_dense_byte_count(element_type);
-  const uint8_t* expected_ptr = expected_elements.data;
-  const uint8_t* actual_ptr = actual_elements.data;
-  for (iree_host_size_t i = 0; i < element_count; ++i) {
-    int cmp = memcmp(expected_ptr, actual_ptr, element_size);
-    if (cmp != 0) {
-      *out_index = i;
+// Number of elements compared at a time. Each block is widened into scratch
+// arrays on the stack and compared with branch-free loops that the compiler
+// can vectorize.
+#define IREE_HAL_BUFFER_COMPARISON_BLOCK_LENGTH 256
+
+// Minimum number of elements compared by each thread.
+#define IREE_HAL_BUFFER_COMPARISON_SLICE_LENGTH (1024 * 1024)
+
+// Maximum number of threads (including the caller) used for one comparison.
+#define IREE_HAL_BUFFER_COMPARISON_MAX_SLICES 8
+
+// Largest element size supported when broadcasting.
+#define IREE_HAL_BUFFER_COMPARISON_MAX_ELEMENT_SIZE 16
+
+typedef struct {
+  iree_hal_buffer_equality_t equality;
+  iree_hal_element_type_t element_type;
+  iree_host_size_t element_size;
+  // True if elements are compared by value instead of by their bytes.
+  bool approximate;
+  // Absolute threshold for |element_type| in approximate modes.
+  double threshold;
+  // When broadcasting |expected_data| is a single block of the repeated
+  // expected element that is compared against each block of |actual_data|.
+  bool broadcast;
+  const uint8_t* expected_data;
+  const uint8_t* actual_data;
+  // Lowest mismatching index found by any slice so far. Slices stop early
+  // once they are past it.
+  iree_atomic_intptr_t first_mismatch_index;
+  uint8_t broadcast_block[IREE_HAL_BUFFER_COMPARISON_BLOCK_LENGTH *
+                          IREE_HAL_BUFFER_COMPARISON_MAX_ELEMENT_SIZE];
+} iree_hal_buffer_comparison_t;
+
+// Returns true if |element_type| has a numeric value the elements can be
+// widened to for measuring differences.
+static bool iree_hal_element_type_is_numeric(
+    iree_hal_element_type_t element_type) {
+  switch (element_type) {
+    case IREE_HAL_ELEMENT_TYPE_INT_8:
+    case IREE_HAL_ELEMENT_TYPE_SINT_8:
+    case IREE_HAL_ELEMENT_TYPE_UINT_8:
+    case IREE_HAL_ELEMENT_TYPE_INT_16:
+    case IREE_HAL_ELEMENT_TYPE_SINT_16:
+    case IREE_HAL_ELEMENT_TYPE_UINT_16:
+    case IREE_HAL_ELEMENT_TYPE_INT_32:
+    case IREE_HAL_ELEMENT_TYPE_SINT_32:
+    case IREE_HAL_ELEMENT_TYPE_UINT_32:
+    case IREE_HAL_ELEMENT_TYPE_INT_64:
+    case IREE_HAL_ELEMENT_TYPE_SINT_64:
+    case IREE_HAL_ELEMENT_TYPE_UINT_64:
+    case IREE_HAL_ELEMENT_TYPE_FLOAT_16:
+    case IREE_HAL_ELEMENT_TYPE_BFLOAT_16:
+    case IREE_HAL_ELEMENT_TYPE_FLOAT_32:
+    case IREE_HAL_ELEMENT_TYPE_FLOAT_64:
+      return true;
+    default:
       return false;
+  }
+}
+
+static void iree_hal_buffer_comparison_initialize(
+    iree_hal_buffer_equality_t equality, iree_hal_element_type_t element_type,
+    iree_const_byte_span_t expected_elements, bool broadcast,
+    iree_const_byte_span_t actual_elements,
+    iree_hal_buffer_comparison_t* out_comparison) {
+  iree_hal_buffer_comparison_t* comparison = out_comparison;
+  comparison->equality = equality;
+  comparison->element_type = element_type;
+  comparison->element_size = iree_hal_element_dense_byte_count(element_type);
+  comparison->approximate = false;
+  comparison->threshold = 0.0;
+  if (equality.mode != IREE_HAL_BUFFER_EQUALITY_EXACT) {
+    switch (element_type) {
+      case IREE_HAL_ELEMENT_TYPE_FLOAT_16:
+      case IREE_HAL_ELEMENT_TYPE_BFLOAT_16:
+        comparison->approximate = true;
+        comparison->threshold = equality.f16_threshold;
+        break;
+      case IREE_HAL_ELEMENT_TYPE_FLOAT_32:
+        comparison->approximate = true;
+        comparison->threshold = equality.f32_threshold;
+        break;
+      case IREE_HAL_ELEMENT_TYPE_FLOAT_64:
+        comparison->approximate = true;
+        comparison->threshold = equality.f64_threshold;
+        break;
+      default:
+        break;
     }
-    expected_ptr += expected_stride * element_size;
-    actual_ptr += actual_stride * element_size;
   }
-  return true;
+  comparison->broadcast = broadcast;
+  comparison->expected_data = expected_elements.data;
+  comparison->actual_data = actual_elements.data;
+  if (broadcast) {
+    IREE_ASSERT_LE(comparison->element_size,
+                   IREE_HAL_BUFFER_COMPARISON_MAX_ELEMENT_SIZE);
+    for (iree_host_size_t i = 0; i < IREE_HAL_BUFFER_COMPARISON_BLOCK_LENGTH;
+         ++i) {
+      memcpy(&comparison->broadcast_block[i * comparison->element_size],
+             expected_elements.data, comparison->element_size);
+    }
+    comparison->expected_data = comparison->broadcast_block;
+  }
+  iree_atomic_store_intptr(&comparison->first_mismatch_index, INTPTR_MAX,
+                           iree_memory_order_relaxed);
 }
 
-static bool iree_hal_compare_strided_elements_approximate_absolute_f16(
-    iree_hal_buffer_equality_t equality, iree_host_size_t element_count,
-    const uint16_t* expected_ptr, iree_host_size_t expected_stride,
-    const uint16_t* actual_ptr, iree_host_size_t actual_stride,
-    iree_host_size_t* out_index) {
-  for (iree_host_size_t i = 0; i < element_count; ++i) {
-    if (fabsf(iree_math_f16_to_f32(*expected_ptr) -
-              iree_math_f16_to_f32(*actual_ptr)) > equality.f16_threshold) {
-      *out_index = i;
-      return false;
+// Returns the expected elements compared against the block at |index|.
+static const uint8_t* iree_hal_buffer_comparison_expected_block(
+    const iree_hal_buffer_comparison_t* comparison, iree_host_size_t index) {
+  return comparison->broadcast
+             ? comparison->expected_data
+             : comparison->expected_data + index * comparison->element_size;
+}
+
+// Maps the |bits| of a sign-magnitude float of |bit_count| bits to an integer
+// ordered the same way as the float values such that adjacent representable
+// values differ by one. -0 and +0 both map to 0.
+static inline int64_t iree_hal_float_bits_to_ordinal(uint64_t bits,
+                                                     int bit_count) {
+  const uint64_t sign_bit = 1ull << (bit_count - 1);
+  const int64_t magnitude = (int64_t)(bits & (sign_bit - 1));
+  return (bits & sign_bit) ? -magnitude : magnitude;
+}
+
+static inline uint64_t iree_hal_ordinal_distance(int64_t a, int64_t b) {
+  return a > b ? (uint64_t)a - (uint64_t)b : (uint64_t)b - (uint64_t)a;
+}
+
+// Block of elements widened for comparison.
+typedef struct {
+  double values[IREE_HAL_BUFFER_COMPARISON_BLOCK_LENGTH];
+  // Integers ordered the same as |values| where adjacent representable values
+  // differ by one. Integer elements are their own ordinals.
+  int64_t ordinals[IREE_HAL_BUFFER_COMPARISON_BLOCK_LENGTH];
+} iree_hal_buffer_comparison_block_t;
+
+#define IREE_HAL_LOAD_BLOCK(type, value_expr, ordinal_expr) \
+  {                                                         \
+    const type* ptr = (const type*)data;                    \
+    for (iree_host_size_t i = 0; i < count; ++i) {          \
+      const type x = ptr[i];                                \
+      out_block->values[i] = (value_expr);                  \
+      out_block->ordinals[i] = (ordinal_expr);              \
+    }                                                       \
+  }
+
+// Widens |count| elements of a numeric |element_type| from |data|.
+static void iree_hal_buffer_comparison_load_block(
+    iree_hal_element_type_t element_type, const uint8_t* data,
+    iree_host_size_t count, iree_hal_buffer_comparison_block_t* out_block) {
+  switch (element_type) {
+    case IREE_HAL_ELEMENT_TYPE_INT_8:
+    case IREE_HAL_ELEMENT_TYPE_SINT_8:
+      IREE_HAL_LOAD_BLOCK(int8_t, x, x);
+      break;
+    case IREE_HAL_ELEMENT_TYPE_UINT_8:
+      IREE_HAL_LOAD_BLOCK(uint8_t, x, x);
+      break;
+    case IREE_HAL_ELEMENT_TYPE_INT_16:
+    case IREE_HAL_ELEMENT_TYPE_SINT_16:
+      IREE_HAL_LOAD_BLOCK(int16_t, x, x);
+      break;
+    case IREE_HAL_ELEMENT_TYPE_UINT_16:
+      IREE_HAL_LOAD_BLOCK(uint16_t, x, x);
+      break;
+    case IREE_HAL_ELEMENT_TYPE_INT_32:
+    case IREE_HAL_ELEMENT_TYPE_SINT_32:
+      IREE_HAL_LOAD_BLOCK(int32_t, x, x);
+      break;
+    case IREE_HAL_ELEMENT_TYPE_UINT_32:
+      IREE_HAL_LOAD_BLOCK(uint32_t, x, x);
+      break;
+    case IREE_HAL_ELEMENT_TYPE_INT_64:
+    case IREE_HAL_ELEMENT_TYPE_SINT_64:
+      IREE_HAL_LOAD_BLOCK(int64_t, (double)x, x);
+      break;
+    case IREE_HAL_ELEMENT_TYPE_UINT_64:
+      // Flipping the top bit keeps the order when reinterpreted as signed.
+      IREE_HAL_LOAD_BLOCK(uint64_t, (double)x,
+                          (int64_t)(x ^ 0x8000000000000000ull));
+      break;
+    case IREE_HAL_ELEMENT_TYPE_FLOAT_16:
+      IREE_HAL_LOAD_BLOCK(uint16_t, iree_math_f16_to_f32(x),
+                          iree_hal_float_bits_to_ordinal(x, 16));
+      break;
+    case IREE_HAL_ELEMENT_TYPE_BFLOAT_16: {
+      const uint16_t* ptr = (const uint16_t*)data;
+      for (iree_host_size_t i = 0; i < count; ++i) {
+        const uint32_t f32_bits = (uint32_t)ptr[i] << 16;
+        float value;
+        memcpy(&value, &f32_bits, sizeof(value));
+        out_block->values[i] = value;
+        out_block->ordinals[i] = iree_hal_float_bits_to_ordinal(ptr[i], 16);
+      }
+      break;
+    }
+    case IREE_HAL_ELEMENT_TYPE_FLOAT_32: {
+      const uint32_t* ptr = (const uint32_t*)data;
+      for (iree_host_size_t i = 0; i < count; ++i) {
+        float value;
+        memcpy(&value, &ptr[i], sizeof(value));
+        out_block->values[i] = value;
+        out_block->ordinals[i] = iree_hal_float_bits_to_ordinal(ptr[i], 32);
+      }
+      break;
     }
-    expected_ptr += expected_stride;
-    actual_ptr += actual_stride;
+    case IREE_HAL_ELEMENT_TYPE_FLOAT_64: {
+      const uint64_t* ptr = (const uint64_t*)data;
+      for (iree_host_size_t i = 0; i < count; ++i) {
+        double value;
+        memcpy(&value, &ptr[i], sizeof(value));
+        out_block->values[i] = value;
+        out_block->ordinals[i] = iree_hal_float_bits_to_ordinal(ptr[i], 64);
+      }
+      break;
+    }
+    default:
+      IREE_ASSERT(false && "non-numeric element type");
+      break;
   }
-  return true;
 }
 
-static bool iree_hal_compare_strided_elements_approximate_absolute_f32(
-    iree_hal_buffer_equality_t equality, iree_host_size_t element_count,
-    const float* expected_ptr, iree_host_size_t expected_stride,
-    const float* actual_ptr, iree_host_size_t actual_stride,
-    iree_host_size_t* out_index) {
-  for (iree_host_size_t i = 0; i < element_count; ++i) {
-    if (fabsf(*expected_ptr - *actual_ptr) > equality.f32_threshold) {
-      *out_index = i;
-      return false;
+#undef IREE_HAL_LOAD_BLOCK
+
+// Returns 1 if two values are a mismatch. NaN only matches NaN and otherwise
+// values match if they are not |out_of_range| of each other.
+static inline uint8_t iree_hal_approximate_mismatch(int e_nan, int a_nan,
+                                                    int out_of_range) {
+  return (uint8_t)((e_nan ^ a_nan) | (((e_nan | a_nan) ^ 1) & out_of_range));
+}
+
+// Sets |out_mismatches| to 1 for each of the |count| widened elements that do
+// not match based on the approximate mode of |comparison|.
+// Returns the number of mismatches.
+static iree_host_size_t iree_hal_buffer_comparison_classify_block(
+    const iree_hal_buffer_comparison_t* comparison, iree_host_size_t count,
+    const iree_hal_buffer_comparison_block_t* expected,
+    const iree_hal_buffer_comparison_block_t* actual,
+    uint8_t* out_mismatches) {
+  const double threshold = comparison->threshold;
+  switch (comparison->equality.mode) {
+    default:
+    case IREE_HAL_BUFFER_EQUALITY_APPROXIMATE_ABSOLUTE:
+      for (iree_host_size_t i = 0; i < count; ++i) {
+        const double e = expected->values[i];
+        const double a = actual->values[i];
+        const double diff = e == a ? 0.0 : fabs(e - a);
+        const int e_nan = e != e;
+        const int a_nan = a != a;
+        const int out_of_range = !(diff <= threshold);
+        out_mismatches[i] =
+            iree_hal_approximate_mismatch(e_nan, a_nan, out_of_range);
+      }
+      break;
+    case IREE_HAL_BUFFER_EQUALITY_APPROXIMATE_RELATIVE: {
+      const double relative_threshold = comparison->equality.relative_threshold;
+      for (iree_host_size_t i = 0; i < count; ++i) {
+        const double e = expected->values[i];
+        const double a = actual->values[i];
+        const double diff = e == a ? 0.0 : fabs(e - a);
+        const int e_nan = e != e;
+        const int a_nan = a != a;
+        const int out_of_range =
+            !(diff <= threshold + relative_threshold * fabs(e));
+        out_mismatches[i] =
+            iree_hal_approximate_mismatch(e_nan, a_nan, out_of_range);
+      }
+      break;
+    }
+    case IREE_HAL_BUFFER_EQUALITY_APPROXIMATE_ULP: {
+      const uint64_t max_ulp_distance = comparison->equality.max_ulp_distance;
+      for (iree_host_size_t i = 0; i < count; ++i) {
+        const double e = expected->values[i];
+        const double a = actual->values[i];
+        const int e_nan = e != e;
+        const int a_nan = a != a;
+        const int out_of_range =
+            iree_hal_ordinal_distance(expected->ordinals[i],
+                                      actual->ordinals[i]) > max_ulp_distance;
+        out_mismatches[i] =
+            iree_hal_approximate_mismatch(e_nan, a_nan, out_of_range);
+      }
+      break;
     }
-    expected_ptr += expected_stride;
-    actual_ptr += actual_stride;
   }
-  return true;
+  iree_host_size_t mismatch_count = 0;
+  for (iree_host_size_t i = 0; i < count; ++i) {
+    mismatch_count += out_mismatches[i];
+  }
+  return mismatch_count;
 }
 
-static bool iree_hal_compare_strided_elements_approximate_absolute_f64(
-    iree_hal_buffer_equality_t equality, iree_host_size_t element_count,
-    const double* expected_ptr, iree_host_size_t expected_stride,
-    const double* actual_ptr, iree_host_size_t actual_stride,
-    iree_host_size_t* out_index) {
-  for (iree_host_size_t i = 0; i < element_count; ++i) {
-    if (fabs(*expected_ptr - *actual_ptr) > equality.f64_threshold) {
-      *out_index = i;
-      return false;
+// Scratch storage for comparing blocks on a single thread.
+typedef struct {
+  iree_hal_buffer_comparison_block_t expected;
+  iree_hal_buffer_comparison_block_t actual;
+  uint8_t mismatches[IREE_HAL_BUFFER_COMPARISON_BLOCK_LENGTH];
+} iree_hal_buffer_comparison_scratch_t;
+
+// Compares the |count| elements of the block starting at |index| and sets
+// |scratch->mismatches| for each. Returns the number of mismatches.
+// Broadcast blocks of expected values are only widened once per scratch when
+// |expected_loaded| is set.
+static iree_host_size_t iree_hal_buffer_comparison_compare_block(
+    const iree_hal_buffer_comparison_t* comparison, iree_host_size_t index,
+    iree_host_size_t count, bool expected_loaded,
+    iree_hal_buffer_comparison_scratch_t* scratch) {
+  const iree_host_size_t element_size = comparison->element_size;
+  const uint8_t* expected_ptr =
+      iree_hal_buffer_comparison_expected_block(comparison, index);
+  const uint8_t* actual_ptr = comparison->actual_data + index * element_size;
+  if (comparison->approximate) {
+    if (!expected_loaded) {
+      iree_hal_buffer_comparison_load_block(
+          comparison->element_type, expected_ptr, count, &scratch->expected);
     }
-    expected_ptr += expected_stride;
-    actual_ptr += actual_stride;
+    iree_hal_buffer_comparison_load_block(comparison->element_type,
+                                          actual_ptr, count, &scratch->actual);
+    return iree_hal_buffer_comparison_classify_block(
+        comparison, count, &scratch->expected, &scratch->actual,
+        scratch->mismatches);
   }
-  return true;
+
+  // Exact comparisons check the entire block at once and only look at the
+  // individual elements if it differs.
+  if (memcmp(expected_ptr, actual_ptr, count * element_size) == 0) {
+    memset(scratch->mismatches, 0, count);
+    return 0;
+  }
+  iree_host_size_t mismatch_count = 0;
+  for (iree_host_size_t i = 0; i < count; ++i) {
+    scratch->mismatches[i] = memcmp(expected_ptr + i * element_size,
+                                    actual_ptr + i * element_size,
+                                    element_size) != 0;
+    mismatch_count += scratch->mismatches[i];
+  }
+  return mismatch_count;
+}
+
+// Lowers the shared first mismatch index of |comparison| to |index|.
+static void iree_hal_buffer_comparison_report_mismatch(
+    iree_hal_buffer_comparison_t* comparison, iree_host_size_t index) {
+  intptr_t current = iree_atomic_load_intptr(&comparison->first_mismatch_index,
+                                             iree_memory_order_relaxed);
+  while ((intptr_t)index < current &&
+         !iree_atomic_compare_exchange_weak_intptr(
+             &comparison->first_mismatch_index, &current, (intptr_t)index,
+             iree_memory_order_relaxed, iree_memory_order_relaxed)) {
+  }
+}
+
+static void iree_hal_buffer_comparison_statistics_initialize(
+    iree_host_size_t element_count,
+    iree_hal_buffer_comparison_statistics_t* out_statistics) {
+  memset(out_statistics, 0, sizeof(*out_statistics));
+  out_statistics->element_count = element_count;
+  out_statistics->first_mismatch_index = element_count;
 }
 
-static bool iree_hal_compare_strided_elements_approximate_absolute(
+static iree_host_size_t iree_hal_ulp_histogram_bucket(uint64_t distance) {
+  if (distance == 0) return 0;
+  iree_host_size_t bucket = 64 - iree_math_count_leading_zeros_u64(distance);
+  return iree_min(bucket, IREE_HAL_BUFFER_ULP_HISTOGRAM_BUCKET_COUNT - 1);
+}
+
+// Accumulates the differences of the block at |index| that was compared into
+// |scratch| into |statistics|.
+static void iree_hal_buffer_comparison_accumulate_block(
+    const iree_hal_buffer_comparison_t* comparison, iree_host_size_t index,
+    iree_host_size_t count, iree_host_size_t mismatch_count,
+    iree_hal_buffer_comparison_scratch_t* scratch,
+    iree_hal_buffer_comparison_statistics_t* statistics) {
+  statistics->mismatch_count += mismatch_count;
+  if (mismatch_count > 0 && statistics->first_mismatch_index >= index + count) {
+    for (iree_host_size_t i = 0; i < count; ++i) {
+      if (scratch->mismatches[i]) {
+        statistics->first_mismatch_index = index + i;
+        break;
+      }
+    }
+  }
+
+  // Without a numeric interpretation all we know is whether elements match.
+  if (!iree_hal_element_type_is_numeric(comparison->element_type)) {
+    statistics->ulp_histogram[0] += count - mismatch_count;
+    statistics->ulp_histogram[IREE_HAL_BUFFER_ULP_HISTOGRAM_BUCKET_COUNT - 1] +=
+        mismatch_count;
+    return;
+  }
+
+  // Exact comparisons compare bytes and haven't widened the elements yet.
+  if (!comparison->approximate) {
+    const iree_host_size_t element_size = comparison->element_size;
+    iree_hal_buffer_comparison_load_block(
+        comparison->element_type,
+        iree_hal_buffer_comparison_expected_block(comparison, index), count,
+        &scratch->expected);
+    iree_hal_buffer_comparison_load_block(
+        comparison->element_type,
+        comparison->actual_data + index * element_size, count,
+        &scratch->actual);
+  }
+
+  for (iree_host_size_t i = 0; i < count; ++i) {
+    const double e = scratch->expected.values[i];
+    const double a = scratch->actual.values[i];
+    const bool e_nan = e != e;
+    const bool a_nan = a != a;
+    if (e_nan || a_nan) {
+      const iree_host_size_t bucket =
+          e_nan && a_nan ? 0 : IREE_HAL_BUFFER_ULP_HISTOGRAM_BUCKET_COUNT - 1;
+      statistics->ulp_histogram[bucket]++;
+      continue;
+    }
+    const double absolute_error = e == a ? 0.0 : fabs(e - a);
+    const double relative_error =
+        absolute_error == 0.0 ? 0.0 : absolute_error / fabs(e);
+    const uint64_t ulp_distance = iree_hal_ordinal_distance(
+        scratch->expected.ordinals[i], scratch->actual.ordinals[i]);
+    if (absolute_error > statistics->max_absolute_error) {
+      statistics->max_absolute_error = absolute_error;
+      statistics->max_absolute_error_index = index + i;
+    }
+    if (relative_error > statistics->max_relative_error) {
+      statistics->max_relative_error = relative_error;
+      statistics->max_relative_error_index = index + i;
+    }
+    statistics->max_ulp_distance =
+        iree_max(statistics->max_ulp_distance, ulp_distance);
+    statistics->ulp_histogram[iree_hal_ulp_histogram_bucket(ulp_distance)]++;
+  }
+}
+
+// Merges the statistics of a later range of elements in |source| into
+// |target|. Ties keep the earliest index.
+static void iree_hal_buffer_comparison_statistics_merge(
+    const iree_hal_buffer_comparison_statistics_t* source,
+    iree_hal_buffer_comparison_statistics_t* target) {
+  target->mismatch_count += source->mismatch_count;
+  if (source->mismatch_count > 0 &&
+      target->first_mismatch_index == target->element_count) {
+    target->first_mismatch_index = source->first_mismatch_index;
+  }
+  if (source->max_absolute_error > target->max_absolute_error) {
+    target->max_absolute_error = source->max_absolute_error;
+    target->max_absolute_error_index = source->max_absolute_error_index;
+  }
+  if (source->max_relative_error > target->max_relative_error) {
+    target->max_relative_error = source->max_relative_error;
+    target->max_relative_error_index = source->max_relative_error_index;
+  }
+  target->max_ulp_distance =
+      iree_max(target->max_ulp_distance, source->max_ulp_distance);
+  for (iree_host_size_t i = 0; i < IREE_HAL_BUFFER_ULP_HISTOGRAM_BUCKET_COUNT;
+       ++i) {
+    target->ulp_histogram[i] += source->ulp_histogram[i];
+  }
+}
+
+// A range of elements compared by a single thread.
+typedef struct {
+  iree_hal_buffer_comparison_t* comparison;
+  iree_host_size_t begin;
+  iree_host_size_t end;
+  // Statistics of the range or NULL to stop at the first mismatch.
+  iree_hal_buffer_comparison_statistics_t* statistics;
+} iree_hal_buffer_comparison_slice_t;
+
+static void iree_hal_buffer_comparison_run_slice(
+    iree_hal_buffer_comparison_slice_t* slice) {
+  iree_hal_buffer_comparison_t* comparison = slice->comparison;
+  iree_hal_buffer_comparison_scratch_t scratch;
+
+  // Broadcast values are the same for every block and only widened once.
+  bool expected_loaded = false;
+  if (comparison->broadcast && comparison->approximate) {
+    iree_hal_buffer_comparison_load_block(
+        comparison->element_type, comparison->expected_data,
+        IREE_HAL_BUFFER_COMPARISON_BLOCK_LENGTH, &scratch.expected);
+    expected_loaded = true;
+  }
+
+  for (iree_host_size_t index = slice->begin; index < slice->end;
+       index += IREE_HAL_BUFFER_COMPARISON_BLOCK_LENGTH) {
+    const iree_host_size_t count = iree_min(
+        IREE_HAL_BUFFER_COMPARISON_BLOCK_LENGTH, slice->end - index);
+    if (slice->statistics) {
+      const iree_host_size_t mismatch_count =
+          iree_hal_buffer_comparison_compare_block(comparison, index, count,
+                                                   expected_loaded, &scratch);
+      iree_hal_buffer_comparison_accumulate_block(
+          comparison, index, count, mismatch_count, &scratch,
+          slice->statistics);
+      continue;
+    }
+
+    // Stop once another slice has found an earlier mismatch.
+    if (iree_atomic_load_intptr(&comparison->first_mismatch_index,
+                                iree_memory_order_relaxed) < (intptr_t)index) {
+      break;
+    }
+    if (iree_hal_buffer_comparison_compare_block(comparison, index, count,
+                                                 expected_loaded, &scratch)) {
+      for (iree_host_size_t i = 0; i < count; ++i) {
+        if (scratch.mismatches[i]) {
+          iree_hal_buffer_comparison_report_mismatch(comparison, index + i);
+          break;
+        }
+      }
+      break;
+    }
+  }
+}
+
+static void iree_hal_buffer_comparison_slice_main(void* user_data,
+                                                  iree_host_size_t index) {
+  iree_hal_buffer_comparison_slice_t* slices =
+      (iree_hal_buffer_comparison_slice_t*)user_data;
+  iree_hal_buffer_comparison_run_slice(&slices[index]);
+}
+
+// Compares |element_count| elements split into slices that run on their own
+// threads when large enough. The calling thread runs the first slice.
+// |slice_statistics| has storage for IREE_HAL_BUFFER_COMPARISON_MAX_SLICES
+// results or is NULL to only find the first mismatch.
+// Returns the number of slices the comparison was split into.
+static iree_host_size_t iree_hal_buffer_comparison_run(
+    iree_hal_buffer_comparison_t* comparison, iree_host_size_t element_count,
+    iree_hal_buffer_comparison_statistics_t* slice_statistics) {
+  iree_host_size_t slice_count = iree_min(
+      element_count / IREE_HAL_BUFFER_COMPARISON_SLICE_LENGTH,
+      IREE_HAL_BUFFER_COMPARISON_MAX_SLICES);
+  slice_count = iree_max(slice_count, 1);
+  const iree_host_size_t slice_length =
+      iree_host_align((element_count + slice_count - 1) / slice_count,
+                      IREE_HAL_BUFFER_COMPARISON_BLOCK_LENGTH);
+  iree_hal_buffer_comparison_slice_t
+      slices[IREE_HAL_BUFFER_COMPARISON_MAX_SLICES];
+  for (iree_host_size_t i = 0; i < slice_count; ++i) {
+    slices[i].comparison = comparison;
+    slices[i].begin = iree_min(i * slice_length, element_count);
+    slices[i].end = iree_min(slices[i].begin + slice_length, element_count);
+    slices[i].statistics = NULL;
+    if (slice_statistics) {
+      slices[i].statistics = &slice_statistics[i];
+      iree_hal_buffer_comparison_statistics_initialize(element_count,
+                                                       &slice_statistics[i]);
+    }
+  }
+  iree_fork_join(IREE_SV("iree-compare"), slice_count,
+                 iree_hal_buffer_comparison_slice_main, slices,
+                 iree_allocator_system());
+  return slice_count;
+}
+
+// Compares elements and stops at the first mismatch.
+static bool iree_hal_compare_elements(
     iree_hal_buffer_equality_t equality, iree_hal_element_type_t element_type,
     iree_host_size_t element_count, iree_const_byte_span_t expected_elements,
-    iree_host_size_t expected_stride, iree_const_byte_span_t actual_elements,
-    iree_host_size_t actual_stride, iree_host_size_t* out_index) {
-  switch (element_type) {
-    case IREE_HAL_ELEMENT_TYPE_FLOAT_16:
-      return iree_hal_compare_strided_elements_approximate_absolute_f16(
-          equality, element_count, (const uint16_t*)expected_elements.data,
-          expected_stride, (const uint16_t*)actual_elements.data, actual_stride,
-          out_index);
-    case IREE_HAL_ELEMENT_TYPE_FLOAT_32:
-      return iree_hal_compare_strided_elements_approximate_absolute_f32(
-          equality, element_count, (const float*)expected_elements.data,
-          expected_stride, (const float*)actual_elements.data, actual_stride,
-          out_index);
-    case IREE_HAL_ELEMENT_TYPE_FLOAT_64:
-      return iree_hal_compare_strided_elements_approximate_absolute_f64(
-          equality, element_count, (const double*)expected_elements.data,
-          expected_stride, (const double*)actual_elements.data, actual_stride,
-          out_index);
-    default:
-      return iree_hal_compare_strided_elements_exact(
-          element_type, element_count, expected_elements, expected_stride,
-          actual_elements, actual_stride, out_index);
-  }
+    bool broadcast, iree_const_byte_span_t actual_elements,
+    iree_host_size_t* out_index) {
+  iree_hal_buffer_comparison_t comparison;
+  iree_hal_buffer_comparison_initialize(equality, element_type,
+                                        expected_elements, broadcast,
+                                        actual_elements, &comparison);
+  iree_hal_buffer_comparison_run(&comparison, element_count,
+                                 /*slice_statistics=*/NULL);
+  const intptr_t first_mismatch_index = iree_atomic_load_intptr(
+      &comparison.first_mismatch_index, iree_memory_order_relaxed);
+  if (first_mismatch_index == INTPTR_MAX) return true;
+  *out_index = (iree_host_size_t)first_mismatch_index;
+  return false;
 }
 
-// Compares two buffers element by element.
-// The provided strides (in elements) are applied up to |element_count|.
-static bool iree_hal_compare_strided_elements(
+// Compares all elements and summarizes the differences.
+static bool iree_hal_compare_elements_statistics(
     iree_hal_buffer_equality_t equality, iree_hal_element_type_t element_type,
     iree_host_size_t element_count, iree_const_byte_span_t expected_elements,
-    iree_host_size_t expected_stride, iree_const_byte_span_t actual_elements,
-    iree_host_size_t actual_stride, iree_host_size_t* out_index) {
-  switch (equality.mode) {
-    case IREE_HAL_BUFFER_EQUALITY_EXACT:
-      return iree_hal_compare_strided_elements_exact(
-          element_type, element_count, expected_elements, expected_stride,
-          actual_elements, actual_stride, out_index);
-    case IREE_HAL_BUFFER_EQUALITY_APPROXIMATE_ABSOLUTE:
-      return iree_hal_compare_strided_elements_approximate_absolute(
-          equality, element_type, element_count, expected_elements,
-          expected_stride, actual_elements, actual_stride, out_index);
-    default:
-      IREE_ASSERT(false && "unhandled equality mode");
-      return false;
+    bool broadcast, iree_const_byte_span_t actual_elements,
+    iree_hal_buffer_comparison_statistics_t* out_statistics) {
+  iree_hal_buffer_comparison_t comparison;
+  iree_hal_buffer_comparison_initialize(equality, element_type,
+                                        expected_elements, broadcast,
+                                        actual_elements, &comparison);
+  iree_hal_buffer_comparison_statistics_t
+      slice_statistics[IREE_HAL_BUFFER_COMPARISON_MAX_SLICES];
+  const iree_host_size_t slice_count = iree_hal_buffer_comparison_run(
+      &comparison, element_count, slice_statistics);
+  *out_statistics = slice_statistics[0];
+  for (iree_host_size_t i = 1; i < slice_count; ++i) {
+    iree_hal_buffer_comparison_statistics_merge(&slice_statistics[i],
+                                                out_statistics);
   }
+  return out_statistics->mismatch_count == 0;
 }
 
 bool iree_hal_compare_buffer_elements_broadcast(
     iree_hal_buffer_equality_t equality,
     iree_hal_buffer_element_t expected_element, iree_host_size_t element_count,
     iree_const_byte_span_t actual_elements, iree_host_size_t* out_index) {
-  return iree_hal_compare_strided_elements(
+  return iree_hal_compare_elements(
       equality, expected_element.type, element_count,
       iree_make_const_byte_span(
           expected_element.storage,
           iree_hal_element_dense_byte_count(expected_element.type)),
-      /*expected_stride=*/0, actual_elements, /*actual_stride=*/1, out_index);
+      /*broadcast=*/true, actual_elements, out_index);
 }
 
 bool iree_hal_compare_buffer_elements_elementwise(
     iree_hal_buffer_equality_t equality, iree_hal_element_type_t element_type,
     iree_host_size_t element_count, iree_const_byte_span_t expected_elements,
     iree_const_byte_span_t actual_elements, iree_host_size_t* out_index) {
-  return iree_hal_compare_strided_elements(
+  return iree_hal_compare_elements(equality, element_type, element_count,
+                                   expected_elements, /*broadcast=*/false,
+                                   actual_elements, out_index);
+}
+
+bool iree_hal_compare_buffer_elements_statistics(
+    iree_hal_buffer_equality_t equality, iree_hal_element_type_t element_type,
+    iree_host_size_t element_count, iree_const_byte_span_t expected_elements,
+    iree_const_byte_span_t actual_elements,
+    iree_hal_buffer_comparison_statistics_t* out_statistics) {
+  IREE_ASSERT_ARGUMENT(out_statistics);
+  return iree_hal_compare_elements_statistics(
       equality, element_type, element_count, expected_elements,
-      /*expected_stride=*/1, actual_elements, /*actual_stride=*/1, out_index);
+      /*broadcast=*/false, actual_elements, out_statistics);
+}
+
+iree_status_t iree_hal_append_buffer_comparison_statistics_string(
+    const iree_hal_buffer_comparison_statistics_t* statistics,
+    iree_string_builder_t* builder) {
+  IREE_ASSERT_ARGUMENT(statistics);
+  IREE_ASSERT_ARGUMENT(builder);
+  IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+      builder,
+      "%" PRIhsz " of %" PRIhsz
+      " elements do not match (max absolute error %g at index %" PRIhsz
+      ", max relative error %g at index %" PRIhsz
+      ", max ULP distance %" PRIu64 "); ULP distance histogram:",
+      statistics->mismatch_count, statistics->element_count,
+      statistics->max_absolute_error, statistics->max_absolute_error_index,
+      statistics->max_relative_error, statistics->max_relative_error_index,
+      statistics->max_ulp_distance));
+  for (iree_host_size_t i = 0; i < IREE_HAL_BUFFER_ULP_HISTOGRAM_BUCKET_COUNT;
+       ++i) {
+    if (!statistics->ulp_histogram[i]) continue;
+    if (i == 0) {
+      IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+          builder, " [0]=%" PRIhsz, statistics->ulp_histogram[i]));
+    } else if (i == IREE_HAL_BUFFER_ULP_HISTOGRAM_BUCKET_COUNT - 1) {
+      IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+          builder, " [%" PRIu64 ",inf)=%" PRIhsz, (uint64_t)1 << (i - 1),
+          statistics->ulp_histogram[i]));
+    } else {
+      IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+          builder, " [%" PRIu64 ",%" PRIu64 ")=%" PRIhsz,
+          (uint64_t)1 << (i - 1), (uint64_t)1 << i,
+          statistics->ulp_histogram[i]));
+    }
+  }
+  return iree_ok_status();
+}
+
+// Appends a summary of all differences between the elements of a failed match.
+static iree_status_t iree_hal_append_element_differences_string(
+    iree_hal_buffer_equality_t equality, iree_hal_element_type_t element_type,
+    iree_host_size_t element_count, iree_const_byte_span_t expected_elements,
+    bool broadcast, iree_const_byte_span_t actual_elements,
+    iree_string_builder_t* builder) {
+  iree_hal_buffer_comparison_statistics_t statistics;
+  iree_hal_compare_elements_statistics(equality, element_type, element_count,
+                                       expected_elements, broadcast,
+                                       actual_elements, &statistics);
+  IREE_RETURN_IF_ERROR(
+      iree_string_builder_append_string(builder, IREE_SV("; ")));
+  return iree_hal_append_buffer_comparison_statistics_string(&statistics,
+                                                             builder);
 }
 
 //===----------------------------------------------------------------------===//
@@ -391,13 +933,24 @@ iree_status_t iree_hal_buffer_view_element_matcher_match(
   iree_hal_buffer_element_t actual_element = iree_hal_buffer_element_at(
       iree_hal_buffer_view_element_type(matchee), actual_contents, i);
 
-  IREE_RETURN_IF_ERROR(iree_hal_buffer_unmap_range(&actual_mapping));
-
+  iree_status_t status = iree_ok_status();
   if (!all_match) {
-    IREE_RETURN_IF_ERROR(iree_hal_append_element_mismatch_string(
-        i, matcher->value, actual_element, builder));
+    status = iree_hal_append_element_mismatch_string(i, matcher->value,
+                                                     actual_element, builder);
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_append_element_differences_string(
+          matcher->equality, matcher->value.type,
+          iree_hal_buffer_view_element_count(matchee),
+          iree_make_const_byte_span(
+              matcher->value.storage,
+              iree_hal_element_dense_byte_count(matcher->value.type)),
+          /*broadcast=*/true, actual_contents, builder);
+    }
   }
 
+  status = iree_status_join(status,
+                            iree_hal_buffer_unmap_range(&actual_mapping));
+  IREE_RETURN_IF_ERROR(status);
   *out_matched = all_match;
   return iree_ok_status();
 }
@@ -516,13 +1069,21 @@ iree_status_t iree_hal_buffer_view_array_matcher_match(
   iree_hal_buffer_element_t expected_element = iree_hal_buffer_element_at(
       iree_hal_buffer_view_element_type(matchee), matcher->elements, i);
 
-  IREE_RETURN_IF_ERROR(iree_hal_buffer_unmap_range(&actual_mapping));
-
+  iree_status_t status = iree_ok_status();
   if (!all_match) {
-    IREE_RETURN_IF_ERROR(iree_hal_append_element_mismatch_string(
-        i, expected_element, actual_element, builder));
+    status = iree_hal_append_element_mismatch_string(i, expected_element,
+                                                     actual_element, builder);
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_append_element_differences_string(
+          matcher->equality, iree_hal_buffer_view_element_type(matchee),
+          iree_hal_buffer_view_element_count(matchee), matcher->elements,
+          /*broadcast=*/false, actual_contents, builder);
+    }
   }
 
+  status = iree_status_join(status,
+                            iree_hal_buffer_unmap_range(&actual_mapping));
+  IREE_RETURN_IF_ERROR(status);
   *out_matched = all_match;
   return iree_ok_status();
 }
@@ -631,14 +1192,22 @@ iree_status_t iree_hal_buffer_view_matcher_match(
   iree_hal_buffer_element_t expected_element = iree_hal_buffer_element_at(
       iree_hal_buffer_view_element_type(matchee), expected_contents, i);
 
-  IREE_RETURN_IF_ERROR(iree_hal_buffer_unmap_range(&actual_mapping));
-  IREE_RETURN_IF_ERROR(iree_hal_buffer_unmap_range(&expected_mapping));
-
   if (!all_match) {
-    IREE_RETURN_IF_ERROR(iree_hal_append_element_mismatch_string(
-        i, expected_element, actual_element, builder));
+    status = iree_hal_append_element_mismatch_string(i, expected_element,
+                                                     actual_element, builder);
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_append_element_differences_string(
+          matcher->equality, iree_hal_buffer_view_element_type(matchee),
+          iree_hal_buffer_view_element_count(matchee), expected_contents,
+          /*broadcast=*/false, actual_contents, builder);
+    }
   }
 
+  status = iree_status_join(status,
+                            iree_hal_buffer_unmap_range(&actual_mapping));
+  status = iree_status_join(status,
+                            iree_hal_buffer_unmap_range(&expected_mapping));
+  IREE_RETURN_IF_ERROR(status);
   *out_matched = all_match;
   return iree_ok_status();
 }
@@ -40,17 +40,30 @@ typedef enum {
   IREE_HAL_BUFFER_EQUALITY_EXACT = 0,
   // abs(a - b) <= threshold
   IREE_HAL_BUFFER_EQUALITY_APPROXIMATE_ABSOLUTE,
+  // abs(a - b) <= threshold + relative_threshold * abs(a)
+  IREE_HAL_BUFFER_EQUALITY_APPROXIMATE_RELATIVE,
+  // ulp_distance(a, b) <= max_ulp_distance
+  IREE_HAL_BUFFER_EQUALITY_APPROXIMATE_ULP,
 } iree_hal_buffer_equality_mode_t;
 
+// Approximate modes only apply to floating-point element types (f16, bf16,
+// f32, and f64) and all other element types are compared exactly. When
+// comparing approximately NaN matches NaN and never matches any other value.
+//
 // TODO(benvanik): initializers/configuration for equality comparisons.
 typedef struct {
   iree_hal_buffer_equality_mode_t mode;
-  // TODO(benvanik): allow override in approximate modes (ULP, abs/rel diff).
-  // For now we just have some hardcoded types that are used in place of
-  // compile-time constants. Consider these provisional.
+  // Absolute thresholds used by the APPROXIMATE_ABSOLUTE and
+  // APPROXIMATE_RELATIVE modes. bf16 uses the f16 threshold.
   float f16_threshold;
   float f32_threshold;
   double f64_threshold;
+  // Fraction of the expected magnitude added to the absolute threshold in the
+  // APPROXIMATE_RELATIVE mode.
+  double relative_threshold;
+  // Maximum number of representable values between the expected and actual
+  // values in the APPROXIMATE_ULP mode.
+  uint32_t max_ulp_distance;
 } iree_hal_buffer_equality_t;
 
 // Variant type storing known HAL buffer elements.
@@ -125,6 +138,7 @@ static inline iree_hal_buffer_element_t iree_hal_make_buffer_element_f64(
 
 // Returns true if all elements match the uniform value based on |equality|.
 // |out_index| will contain the first index that does not match.
+// Large comparisons are split across multiple threads.
 bool iree_hal_compare_buffer_elements_broadcast(
     iree_hal_buffer_equality_t equality,
     iree_hal_buffer_element_t expected_element, iree_host_size_t element_count,
@@ -132,11 +146,54 @@ bool iree_hal_compare_buffer_elements_broadcast(
 
 // Returns true if all elements match based on |equality|.
 // |out_index| will contain the first index that does not match.
+// Large comparisons are split across multiple threads.
 bool iree_hal_compare_buffer_elements_elementwise(
     iree_hal_buffer_equality_t equality, iree_hal_element_type_t element_type,
     iree_host_size_t element_count, iree_const_byte_span_t expected_elements,
     iree_const_byte_span_t actual_elements, iree_host_size_t* out_index);
 
+// Number of buckets in iree_hal_buffer_comparison_statistics_t::ulp_histogram.
+#define IREE_HAL_BUFFER_ULP_HISTOGRAM_BUCKET_COUNT 16
+
+// Summary of the differences between two sets of elements.
+// Errors and distances are only measured for numeric element types; integer
+// distances are in units of the integer value. Elements where only one of the
+// values is NaN are mismatches that do not contribute to the maximums.
+typedef struct {
+  iree_host_size_t element_count;
+  iree_host_size_t mismatch_count;
+  // Index of the first mismatching element or element_count if all match.
+  iree_host_size_t first_mismatch_index;
+  // Largest abs(expected - actual) and the first index it was seen at.
+  double max_absolute_error;
+  iree_host_size_t max_absolute_error_index;
+  // Largest abs(expected - actual) / abs(expected) and the first index it was
+  // seen at. Infinite if an expected zero was not matched exactly.
+  double max_relative_error;
+  iree_host_size_t max_relative_error_index;
+  // Largest distance in units in the last place between two elements.
+  uint64_t max_ulp_distance;
+  // Number of elements by distance in units in the last place. Bucket 0 holds
+  // exact matches, bucket i holds distances in [2^(i-1), 2^i), and the last
+  // bucket holds all larger distances along with mismatches that have no
+  // numeric distance.
+  iree_host_size_t ulp_histogram[IREE_HAL_BUFFER_ULP_HISTOGRAM_BUCKET_COUNT];
+} iree_hal_buffer_comparison_statistics_t;
+
+// Compares all elements and summarizes the differences in |out_statistics|.
+// Unlike the other comparisons this does not stop at the first mismatch.
+// Returns true if all elements match based on |equality|.
+bool iree_hal_compare_buffer_elements_statistics(
+    iree_hal_buffer_equality_t equality, iree_hal_element_type_t element_type,
+    iree_host_size_t element_count, iree_const_byte_span_t expected_elements,
+    iree_const_byte_span_t actual_elements,
+    iree_hal_buffer_comparison_statistics_t* out_statistics);
+
+// Appends a human-readable summary of |statistics| to |builder|.
+iree_status_t iree_hal_append_buffer_comparison_statistics_string(
+    const iree_hal_buffer_comparison_statistics_t* statistics,
+    iree_string_builder_t* builder);
+
 //===----------------------------------------------------------------------===//
 // iree_hal_buffer_view_metadata_matcher_t
 //===----------------------------------------------------------------------===//
@@ -6,6 +6,10 @@
 
 #include "iree/tooling/buffer_view_matchers.h"
 
+#include <cmath>
+#include <limits>
+#include <vector>
+
 #include "iree/base/api.h"
 #include "iree/base/internal/math.h"
 #include "iree/base/internal/span.h"
@@ -410,6 +414,167 @@ TEST_F(BufferViewMatchersTest, CompareElementwiseF64NE) {
   EXPECT_EQ(index, 1);
 }
 
+TEST_F(BufferViewMatchersTest, CompareElementwiseF32NaN) {
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  const float lhs[] = {1.0f, nan, nan};
+  const float rhs[] = {1.0f, nan, 3.0f};
+  iree_host_size_t index = 0;
+  EXPECT_FALSE(iree_hal_compare_buffer_elements_elementwise(
+      kApproximateEquality, IREE_HAL_ELEMENT_TYPE_FLOAT_32, IREE_ARRAYSIZE(lhs),
+      iree_make_const_byte_span(lhs, sizeof(lhs)),
+      iree_make_const_byte_span(rhs, sizeof(rhs)), &index));
+  EXPECT_EQ(index, 2);
+}
+
+TEST_F(BufferViewMatchersTest, CompareElementwiseF32Infinity) {
+  const float inf = std::numeric_limits<float>::infinity();
+  const float lhs[] = {inf, -inf, inf};
+  const float rhs[] = {inf, -inf, 1.0f};
+  iree_host_size_t index = 0;
+  EXPECT_FALSE(iree_hal_compare_buffer_elements_elementwise(
+      kApproximateEquality, IREE_HAL_ELEMENT_TYPE_FLOAT_32, IREE_ARRAYSIZE(lhs),
+      iree_make_const_byte_span(lhs, sizeof(lhs)),
+      iree_make_const_byte_span(rhs, sizeof(rhs)), &index));
+  EXPECT_EQ(index, 2);
+}
+
+TEST_F(BufferViewMatchersTest, CompareElementwiseF32Relative) {
+  iree_hal_buffer_equality_t equality = kApproximateEquality;
+  equality.mode = IREE_HAL_BUFFER_EQUALITY_APPROXIMATE_RELATIVE;
+  equality.relative_threshold = 0.01;
+  const float lhs[] = {1000.0f, 0.0f, 1000.0f};
+  const float rhs[] = {1009.0f, 0.00001f, 1011.0f};
+  iree_host_size_t index = 0;
+  EXPECT_FALSE(iree_hal_compare_buffer_elements_elementwise(
+      equality, IREE_HAL_ELEMENT_TYPE_FLOAT_32, IREE_ARRAYSIZE(lhs),
+      iree_make_const_byte_span(lhs, sizeof(lhs)),
+      iree_make_const_byte_span(rhs, sizeof(rhs)), &index));
+  EXPECT_EQ(index, 2);
+}
+
+TEST_F(BufferViewMatchersTest, CompareElementwiseF32ULP) {
+  iree_hal_buffer_equality_t equality = kApproximateEquality;
+  equality.mode = IREE_HAL_BUFFER_EQUALITY_APPROXIMATE_ULP;
+  equality.max_ulp_distance = 2;
+  const float lhs[] = {1.0f, -0.0f, 1.0f};
+  const float rhs[] = {std::nextafter(std::nextafter(1.0f, 2.0f), 2.0f), 0.0f,
+                       1.0001f};
+  iree_host_size_t index = 0;
+  EXPECT_FALSE(iree_hal_compare_buffer_elements_elementwise(
+      equality, IREE_HAL_ELEMENT_TYPE_FLOAT_32, IREE_ARRAYSIZE(lhs),
+      iree_make_const_byte_span(lhs, sizeof(lhs)),
+      iree_make_const_byte_span(rhs, sizeof(rhs)), &index));
+  EXPECT_EQ(index, 2);
+}
+
+TEST_F(BufferViewMatchersTest, CompareElementwiseBF16ULP) {
+  iree_hal_buffer_equality_t equality = kApproximateEquality;
+  equality.mode = IREE_HAL_BUFFER_EQUALITY_APPROXIMATE_ULP;
+  equality.max_ulp_distance = 1;
+  // 1.0, -1.0, and 2.0 with the low bits of the mantissa perturbed.
+  const uint16_t lhs[] = {0x3F80, 0xBF80, 0x4000};
+  const uint16_t rhs[] = {0x3F81, 0xBF7F, 0x4002};
+  iree_host_size_t index = 0;
+  EXPECT_FALSE(iree_hal_compare_buffer_elements_elementwise(
+      equality, IREE_HAL_ELEMENT_TYPE_BFLOAT_16, IREE_ARRAYSIZE(lhs),
+      iree_make_const_byte_span(lhs, sizeof(lhs)),
+      iree_make_const_byte_span(rhs, sizeof(rhs)), &index));
+  EXPECT_EQ(index, 2);
+}
+
+// Large enough to be split across multiple threads. Mismatches in later
+// slices must not hide earlier ones.
+TEST_F(BufferViewMatchersTest, CompareElementwiseLargeF32) {
+  std::vector<float> lhs(5 * 1024 * 1024 + 3, 1.0f);
+  std::vector<float> rhs = lhs;
+  iree_host_size_t index = 0;
+  EXPECT_TRUE(iree_hal_compare_buffer_elements_elementwise(
+      kApproximateEquality, IREE_HAL_ELEMENT_TYPE_FLOAT_32, lhs.size(),
+      iree_make_const_byte_span(lhs.data(), lhs.size() * sizeof(float)),
+      iree_make_const_byte_span(rhs.data(), rhs.size() * sizeof(float)),
+      &index));
+  rhs[rhs.size() - 1] = 2.0f;
+  rhs[4 * 1024 * 1024 + 17] = 2.0f;
+  rhs[3 * 1024 * 1024 + 5] = 2.0f;
+  EXPECT_FALSE(iree_hal_compare_buffer_elements_elementwise(
+      kApproximateEquality, IREE_HAL_ELEMENT_TYPE_FLOAT_32, lhs.size(),
+      iree_make_const_byte_span(lhs.data(), lhs.size() * sizeof(float)),
+      iree_make_const_byte_span(rhs.data(), rhs.size() * sizeof(float)),
+      &index));
+  EXPECT_EQ(index, 3 * 1024 * 1024 + 5);
+  EXPECT_FALSE(iree_hal_compare_buffer_elements_elementwise(
+      kExactEquality, IREE_HAL_ELEMENT_TYPE_FLOAT_32, lhs.size(),
+      iree_make_const_byte_span(lhs.data(), lhs.size() * sizeof(float)),
+      iree_make_const_byte_span(rhs.data(), rhs.size() * sizeof(float)),
+      &index));
+  EXPECT_EQ(index, 3 * 1024 * 1024 + 5);
+}
+
+TEST_F(BufferViewMatchersTest, CompareBroadcastLargeI32) {
+  std::vector<int32_t> rhs(3 * 1024 * 1024, 7);
+  iree_host_size_t index = 0;
+  EXPECT_TRUE(iree_hal_compare_buffer_elements_broadcast(
+      kExactEquality, iree_hal_make_buffer_element_i32(7), rhs.size(),
+      iree_make_const_byte_span(rhs.data(), rhs.size() * sizeof(int32_t)),
+      &index));
+  rhs[2 * 1024 * 1024 + 1] = 8;
+  EXPECT_FALSE(iree_hal_compare_buffer_elements_broadcast(
+      kExactEquality, iree_hal_make_buffer_element_i32(7), rhs.size(),
+      iree_make_const_byte_span(rhs.data(), rhs.size() * sizeof(int32_t)),
+      &index));
+  EXPECT_EQ(index, 2 * 1024 * 1024 + 1);
+}
+
+TEST_F(BufferViewMatchersTest, CompareStatisticsF32) {
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  const float lhs[] = {1.0f, 2.0f, 4.0f, nan, 8.0f, 0.5f};
+  const float rhs[] = {1.0f, std::nextafter(2.0f, 3.0f), 4.5f, 1.0f, 8.0f,
+                       0.25f};
+  iree_hal_buffer_comparison_statistics_t statistics;
+  EXPECT_FALSE(iree_hal_compare_buffer_elements_statistics(
+      kApproximateEquality, IREE_HAL_ELEMENT_TYPE_FLOAT_32, IREE_ARRAYSIZE(lhs),
+      iree_make_const_byte_span(lhs, sizeof(lhs)),
+      iree_make_const_byte_span(rhs, sizeof(rhs)), &statistics));
+  EXPECT_EQ(statistics.element_count, 6);
+  EXPECT_EQ(statistics.mismatch_count, 3);
+  EXPECT_EQ(statistics.first_mismatch_index, 2);
+  EXPECT_EQ(statistics.max_absolute_error, 0.5);
+  EXPECT_EQ(statistics.max_absolute_error_index, 2);
+  EXPECT_EQ(statistics.max_relative_error, 0.5);
+  EXPECT_EQ(statistics.max_relative_error_index, 5);
+  // 4.0 -> 4.5 is 2^20 ULPs and 0.5 -> 0.25 is 2^23.
+  EXPECT_EQ(statistics.max_ulp_distance, 1u << 23);
+  EXPECT_EQ(statistics.ulp_histogram[0], 2);
+  EXPECT_EQ(statistics.ulp_histogram[1], 1);
+  const size_t last_bucket = IREE_HAL_BUFFER_ULP_HISTOGRAM_BUCKET_COUNT - 1;
+  EXPECT_EQ(statistics.ulp_histogram[last_bucket], 3);
+
+  auto sb = StringBuilder::MakeSystem();
+  IREE_ASSERT_OK(
+      iree_hal_append_buffer_comparison_statistics_string(&statistics, sb));
+  EXPECT_THAT(sb.ToString(), HasSubstr("3 of 6 elements do not match"));
+  EXPECT_THAT(sb.ToString(), HasSubstr("[1,2)=1"));
+}
+
+TEST_F(BufferViewMatchersTest, CompareStatisticsLargeI8) {
+  std::vector<int8_t> lhs(4 * 1024 * 1024, 1);
+  std::vector<int8_t> rhs = lhs;
+  rhs[1 * 1024 * 1024 + 3] = 4;
+  rhs[3 * 1024 * 1024 + 9] = -1;
+  iree_hal_buffer_comparison_statistics_t statistics;
+  EXPECT_FALSE(iree_hal_compare_buffer_elements_statistics(
+      kApproximateEquality, IREE_HAL_ELEMENT_TYPE_INT_8, lhs.size(),
+      iree_make_const_byte_span(lhs.data(), lhs.size()),
+      iree_make_const_byte_span(rhs.data(), rhs.size()), &statistics));
+  EXPECT_EQ(statistics.mismatch_count, 2);
+  EXPECT_EQ(statistics.first_mismatch_index, 1 * 1024 * 1024 + 3);
+  EXPECT_EQ(statistics.max_absolute_error, 3.0);
+  EXPECT_EQ(statistics.max_absolute_error_index, 1 * 1024 * 1024 + 3);
+  EXPECT_EQ(statistics.max_ulp_distance, 3);
+  EXPECT_EQ(statistics.ulp_histogram[0], lhs.size() - 2);
+  EXPECT_EQ(statistics.ulp_histogram[2], 2);
+}
+
 //===----------------------------------------------------------------------===//
 // iree_hal_buffer_view_metadata_matcher_t
 //===----------------------------------------------------------------------===//
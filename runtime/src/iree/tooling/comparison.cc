@@ -20,20 +20,57 @@
 
 using namespace iree;
 
+IREE_FLAG(string, expected_comparison_mode, "absolute",
+          "Mode used to compare floating-point values: `exact`, `absolute`,\n"
+          "`relative`, or `ulp`.");
 IREE_FLAG(float, expected_f16_threshold, 0.001f,
           "Threshold under which two f16 values are considered equal.");
 IREE_FLAG(float, expected_f32_threshold, 0.0001f,
           "Threshold under which two f32 values are considered equal.");
 IREE_FLAG(double, expected_f64_threshold, 0.0001,
           "Threshold under which two f64 values are considered equal.");
+IREE_FLAG(double, expected_relative_threshold, 0.0,
+          "Fraction of the expected value added to the threshold in the\n"
+          "`relative` comparison mode.");
+IREE_FLAG(int32_t, expected_max_ulp_distance, 4,
+          "Maximum number of representable values between two values\n"
+          "considered equal in the `ulp` comparison mode.");
 
-static iree_hal_buffer_equality_t iree_tooling_equality_from_flags(void) {
-  iree_hal_buffer_equality_t equality;
-  equality.mode = IREE_HAL_BUFFER_EQUALITY_APPROXIMATE_ABSOLUTE;
-  equality.f16_threshold = FLAG_expected_f16_threshold;
-  equality.f32_threshold = FLAG_expected_f32_threshold;
-  equality.f64_threshold = FLAG_expected_f64_threshold;
-  return equality;
+static iree_status_t iree_tooling_parse_equality_mode(
+    iree_string_view_t value, iree_hal_buffer_equality_mode_t* out_mode) {
+  if (iree_string_view_equal(value, IREE_SV("exact"))) {
+    *out_mode = IREE_HAL_BUFFER_EQUALITY_EXACT;
+  } else if (iree_string_view_equal(value, IREE_SV("absolute"))) {
+    *out_mode = IREE_HAL_BUFFER_EQUALITY_APPROXIMATE_ABSOLUTE;
+  } else if (iree_string_view_equal(value, IREE_SV("relative"))) {
+    *out_mode = IREE_HAL_BUFFER_EQUALITY_APPROXIMATE_RELATIVE;
+  } else if (iree_string_view_equal(value, IREE_SV("ulp"))) {
+    *out_mode = IREE_HAL_BUFFER_EQUALITY_APPROXIMATE_ULP;
+  } else {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "unsupported comparison mode '%.*s'",
+                            (int)value.size, value.data);
+  }
+  return iree_ok_status();
+}
+
+static iree_status_t iree_tooling_equality_from_flags(
+    iree_hal_buffer_equality_t* out_equality) {
+  IREE_RETURN_IF_ERROR(iree_tooling_parse_equality_mode(
+      iree_make_cstring_view(FLAG_expected_comparison_mode),
+      &out_equality->mode));
+  if (FLAG_expected_max_ulp_distance < 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "--expected_max_ulp_distance must be >= 0 but "
+                            "got %d",
+                            FLAG_expected_max_ulp_distance);
+  }
+  out_equality->f16_threshold = FLAG_expected_f16_threshold;
+  out_equality->f32_threshold = FLAG_expected_f32_threshold;
+  out_equality->f64_threshold = FLAG_expected_f64_threshold;
+  out_equality->relative_threshold = FLAG_expected_relative_threshold;
+  out_equality->max_ulp_distance = (uint32_t)FLAG_expected_max_ulp_distance;
+  return iree_ok_status();
 }
 
 static iree_status_t iree_vm_append_variant_type_string(
@@ -152,13 +189,13 @@ static bool iree_tooling_compare_values(int result_index,
 }
 
 static bool iree_tooling_compare_buffer_views(
-    int result_index, iree_hal_buffer_view_t* expected_view,
-    iree_hal_buffer_view_t* actual_view, iree_allocator_t host_allocator,
-    iree_host_size_t max_element_count, iree_string_builder_t* builder) {
+    int result_index, iree_hal_buffer_equality_t equality,
+    iree_hal_buffer_view_t* expected_view, iree_hal_buffer_view_t* actual_view,
+    iree_allocator_t host_allocator, iree_host_size_t max_element_count,
+    iree_string_builder_t* builder) {
   iree_string_builder_t subbuilder;
   iree_string_builder_initialize(host_allocator, &subbuilder);
 
-  iree_hal_buffer_equality_t equality = iree_tooling_equality_from_flags();
   bool did_match = false;
   IREE_CHECK_OK(iree_hal_buffer_view_match_equal(
       equality, expected_view, actual_view, &subbuilder, &did_match));
@@ -186,6 +223,7 @@ static bool iree_tooling_compare_buffer_views(
 }
 
 static bool iree_tooling_compare_variants(int result_index,
+                                          iree_hal_buffer_equality_t equality,
                                           iree_vm_variant_t expected_variant,
                                           iree_vm_variant_t actual_variant,
                                           iree_allocator_t host_allocator,
@@ -209,7 +247,8 @@ static bool iree_tooling_compare_variants(int result_index,
     if (iree_hal_buffer_view_isa(actual_variant.ref) &&
         iree_hal_buffer_view_isa(expected_variant.ref)) {
       return iree_tooling_compare_buffer_views(
-          result_index, iree_hal_buffer_view_deref(expected_variant.ref),
+          result_index, equality,
+          iree_hal_buffer_view_deref(expected_variant.ref),
           iree_hal_buffer_view_deref(actual_variant.ref), host_allocator,
           max_element_count, builder);
     }
@@ -228,16 +267,21 @@ static bool iree_tooling_compare_variants(int result_index,
   return false;
 }
 
-bool iree_tooling_compare_variant_lists_and_append(
+iree_status_t iree_tooling_compare_variant_lists_and_append(
     iree_vm_list_t* expected_list, iree_vm_list_t* actual_list,
-    iree_allocator_t host_allocator, iree_string_builder_t* builder) {
+    iree_allocator_t host_allocator, iree_string_builder_t* builder,
+    bool* out_all_match) {
   IREE_TRACE_SCOPE();
+  *out_all_match = false;
+
+  iree_hal_buffer_equality_t equality;
+  IREE_RETURN_IF_ERROR(iree_tooling_equality_from_flags(&equality));
 
   if (iree_vm_list_size(expected_list) != iree_vm_list_size(actual_list)) {
     IREE_CHECK_OK(iree_string_builder_append_format(
         builder, "[FAILED] expected %zu list elements but %zu provided\n",
         iree_vm_list_size(expected_list), iree_vm_list_size(actual_list)));
-    return false;
+    return iree_ok_status();
   }
 
   bool all_match = true;
@@ -249,24 +293,24 @@ bool iree_tooling_compare_variant_lists_and_append(
     IREE_CHECK_OK(
         iree_vm_list_get_variant_assign(actual_list, i, &actual_variant));
     bool did_match = iree_tooling_compare_variants(
-        (int)i, expected_variant, actual_variant, host_allocator,
+        (int)i, equality, expected_variant, actual_variant, host_allocator,
         /*max_element_count=*/1024, builder);
     if (!did_match) all_match = false;
   }
 
-  return all_match;
+  *out_all_match = all_match;
+  return iree_ok_status();
 }
 
-bool iree_tooling_compare_variant_lists(iree_vm_list_t* expected_list,
-                                        iree_vm_list_t* actual_list,
-                                        iree_allocator_t host_allocator,
-                                        FILE* file) {
+iree_status_t iree_tooling_compare_variant_lists(
+    iree_vm_list_t* expected_list, iree_vm_list_t* actual_list,
+    iree_allocator_t host_allocator, FILE* file, bool* out_all_match) {
   iree_string_builder_t builder;
   iree_string_builder_initialize(host_allocator, &builder);
-  bool all_match = iree_tooling_compare_variant_lists_and_append(
-      expected_list, actual_list, host_allocator, &builder);
+  iree_status_t status = iree_tooling_compare_variant_lists_and_append(
+      expected_list, actual_list, host_allocator, &builder, out_all_match);
   fwrite(iree_string_builder_buffer(&builder), 1,
          iree_string_builder_size(&builder), file);
   iree_string_builder_deinitialize(&builder);
-  return all_match;
+  return status;
 }
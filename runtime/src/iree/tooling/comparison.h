@@ -17,20 +17,21 @@ extern "C" {
 #endif  // __cplusplus
 
 // Compares expected vs actual results and appends to |builder|.
-// Returns true if all values match and false otherwise.
-// Errors when performing comparison will abort the process.
+// Sets |out_all_match| to true if all values match and false otherwise.
+// Returns an error if the comparison flags are invalid; other errors when
+// performing comparison will abort the process.
 // When all list elements match no output is written and otherwise
 // newline-separated strings detailing the differing elements is appended.
-bool iree_tooling_compare_variant_lists_and_append(
+iree_status_t iree_tooling_compare_variant_lists_and_append(
     iree_vm_list_t* expected_list, iree_vm_list_t* actual_list,
-    iree_allocator_t host_allocator, iree_string_builder_t* builder);
+    iree_allocator_t host_allocator, iree_string_builder_t* builder,
+    bool* out_all_match);
 
 // Compares expected vs actual results and appends to |file|.
 // Refer to iree_tooling_compare_variant_lists_and_append for details.
-bool iree_tooling_compare_variant_lists(iree_vm_list_t* expected_list,
-                                        iree_vm_list_t* actual_list,
-                                        iree_allocator_t host_allocator,
-                                        FILE* file);
+iree_status_t iree_tooling_compare_variant_lists(
+    iree_vm_list_t* expected_list, iree_vm_list_t* actual_list,
+    iree_allocator_t host_allocator, FILE* file, bool* out_all_match);
 
 #ifdef __cplusplus
 }  // extern "C"
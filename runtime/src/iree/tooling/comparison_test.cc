@@ -6,7 +6,11 @@
 
 #include "iree/tooling/comparison.h"
 
+#include <deque>
+#include <string>
+
 #include "iree/base/api.h"
+#include "iree/base/internal/flags.h"
 #include "iree/base/internal/span.h"
 #include "iree/hal/api.h"
 #include "iree/modules/hal/module.h"
@@ -18,8 +22,22 @@
 namespace iree {
 namespace {
 
+using ::iree::testing::status::StatusIs;
 using ::testing::HasSubstr;
 
+// Parses a single command line |flag| into the registered flags.
+// Flag parsing modifies argv in place and string flags reference it so the
+// storage must outlive the test.
+static void SetFlag(const char* flag) {
+  static std::deque<std::string> flag_storage;
+  flag_storage.emplace_back(flag);
+  char* argv_storage[] = {const_cast<char*>("test"),
+                          &flag_storage.back()[0]};
+  char** argv = argv_storage;
+  int argc = IREE_ARRAYSIZE(argv_storage);
+  IREE_CHECK_OK(iree_flags_parse(IREE_FLAGS_PARSE_MODE_DEFAULT, &argc, &argv));
+}
+
 static void ParseToVariantList(iree_hal_allocator_t* device_allocator,
                                iree::span<const std::string> input_strings,
                                iree_allocator_t host_allocator,
@@ -62,8 +80,10 @@ class ComparisonTest : public ::testing::Test {
 
     iree_string_builder_t builder;
     iree_string_builder_initialize(host_allocator_, &builder);
-    bool all_match = iree_tooling_compare_variant_lists_and_append(
-        expected_list.get(), actual_list.get(), host_allocator_, &builder);
+    bool all_match = false;
+    IREE_CHECK_OK(iree_tooling_compare_variant_lists_and_append(
+        expected_list.get(), actual_list.get(), host_allocator_, &builder,
+        &all_match));
     out_string->assign(iree_string_builder_buffer(&builder),
                        iree_string_builder_size(&builder));
     iree_string_builder_deinitialize(&builder);
@@ -137,5 +157,35 @@ TEST_F(ComparisonTest, CompareListsWithDifferingTypes) {
   EXPECT_THAT(result, HasSubstr("variant types mismatch"));
 }
 
+// Invalid comparison flags are returned to the caller instead of aborting.
+TEST_F(ComparisonTest, InvalidComparisonFlags) {
+  auto strings = std::vector<std::string>{"2xf32=[1 2]"};
+  vm::ref<iree_vm_list_t> list;
+  ParseToVariantList(device_allocator_, strings, host_allocator_, &list);
+  iree_string_builder_t builder;
+  iree_string_builder_initialize(host_allocator_, &builder);
+  bool all_match = false;
+
+  SetFlag("--expected_comparison_mode=bogus");
+  EXPECT_THAT(Status(iree_tooling_compare_variant_lists_and_append(
+                  list.get(), list.get(), host_allocator_, &builder,
+                  &all_match)),
+              StatusIs(StatusCode::kInvalidArgument));
+  SetFlag("--expected_comparison_mode=absolute");
+
+  // Negative distances must not wrap around to huge unsigned values.
+  SetFlag("--expected_max_ulp_distance=-1");
+  EXPECT_THAT(Status(iree_tooling_compare_variant_lists_and_append(
+                  list.get(), list.get(), host_allocator_, &builder,
+                  &all_match)),
+              StatusIs(StatusCode::kInvalidArgument));
+  SetFlag("--expected_max_ulp_distance=4");
+
+  IREE_EXPECT_OK(iree_tooling_compare_variant_lists_and_append(
+      list.get(), list.get(), host_allocator_, &builder, &all_match));
+  EXPECT_TRUE(all_match);
+  iree_string_builder_deinitialize(&builder);
+}
+
 }  // namespace
 }  // namespace iree
@@ -14,6 +14,7 @@
 #include "iree/base/internal/flags.h"
 #include "iree/base/internal/path.h"
 #include "iree/base/tracing.h"
+#include "iree/hal/local/fork_join_pool_flags.h"
 #include "iree/hal/local/loaders/registration/init.h"
 #include "iree/hal/local/plugins/registration/init.h"
 #include "iree/modules/hal/inline/module.h"
@@ -291,15 +292,24 @@ static iree_status_t iree_tooling_load_hal_loader_module(
       plugin_manager, IREE_ARRAYSIZE(loaders), &loader_count, loaders,
       host_allocator);
 
-  // Create the module; it retains the loaders for its lifetime.
+  // Create the optional pool used to distribute workgroups across threads.
+  iree_hal_local_fork_join_pool_t* fork_join_pool = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_local_fork_join_pool_create_from_flags(host_allocator,
+                                                             &fork_join_pool);
+  }
+
+  // Create the module; it retains the loaders and pool for its lifetime.
   iree_vm_module_t* module = NULL;
   if (iree_status_is_ok(status)) {
     iree_hal_loader_module_flags_t flags = IREE_HAL_LOADER_MODULE_FLAG_NONE;
     status = iree_hal_loader_module_create(instance, flags, loader_count,
-                                           loaders, host_allocator, &module);
+                                           loaders, fork_join_pool,
+                                           host_allocator, &module);
   }
 
   // Always release loaders; loader module has retained them.
+  iree_hal_local_fork_join_pool_release(fork_join_pool);
   for (iree_host_size_t i = 0; i < loader_count; ++i) {
     iree_hal_executable_loader_release(loaders[i]);
   }
@@ -6,6 +6,8 @@
 
 #include "iree/tooling/device_util.h"
 
+#include <inttypes.h>
+
 #include "iree/base/internal/call_once.h"
 #include "iree/base/internal/flags.h"
 #include "iree/base/tracing.h"
@@ -446,3 +448,37 @@ iree_status_t iree_hal_end_profiling_from_flags(iree_hal_device_t* device) {
   if (strlen(FLAG_device_profiling_mode) == 0) return iree_ok_status();
   return iree_hal_device_profiling_end(device);
 }
+
+iree_status_t iree_hal_device_executable_statistics_fprint(
+    FILE* file, iree_hal_device_t* device) {
+  if (!device) return iree_ok_status();
+  int64_t load_count = 0;
+  iree_status_t status = iree_hal_device_query_i64(
+      device, IREE_SV("hal.executable.statistics"), IREE_SV("load_count"),
+      &load_count);
+  if (iree_status_is_not_found(status)) {
+    // Device does not track executable statistics.
+    iree_status_ignore(status);
+    return iree_ok_status();
+  }
+  IREE_RETURN_IF_ERROR(status);
+  int64_t load_bytes = 0;
+  IREE_RETURN_IF_ERROR(iree_hal_device_query_i64(
+      device, IREE_SV("hal.executable.statistics"), IREE_SV("load_bytes"),
+      &load_bytes));
+  int64_t load_time_ns = 0;
+  IREE_RETURN_IF_ERROR(iree_hal_device_query_i64(
+      device, IREE_SV("hal.executable.statistics"), IREE_SV("load_time_ns"),
+      &load_time_ns));
+  int64_t load_time_max_ns = 0;
+  IREE_RETURN_IF_ERROR(iree_hal_device_query_i64(
+      device, IREE_SV("hal.executable.statistics"), IREE_SV("load_time_max_ns"),
+      &load_time_max_ns));
+  fprintf(file, "[[ iree_hal_executable_t load statistics ]]\n");
+  fprintf(file,
+          "LOAD: %" PRId64 " executables, %" PRId64 "B, %.3fms total, "
+          "%.3fms max\n",
+          load_count, load_bytes, load_time_ns / 1000000.0,
+          load_time_max_ns / 1000000.0);
+  return iree_ok_status();
+}
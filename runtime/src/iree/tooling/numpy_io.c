@@ -6,8 +6,17 @@
 
 #include "iree/tooling/numpy_io.h"
 
+#include "iree/base/internal/file_io.h"
+#include "iree/base/internal/fork_join.h"
 #include "iree/base/tracing.h"
 
+// Minimum number of bytes each thread reads when loading arrays in parallel.
+// Arrays smaller than twice this are read on the calling thread.
+#define IREE_NUMPY_NPY_PARALLEL_READ_CHUNK_LENGTH (8 * 1024 * 1024)
+
+// Maximum number of threads used to read the contents of a single array.
+#define IREE_NUMPY_NPY_PARALLEL_READ_MAX_THREADS 8
+
 //===----------------------------------------------------------------------===//
 // .npy (multiple values concatenated)
 //===----------------------------------------------------------------------===//
@@ -119,14 +128,93 @@ static iree_status_t iree_numpy_npy_read_header(
   return status;
 }
 
+// A range of the array contents read by a single thread.
+typedef struct {
+  FILE* stream;
+  uint64_t offset;
+  iree_byte_span_t buffer;
+  iree_status_t status;
+} iree_numpy_npy_read_chunk_t;
+
+static void iree_numpy_npy_read_chunk(void* user_data, iree_host_size_t index) {
+  iree_numpy_npy_read_chunk_t* chunk =
+      &((iree_numpy_npy_read_chunk_t*)user_data)[index];
+  chunk->status =
+      iree_file_read_at(chunk->stream, chunk->offset, chunk->buffer);
+}
+
+// Reads |buffer| from |stream| starting at |offset| by splitting it across
+// |thread_count| threads issuing positional reads. The calling thread reads
+// the first chunk.
+static iree_status_t iree_numpy_npy_read_parallel(
+    FILE* stream, uint64_t offset, iree_byte_span_t buffer,
+    iree_host_size_t thread_count, iree_allocator_t host_allocator) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (uint64_t)thread_count);
+
+  // Chunks are page-aligned so that threads don't fault in the same pages.
+  iree_host_size_t chunk_length = iree_host_align(
+      (buffer.data_length + thread_count - 1) / thread_count, 4096);
+  iree_numpy_npy_read_chunk_t
+      chunks[IREE_NUMPY_NPY_PARALLEL_READ_MAX_THREADS];
+  iree_host_size_t chunk_count = 0;
+  for (iree_host_size_t chunk_offset = 0; chunk_offset < buffer.data_length;
+       chunk_offset += chunk_length) {
+    iree_numpy_npy_read_chunk_t* chunk = &chunks[chunk_count++];
+    chunk->stream = stream;
+    chunk->offset = offset + chunk_offset;
+    chunk->buffer = iree_make_byte_span(
+        buffer.data + chunk_offset,
+        iree_min(chunk_length, buffer.data_length - chunk_offset));
+    chunk->status = iree_ok_status();
+  }
+  iree_fork_join(IREE_SV("iree-npy-read"), chunk_count,
+                 iree_numpy_npy_read_chunk, chunks, host_allocator);
+
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < chunk_count; ++i) {
+    status = iree_status_join(status, chunks[i].status);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 typedef struct {
   FILE* stream;
+  // Offset of the array contents in |stream| or -1 if it cannot be positioned.
+  int64_t offset;
+  iree_allocator_t host_allocator;
 } iree_numpy_npy_read_params_t;
 static iree_status_t iree_numpy_npy_read_into_mapping(
     iree_hal_buffer_mapping_t* mapping, void* user_data) {
   iree_numpy_npy_read_params_t* params =
       (iree_numpy_npy_read_params_t*)user_data;
   iree_host_size_t contents_length = mapping->contents.data_length;
+
+  // Large arrays are read with multiple threads if the platform supports
+  // positional reads (probed with an empty read). Those leave the stream
+  // position unspecified so it is explicitly moved past the contents afterward.
+  iree_host_size_t thread_count =
+      iree_min(contents_length / IREE_NUMPY_NPY_PARALLEL_READ_CHUNK_LENGTH,
+               IREE_NUMPY_NPY_PARALLEL_READ_MAX_THREADS);
+  if (thread_count > 1 && params->offset >= 0) {
+    iree_status_t probe_status = iree_file_read_at(
+        params->stream, params->offset, iree_make_byte_span(NULL, 0));
+    if (iree_status_is_ok(probe_status)) {
+      IREE_RETURN_IF_ERROR(iree_numpy_npy_read_parallel(
+          params->stream, params->offset, mapping->contents, thread_count,
+          params->host_allocator));
+      if (iree_fseek64(params->stream, params->offset + contents_length,
+                       SEEK_SET) != 0) {
+        return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                                "failed to seek past npy contents");
+      }
+      return iree_ok_status();
+    }
+    iree_status_ignore(probe_status);
+  }
+
   if (fread(mapping->contents.data, 1, contents_length, params->stream) !=
       contents_length) {
     return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
@@ -136,6 +224,72 @@ static iree_status_t iree_numpy_npy_read_into_mapping(
   return iree_ok_status();
 }
 
+static void iree_numpy_npy_release_file_contents(void* user_data,
+                                                 iree_hal_buffer_t* buffer) {
+  iree_file_contents_free((iree_file_contents_t*)user_data);
+}
+
+// Tries to map the |byte_length| bytes of array contents at |offset| in
+// |stream| and import them into |device_allocator| without copying.
+// Returns false if the contents cannot be used in place and must be read.
+static bool iree_numpy_npy_try_import_mapping(
+    FILE* stream, uint64_t offset, iree_device_size_t byte_length,
+    iree_hal_buffer_params_t buffer_params,
+    iree_hal_allocator_t* device_allocator, iree_hal_buffer_t** out_buffer) {
+  *out_buffer = NULL;
+  if (byte_length == 0) return false;
+
+  // Only devices that can access host memory can import the mapping.
+  iree_hal_buffer_params_t compat_params = buffer_params;
+  iree_device_size_t compat_length = byte_length;
+  if (!iree_all_bits_set(iree_hal_allocator_query_buffer_compatibility(
+                             device_allocator, buffer_params, byte_length,
+                             &compat_params, &compat_length),
+                         IREE_HAL_BUFFER_COMPATIBILITY_IMPORTABLE)) {
+    return false;
+  }
+
+  // Mapping can fail for reasons such as the stream being a pipe; reading
+  // still works in those cases and will report any real errors.
+  iree_file_contents_t* contents = NULL;
+  iree_status_t status = iree_file_map_contents(
+      stream, offset, byte_length,
+      iree_hal_allocator_host_allocator(device_allocator), &contents);
+  if (!iree_status_is_ok(status)) {
+    iree_status_ignore(status);
+    return false;
+  }
+
+  // numpy pads headers such that the first array in a file is aligned but the
+  // contents of arrays following others in a concatenated file may not be.
+  if (!iree_host_size_has_alignment((uintptr_t)contents->buffer.data,
+                                    IREE_HAL_HEAP_BUFFER_ALIGNMENT)) {
+    iree_file_contents_free(contents);
+    return false;
+  }
+
+  iree_hal_external_buffer_t external_buffer;
+  memset(&external_buffer, 0, sizeof(external_buffer));
+  external_buffer.type = IREE_HAL_EXTERNAL_BUFFER_TYPE_HOST_ALLOCATION;
+  external_buffer.flags = IREE_HAL_EXTERNAL_BUFFER_FLAG_NONE;
+  external_buffer.size = byte_length;
+  external_buffer.handle.host_allocation.ptr = contents->buffer.data;
+  iree_hal_buffer_release_callback_t release_callback = {
+      .fn = iree_numpy_npy_release_file_contents,
+      .user_data = contents,
+  };
+  status = iree_hal_allocator_import_buffer(device_allocator, buffer_params,
+                                            &external_buffer, release_callback,
+                                            out_buffer);
+  if (!iree_status_is_ok(status)) {
+    iree_status_ignore(status);
+    iree_file_contents_free(contents);
+    *out_buffer = NULL;
+    return false;
+  }
+  return true;
+}
+
 // Scans for the next key: value pair in |dict|.
 // |dict| will be set to the remaining |dict| string after the key and value.
 static iree_status_t iree_numpy_consume_dict_key_value(
@@ -370,12 +524,43 @@ iree_numpy_npy_load_ndarray(FILE* stream, iree_numpy_npy_load_options_t options,
     if (!iree_status_is_ok(status)) break;
   }
 
-  // Allocate the buffer view and directly read into the allocated memory.
-  // On targets where we can perform host mapping this will be zero-copy; on
-  // others it'll at least be _somewhat_ efficient.
+  // Compute the length of the contents that follow the header. Streams that
+  // cannot be positioned (pipes, etc) report an offset of -1.
+  int64_t contents_offset = (int64_t)iree_ftell64(stream);
+  iree_device_size_t contents_length = 0;
   if (iree_status_is_ok(status)) {
+    status = iree_hal_buffer_compute_view_size(
+        shape_rank, shape, element_type, encoding_type, &contents_length);
+  }
+
+  // If requested try to use the file contents in place. This is zero-copy
+  // when the device can access host memory and the contents are suitably
+  // aligned within the file.
+  iree_hal_buffer_t* mapped_buffer = NULL;
+  if (iree_status_is_ok(status) &&
+      iree_all_bits_set(options, IREE_NUMPY_NPY_LOAD_OPTION_MAP_FILE) &&
+      contents_offset >= 0 &&
+      iree_numpy_npy_try_import_mapping(stream, (uint64_t)contents_offset,
+                                        contents_length, buffer_params,
+                                        device_allocator, &mapped_buffer)) {
+    status = iree_hal_buffer_view_create(mapped_buffer, shape_rank, shape,
+                                         element_type, encoding_type,
+                                         host_allocator, out_buffer_view);
+    iree_hal_buffer_release(mapped_buffer);
+    if (iree_status_is_ok(status) &&
+        iree_fseek64(stream, contents_offset + contents_length, SEEK_SET) !=
+            0) {
+      status = iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                                "failed to seek past npy contents");
+    }
+  } else if (iree_status_is_ok(status)) {
+    // Allocate the buffer view and directly read into the allocated memory.
+    // On targets where we can perform host mapping this avoids any
+    // intermediate copies.
     iree_numpy_npy_read_params_t read_params = {
         .stream = stream,
+        .offset = contents_offset,
+        .host_allocator = host_allocator,
     };
     buffer_params.access |= IREE_HAL_MEMORY_ACCESS_DISCARD_WRITE;
     status = iree_hal_buffer_view_generate_buffer(
@@ -16,18 +16,20 @@
 // Pickled objects are not supported (similar to using `allow_pickle=False`) and
 // not all dtypes are supported.
 //
-// .npy and uncompressed .npz files can be mapped into host memory with
+// .npy files can be mapped into host memory with
 // IREE_NUMPY_NPY_LOAD_OPTION_MAP_FILE if the HAL device allocator
 // supports using such memory. On devices with discrete memory the contents will
-// be loaded into host memory and copied to the device.
+// be loaded into host memory and copied to the device. Large arrays that are
+// not mapped are read with multiple threads on platforms supporting positional
+// file reads.
 //
 // This current implementation is very basic; in the future it'd be nice to
 // support an iree_io_stream_t to allow for externalizing the file access.
 //
-// NOTE: this implementation is optimized for code size and is not intended to
-// be used in performance-sensitive situations. If you are wanting to run
-// through thousands of arrays and GB of data then you're going to want
-// something more sophisticated (delay loading with async IO, etc).
+// NOTE: this implementation is optimized for code size and only handles the
+// simple cases of large data quickly. If you are wanting to run through
+// thousands of arrays then you're going to want something more sophisticated
+// (delay loading with async IO, etc).
 //
 // TODO(benvanik): conditionally enable compression when zlib is present. For
 // now to reduce dependencies we don't support loading compressed npz files or
@@ -54,10 +56,14 @@ enum iree_numpy_npy_load_options_bits_t {
   IREE_NUMPY_NPY_LOAD_OPTION_DEFAULT = 0u,
 
   // Tries to map the file into memory and use the contents directly from the
-  // file system. Only available if the HAL device supports accessing mapped
-  // data.
-  // Like providing `mmap_mode` to `numpy.load`.
-  // May be ignored if the implementation does not support mapping.
+  // file system. Only available if the HAL device supports importing host
+  // memory and the array contents are aligned to
+  // IREE_HAL_HEAP_BUFFER_ALIGNMENT within the file (always true for the first
+  // array in a file). The mapping is copy-on-write and writes to the buffer
+  // never reach the file.
+  // Like providing `mmap_mode='c'` to `numpy.load`.
+  // Ignored if the implementation does not support mapping or the contents
+  // cannot be used in place, in which case the file is read as usual.
   IREE_NUMPY_NPY_LOAD_OPTION_MAP_FILE = 1u << 0,
 };
 typedef uint32_t iree_numpy_npy_load_options_t;
@@ -73,8 +79,9 @@ typedef uint32_t iree_numpy_npy_save_options_t;
 // in the npy file allocated from the given |device_allocator|.
 //
 // If IREE_NUMPY_NPY_LOAD_OPTION_MAP_FILE is set and the
-// |device_allocator| supports mapping then the file will be mapped into the
-// host process. Otherwise the file will be loaded into a new allocation.
+// |device_allocator| supports importing host memory then the file will be
+// mapped into the host process and the buffer will reference the mapping.
+// Otherwise the file will be loaded into a new allocation.
 //
 // Upon return the |stream| will be positioned immediately following the
 // ndarray contents, which may be end-of-stream.
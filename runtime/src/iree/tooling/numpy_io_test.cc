@@ -58,11 +58,12 @@ class NumpyIOTest : public ::testing::Test {
            std::to_string(unique_id++) + '_' + suffix;
   }
 
-  FILE* OpenInputFile(const char* name) {
+  FILE* OpenInputFile(const char* name, std::string* out_path = nullptr) {
     const struct iree_file_toc_t* file_toc = iree_numpy_npy_files_create();
     for (size_t i = 0; i < iree_numpy_npy_files_size(); ++i) {
       if (strcmp(file_toc[i].name, name) != 0) continue;
       auto file_path = GetTempFilename(name);
+      if (out_path) *out_path = file_path;
       IREE_CHECK_OK(iree_file_write_contents(
           file_path.c_str(),
           iree_make_const_byte_span(file_toc[i].data, file_toc[i].size)));
@@ -119,15 +120,16 @@ static void LoadArrayAndAssertContents(FILE* stream,
                                        std::vector<iree_hal_dim_t> shape,
                                        iree_hal_element_type_t element_type,
                                        iree_hal_encoding_type_t encoding_type,
-                                       std::vector<T> contents) {
+                                       std::vector<T> contents,
+                                       iree_numpy_npy_load_options_t options =
+                                           IREE_NUMPY_NPY_LOAD_OPTION_DEFAULT) {
   iree_hal_buffer_params_t buffer_params = {};
   buffer_params.usage = IREE_HAL_BUFFER_USAGE_TRANSFER;
   buffer_params.access = IREE_HAL_MEMORY_ACCESS_READ;
   buffer_params.type = IREE_HAL_MEMORY_TYPE_HOST_LOCAL;
   iree_hal_buffer_view_t* buffer_view = NULL;
   IREE_ASSERT_OK(iree_numpy_npy_load_ndarray(
-      stream, IREE_NUMPY_NPY_LOAD_OPTION_DEFAULT, buffer_params,
-      device_allocator, &buffer_view));
+      stream, options, buffer_params, device_allocator, &buffer_view));
   AssertBufferViewContents<T>(buffer_view, shape, element_type, encoding_type,
                               contents);
   iree_hal_buffer_view_release(buffer_view);
@@ -194,6 +196,71 @@ TEST_F(NumpyIOTest, LoadMultipleArrays) {
   fclose(stream);
 }
 
+// Tests mapping multiple arrays from a concatenated file. Only the first array
+// is aligned within the file and the others must fall back to reading. Changes
+// made to the file after loading are only visible through the mapped buffer.
+TEST_F(NumpyIOTest, MapMultipleArrays) {
+  std::string file_path;
+  FILE* stream = OpenInputFile("multiple.npy", &file_path);
+
+  iree_hal_buffer_params_t buffer_params = {};
+  buffer_params.usage = IREE_HAL_BUFFER_USAGE_TRANSFER;
+  buffer_params.access = IREE_HAL_MEMORY_ACCESS_READ;
+  buffer_params.type = IREE_HAL_MEMORY_TYPE_HOST_LOCAL;
+
+  // np.array([1.1, 2.2, 3.3], dtype=np.float32)
+  iree_hal_buffer_view_t* mapped_view = NULL;
+  IREE_ASSERT_OK(iree_numpy_npy_load_ndarray(
+      stream, IREE_NUMPY_NPY_LOAD_OPTION_MAP_FILE, buffer_params,
+      device_allocator_, &mapped_view));
+  long mapped_offset = ftell(stream) - 3 * sizeof(float);
+  AssertBufferViewContents<float>(
+      mapped_view, {3}, IREE_HAL_ELEMENT_TYPE_FLOAT_32,
+      IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR, {1.1f, 2.2f, 3.3f});
+
+  // np.array([[0, 1], [2, 3]], dtype=np.int32)
+  iree_hal_buffer_view_t* read_view = NULL;
+  IREE_ASSERT_OK(iree_numpy_npy_load_ndarray(
+      stream, IREE_NUMPY_NPY_LOAD_OPTION_MAP_FILE, buffer_params,
+      device_allocator_, &read_view));
+  long read_offset = ftell(stream) - 4 * sizeof(int32_t);
+  AssertBufferViewContents<int32_t>(
+      read_view, {2, 2}, IREE_HAL_ELEMENT_TYPE_SINT_32,
+      IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR, {0, 1, 2, 3});
+
+  // np.array(42, dtype=np.int32)
+  LoadArrayAndAssertContents<int32_t>(
+      stream, device_allocator_, {}, IREE_HAL_ELEMENT_TYPE_SINT_32,
+      IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR, {42},
+      IREE_NUMPY_NPY_LOAD_OPTION_MAP_FILE);
+
+  // Should have hit EOF.
+  ASSERT_TRUE(IsEOF(stream));
+  fclose(stream);
+
+  // Overwrite the contents of the first two arrays in the file. The mapped
+  // buffer aliases the file pages and observes the change while the buffer
+  // that was read into holds a copy of the original contents.
+  FILE* writer = fopen(file_path.c_str(), "r+b");
+  ASSERT_NE(writer, nullptr);
+  const float new_floats[3] = {4.4f, 5.5f, 6.6f};
+  const int32_t new_ints[4] = {4, 5, 6, 7};
+  ASSERT_EQ(fseek(writer, mapped_offset, SEEK_SET), 0);
+  ASSERT_EQ(fwrite(new_floats, sizeof(new_floats), 1, writer), 1);
+  ASSERT_EQ(fseek(writer, read_offset, SEEK_SET), 0);
+  ASSERT_EQ(fwrite(new_ints, sizeof(new_ints), 1, writer), 1);
+  fclose(writer);
+  AssertBufferViewContents<float>(
+      mapped_view, {3}, IREE_HAL_ELEMENT_TYPE_FLOAT_32,
+      IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR, {4.4f, 5.5f, 6.6f});
+  AssertBufferViewContents<int32_t>(
+      read_view, {2, 2}, IREE_HAL_ELEMENT_TYPE_SINT_32,
+      IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR, {0, 1, 2, 3});
+
+  iree_hal_buffer_view_release(read_view);
+  iree_hal_buffer_view_release(mapped_view);
+}
+
 // Tests loading arrays with various shapes.
 TEST_F(NumpyIOTest, ArrayShapes) {
   FILE* stream = OpenInputFile("array_shapes.npy");
@@ -400,5 +467,53 @@ TEST_F(NumpyIOTest, RoundTripArrayTypes) {
   fclose(target_stream);
 }
 
+// Tests round-tripping arrays large enough to be read in parallel, both read
+// and mapped, with an unaligned array following the first.
+TEST_F(NumpyIOTest, RoundTripLargeArrays) {
+  const iree_hal_dim_t kElementCount = 9 * 1024 * 1024 + 3;
+  std::vector<uint32_t> contents(kElementCount);
+  for (size_t i = 0; i < contents.size(); ++i) {
+    contents[i] = static_cast<uint32_t>(i * 2654435761u);
+  }
+  iree_hal_buffer_params_t buffer_params = {};
+  buffer_params.usage = IREE_HAL_BUFFER_USAGE_TRANSFER;
+  buffer_params.access = IREE_HAL_MEMORY_ACCESS_ALL;
+  buffer_params.type = IREE_HAL_MEMORY_TYPE_HOST_LOCAL;
+  iree_hal_buffer_view_t* buffer_view = NULL;
+  IREE_ASSERT_OK(iree_hal_buffer_view_allocate_buffer(
+      device_allocator_, 1, &kElementCount, IREE_HAL_ELEMENT_TYPE_UINT_32,
+      IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR, buffer_params,
+      iree_make_const_byte_span(contents.data(),
+                                contents.size() * sizeof(uint32_t)),
+      &buffer_view));
+
+  FILE* stream = OpenOutputFile("large_out.npy");
+  for (int i = 0; i < 2; ++i) {
+    IREE_ASSERT_OK(iree_numpy_npy_save_ndarray(
+        stream, IREE_NUMPY_NPY_SAVE_OPTION_DEFAULT, buffer_view,
+        iree_allocator_system()));
+  }
+  iree_hal_buffer_view_release(buffer_view);
+  fflush(stream);
+
+  for (auto options : {IREE_NUMPY_NPY_LOAD_OPTION_DEFAULT,
+                       IREE_NUMPY_NPY_LOAD_OPTION_MAP_FILE}) {
+    fseek(stream, 0, SEEK_SET);
+    for (int i = 0; i < 2; ++i) {
+      IREE_ASSERT_OK(iree_numpy_npy_load_ndarray(
+          stream, options, buffer_params, device_allocator_, &buffer_view));
+      ASSERT_EQ(iree_hal_buffer_view_shape_dim(buffer_view, 0), kElementCount);
+      std::vector<uint32_t> actual_contents(kElementCount);
+      IREE_ASSERT_OK(iree_hal_buffer_map_read(
+          iree_hal_buffer_view_buffer(buffer_view), 0, actual_contents.data(),
+          actual_contents.size() * sizeof(uint32_t)));
+      iree_hal_buffer_view_release(buffer_view);
+      ASSERT_TRUE(actual_contents == contents);
+    }
+    ASSERT_TRUE(IsEOF(stream));
+  }
+  fclose(stream);
+}
+
 }  // namespace
 }  // namespace iree
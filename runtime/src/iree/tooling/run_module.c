@@ -297,9 +297,13 @@ static iree_status_t iree_tooling_process_outputs(
       "parsing expected function outputs");
 
   // Compare expected vs actual lists and output diffs.
+  bool did_match = false;
+  if (iree_status_is_ok(status)) {
+    status = iree_tooling_compare_variant_lists(expected_list, outputs,
+                                                host_allocator, stdout,
+                                                &did_match);
+  }
   if (iree_status_is_ok(status)) {
-    bool did_match = iree_tooling_compare_variant_lists(expected_list, outputs,
-                                                        host_allocator, stdout);
     if (did_match) {
       fprintf(
           stdout,
@@ -356,6 +360,10 @@ iree_status_t iree_tooling_run_module_with_data(
     IREE_IGNORE_ERROR(
         iree_hal_allocator_statistics_fprint(stderr, device_allocator));
   }
+  if (device && FLAG_print_statistics) {
+    IREE_IGNORE_ERROR(
+        iree_hal_device_executable_statistics_fprint(stderr, device));
+  }
 
   iree_hal_allocator_release(device_allocator);
   iree_hal_device_release(device);
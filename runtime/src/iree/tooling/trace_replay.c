@@ -19,8 +19,99 @@
 #include "iree/modules/hal/module.h"
 #include "iree/tooling/device_util.h"
 #include "iree/tooling/numpy_io.h"
+#include "iree/tooling/vm_util.h"
 #include "iree/vm/bytecode/module.h"
 
+//===----------------------------------------------------------------------===//
+// iree_trace_replay_latency_histogram_t
+//===----------------------------------------------------------------------===//
+
+// Latencies below the sub-bucket count get a bucket each and every power of two
+// above that is split into IREE_TRACE_REPLAY_LATENCY_SUB_BUCKET_COUNT linear
+// sub-buckets.
+static iree_host_size_t iree_trace_replay_latency_bucket_index(
+    uint64_t latency_ns) {
+  if (latency_ns < IREE_TRACE_REPLAY_LATENCY_SUB_BUCKET_COUNT) {
+    return (iree_host_size_t)latency_ns;
+  }
+  int shift = (63 - iree_math_count_leading_zeros_u64(latency_ns)) -
+              IREE_TRACE_REPLAY_LATENCY_SUB_BUCKET_BITS;
+  iree_host_size_t sub_bucket =
+      (iree_host_size_t)(latency_ns >> shift) &
+      (IREE_TRACE_REPLAY_LATENCY_SUB_BUCKET_COUNT - 1);
+  return (shift + 1) * IREE_TRACE_REPLAY_LATENCY_SUB_BUCKET_COUNT + sub_bucket;
+}
+
+// Returns the largest latency that maps to |bucket_index|.
+static uint64_t iree_trace_replay_latency_bucket_upper_bound(
+    iree_host_size_t bucket_index) {
+  if (bucket_index < IREE_TRACE_REPLAY_LATENCY_SUB_BUCKET_COUNT) {
+    return bucket_index;
+  }
+  int shift =
+      (int)(bucket_index / IREE_TRACE_REPLAY_LATENCY_SUB_BUCKET_COUNT) - 1;
+  uint64_t sub_bucket =
+      bucket_index % IREE_TRACE_REPLAY_LATENCY_SUB_BUCKET_COUNT;
+  uint64_t lower_bound =
+      (IREE_TRACE_REPLAY_LATENCY_SUB_BUCKET_COUNT + sub_bucket) << shift;
+  return lower_bound + (((uint64_t)1 << shift) - 1);
+}
+
+void iree_trace_replay_latency_histogram_reset(
+    iree_trace_replay_latency_histogram_t* histogram) {
+  memset(histogram, 0, sizeof(*histogram));
+}
+
+void iree_trace_replay_latency_histogram_record(
+    iree_trace_replay_latency_histogram_t* histogram,
+    iree_duration_t latency_ns) {
+  if (latency_ns < 0) latency_ns = 0;
+  if (!histogram->count || latency_ns < histogram->min_ns) {
+    histogram->min_ns = latency_ns;
+  }
+  if (latency_ns > histogram->max_ns) histogram->max_ns = latency_ns;
+  ++histogram->count;
+  histogram->total_ns += latency_ns;
+  ++histogram->buckets[iree_trace_replay_latency_bucket_index(
+      (uint64_t)latency_ns)];
+}
+
+void iree_trace_replay_latency_histogram_merge(
+    iree_trace_replay_latency_histogram_t* target,
+    const iree_trace_replay_latency_histogram_t* source) {
+  if (!source->count) return;
+  if (!target->count || source->min_ns < target->min_ns) {
+    target->min_ns = source->min_ns;
+  }
+  if (source->max_ns > target->max_ns) target->max_ns = source->max_ns;
+  target->count += source->count;
+  target->total_ns += source->total_ns;
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(target->buckets); ++i) {
+    target->buckets[i] += source->buckets[i];
+  }
+}
+
+iree_duration_t iree_trace_replay_latency_histogram_percentile(
+    const iree_trace_replay_latency_histogram_t* histogram, double percentile) {
+  if (!histogram->count) return 0;
+  if (percentile <= 0.0) return histogram->min_ns;
+  if (percentile >= 100.0) return histogram->max_ns;
+  // Rank of the latency (1-based) that |percentile| falls on.
+  uint64_t rank = (uint64_t)(percentile / 100.0 * histogram->count + 0.5);
+  if (rank < 1) rank = 1;
+  uint64_t seen_count = 0;
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(histogram->buckets); ++i) {
+    seen_count += histogram->buckets[i];
+    if (seen_count >= rank) {
+      uint64_t upper_bound = iree_trace_replay_latency_bucket_upper_bound(i);
+      return upper_bound < (uint64_t)histogram->max_ns
+                 ? (iree_duration_t)upper_bound
+                 : histogram->max_ns;
+    }
+  }
+  return histogram->max_ns;
+}
+
 //===----------------------------------------------------------------------===//
 // iree_trace_replay_t
 //===----------------------------------------------------------------------===//
@@ -46,6 +137,8 @@ iree_status_t iree_trace_replay_initialize(
 
   out_replay->driver_registry = driver_registry;
 
+  out_replay->call_window = 1;
+
   iree_status_t status = iree_ok_status();
   if (iree_status_is_ok(status)) {
     status = iree_vm_list_create(iree_vm_make_undefined_type_def(), 8u,
@@ -67,6 +160,9 @@ iree_status_t iree_trace_replay_initialize(
 }
 
 void iree_trace_replay_deinitialize(iree_trace_replay_t* replay) {
+  IREE_IGNORE_ERROR(iree_trace_replay_flush(replay));
+  if (replay->loop_sync) iree_loop_sync_free(replay->loop_sync);
+
   iree_vm_list_release(replay->inputs);
   iree_vm_list_release(replay->outputs);
   iree_vm_list_release(replay->blackboard);
@@ -96,11 +192,58 @@ void iree_trace_replay_set_hal_devices_override(
 }
 
 void iree_trace_replay_reset(iree_trace_replay_t* replay) {
+  IREE_IGNORE_ERROR(iree_trace_replay_flush(replay));
   iree_vm_list_clear(replay->inputs);
   iree_vm_list_clear(replay->outputs);
   iree_vm_list_clear(replay->blackboard);
 }
 
+// Maximum number of loop operations run for a call when it is issued. The
+// begin op and a few resumes are enough to get the call to its first wait.
+#define IREE_TRACE_REPLAY_CALL_MAX_RUN_OPS 4
+
+iree_status_t iree_trace_replay_set_call_window(
+    iree_trace_replay_t* replay, iree_host_size_t max_in_flight) {
+  if (max_in_flight == 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "call window must allow at least one call");
+  }
+  IREE_RETURN_IF_ERROR(iree_trace_replay_flush(replay));
+  if (replay->loop_sync) {
+    iree_loop_sync_free(replay->loop_sync);
+    replay->loop_sync = NULL;
+  }
+  replay->call_window = 1;
+
+  // On failure the replay falls back to running calls one at a time.
+  iree_status_t status = iree_ok_status();
+  if (max_in_flight > 1) {
+    // Each in-flight call has at most a few runnable operations (begin,
+    // resume) and a wait (on its signal fence or within the program) at a
+    // time.
+    iree_loop_sync_options_t options = {
+        .max_queue_depth = max_in_flight * IREE_TRACE_REPLAY_CALL_MAX_RUN_OPS,
+        .max_wait_count = max_in_flight * 2,
+    };
+    status = iree_loop_sync_allocate(options, replay->host_allocator,
+                                     &replay->loop_sync);
+    if (iree_status_is_ok(status)) replay->call_window = max_in_flight;
+  }
+
+  // Contexts loaded while pipelining may have multiple invocations in flight.
+  // Only a flag added here is removed so that one set by the user remains.
+  const bool has_concurrent_flag = iree_all_bits_set(
+      replay->context_flags, IREE_VM_CONTEXT_FLAG_CONCURRENT);
+  if (replay->call_window > 1 && !has_concurrent_flag) {
+    replay->context_flags |= IREE_VM_CONTEXT_FLAG_CONCURRENT;
+    replay->concurrent_context = true;
+  } else if (replay->call_window == 1 && replay->concurrent_context) {
+    replay->context_flags &= ~IREE_VM_CONTEXT_FLAG_CONCURRENT;
+    replay->concurrent_context = false;
+  }
+  return status;
+}
+
 //===----------------------------------------------------------------------===//
 // type: context_load
 //===----------------------------------------------------------------------===//
@@ -1289,11 +1432,29 @@ iree_status_t iree_trace_replay_event_call_finish(iree_trace_replay_t* replay,
   return iree_ok_status();
 }
 
+// Appends the wait and signal fences expected by functions using the
+// `coarse-fences` ABI model to |input_list|. |out_signal_fence| is set to the
+// fence the call signals on completion or NULL if the function does not use
+// fences.
+static iree_status_t iree_trace_replay_append_call_fences(
+    iree_trace_replay_t* replay, iree_vm_function_t* function,
+    iree_vm_list_t* input_list, iree_hal_fence_t** out_signal_fence) {
+  *out_signal_fence = NULL;
+  if (!replay->device) return iree_ok_status();
+  return iree_tooling_append_async_fence_inputs(input_list, function,
+                                                replay->device,
+                                                /*wait_fence=*/NULL,
+                                                out_signal_fence);
+}
+
 iree_status_t iree_trace_replay_event_call(
     iree_trace_replay_t* replay, yaml_document_t* document,
     yaml_node_t* event_node, const iree_trace_replay_call_hooks_t* hooks) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  // The call may observe state produced by in-flight calls.
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(z0, iree_trace_replay_flush(replay));
+
   iree_vm_function_t function;
   iree_vm_list_t* input_list = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
@@ -1305,6 +1466,12 @@ iree_status_t iree_trace_replay_event_call(
       iree_vm_make_undefined_type_def(), /*initial_capacity=*/8,
       replay->host_allocator, &output_list);
 
+  iree_hal_fence_t* signal_fence = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_trace_replay_append_call_fences(replay, &function,
+                                                  input_list, &signal_fence);
+  }
+
   if (iree_status_is_ok(status) && hooks && hooks->before) {
     status = hooks->before(hooks->user_data, replay, document, event_node,
                            function, input_list);
@@ -1313,9 +1480,17 @@ iree_status_t iree_trace_replay_event_call(
   // Invoke the function to produce outputs.
   iree_status_t call_status = iree_ok_status();
   if (iree_status_is_ok(status)) {
+    iree_time_t issue_time_ns = iree_time_now();
     call_status = iree_vm_invoke(
         replay->context, function, IREE_VM_INVOCATION_FLAG_NONE,
         /*policy=*/NULL, input_list, output_list, replay->host_allocator);
+    if (iree_status_is_ok(call_status) && signal_fence) {
+      call_status = iree_hal_fence_wait(signal_fence, iree_infinite_timeout());
+    }
+    if (iree_status_is_ok(call_status)) {
+      iree_trace_replay_latency_histogram_record(
+          &replay->call_latency, iree_time_now() - issue_time_ns);
+    }
   }
 
   if (!iree_status_is_ok(call_status)) {
@@ -1335,6 +1510,7 @@ iree_status_t iree_trace_replay_event_call(
   // to just the call. The downside is that if the hook allocates memory it
   // won't be able to reuse what we're holding on to here.
   iree_vm_list_release(input_list);
+  iree_hal_fence_release(signal_fence);
 
   if (iree_status_is_ok(status)) {
     status = iree_trace_replay_event_call_finish(replay, document, event_node,
@@ -1346,6 +1522,231 @@ iree_status_t iree_trace_replay_event_call(
   return status;
 }
 
+//===----------------------------------------------------------------------===//
+// Pipelined calls
+//===----------------------------------------------------------------------===//
+
+// A call issued asynchronously that has not yet been retired.
+typedef struct iree_trace_replay_pending_call_t {
+  // Next call in issue order.
+  struct iree_trace_replay_pending_call_t* next;
+  // Scope the invocation and its fence wait are run in so that the call can be
+  // drained independently of the calls issued after it.
+  iree_loop_sync_scope_t scope;
+  iree_vm_async_invoke_state_t invoke_state;
+  iree_vm_function_t function;
+  iree_vm_list_t* input_list;
+  iree_vm_list_t* output_list;
+  // Fence signaled by `coarse-fences` functions on completion or NULL.
+  iree_hal_fence_t* signal_fence;
+  // Set once the VM invocation has returned (successfully or not). Any fence
+  // wait may still be pending.
+  bool invoked;
+  // Result of the invocation and any fence wait.
+  iree_status_t status;
+  iree_time_t issue_time_ns;
+  iree_time_t complete_time_ns;
+} iree_trace_replay_pending_call_t;
+
+static void iree_trace_replay_pending_call_free(
+    iree_trace_replay_t* replay, iree_trace_replay_pending_call_t* call) {
+  iree_loop_sync_scope_deinitialize(&call->scope);
+  iree_vm_list_release(call->input_list);
+  iree_vm_list_release(call->output_list);
+  iree_hal_fence_release(call->signal_fence);
+  iree_status_ignore(call->status);
+  iree_allocator_free(replay->host_allocator, call);
+}
+
+static void iree_trace_replay_pending_call_complete(
+    iree_trace_replay_pending_call_t* call, iree_status_t status) {
+  call->status = iree_status_join(call->status, status);
+  call->complete_time_ns = iree_time_now();
+}
+
+static void iree_trace_replay_pending_call_error(void* user_data,
+                                                 iree_status_t status) {
+  iree_trace_replay_pending_call_t* call =
+      (iree_trace_replay_pending_call_t*)user_data;
+  call->status = iree_status_join(call->status, status);
+}
+
+static iree_status_t iree_trace_replay_pending_call_fence_reached(
+    void* user_data, iree_loop_t loop, iree_status_t status) {
+  iree_trace_replay_pending_call_complete(
+      (iree_trace_replay_pending_call_t*)user_data, status);
+  return iree_ok_status();
+}
+
+static iree_status_t iree_trace_replay_pending_call_invoked(
+    void* user_data, iree_loop_t loop, iree_status_t status,
+    iree_vm_list_t* outputs) {
+  iree_trace_replay_pending_call_t* call =
+      (iree_trace_replay_pending_call_t*)user_data;
+  call->invoked = true;
+  // The call retains its own reference to the outputs.
+  iree_vm_list_release(outputs);
+  if (iree_status_is_ok(status) && call->signal_fence) {
+    status = iree_loop_wait_one(
+        loop, iree_hal_fence_await(call->signal_fence), iree_infinite_timeout(),
+        iree_trace_replay_pending_call_fence_reached, call);
+    if (iree_status_is_ok(status)) return iree_ok_status();
+  }
+  iree_trace_replay_pending_call_complete(call, status);
+  return iree_ok_status();
+}
+
+// Runs |call| on the loop until it has been submitted and is only waiting on
+// the device. Without this the invocation would not begin until retired and
+// the window would only ever have one call executing.
+static iree_status_t iree_trace_replay_pump_call(
+    iree_trace_replay_pending_call_t* call) {
+  iree_status_t status = iree_ok_status();
+  for (int i = 0; i < IREE_TRACE_REPLAY_CALL_MAX_RUN_OPS &&
+                  iree_status_is_ok(status) && !call->invoked &&
+                  call->scope.pending_count > 0;
+       ++i) {
+    status = iree_loop_drain(iree_loop_sync_scope(&call->scope),
+                             iree_immediate_timeout());
+  }
+  return status;
+}
+
+// Waits for the oldest in-flight call to complete and reports it to the call
+// hooks.
+static iree_status_t iree_trace_replay_retire_call(
+    iree_trace_replay_t* replay) {
+  iree_trace_replay_pending_call_t* call = replay->pending_head;
+  replay->pending_head = call->next;
+  if (!replay->pending_head) replay->pending_tail = NULL;
+  --replay->pending_count;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Draining the scope also makes progress on calls issued after this one.
+  iree_status_t status = iree_loop_drain(iree_loop_sync_scope(&call->scope),
+                                         iree_infinite_timeout());
+  iree_loop_sync_scope_deinitialize(&call->scope);
+  iree_status_t call_status = call->status;
+  call->status = iree_ok_status();
+
+  const iree_trace_replay_call_hooks_t* hooks = &replay->call_hooks;
+  if (!iree_status_is_ok(status)) {
+    iree_status_ignore(call_status);
+  } else if (!iree_status_is_ok(call_status)) {
+    if (hooks->error) {
+      status = hooks->error(hooks->user_data, replay, /*document=*/NULL,
+                            /*event_node=*/NULL, call->function, call_status);
+    } else {
+      status = call_status;
+    }
+  } else {
+    iree_trace_replay_latency_histogram_record(
+        &replay->call_latency, call->complete_time_ns - call->issue_time_ns);
+    if (hooks->after) {
+      status = hooks->after(hooks->user_data, replay, /*document=*/NULL,
+                            /*event_node=*/NULL, call->function,
+                            call->output_list);
+    }
+  }
+
+  iree_trace_replay_pending_call_free(replay, call);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+iree_status_t iree_trace_replay_flush(iree_trace_replay_t* replay) {
+  // All calls are retired even after a failure so that none are left
+  // referencing the context.
+  iree_status_t status = iree_ok_status();
+  while (replay->pending_head) {
+    status = iree_status_join(status, iree_trace_replay_retire_call(replay));
+  }
+  return status;
+}
+
+// Issues a `call` event without waiting for it to complete. The call must not
+// have results that are consumed by later events as they will not be stored.
+static iree_status_t iree_trace_replay_event_call_pipelined(
+    iree_trace_replay_t* replay, yaml_document_t* document,
+    yaml_node_t* event_node) {
+  // Make room in the window for the new call.
+  if (replay->pending_count >= replay->call_window) {
+    IREE_RETURN_IF_ERROR(iree_trace_replay_retire_call(replay));
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_trace_replay_pending_call_t* call = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(replay->host_allocator, sizeof(*call),
+                                (void**)&call));
+  memset(call, 0, sizeof(*call));
+
+  iree_status_t status = iree_trace_replay_event_call_prepare(
+      replay, document, event_node, &call->function, &call->input_list);
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_list_create(iree_vm_make_undefined_type_def(),
+                                 /*initial_capacity=*/8, replay->host_allocator,
+                                 &call->output_list);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_trace_replay_append_call_fences(
+        replay, &call->function, call->input_list, &call->signal_fence);
+  }
+
+  const iree_trace_replay_call_hooks_t* hooks = &replay->call_hooks;
+  if (iree_status_is_ok(status) && hooks->before) {
+    status = hooks->before(hooks->user_data, replay, document, event_node,
+                           call->function, call->input_list);
+  }
+
+  if (iree_status_is_ok(status)) {
+    iree_loop_sync_scope_initialize(replay->loop_sync,
+                                    iree_trace_replay_pending_call_error, call,
+                                    &call->scope);
+    call->issue_time_ns = iree_time_now();
+    status = iree_vm_async_invoke(
+        iree_loop_sync_scope(&call->scope), &call->invoke_state,
+        replay->context, call->function, IREE_VM_INVOCATION_FLAG_NONE,
+        /*policy=*/NULL, call->input_list, call->output_list,
+        replay->host_allocator, iree_trace_replay_pending_call_invoked, call);
+  }
+
+  if (!iree_status_is_ok(status)) {
+    iree_trace_replay_pending_call_free(replay, call);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  // Track the call before running it so that it is always retired (and its
+  // scope drained) even if pumping fails.
+  if (replay->pending_tail) {
+    replay->pending_tail->next = call;
+  } else {
+    replay->pending_head = call;
+  }
+  replay->pending_tail = call;
+  ++replay->pending_count;
+  status = iree_trace_replay_pump_call(call);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Returns true if the `call` |event_node| can be pipelined. Calls storing their
+// results must complete before the next event may observe them.
+static bool iree_trace_replay_event_call_can_pipeline(
+    iree_trace_replay_t* replay, yaml_document_t* document,
+    yaml_node_t* event_node) {
+  if (replay->call_window <= 1) return false;
+  yaml_node_t* results_node = NULL;
+  iree_status_t status = iree_yaml_mapping_try_find(
+      document, event_node, IREE_SV("results"), &results_node);
+  if (!iree_status_is_ok(status)) {
+    iree_status_ignore(status);
+    return false;
+  }
+  return results_node == NULL;
+}
+
 //===----------------------------------------------------------------------===//
 // Blackboard management
 //===----------------------------------------------------------------------===//
@@ -1464,7 +1865,7 @@ static iree_status_t iree_trace_replay_event_numpy_load(
       }
       iree_hal_buffer_view_t* buffer_view = NULL;
       status = iree_numpy_npy_load_ndarray(
-          file, IREE_NUMPY_NPY_LOAD_OPTION_DEFAULT, buffer_params,
+          file, IREE_NUMPY_NPY_LOAD_OPTION_MAP_FILE, buffer_params,
           device_allocator, &buffer_view);
       if (!iree_status_is_ok(status)) break;
 
@@ -1577,6 +1978,15 @@ iree_status_t iree_trace_replay_event(iree_trace_replay_t* replay,
   yaml_node_t* type_node = NULL;
   IREE_RETURN_IF_ERROR(iree_yaml_mapping_find(document, event_node,
                                               IREE_SV("type"), &type_node));
+  if (iree_yaml_string_equal(type_node, IREE_SV("call")) &&
+      iree_trace_replay_event_call_can_pipeline(replay, document,
+                                                event_node)) {
+    return iree_trace_replay_event_call_pipelined(replay, document,
+                                                  event_node);
+  }
+
+  // All other events observe or modify state that in-flight calls may use.
+  IREE_RETURN_IF_ERROR(iree_trace_replay_flush(replay));
   if (iree_yaml_string_equal(type_node, IREE_SV("context_load"))) {
     return iree_trace_replay_event_context_load(replay, document, event_node);
   } else if (iree_yaml_string_equal(type_node, IREE_SV("module_load"))) {
@@ -8,6 +8,7 @@
 #define IREE_TOOLING_TRACE_REPLAY_H_
 
 #include "iree/base/api.h"
+#include "iree/base/loop_sync.h"
 #include "iree/hal/api.h"
 #include "iree/tooling/yaml_util.h"
 #include "iree/vm/api.h"
@@ -18,6 +19,58 @@ extern "C" {
 
 typedef struct iree_trace_replay_t iree_trace_replay_t;
 
+//===----------------------------------------------------------------------===//
+// iree_trace_replay_latency_histogram_t
+//===----------------------------------------------------------------------===//
+
+// Number of linear sub-buckets each power-of-two latency range is split into
+// as log2. 3 bits keeps the relative error of any reported percentile under
+// 12.5%.
+#define IREE_TRACE_REPLAY_LATENCY_SUB_BUCKET_BITS 3
+#define IREE_TRACE_REPLAY_LATENCY_SUB_BUCKET_COUNT \
+  (1 << IREE_TRACE_REPLAY_LATENCY_SUB_BUCKET_BITS)
+#define IREE_TRACE_REPLAY_LATENCY_BUCKET_COUNT \
+  (64 * IREE_TRACE_REPLAY_LATENCY_SUB_BUCKET_COUNT)
+
+// Log-linear histogram of call latencies in nanoseconds.
+// Histograms from multiple replays (such as one per thread) can be merged to
+// produce aggregate percentiles.
+typedef struct iree_trace_replay_latency_histogram_t {
+  // Total number of latencies recorded.
+  uint64_t count;
+  // Sum of all latencies recorded.
+  iree_duration_t total_ns;
+  // Minimum and maximum latency recorded; 0 if none recorded.
+  iree_duration_t min_ns;
+  iree_duration_t max_ns;
+  // Number of latencies recorded per bucket.
+  uint64_t buckets[IREE_TRACE_REPLAY_LATENCY_BUCKET_COUNT];
+} iree_trace_replay_latency_histogram_t;
+
+// Resets |histogram| to having no recorded latencies.
+void iree_trace_replay_latency_histogram_reset(
+    iree_trace_replay_latency_histogram_t* histogram);
+
+// Records a single |latency_ns| in |histogram|.
+void iree_trace_replay_latency_histogram_record(
+    iree_trace_replay_latency_histogram_t* histogram,
+    iree_duration_t latency_ns);
+
+// Merges all latencies recorded in |source| into |target|.
+void iree_trace_replay_latency_histogram_merge(
+    iree_trace_replay_latency_histogram_t* target,
+    const iree_trace_replay_latency_histogram_t* source);
+
+// Returns the latency at or below which |percentile| (0-100) of all recorded
+// latencies fall. The result is the upper bound of the containing bucket
+// clamped to the maximum recorded latency.
+iree_duration_t iree_trace_replay_latency_histogram_percentile(
+    const iree_trace_replay_latency_histogram_t* histogram, double percentile);
+
+//===----------------------------------------------------------------------===//
+// iree_trace_replay_t
+//===----------------------------------------------------------------------===//
+
 enum iree_trace_replay_flag_bits_e {
   IREE_TRACE_REPLAY_FLAG_NONE = 0u,
   // Prints statistics on replay shutdown.
@@ -45,13 +98,17 @@ typedef struct iree_trace_replay_call_hooks_t {
                           iree_vm_function_t function,
                           iree_vm_list_t* input_list);
   // Issued after the call completes successfully with the call outputs.
+  // When the call was pipelined (see iree_trace_replay_set_call_window) the
+  // trace document is no longer available and |document| and |event_node| are
+  // NULL.
   iree_status_t (*after)(void* user_data, iree_trace_replay_t* replay,
                          yaml_document_t* document, yaml_node_t* event_node,
                          iree_vm_function_t function,
                          iree_vm_list_t* output_list);
   // Issued only when the call fails and not the replay operation itself.
   // |status| is as returned from the call and ownership is transferred to the
-  // hook.
+  // hook. As with |after| |document| and |event_node| are NULL for pipelined
+  // calls.
   iree_status_t (*error)(void* user_data, iree_trace_replay_t* replay,
                          yaml_document_t* document, yaml_node_t* event_node,
                          iree_vm_function_t function, iree_status_t status);
@@ -98,6 +155,24 @@ typedef struct iree_trace_replay_t {
 
   // Optional call hooks allowing reflection of calls and their I/O.
   iree_trace_replay_call_hooks_t call_hooks;
+
+  // Maximum number of calls that may be in flight at once. 1 runs each call to
+  // completion before processing the next event.
+  iree_host_size_t call_window;
+  // Loop the pipelined calls are issued on, only allocated when the call
+  // window is larger than 1.
+  iree_loop_sync_t* loop_sync;
+  // True if IREE_VM_CONTEXT_FLAG_CONCURRENT was added to |context_flags| by
+  // iree_trace_replay_set_call_window and must be removed when reset to 1.
+  bool concurrent_context;
+  // In-flight calls in issue order.
+  struct iree_trace_replay_pending_call_t* pending_head;
+  struct iree_trace_replay_pending_call_t* pending_tail;
+  iree_host_size_t pending_count;
+
+  // Latency of every call completed by the replay measured from when it was
+  // issued to when its results (and signal fence, if any) were available.
+  iree_trace_replay_latency_histogram_t call_latency;
 } iree_trace_replay_t;
 
 // Initializes a trace replay context.
@@ -121,8 +196,28 @@ void iree_trace_replay_set_hal_devices_override(
     const iree_string_view_t* device_uris);
 
 // Resets replay input/output/blackboard state.
+// Any in-flight calls are completed first and their errors are ignored.
 void iree_trace_replay_reset(iree_trace_replay_t* replay);
 
+// Allows up to |max_in_flight| calls to be issued before the oldest must
+// complete. Calls are issued asynchronously with iree_vm_async_invoke and
+// retired in order; calls whose `results` feed later events and all non-call
+// events wait for the in-flight calls to complete first so the trace observes
+// the same state as when run sequentially.
+//
+// Functions using the `coarse-fences` ABI model are considered complete when
+// their signal fence is reached.
+//
+// Windows larger than 1 interleave invocations within the same context and
+// must be set before the first `context_load` event. They add
+// IREE_VM_CONTEXT_FLAG_CONCURRENT to the context flags until the window is
+// reset to 1. On failure the window is left at 1.
+iree_status_t iree_trace_replay_set_call_window(iree_trace_replay_t* replay,
+                                                iree_host_size_t max_in_flight);
+
+// Waits for all in-flight calls to complete and returns the first error.
+iree_status_t iree_trace_replay_flush(iree_trace_replay_t* replay);
+
 // Replays the given |event_node| against the replay context.
 // Automatically switches between the default iree_trace_replay_event_* methods.
 iree_status_t iree_trace_replay_event(iree_trace_replay_t* replay,
@@ -0,0 +1,132 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/tooling/trace_replay.h"
+
+#include "iree/testing/gtest.h"
+
+namespace {
+
+TEST(LatencyHistogram, Empty) {
+  iree_trace_replay_latency_histogram_t histogram;
+  iree_trace_replay_latency_histogram_reset(&histogram);
+  EXPECT_EQ(0u, histogram.count);
+  EXPECT_EQ(0, histogram.min_ns);
+  EXPECT_EQ(0, histogram.max_ns);
+  EXPECT_EQ(0, iree_trace_replay_latency_histogram_percentile(&histogram, 0));
+  EXPECT_EQ(0, iree_trace_replay_latency_histogram_percentile(&histogram, 50));
+  EXPECT_EQ(0, iree_trace_replay_latency_histogram_percentile(&histogram, 100));
+}
+
+TEST(LatencyHistogram, Statistics) {
+  iree_trace_replay_latency_histogram_t histogram;
+  iree_trace_replay_latency_histogram_reset(&histogram);
+  iree_trace_replay_latency_histogram_record(&histogram, 300);
+  iree_trace_replay_latency_histogram_record(&histogram, 100);
+  iree_trace_replay_latency_histogram_record(&histogram, 200);
+  // Negative latencies (from clock adjustments) are recorded as 0.
+  iree_trace_replay_latency_histogram_record(&histogram, -5);
+  EXPECT_EQ(4u, histogram.count);
+  EXPECT_EQ(600, histogram.total_ns);
+  EXPECT_EQ(0, histogram.min_ns);
+  EXPECT_EQ(300, histogram.max_ns);
+  EXPECT_EQ(0, iree_trace_replay_latency_histogram_percentile(&histogram, 0));
+  EXPECT_EQ(300,
+            iree_trace_replay_latency_histogram_percentile(&histogram, 100));
+}
+
+// Latencies below the sub-bucket count each have their own bucket and are
+// reported exactly.
+TEST(LatencyHistogram, SmallValuesExact) {
+  iree_trace_replay_latency_histogram_t histogram;
+  iree_trace_replay_latency_histogram_reset(&histogram);
+  for (int i = 0; i < IREE_TRACE_REPLAY_LATENCY_SUB_BUCKET_COUNT; ++i) {
+    iree_trace_replay_latency_histogram_record(&histogram, i);
+  }
+  for (int i = 1; i <= IREE_TRACE_REPLAY_LATENCY_SUB_BUCKET_COUNT; ++i) {
+    double percentile = 100.0 * i / IREE_TRACE_REPLAY_LATENCY_SUB_BUCKET_COUNT;
+    EXPECT_EQ(i - 1, iree_trace_replay_latency_histogram_percentile(
+                         &histogram, percentile))
+        << "percentile " << percentile;
+  }
+}
+
+// Larger latencies are reported as the upper bound of their bucket: never
+// below the true value and within the advertised relative error.
+TEST(LatencyHistogram, LargeValuesBoundedError) {
+  iree_trace_replay_latency_histogram_t histogram;
+  iree_trace_replay_latency_histogram_reset(&histogram);
+  static constexpr int kCount = 1000;
+  static constexpr iree_duration_t kStep = 1237;
+  for (int i = 1; i <= kCount; ++i) {
+    iree_trace_replay_latency_histogram_record(&histogram, i * kStep);
+  }
+  const double max_error =
+      1.0 / (double)IREE_TRACE_REPLAY_LATENCY_SUB_BUCKET_COUNT;
+  for (double percentile : {1.0, 10.0, 25.0, 50.0, 75.0, 90.0, 99.0, 99.9}) {
+    iree_duration_t expected = (iree_duration_t)(percentile * kCount / 100.0 +
+                                                 0.5) *
+                               kStep;
+    iree_duration_t actual =
+        iree_trace_replay_latency_histogram_percentile(&histogram, percentile);
+    EXPECT_GE(actual, expected) << "percentile " << percentile;
+    EXPECT_LE(actual, expected + (iree_duration_t)(expected * max_error))
+        << "percentile " << percentile;
+  }
+}
+
+// Percentiles are never reported above the largest latency recorded even when
+// the bucket it falls in extends further.
+TEST(LatencyHistogram, ClampedToMax) {
+  iree_trace_replay_latency_histogram_t histogram;
+  iree_trace_replay_latency_histogram_reset(&histogram);
+  iree_trace_replay_latency_histogram_record(&histogram, 1000001);
+  EXPECT_EQ(1000001,
+            iree_trace_replay_latency_histogram_percentile(&histogram, 50));
+  EXPECT_EQ(1000001,
+            iree_trace_replay_latency_histogram_percentile(&histogram, 99));
+}
+
+// Merging histograms is equivalent to recording all latencies in one.
+TEST(LatencyHistogram, Merge) {
+  iree_trace_replay_latency_histogram_t combined;
+  iree_trace_replay_latency_histogram_reset(&combined);
+  iree_trace_replay_latency_histogram_t lhs;
+  iree_trace_replay_latency_histogram_reset(&lhs);
+  iree_trace_replay_latency_histogram_t rhs;
+  iree_trace_replay_latency_histogram_reset(&rhs);
+  for (int i = 0; i < 100; ++i) {
+    iree_duration_t latency_ns = 1000 + i * 97;
+    iree_trace_replay_latency_histogram_record(&combined, latency_ns);
+    iree_trace_replay_latency_histogram_record(i % 3 ? &lhs : &rhs,
+                                               latency_ns);
+  }
+
+  // Merging into an empty histogram takes the minimum of the source.
+  iree_trace_replay_latency_histogram_t merged;
+  iree_trace_replay_latency_histogram_reset(&merged);
+  iree_trace_replay_latency_histogram_merge(&merged, &lhs);
+  iree_trace_replay_latency_histogram_merge(&merged, &rhs);
+  EXPECT_EQ(combined.count, merged.count);
+  EXPECT_EQ(combined.total_ns, merged.total_ns);
+  EXPECT_EQ(combined.min_ns, merged.min_ns);
+  EXPECT_EQ(combined.max_ns, merged.max_ns);
+  for (double percentile : {0.0, 10.0, 50.0, 90.0, 99.0, 100.0}) {
+    EXPECT_EQ(
+        iree_trace_replay_latency_histogram_percentile(&combined, percentile),
+        iree_trace_replay_latency_histogram_percentile(&merged, percentile))
+        << "percentile " << percentile;
+  }
+
+  // Merging an empty histogram has no effect.
+  iree_trace_replay_latency_histogram_t empty;
+  iree_trace_replay_latency_histogram_reset(&empty);
+  iree_trace_replay_latency_histogram_merge(&merged, &empty);
+  EXPECT_EQ(combined.count, merged.count);
+  EXPECT_EQ(combined.min_ns, merged.min_ns);
+}
+
+}  // namespace
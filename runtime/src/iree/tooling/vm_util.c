@@ -51,7 +51,7 @@ static iree_status_t iree_tooling_load_ndarrays_from_file(
   while (iree_status_is_ok(status) && !iree_file_is_at(file, file_length)) {
     iree_hal_buffer_view_t* buffer_view = NULL;
     status = iree_numpy_npy_load_ndarray(
-        file, IREE_NUMPY_NPY_LOAD_OPTION_DEFAULT, buffer_params,
+        file, IREE_NUMPY_NPY_LOAD_OPTION_MAP_FILE, buffer_params,
         device_allocator, &buffer_view);
     if (iree_status_is_ok(status)) {
       iree_vm_ref_t buffer_view_ref =
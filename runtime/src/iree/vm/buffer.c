@@ -72,6 +72,8 @@ IREE_API_EXPORT void iree_vm_buffer_initialize(iree_vm_buffer_access_t access,
   out_buffer->access = access;
   out_buffer->data = data;
   out_buffer->allocator = allocator;
+  out_buffer->origin_digest = NULL;
+  out_buffer->origin_offset = 0;
 }
 
 IREE_API_EXPORT void iree_vm_buffer_deinitialize(iree_vm_buffer_t* buffer) {
@@ -37,6 +37,13 @@ enum iree_vm_buffer_access_bits_t {
 };
 typedef uint32_t iree_vm_buffer_access_t;
 
+// Digest of the contents of a module. Modules with equal digests have equal
+// contents regardless of where or how many times they have been loaded.
+typedef struct iree_vm_module_digest_t {
+  uint64_t lo;
+  uint64_t hi;
+} iree_vm_module_digest_t;
+
 // A simple byte range with options for ownership and wrapping semantics.
 // The access flags indicate what access is allowed from the VM.
 // Buffers are fixed-length and may only contain primitive values.
@@ -63,6 +70,15 @@ typedef struct iree_vm_buffer_t {
   iree_vm_buffer_access_t access;
   iree_byte_span_t data;
   iree_allocator_t allocator;
+
+  // Digest of the module the buffer data is stored in, if known. Only set on
+  // buffers with IREE_VM_BUFFER_ACCESS_ORIGIN_MODULE by modules that compute a
+  // digest and NULL otherwise. Together with |origin_offset| this identifies
+  // the buffer contents without having to read them.
+  const iree_vm_module_digest_t* origin_digest;
+  // Byte offset of the buffer data within the module identified by
+  // |origin_digest|.
+  iree_host_size_t origin_offset;
 } iree_vm_buffer_t;
 
 // Initializes a buffer in-place with the given byte contents.
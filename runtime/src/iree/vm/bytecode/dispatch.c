@@ -85,10 +85,7 @@ static void iree_vm_bytecode_stack_frame_cleanup(iree_vm_stack_frame_t* frame) {
       (iree_vm_bytecode_frame_storage_t*)iree_vm_stack_frame_storage(frame);
   iree_vm_ref_t* refs = (iree_vm_ref_t*)((uintptr_t)stack_storage +
                                          stack_storage->ref_register_offset);
-  for (uint16_t i = 0; i < stack_storage->ref_register_count; ++i) {
-    iree_vm_ref_t* ref = &refs[i];
-    if (ref->ptr) iree_vm_ref_release(ref);
-  }
+  iree_vm_ref_release_all(stack_storage->ref_register_count, refs);
 }
 
 static iree_status_t iree_vm_bytecode_function_enter(
@@ -1296,7 +1293,8 @@ static iree_status_t iree_vm_bytecode_dispatch(
       IREE_RETURN_IF_ERROR(iree_vm_list_get_ref_retain(list, index, result));
       if (result->type != IREE_VM_REF_TYPE_NULL &&
           (iree_vm_type_def_is_value(type_def) ||
-           result->type != iree_vm_type_def_as_ref(type_def))) {
+           !iree_vm_ref_type_equal(result->type,
+                                   iree_vm_type_def_as_ref(type_def)))) {
         // Type mismatch; put null in the register instead.
         // TODO(benvanik): return an error here and make a query type method?
         iree_vm_ref_release(result);
@@ -688,6 +688,9 @@ static iree_status_t iree_vm_bytecode_module_alloc_state(
     iree_vm_buffer_t* ref = &state->rodata_ref_table[i];
     iree_vm_buffer_initialize(IREE_VM_BUFFER_ACCESS_ORIGIN_MODULE, byte_span,
                               iree_allocator_null(), ref);
+    ref->origin_digest = &module->digest;
+    ref->origin_offset =
+        (iree_host_size_t)(byte_span.data - module->archive_contents.data);
   }
 
   *out_module_state = (iree_vm_module_state_t*)state;
@@ -704,9 +707,7 @@ static void iree_vm_bytecode_module_free_state(
       (iree_vm_bytecode_module_state_t*)module_state;
 
   // Release remaining global references.
-  for (int i = 0; i < state->global_ref_count; ++i) {
-    iree_vm_ref_release(&state->global_ref_table[i]);
-  }
+  iree_vm_ref_release_all(state->global_ref_count, state->global_ref_table);
 
   // Ensure all rodata references are unused and deinitialized.
   for (int i = 0; i < state->rodata_ref_count; ++i) {
@@ -821,6 +822,53 @@ static iree_status_t iree_vm_bytecode_module_resume_call(
   return iree_vm_bytecode_dispatch_resume(stack, module, call_results);  // tail
 }
 
+// The two halves of the digest are computed with independent multiplicative
+// hashes over 8-byte words. The dependency chains of the two lanes overlap in
+// the pipeline so that hashing runs close to memory bandwidth.
+#define IREE_VM_BYTECODE_DIGEST_PRIME_LO 0x9E3779B97F4A7C15ull
+#define IREE_VM_BYTECODE_DIGEST_PRIME_HI 0xC2B2AE3D27D4EB4Full
+
+static inline uint64_t iree_vm_bytecode_digest_mix(uint64_t hash, uint64_t word,
+                                                   uint64_t prime) {
+  hash = (hash ^ word) * prime;
+  return hash ^ (hash >> 32);
+}
+
+// Computes the digest of the module |archive_contents|. This reads the entire
+// archive once per module load so that rodata can later be identified by
+// digest and offset without being read again.
+static iree_vm_module_digest_t iree_vm_bytecode_module_calculate_digest(
+    iree_const_byte_span_t archive_contents) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, archive_contents.data_length);
+  iree_vm_module_digest_t digest = {
+      .lo = 0xCBF29CE484222325ull,
+      .hi = 0x84222325CBF29CE4ull,
+  };
+  const uint8_t* bytes = archive_contents.data;
+  iree_host_size_t word_count = archive_contents.data_length / sizeof(uint64_t);
+  for (iree_host_size_t i = 0; i < word_count; ++i) {
+    uint64_t word = 0;
+    memcpy(&word, bytes + i * sizeof(uint64_t), sizeof(word));
+    digest.lo = iree_vm_bytecode_digest_mix(digest.lo, word,
+                                            IREE_VM_BYTECODE_DIGEST_PRIME_LO);
+    digest.hi = iree_vm_bytecode_digest_mix(digest.hi, word,
+                                            IREE_VM_BYTECODE_DIGEST_PRIME_HI);
+  }
+  // The trailing bytes and the total length are mixed in as two more words.
+  uint64_t tail_words[2] = {0, (uint64_t)archive_contents.data_length};
+  memcpy(&tail_words[0], bytes + word_count * sizeof(uint64_t),
+         archive_contents.data_length % sizeof(uint64_t));
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(tail_words); ++i) {
+    digest.lo = iree_vm_bytecode_digest_mix(digest.lo, tail_words[i],
+                                            IREE_VM_BYTECODE_DIGEST_PRIME_LO);
+    digest.hi = iree_vm_bytecode_digest_mix(digest.hi, tail_words[i],
+                                            IREE_VM_BYTECODE_DIGEST_PRIME_HI);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return digest;
+}
+
 IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
     iree_vm_instance_t* instance, iree_const_byte_span_t archive_contents,
     iree_allocator_t archive_allocator, iree_allocator_t allocator,
@@ -881,6 +929,7 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
   module->archive_allocator = archive_allocator;
   module->archive_rodata_offset = archive_rodata_offset;
   module->def = module_def;
+  module->digest = iree_vm_bytecode_module_calculate_digest(archive_contents);
 
   module->type_count = iree_vm_TypeDef_vec_len(type_defs);
   iree_status_t resolve_status = iree_vm_bytecode_module_resolve_types(
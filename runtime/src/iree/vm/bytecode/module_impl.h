@@ -49,6 +49,10 @@ typedef struct iree_vm_bytecode_module_t {
   // Loaded FlatBuffer module pointing into the archive contents.
   iree_vm_BytecodeModuleDef_table_t def;
 
+  // Digest of the archive contents referenced by rodata buffers so that users
+  // can identify their contents across module instances.
+  iree_vm_module_digest_t digest;
+
   // Type table mapping module type IDs to registered VM types.
   iree_host_size_t type_count;
   iree_vm_type_def_t type_table[];
@@ -228,4 +228,61 @@ TEST_F(VMBytecodeModuleTest, FuncIO600) {
               IsOkAndHolds(Eq(MakeNullRefList(600))));
 }
 
+// Rodata buffers carry the digest of the module contents and their offset
+// within them so that the same data is identifiable in any loaded copy of the
+// module.
+TEST_F(VMBytecodeModuleTest, RodataOriginDigest) {
+  IREE_ASSERT_OK_AND_ASSIGN(
+      auto outputs, RunFunction("RodataBuffer", std::vector<iree_vm_ref_t>()));
+  ASSERT_EQ(outputs.size(), 1);
+  iree_vm_buffer_t* buffer = iree_vm_buffer_deref(outputs[0]);
+  ASSERT_NE(buffer, nullptr);
+  ASSERT_NE(buffer->origin_digest, nullptr);
+
+  // Load a second copy of the same module contents at another address.
+  const auto* module_file_toc = iree_vm_bytecode_module_test_module_create();
+  std::vector<uint8_t> module_data(
+      reinterpret_cast<const uint8_t*>(module_file_toc->data),
+      reinterpret_cast<const uint8_t*>(module_file_toc->data) +
+          module_file_toc->size);
+  iree_vm_module_t* module_copy = nullptr;
+  IREE_ASSERT_OK(iree_vm_bytecode_module_create(
+      instance_,
+      iree_const_byte_span_t{module_data.data(), module_data.size()},
+      iree_allocator_null(), iree_allocator_system(), &module_copy));
+  iree_vm_context_t* context_copy = nullptr;
+  IREE_ASSERT_OK(iree_vm_context_create_with_modules(
+      instance_, IREE_VM_CONTEXT_FLAG_NONE, 1, &module_copy,
+      iree_allocator_system(), &context_copy));
+  iree_vm_function_t function;
+  IREE_ASSERT_OK(iree_vm_module_lookup_function_by_name(
+      module_copy, IREE_VM_FUNCTION_LINKAGE_EXPORT,
+      iree_make_cstring_view("RodataBuffer"), &function));
+  ref<iree_vm_list_t> output_list;
+  IREE_ASSERT_OK(iree_vm_list_create(iree_vm_make_undefined_type_def(), 1,
+                                     iree_allocator_system(), &output_list));
+  IREE_ASSERT_OK(iree_vm_invoke(context_copy, function,
+                                IREE_VM_INVOCATION_FLAG_NONE,
+                                /*policy=*/nullptr, /*inputs=*/nullptr,
+                                output_list.get(), iree_allocator_system()));
+  iree_vm_ref_t buffer_copy_ref = iree_vm_ref_null();
+  IREE_ASSERT_OK(
+      iree_vm_list_get_ref_assign(output_list.get(), 0, &buffer_copy_ref));
+  iree_vm_buffer_t* buffer_copy = iree_vm_buffer_deref(buffer_copy_ref);
+  ASSERT_NE(buffer_copy, nullptr);
+
+  EXPECT_NE(buffer_copy->data.data, buffer->data.data);
+  ASSERT_NE(buffer_copy->origin_digest, nullptr);
+  EXPECT_EQ(buffer_copy->origin_digest->lo, buffer->origin_digest->lo);
+  EXPECT_EQ(buffer_copy->origin_digest->hi, buffer->origin_digest->hi);
+  EXPECT_EQ(buffer_copy->origin_offset, buffer->origin_offset);
+  EXPECT_EQ(buffer->data.data - buffer->origin_offset,
+            reinterpret_cast<const uint8_t*>(module_file_toc->data));
+
+  output_list.reset();
+  iree_vm_context_release(context_copy);
+  iree_vm_module_release(module_copy);
+  for (auto& output : outputs) iree_vm_ref_release(&output);
+}
+
 }  // namespace
@@ -17,6 +17,14 @@ vm.module @bytecode_module_test {
     vm.return %7, %6, %5, %4, %3, %2, %1, %0 : i32, i32, i32, i32, i32, i32, i32, i32
   }
 
+  // Tests rodata buffers referencing the module contents.
+  vm.rodata private @Rodata dense<[1, 2, 3, 4]> : tensor<4xi32>
+  vm.export @RodataBuffer
+  vm.func @RodataBuffer() -> !vm.buffer {
+    %0 = vm.const.ref.rodata @Rodata : !vm.buffer
+    vm.return %0 : !vm.buffer
+  }
+
   // Tests boundary conditions on stack allocation of arguments and results:
   // several hundred should trip heap allocation. This looks silly but some ML
   // frameworks like to generate functions with thousands of arguments and
@@ -121,7 +121,8 @@ iree_vm_instance_register_type(iree_vm_instance_t* instance,
                             (1 << IREE_VM_REF_TYPE_TAG_BITS));
   }
 
-  if (descriptor->offsetof_counter & ~IREE_VM_REF_TYPE_TAG_BIT_MASK) {
+  if (descriptor->offsetof_counter &
+      ~IREE_VM_REF_TYPE_COUNTER_OFFSET_BIT_MASK) {
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                             "types must have offsets within the first few "
                             "words of their structures");
@@ -138,8 +139,7 @@ iree_vm_instance_register_type(iree_vm_instance_t* instance,
       // register/unregister set.
       ++type->registration_count;
       iree_slim_mutex_unlock(&instance->type_mutex);
-      *out_registration = (iree_vm_ref_type_t)descriptor |
-                          (iree_vm_ref_type_t)descriptor->offsetof_counter;
+      *out_registration = iree_vm_make_ref_type(descriptor);
       return iree_ok_status();
     }
   }
@@ -163,8 +163,7 @@ iree_vm_instance_register_type(iree_vm_instance_t* instance,
 
   iree_slim_mutex_unlock(&instance->type_mutex);
 
-  *out_registration = (iree_vm_ref_type_t)descriptor |
-                      (iree_vm_ref_type_t)descriptor->offsetof_counter;
+  *out_registration = iree_vm_make_ref_type(descriptor);
   return iree_ok_status();
 }
 
@@ -65,6 +65,19 @@ struct iree_vm_list_t {
 
 IREE_VM_DEFINE_TYPE_ADAPTERS(iree_vm_list, iree_vm_list_t);
 
+// Returns OUT_OF_RANGE if [offset, offset + count) is not within the list.
+static iree_status_t iree_vm_list_check_range(const iree_vm_list_t* list,
+                                              iree_host_size_t offset,
+                                              iree_host_size_t count) {
+  if (offset > list->count || count > list->count - offset) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "range [%" PRIhsz ", %" PRIhsz
+                            ") out of bounds of list with size %" PRIhsz,
+                            offset, offset + count, list->count);
+  }
+  return iree_ok_status();
+}
+
 static void iree_vm_list_retain_range(iree_vm_list_t* list,
                                       iree_host_size_t offset,
                                       iree_host_size_t length) {
@@ -103,9 +116,7 @@ static void iree_vm_list_reset_range(iree_vm_list_t* list,
     }
     case IREE_VM_LIST_STORAGE_MODE_REF: {
       iree_vm_ref_t* ref_storage = (iree_vm_ref_t*)list->storage;
-      for (iree_host_size_t i = offset; i < offset + length; ++i) {
-        iree_vm_ref_release(&ref_storage[i]);
-      }
+      iree_vm_ref_release_all(length, &ref_storage[offset]);
       break;
     }
     case IREE_VM_LIST_STORAGE_MODE_VARIANT: {
@@ -780,6 +791,23 @@ iree_vm_list_push_value(iree_vm_list_t* list, const iree_vm_value_t* value) {
   return iree_vm_list_set_value(list, i, value);
 }
 
+IREE_API_EXPORT iree_status_t iree_vm_list_map_values(
+    iree_vm_list_t* list, iree_host_size_t offset, iree_host_size_t count,
+    iree_byte_span_t* out_span) {
+  IREE_ASSERT_ARGUMENT(list);
+  IREE_ASSERT_ARGUMENT(out_span);
+  *out_span = iree_make_byte_span(NULL, 0);
+  if (list->storage_mode != IREE_VM_LIST_STORAGE_MODE_VALUE) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "list does not store primitive values");
+  }
+  IREE_RETURN_IF_ERROR(iree_vm_list_check_range(list, offset, count));
+  *out_span = iree_make_byte_span(
+      (uint8_t*)list->storage + offset * list->element_size,
+      count * list->element_size);
+  return iree_ok_status();
+}
+
 IREE_API_EXPORT void* iree_vm_list_get_ref_deref(const iree_vm_list_t* list,
                                                  iree_host_size_t i,
                                                  iree_vm_ref_type_t type) {
@@ -842,6 +870,35 @@ IREE_API_EXPORT iree_status_t iree_vm_list_get_ref_retain(
                                                out_value);
 }
 
+IREE_API_EXPORT iree_status_t iree_vm_list_get_ref_move(
+    iree_vm_list_t* list, iree_host_size_t i, iree_vm_ref_t* out_value) {
+  if (i >= list->count) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "index %zu out of bounds (%zu)", i, list->count);
+  }
+  uintptr_t element_ptr = (uintptr_t)list->storage + i * list->element_size;
+  switch (list->storage_mode) {
+    case IREE_VM_LIST_STORAGE_MODE_REF: {
+      iree_vm_ref_move((iree_vm_ref_t*)element_ptr, out_value);
+      break;
+    }
+    case IREE_VM_LIST_STORAGE_MODE_VARIANT: {
+      iree_vm_variant_t* variant = (iree_vm_variant_t*)element_ptr;
+      if (!iree_vm_variant_is_empty(*variant) &&
+          !iree_vm_type_def_is_ref(variant->type)) {
+        return iree_make_status(IREE_STATUS_FAILED_PRECONDITION);
+      }
+      iree_vm_ref_move(&variant->ref, out_value);
+      memset(&variant->type, 0, sizeof(variant->type));
+      break;
+    }
+    default:
+      return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                              "list does not store refs");
+  }
+  return iree_ok_status();
+}
+
 static iree_status_t iree_vm_list_set_ref(iree_vm_list_t* list,
                                           iree_host_size_t i, bool is_move,
                                           iree_vm_ref_t* value) {
@@ -916,6 +973,120 @@ IREE_API_EXPORT iree_status_t iree_vm_list_pop_front_ref_move(
   return iree_ok_status();
 }
 
+IREE_API_EXPORT iree_status_t iree_vm_list_map_refs(
+    const iree_vm_list_t* list, iree_host_size_t offset, iree_host_size_t count,
+    const iree_vm_ref_t** out_refs) {
+  IREE_ASSERT_ARGUMENT(list);
+  IREE_ASSERT_ARGUMENT(out_refs);
+  *out_refs = NULL;
+  if (list->storage_mode != IREE_VM_LIST_STORAGE_MODE_REF) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "list does not store refs of a single type");
+  }
+  IREE_RETURN_IF_ERROR(iree_vm_list_check_range(list, offset, count));
+  *out_refs = (const iree_vm_ref_t*)list->storage + offset;
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_list_get_refs_retain(
+    const iree_vm_list_t* list, iree_host_size_t offset, iree_host_size_t count,
+    iree_vm_ref_t* out_values) {
+  IREE_ASSERT_ARGUMENT(list);
+  IREE_ASSERT_ARGUMENT(!count || out_values);
+  IREE_RETURN_IF_ERROR(iree_vm_list_check_range(list, offset, count));
+  switch (list->storage_mode) {
+    case IREE_VM_LIST_STORAGE_MODE_REF: {
+      iree_vm_ref_t* refs = (iree_vm_ref_t*)list->storage + offset;
+      for (iree_host_size_t i = 0; i < count; ++i) {
+        iree_vm_ref_retain(&refs[i], &out_values[i]);
+      }
+      break;
+    }
+    case IREE_VM_LIST_STORAGE_MODE_VARIANT: {
+      iree_vm_variant_t* variants = (iree_vm_variant_t*)list->storage + offset;
+      for (iree_host_size_t i = 0; i < count; ++i) {
+        if (!iree_vm_variant_is_empty(variants[i]) &&
+            !iree_vm_type_def_is_ref(variants[i].type)) {
+          return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                                  "element %" PRIhsz " is not a ref",
+                                  offset + i);
+        }
+      }
+      for (iree_host_size_t i = 0; i < count; ++i) {
+        iree_vm_ref_retain(&variants[i].ref, &out_values[i]);
+      }
+      break;
+    }
+    default:
+      return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                              "list does not store refs");
+  }
+  return iree_ok_status();
+}
+
+static iree_status_t iree_vm_list_push_refs(iree_vm_list_t* list,
+                                            iree_host_size_t count,
+                                            bool is_move,
+                                            iree_vm_ref_t* values) {
+  IREE_ASSERT_ARGUMENT(list);
+  IREE_ASSERT_ARGUMENT(!count || values);
+
+  // Check all types up front so that the list is unchanged on failure.
+  switch (list->storage_mode) {
+    case IREE_VM_LIST_STORAGE_MODE_REF: {
+      iree_vm_ref_type_t element_type =
+          iree_vm_type_def_as_ref(list->element_type);
+      if (element_type == IREE_VM_REF_TYPE_ANY) break;
+      for (iree_host_size_t i = 0; i < count; ++i) {
+        if (values[i].type != IREE_VM_REF_TYPE_NULL &&
+            !iree_vm_ref_type_equal(values[i].type, element_type)) {
+          return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                  "source ref %" PRIhsz " type mismatch", i);
+        }
+      }
+      break;
+    }
+    case IREE_VM_LIST_STORAGE_MODE_VARIANT:
+      break;
+    default:
+      return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                              "list cannot store refs");
+  }
+
+  // New elements are zeroed and need no release before being overwritten.
+  iree_host_size_t offset = list->count;
+  IREE_RETURN_IF_ERROR(iree_vm_list_resize(list, offset + count));
+  if (list->storage_mode == IREE_VM_LIST_STORAGE_MODE_REF) {
+    iree_vm_ref_t* refs = (iree_vm_ref_t*)list->storage + offset;
+    memcpy(refs, values, count * sizeof(*refs));
+    if (is_move) {
+      memset(values, 0, count * sizeof(*values));
+    } else {
+      for (iree_host_size_t i = 0; i < count; ++i) {
+        iree_vm_ref_retain_inplace(&refs[i]);
+      }
+    }
+  } else {
+    iree_vm_variant_t* variants = (iree_vm_variant_t*)list->storage + offset;
+    for (iree_host_size_t i = 0; i < count; ++i) {
+      variants[i].type = iree_vm_make_ref_type_def(values[i].type);
+      iree_vm_ref_retain_or_move(is_move, &values[i], &variants[i].ref);
+    }
+  }
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_list_push_refs_retain(
+    iree_vm_list_t* list, iree_host_size_t count, const iree_vm_ref_t* values) {
+  return iree_vm_list_push_refs(list, count, /*is_move=*/false,
+                                (iree_vm_ref_t*)values);
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_list_push_refs_move(
+    iree_vm_list_t* list, iree_host_size_t count, iree_vm_ref_t* values) {
+  return iree_vm_list_push_refs(list, count, /*is_move=*/true, values);
+}
+
 typedef enum {
   IREE_VM_LIST_REF_ASSIGN = 0,
   IREE_VM_LIST_REF_RETAIN,
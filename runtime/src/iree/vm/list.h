@@ -157,6 +157,14 @@ IREE_API_EXPORT iree_status_t iree_vm_list_set_value(
 IREE_API_EXPORT iree_status_t
 iree_vm_list_push_value(iree_vm_list_t* list, const iree_vm_value_t* value);
 
+// Returns a view of |count| elements starting at |offset| in a list storing
+// primitive values of a single type. Elements are stored densely in the list
+// element type and may be read and written in place. The view is invalidated
+// by any operation that changes the list capacity.
+IREE_API_EXPORT iree_status_t iree_vm_list_map_values(
+    iree_vm_list_t* list, iree_host_size_t offset, iree_host_size_t count,
+    iree_byte_span_t* out_span);
+
 // Returns a dereferenced pointer to the given type if the element at the
 // given index |i| matches the |type|. Returns NULL on error.
 IREE_API_EXPORT void* iree_vm_list_get_ref_deref(const iree_vm_list_t* list,
@@ -174,6 +182,12 @@ IREE_API_EXPORT iree_status_t iree_vm_list_get_ref_assign(
 IREE_API_EXPORT iree_status_t iree_vm_list_get_ref_retain(
     const iree_vm_list_t* list, iree_host_size_t i, iree_vm_ref_t* out_value);
 
+// Moves the ref value of the element at the given index to |out_value|,
+// transferring ownership to the caller without changing the reference count.
+// The element is left NULL and the list size is unchanged.
+IREE_API_EXPORT iree_status_t iree_vm_list_get_ref_move(
+    iree_vm_list_t* list, iree_host_size_t i, iree_vm_ref_t* out_value);
+
 // Sets the ref value of the element at the given index, retaining a reference
 // in the list until the element is cleared or the list is disposed.
 IREE_API_EXPORT iree_status_t iree_vm_list_set_ref_retain(
@@ -199,6 +213,33 @@ IREE_API_EXPORT iree_status_t iree_vm_list_push_ref_move(iree_vm_list_t* list,
 IREE_API_EXPORT iree_status_t
 iree_vm_list_pop_front_ref_move(iree_vm_list_t* list, iree_vm_ref_t* out_value);
 
+// Returns a view of |count| elements starting at |offset| in a list storing
+// refs of a single type. The refs remain owned by the list and must be retained
+// by the caller to extend their lifetime. The view is invalidated by any
+// operation that changes the list capacity or contents.
+IREE_API_EXPORT iree_status_t iree_vm_list_map_refs(
+    const iree_vm_list_t* list, iree_host_size_t offset, iree_host_size_t count,
+    const iree_vm_ref_t** out_refs);
+
+// Retains |count| ref values starting at |offset| into |out_values|, releasing
+// any existing values. In variant lists all elements in the range must be refs
+// or empty.
+IREE_API_EXPORT iree_status_t iree_vm_list_get_refs_retain(
+    const iree_vm_list_t* list, iree_host_size_t offset, iree_host_size_t count,
+    iree_vm_ref_t* out_values);
+
+// Pushes |count| ref |values| to the end of the list, retaining a reference to
+// each in the list. All types are checked before any element is added so the
+// list is unchanged on failure. |values| must not alias the list storage.
+IREE_API_EXPORT iree_status_t iree_vm_list_push_refs_retain(
+    iree_vm_list_t* list, iree_host_size_t count, const iree_vm_ref_t* values);
+
+// Pushes |count| ref |values| to the end of the list, moving ownership of each
+// reference to the list and resetting |values| to NULL.
+// |values| must not alias the list storage.
+IREE_API_EXPORT iree_status_t iree_vm_list_push_refs_move(
+    iree_vm_list_t* list, iree_host_size_t count, iree_vm_ref_t* values);
+
 // Returns the value of the element at the given index. If the element contains
 // a ref it will *not* be retained and the caller must retain it to extend its
 // lifetime.
@@ -0,0 +1,169 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "iree/base/api.h"
+#include "iree/vm/instance.h"
+#include "iree/vm/list.h"
+#include "iree/vm/ref.h"
+
+namespace {
+
+// Minimal ref object standing in for tensors passed to a function.
+struct test_object_t {
+  iree_vm_ref_object_t ref_object = {1};
+};
+
+// Owns an instance with the test object type registered and a set of objects
+// to populate lists with.
+class ListBenchmarkFixture {
+ public:
+  explicit ListBenchmarkFixture(iree_host_size_t object_count) {
+    IREE_CHECK_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
+                                          iree_allocator_system(), &instance_));
+    descriptor_.type_name = IREE_SV("test_object");
+    descriptor_.offsetof_counter = offsetof(test_object_t, ref_object.counter) /
+                                   IREE_VM_REF_COUNTER_ALIGNMENT;
+    descriptor_.destroy = +[](void* ptr) {
+      delete reinterpret_cast<test_object_t*>(ptr);
+    };
+    IREE_CHECK_OK(
+        iree_vm_instance_register_type(instance_, &descriptor_, &type_));
+    refs_.resize(object_count);
+    for (auto& ref : refs_) {
+      memset(&ref, 0, sizeof(ref));
+      IREE_CHECK_OK(iree_vm_ref_wrap_assign(new test_object_t(), type_, &ref));
+    }
+  }
+
+  ~ListBenchmarkFixture() {
+    iree_vm_ref_release_all(refs_.size(), refs_.data());
+    iree_vm_instance_release(instance_);
+  }
+
+  iree_vm_list_t* CreateList() {
+    iree_vm_list_t* list = nullptr;
+    IREE_CHECK_OK(iree_vm_list_create(iree_vm_make_ref_type_def(type_),
+                                      refs_.size(), iree_allocator_system(),
+                                      &list));
+    return list;
+  }
+
+  std::vector<iree_vm_ref_t>& refs() { return refs_; }
+
+ private:
+  iree_vm_instance_t* instance_ = nullptr;
+  iree_vm_ref_type_descriptor_t descriptor_ = {0};
+  iree_vm_ref_type_t type_ = 0;
+  std::vector<iree_vm_ref_t> refs_;
+};
+
+// Builds an argument list one element at a time.
+static void BM_ListPushRefRetain(benchmark::State& state) {
+  ListBenchmarkFixture fixture(state.range(0));
+  iree_vm_list_t* list = fixture.CreateList();
+  for (auto _ : state) {
+    for (auto& ref : fixture.refs()) {
+      IREE_CHECK_OK(iree_vm_list_push_ref_retain(list, &ref));
+    }
+    iree_vm_list_clear(list);
+  }
+  iree_vm_list_release(list);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ListPushRefRetain)->Arg(16)->Arg(256)->Arg(1024);
+
+// Builds an argument list with a single bulk push.
+static void BM_ListPushRefsRetain(benchmark::State& state) {
+  ListBenchmarkFixture fixture(state.range(0));
+  iree_vm_list_t* list = fixture.CreateList();
+  for (auto _ : state) {
+    IREE_CHECK_OK(iree_vm_list_push_refs_retain(list, fixture.refs().size(),
+                                                fixture.refs().data()));
+    iree_vm_list_clear(list);
+  }
+  iree_vm_list_release(list);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ListPushRefsRetain)->Arg(16)->Arg(256)->Arg(1024);
+
+// Reads results out of a list one element at a time.
+static void BM_ListGetRefRetain(benchmark::State& state) {
+  ListBenchmarkFixture fixture(state.range(0));
+  iree_vm_list_t* list = fixture.CreateList();
+  IREE_CHECK_OK(iree_vm_list_push_refs_retain(list, fixture.refs().size(),
+                                              fixture.refs().data()));
+  std::vector<iree_vm_ref_t> out_refs(state.range(0));
+  for (auto _ : state) {
+    for (iree_host_size_t i = 0; i < out_refs.size(); ++i) {
+      IREE_CHECK_OK(iree_vm_list_get_ref_retain(list, i, &out_refs[i]));
+    }
+    iree_vm_ref_release_all(out_refs.size(), out_refs.data());
+  }
+  iree_vm_list_release(list);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ListGetRefRetain)->Arg(16)->Arg(256)->Arg(1024);
+
+// Reads results out of a list with a single bulk get.
+static void BM_ListGetRefsRetain(benchmark::State& state) {
+  ListBenchmarkFixture fixture(state.range(0));
+  iree_vm_list_t* list = fixture.CreateList();
+  IREE_CHECK_OK(iree_vm_list_push_refs_retain(list, fixture.refs().size(),
+                                              fixture.refs().data()));
+  std::vector<iree_vm_ref_t> out_refs(state.range(0));
+  for (auto _ : state) {
+    IREE_CHECK_OK(iree_vm_list_get_refs_retain(list, 0, out_refs.size(),
+                                               out_refs.data()));
+    iree_vm_ref_release_all(out_refs.size(), out_refs.data());
+  }
+  iree_vm_list_release(list);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ListGetRefsRetain)->Arg(16)->Arg(256)->Arg(1024);
+
+// Fills a primitive list one element at a time.
+static void BM_ListSetValue(benchmark::State& state) {
+  iree_vm_list_t* list = nullptr;
+  IREE_CHECK_OK(iree_vm_list_create(
+      iree_vm_make_value_type_def(IREE_VM_VALUE_TYPE_I32), state.range(0),
+      iree_allocator_system(), &list));
+  IREE_CHECK_OK(iree_vm_list_resize(list, state.range(0)));
+  for (auto _ : state) {
+    for (int32_t i = 0; i < state.range(0); ++i) {
+      iree_vm_value_t value = iree_vm_value_make_i32(i);
+      IREE_CHECK_OK(iree_vm_list_set_value(list, i, &value));
+    }
+  }
+  iree_vm_list_release(list);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ListSetValue)->Arg(16)->Arg(256)->Arg(1024);
+
+// Fills a primitive list in place through a mapped view.
+static void BM_ListMapValues(benchmark::State& state) {
+  iree_vm_list_t* list = nullptr;
+  IREE_CHECK_OK(iree_vm_list_create(
+      iree_vm_make_value_type_def(IREE_VM_VALUE_TYPE_I32), state.range(0),
+      iree_allocator_system(), &list));
+  IREE_CHECK_OK(iree_vm_list_resize(list, state.range(0)));
+  for (auto _ : state) {
+    iree_byte_span_t span;
+    IREE_CHECK_OK(iree_vm_list_map_values(list, 0, state.range(0), &span));
+    int32_t* values = reinterpret_cast<int32_t*>(span.data);
+    for (int32_t i = 0; i < state.range(0); ++i) values[i] = i;
+    benchmark::DoNotOptimize(values);
+  }
+  iree_vm_list_release(list);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ListMapValues)->Arg(16)->Arg(256)->Arg(1024);
+
+}  // namespace
@@ -233,6 +233,138 @@ TEST_F(VMListTest, UsageRef) {
   iree_vm_list_release(list);
 }
 
+// Tests moving refs out of ref and variant lists.
+TEST_F(VMListTest, GetRefMove) {
+  iree_vm_type_def_t element_types[2] = {
+      iree_vm_make_ref_type_def(test_a_type()),
+      iree_vm_make_undefined_type_def(),
+  };
+  for (iree_vm_type_def_t element_type : element_types) {
+    iree_vm_list_t* list = nullptr;
+    IREE_ASSERT_OK(iree_vm_list_create(element_type, 2,
+                                       iree_allocator_system(), &list));
+    IREE_ASSERT_OK(iree_vm_list_resize(list, 2));
+    iree_vm_ref_t ref_a = MakeRef<A>(1.0f);
+    IREE_ASSERT_OK(iree_vm_list_set_ref_move(list, 0, &ref_a));
+
+    iree_vm_ref_t moved_ref{0};
+    IREE_ASSERT_OK(iree_vm_list_get_ref_move(list, 0, &moved_ref));
+    EXPECT_TRUE(test_a_isa(moved_ref));
+    EXPECT_EQ(2, iree_vm_list_size(list));
+    iree_vm_ref_t null_ref{0};
+    IREE_ASSERT_OK(iree_vm_list_get_ref_assign(list, 0, &null_ref));
+    EXPECT_EQ(nullptr, null_ref.ptr);
+    iree_vm_ref_release(&moved_ref);
+
+    EXPECT_THAT(Status(iree_vm_list_get_ref_move(list, 2, &moved_ref)),
+                StatusIs(StatusCode::kOutOfRange));
+    iree_vm_list_release(list);
+  }
+}
+
+// Tests bulk pushing refs into ref and variant lists.
+TEST_F(VMListTest, PushRefsBulk) {
+  iree_vm_type_def_t element_types[2] = {
+      iree_vm_make_ref_type_def(test_a_type()),
+      iree_vm_make_undefined_type_def(),
+  };
+  for (iree_vm_type_def_t element_type : element_types) {
+    iree_vm_list_t* list = nullptr;
+    IREE_ASSERT_OK(iree_vm_list_create(element_type, 0,
+                                       iree_allocator_system(), &list));
+    iree_vm_ref_t refs[3] = {MakeRef<A>(0.0f), {0}, MakeRef<A>(2.0f)};
+    IREE_ASSERT_OK(
+        iree_vm_list_push_refs_retain(list, IREE_ARRAYSIZE(refs), refs));
+    IREE_ASSERT_OK(
+        iree_vm_list_push_refs_move(list, IREE_ARRAYSIZE(refs), refs));
+    for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(refs); ++i) {
+      EXPECT_EQ(nullptr, refs[i].ptr);
+    }
+    ASSERT_EQ(6, iree_vm_list_size(list));
+
+    iree_vm_ref_t out_refs[6] = {{0}};
+    IREE_ASSERT_OK(iree_vm_list_get_refs_retain(list, 0, 6, out_refs));
+    for (iree_host_size_t i = 0; i < 6; ++i) {
+      if (i % 3 == 1) {
+        EXPECT_EQ(nullptr, out_refs[i].ptr);
+      } else {
+        ASSERT_TRUE(test_a_isa(out_refs[i]));
+        EXPECT_EQ(i % 3, test_a_deref(out_refs[i])->data());
+      }
+    }
+    EXPECT_THAT(Status(iree_vm_list_get_refs_retain(list, 4, 3, out_refs)),
+                StatusIs(StatusCode::kOutOfRange));
+    iree_vm_ref_release_all(IREE_ARRAYSIZE(out_refs), out_refs);
+    iree_vm_list_release(list);
+  }
+}
+
+// Tests that a bulk push with a mismatched type leaves the list unchanged.
+TEST_F(VMListTest, PushRefsTypeMismatch) {
+  iree_vm_type_def_t element_type = iree_vm_make_ref_type_def(test_a_type());
+  iree_vm_list_t* list = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_list_create(element_type, 0, iree_allocator_system(), &list));
+  iree_vm_ref_t refs[2] = {MakeRef<A>(0.0f), MakeRef<B>(1.0f)};
+  EXPECT_THAT(Status(iree_vm_list_push_refs_move(list, 2, refs)),
+              StatusIs(StatusCode::kInvalidArgument));
+  EXPECT_EQ(0, iree_vm_list_size(list));
+  EXPECT_NE(nullptr, refs[0].ptr);
+  EXPECT_NE(nullptr, refs[1].ptr);
+  iree_vm_ref_release_all(IREE_ARRAYSIZE(refs), refs);
+  iree_vm_list_release(list);
+}
+
+// Tests viewing ref list storage in place.
+TEST_F(VMListTest, MapRefs) {
+  iree_vm_type_def_t element_type = iree_vm_make_ref_type_def(test_a_type());
+  iree_vm_list_t* list = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_list_create(element_type, 4, iree_allocator_system(), &list));
+  for (iree_host_size_t i = 0; i < 4; ++i) {
+    iree_vm_ref_t ref_a = MakeRef<A>(static_cast<float>(i));
+    IREE_ASSERT_OK(iree_vm_list_push_ref_move(list, &ref_a));
+  }
+  const iree_vm_ref_t* refs = nullptr;
+  IREE_ASSERT_OK(iree_vm_list_map_refs(list, 1, 3, &refs));
+  for (iree_host_size_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(i + 1, test_a_deref(refs[i])->data());
+  }
+  EXPECT_THAT(Status(iree_vm_list_map_refs(list, 2, 3, &refs)),
+              StatusIs(StatusCode::kOutOfRange));
+  iree_vm_list_release(list);
+
+  // Variant lists have no dense ref storage to view.
+  IREE_ASSERT_OK(iree_vm_list_create(iree_vm_make_undefined_type_def(), 4,
+                                     iree_allocator_system(), &list));
+  EXPECT_THAT(Status(iree_vm_list_map_refs(list, 0, 0, &refs)),
+              StatusIs(StatusCode::kFailedPrecondition));
+  iree_vm_list_release(list);
+}
+
+// Tests reading and writing value list storage in place.
+TEST_F(VMListTest, MapValues) {
+  iree_vm_type_def_t element_type =
+      iree_vm_make_value_type_def(IREE_VM_VALUE_TYPE_I32);
+  iree_vm_list_t* list = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_list_create(element_type, 8, iree_allocator_system(), &list));
+  IREE_ASSERT_OK(iree_vm_list_resize(list, 8));
+  iree_byte_span_t span = iree_make_byte_span(NULL, 0);
+  IREE_ASSERT_OK(iree_vm_list_map_values(list, 2, 4, &span));
+  ASSERT_EQ(4 * sizeof(int32_t), span.data_length);
+  int32_t* values = reinterpret_cast<int32_t*>(span.data);
+  for (int32_t i = 0; i < 4; ++i) values[i] = i + 100;
+  for (iree_host_size_t i = 0; i < 8; ++i) {
+    iree_vm_value_t value;
+    IREE_ASSERT_OK(iree_vm_list_get_value(list, i, &value));
+    EXPECT_EQ(i >= 2 && i < 6 ? 100 + (int32_t)i - 2 : 0, value.i32);
+  }
+  EXPECT_THAT(Status(iree_vm_list_map_values(list, 9, 0, &span)),
+              StatusIs(StatusCode::kOutOfRange));
+  iree_vm_list_release(list);
+}
+
 // Tests simple variant list usage, mainly just for demonstration.
 // Stores any heterogeneous element type, equivalent to `!vm.list<?>`.
 TEST_F(VMListTest, UsageVariant) {
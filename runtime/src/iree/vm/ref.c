@@ -42,7 +42,7 @@ static inline volatile iree_atomic_ref_count_t* iree_vm_get_raw_counter_ptr(
   IREE_VM_REF_ASSERT(ptr);
   IREE_VM_REF_ASSERT(type_descriptor);
   return (volatile iree_atomic_ref_count_t*)ptr +
-         (type & IREE_VM_REF_TYPE_TAG_BIT_MASK);
+         (type & IREE_VM_REF_TYPE_COUNTER_OFFSET_BIT_MASK);
 }
 
 static inline volatile iree_atomic_ref_count_t* iree_vm_get_ref_counter_ptr(
@@ -50,7 +50,51 @@ static inline volatile iree_atomic_ref_count_t* iree_vm_get_ref_counter_ptr(
   IREE_VM_REF_ASSERT(ref);
   IREE_VM_REF_ASSERT(ref->ptr);
   return (volatile iree_atomic_ref_count_t*)ref->ptr +
-         (ref->type & IREE_VM_REF_TYPE_TAG_BIT_MASK);
+         (ref->type & IREE_VM_REF_TYPE_COUNTER_OFFSET_BIT_MASK);
+}
+
+// Adds a reference to the object of |type| owning |counter|.
+static inline void iree_vm_ref_counter_inc(
+    volatile iree_atomic_ref_count_t* counter, iree_vm_ref_type_t type) {
+  if (type & IREE_VM_REF_TYPE_THREAD_CONFINED_BIT) {
+    // Only the owning thread can observe the counter so no RMW is required.
+    iree_atomic_ref_count_t* confined_counter =
+        (iree_atomic_ref_count_t*)counter;
+    iree_atomic_store_int32(
+        confined_counter,
+        iree_atomic_load_int32(confined_counter, iree_memory_order_relaxed) + 1,
+        iree_memory_order_relaxed);
+  } else {
+    iree_atomic_ref_count_inc(counter);
+  }
+}
+
+// Removes |count| references from the object of |type| owning |counter| and
+// returns the reference count prior to the decrement.
+static inline int32_t iree_vm_ref_counter_dec(
+    volatile iree_atomic_ref_count_t* counter, iree_vm_ref_type_t type,
+    int32_t count) {
+  if (type & IREE_VM_REF_TYPE_THREAD_CONFINED_BIT) {
+    iree_atomic_ref_count_t* confined_counter =
+        (iree_atomic_ref_count_t*)counter;
+    int32_t value =
+        iree_atomic_load_int32(confined_counter, iree_memory_order_relaxed);
+    iree_atomic_store_int32(confined_counter, value - count,
+                            iree_memory_order_relaxed);
+    return value;
+  }
+  return iree_atomic_fetch_sub_int32(counter, count, iree_memory_order_acq_rel);
+}
+
+// Destroys the object |ptr| of |type| after its last reference was released.
+static void iree_vm_ref_destroy(void* ptr, iree_vm_ref_type_t type) {
+  const iree_vm_ref_type_descriptor_t* descriptor =
+      iree_vm_ref_type_descriptor(type);
+  if (descriptor->destroy) {
+    // NOTE: this makes us not re-entrant, but I think that's OK.
+    iree_vm_ref_ptr_trace("DESTROY", ptr, type);
+    descriptor->destroy(ptr);
+  }
 }
 
 IREE_API_EXPORT void iree_vm_ref_object_retain(void* ptr,
@@ -59,7 +103,7 @@ IREE_API_EXPORT void iree_vm_ref_object_retain(void* ptr,
   IREE_VM_REF_ASSERT(type);
   volatile iree_atomic_ref_count_t* counter =
       iree_vm_get_raw_counter_ptr(ptr, type);
-  iree_atomic_ref_count_inc(counter);
+  iree_vm_ref_counter_inc(counter, type);
   iree_vm_ref_ptr_trace("RETAIN", ptr, type);
 }
 
@@ -70,14 +114,8 @@ IREE_API_EXPORT void iree_vm_ref_object_release(void* ptr,
   iree_vm_ref_ptr_trace("RELEASE", ptr, type);
   volatile iree_atomic_ref_count_t* counter =
       iree_vm_get_raw_counter_ptr(ptr, type);
-  if (iree_atomic_ref_count_dec(counter) == 1) {
-    const iree_vm_ref_type_descriptor_t* descriptor =
-        iree_vm_ref_type_descriptor(type);
-    if (descriptor->destroy) {
-      // NOTE: this makes us not re-entrant, but I think that's OK.
-      iree_vm_ref_ptr_trace("DESTROY", ptr, type);
-      descriptor->destroy(ptr);
-    }
+  if (iree_vm_ref_counter_dec(counter, type, 1) == 1) {
+    iree_vm_ref_destroy(ptr, type);
   }
 }
 
@@ -113,7 +151,7 @@ IREE_API_EXPORT iree_status_t iree_vm_ref_wrap_retain(void* ptr,
   if (out_ref->ptr) {
     volatile iree_atomic_ref_count_t* counter =
         iree_vm_get_ref_counter_ptr(out_ref);
-    iree_atomic_ref_count_inc(counter);
+    iree_vm_ref_counter_inc(counter, out_ref->type);
     iree_vm_ref_trace("WRAP RETAIN", out_ref);
   }
   return iree_ok_status();
@@ -124,7 +162,7 @@ IREE_API_EXPORT void iree_vm_ref_retain_inplace(iree_vm_ref_t* ref) {
   if (ref->ptr) {
     volatile iree_atomic_ref_count_t* counter =
         iree_vm_get_ref_counter_ptr(ref);
-    iree_atomic_ref_count_inc(counter);
+    iree_vm_ref_counter_inc(counter, ref->type);
     iree_vm_ref_trace("RETAIN", ref);
   }
 }
@@ -139,7 +177,7 @@ IREE_API_EXPORT void iree_vm_ref_retain(iree_vm_ref_t* ref,
   if (ref->ptr) {
     volatile iree_atomic_ref_count_t* counter =
         iree_vm_get_ref_counter_ptr(ref);
-    iree_atomic_ref_count_inc(counter);
+    iree_vm_ref_counter_inc(counter, ref->type);
     iree_vm_ref_trace("RETAIN", ref);
   }
   if (out_ref->ptr) {
@@ -156,7 +194,8 @@ IREE_API_EXPORT iree_status_t iree_vm_ref_retain_checked(
   IREE_VM_REF_ASSERT(ref);
   IREE_VM_REF_ASSERT(type);
   IREE_VM_REF_ASSERT(out_ref);
-  if (ref->type != IREE_VM_REF_TYPE_NULL && ref->type != type &&
+  if (ref->type != IREE_VM_REF_TYPE_NULL &&
+      !iree_vm_ref_type_equal(ref->type, type) &&
       type != IREE_VM_REF_TYPE_ANY) {
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                             "source ref type mismatch");
@@ -182,7 +221,8 @@ IREE_API_EXPORT iree_status_t iree_vm_ref_retain_or_move_checked(
   IREE_VM_REF_ASSERT(ref);
   IREE_VM_REF_ASSERT(type);
   IREE_VM_REF_ASSERT(out_ref);
-  if (ref->type != IREE_VM_REF_TYPE_NULL && ref->type != type &&
+  if (ref->type != IREE_VM_REF_TYPE_NULL &&
+      !iree_vm_ref_type_equal(ref->type, type) &&
       type != IREE_VM_REF_TYPE_ANY) {
     // Make no changes on failure.
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
@@ -198,20 +238,41 @@ IREE_API_EXPORT void iree_vm_ref_release(iree_vm_ref_t* ref) {
 
   iree_vm_ref_trace("RELEASE", ref);
   volatile iree_atomic_ref_count_t* counter = iree_vm_get_ref_counter_ptr(ref);
-  if (iree_atomic_ref_count_dec(counter) == 1) {
-    const iree_vm_ref_type_descriptor_t* descriptor =
-        iree_vm_ref_type_descriptor(ref->type);
-    if (descriptor->destroy) {
-      // NOTE: this makes us not re-entrant, but I think that's OK.
-      iree_vm_ref_trace("DESTROY", ref);
-      descriptor->destroy(ref->ptr);
-    }
+  if (iree_vm_ref_counter_dec(counter, ref->type, 1) == 1) {
+    iree_vm_ref_destroy(ref->ptr, ref->type);
   }
 
   // Reset ref to point at nothing.
   memset(ref, 0, sizeof(*ref));
 }
 
+IREE_API_EXPORT void iree_vm_ref_release_all(iree_host_size_t ref_count,
+                                             iree_vm_ref_t* refs) {
+  IREE_VM_REF_ASSERT(!ref_count || refs);
+  for (iree_host_size_t i = 0; i < ref_count;) {
+    iree_vm_ref_t ref = refs[i];
+    if (ref.type == IREE_VM_REF_TYPE_NULL || ref.ptr == NULL) {
+      memset(&refs[i++], 0, sizeof(*refs));
+      continue;
+    }
+
+    // Gather adjacent references to the same object so that they can be
+    // dropped together.
+    iree_host_size_t run_end = i + 1;
+    while (run_end < ref_count && refs[run_end].ptr == ref.ptr) ++run_end;
+    int32_t run_length = (int32_t)(run_end - i);
+    memset(&refs[i], 0, run_length * sizeof(*refs));
+    i = run_end;
+
+    iree_vm_ref_trace("RELEASE", &ref);
+    volatile iree_atomic_ref_count_t* counter =
+        iree_vm_get_ref_counter_ptr(&ref);
+    if (iree_vm_ref_counter_dec(counter, ref.type, run_length) == run_length) {
+      iree_vm_ref_destroy(ref.ptr, ref.type);
+    }
+  }
+}
+
 IREE_API_EXPORT void iree_vm_ref_assign(iree_vm_ref_t* ref,
                                         iree_vm_ref_t* out_ref) {
   IREE_VM_REF_ASSERT(ref);
@@ -34,6 +34,14 @@ typedef struct iree_vm_instance_t iree_vm_instance_t;
   (sizeof(uintptr_t) * 8 - IREE_VM_REF_TYPE_TAG_BITS)
 #define IREE_VM_REF_TYPE_PTR_BIT_MASK (~IREE_VM_REF_TYPE_TAG_BIT_MASK)
 
+// Tag bits holding the offset of the reference counter in units of
+// IREE_VM_REF_COUNTER_ALIGNMENT (iree_vm_ref_type_descriptor_t
+// offsetof_counter).
+#define IREE_VM_REF_TYPE_COUNTER_OFFSET_BIT_MASK 0b011
+// Tag bit set when the type is thread-confined so that retains and releases
+// can pick how to update the counter without loading the type descriptor.
+#define IREE_VM_REF_TYPE_THREAD_CONFINED_BIT 0b100
+
 // (1 << IREE_VM_REF_TYPE_TAG_BITS) hardcoded for MSVC which cannot have
 // expressions in its alignas in older versions.
 #define IREE_VM_REF_TYPE_DESCRIPTOR_ALIGNMENT 8
@@ -71,8 +79,15 @@ typedef iree_alignas(IREE_VM_REF_TYPE_DESCRIPTOR_ALIGNMENT) struct
   iree_string_view_t type_name;
   // Offset from ptr in units of IREE_VM_REF_COUNTER_ALIGNMENT to the start of
   // an iree_atomic_ref_count_t representing the current reference count.
+  // Must fit within IREE_VM_REF_TYPE_COUNTER_OFFSET_BIT_MASK.
   uintptr_t offsetof_counter : IREE_VM_REF_TYPE_TAG_BITS;
-  uintptr_t reserved : IREE_VM_REF_TYPE_PTR_BITS;
+  // Set when objects of the type are only ever referenced from the thread
+  // that created them. The iree_vm_ref_* functions then adjust the reference
+  // count with plain loads and stores instead of atomic read-modify-writes.
+  // Objects must not be retained or released concurrently by any means,
+  // including type-specific retain/release functions.
+  uintptr_t thread_confined : 1;
+  uintptr_t reserved : IREE_VM_REF_TYPE_PTR_BITS - 1;
 } iree_vm_ref_type_descriptor_t;
 
 // Type-erased reference counted type descriptor.
@@ -82,7 +97,16 @@ typedef uintptr_t iree_vm_ref_type_t;
 static inline iree_vm_ref_type_t iree_vm_make_ref_type(
     const iree_vm_ref_type_descriptor_t* descriptor) {
   return (iree_vm_ref_type_t)descriptor |
-         (iree_vm_ref_type_t)descriptor->offsetof_counter;
+         (iree_vm_ref_type_t)descriptor->offsetof_counter |
+         (descriptor->thread_confined ? IREE_VM_REF_TYPE_THREAD_CONFINED_BIT
+                                      : 0);
+}
+
+// Returns true if |lhs| and |rhs| reference the same type descriptor.
+// Tag bits are ignored as types derived from an iree_vm_type_def_t have none.
+static inline bool iree_vm_ref_type_equal(iree_vm_ref_type_t lhs,
+                                          iree_vm_ref_type_t rhs) {
+  return ((lhs ^ rhs) & IREE_VM_REF_TYPE_PTR_BIT_MASK) == 0;
 }
 
 // Returns the type name for the given type, if found.
@@ -226,6 +250,12 @@ IREE_API_EXPORT iree_status_t iree_vm_ref_retain_or_move_checked(
 // Releases the reference-counted pointer |ref|, possibly freeing it.
 IREE_API_EXPORT void iree_vm_ref_release(iree_vm_ref_t* ref);
 
+// Releases all |ref_count| references in |refs|, possibly freeing them, and
+// resets each to NULL. NULL refs are skipped and runs of adjacent refs to the
+// same object are released with a single reference count adjustment.
+IREE_API_EXPORT void iree_vm_ref_release_all(iree_host_size_t ref_count,
+                                             iree_vm_ref_t* refs);
+
 // Assigns the reference-counted pointer |ref| without incrementing the count.
 // |out_ref| will be released if it already contains a reference.
 IREE_API_EXPORT void iree_vm_ref_assign(iree_vm_ref_t* ref,
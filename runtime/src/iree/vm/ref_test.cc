@@ -13,6 +13,7 @@
 #include "iree/testing/status_matchers.h"
 #include "iree/vm/instance.h"
 #include "iree/vm/ref.h"
+#include "iree/vm/type_def.h"
 
 namespace {
 
@@ -74,7 +75,8 @@ static iree_vm_ref_t MakeRef(InstancePtr& instance, const char* type_name) {
 // only here to test the expected behavior.
 static int32_t ReadCounter(iree_vm_ref_t* ref) {
   return iree_atomic_load_int32((iree_atomic_ref_count_t*)ref->ptr +
-                                    (ref->type & IREE_VM_REF_TYPE_TAG_BIT_MASK),
+                                    (ref->type &
+                                     IREE_VM_REF_TYPE_COUNTER_OFFSET_BIT_MASK),
                                 iree_memory_order_seq_cst);
 }
 
@@ -512,6 +514,70 @@ TEST(VMRefTest, InPlaceAssignment) {
   EXPECT_EQ(IREE_VM_REF_TYPE_NULL, ref.type());
 }
 
+// Tests that releasing a range of refs handles NULLs and repeated objects.
+TEST(VMRefTest, ReleaseAll) {
+  auto instance = MakeInstance();
+  iree_vm_ref_t a_ref = MakeRef<A>(instance, "AType");
+  iree_vm_ref_t b_ref = MakeRef<B>(instance, "BType");
+  iree_vm_ref_t a_keep = {0};
+  iree_vm_ref_retain(&a_ref, &a_keep);
+  iree_vm_ref_t refs[6] = {{0}};
+  iree_vm_ref_retain(&a_ref, &refs[0]);
+  iree_vm_ref_retain(&a_ref, &refs[1]);
+  iree_vm_ref_move(&b_ref, &refs[3]);
+  iree_vm_ref_move(&a_ref, &refs[4]);
+  EXPECT_EQ(4, ReadCounter(&a_keep));
+  iree_vm_ref_release_all(IREE_ARRAYSIZE(refs), refs);
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(refs); ++i) {
+    EXPECT_EQ(nullptr, refs[i].ptr);
+    EXPECT_EQ(IREE_VM_REF_TYPE_NULL, refs[i].type);
+  }
+  EXPECT_EQ(1, ReadCounter(&a_keep));
+  iree_vm_ref_release(&a_keep);
+}
+
+static int confined_destroy_count = 0;
+
+// Tests that types registered as thread-confined are counted correctly.
+TEST(VMRefTest, ThreadConfinedType) {
+  auto instance = MakeInstance();
+  static iree_vm_ref_type_descriptor_t descriptor = {0};
+  descriptor.type_name = IREE_SV("ConfinedType");
+  descriptor.offsetof_counter = offsetof(ref_object_c_t, ref_object.counter) /
+                                IREE_VM_REF_COUNTER_ALIGNMENT;
+  descriptor.destroy = +[](void* ptr) {
+    ++confined_destroy_count;
+    delete reinterpret_cast<ref_object_c_t*>(ptr);
+  };
+  descriptor.thread_confined = 1;
+  iree_vm_ref_type_t type = 0;
+  IREE_ASSERT_OK(
+      iree_vm_instance_register_type(instance.get(), &descriptor, &type));
+  EXPECT_NE(0u, type & IREE_VM_REF_TYPE_THREAD_CONFINED_BIT);
+
+  confined_destroy_count = 0;
+  iree_vm_ref_t ref_0 = {0};
+  IREE_ASSERT_OK(iree_vm_ref_wrap_assign(new ref_object_c_t(), type, &ref_0));
+  iree_vm_ref_t ref_1 = {0};
+  iree_vm_ref_retain(&ref_0, &ref_1);
+  iree_vm_ref_retain(&ref_0, &ref_1);
+  EXPECT_EQ(2, ReadCounter(&ref_0));
+
+  // Types round-tripped through a type def lose their tag bits but still
+  // match the registered type.
+  iree_vm_ref_type_t def_type =
+      iree_vm_type_def_as_ref(iree_vm_make_ref_type_def(type));
+  EXPECT_NE(type, def_type);
+  EXPECT_TRUE(iree_vm_ref_type_equal(type, def_type));
+  IREE_EXPECT_OK(iree_vm_ref_retain_checked(&ref_0, def_type, &ref_1));
+  EXPECT_EQ(2, ReadCounter(&ref_0));
+  iree_vm_ref_release(&ref_1);
+  EXPECT_EQ(1, ReadCounter(&ref_0));
+  EXPECT_EQ(0, confined_destroy_count);
+  iree_vm_ref_release(&ref_0);
+  EXPECT_EQ(1, confined_destroy_count);
+}
+
 }  // namespace
 
 struct ref_object_d_t {
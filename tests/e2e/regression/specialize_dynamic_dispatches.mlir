@@ -0,0 +1,56 @@
+// Built with --iree-flow-specialize-dispatch-dims=4,8: rows of 4 and 8 run the
+// specialized dispatch variants and all other row counts the generic one. All
+// of them must produce the same results.
+
+func.func private @transform_rows(%input: tensor<?x4xf32>) -> tensor<?x4xf32> {
+  %c0 = arith.constant 0 : index
+  %cst = arith.constant 0.0 : f32
+  %weights = arith.constant dense<[[1.0, 0.0, 0.0, 1.0], [0.0, 2.0, 0.0, 0.0], [0.0, 0.0, 3.0, 0.0], [1.0, 0.0, 0.0, 4.0]]> : tensor<4x4xf32>
+  %dim = tensor.dim %input, %c0 : tensor<?x4xf32>
+  %empty = tensor.empty(%dim) : tensor<?x4xf32>
+  %fill = linalg.fill ins(%cst : f32) outs(%empty : tensor<?x4xf32>) -> tensor<?x4xf32>
+  %matmul = linalg.matmul ins(%input, %weights : tensor<?x4xf32>, tensor<4x4xf32>) outs(%fill : tensor<?x4xf32>) -> tensor<?x4xf32>
+  %result = linalg.generic {indexing_maps = [affine_map<(d0, d1) -> (d0, d1)>, affine_map<(d0, d1) -> (d0, d1)>], iterator_types = ["parallel", "parallel"]} ins(%matmul : tensor<?x4xf32>) outs(%empty : tensor<?x4xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %one = arith.constant 1.0 : f32
+    %sum = arith.addf %in, %one : f32
+    linalg.yield %sum : f32
+  } -> tensor<?x4xf32>
+  return %result : tensor<?x4xf32>
+}
+
+func.func @hot_dim_4() {
+  %input = flow.tensor.constant dense<[[0.0, 1.0, 0.0, -1.0], [1.0, 1.0, 0.0, -1.0], [2.0, 1.0, 0.0, -1.0], [3.0, 1.0, 0.0, -1.0]]> : tensor<4x4xf32> -> tensor<?x4xf32>
+  %res = call @transform_rows(%input) : (tensor<?x4xf32>) -> tensor<?x4xf32>
+  %dshape = util.optimization_barrier %res : tensor<?x4xf32>
+  %result = tensor.cast %dshape : tensor<?x4xf32> to tensor<4x4xf32>
+  check.expect_almost_eq_const(%result, dense<[[0.0, 3.0, 1.0, -3.0], [1.0, 3.0, 1.0, -2.0], [2.0, 3.0, 1.0, -1.0], [3.0, 3.0, 1.0, 0.0]]> : tensor<4x4xf32>) : tensor<4x4xf32>
+  return
+}
+
+func.func @hot_dim_8() {
+  %input = flow.tensor.constant dense<[[0.0, 1.0, 0.0, -1.0], [1.0, 1.0, 0.0, -1.0], [2.0, 1.0, 0.0, -1.0], [3.0, 1.0, 0.0, -1.0], [4.0, 1.0, 0.0, -1.0], [5.0, 1.0, 0.0, -1.0], [6.0, 1.0, 0.0, -1.0], [7.0, 1.0, 0.0, -1.0]]> : tensor<8x4xf32> -> tensor<?x4xf32>
+  %res = call @transform_rows(%input) : (tensor<?x4xf32>) -> tensor<?x4xf32>
+  %dshape = util.optimization_barrier %res : tensor<?x4xf32>
+  %result = tensor.cast %dshape : tensor<?x4xf32> to tensor<8x4xf32>
+  check.expect_almost_eq_const(%result, dense<[[0.0, 3.0, 1.0, -3.0], [1.0, 3.0, 1.0, -2.0], [2.0, 3.0, 1.0, -1.0], [3.0, 3.0, 1.0, 0.0], [4.0, 3.0, 1.0, 1.0], [5.0, 3.0, 1.0, 2.0], [6.0, 3.0, 1.0, 3.0], [7.0, 3.0, 1.0, 4.0]]> : tensor<8x4xf32>) : tensor<8x4xf32>
+  return
+}
+
+func.func @generic_dim_3() {
+  %input = flow.tensor.constant dense<[[0.0, 1.0, 0.0, -1.0], [1.0, 1.0, 0.0, -1.0], [2.0, 1.0, 0.0, -1.0]]> : tensor<3x4xf32> -> tensor<?x4xf32>
+  %res = call @transform_rows(%input) : (tensor<?x4xf32>) -> tensor<?x4xf32>
+  %dshape = util.optimization_barrier %res : tensor<?x4xf32>
+  %result = tensor.cast %dshape : tensor<?x4xf32> to tensor<3x4xf32>
+  check.expect_almost_eq_const(%result, dense<[[0.0, 3.0, 1.0, -3.0], [1.0, 3.0, 1.0, -2.0], [2.0, 3.0, 1.0, -1.0]]> : tensor<3x4xf32>) : tensor<3x4xf32>
+  return
+}
+
+func.func @generic_dim_5() {
+  %input = flow.tensor.constant dense<[[0.0, 1.0, 0.0, -1.0], [1.0, 1.0, 0.0, -1.0], [2.0, 1.0, 0.0, -1.0], [3.0, 1.0, 0.0, -1.0], [4.0, 1.0, 0.0, -1.0]]> : tensor<5x4xf32> -> tensor<?x4xf32>
+  %res = call @transform_rows(%input) : (tensor<?x4xf32>) -> tensor<?x4xf32>
+  %dshape = util.optimization_barrier %res : tensor<?x4xf32>
+  %result = tensor.cast %dshape : tensor<?x4xf32> to tensor<5x4xf32>
+  check.expect_almost_eq_const(%result, dense<[[0.0, 3.0, 1.0, -3.0], [1.0, 3.0, 1.0, -2.0], [2.0, 3.0, 1.0, -1.0], [3.0, 3.0, 1.0, 0.0], [4.0, 3.0, 1.0, 1.0]]> : tensor<5x4xf32>) : tensor<5x4xf32>
+  return
+}
@@ -14,6 +14,7 @@
 #include "iree/base/api.h"
 #include "iree/base/internal/file_io.h"
 #include "iree/base/internal/flags.h"
+#include "iree/base/internal/fork_join.h"
 #include "iree/base/internal/path.h"
 #include "iree/hal/api.h"
 #include "iree/testing/benchmark.h"
@@ -34,6 +35,18 @@ IREE_FLAG(bool, reuse_devices, true,
 IREE_FLAG(bool, reuse_modules, true,
           "Only loads modules once and reuses them for all iterations.");
 
+IREE_FLAG(int32_t, call_window, 1,
+          "Maximum number of calls issued asynchronously before the oldest\n"
+          "must complete. 1 runs each call to completion before the next.\n"
+          "Calls whose results are used by later events are always run to\n"
+          "completion.");
+IREE_FLAG(int32_t, replay_threads, 1,
+          "Number of threads each replaying the trace concurrently with their\n"
+          "own context. Models independent request streams.");
+IREE_FLAG(bool, print_latency, false,
+          "Prints per-call latency percentiles and sustained call throughput\n"
+          "to stderr after each benchmark run.");
+
 IREE_FLAG_LIST(
     string, input,
     "An input (a) value or (b) buffer of the format:\n"
@@ -153,12 +166,11 @@ static iree_status_t iree_replay_benchmark_run_documents(
   return status;
 }
 
-// Benchmark function that runs a trace file.
-static iree_status_t iree_replay_benchmark_run_file(
-    const iree_benchmark_def_t* benchmark_def,
-    iree_benchmark_state_t* benchmark_state) {
-  const iree_replay_benchmark_registration_t* registration =
-      (const iree_replay_benchmark_registration_t*)benchmark_def->user_data;
+// Initializes |out_replay| for running the trace in |registration|.
+// On failure |out_replay| is left deinitialized.
+static iree_status_t iree_replay_benchmark_initialize_replay(
+    const iree_replay_benchmark_registration_t* registration,
+    iree_trace_replay_t* out_replay) {
   const iree_replay_benchmark_globals_t* globals = registration->globals;
 
   iree_trace_replay_flags_t replay_flags = IREE_TRACE_REPLAY_FLAG_NONE;
@@ -172,18 +184,11 @@ static iree_status_t iree_replay_benchmark_run_file(
     replay_flags |= IREE_TRACE_REPLAY_FLAG_REUSE_MODULES;
   }
 
-  // Setup replay state used for this benchmark.
-  iree_trace_replay_t replay;
   IREE_RETURN_IF_ERROR(iree_trace_replay_initialize(
       registration->root_path, globals->instance, replay_flags,
       IREE_VM_CONTEXT_FLAG_NONE, iree_hal_available_driver_registry(),
-      iree_allocator_system(), &replay));
-  replay.stdin_contents = globals->stdin_contents;
-
-  // Hook into all calls processed during the trace so we can time them.
-  replay.call_hooks.user_data = benchmark_state;
-  replay.call_hooks.before = iree_replay_benchmark_call_before;
-  replay.call_hooks.after = iree_replay_benchmark_call_after;
+      iree_allocator_system(), out_replay));
+  out_replay->stdin_contents = globals->stdin_contents;
 
   // Query device overrides, if any. When omitted the devices from the trace
   // file will be used.
@@ -191,18 +196,85 @@ static iree_status_t iree_replay_benchmark_run_file(
   iree_host_size_t device_uri_count = 0;
   const iree_string_view_t* device_uris = NULL;
   iree_hal_get_devices_flag_list(&device_uri_count, &device_uris);
-  iree_trace_replay_set_hal_devices_override(&replay, device_uri_count,
+  iree_trace_replay_set_hal_devices_override(out_replay, device_uri_count,
                                              device_uris);
 
+  iree_status_t status = iree_trace_replay_set_call_window(
+      out_replay, (iree_host_size_t)iree_max(1, FLAG_call_window));
+  if (!iree_status_is_ok(status)) iree_trace_replay_deinitialize(out_replay);
+  return status;
+}
+
+// Prints the latency of all calls made by |thread_count| threads and the
+// sustained call rate over |elapsed_ns| of replay time.
+static void iree_replay_benchmark_print_latency(
+    const iree_replay_benchmark_registration_t* registration,
+    iree_host_size_t thread_count,
+    const iree_trace_replay_latency_histogram_t* latency,
+    iree_duration_t elapsed_ns) {
+  iree_string_view_t name = iree_file_path_stem(registration->file_path);
+  double calls_per_second =
+      elapsed_ns > 0 ? latency->count * 1e9 / (double)elapsed_ns : 0.0;
+  fprintf(stderr,
+          "%.*s: %" PRIu64 " calls on %" PRIhsz
+          " thread(s), %.1f calls/s sustained\n",
+          (int)name.size, name.data, latency->count, thread_count,
+          calls_per_second);
+  if (!latency->count) return;
+  fprintf(stderr,
+          "  latency (ms): min %.3f mean %.3f p50 %.3f p90 %.3f p99 %.3f "
+          "max %.3f\n",
+          latency->min_ns / 1e6, latency->total_ns / 1e6 / latency->count,
+          iree_trace_replay_latency_histogram_percentile(latency, 50) / 1e6,
+          iree_trace_replay_latency_histogram_percentile(latency, 90) / 1e6,
+          iree_trace_replay_latency_histogram_percentile(latency, 99) / 1e6,
+          latency->max_ns / 1e6);
+}
+
+// Runs all events in |file| from start to end and rewinds it.
+static iree_status_t iree_replay_benchmark_run_pass(
+    iree_trace_replay_t* replay, FILE* file,
+    iree_benchmark_state_t* benchmark_state) {
+  // Clear replay state.
+  iree_trace_replay_reset(replay);
+
+  // Run all events in the document from start to end and wait for any calls
+  // still in flight.
+  iree_status_t status =
+      iree_replay_benchmark_run_documents(replay, file, benchmark_state);
+  status = iree_status_join(status, iree_trace_replay_flush(replay));
+
+  // Reset file back to the start.
+  fseek(file, 0, SEEK_SET);
+  return status;
+}
+
+// Runs the trace in |registration| one call at a time timing only the calls.
+static iree_status_t iree_replay_benchmark_run_sequential(
+    const iree_replay_benchmark_registration_t* registration,
+    iree_benchmark_state_t* benchmark_state) {
+  // Setup replay state used for this benchmark.
+  iree_trace_replay_t replay;
+  IREE_RETURN_IF_ERROR(
+      iree_replay_benchmark_initialize_replay(registration, &replay));
+
+  // Hook into all calls processed during the trace so we can time them.
+  replay.call_hooks.user_data = benchmark_state;
+  replay.call_hooks.before = iree_replay_benchmark_call_before;
+  replay.call_hooks.after = iree_replay_benchmark_call_after;
+
   // Open trace YAML file from the given file_path.
   FILE* file = fopen(registration->file_path.data, "rb");
   if (!file) {
+    iree_trace_replay_deinitialize(&replay);
     return iree_make_status(
         iree_status_code_from_errno(errno), "failed to open trace file '%.*s'",
         (int)registration->file_path.size, registration->file_path.data);
   }
 
   // Call the functions within the trace in order.
+  iree_status_t status = iree_ok_status();
+  iree_duration_t elapsed_ns = 0;
   while (iree_benchmark_keep_running(benchmark_state,
                                      /*batch_count=*/1)) {
     // Pause timing that was started automatically. We'll resume/pause around
@@ -210,22 +282,146 @@ static iree_status_t iree_replay_benchmark_run_file(
     // TODO(benvanik): see if we can tell benchmark to start paused?
     iree_benchmark_pause_timing(benchmark_state);
 
-    // Clear replay state.
-    iree_trace_replay_reset(&replay);
-
-    // Run all events in the document from start to end.
-    IREE_RETURN_IF_ERROR(
-        iree_replay_benchmark_run_documents(&replay, file, benchmark_state));
-
-    // Reset file back to the start.
-    fseek(file, 0, SEEK_SET);
+    iree_time_t start_ns = iree_time_now();
+    status = iree_replay_benchmark_run_pass(&replay, file, benchmark_state);
+    elapsed_ns += iree_time_now() - start_ns;
 
     // Resume before looping because keep_running requires it.
     iree_benchmark_resume_timing(benchmark_state);
+    if (!iree_status_is_ok(status)) break;
   }
+  fclose(file);
 
+  if (iree_status_is_ok(status) && FLAG_print_latency) {
+    iree_replay_benchmark_print_latency(registration, 1, &replay.call_latency,
+                                        elapsed_ns);
+  }
   iree_trace_replay_deinitialize(&replay);
-  return iree_ok_status();
+  return status;
+}
+
+// A replay of the trace with its own context run on its own thread.
+typedef struct iree_replay_benchmark_worker_t {
+  iree_trace_replay_t replay;
+  FILE* file;
+  // Result of the last pass.
+  iree_status_t status;
+} iree_replay_benchmark_worker_t;
+
+static void iree_replay_benchmark_worker_main(void* user_data,
+                                              iree_host_size_t index) {
+  iree_replay_benchmark_worker_t* worker =
+      &((iree_replay_benchmark_worker_t*)user_data)[index];
+  worker->status = iree_replay_benchmark_run_pass(&worker->replay,
+                                                  worker->file, NULL);
+}
+
+// Runs one pass of the trace on each worker concurrently.
+// The first worker runs on the calling thread.
+static iree_status_t iree_replay_benchmark_run_workers(
+    iree_host_size_t worker_count, iree_replay_benchmark_worker_t* workers) {
+  iree_fork_join(IREE_SV("iree-replay"), worker_count,
+                 iree_replay_benchmark_worker_main, workers,
+                 iree_allocator_system());
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < worker_count; ++i) {
+    status = iree_status_join(status, workers[i].status);
+    workers[i].status = iree_ok_status();
+  }
+  return status;
+}
+
+// Runs the trace in |registration| on one or more threads with calls
+// pipelined up to --call_window deep. The whole trace is timed so that queueing
+// between calls is included and each call counts as one item processed.
+static iree_status_t iree_replay_benchmark_run_throughput(
+    const iree_replay_benchmark_registration_t* registration,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_allocator_t host_allocator = iree_allocator_system();
+  iree_host_size_t worker_count =
+      (iree_host_size_t)iree_max(1, FLAG_replay_threads);
+
+  // Each worker has its own replay state and file handle and persists across
+  // iterations so that devices and modules can be reused.
+  iree_replay_benchmark_worker_t* workers = NULL;
+  iree_status_t status = iree_allocator_malloc(
+      host_allocator, worker_count * sizeof(*workers), (void**)&workers);
+  if (iree_status_is_ok(status)) {
+    memset(workers, 0, worker_count * sizeof(*workers));
+  }
+  // Workers [0, initialized_count) have an open file and an initialized
+  // replay. A worker that fails part way through cleans up after itself and is
+  // not counted.
+  iree_host_size_t initialized_count = 0;
+  while (iree_status_is_ok(status) && initialized_count < worker_count) {
+    iree_replay_benchmark_worker_t* worker = &workers[initialized_count];
+    worker->file = fopen(registration->file_path.data, "rb");
+    if (!worker->file) {
+      status = iree_make_status(iree_status_code_from_errno(errno),
+                                "failed to open trace file '%.*s'",
+                                (int)registration->file_path.size,
+                                registration->file_path.data);
+      break;
+    }
+    status =
+        iree_replay_benchmark_initialize_replay(registration, &worker->replay);
+    if (!iree_status_is_ok(status)) {
+      fclose(worker->file);
+      worker->file = NULL;
+      break;
+    }
+    ++initialized_count;
+  }
+
+  int64_t call_count = 0;
+  iree_duration_t elapsed_ns = 0;
+  while (iree_status_is_ok(status) &&
+         iree_benchmark_keep_running(benchmark_state,
+                                     /*batch_count=*/1)) {
+    uint64_t previous_count = 0;
+    for (iree_host_size_t i = 0; i < worker_count; ++i) {
+      previous_count += workers[i].replay.call_latency.count;
+    }
+    iree_time_t start_ns = iree_time_now();
+    status = iree_replay_benchmark_run_workers(worker_count, workers);
+    elapsed_ns += iree_time_now() - start_ns;
+    for (iree_host_size_t i = 0; i < worker_count; ++i) {
+      call_count += workers[i].replay.call_latency.count;
+    }
+    call_count -= previous_count;
+  }
+  iree_benchmark_set_items_processed(benchmark_state, call_count);
+
+  if (iree_status_is_ok(status) && FLAG_print_latency) {
+    iree_trace_replay_latency_histogram_t latency;
+    iree_trace_replay_latency_histogram_reset(&latency);
+    for (iree_host_size_t i = 0; i < worker_count; ++i) {
+      iree_trace_replay_latency_histogram_merge(
+          &latency, &workers[i].replay.call_latency);
+    }
+    iree_replay_benchmark_print_latency(registration, worker_count, &latency,
+                                        elapsed_ns);
+  }
+
+  for (iree_host_size_t i = 0; i < initialized_count; ++i) {
+    iree_trace_replay_deinitialize(&workers[i].replay);
+    fclose(workers[i].file);
+  }
+  iree_allocator_free(host_allocator, workers);
+  return status;
+}
+
+// Benchmark function that runs a trace file.
+static iree_status_t iree_replay_benchmark_run_file(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  const iree_replay_benchmark_registration_t* registration =
+      (const iree_replay_benchmark_registration_t*)benchmark_def->user_data;
+  if (FLAG_call_window > 1 || FLAG_replay_threads > 1) {
+    return iree_replay_benchmark_run_throughput(registration,
+                                                benchmark_state);
+  }
+  return iree_replay_benchmark_run_sequential(registration, benchmark_state);
 }
 
 // Registers benchmarks for each trace file.